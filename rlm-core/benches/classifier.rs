@@ -0,0 +1,77 @@
+//! Per-message latency of the pattern classifier.
+//!
+//! Compares a full `should_activate` against the incremental session API on a
+//! context that grows by one turn per message, which is how hosts call it.
+
+use criterion::{black_box, criterion_group, criterion_main, BatchSize, Criterion};
+use rlm_core::context::{SessionContext, ToolOutput};
+use rlm_core::{ClassifierSession, PatternClassifier};
+
+const QUERIES: [&str; 4] = [
+    "What does this function return?",
+    "Find every place where the auth token is refreshed and check for races",
+    "now do the same for the tests",
+    "Be thorough: refactor the storage layer across src/memory/ and src/context/",
+];
+
+/// A session with `turns` user/assistant exchanges, files and tool outputs.
+fn session_context(turns: usize) -> SessionContext {
+    let mut ctx = SessionContext::new();
+    for i in 0..turns {
+        ctx.add_user_message(QUERIES[i % QUERIES.len()]);
+        ctx.add_assistant_message("Here is what I found in the module. ".repeat(20));
+        ctx.cache_file(format!("/src/module_{}/file_{}.rs", i % 7, i), "fn f() {}");
+        ctx.add_tool_output(ToolOutput::new("read", "line of output\n".repeat(100)));
+    }
+    ctx
+}
+
+fn bench_query_only(c: &mut Criterion) {
+    let classifier = PatternClassifier::new();
+    let ctx = SessionContext::new();
+    c.bench_function("classifier/query_only", |b| {
+        b.iter(|| {
+            for query in QUERIES {
+                black_box(classifier.should_activate(black_box(query), &ctx));
+            }
+        })
+    });
+}
+
+fn bench_per_message(c: &mut Criterion) {
+    let classifier = PatternClassifier::new();
+    let mut group = c.benchmark_group("classifier/per_message");
+
+    for turns in [10, 200] {
+        let ctx = session_context(turns);
+        group.bench_function(format!("full/{}_turns", turns), |b| {
+            b.iter(|| black_box(classifier.should_activate(QUERIES[1], &ctx)))
+        });
+
+        // Warm the session on the existing history, then time one new turn.
+        let mut warm = ClassifierSession::new();
+        classifier.should_activate_incremental(&mut warm, QUERIES[0], &ctx);
+        group.bench_function(format!("incremental/{}_turns", turns), |b| {
+            b.iter_batched(
+                || {
+                    let mut next = ctx.clone();
+                    next.add_user_message(QUERIES[2]);
+                    next.add_tool_output(ToolOutput::new("grep", "match\n".repeat(50)));
+                    (warm.clone(), next)
+                },
+                |(mut session, next)| {
+                    black_box(classifier.should_activate_incremental(
+                        &mut session,
+                        QUERIES[1],
+                        &next,
+                    ))
+                },
+                BatchSize::LargeInput,
+            )
+        });
+    }
+    group.finish();
+}
+
+criterion_group!(benches, bench_query_only, bench_per_message);
+criterion_main!(benches);
@@ -0,0 +1,326 @@
+//! Latency of the C ABI entry points that hosts call through `rlm_core.h`.
+//!
+//! Every benchmark goes through the exported `rlm_*` functions, including
+//! string conversion and `rlm_string_free`, so the numbers match what Go,
+//! Swift and C++ callers see. `scripts/perf/native_perf_harness.py` turns
+//! the criterion samples into the M5 harness JSON for the perf gate.
+//!
+//! Memory-store sizes come from `RLM_BENCH_NODES` (comma-separated, default
+//! `10000,100000`); add `1000000` for the full sweep.
+
+use std::ffi::{CStr, CString};
+use std::os::raw::c_char;
+
+use criterion::{black_box, criterion_group, criterion_main, BatchSize, Criterion};
+use rlm_core::ffi::*;
+
+const WORDS: [&str; 8] = [
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel",
+];
+
+const RESPONSE: &str = "The function `parse_config` returns a Result. It was added in \
+    src/config.rs on line 42. The cache hit rate is 87% after warmup, and the retry \
+    loop backs off exponentially. I believe the race happens because the lock is \
+    released before the write is flushed.";
+
+const MODEL: &str = "claude-sonnet";
+
+fn cstr(s: &str) -> CString {
+    CString::new(s).unwrap()
+}
+
+/// Take and free a library-owned string, returning its length.
+unsafe fn consume(ptr: *mut c_char) -> usize {
+    assert!(!ptr.is_null(), "ffi call failed");
+    let len = CStr::from_ptr(ptr).to_bytes().len();
+    rlm_string_free(ptr);
+    len
+}
+
+fn node_content(i: usize) -> CString {
+    cstr(&format!(
+        "node {i} {} {} observation about module_{}",
+        WORDS[i % WORDS.len()],
+        WORDS[(i / 7) % WORDS.len()],
+        i % 97
+    ))
+}
+
+fn bench_sizes() -> Vec<usize> {
+    std::env::var("RLM_BENCH_NODES")
+        .ok()
+        .map(|v| v.split(',').filter_map(|s| s.trim().parse().ok()).collect())
+        .unwrap_or_else(|| vec![10_000, 100_000])
+}
+
+/// Build a store with `n` nodes and one binary edge per node, returning the
+/// store and the ids of the first 100 nodes.
+unsafe fn populated_store(n: usize) -> (*mut RlmMemoryStore, Vec<CString>) {
+    let store = rlm_memory_store_in_memory();
+    let (edge_type, label) = (cstr("semantic"), cstr("next"));
+    let mut ids = Vec::new();
+    let mut prev: Option<CString> = None;
+    for start in (0..n).step_by(10_000) {
+        let nodes: Vec<*mut RlmNode> = (start..n.min(start + 10_000))
+            .map(|i| rlm_node_new(RlmNodeType::Fact, node_content(i).as_ptr()))
+            .collect();
+        let raw: Vec<*const RlmNode> = nodes.iter().map(|&p| p as *const _).collect();
+        assert_eq!(
+            rlm_memory_store_add_nodes(store, raw.as_ptr(), raw.len()),
+            raw.len() as i64
+        );
+
+        let mut edges = Vec::with_capacity(nodes.len());
+        for &node in &nodes {
+            let id_ptr = rlm_node_id(node);
+            let id = CStr::from_ptr(id_ptr).to_owned();
+            rlm_string_free(id_ptr);
+            if let Some(prev) = &prev {
+                edges.push(rlm_hyperedge_binary(
+                    edge_type.as_ptr(),
+                    prev.as_ptr(),
+                    id.as_ptr(),
+                    label.as_ptr(),
+                ));
+            }
+            if ids.len() < 100 {
+                ids.push(id.clone());
+            }
+            prev = Some(id);
+            rlm_node_free(node);
+        }
+        let raw: Vec<*const RlmHyperEdge> = edges.iter().map(|&p| p as *const _).collect();
+        rlm_memory_store_add_edges(store, raw.as_ptr(), raw.len());
+        edges.into_iter().for_each(|e| rlm_hyperedge_free(e));
+    }
+    (store, ids)
+}
+
+fn bench_memory_store(c: &mut Criterion) {
+    for n in bench_sizes() {
+        let (store, ids) = unsafe { populated_store(n) };
+        let mut group = c.benchmark_group(format!("ffi/memory/{n}"));
+        group.sample_size(20);
+
+        group.bench_function("insert_batch_100", |b| {
+            b.iter_batched(
+                || {
+                    (0..100)
+                        .map(|i| unsafe {
+                            rlm_node_new(RlmNodeType::Fact, node_content(n + i).as_ptr())
+                        })
+                        .collect::<Vec<_>>()
+                },
+                |nodes| unsafe {
+                    let raw: Vec<*const RlmNode> = nodes.iter().map(|&p| p as *const _).collect();
+                    black_box(rlm_memory_store_add_nodes(store, raw.as_ptr(), raw.len()));
+                    nodes.into_iter().for_each(|p| rlm_node_free(p));
+                },
+                BatchSize::SmallInput,
+            )
+        });
+
+        group.bench_function("search_content_20", |b| {
+            let query = cstr("charlie");
+            b.iter(|| unsafe {
+                let list = rlm_memory_store_search_content_list(store, query.as_ptr(), 20);
+                black_box(rlm_node_list_len(list));
+                rlm_node_list_free(list);
+            })
+        });
+
+        group.bench_function("get_node", |b| {
+            let mut i = 0;
+            b.iter(|| unsafe {
+                i = (i + 1) % ids.len();
+                let node = rlm_memory_store_get_node(store, ids[i].as_ptr());
+                black_box(node);
+                rlm_node_free(node);
+            })
+        });
+
+        group.bench_function("edges_for_node", |b| {
+            let mut i = 0;
+            b.iter(|| unsafe {
+                i = (i + 1) % ids.len();
+                let list = rlm_memory_store_get_edges_for_node_list(store, ids[i].as_ptr());
+                black_box(rlm_hyperedge_list_len(list));
+                rlm_hyperedge_list_free(list);
+            })
+        });
+
+        group.bench_function("neighborhood_depth_2", |b| {
+            let mut i = 0;
+            b.iter(|| unsafe {
+                i = (i + 1) % ids.len();
+                black_box(consume(rlm_memory_store_neighborhood(
+                    store,
+                    ids[i].as_ptr(),
+                    2,
+                    50,
+                )))
+            })
+        });
+
+        group.finish();
+        unsafe { rlm_memory_store_free(store) };
+    }
+}
+
+fn bench_classifier(c: &mut Criterion) {
+    unsafe {
+        let classifier = rlm_pattern_classifier_new();
+        let ctx = rlm_session_context_new();
+        for i in 0..50 {
+            rlm_session_context_add_user_message(ctx, cstr(&format!("question {i}")).as_ptr());
+            rlm_session_context_add_assistant_message(ctx, node_content(i).as_ptr());
+        }
+        let query = cstr("Find every place where the auth token is refreshed and check for races");
+
+        c.bench_function("ffi/classifier/should_activate", |b| {
+            b.iter(|| {
+                let decision =
+                    rlm_pattern_classifier_should_activate(classifier, query.as_ptr(), ctx);
+                black_box(rlm_activation_decision_score(decision));
+                rlm_activation_decision_free(decision);
+            })
+        });
+
+        rlm_session_context_free(ctx);
+        rlm_pattern_classifier_free(classifier);
+    }
+}
+
+fn bench_epistemic(c: &mut Criterion) {
+    unsafe {
+        let response = cstr(RESPONSE);
+
+        let scrubber = rlm_evidence_scrubber_new();
+        c.bench_function("ffi/epistemic/scrub", |b| {
+            b.iter(|| {
+                black_box(consume(rlm_evidence_scrubber_scrub(
+                    scrubber,
+                    response.as_ptr(),
+                )))
+            })
+        });
+        rlm_evidence_scrubber_free(scrubber);
+
+        let extractor = rlm_claim_extractor_new();
+        c.bench_function("ffi/epistemic/extract_claims", |b| {
+            b.iter(|| {
+                black_box(consume(rlm_claim_extractor_extract(
+                    extractor,
+                    response.as_ptr(),
+                )))
+            })
+        });
+        rlm_claim_extractor_free(extractor);
+
+        let kl: Vec<f64> = (1..=64)
+            .map(|i| rlm_kl_bernoulli_bits(0.9, i as f64 / 65.0))
+            .collect();
+        c.bench_function("ffi/epistemic/kl_64", |b| {
+            b.iter(|| {
+                let mut sum = 0.0;
+                for i in 1..=64 {
+                    let q = black_box(i as f64 / 65.0);
+                    sum += rlm_kl_bernoulli_bits(0.9, q) + rlm_binary_entropy_bits(q);
+                }
+                black_box(sum + rlm_aggregate_evidence_bits(kl.as_ptr(), kl.len()))
+            })
+        });
+    }
+}
+
+fn bench_cost_tracker(c: &mut Criterion) {
+    unsafe {
+        let tracker = rlm_cost_tracker_new();
+        let model = cstr(MODEL);
+        c.bench_function("ffi/cost/record", |b| {
+            b.iter(|| {
+                black_box(rlm_cost_tracker_record(
+                    tracker,
+                    model.as_ptr(),
+                    1200,
+                    300,
+                    800,
+                    0,
+                    -1.0,
+                ))
+            })
+        });
+        c.bench_function("ffi/cost/snapshot_into", |b| {
+            let mut out = RlmCostSnapshot::default();
+            b.iter(|| black_box(rlm_cost_tracker_snapshot_into(tracker, &mut out)))
+        });
+        rlm_cost_tracker_free(tracker);
+    }
+}
+
+fn bench_json_round_trips(c: &mut Criterion) {
+    unsafe {
+        let node = rlm_node_new_full(
+            RlmNodeType::Fact,
+            node_content(7).as_ptr(),
+            RlmTier::Session,
+            0.8,
+        );
+        c.bench_function("ffi/json/node_round_trip", |b| {
+            b.iter(|| {
+                let json = rlm_node_to_json(node);
+                let back = rlm_node_from_json(json);
+                rlm_string_free(json);
+                black_box(back);
+                rlm_node_free(back);
+            })
+        });
+        rlm_node_free(node);
+
+        let ctx = rlm_session_context_new();
+        let source = cstr("fn f() {}");
+        for i in 0..20 {
+            rlm_session_context_add_user_message(ctx, node_content(i).as_ptr());
+            rlm_session_context_cache_file(
+                ctx,
+                cstr(&format!("/src/module_{i}.rs")).as_ptr(),
+                source.as_ptr(),
+            );
+        }
+        c.bench_function("ffi/json/session_context_round_trip", |b| {
+            b.iter(|| {
+                let json = rlm_session_context_to_json(ctx);
+                let back = rlm_session_context_from_json(json);
+                rlm_string_free(json);
+                black_box(back);
+                rlm_session_context_free(back);
+            })
+        });
+        rlm_session_context_free(ctx);
+
+        let tracker = rlm_cost_tracker_new();
+        for model in ["claude-sonnet", "claude-haiku", "gpt-4o"] {
+            rlm_cost_tracker_record(tracker, cstr(model).as_ptr(), 1000, 200, 0, 0, -1.0);
+        }
+        c.bench_function("ffi/json/cost_tracker_round_trip", |b| {
+            b.iter(|| {
+                let json = rlm_cost_tracker_to_json(tracker);
+                let back = rlm_cost_tracker_from_json(json);
+                rlm_string_free(json);
+                black_box(back);
+                rlm_cost_tracker_free(back);
+            })
+        });
+        rlm_cost_tracker_free(tracker);
+    }
+}
+
+criterion_group!(
+    benches,
+    bench_memory_store,
+    bench_classifier,
+    bench_epistemic,
+    bench_cost_tracker,
+    bench_json_round_trips
+);
+criterion_main!(benches);
@@ -0,0 +1,274 @@
+/**
+ * Latency of the rlm_core.h entry points from a C++ host.
+ *
+ * Counterpart of benches/ffi.rs that links the release library the way
+ * embedders do. Prints per-iteration samples as JSON on stdout:
+ *
+ *     {"driver": "cxx", "samples_ms": {"<name>": [ms, ...], ...}}
+ *
+ * scripts/perf/native_perf_harness.py folds them into the M5 harness schema.
+ *
+ * Build (from rlm-core/, after `cargo build --release`):
+ *
+ *     c++ -std=c++17 -O2 -Iinclude benches/native/rlm_core_bench.cpp \
+ *         -Ltarget/release -lrlm_core -o target/release/rlm_core_bench
+ *
+ * Usage: rlm_core_bench [--nodes 10000,100000] [--samples 30]
+ */
+
+#include "rlm_core.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Samples = std::map<std::string, std::vector<double>>;
+
+const char* const kWords[] = {"alpha", "bravo", "charlie", "delta",
+                              "echo",  "foxtrot", "golf", "hotel"};
+
+const char* const kResponse =
+    "The function `parse_config` returns a Result. It was added in src/config.rs on line 42. "
+    "The cache hit rate is 87% after warmup, and the retry loop backs off exponentially. "
+    "I believe the race happens because the lock is released before the write is flushed.";
+
+std::string node_content(size_t i) {
+    return "node " + std::to_string(i) + " " + kWords[i % 8] + " " + kWords[(i / 7) % 8] +
+           " observation about module_" + std::to_string(i % 97);
+}
+
+/** Keep `value` observable so the call is not optimized away. */
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * Time `body` in `samples` batches, recording milliseconds per call. The
+ * batch size is calibrated so each sample takes about a millisecond.
+ */
+template <typename Body>
+void measure(Samples& out, const std::string& name, int samples, Body&& body) {
+    size_t iters = 1;
+    for (;;) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < iters; ++i) {
+            body();
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (elapsed >= 1.0 || iters >= (1u << 20)) {
+            break;
+        }
+        iters *= 2;
+    }
+
+    std::vector<double>& series = out[name];
+    for (int s = 0; s < samples; ++s) {
+        auto start = Clock::now();
+        for (size_t i = 0; i < iters; ++i) {
+            body();
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        series.push_back(elapsed / static_cast<double>(iters));
+    }
+}
+
+void bench_memory(Samples& out, size_t n, int samples) {
+    auto store = rlm::MemoryStore::in_memory();
+    std::vector<std::string> ids;
+    std::string prev;
+    for (size_t start = 0; start < n; start += 10000) {
+        std::vector<rlm::Node> nodes;
+        for (size_t i = start; i < std::min(n, start + 10000); ++i) {
+            nodes.emplace_back(RLM_NODE_TYPE_FACT, node_content(i));
+        }
+        store.add_nodes(nodes);
+
+        std::vector<rlm::HyperEdge> edges;
+        for (const rlm::Node& node : nodes) {
+            std::string id(node.id().str());
+            if (!prev.empty()) {
+                edges.push_back(rlm::HyperEdge::binary("semantic", prev, id, "next"));
+            }
+            if (ids.size() < 100) {
+                ids.push_back(id);
+            }
+            prev = std::move(id);
+        }
+        store.add_edges(edges);
+    }
+
+    const std::string prefix = "cxx/memory/" + std::to_string(n) + "/";
+    size_t next = n;
+    measure(out, prefix + "insert_batch_100", samples, [&] {
+        std::vector<rlm::Node> batch;
+        batch.reserve(100);
+        for (size_t i = 0; i < 100; ++i) {
+            batch.emplace_back(RLM_NODE_TYPE_FACT, node_content(next++));
+        }
+        keep(store.add_nodes(batch));
+    });
+    measure(out, prefix + "search_content_20", samples,
+            [&] { keep(store.search_content("charlie", 20).size()); });
+
+    size_t cursor = 0;
+    measure(out, prefix + "get_node", samples, [&] {
+        cursor = (cursor + 1) % ids.size();
+        keep(store.get_node(ids[cursor]).has_value());
+    });
+    measure(out, prefix + "edges_for_node", samples, [&] {
+        cursor = (cursor + 1) % ids.size();
+        keep(store.edges_for_node(ids[cursor]).size());
+    });
+    measure(out, prefix + "neighborhood_depth_2", samples, [&] {
+        cursor = (cursor + 1) % ids.size();
+        keep(store.neighborhood(ids[cursor], 2, 50).str().size());
+    });
+}
+
+void bench_classifier(Samples& out, int samples) {
+    rlm::SessionContext ctx;
+    for (size_t i = 0; i < 50; ++i) {
+        ctx.add_user_message("question " + std::to_string(i));
+        ctx.add_assistant_message(node_content(i));
+    }
+    RlmPatternClassifier* classifier = rlm_pattern_classifier_new();
+    const char* query = "Find every place where the auth token is refreshed and check for races";
+    measure(out, "cxx/classifier/should_activate", samples, [&] {
+        RlmActivationDecision* decision =
+            rlm_pattern_classifier_should_activate(classifier, query, ctx.get());
+        keep(rlm_activation_decision_score(decision));
+        rlm_activation_decision_free(decision);
+    });
+    rlm_pattern_classifier_free(classifier);
+}
+
+void bench_epistemic(Samples& out, int samples) {
+    RlmEvidenceScrubber* scrubber = rlm_evidence_scrubber_new();
+    measure(out, "cxx/epistemic/scrub", samples, [&] {
+        rlm::String scrubbed(rlm::detail::check_ptr(rlm_evidence_scrubber_scrub(scrubber, kResponse)));
+        keep(scrubbed.str().size());
+    });
+    rlm_evidence_scrubber_free(scrubber);
+
+    RlmClaimExtractor* extractor = rlm_claim_extractor_new();
+    measure(out, "cxx/epistemic/extract_claims", samples, [&] {
+        rlm::String claims(rlm::detail::check_ptr(rlm_claim_extractor_extract(extractor, kResponse)));
+        keep(claims.str().size());
+    });
+    rlm_claim_extractor_free(extractor);
+
+    std::vector<double> kl;
+    for (int i = 1; i <= 64; ++i) {
+        kl.push_back(rlm_kl_bernoulli_bits(0.9, i / 65.0));
+    }
+    measure(out, "cxx/epistemic/kl_64", samples, [&] {
+        double sum = 0.0;
+        for (int i = 1; i <= 64; ++i) {
+            sum += rlm_kl_bernoulli_bits(0.9, i / 65.0) + rlm_binary_entropy_bits(i / 65.0);
+        }
+        keep(sum + rlm_aggregate_evidence_bits(kl.data(), kl.size()));
+    });
+}
+
+void bench_cost(Samples& out, int samples) {
+    rlm::CostTracker tracker;
+    measure(out, "cxx/cost/record", samples,
+            [&] { tracker.record("claude-sonnet", 1200, 300, 800); });
+    RlmCostSnapshot snapshot{};
+    measure(out, "cxx/cost/snapshot_into", samples,
+            [&] { keep(tracker.snapshot_into(snapshot)); });
+}
+
+void bench_json(Samples& out, int samples) {
+    rlm::Node node(RLM_NODE_TYPE_FACT, node_content(7), RLM_TIER_SESSION, 0.8);
+    measure(out, "cxx/json/node_round_trip", samples,
+            [&] { keep(rlm::Node::from_json(node.to_json()).confidence()); });
+
+    rlm::SessionContext ctx;
+    for (size_t i = 0; i < 20; ++i) {
+        ctx.add_user_message(node_content(i));
+        ctx.cache_file("/src/module_" + std::to_string(i) + ".rs", "fn f() {}");
+    }
+    measure(out, "cxx/json/session_context_round_trip", samples,
+            [&] { keep(rlm::SessionContext::from_json(ctx.to_json()).message_count()); });
+
+    rlm::CostTracker tracker;
+    for (const char* model : {"claude-sonnet", "claude-haiku", "gpt-4o"}) {
+        tracker.record(model, 1000, 200);
+    }
+    measure(out, "cxx/json/cost_tracker_round_trip", samples,
+            [&] { keep(rlm::CostTracker::from_json(tracker.to_json()).request_count()); });
+}
+
+std::vector<size_t> parse_sizes(const char* csv) {
+    std::vector<size_t> sizes;
+    std::string value(csv);
+    size_t start = 0;
+    while (start < value.size()) {
+        size_t end = value.find(',', start);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        if (end > start) {
+            sizes.push_back(std::stoul(value.substr(start, end - start)));
+        }
+        start = end + 1;
+    }
+    return sizes;
+}
+
+void write_json(const Samples& samples) {
+    std::printf("{\"driver\": \"cxx\", \"samples_ms\": {");
+    bool first = true;
+    for (const auto& [name, series] : samples) {
+        std::printf("%s\n  \"%s\": [", first ? "" : ",", name.c_str());
+        for (size_t i = 0; i < series.size(); ++i) {
+            std::printf("%s%.9g", i ? ", " : "", series[i]);
+        }
+        std::printf("]");
+        first = false;
+    }
+    std::printf("\n}}\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes = {10000, 100000};
+    int samples = 30;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--nodes") == 0) {
+            sizes = parse_sizes(argv[i + 1]);
+        } else if (std::strcmp(argv[i], "--samples") == 0) {
+            samples = std::atoi(argv[i + 1]);
+        } else {
+            std::fprintf(stderr, "unknown option: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    try {
+        rlm::Library lib;
+        Samples out;
+        for (size_t n : sizes) {
+            bench_memory(out, n, samples);
+        }
+        bench_classifier(out, samples);
+        bench_epistemic(out, samples);
+        bench_cost(out, samples);
+        bench_json(out, samples);
+        write_json(out);
+    } catch (const rlm::Error& e) {
+        std::fprintf(stderr, "rlm_core_bench: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
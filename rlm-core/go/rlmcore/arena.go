@@ -0,0 +1,154 @@
+// Package rlmcore provides Go bindings for the rlm-core Rust library.
+// This file contains request-scoped arena bindings.
+
+package rlmcore
+
+/*
+#cgo LDFLAGS: -L${SRCDIR}/../../target/release -lrlm_core
+#cgo darwin LDFLAGS: -framework Security -framework CoreFoundation
+
+#include <stdlib.h>
+#include "../../include/rlm_core.h"
+*/
+import "C"
+
+import (
+	"runtime"
+	"unsafe"
+)
+
+// Arena holds short-lived messages, tool outputs, nodes and trajectory
+// events for one request and releases them all at once.
+//
+// Objects created by an Arena are borrowed: their Free is a no-op, and they
+// are only valid until the arena is reset or freed. Each keeps a reference
+// to its Arena, so the arena is not finalized while they are reachable. An
+// Arena must not be shared between goroutines.
+type Arena struct {
+	ptr *C.RlmArena
+}
+
+// NewArena creates an empty arena.
+func NewArena() *Arena {
+	a := &Arena{ptr: C.rlm_arena_new()}
+	runtime.SetFinalizer(a, (*Arena).Free)
+	return a
+}
+
+// Reset releases every object created in the arena, keeping its memory for
+// the next request.
+func (a *Arena) Reset() {
+	C.rlm_arena_reset(a.ptr)
+}
+
+// Free releases the arena and every object created in it.
+func (a *Arena) Free() {
+	if a.ptr != nil {
+		C.rlm_arena_free(a.ptr)
+		a.ptr = nil
+	}
+}
+
+// ObjectCount returns the number of objects currently in the arena.
+func (a *Arena) ObjectCount() int {
+	return int(C.rlm_arena_object_count(a.ptr))
+}
+
+// StringBytes returns the bytes of string data currently in the arena.
+func (a *Arena) StringBytes() int {
+	return int(C.rlm_arena_string_bytes(a.ptr))
+}
+
+// NewMessage creates a message in the arena.
+func (a *Arena) NewMessage(role Role, content string) (*Message, error) {
+	cs := cString(content)
+	defer C.free(unsafe.Pointer(cs))
+	ptr := C.rlm_message_new_in(a.ptr, C.RlmRole(role), cs)
+	if ptr == nil {
+		return nil, lastError()
+	}
+	return &Message{ptr: ptr, borrowed: true, owner: a}, nil
+}
+
+// NewToolOutput creates a tool output in the arena.
+func (a *Arena) NewToolOutput(toolName, content string) (*ToolOutput, error) {
+	cname := cString(toolName)
+	defer C.free(unsafe.Pointer(cname))
+	ccontent := cString(content)
+	defer C.free(unsafe.Pointer(ccontent))
+	ptr := C.rlm_tool_output_new_in(a.ptr, cname, ccontent)
+	if ptr == nil {
+		return nil, lastError()
+	}
+	return &ToolOutput{ptr: ptr, borrowed: true, owner: a}, nil
+}
+
+// NewToolOutputWithExitCode creates a tool output with an exit code in the
+// arena.
+func (a *Arena) NewToolOutputWithExitCode(toolName, content string, exitCode int) (*ToolOutput, error) {
+	cname := cString(toolName)
+	defer C.free(unsafe.Pointer(cname))
+	ccontent := cString(content)
+	defer C.free(unsafe.Pointer(ccontent))
+	ptr := C.rlm_tool_output_new_with_exit_code_in(a.ptr, cname, ccontent, C.int(exitCode))
+	if ptr == nil {
+		return nil, lastError()
+	}
+	return &ToolOutput{ptr: ptr, borrowed: true, owner: a}, nil
+}
+
+// NewNode creates a node in the arena.
+func (a *Arena) NewNode(nodeType NodeType, content string) (*Node, error) {
+	ccontent := cString(content)
+	defer C.free(unsafe.Pointer(ccontent))
+	ptr := C.rlm_node_new_in(a.ptr, C.RlmNodeType(nodeType), ccontent)
+	if ptr == nil {
+		return nil, lastError()
+	}
+	return &Node{ptr: ptr, borrowed: true, owner: a}, nil
+}
+
+// NewNodeFull creates a node with tier and confidence in the arena.
+func (a *Arena) NewNodeFull(nodeType NodeType, content string, tier Tier, confidence float64) (*Node, error) {
+	ccontent := cString(content)
+	defer C.free(unsafe.Pointer(ccontent))
+	ptr := C.rlm_node_new_full_in(a.ptr, C.RlmNodeType(nodeType), ccontent, C.RlmTier(tier), C.double(confidence))
+	if ptr == nil {
+		return nil, lastError()
+	}
+	return &Node{ptr: ptr, borrowed: true, owner: a}, nil
+}
+
+// NewTrajectoryEvent creates a trajectory event in the arena.
+func (a *Arena) NewTrajectoryEvent(eventType TrajectoryEventType, depth uint32, content string) (*TrajectoryEvent, error) {
+	ccontent := cString(content)
+	defer C.free(unsafe.Pointer(ccontent))
+	ptr := C.rlm_trajectory_event_new_in(a.ptr, C.RlmTrajectoryEventType(eventType), C.uint32_t(depth), ccontent)
+	if ptr == nil {
+		return nil, lastError()
+	}
+	return &TrajectoryEvent{ptr: ptr, borrowed: true, owner: a}, nil
+}
+
+// NodeJSON serializes a node to JSON through the arena.
+func (a *Arena) NodeJSON(n *Node) (string, error) {
+	return arenaString(C.rlm_node_to_json_in(a.ptr, n.ptr))
+}
+
+// EventJSON serializes a trajectory event to JSON through the arena.
+func (a *Arena) EventJSON(e *TrajectoryEvent) (string, error) {
+	return arenaString(C.rlm_trajectory_event_to_json_in(a.ptr, e.ptr))
+}
+
+// EventLogLine formats a trajectory event as a log line through the arena.
+func (a *Arena) EventLogLine(e *TrajectoryEvent) (string, error) {
+	return arenaString(C.rlm_trajectory_event_log_line_in(a.ptr, e.ptr))
+}
+
+// arenaString copies an arena-owned string; it must not be freed.
+func arenaString(cstr *C.char) (string, error) {
+	if cstr == nil {
+		return "", lastError()
+	}
+	return C.GoString(cstr), nil
+}
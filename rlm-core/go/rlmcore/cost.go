@@ -33,6 +33,23 @@ char* rlm_cost_tracker_by_model_json(const RlmCostTracker* tracker);
 char* rlm_cost_tracker_to_json(const RlmCostTracker* tracker);
 RlmCostTracker* rlm_cost_tracker_from_json(const char* json);
 
+typedef struct RlmUsageCosts {
+    uint64_t input_tokens;
+    uint64_t output_tokens;
+    uint64_t request_count;
+    double cost;
+} RlmUsageCosts;
+typedef struct RlmCostSnapshot {
+    uint64_t input_tokens;
+    uint64_t output_tokens;
+    uint64_t cache_read_tokens;
+    uint64_t cache_creation_tokens;
+    uint64_t request_count;
+    double total_cost;
+    RlmUsageCosts tiers[3];
+} RlmCostSnapshot;
+int rlm_cost_tracker_snapshot_into(const RlmCostTracker* tracker, RlmCostSnapshot* out);
+
 // Cost calculation helpers
 double rlm_calculate_cost(const char* model_json, uint64_t input_tokens, uint64_t output_tokens);
 double rlm_calculate_cost_by_name(const char* model_name, uint64_t input_tokens, uint64_t output_tokens);
@@ -66,7 +83,28 @@ type ModelCost struct {
 	RequestCount        uint64  `json:"request_count"`
 }
 
+// UsageCosts holds token and cost counters for one tier.
+type UsageCosts struct {
+	InputTokens  uint64
+	OutputTokens uint64
+	RequestCount uint64
+	Cost         float64
+}
+
+// CostSnapshot is a point-in-time copy of tracker totals.
+// Tiers is indexed root, recursive, extraction.
+type CostSnapshot struct {
+	InputTokens         uint64
+	OutputTokens        uint64
+	CacheReadTokens     uint64
+	CacheCreationTokens uint64
+	RequestCount        uint64
+	TotalCost           float64
+	Tiers               [3]UsageCosts
+}
+
 // NewCostTracker creates a new cost tracker.
+// The tracker is safe for concurrent use from multiple goroutines.
 func NewCostTracker() *CostTracker {
 	ct := &CostTracker{ptr: C.rlm_cost_tracker_new()}
 	runtime.SetFinalizer(ct, (*CostTracker).Free)
@@ -144,6 +182,31 @@ func (ct *CostTracker) RequestCount() uint64 {
 	return uint64(C.rlm_cost_tracker_request_count(ct.ptr))
 }
 
+// Snapshot returns all totals in a single call without JSON encoding.
+func (ct *CostTracker) Snapshot() (CostSnapshot, error) {
+	var out C.RlmCostSnapshot
+	if C.rlm_cost_tracker_snapshot_into(ct.ptr, &out) != 0 {
+		return CostSnapshot{}, lastError()
+	}
+	snap := CostSnapshot{
+		InputTokens:         uint64(out.input_tokens),
+		OutputTokens:        uint64(out.output_tokens),
+		CacheReadTokens:     uint64(out.cache_read_tokens),
+		CacheCreationTokens: uint64(out.cache_creation_tokens),
+		RequestCount:        uint64(out.request_count),
+		TotalCost:           float64(out.total_cost),
+	}
+	for i, tier := range out.tiers {
+		snap.Tiers[i] = UsageCosts{
+			InputTokens:  uint64(tier.input_tokens),
+			OutputTokens: uint64(tier.output_tokens),
+			RequestCount: uint64(tier.request_count),
+			Cost:         float64(tier.cost),
+		}
+	}
+	return snap, nil
+}
+
 // ByModel returns the per-model cost breakdown.
 func (ct *CostTracker) ByModel() (map[string]ModelCost, error) {
 	cstr := C.rlm_cost_tracker_by_model_json(ct.ptr)
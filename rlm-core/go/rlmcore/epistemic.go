@@ -16,6 +16,7 @@ RlmClaimExtractor* rlm_claim_extractor_new(void);
 void rlm_claim_extractor_free(RlmClaimExtractor* extractor);
 char* rlm_claim_extractor_extract(RlmClaimExtractor* extractor, const char* response);
 char* rlm_claim_extractor_extract_high_specificity(RlmClaimExtractor* extractor, const char* response, double threshold);
+char* rlm_claim_extractor_extract_batch(RlmClaimExtractor* extractor, const char* const* responses, size_t count);
 
 // EvidenceScrubber opaque type and functions
 typedef struct RlmEvidenceScrubber RlmEvidenceScrubber;
@@ -104,6 +105,33 @@ func (e *ClaimExtractor) Extract(response string) ([]Claim, error) {
 	return claims, nil
 }
 
+// ExtractBatch extracts claims from several responses in one call.
+// Large batches are processed in parallel; results are in input order.
+func (e *ClaimExtractor) ExtractBatch(responses []string) ([][]Claim, error) {
+	if len(responses) == 0 {
+		return [][]Claim{}, nil
+	}
+	cresponses := C.malloc(C.size_t(len(responses)) * C.size_t(unsafe.Sizeof(uintptr(0))))
+	defer C.free(cresponses)
+	ptrs := unsafe.Slice((**C.char)(cresponses), len(responses))
+	for i, response := range responses {
+		ptrs[i] = cString(response)
+		defer C.free(unsafe.Pointer(ptrs[i]))
+	}
+
+	cstr := C.rlm_claim_extractor_extract_batch(e.ptr, (**C.char)(cresponses), C.size_t(len(responses)))
+	if cstr == nil {
+		return nil, lastError()
+	}
+	jsonStr := goString(cstr)
+
+	var batches [][]Claim
+	if err := json.Unmarshal([]byte(jsonStr), &batches); err != nil {
+		return nil, err
+	}
+	return batches, nil
+}
+
 // ExtractHighSpecificity extracts claims above a specificity threshold.
 func (e *ClaimExtractor) ExtractHighSpecificity(response string, threshold float64) ([]Claim, error) {
 	cresponse := cString(response)
@@ -0,0 +1,58 @@
+// Package rlmcore provides Go bindings for the rlm-core Rust library.
+// This file contains LLM provider limiter bindings.
+
+package rlmcore
+
+/*
+#cgo LDFLAGS: -L${SRCDIR}/../../target/release -lrlm_core
+#cgo darwin LDFLAGS: -framework Security -framework CoreFoundation
+
+#include <stdlib.h>
+
+char* rlm_llm_limiter_state_json(void);
+*/
+import "C"
+
+import "encoding/json"
+
+// LimiterConfig is the configuration of a provider limiter.
+type LimiterConfig struct {
+	RequestsPerWindow uint32  `json:"requests_per_window"`
+	TokensPerWindow   uint32  `json:"tokens_per_window"`
+	WindowMs          uint64  `json:"window_ms"`
+	MinConcurrency    int     `json:"min_concurrency"`
+	MaxConcurrency    int     `json:"max_concurrency"`
+	BackoffRatio      float64 `json:"backoff_ratio"`
+	LatencyTolerance  float64 `json:"latency_tolerance"`
+}
+
+// LimiterState is a point-in-time view of one provider limiter.
+type LimiterState struct {
+	ID                uint64        `json:"id"`
+	Provider          string        `json:"provider"`
+	ConcurrencyLimit  float64       `json:"concurrency_limit"`
+	InFlight          int           `json:"in_flight"`
+	Waiting           int           `json:"waiting"`
+	RequestsAvailable *float64      `json:"requests_available"`
+	TokensAvailable   *float64      `json:"tokens_available"`
+	PausedForMs       *uint64       `json:"paused_for_ms"`
+	LatencyEwmaMs     *float64      `json:"latency_ewma_ms"`
+	LatencyBaselineMs *float64      `json:"latency_baseline_ms"`
+	Admitted          uint64        `json:"admitted"`
+	Throttled         uint64        `json:"throttled"`
+	Coalesced         uint64        `json:"coalesced"`
+	Config            LimiterConfig `json:"config"`
+}
+
+// LimiterStates returns the state of every live provider limiter.
+func LimiterStates() ([]LimiterState, error) {
+	cstr := C.rlm_llm_limiter_state_json()
+	if cstr == nil {
+		return nil, lastError()
+	}
+	var states []LimiterState
+	if err := json.Unmarshal([]byte(goString(cstr)), &states); err != nil {
+		return nil, err
+	}
+	return states, nil
+}
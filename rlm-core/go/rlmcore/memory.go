@@ -60,6 +60,23 @@ func (s *MemoryStore) AddNode(node *Node) error {
 	return nil
 }
 
+// AddNodes adds many nodes in a single transaction. Either every node is
+// stored or none are.
+func (s *MemoryStore) AddNodes(nodes []*Node) (int64, error) {
+	if len(nodes) == 0 {
+		return 0, nil
+	}
+	ptrs := make([]*C.RlmNode, len(nodes))
+	for i, n := range nodes {
+		ptrs[i] = n.ptr
+	}
+	count := C.rlm_memory_store_add_nodes(s.ptr, (**C.RlmNode)(unsafe.Pointer(&ptrs[0])), C.size_t(len(ptrs)))
+	if count < 0 {
+		return 0, lastError()
+	}
+	return int64(count), nil
+}
+
 // GetNode retrieves a node by ID.
 func (s *MemoryStore) GetNode(nodeID string) (*Node, error) {
 	cid := cString(nodeID)
@@ -177,20 +194,106 @@ func (s *MemoryStore) Decay(factor, minConfidence float64) ([]string, error) {
 	return decayed, nil
 }
 
-// Stats returns statistics about the memory store.
-func (s *MemoryStore) Stats() (*MemoryStats, error) {
-	cstr := C.rlm_memory_store_stats(s.ptr)
+// MaintenanceOptions tunes background decay and consolidation. Zero values
+// take the library defaults.
+type MaintenanceOptions struct {
+	DecayFactor      float64  `json:"decay_factor,omitempty"`
+	MinConfidence    float64  `json:"min_confidence,omitempty"`
+	ConsolidateTiers []string `json:"consolidate_tiers,omitempty"`
+	BatchSize        uint64   `json:"batch_size,omitempty"`
+	BatchPauseMs     uint64   `json:"batch_pause_ms,omitempty"`
+	SweepIntervalMs  uint64   `json:"sweep_interval_ms,omitempty"`
+}
+
+// MaintenanceStats reports background maintenance progress.
+type MaintenanceStats struct {
+	Sweeps    uint64  `json:"sweeps"`
+	Batches   uint64  `json:"batches"`
+	Decayed   uint64  `json:"decayed"`
+	Promoted  uint64  `json:"promoted"`
+	Errors    uint64  `json:"errors"`
+	LastError *string `json:"last_error"`
+}
+
+// Maintenance decays and consolidates a store in the background, one bounded
+// batch per transaction.
+type Maintenance struct {
+	ptr *C.RlmMemoryMaintenance
+}
+
+// StartMaintenance starts background maintenance of the store.
+func (s *MemoryStore) StartMaintenance(options MaintenanceOptions) (*Maintenance, error) {
+	optionsJSON, err := json.Marshal(options)
+	if err != nil {
+		return nil, err
+	}
+	coptions := cString(string(optionsJSON))
+	defer C.free(unsafe.Pointer(coptions))
+
+	ptr := C.rlm_memory_maintenance_start(s.ptr, coptions)
+	if ptr == nil {
+		return nil, lastError()
+	}
+	m := &Maintenance{ptr: ptr}
+	runtime.SetFinalizer(m, (*Maintenance).Free)
+	return m, nil
+}
+
+// Trigger starts the next sweep now.
+func (m *Maintenance) Trigger() {
+	C.rlm_memory_maintenance_trigger(m.ptr)
+}
+
+// Stats returns maintenance counters.
+func (m *Maintenance) Stats() (*MaintenanceStats, error) {
+	cstr := C.rlm_memory_maintenance_stats(m.ptr)
 	if cstr == nil {
 		return nil, lastError()
 	}
-	jsonStr := goString(cstr)
-	var stats MemoryStats
-	if err := json.Unmarshal([]byte(jsonStr), &stats); err != nil {
+	var stats MaintenanceStats
+	if err := json.Unmarshal([]byte(goString(cstr)), &stats); err != nil {
 		return nil, err
 	}
 	return &stats, nil
 }
 
+// Free stops maintenance after the current batch and releases resources.
+func (m *Maintenance) Free() {
+	if m.ptr != nil {
+		C.rlm_memory_maintenance_free(m.ptr)
+		m.ptr = nil
+	}
+}
+
+// Stats returns statistics about the memory store.
+func (s *MemoryStore) Stats() (*MemoryStats, error) {
+	var out C.RlmMemoryStats
+	if C.rlm_memory_store_stats_into(s.ptr, &out) != 0 {
+		return nil, lastError()
+	}
+	return &MemoryStats{
+		TotalNodes: int64(out.total_nodes),
+		TotalEdges: int64(out.total_edges),
+	}, nil
+}
+
+// QueryByTypeList queries nodes by type without a JSON round trip.
+func (s *MemoryStore) QueryByTypeList(nodeType NodeType, limit int64) (*NodeList, error) {
+	return newNodeList(C.rlm_memory_store_query_by_type_list(s.ptr, C.RlmNodeType(nodeType), C.int64_t(limit)))
+}
+
+// QueryByTierList queries nodes by tier without a JSON round trip.
+func (s *MemoryStore) QueryByTierList(tier Tier, limit int64) (*NodeList, error) {
+	return newNodeList(C.rlm_memory_store_query_by_tier_list(s.ptr, C.RlmTier(tier), C.int64_t(limit)))
+}
+
+// SearchContentList performs full-text search without a JSON round trip.
+func (s *MemoryStore) SearchContentList(query string, limit int64) (*NodeList, error) {
+	cquery := cString(query)
+	defer C.free(unsafe.Pointer(cquery))
+	return newNodeList(C.rlm_memory_store_search_content_list(s.ptr, cquery, C.int64_t(limit)))
+}
+
 // AddEdge adds a hyperedge to the store.
 func (s *MemoryStore) AddEdge(edge *HyperEdge) error {
 	if C.rlm_memory_store_add_edge(s.ptr, edge.ptr) != 0 {
@@ -217,7 +320,49 @@ func (s *MemoryStore) GetEdgesForNode(nodeID string) ([]EdgeData, error) {
 
 // Node represents a memory node in the hypergraph.
 type Node struct {
-	ptr *C.RlmNode
+	ptr      *C.RlmNode
+	borrowed bool
+	owner    any // keeps the holder of a borrowed object reachable
+}
+
+// NodeList is a query result held natively by the library.
+//
+// Nodes returned by At are owned by the list and are only valid until the
+// list is freed. They keep the list reachable, so it is not finalized while
+// they are in use.
+type NodeList struct {
+	ptr *C.RlmNodeList
+}
+
+func newNodeList(ptr *C.RlmNodeList) (*NodeList, error) {
+	if ptr == nil {
+		return nil, lastError()
+	}
+	list := &NodeList{ptr: ptr}
+	runtime.SetFinalizer(list, (*NodeList).Free)
+	return list, nil
+}
+
+// Len returns the number of nodes in the list.
+func (l *NodeList) Len() int {
+	return int(C.rlm_node_list_len(l.ptr))
+}
+
+// At returns a borrowed view of the node at index i, or nil if out of range.
+func (l *NodeList) At(i int) *Node {
+	ptr := C.rlm_node_list_get(l.ptr, C.size_t(i))
+	if ptr == nil {
+		return nil
+	}
+	return &Node{ptr: (*C.RlmNode)(unsafe.Pointer(ptr)), borrowed: true, owner: l}
+}
+
+// Free releases the list and every node it owns.
+func (l *NodeList) Free() {
+	if l.ptr != nil {
+		C.rlm_node_list_free(l.ptr)
+		l.ptr = nil
+	}
 }
 
 // NewNode creates a new node with the given type and content.
@@ -240,7 +385,7 @@ func NewNodeFull(nodeType NodeType, content string, tier Tier, confidence float6
 
 // Free releases the node resources.
 func (n *Node) Free() {
-	if n.ptr != nil {
+	if n.ptr != nil && !n.borrowed {
 		C.rlm_node_free(n.ptr)
 		n.ptr = nil
 	}
@@ -261,6 +406,18 @@ func (n *Node) Content() string {
 	return goString(C.rlm_node_content(n.ptr))
 }
 
+// ContentView returns the node content without copying it out of the library.
+//
+// The returned slice aliases memory owned by the node: it is only valid until
+// the node is mutated or freed, and must not be modified.
+func (n *Node) ContentView() []byte {
+	v := C.rlm_node_content_view(n.ptr)
+	if v.ptr == nil || v.len == 0 {
+		return nil
+	}
+	return unsafe.Slice((*byte)(unsafe.Pointer(v.ptr)), int(v.len))
+}
+
 // Tier returns the node's memory tier.
 func (n *Node) Tier() Tier {
 	return Tier(C.rlm_node_tier(n.ptr))
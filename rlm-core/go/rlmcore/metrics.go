@@ -0,0 +1,98 @@
+// Package rlmcore provides Go bindings for the rlm-core Rust library.
+// This file contains hot-path metrics bindings.
+
+package rlmcore
+
+/*
+#cgo LDFLAGS: -L${SRCDIR}/../../target/release -lrlm_core
+#cgo darwin LDFLAGS: -framework Security -framework CoreFoundation
+
+#include <stdlib.h>
+#include "../../include/rlm_core.h"
+*/
+import "C"
+
+import "time"
+
+// Metric identifies an instrumented hot-path operation.
+type Metric int
+
+const (
+	MetricReplRoundTrip Metric = iota
+	MetricReplSpawn
+	MetricSqliteQuery
+	MetricStoreLockWait
+	MetricLLMCall
+	MetricLLMQueue
+	MetricScrub
+	MetricClaimExtract
+
+	// MetricCount is the number of metrics.
+	MetricCount = int(C.RLM_METRIC_COUNT)
+)
+
+// Name returns the metric's snake_case name, as used in the Prometheus output.
+func (m Metric) Name() string {
+	return C.GoString(C.rlm_metric_name(C.RlmMetric(m)))
+}
+
+// MetricSample summarizes one metric since the last reset. Percentiles are
+// within 12.5% of exact.
+type MetricSample struct {
+	Count uint64
+	Sum   time.Duration
+	Max   time.Duration
+	P50   time.Duration
+	P95   time.Duration
+	P99   time.Duration
+}
+
+// MetricsSnapshot returns every metric, indexed by Metric, without JSON
+// encoding.
+func MetricsSnapshot() ([MetricCount]MetricSample, error) {
+	var out C.RlmMetricsSnapshot
+	var snap [MetricCount]MetricSample
+	if C.rlm_metrics_snapshot(&out) != 0 {
+		return snap, lastError()
+	}
+	for i, s := range out.samples {
+		snap[i] = MetricSample{
+			Count: uint64(s.count),
+			Sum:   time.Duration(s.sum_ns),
+			Max:   time.Duration(s.max_ns),
+			P50:   time.Duration(s.p50_ns),
+			P95:   time.Duration(s.p95_ns),
+			P99:   time.Duration(s.p99_ns),
+		}
+	}
+	return snap, nil
+}
+
+// MetricsPrometheus renders every metric in the Prometheus text format.
+func MetricsPrometheus() (string, error) {
+	cstr := C.rlm_metrics_prometheus()
+	if cstr == nil {
+		return "", lastError()
+	}
+	return goString(cstr), nil
+}
+
+// ResetMetrics clears every metric.
+func ResetMetrics() {
+	C.rlm_metrics_reset()
+}
+
+// SetMetricsTracing turns tracing spans around instrumented operations on or
+// off, overriding the RLM_TRACE_SPANS environment variable.
+func SetMetricsTracing(enabled bool) {
+	var flag C.int
+	if enabled {
+		flag = 1
+	}
+	C.rlm_metrics_set_tracing(flag)
+}
+
+// MetricsTracingEnabled reports whether tracing spans are enabled.
+func MetricsTracingEnabled() bool {
+	return C.rlm_metrics_tracing_enabled() != 0
+}
@@ -7,6 +7,7 @@ package rlmcore
 // Opaque types for REPL
 typedef struct RlmReplHandle RlmReplHandle;
 typedef struct RlmReplPool RlmReplPool;
+typedef struct RlmReplPending RlmReplPending;
 
 // REPL configuration
 char* rlm_repl_config_default(void);
@@ -25,18 +26,29 @@ int rlm_repl_handle_reset(RlmReplHandle* handle);
 int rlm_repl_handle_shutdown(RlmReplHandle* handle);
 int rlm_repl_handle_is_alive(RlmReplHandle* handle);
 
+// Pipelined requests
+RlmReplPending* rlm_repl_handle_execute_async(RlmReplHandle* handle, const char* code);
+RlmReplPending* rlm_repl_handle_get_variable_async(RlmReplHandle* handle, const char* name);
+int rlm_repl_pending_poll(RlmReplPending* pending);
+char* rlm_repl_pending_wait(RlmReplPending* pending);
+void rlm_repl_pending_free(RlmReplPending* pending);
+
 // ReplPool functions
 RlmReplPool* rlm_repl_pool_new_default(size_t max_size);
 RlmReplPool* rlm_repl_pool_new(const char* config_json, size_t max_size);
 void rlm_repl_pool_free(RlmReplPool* pool);
 RlmReplHandle* rlm_repl_pool_acquire(const RlmReplPool* pool);
 void rlm_repl_pool_release(const RlmReplPool* pool, RlmReplHandle* handle);
+RlmReplPool* rlm_repl_pool_new_with_options(const char* config_json, const char* options_json);
+RlmReplHandle* rlm_repl_pool_acquire_timeout(const RlmReplPool* pool, uint64_t timeout_ms);
+char* rlm_repl_pool_stats(const RlmReplPool* pool);
 */
 import "C"
 
 import (
 	"encoding/json"
 	"runtime"
+	"time"
 	"unsafe"
 )
 
@@ -47,6 +59,11 @@ type ReplConfig struct {
 	TimeoutMs       uint64  `json:"timeout_ms"`
 	MaxMemoryBytes  *uint64 `json:"max_memory_bytes,omitempty"`
 	MaxCPUSeconds   *uint64 `json:"max_cpu_seconds,omitempty"`
+	// StartupMode is "spawn" (default) or "fork_server".
+	StartupMode string `json:"startup_mode,omitempty"`
+	// ShmThresholdBytes is the payload size at which values move through
+	// shared memory instead of the JSON pipe (0 disables).
+	ShmThresholdBytes *uint64 `json:"shm_threshold_bytes,omitempty"`
 }
 
 // DefaultReplConfig returns the default REPL configuration.
@@ -249,6 +266,59 @@ func (h *ReplHandle) IsAlive() bool {
 	return C.rlm_repl_handle_is_alive(h.ptr) == 1
 }
 
+// PendingRequest is a REPL request that has been sent but whose result may
+// not have arrived yet. Several may be in flight on one handle.
+type PendingRequest struct {
+	ptr *C.RlmReplPending
+}
+
+func newPendingRequest(ptr *C.RlmReplPending) (*PendingRequest, error) {
+	if ptr == nil {
+		return nil, lastError()
+	}
+	p := &PendingRequest{ptr: ptr}
+	runtime.SetFinalizer(p, (*PendingRequest).Free)
+	return p, nil
+}
+
+// ExecuteAsync starts executing Python code without waiting for the result.
+// Wait decodes into an ExecuteResult.
+func (h *ReplHandle) ExecuteAsync(code string) (*PendingRequest, error) {
+	ccode := cString(code)
+	defer C.free(unsafe.Pointer(ccode))
+	return newPendingRequest(C.rlm_repl_handle_execute_async(h.ptr, ccode))
+}
+
+// GetVariableAsync requests a variable without waiting for the value.
+func (h *ReplHandle) GetVariableAsync(name string) (*PendingRequest, error) {
+	cname := cString(name)
+	defer C.free(unsafe.Pointer(cname))
+	return newPendingRequest(C.rlm_repl_handle_get_variable_async(h.ptr, cname))
+}
+
+// Ready reports whether Wait would return without blocking.
+func (p *PendingRequest) Ready() bool {
+	return C.rlm_repl_pending_poll(p.ptr) == 1
+}
+
+// Wait blocks until the request completes and decodes its result into out.
+// The result can be taken only once.
+func (p *PendingRequest) Wait(out any) error {
+	cstr := C.rlm_repl_pending_wait(p.ptr)
+	if cstr == nil {
+		return lastError()
+	}
+	return json.Unmarshal([]byte(goString(cstr)), out)
+}
+
+// Free releases the pending request, abandoning it if still in flight.
+func (p *PendingRequest) Free() {
+	if p.ptr != nil {
+		C.rlm_repl_pending_free(p.ptr)
+		p.ptr = nil
+	}
+}
+
 // ReplPool is a pool of REPL subprocess handles.
 type ReplPool struct {
 	ptr *C.RlmReplPool
@@ -280,6 +350,54 @@ func NewReplPool(config *ReplConfig, maxSize int) (*ReplPool, error) {
 	return p, nil
 }
 
+// ReplPoolOptions controls pool sizing and timing. Zero values take the
+// library defaults except MinIdle.
+type ReplPoolOptions struct {
+	MinIdle               uint64 `json:"min_idle"`
+	MaxSize               uint64 `json:"max_size,omitempty"`
+	AcquireTimeoutMs      uint64 `json:"acquire_timeout_ms,omitempty"`
+	HealthCheckIntervalMs uint64 `json:"health_check_interval_ms,omitempty"`
+}
+
+// ReplPoolStats reports pool occupancy and spawn latency.
+type ReplPoolStats struct {
+	Idle            int      `json:"idle"`
+	Busy            int      `json:"busy"`
+	Spawning        int      `json:"spawning"`
+	Spawned         uint64   `json:"spawned"`
+	SpawnFailures   uint64   `json:"spawn_failures"`
+	AcquireTimeouts uint64   `json:"acquire_timeouts"`
+	SpawnLatencyMs  []uint64 `json:"spawn_latency_ms"`
+}
+
+// NewReplPoolWithOptions creates a bounded, optionally pre-warmed REPL pool.
+// A nil config uses the default REPL configuration.
+func NewReplPoolWithOptions(config *ReplConfig, options ReplPoolOptions) (*ReplPool, error) {
+	var cconfig *C.char
+	if config != nil {
+		configJSON, err := json.Marshal(config)
+		if err != nil {
+			return nil, err
+		}
+		cconfig = cString(string(configJSON))
+		defer C.free(unsafe.Pointer(cconfig))
+	}
+	optionsJSON, err := json.Marshal(options)
+	if err != nil {
+		return nil, err
+	}
+	coptions := cString(string(optionsJSON))
+	defer C.free(unsafe.Pointer(coptions))
+
+	ptr := C.rlm_repl_pool_new_with_options(cconfig, coptions)
+	if ptr == nil {
+		return nil, lastError()
+	}
+	p := &ReplPool{ptr: ptr}
+	runtime.SetFinalizer(p, (*ReplPool).Free)
+	return p, nil
+}
+
 // Free releases the REPL pool resources.
 func (p *ReplPool) Free() {
 	if p.ptr != nil {
@@ -299,6 +417,28 @@ func (p *ReplPool) Acquire() (*ReplHandle, error) {
 	return h, nil
 }
 
+// AcquireTimeout acquires a REPL handle, waiting at most timeout for one.
+func (p *ReplPool) AcquireTimeout(timeout time.Duration) (*ReplHandle, error) {
+	ptr := C.rlm_repl_pool_acquire_timeout(p.ptr, C.uint64_t(timeout.Milliseconds()))
+	if ptr == nil {
+		return nil, lastError()
+	}
+	return &ReplHandle{ptr: ptr}, nil
+}
+
+// Stats returns pool occupancy and spawn statistics.
+func (p *ReplPool) Stats() (*ReplPoolStats, error) {
+	cstr := C.rlm_repl_pool_stats(p.ptr)
+	if cstr == nil {
+		return nil, lastError()
+	}
+	var stats ReplPoolStats
+	if err := json.Unmarshal([]byte(goString(cstr)), &stats); err != nil {
+		return nil, err
+	}
+	return &stats, nil
+}
+
 // Release releases a REPL handle back to the pool.
 func (p *ReplPool) Release(h *ReplHandle) {
 	if h.ptr != nil {
@@ -108,6 +108,7 @@ typedef struct RlmNode RlmNode;
 typedef struct RlmHyperEdge RlmHyperEdge;
 typedef struct RlmTrajectoryEvent RlmTrajectoryEvent;
 typedef struct RlmPatternClassifier RlmPatternClassifier;
+typedef struct RlmClassifierSession RlmClassifierSession;
 typedef struct RlmActivationDecision RlmActivationDecision;
 
 // SessionContext functions
@@ -124,6 +125,8 @@ int64_t rlm_session_context_file_count(const RlmSessionContext* ctx);
 int64_t rlm_session_context_tool_output_count(const RlmSessionContext* ctx);
 int rlm_session_context_spans_multiple_directories(const RlmSessionContext* ctx);
 int64_t rlm_session_context_total_message_tokens(const RlmSessionContext* ctx);
+int64_t rlm_session_context_total_tokens(const RlmSessionContext* ctx);
+int rlm_session_context_load_tokenizer(RlmSessionContext* ctx, const char* tiktoken_path);
 char* rlm_session_context_to_json(const RlmSessionContext* ctx);
 RlmSessionContext* rlm_session_context_from_json(const char* json);
 
@@ -153,6 +156,10 @@ RlmPatternClassifier* rlm_pattern_classifier_new(void);
 RlmPatternClassifier* rlm_pattern_classifier_with_threshold(int threshold);
 void rlm_pattern_classifier_free(RlmPatternClassifier* classifier);
 RlmActivationDecision* rlm_pattern_classifier_should_activate(const RlmPatternClassifier* classifier, const char* query, const RlmSessionContext* ctx);
+RlmClassifierSession* rlm_classifier_session_new(void);
+void rlm_classifier_session_reset(RlmClassifierSession* session);
+void rlm_classifier_session_free(RlmClassifierSession* session);
+RlmActivationDecision* rlm_pattern_classifier_should_activate_incremental(const RlmPatternClassifier* classifier, RlmClassifierSession* session, const char* query, const RlmSessionContext* ctx);
 
 // ActivationDecision functions
 void rlm_activation_decision_free(RlmActivationDecision* decision);
@@ -530,11 +537,27 @@ func (c *SessionContext) SpansMultipleDirectories() bool {
 	return C.rlm_session_context_spans_multiple_directories(c.ptr) != 0
 }
 
-// TotalMessageTokens returns the approximate token count of all messages.
+// TotalMessageTokens returns the token count of all messages.
 func (c *SessionContext) TotalMessageTokens() int64 {
 	return int64(C.rlm_session_context_total_message_tokens(c.ptr))
 }
 
+// TotalTokens returns the token count of messages, files and tool outputs.
+func (c *SessionContext) TotalTokens() int64 {
+	return int64(C.rlm_session_context_total_tokens(c.ptr))
+}
+
+// LoadTokenizer switches token counting to the BPE rank table at path
+// (a .tiktoken file) and recounts existing content.
+func (c *SessionContext) LoadTokenizer(path string) error {
+	cpath := cString(path)
+	defer C.free(unsafe.Pointer(cpath))
+	if C.rlm_session_context_load_tokenizer(c.ptr, cpath) != 0 {
+		return lastError()
+	}
+	return nil
+}
+
 // ToJSON serializes the context to JSON.
 func (c *SessionContext) ToJSON() (string, error) {
 	cstr := C.rlm_session_context_to_json(c.ptr)
@@ -559,7 +582,9 @@ func SessionContextFromJSON(jsonStr string) (*SessionContext, error) {
 
 // Message represents a conversation message.
 type Message struct {
-	ptr *C.RlmMessage
+	ptr      *C.RlmMessage
+	borrowed bool
+	owner    any // keeps the holder of a borrowed object reachable
 }
 
 // NewMessage creates a new message with the given role and content.
@@ -609,7 +634,7 @@ func NewToolMessage(content string) *Message {
 
 // Free releases the message resources.
 func (m *Message) Free() {
-	if m.ptr != nil {
+	if m.ptr != nil && !m.borrowed {
 		C.rlm_message_free(m.ptr)
 		m.ptr = nil
 	}
@@ -636,7 +661,9 @@ func (m *Message) Timestamp() string {
 
 // ToolOutput represents the output of a tool execution.
 type ToolOutput struct {
-	ptr *C.RlmToolOutput
+	ptr      *C.RlmToolOutput
+	borrowed bool
+	owner    any // keeps the holder of a borrowed object reachable
 }
 
 // NewToolOutput creates a new tool output.
@@ -663,7 +690,7 @@ func NewToolOutputWithExitCode(toolName, content string, exitCode int) *ToolOutp
 
 // Free releases the tool output resources.
 func (o *ToolOutput) Free() {
-	if o.ptr != nil {
+	if o.ptr != nil && !o.borrowed {
 		C.rlm_tool_output_free(o.ptr)
 		o.ptr = nil
 	}
@@ -734,6 +761,45 @@ func (c *PatternClassifier) ShouldActivate(query string, ctx *SessionContext) *A
 	return d
 }
 
+// ShouldActivateIncremental is ShouldActivate using state cached in session,
+// so only context added since the previous call on session is scanned.
+func (c *PatternClassifier) ShouldActivateIncremental(session *ClassifierSession, query string, ctx *SessionContext) *ActivationDecision {
+	cquery := cString(query)
+	defer C.free(unsafe.Pointer(cquery))
+	ptr := C.rlm_pattern_classifier_should_activate_incremental(c.ptr, session.ptr, cquery, ctx.ptr)
+	if ptr == nil {
+		return nil
+	}
+	d := &ActivationDecision{ptr: ptr}
+	runtime.SetFinalizer(d, (*ActivationDecision).Free)
+	return d
+}
+
+// ClassifierSession caches per-session classification state.
+type ClassifierSession struct {
+	ptr *C.RlmClassifierSession
+}
+
+// NewClassifierSession creates an empty classifier session.
+func NewClassifierSession() *ClassifierSession {
+	s := &ClassifierSession{ptr: C.rlm_classifier_session_new()}
+	runtime.SetFinalizer(s, (*ClassifierSession).Free)
+	return s
+}
+
+// Reset forgets the cached state, e.g. after the context was replaced.
+func (s *ClassifierSession) Reset() {
+	C.rlm_classifier_session_reset(s.ptr)
+}
+
+// Free releases the session resources.
+func (s *ClassifierSession) Free() {
+	if s.ptr != nil {
+		C.rlm_classifier_session_free(s.ptr)
+		s.ptr = nil
+	}
+}
+
 // ActivationDecision contains the result of a complexity analysis.
 type ActivationDecision struct {
 	ptr *C.RlmActivationDecision
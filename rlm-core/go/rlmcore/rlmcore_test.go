@@ -1,6 +1,7 @@
 package rlmcore
 
 import (
+	"path/filepath"
 	"strings"
 	"testing"
 )
@@ -107,6 +108,52 @@ func TestSessionContextJSON(t *testing.T) {
 	}
 }
 
+func TestSessionSnapshot(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "session.rlmsnap")
+	ctx := NewSessionContext()
+	defer ctx.Free()
+	ctx.AddUserMessage("Test message")
+	ctx.CacheFile("/test.txt", "content")
+
+	writer, err := CreateSessionSnapshot(path)
+	if err != nil {
+		t.Fatalf("CreateSessionSnapshot failed: %v", err)
+	}
+	if _, err := writer.Checkpoint(ctx); err != nil {
+		t.Fatalf("Checkpoint failed: %v", err)
+	}
+	ctx.AddAssistantMessage("Reply")
+	stats, err := writer.Checkpoint(ctx)
+	if err != nil {
+		t.Fatalf("Checkpoint failed: %v", err)
+	}
+	writer.Free()
+	if stats.Full || stats.MessagesWritten != 1 || stats.BlobsWritten != 0 {
+		t.Errorf("Second checkpoint should be a delta: %+v", stats)
+	}
+
+	snap, err := OpenSessionSnapshot(path)
+	if err != nil {
+		t.Fatalf("OpenSessionSnapshot failed: %v", err)
+	}
+	defer snap.Free()
+	if snap.MessageCount() != 2 {
+		t.Errorf("Snapshot has wrong message count: %d", snap.MessageCount())
+	}
+	if content, ok := snap.GetFile("/test.txt"); !ok || content != "content" {
+		t.Errorf("Snapshot file mismatch: %q", content)
+	}
+
+	restored, err := snap.ToContext()
+	if err != nil {
+		t.Fatalf("ToContext failed: %v", err)
+	}
+	defer restored.Free()
+	if restored.FileCount() != 1 {
+		t.Errorf("Restored context has wrong file count: %d", restored.FileCount())
+	}
+}
+
 func TestMessage(t *testing.T) {
 	msg := NewUserMessage("Hello, world!")
 	defer msg.Free()
@@ -246,6 +293,19 @@ func TestMemoryStore(t *testing.T) {
 		t.Errorf("Expected 1 result, got %d", len(ids))
 	}
 
+	// Query by type without JSON
+	list, err := store.QueryByTypeList(NodeTypeFact, 10)
+	if err != nil {
+		t.Fatalf("QueryByTypeList failed: %v", err)
+	}
+	if list.Len() != 1 || list.At(0).ID() != nodeID {
+		t.Errorf("QueryByTypeList mismatch: len=%d", list.Len())
+	}
+	if list.At(1) != nil {
+		t.Error("At past the end should return nil")
+	}
+	list.Free()
+
 	// Stats
 	stats, err := store.Stats()
 	if err != nil {
@@ -284,6 +344,9 @@ func TestNode(t *testing.T) {
 	if node.Content() != "User struct" {
 		t.Errorf("Content mismatch: %s", node.Content())
 	}
+	if string(node.ContentView()) != "User struct" {
+		t.Errorf("ContentView mismatch: %s", node.ContentView())
+	}
 	if node.Tier() != TierSession {
 		t.Errorf("Tier mismatch: %v", node.Tier())
 	}
@@ -484,3 +547,30 @@ func TestTierString(t *testing.T) {
 		t.Errorf("TierLongTerm string mismatch: %s", TierLongTerm.String())
 	}
 }
+
+func TestMetricsSnapshot(t *testing.T) {
+	scrubber := NewEvidenceScrubber()
+	defer scrubber.Free()
+	if _, err := scrubber.Scrub("See src/lib.rs line 42"); err != nil {
+		t.Fatalf("Scrub failed: %v", err)
+	}
+
+	snap, err := MetricsSnapshot()
+	if err != nil {
+		t.Fatalf("MetricsSnapshot failed: %v", err)
+	}
+	if snap[MetricScrub].Count == 0 {
+		t.Error("Scrub metric should have samples")
+	}
+	if MetricScrub.Name() != "scrub" {
+		t.Errorf("MetricScrub name mismatch: %s", MetricScrub.Name())
+	}
+
+	text, err := MetricsPrometheus()
+	if err != nil {
+		t.Fatalf("MetricsPrometheus failed: %v", err)
+	}
+	if !strings.Contains(text, "rlm_scrub_seconds_count") {
+		t.Error("Prometheus text should include the scrub summary")
+	}
+}
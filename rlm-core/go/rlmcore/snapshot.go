@@ -0,0 +1,146 @@
+// Package rlmcore provides Go bindings for the rlm-core Rust library.
+// This file contains binary session snapshot bindings.
+
+package rlmcore
+
+/*
+#cgo LDFLAGS: -L${SRCDIR}/../../target/release -lrlm_core
+#cgo darwin LDFLAGS: -framework Security -framework CoreFoundation
+
+#include <stdlib.h>
+#include "../../include/rlm_core.h"
+*/
+import "C"
+
+import (
+	"runtime"
+	"unsafe"
+)
+
+// CheckpointStats reports what one snapshot checkpoint appended.
+type CheckpointStats struct {
+	// BlobsWritten counts file and tool-output bodies new to the snapshot.
+	BlobsWritten uint64
+	// BlobsReused counts bodies referenced from earlier checkpoints.
+	BlobsReused uint64
+	// MessagesWritten counts messages appended.
+	MessagesWritten uint64
+	// BytesWritten is the size of the checkpoint.
+	BytesWritten uint64
+	// Full is true when the message list was rewritten from the start.
+	Full bool
+}
+
+// SessionSnapshotWriter appends checkpoints of a SessionContext to an
+// append-only binary snapshot. Unchanged bodies are stored once and each
+// checkpoint adds only new messages.
+type SessionSnapshotWriter struct {
+	ptr *C.RlmSessionSnapshotWriter
+}
+
+func newSessionSnapshotWriter(ptr *C.RlmSessionSnapshotWriter) (*SessionSnapshotWriter, error) {
+	if ptr == nil {
+		return nil, lastError()
+	}
+	w := &SessionSnapshotWriter{ptr: ptr}
+	runtime.SetFinalizer(w, (*SessionSnapshotWriter).Free)
+	return w, nil
+}
+
+// CreateSessionSnapshot creates (or truncates) a snapshot at path.
+func CreateSessionSnapshot(path string) (*SessionSnapshotWriter, error) {
+	cpath := cString(path)
+	defer C.free(unsafe.Pointer(cpath))
+	return newSessionSnapshotWriter(C.rlm_session_snapshot_writer_create(cpath))
+}
+
+// AppendSessionSnapshot continues the snapshot at path, creating it if it is
+// missing. The next checkpoint is a delta against the last committed one.
+func AppendSessionSnapshot(path string) (*SessionSnapshotWriter, error) {
+	cpath := cString(path)
+	defer C.free(unsafe.Pointer(cpath))
+	return newSessionSnapshotWriter(C.rlm_session_snapshot_writer_append(cpath))
+}
+
+// Checkpoint appends and flushes a checkpoint of ctx. After an error, free
+// the writer and resume with AppendSessionSnapshot.
+func (w *SessionSnapshotWriter) Checkpoint(ctx *SessionContext) (CheckpointStats, error) {
+	var out C.RlmSnapshotCheckpointStats
+	if C.rlm_session_snapshot_writer_checkpoint(w.ptr, ctx.ptr, &out) != 0 {
+		return CheckpointStats{}, lastError()
+	}
+	return CheckpointStats{
+		BlobsWritten:    uint64(out.blobs_written),
+		BlobsReused:     uint64(out.blobs_reused),
+		MessagesWritten: uint64(out.messages_written),
+		BytesWritten:    uint64(out.bytes_written),
+		Full:            out.full != 0,
+	}, nil
+}
+
+// Free releases the writer.
+func (w *SessionSnapshotWriter) Free() {
+	if w.ptr != nil {
+		C.rlm_session_snapshot_writer_free(w.ptr)
+		w.ptr = nil
+	}
+}
+
+// SessionSnapshot is a memory-mapped snapshot resumed at its last committed
+// checkpoint. File bodies are read from the mapping only when requested.
+type SessionSnapshot struct {
+	ptr *C.RlmSessionSnapshot
+}
+
+// OpenSessionSnapshot maps the snapshot at path.
+func OpenSessionSnapshot(path string) (*SessionSnapshot, error) {
+	cpath := cString(path)
+	defer C.free(unsafe.Pointer(cpath))
+	ptr := C.rlm_session_snapshot_open(cpath)
+	if ptr == nil {
+		return nil, lastError()
+	}
+	s := &SessionSnapshot{ptr: ptr}
+	runtime.SetFinalizer(s, (*SessionSnapshot).Free)
+	return s, nil
+}
+
+// Free unmaps the snapshot.
+func (s *SessionSnapshot) Free() {
+	if s.ptr != nil {
+		C.rlm_session_snapshot_free(s.ptr)
+		s.ptr = nil
+	}
+}
+
+// MessageCount returns the number of messages in the snapshot.
+func (s *SessionSnapshot) MessageCount() int64 {
+	return int64(C.rlm_session_snapshot_message_count(s.ptr))
+}
+
+// FileCount returns the number of cached files in the snapshot.
+func (s *SessionSnapshot) FileCount() int64 {
+	return int64(C.rlm_session_snapshot_file_count(s.ptr))
+}
+
+// GetFile reads one cached file's contents without decoding the others.
+func (s *SessionSnapshot) GetFile(path string) (string, bool) {
+	cpath := cString(path)
+	defer C.free(unsafe.Pointer(cpath))
+	view := C.rlm_session_snapshot_get_file_view(s.ptr, cpath)
+	if view.ptr == nil {
+		return "", false
+	}
+	return C.GoStringN(view.ptr, C.int(view.len)), true
+}
+
+// ToContext materializes the snapshot as a SessionContext.
+func (s *SessionSnapshot) ToContext() (*SessionContext, error) {
+	ptr := C.rlm_session_snapshot_to_context(s.ptr)
+	if ptr == nil {
+		return nil, lastError()
+	}
+	ctx := &SessionContext{ptr: ptr}
+	runtime.SetFinalizer(ctx, (*SessionContext).Free)
+	return ctx, nil
+}
@@ -0,0 +1,14 @@
+//go:build unix
+
+package rlmcore
+
+/*
+#include "../../include/rlm_core.h"
+*/
+import "C"
+
+// StreamSessionSnapshot starts a new snapshot on a duplicate of fd (a file,
+// pipe or socket); the caller keeps ownership of fd.
+func StreamSessionSnapshot(fd uintptr) (*SessionSnapshotWriter, error) {
+	return newSessionSnapshotWriter(C.rlm_session_snapshot_writer_from_fd(C.int(fd)))
+}
@@ -6,17 +6,22 @@ package rlmcore
 
 #include <stdlib.h>
 #include "../../include/rlm_core.h"
+
+extern void rlmGoTrajectoryCallback(RlmTrajectoryEvent* event, void* user_data);
 */
 import "C"
 
 import (
 	"runtime"
+	"runtime/cgo"
 	"unsafe"
 )
 
 // TrajectoryEvent represents an event in the RLM execution trajectory.
 type TrajectoryEvent struct {
-	ptr *C.RlmTrajectoryEvent
+	ptr      *C.RlmTrajectoryEvent
+	borrowed bool
+	owner    any // keeps the holder of a borrowed object reachable
 }
 
 // NewTrajectoryEvent creates a new trajectory event.
@@ -115,7 +120,7 @@ func NewErrorEvent(depth uint32, errMsg string) *TrajectoryEvent {
 
 // Free releases the event resources.
 func (e *TrajectoryEvent) Free() {
-	if e.ptr != nil {
+	if e.ptr != nil && !e.borrowed {
 		C.rlm_trajectory_event_free(e.ptr)
 		e.ptr = nil
 	}
@@ -258,3 +263,115 @@ func (c *TrajectoryCollector) FinalAnswer() string {
 	}
 	return ""
 }
+
+// TrajectorySinkFormat selects the encoding of a TrajectorySink.
+type TrajectorySinkFormat int
+
+const (
+	TrajectorySinkJSONL  TrajectorySinkFormat = C.RLM_TRAJECTORY_SINK_JSONL
+	TrajectorySinkBinary TrajectorySinkFormat = C.RLM_TRAJECTORY_SINK_BINARY
+)
+
+// EventMask returns the filter mask selecting the given event types.
+// An empty mask (0) selects every event type.
+func EventMask(types ...TrajectoryEventType) uint32 {
+	var mask uint32
+	for _, t := range types {
+		mask |= 1 << uint(t)
+	}
+	return mask
+}
+
+// PublishTrajectoryEvent publishes a copy of event on the process-wide
+// trajectory bus and returns the number of subscribers that will receive it.
+func PublishTrajectoryEvent(event *TrajectoryEvent) (int, error) {
+	n := C.rlm_trajectory_publish(event.ptr)
+	if n < 0 {
+		return 0, lastError()
+	}
+	return int(n), nil
+}
+
+// TrajectorySubscription delivers trajectory bus events to a Go callback.
+type TrajectorySubscription struct {
+	id     uint64
+	handle cgo.Handle
+}
+
+// SubscribeTrajectory calls fn for every bus event whose type is selected by
+// mask (see EventMask). fn runs on a library thread, one event at a time. The
+// event is borrowed: it is only valid during the call and must not be freed.
+func SubscribeTrajectory(mask uint32, fn func(*TrajectoryEvent)) (*TrajectorySubscription, error) {
+	h := cgo.NewHandle(fn)
+	id := C.rlm_trajectory_subscribe(
+		C.RlmTrajectoryCallback(unsafe.Pointer(C.rlmGoTrajectoryCallback)),
+		C.uint32_t(mask),
+		unsafe.Pointer(uintptr(h)),
+	)
+	if id == 0 {
+		h.Delete()
+		return nil, lastError()
+	}
+	return &TrajectorySubscription{id: uint64(id), handle: h}, nil
+}
+
+// Close cancels the subscription after delivering events already queued.
+// It must not be called from inside the callback.
+func (s *TrajectorySubscription) Close() error {
+	if s.id == 0 {
+		return nil
+	}
+	rc := C.rlm_trajectory_unsubscribe(C.uint64_t(s.id))
+	s.id = 0
+	s.handle.Delete()
+	if rc != 0 {
+		return lastError()
+	}
+	return nil
+}
+
+//export rlmGoTrajectoryCallback
+func rlmGoTrajectoryCallback(event *C.RlmTrajectoryEvent, userData unsafe.Pointer) {
+	fn := cgo.Handle(uintptr(userData)).Value().(func(*TrajectoryEvent))
+	fn(&TrajectoryEvent{ptr: event})
+}
+
+// TrajectorySink streams trajectory bus events to a file.
+type TrajectorySink struct {
+	ptr *C.RlmTrajectorySink
+}
+
+// OpenTrajectorySink streams bus events selected by mask to path, appending
+// if the file exists.
+func OpenTrajectorySink(path string, format TrajectorySinkFormat, mask uint32) (*TrajectorySink, error) {
+	cpath := cString(path)
+	defer C.free(unsafe.Pointer(cpath))
+	ptr := C.rlm_trajectory_sink_open(cpath, C.RlmTrajectorySinkFormat(format), C.uint32_t(mask))
+	if ptr == nil {
+		return nil, lastError()
+	}
+	return &TrajectorySink{ptr: ptr}, nil
+}
+
+// Delivered returns the number of events written so far.
+func (s *TrajectorySink) Delivered() uint64 {
+	return uint64(C.rlm_trajectory_sink_delivered(s.ptr))
+}
+
+// Dropped returns the number of events lost because the sink fell behind.
+func (s *TrajectorySink) Dropped() uint64 {
+	return uint64(C.rlm_trajectory_sink_dropped(s.ptr))
+}
+
+// Close flushes pending events and closes the sink.
+func (s *TrajectorySink) Close() error {
+	if s.ptr == nil {
+		return nil
+	}
+	rc := C.rlm_trajectory_sink_close(s.ptr)
+	s.ptr = nil
+	if rc != 0 {
+		return lastError()
+	}
+	return nil
+}
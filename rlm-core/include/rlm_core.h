@@ -9,6 +9,9 @@
  *
  * - Objects created by `*_new()` functions must be freed with corresponding `*_free()` functions
  * - Strings returned by the library must be freed with `rlm_string_free()`
+ * - `*_view()` accessors return an `RlmStrView` borrowed from the owning object;
+ *   views are not NUL-terminated, must not be freed, and are valid only until
+ *   the owner is mutated or freed
  * - Caller-owned strings passed to functions are not freed by the library
  *
  * ## Error Handling
@@ -37,16 +40,41 @@ extern "C" {
  * ============================================================================ */
 
 typedef struct RlmSessionContext RlmSessionContext;
+typedef struct RlmSessionSnapshotWriter RlmSessionSnapshotWriter;
+typedef struct RlmSessionSnapshot RlmSessionSnapshot;
 typedef struct RlmMessage RlmMessage;
 typedef struct RlmToolOutput RlmToolOutput;
 typedef struct RlmMemoryStore RlmMemoryStore;
+typedef struct RlmMemoryMaintenance RlmMemoryMaintenance;
 typedef struct RlmNode RlmNode;
 typedef struct RlmHyperEdge RlmHyperEdge;
 typedef struct RlmTrajectoryEvent RlmTrajectoryEvent;
+typedef struct RlmTrajectorySink RlmTrajectorySink;
 typedef struct RlmPatternClassifier RlmPatternClassifier;
+typedef struct RlmClassifierSession RlmClassifierSession;
 typedef struct RlmActivationDecision RlmActivationDecision;
 typedef struct RlmReplHandle RlmReplHandle;
 typedef struct RlmReplPool RlmReplPool;
+typedef struct RlmReplPending RlmReplPending;
+typedef struct RlmNodeList RlmNodeList;
+typedef struct RlmHyperEdgeList RlmHyperEdgeList;
+typedef struct RlmArena RlmArena;
+
+/* ============================================================================
+ * Borrowed String Views
+ * ============================================================================ */
+
+/**
+ * Non-owning view of a UTF-8 string held inside a library object.
+ *
+ * `ptr` is not NUL-terminated; always use `len`. An absent value is `{NULL, 0}`.
+ * The view is valid until the owning object is mutated or freed and must never
+ * be passed to `rlm_string_free()`.
+ */
+typedef struct {
+    const char* ptr;
+    size_t len;
+} RlmStrView;
 
 /* ============================================================================
  * Enumerations
@@ -99,9 +127,22 @@ typedef enum {
     RLM_EVENT_MEMORY = 17,
     RLM_EVENT_EXTERNALIZE = 18,
     RLM_EVENT_DECOMPOSE = 19,
-    RLM_EVENT_SYNTHESIZE = 20
+    RLM_EVENT_SYNTHESIZE = 20,
+    RLM_EVENT_ADVERSARIAL_START = 21,
+    RLM_EVENT_CRITIC_INVOKED = 22,
+    RLM_EVENT_ISSUE_FOUND = 23,
+    RLM_EVENT_ADVERSARIAL_COMPLETE = 24
 } RlmTrajectoryEventType;
 
+/** Bit for `type` in a trajectory filter mask */
+#define RLM_EVENT_MASK(type) (1u << (type))
+
+/** Encoding for trajectory sinks */
+typedef enum {
+    RLM_TRAJECTORY_SINK_JSONL = 0,
+    RLM_TRAJECTORY_SINK_BINARY = 1
+} RlmTrajectorySinkFormat;
+
 /* ============================================================================
  * Library Functions
  * ============================================================================ */
@@ -161,15 +202,98 @@ int rlm_session_context_add_user_message(RlmSessionContext* ctx, const char* con
 int rlm_session_context_add_assistant_message(RlmSessionContext* ctx, const char* content);
 int rlm_session_context_cache_file(RlmSessionContext* ctx, const char* path, const char* content);
 char* rlm_session_context_get_file(const RlmSessionContext* ctx, const char* path);
+RlmStrView rlm_session_context_get_file_view(const RlmSessionContext* ctx, const char* path);
 int rlm_session_context_add_tool_output(RlmSessionContext* ctx, const RlmToolOutput* output);
 int64_t rlm_session_context_message_count(const RlmSessionContext* ctx);
 int64_t rlm_session_context_file_count(const RlmSessionContext* ctx);
 int64_t rlm_session_context_tool_output_count(const RlmSessionContext* ctx);
 int rlm_session_context_spans_multiple_directories(const RlmSessionContext* ctx);
 int64_t rlm_session_context_total_message_tokens(const RlmSessionContext* ctx);
+int64_t rlm_session_context_total_tokens(const RlmSessionContext* ctx);
+
+/**
+ * Count tokens with a BPE tokenizer loaded from a `.tiktoken` rank file
+ * (e.g. cl100k_base.tiktoken) instead of the ~4 bytes/token estimate.
+ * Token totals are maintained incrementally, so the total_*_tokens getters
+ * stay O(1) either way.
+ * @param ctx Session context
+ * @param tiktoken_path Path to the rank file (cached per process)
+ * @return 0 on success, -1 on failure
+ */
+int rlm_session_context_load_tokenizer(RlmSessionContext* ctx, const char* tiktoken_path);
 char* rlm_session_context_to_json(const RlmSessionContext* ctx);
 RlmSessionContext* rlm_session_context_from_json(const char* json);
 
+/* ============================================================================
+ * SessionSnapshot - Append-only binary checkpoints with mmap resume
+ * ============================================================================ */
+
+/**
+ * What one checkpoint appended. File and tool-output bodies are stored once
+ * by content hash, so unchanged bodies count as reused rather than written.
+ * `full` is 1 when the message list was rewritten from the start (first
+ * checkpoint, or earlier messages changed) and 0 for a delta.
+ */
+typedef struct RlmSnapshotCheckpointStats {
+    uint64_t blobs_written;
+    uint64_t blobs_reused;
+    uint64_t messages_written;
+    uint64_t bytes_written;
+    int32_t full;
+} RlmSnapshotCheckpointStats;
+
+/**
+ * Create a snapshot at `path`, replacing any existing one by rename so
+ * readers that mapped it are unaffected.
+ * @return Writer (must be freed with rlm_session_snapshot_writer_free), or NULL on error
+ */
+RlmSessionSnapshotWriter* rlm_session_snapshot_writer_create(const char* path);
+
+/**
+ * Continue the snapshot at `path`, creating it if missing. An interrupted
+ * trailing checkpoint is dropped by rewriting the committed prefix to a new
+ * file; the next checkpoint is a delta.
+ * @return Writer (must be freed with rlm_session_snapshot_writer_free), or NULL on error
+ */
+RlmSessionSnapshotWriter* rlm_session_snapshot_writer_append(const char* path);
+
+/**
+ * Stream a new snapshot to a duplicate of `fd` (POSIX only); the caller keeps `fd`.
+ * @return Writer (must be freed with rlm_session_snapshot_writer_free), or NULL on error
+ */
+RlmSessionSnapshotWriter* rlm_session_snapshot_writer_from_fd(int fd);
+
+/**
+ * Append and flush a checkpoint of `ctx`, syncing it to disk for writers
+ * opened by path. Free the writer after a failure.
+ * @param stats_out Receives what was appended (may be NULL)
+ * @return 0 on success, -1 on failure
+ */
+int rlm_session_snapshot_writer_checkpoint(RlmSessionSnapshotWriter* writer, const RlmSessionContext* ctx, RlmSnapshotCheckpointStats* stats_out);
+void rlm_session_snapshot_writer_free(RlmSessionSnapshotWriter* writer);
+
+/**
+ * Map a snapshot and resume its last committed checkpoint. File bodies are
+ * read from the mapping only when requested.
+ * @return Snapshot (must be freed with rlm_session_snapshot_free), or NULL on error
+ */
+RlmSessionSnapshot* rlm_session_snapshot_open(const char* path);
+void rlm_session_snapshot_free(RlmSessionSnapshot* snapshot);
+int64_t rlm_session_snapshot_message_count(const RlmSessionSnapshot* snapshot);
+int64_t rlm_session_snapshot_file_count(const RlmSessionSnapshot* snapshot);
+
+/**
+ * Borrow a cached file's contents from the mapping; valid until the
+ * snapshot is freed. `{ NULL, 0 }` if not cached or on error.
+ */
+RlmStrView rlm_session_snapshot_get_file_view(const RlmSessionSnapshot* snapshot, const char* path);
+
+/**
+ * Materialize the snapshot as a session context, reading every body.
+ * @return Context (must be freed with rlm_session_context_free), or NULL on error
+ */
+RlmSessionContext* rlm_session_snapshot_to_context(const RlmSessionSnapshot* snapshot);
+
 /* ============================================================================
  * Message
  * ============================================================================ */
@@ -182,6 +306,7 @@ RlmMessage* rlm_message_tool(const char* content);
 void rlm_message_free(RlmMessage* msg);
 RlmRole rlm_message_role(const RlmMessage* msg);
 char* rlm_message_content(const RlmMessage* msg);
+RlmStrView rlm_message_content_view(const RlmMessage* msg);
 char* rlm_message_timestamp(const RlmMessage* msg);
 
 /* ============================================================================
@@ -192,11 +317,72 @@ RlmToolOutput* rlm_tool_output_new(const char* tool_name, const char* content);
 RlmToolOutput* rlm_tool_output_new_with_exit_code(const char* tool_name, const char* content, int exit_code);
 void rlm_tool_output_free(RlmToolOutput* output);
 char* rlm_tool_output_tool_name(const RlmToolOutput* output);
+RlmStrView rlm_tool_output_tool_name_view(const RlmToolOutput* output);
 char* rlm_tool_output_content(const RlmToolOutput* output);
+RlmStrView rlm_tool_output_content_view(const RlmToolOutput* output);
 int rlm_tool_output_exit_code(const RlmToolOutput* output);
 int rlm_tool_output_has_exit_code(const RlmToolOutput* output);
 int rlm_tool_output_is_success(const RlmToolOutput* output);
 
+/* ============================================================================
+ * Arena - Request-scoped objects and strings
+ * ============================================================================ */
+
+/**
+ * An arena holds short-lived messages, tool outputs, nodes and trajectory
+ * events created with the *_new_in() functions, plus strings returned by the
+ * *_in() accessors. rlm_arena_reset() releases all of them at once and keeps
+ * the memory for the next request.
+ *
+ * Arena objects and strings must not be passed to *_free() or
+ * rlm_string_free(), and are invalid after rlm_arena_reset() or
+ * rlm_arena_free(). An arena is not thread-safe: use one per request.
+ */
+RlmArena* rlm_arena_new(void);
+void rlm_arena_reset(RlmArena* arena);
+void rlm_arena_free(RlmArena* arena);
+
+/** @return Number of objects currently allocated in the arena */
+size_t rlm_arena_object_count(const RlmArena* arena);
+
+/** @return Bytes of string data currently allocated, including terminators */
+size_t rlm_arena_string_bytes(const RlmArena* arena);
+
+/**
+ * Arena counterparts of the matching constructors.
+ * @return Object owned by `arena`, or NULL on error
+ */
+RlmMessage* rlm_message_new_in(RlmArena* arena, RlmRole role, const char* content);
+RlmToolOutput* rlm_tool_output_new_in(RlmArena* arena, const char* tool_name, const char* content);
+RlmToolOutput* rlm_tool_output_new_with_exit_code_in(
+    RlmArena* arena,
+    const char* tool_name,
+    const char* content,
+    int exit_code);
+RlmNode* rlm_node_new_in(RlmArena* arena, RlmNodeType node_type, const char* content);
+RlmNode* rlm_node_new_full_in(
+    RlmArena* arena,
+    RlmNodeType node_type,
+    const char* content,
+    RlmTier tier,
+    double confidence);
+RlmTrajectoryEvent* rlm_trajectory_event_new_in(
+    RlmArena* arena,
+    RlmTrajectoryEventType event_type,
+    uint32_t depth,
+    const char* content);
+
+/**
+ * Arena counterparts of the matching string accessors. The objects may come
+ * from the arena or from the regular constructors.
+ * @return String owned by `arena`, or NULL on error (or no timestamp)
+ */
+const char* rlm_message_timestamp_in(RlmArena* arena, const RlmMessage* msg);
+const char* rlm_node_id_in(RlmArena* arena, const RlmNode* node);
+const char* rlm_node_to_json_in(RlmArena* arena, const RlmNode* node);
+const char* rlm_trajectory_event_log_line_in(RlmArena* arena, const RlmTrajectoryEvent* event);
+const char* rlm_trajectory_event_to_json_in(RlmArena* arena, const RlmTrajectoryEvent* event);
+
 /* ============================================================================
  * PatternClassifier
  * ============================================================================ */
@@ -209,6 +395,26 @@ RlmActivationDecision* rlm_pattern_classifier_should_activate(
     const char* query,
     const RlmSessionContext* ctx);
 
+/**
+ * Per-session state for incremental classification. Each call with the same
+ * session only scans messages and files added since the last call. Reset the
+ * session after replacing or rewriting the context.
+ */
+RlmClassifierSession* rlm_classifier_session_new(void);
+void rlm_classifier_session_reset(RlmClassifierSession* session);
+void rlm_classifier_session_free(RlmClassifierSession* session);
+
+/**
+ * Same result as rlm_pattern_classifier_should_activate(), computed from the
+ * state cached in `session`.
+ * @return Decision (must be freed with rlm_activation_decision_free), or NULL on error
+ */
+RlmActivationDecision* rlm_pattern_classifier_should_activate_incremental(
+    const RlmPatternClassifier* classifier,
+    RlmClassifierSession* session,
+    const char* query,
+    const RlmSessionContext* ctx);
+
 /* ============================================================================
  * ActivationDecision
  * ============================================================================ */
@@ -216,6 +422,7 @@ RlmActivationDecision* rlm_pattern_classifier_should_activate(
 void rlm_activation_decision_free(RlmActivationDecision* decision);
 int rlm_activation_decision_should_activate(const RlmActivationDecision* decision);
 char* rlm_activation_decision_reason(const RlmActivationDecision* decision);
+RlmStrView rlm_activation_decision_reason_view(const RlmActivationDecision* decision);
 int rlm_activation_decision_score(const RlmActivationDecision* decision);
 
 /* ============================================================================
@@ -224,20 +431,124 @@ int rlm_activation_decision_score(const RlmActivationDecision* decision);
 
 RlmMemoryStore* rlm_memory_store_in_memory(void);
 RlmMemoryStore* rlm_memory_store_open(const char* path);
+
+/**
+ * Open or create a memory store with tuning options.
+ *
+ * File-backed stores run in WAL mode with one writer connection and a pool of
+ * read-only connections, so queries proceed concurrently with writes.
+ *
+ * @param path Path to the database file
+ * @param options_json JSON object (may be NULL for defaults):
+ *   `{"reader_pool_size": 4, "synchronous": "NORMAL", "busy_timeout_ms": 5000,
+ *     "statement_cache_capacity": 64}`
+ * @return Store pointer (must be freed with rlm_memory_store_free), or NULL on error
+ */
+RlmMemoryStore* rlm_memory_store_open_with_options(const char* path, const char* options_json);
+
 void rlm_memory_store_free(RlmMemoryStore* store);
 int rlm_memory_store_add_node(const RlmMemoryStore* store, const RlmNode* node);
+
+/**
+ * Add many nodes in one transaction (all-or-nothing).
+ * @param store Memory store
+ * @param nodes Array of `n` node pointers
+ * @param n Number of nodes
+ * @return Number of nodes inserted, or -1 on failure
+ */
+int64_t rlm_memory_store_add_nodes(const RlmMemoryStore* store, const RlmNode* const* nodes, size_t n);
+
+/**
+ * Update many nodes in one transaction (all-or-nothing).
+ * @return Number of nodes written, or -1 on failure
+ */
+int64_t rlm_memory_store_update_nodes(const RlmMemoryStore* store, const RlmNode* const* nodes, size_t n);
+
 RlmNode* rlm_memory_store_get_node(const RlmMemoryStore* store, const char* node_id);
 int rlm_memory_store_update_node(const RlmMemoryStore* store, const RlmNode* node);
 int rlm_memory_store_delete_node(const RlmMemoryStore* store, const char* node_id);
 char* rlm_memory_store_query_by_type(const RlmMemoryStore* store, RlmNodeType node_type, int64_t limit);
 char* rlm_memory_store_query_by_tier(const RlmMemoryStore* store, RlmTier tier, int64_t limit);
 char* rlm_memory_store_search_content(const RlmMemoryStore* store, const char* query, int64_t limit);
+
+/**
+ * Approximate nearest-neighbour search over node embeddings (cosine
+ * similarity, HNSW). Sees writes from other handles and processes; the index
+ * is persisted next to the database file.
+ * @param store Memory store
+ * @param query Query vector of `dim` floats
+ * @param dim Query dimension; must match the indexed embeddings
+ * @param k Maximum number of results
+ * @param tier_filter RlmTier value, or negative to search all tiers
+ * @return JSON array of {"id", "score"}, best first (must be freed with rlm_string_free), or NULL on error
+ */
+char* rlm_memory_store_search_embedding(const RlmMemoryStore* store, const float* query, size_t dim, int64_t k, int32_t tier_filter);
+
+/**
+ * Hybrid full-text + embedding search, fused by reciprocal rank.
+ * @param text FTS5 query string
+ * @return JSON array of {"id", "score"} with fused scores, or NULL on error
+ */
+char* rlm_memory_store_search_hybrid(const RlmMemoryStore* store, const char* text, const float* query, size_t dim, int64_t k, int32_t tier_filter);
+
 char* rlm_memory_store_promote(const RlmMemoryStore* store, const char* node_ids_json, const char* reason);
 char* rlm_memory_store_decay(const RlmMemoryStore* store, double factor, double min_confidence);
+
+/**
+ * Start background decay/consolidation in bounded batches.
+ *
+ * Each sweep decays every node (as rlm_memory_store_decay) and then promotes
+ * the nodes of each listed tier, one transaction per batch.
+ *
+ * @param store Memory store (may be freed independently of the scheduler)
+ * @param options_json JSON object (may be NULL for defaults):
+ *   `{"decay_factor": 0.95, "min_confidence": 0.1, "consolidate_tiers": ["task"],
+ *     "batch_size": 500, "batch_pause_ms": 10, "sweep_interval_ms": 86400000}`
+ * @return Scheduler (must be freed with rlm_memory_maintenance_free), or NULL on error
+ */
+RlmMemoryMaintenance* rlm_memory_maintenance_start(const RlmMemoryStore* store, const char* options_json);
+
+/**
+ * Start the next sweep now instead of waiting for the interval.
+ */
+void rlm_memory_maintenance_trigger(const RlmMemoryMaintenance* maintenance);
+
+/**
+ * Get maintenance counters.
+ * @return JSON `{"sweeps", "batches", "decayed", "promoted", "errors", "last_error"}`
+ *   (must be freed with rlm_string_free), or NULL on error
+ */
+char* rlm_memory_maintenance_stats(const RlmMemoryMaintenance* maintenance);
+
+/**
+ * Stop the scheduler after its current batch and free it.
+ */
+void rlm_memory_maintenance_free(RlmMemoryMaintenance* maintenance);
+
 char* rlm_memory_store_stats(const RlmMemoryStore* store);
 int rlm_memory_store_add_edge(const RlmMemoryStore* store, const RlmHyperEdge* edge);
+
+/**
+ * Add many hyperedges in one transaction (all-or-nothing).
+ * @param store Memory store
+ * @param edges Array of `n` edge pointers
+ * @param n Number of edges
+ * @return Number of edges inserted, or -1 on failure
+ */
+int64_t rlm_memory_store_add_edges(const RlmMemoryStore* store, const RlmHyperEdge* const* edges, size_t n);
+
 char* rlm_memory_store_get_edges_for_node(const RlmMemoryStore* store, const char* node_id);
 
+/**
+ * Expand the k-hop neighbourhood of a node in a single call.
+ * @param store Memory store
+ * @param node_id Origin node UUID
+ * @param depth Maximum number of hops from the origin
+ * @param limit Maximum number of nodes to return (negative for no limit)
+ * @return JSON `{"nodes": [...], "edges": [...]}` (must be freed with rlm_string_free), or NULL on error
+ */
+char* rlm_memory_store_neighborhood(const RlmMemoryStore* store, const char* node_id, uint32_t depth, int64_t limit);
+
 /* ============================================================================
  * Node
  * ============================================================================ */
@@ -248,9 +559,11 @@ void rlm_node_free(RlmNode* node);
 char* rlm_node_id(const RlmNode* node);
 RlmNodeType rlm_node_type(const RlmNode* node);
 char* rlm_node_content(const RlmNode* node);
+RlmStrView rlm_node_content_view(const RlmNode* node);
 RlmTier rlm_node_tier(const RlmNode* node);
 double rlm_node_confidence(const RlmNode* node);
 char* rlm_node_subtype(const RlmNode* node);
+RlmStrView rlm_node_subtype_view(const RlmNode* node);
 int rlm_node_set_subtype(RlmNode* node, const char* subtype);
 int rlm_node_set_tier(RlmNode* node, RlmTier tier);
 int rlm_node_set_confidence(RlmNode* node, double confidence);
@@ -271,10 +584,77 @@ void rlm_hyperedge_free(RlmHyperEdge* edge);
 char* rlm_hyperedge_id(const RlmHyperEdge* edge);
 char* rlm_hyperedge_type(const RlmHyperEdge* edge);
 char* rlm_hyperedge_label(const RlmHyperEdge* edge);
+RlmStrView rlm_hyperedge_label_view(const RlmHyperEdge* edge);
 double rlm_hyperedge_weight(const RlmHyperEdge* edge);
 char* rlm_hyperedge_node_ids(const RlmHyperEdge* edge);
 int rlm_hyperedge_contains(const RlmHyperEdge* edge, const char* node_id);
 
+/* ============================================================================
+ * Result Lists
+ *
+ * Handle-based alternatives to the JSON query functions. Results are read
+ * through the regular node/edge accessors without any JSON encode/decode.
+ * ============================================================================ */
+
+/**
+ * Memory store statistics in a fixed layout.
+ * `nodes_by_tier` is indexed by RlmTier and `nodes_by_type` by RlmNodeType.
+ */
+typedef struct {
+    uint64_t total_nodes;
+    uint64_t total_edges;
+    uint64_t nodes_by_tier[4];
+    uint64_t nodes_by_type[5];
+} RlmMemoryStats;
+
+/** @return Node list (must be freed with rlm_node_list_free), or NULL on error */
+RlmNodeList* rlm_memory_store_query_by_type_list(const RlmMemoryStore* store, RlmNodeType node_type, int64_t limit);
+/** @return Node list (must be freed with rlm_node_list_free), or NULL on error */
+RlmNodeList* rlm_memory_store_query_by_tier_list(const RlmMemoryStore* store, RlmTier tier, int64_t limit);
+/** @return Node list (must be freed with rlm_node_list_free), or NULL on error */
+RlmNodeList* rlm_memory_store_search_content_list(const RlmMemoryStore* store, const char* query, int64_t limit);
+/** @return Edge list (must be freed with rlm_hyperedge_list_free), or NULL on error */
+RlmHyperEdgeList* rlm_memory_store_get_edges_for_node_list(const RlmMemoryStore* store, const char* node_id);
+
+/**
+ * Fill `out` with store statistics.
+ * @return 0 on success, -1 on error
+ */
+int rlm_memory_store_stats_into(const RlmMemoryStore* store, RlmMemoryStats* out);
+
+size_t rlm_node_list_len(const RlmNodeList* list);
+
+/**
+ * Borrow the node at `index`.
+ * @return Node owned by the list (do NOT free), or NULL if out of range
+ */
+const RlmNode* rlm_node_list_get(const RlmNodeList* list, size_t index);
+void rlm_node_list_free(RlmNodeList* list);
+
+size_t rlm_hyperedge_list_len(const RlmHyperEdgeList* list);
+
+/**
+ * Borrow the edge at `index`.
+ * @return Edge owned by the list (do NOT free), or NULL if out of range
+ */
+const RlmHyperEdge* rlm_hyperedge_list_get(const RlmHyperEdgeList* list, size_t index);
+void rlm_hyperedge_list_free(RlmHyperEdgeList* list);
+
+/**
+ * Copy a node's 16-byte binary UUID into `out` without allocating.
+ * @return 0 on success, -1 on error
+ */
+int rlm_node_id_bytes(const RlmNode* node, uint8_t* out);
+
+size_t rlm_hyperedge_member_count(const RlmHyperEdge* edge);
+
+/**
+ * Copy the 16-byte binary UUID of member `index` into `out`.
+ * @return 0 on success, -1 on error
+ */
+int rlm_hyperedge_member_id_bytes(const RlmHyperEdge* edge, size_t index, uint8_t* out);
+RlmStrView rlm_hyperedge_member_role_view(const RlmHyperEdge* edge, size_t index);
+
 /* ============================================================================
  * TrajectoryEvent
  * ============================================================================ */
@@ -293,6 +673,7 @@ void rlm_trajectory_event_free(RlmTrajectoryEvent* event);
 RlmTrajectoryEventType rlm_trajectory_event_type(const RlmTrajectoryEvent* event);
 uint32_t rlm_trajectory_event_depth(const RlmTrajectoryEvent* event);
 char* rlm_trajectory_event_content(const RlmTrajectoryEvent* event);
+RlmStrView rlm_trajectory_event_content_view(const RlmTrajectoryEvent* event);
 char* rlm_trajectory_event_timestamp(const RlmTrajectoryEvent* event);
 char* rlm_trajectory_event_log_line(const RlmTrajectoryEvent* event);
 int rlm_trajectory_event_is_error(const RlmTrajectoryEvent* event);
@@ -301,6 +682,62 @@ char* rlm_trajectory_event_to_json(const RlmTrajectoryEvent* event);
 RlmTrajectoryEvent* rlm_trajectory_event_from_json(const char* json);
 char* rlm_trajectory_event_type_name(RlmTrajectoryEventType event_type);
 
+/* ============================================================================
+ * Trajectory Streaming
+ *
+ * A process-wide trajectory bus carrying every event the library emits plus
+ * those passed to rlm_trajectory_publish(). Subscriptions and sinks each run
+ * on their own thread behind a bounded ring buffer; when a consumer falls
+ * behind, events are dropped and counted rather than queued without bound.
+ * Filter masks are built with RLM_EVENT_MASK(); 0 selects every event type.
+ * ============================================================================ */
+
+/**
+ * Subscription callback. `event` is borrowed for the duration of the call.
+ */
+typedef void (*RlmTrajectoryCallback)(const RlmTrajectoryEvent* event, void* user_data);
+
+/**
+ * Publish a copy of `event` on the trajectory bus.
+ * @return Number of subscribers that will receive it, or -1 on error
+ */
+int64_t rlm_trajectory_publish(const RlmTrajectoryEvent* event);
+
+/**
+ * Deliver bus events matching `filter_mask` to `callback`, in order, on a
+ * library-owned thread. Do not call rlm_trajectory_unsubscribe() from inside
+ * the callback.
+ * @return Subscription id (> 0), or 0 on error
+ */
+uint64_t rlm_trajectory_subscribe(RlmTrajectoryCallback callback, uint32_t filter_mask, void* user_data);
+
+/**
+ * Cancel a subscription after delivering events already queued for it.
+ * @return 0 on success, -1 if `id` is unknown
+ */
+int rlm_trajectory_unsubscribe(uint64_t id);
+
+/**
+ * Stream bus events to a file (appending) as JSON Lines or a binary log.
+ * @return Sink (must be released with rlm_trajectory_sink_close), or NULL on error
+ */
+RlmTrajectorySink* rlm_trajectory_sink_open(const char* path, RlmTrajectorySinkFormat format, uint32_t filter_mask);
+
+/**
+ * Stream bus events to a duplicate of `fd` (POSIX only); the caller keeps `fd`.
+ * @return Sink (must be released with rlm_trajectory_sink_close), or NULL on error
+ */
+RlmTrajectorySink* rlm_trajectory_sink_open_fd(int fd, RlmTrajectorySinkFormat format, uint32_t filter_mask);
+
+uint64_t rlm_trajectory_sink_delivered(const RlmTrajectorySink* sink);
+uint64_t rlm_trajectory_sink_dropped(const RlmTrajectorySink* sink);
+
+/**
+ * Flush pending events, close and free the sink.
+ * @return 0 on success, -1 if a write failed
+ */
+int rlm_trajectory_sink_close(RlmTrajectorySink* sink);
+
 /* ============================================================================
  * REPL Configuration
  * ============================================================================ */
@@ -323,6 +760,11 @@ RlmReplHandle* rlm_repl_handle_spawn_default(void);
 
 /**
  * Spawn a new REPL subprocess with custom configuration.
+ *
+ * Set `"startup_mode": "fork_server"` (Unix only) to fork the REPL from a shared,
+ * pre-imported fork server instead of booting a new interpreter.
+ * Values at or above `"shm_threshold_bytes"` (0 disables) are exchanged through
+ * shared-memory segments instead of inline JSON.
  * @param config_json JSON string with configuration options
  * @return Handle pointer (must be freed with rlm_repl_handle_free), or NULL on error
  */
@@ -403,13 +845,54 @@ int rlm_repl_handle_shutdown(RlmReplHandle* handle);
  */
 int rlm_repl_handle_is_alive(RlmReplHandle* handle);
 
+/* ============================================================================
+ * Pipelined REPL requests
+ * ============================================================================ */
+
+/**
+ * Start executing Python code without waiting for the result.
+ * Several requests may be in flight on one handle at once.
+ * @param handle REPL handle
+ * @param code Python code to execute
+ * @return Pending request (must be freed with rlm_repl_pending_free), or NULL on error
+ */
+RlmReplPending* rlm_repl_handle_execute_async(RlmReplHandle* handle, const char* code);
+
+/**
+ * Request a variable from the REPL namespace without waiting for the value.
+ * @param handle REPL handle
+ * @param name Variable name
+ * @return Pending request (must be freed with rlm_repl_pending_free), or NULL on error
+ */
+RlmReplPending* rlm_repl_handle_get_variable_async(RlmReplHandle* handle, const char* name);
+
+/**
+ * Check without blocking whether a pending request has completed (or failed/timed out).
+ * @param pending Pending request
+ * @return 1 if rlm_repl_pending_wait would not block, 0 if still in flight, -1 on error
+ */
+int rlm_repl_pending_poll(RlmReplPending* pending);
+
+/**
+ * Block until a pending request completes and take its result (at most once).
+ * @param pending Pending request
+ * @return Same JSON as the blocking call (must be freed with rlm_string_free), or NULL on error
+ */
+char* rlm_repl_pending_wait(RlmReplPending* pending);
+
+/**
+ * Free a pending request, abandoning it if it has not completed.
+ * @param pending Pending request to free (may be NULL)
+ */
+void rlm_repl_pending_free(RlmReplPending* pending);
+
 /* ============================================================================
  * ReplPool - Pool of REPL subprocesses
  * ============================================================================ */
 
 /**
  * Create a new REPL pool with default configuration.
- * @param max_size Maximum number of REPL handles to keep in the pool
+ * @param max_size Maximum number of live REPL handles (0 for unbounded)
  * @return Pool pointer (must be freed with rlm_repl_pool_free)
  */
 RlmReplPool* rlm_repl_pool_new_default(size_t max_size);
@@ -417,7 +900,7 @@ RlmReplPool* rlm_repl_pool_new_default(size_t max_size);
 /**
  * Create a new REPL pool with custom configuration.
  * @param config_json JSON string with configuration options
- * @param max_size Maximum number of REPL handles to keep in the pool
+ * @param max_size Maximum number of live REPL handles (0 for unbounded)
  * @return Pool pointer (must be freed with rlm_repl_pool_free), or NULL on error
  */
 RlmReplPool* rlm_repl_pool_new(const char* config_json, size_t max_size);
@@ -430,6 +913,9 @@ void rlm_repl_pool_free(RlmReplPool* pool);
 
 /**
  * Acquire a REPL handle from the pool.
+ *
+ * Reuses an idle handle, spawns one if below max_size, or waits up to the
+ * pool's acquire timeout for a release.
  * @param pool REPL pool
  * @return Handle pointer (must be freed with rlm_repl_handle_free or returned with rlm_repl_pool_release), or NULL on error
  */
@@ -442,6 +928,29 @@ RlmReplHandle* rlm_repl_pool_acquire(const RlmReplPool* pool);
  */
 void rlm_repl_pool_release(const RlmReplPool* pool, RlmReplHandle* handle);
 
+/**
+ * Create a REPL pool with sizing and timing options.
+ * @param config_json REPL configuration JSON, or NULL for defaults
+ * @param options_json JSON with optional `min_idle`, `max_size`,
+ *        `acquire_timeout_ms` and `health_check_interval_ms`, or NULL for defaults
+ * @return Pool pointer (must be freed with rlm_repl_pool_free), or NULL on error
+ */
+RlmReplPool* rlm_repl_pool_new_with_options(const char* config_json, const char* options_json);
+
+/**
+ * Acquire a REPL handle, waiting at most `timeout_ms` for one to free up.
+ * @return Handle pointer, or NULL on error or timeout
+ */
+RlmReplHandle* rlm_repl_pool_acquire_timeout(const RlmReplPool* pool, uint64_t timeout_ms);
+
+/**
+ * Get pool statistics.
+ * @return JSON with idle, busy, spawning, spawned, spawn_failures,
+ *         acquire_timeouts and a spawn_latency_ms histogram
+ *         (must be freed with rlm_string_free), or NULL on error
+ */
+char* rlm_repl_pool_stats(const RlmReplPool* pool);
+
 /* ============================================================================
  * Epistemic Verification - ClaimExtractor
  * ============================================================================ */
@@ -477,6 +986,16 @@ char* rlm_claim_extractor_extract(RlmClaimExtractor* extractor, const char* resp
  */
 char* rlm_claim_extractor_extract_high_specificity(RlmClaimExtractor* extractor, const char* response, double threshold);
 
+/**
+ * Extract claims from several responses at once (parallel for large batches).
+ * @param extractor Claim extractor
+ * @param responses Array of `count` response strings (may be NULL if count is 0)
+ * @param count Number of responses
+ * @return JSON array with one array of claims per response, in input order
+ *         (must be freed with rlm_string_free), or NULL on error
+ */
+char* rlm_claim_extractor_extract_batch(RlmClaimExtractor* extractor, const char* const* responses, size_t count);
+
 /* ============================================================================
  * Epistemic Verification - EvidenceScrubber
  * ============================================================================ */
@@ -963,7 +1482,8 @@ RlmCostTracker* rlm_cost_tracker_new(void);
 void rlm_cost_tracker_free(RlmCostTracker* tracker);
 
 /**
- * Record token usage from a completion.
+ * Record token usage from a completion. Safe to call concurrently on the
+ * same tracker from multiple threads.
  * @param tracker Cost tracker
  * @param model Model name
  * @param input_tokens Input token count
@@ -1041,6 +1561,54 @@ char* rlm_cost_tracker_to_json(const RlmCostTracker* tracker);
  */
 RlmCostTracker* rlm_cost_tracker_from_json(const char* json);
 
+/** Token and cost counters for one tier or model. */
+typedef struct RlmUsageCosts {
+    uint64_t input_tokens;
+    uint64_t output_tokens;
+    uint64_t request_count;
+    double cost;
+} RlmUsageCosts;
+
+/** Cost tracker totals; `tiers` is indexed root, recursive, extraction. */
+typedef struct RlmCostSnapshot {
+    uint64_t input_tokens;
+    uint64_t output_tokens;
+    uint64_t cache_read_tokens;
+    uint64_t cache_creation_tokens;
+    uint64_t request_count;
+    double total_cost;
+    RlmUsageCosts tiers[3];
+} RlmCostSnapshot;
+
+/**
+ * Fill a fixed-layout snapshot of the tracker totals without JSON.
+ * Safe to call while other threads record into the same tracker.
+ * @param tracker Cost tracker
+ * @param out Destination snapshot
+ * @return 0 on success, -1 on failure
+ */
+int rlm_cost_tracker_snapshot_into(const RlmCostTracker* tracker, RlmCostSnapshot* out);
+
+/**
+ * Number of models tracked, for use with rlm_cost_tracker_model_costs_into.
+ */
+size_t rlm_cost_tracker_model_count(const RlmCostTracker* tracker);
+
+/**
+ * Fill the costs of the model at `index`.
+ * @param tracker Cost tracker
+ * @param index Model index in [0, rlm_cost_tracker_model_count)
+ * @param out Destination costs
+ * @param name Receives a view of the model name valid until the tracker is
+ *             freed (may be NULL)
+ * @return 0 on success, -1 if index is out of range
+ */
+int rlm_cost_tracker_model_costs_into(
+    const RlmCostTracker* tracker,
+    size_t index,
+    RlmUsageCosts* out,
+    RlmStrView* name);
+
 /* ============================================================================
  * Cost Calculation Helpers
  * ============================================================================ */
@@ -1081,6 +1649,109 @@ char* rlm_model_spec_json(const char* model_name);
  */
 uint64_t rlm_effective_input_tokens(uint64_t input_tokens, uint64_t cache_read_tokens);
 
+/* ============================================================================
+ * LLM Provider Limiters - Live admission-control state
+ * ============================================================================ */
+
+/**
+ * Get the state of every live provider limiter.
+ *
+ * Each batch executor owns one limiter for its provider (AIMD concurrency,
+ * request and token budgets, Retry-After pauses). Each array element has:
+ * id, provider, concurrency_limit, in_flight, waiting, requests_available,
+ * tokens_available, paused_for_ms, latency_ewma_ms, latency_baseline_ms,
+ * admitted, throttled, coalesced and config.
+ *
+ * @return JSON array (must be freed with rlm_string_free), or NULL on error
+ */
+char* rlm_llm_limiter_state_json(void);
+
+/* ============================================================================
+ * Metrics - Hot-path latency histograms and tracing spans
+ * ============================================================================ */
+
+/**
+ * Instrumented operations; indexes RlmMetricsSnapshot.samples.
+ *
+ * REPL_ROUND_TRIP: request written until its response is routed back.
+ * REPL_SPAWN: REPL process spawn or fork until ready.
+ * SQLITE_QUERY: SQLite work while holding a memory-store connection.
+ * STORE_LOCK_WAIT: wait for the memory-store writer lock or a pooled reader.
+ * LLM_CALL: LLM provider call, per attempt.
+ * LLM_QUEUE: wait for batch rate-limiter capacity.
+ * SCRUB / CLAIM_EXTRACT: evidence scrubbing and claim extraction per text.
+ */
+typedef enum {
+    RLM_METRIC_REPL_ROUND_TRIP = 0,
+    RLM_METRIC_REPL_SPAWN = 1,
+    RLM_METRIC_SQLITE_QUERY = 2,
+    RLM_METRIC_STORE_LOCK_WAIT = 3,
+    RLM_METRIC_LLM_CALL = 4,
+    RLM_METRIC_LLM_QUEUE = 5,
+    RLM_METRIC_SCRUB = 6,
+    RLM_METRIC_CLAIM_EXTRACT = 7
+} RlmMetric;
+
+#define RLM_METRIC_COUNT 8
+
+/**
+ * Latency summary of one metric since the last reset, in nanoseconds.
+ * Percentiles come from log-linear buckets and are within 12.5% of exact.
+ */
+typedef struct RlmMetricSample {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t p50_ns;
+    uint64_t p95_ns;
+    uint64_t p99_ns;
+} RlmMetricSample;
+
+/** Every metric; `samples` is indexed by RlmMetric. */
+typedef struct RlmMetricsSnapshot {
+    RlmMetricSample samples[RLM_METRIC_COUNT];
+} RlmMetricsSnapshot;
+
+/**
+ * Fill a fixed-layout snapshot of every metric without serializing.
+ * Safe to call while other threads record.
+ * @param out Destination snapshot
+ * @return 0 on success, -1 on failure
+ */
+int rlm_metrics_snapshot(RlmMetricsSnapshot* out);
+
+/**
+ * Render every metric in the Prometheus text exposition format, as a
+ * `summary` family `rlm_<name>_seconds` plus a `rlm_<name>_seconds_max` gauge.
+ * @return Text (must be freed with rlm_string_free), or NULL on error
+ */
+char* rlm_metrics_prometheus(void);
+
+/**
+ * Clear every metric.
+ */
+void rlm_metrics_reset(void);
+
+/**
+ * Get the snake_case name of a metric, as used in the Prometheus output.
+ * @param metric Metric
+ * @return Static string (do not free)
+ */
+const char* rlm_metric_name(RlmMetric metric);
+
+/**
+ * Turn `tracing` spans named "rlm_op" around instrumented operations on or
+ * off. Spans start as set by the RLM_TRACE_SPANS environment variable.
+ * @param enabled Non-zero to enable, 0 to disable
+ */
+void rlm_metrics_set_tracing(int enabled);
+
+/**
+ * Check whether `tracing` spans are enabled.
+ * @return 1 if enabled, 0 if not
+ */
+int rlm_metrics_tracing_enabled(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1119 @@
+/**
+ * @file rlm_core.hpp
+ * @brief Header-only C++17 wrapper over the rlm-core C API
+ *
+ * Every library object is held by a move-only RAII type that frees it on
+ * destruction, and every library-allocated string is held by `rlm::String`,
+ * which frees it with `rlm_string_free()` and reads as a `std::string_view`
+ * without copying.
+ *
+ * ## Error Handling
+ *
+ * Calls that can fail throw `rlm::Error` carrying `rlm_last_error()`.
+ * Accessors marked `noexcept` read fields directly and never allocate;
+ * accessors returning `std::string_view` borrow from the owning object and
+ * are valid until it is mutated or destroyed.
+ *
+ * ## Strings In
+ *
+ * The C API takes NUL-terminated strings, so string parameters accept
+ * `const char*`, `std::string` or `rlm::String` (`rlm::CStr`) and are passed
+ * through without copying.
+ */
+
+#ifndef RLM_CORE_HPP
+#define RLM_CORE_HPP
+
+#include "rlm_core.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace rlm {
+
+/* ============================================================================
+ * Errors and Strings
+ * ============================================================================ */
+
+/** Error reported by the library through `rlm_last_error()`. */
+class Error : public std::runtime_error {
+public:
+    explicit Error(const std::string& message) : std::runtime_error(message) {}
+
+    /** Build an error from the calling thread's last error. */
+    static Error last() {
+        const char* message = rlm_last_error();
+        return Error(message ? message : "unknown error");
+    }
+};
+
+/** 16-byte binary UUID, as filled by `rlm_node_id_bytes()`. */
+using Uuid = std::array<uint8_t, 16>;
+
+/**
+ * Owned, NUL-terminated string allocated by the library.
+ *
+ * Behaves like `std::unique_ptr<char, rlm_string_free>`: move-only, freed on
+ * destruction, and convertible to `std::string_view` without copying.
+ */
+class String {
+public:
+    String() noexcept = default;
+
+    /** Take ownership of `ptr` (may be NULL). */
+    explicit String(char* ptr) noexcept : ptr_(ptr), len_(ptr ? std::strlen(ptr) : 0) {}
+
+    String(String&& other) noexcept
+        : ptr_(std::exchange(other.ptr_, nullptr)), len_(std::exchange(other.len_, 0)) {}
+
+    String& operator=(String&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ptr_ = std::exchange(other.ptr_, nullptr);
+            len_ = std::exchange(other.len_, 0);
+        }
+        return *this;
+    }
+
+    String(const String&) = delete;
+    String& operator=(const String&) = delete;
+
+    ~String() { reset(); }
+
+    const char* c_str() const noexcept { return ptr_ ? ptr_ : ""; }
+    const char* data() const noexcept { return c_str(); }
+    size_t size() const noexcept { return len_; }
+    bool empty() const noexcept { return len_ == 0; }
+    explicit operator bool() const noexcept { return ptr_ != nullptr; }
+
+    std::string_view view() const noexcept { return {c_str(), len_}; }
+    operator std::string_view() const noexcept { return view(); }
+
+    /** Copy into a `std::string`. */
+    std::string str() const { return std::string(view()); }
+
+    /** Give up ownership; the caller must free the result with `rlm_string_free()`. */
+    char* release() noexcept {
+        len_ = 0;
+        return std::exchange(ptr_, nullptr);
+    }
+
+    void reset() noexcept {
+        rlm_string_free(std::exchange(ptr_, nullptr));
+        len_ = 0;
+    }
+
+private:
+    char* ptr_ = nullptr;
+    size_t len_ = 0;
+};
+
+/** Borrowed NUL-terminated string argument; never copies. */
+class CStr {
+public:
+    CStr(const char* s) noexcept : ptr_(s) {}
+    CStr(std::nullptr_t) noexcept : ptr_(nullptr) {}
+    CStr(const std::string& s) noexcept : ptr_(s.c_str()) {}
+    CStr(const String& s) noexcept : ptr_(s.c_str()) {}
+
+    const char* get() const noexcept { return ptr_; }
+
+private:
+    const char* ptr_;
+};
+
+/** View an `RlmStrView`; an absent value reads as empty. */
+inline std::string_view view(RlmStrView s) noexcept {
+    return s.ptr ? std::string_view(s.ptr, s.len) : std::string_view();
+}
+
+/** View an `RlmStrView`, keeping absent values distinct from empty ones. */
+inline std::optional<std::string_view> view_opt(RlmStrView s) noexcept {
+    if (!s.ptr) {
+        return std::nullopt;
+    }
+    return std::string_view(s.ptr, s.len);
+}
+
+/**
+ * Contiguous, non-owning range of `T`, for batch calls (C++17 lacks
+ * `std::span`). Converts implicitly from arrays, `std::array` and
+ * `std::vector`.
+ */
+template <typename T>
+class Span {
+public:
+    constexpr Span() noexcept = default;
+    constexpr Span(T* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    template <size_t N>
+    constexpr Span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+
+    template <typename Container,
+              typename = std::enable_if_t<std::is_convertible_v<
+                  decltype(std::data(std::declval<Container&>())), T*>>>
+    constexpr Span(Container& container) noexcept
+        : data_(std::data(container)), size_(std::size(container)) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr T* begin() const noexcept { return data_; }
+    constexpr T* end() const noexcept { return data_ + size_; }
+    constexpr T& operator[](size_t i) const noexcept { return data_[i]; }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+namespace detail {
+
+template <typename T, void (*Free)(T*)>
+struct Deleter {
+    void operator()(T* ptr) const noexcept { Free(ptr); }
+};
+
+template <typename T, void (*Free)(T*)>
+using Owned = std::unique_ptr<T, Deleter<T, Free>>;
+
+/** Throw the last error if `status` is negative; otherwise return it. */
+template <typename Int>
+inline Int check(Int status) {
+    if (status < 0) {
+        throw Error::last();
+    }
+    return status;
+}
+
+/** Throw the last error if `ptr` is NULL; otherwise return it. */
+template <typename T>
+inline T* check_ptr(T* ptr) {
+    if (!ptr) {
+        throw Error::last();
+    }
+    return ptr;
+}
+
+/** Take ownership of a returned string, throwing if it is NULL. */
+inline String check_str(char* ptr) { return String(check_ptr(ptr)); }
+
+/** Handles of `items`, for the `const T* const*` batch entry points. */
+template <typename Handle, typename Raw>
+inline std::vector<const Raw*> handles(Span<const Handle> items) {
+    std::vector<const Raw*> out;
+    out.reserve(items.size());
+    for (const Handle& item : items) {
+        out.push_back(item.get());
+    }
+    return out;
+}
+
+/** Random-access iterator over a result list, by index. */
+template <typename List, typename Ref>
+class ListIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = Ref;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = Ref;
+
+    ListIterator(const List* list, size_t index) noexcept : list_(list), index_(index) {}
+
+    Ref operator*() const noexcept { return (*list_)[index_]; }
+    Ref operator[](difference_type n) const noexcept { return (*list_)[index_ + n]; }
+    ListIterator& operator++() noexcept { ++index_; return *this; }
+    ListIterator operator++(int) noexcept { ListIterator it = *this; ++index_; return it; }
+    ListIterator& operator--() noexcept { --index_; return *this; }
+    ListIterator operator--(int) noexcept { ListIterator it = *this; --index_; return it; }
+    ListIterator& operator+=(difference_type n) noexcept { index_ += n; return *this; }
+    ListIterator& operator-=(difference_type n) noexcept { index_ -= n; return *this; }
+    ListIterator operator+(difference_type n) const noexcept { return ListIterator(list_, index_ + n); }
+    ListIterator operator-(difference_type n) const noexcept { return ListIterator(list_, index_ - n); }
+    difference_type operator-(const ListIterator& other) const noexcept {
+        return static_cast<difference_type>(index_) - static_cast<difference_type>(other.index_);
+    }
+    bool operator==(const ListIterator& other) const noexcept { return index_ == other.index_; }
+    bool operator!=(const ListIterator& other) const noexcept { return index_ != other.index_; }
+    bool operator<(const ListIterator& other) const noexcept { return index_ < other.index_; }
+
+private:
+    const List* list_;
+    size_t index_;
+};
+
+} // namespace detail
+
+/* ============================================================================
+ * Node and HyperEdge
+ * ============================================================================ */
+
+namespace detail {
+
+/** Read accessors shared by owned and borrowed nodes. */
+template <typename Derived>
+class NodeReader {
+public:
+    /** @return Node id as UUID text */
+    String id() const { return check_str(rlm_node_id(raw())); }
+
+    /** Binary node id, without allocating. */
+    Uuid id_bytes() const {
+        Uuid out{};
+        check(rlm_node_id_bytes(raw(), out.data()));
+        return out;
+    }
+
+    RlmNodeType type() const noexcept { return rlm_node_type(raw()); }
+    RlmTier tier() const noexcept { return rlm_node_tier(raw()); }
+    double confidence() const noexcept { return rlm_node_confidence(raw()); }
+    uint64_t access_count() const noexcept { return rlm_node_access_count(raw()); }
+    std::string_view content() const noexcept { return view(rlm_node_content_view(raw())); }
+
+    std::optional<std::string_view> subtype() const noexcept {
+        return view_opt(rlm_node_subtype_view(raw()));
+    }
+
+    bool is_decayed(double min_confidence) const {
+        return check(rlm_node_is_decayed(raw(), min_confidence)) != 0;
+    }
+
+    int64_t age_hours() const noexcept { return rlm_node_age_hours(raw()); }
+    String to_json() const { return check_str(rlm_node_to_json(raw())); }
+
+private:
+    const RlmNode* raw() const noexcept { return static_cast<const Derived*>(this)->get(); }
+};
+
+/** Read accessors shared by owned and borrowed hyperedges. */
+template <typename Derived>
+class HyperEdgeReader {
+public:
+    String id() const { return check_str(rlm_hyperedge_id(raw())); }
+    String type() const { return check_str(rlm_hyperedge_type(raw())); }
+    double weight() const noexcept { return rlm_hyperedge_weight(raw()); }
+
+    std::optional<std::string_view> label() const noexcept {
+        return view_opt(rlm_hyperedge_label_view(raw()));
+    }
+
+    /** @return JSON array of member node ids */
+    String node_ids() const { return check_str(rlm_hyperedge_node_ids(raw())); }
+
+    bool contains(CStr node_id) const {
+        return check(rlm_hyperedge_contains(raw(), node_id.get())) != 0;
+    }
+
+    size_t member_count() const noexcept { return rlm_hyperedge_member_count(raw()); }
+
+    Uuid member_id_bytes(size_t index) const {
+        Uuid out{};
+        check(rlm_hyperedge_member_id_bytes(raw(), index, out.data()));
+        return out;
+    }
+
+    std::string_view member_role(size_t index) const noexcept {
+        return view(rlm_hyperedge_member_role_view(raw(), index));
+    }
+
+private:
+    const RlmHyperEdge* raw() const noexcept {
+        return static_cast<const Derived*>(this)->get();
+    }
+};
+
+} // namespace detail
+
+/** Node borrowed from a `NodeList` or `Arena`; valid while its owner is. */
+class NodeRef : public detail::NodeReader<NodeRef> {
+public:
+    explicit NodeRef(const RlmNode* node) noexcept : node_(node) {}
+    const RlmNode* get() const noexcept { return node_; }
+
+private:
+    const RlmNode* node_;
+};
+
+/** Owned memory node. */
+class Node : public detail::NodeReader<Node> {
+public:
+    Node(RlmNodeType type, CStr content)
+        : node_(detail::check_ptr(rlm_node_new(type, content.get()))) {}
+
+    Node(RlmNodeType type, CStr content, RlmTier tier, double confidence)
+        : node_(detail::check_ptr(rlm_node_new_full(type, content.get(), tier, confidence))) {}
+
+    /** Take ownership of `node` (must not be NULL). */
+    explicit Node(RlmNode* node) noexcept : node_(node) {}
+
+    static Node from_json(CStr json) {
+        return Node(detail::check_ptr(rlm_node_from_json(json.get())));
+    }
+
+    void set_subtype(CStr subtype) { detail::check(rlm_node_set_subtype(get_mut(), subtype.get())); }
+    void set_tier(RlmTier tier) { detail::check(rlm_node_set_tier(get_mut(), tier)); }
+    void set_confidence(double confidence) {
+        detail::check(rlm_node_set_confidence(get_mut(), confidence));
+    }
+    void record_access() { detail::check(rlm_node_record_access(get_mut())); }
+
+    const RlmNode* get() const noexcept { return node_.get(); }
+    RlmNode* get_mut() noexcept { return node_.get(); }
+    RlmNode* release() noexcept { return node_.release(); }
+    operator NodeRef() const noexcept { return NodeRef(get()); }
+
+private:
+    detail::Owned<RlmNode, rlm_node_free> node_;
+};
+
+/** Hyperedge borrowed from a `HyperEdgeList`; valid while the list is alive. */
+class HyperEdgeRef : public detail::HyperEdgeReader<HyperEdgeRef> {
+public:
+    explicit HyperEdgeRef(const RlmHyperEdge* edge) noexcept : edge_(edge) {}
+    const RlmHyperEdge* get() const noexcept { return edge_; }
+
+private:
+    const RlmHyperEdge* edge_;
+};
+
+/** Owned hyperedge. */
+class HyperEdge : public detail::HyperEdgeReader<HyperEdge> {
+public:
+    explicit HyperEdge(CStr edge_type)
+        : edge_(detail::check_ptr(rlm_hyperedge_new(edge_type.get()))) {}
+
+    /** Take ownership of `edge` (must not be NULL). */
+    explicit HyperEdge(RlmHyperEdge* edge) noexcept : edge_(edge) {}
+
+    /** Binary edge from `subject_id` to `object_id`; `label` may be NULL. */
+    static HyperEdge binary(CStr edge_type, CStr subject_id, CStr object_id, CStr label = nullptr) {
+        return HyperEdge(detail::check_ptr(rlm_hyperedge_binary(
+            edge_type.get(), subject_id.get(), object_id.get(), label.get())));
+    }
+
+    const RlmHyperEdge* get() const noexcept { return edge_.get(); }
+    RlmHyperEdge* release() noexcept { return edge_.release(); }
+    operator HyperEdgeRef() const noexcept { return HyperEdgeRef(get()); }
+
+private:
+    detail::Owned<RlmHyperEdge, rlm_hyperedge_free> edge_;
+};
+
+/** Query result of nodes, read in place without JSON. */
+class NodeList {
+public:
+    using iterator = detail::ListIterator<NodeList, NodeRef>;
+
+    explicit NodeList(RlmNodeList* list) noexcept : list_(list) {}
+
+    size_t size() const noexcept { return rlm_node_list_len(list_.get()); }
+    bool empty() const noexcept { return size() == 0; }
+
+    /** Borrow node `index`; `index` must be below `size()`. */
+    NodeRef operator[](size_t index) const noexcept {
+        return NodeRef(rlm_node_list_get(list_.get(), index));
+    }
+
+    iterator begin() const noexcept { return iterator(this, 0); }
+    iterator end() const noexcept { return iterator(this, size()); }
+
+    const RlmNodeList* get() const noexcept { return list_.get(); }
+
+private:
+    detail::Owned<RlmNodeList, rlm_node_list_free> list_;
+};
+
+/** Query result of hyperedges, read in place without JSON. */
+class HyperEdgeList {
+public:
+    using iterator = detail::ListIterator<HyperEdgeList, HyperEdgeRef>;
+
+    explicit HyperEdgeList(RlmHyperEdgeList* list) noexcept : list_(list) {}
+
+    size_t size() const noexcept { return rlm_hyperedge_list_len(list_.get()); }
+    bool empty() const noexcept { return size() == 0; }
+
+    /** Borrow edge `index`; `index` must be below `size()`. */
+    HyperEdgeRef operator[](size_t index) const noexcept {
+        return HyperEdgeRef(rlm_hyperedge_list_get(list_.get(), index));
+    }
+
+    iterator begin() const noexcept { return iterator(this, 0); }
+    iterator end() const noexcept { return iterator(this, size()); }
+
+    const RlmHyperEdgeList* get() const noexcept { return list_.get(); }
+
+private:
+    detail::Owned<RlmHyperEdgeList, rlm_hyperedge_list_free> list_;
+};
+
+/* ============================================================================
+ * MemoryStore
+ * ============================================================================ */
+
+/** Hypergraph memory store. Safe to share across threads by const reference. */
+class MemoryStore {
+public:
+    static MemoryStore in_memory() {
+        return MemoryStore(detail::check_ptr(rlm_memory_store_in_memory()));
+    }
+
+    static MemoryStore open(CStr path) {
+        return MemoryStore(detail::check_ptr(rlm_memory_store_open(path.get())));
+    }
+
+    /** @param options_json See `rlm_memory_store_open_with_options()` (may be NULL) */
+    static MemoryStore open(CStr path, CStr options_json) {
+        return MemoryStore(detail::check_ptr(
+            rlm_memory_store_open_with_options(path.get(), options_json.get())));
+    }
+
+    /** Take ownership of `store` (must not be NULL). */
+    explicit MemoryStore(RlmMemoryStore* store) noexcept : store_(store) {}
+
+    void add_node(const Node& node) const {
+        detail::check(rlm_memory_store_add_node(get(), node.get()));
+    }
+
+    /** Insert all nodes in one transaction, without copying the handles. */
+    size_t add_nodes(Span<const RlmNode* const> nodes) const {
+        return static_cast<size_t>(
+            detail::check(rlm_memory_store_add_nodes(get(), nodes.data(), nodes.size())));
+    }
+
+    /** Insert all nodes in one transaction. */
+    size_t add_nodes(Span<const Node> nodes) const {
+        auto raw = detail::handles<Node, RlmNode>(nodes);
+        return add_nodes(Span<const RlmNode* const>(raw.data(), raw.size()));
+    }
+
+    void update_node(const Node& node) const {
+        detail::check(rlm_memory_store_update_node(get(), node.get()));
+    }
+
+    /** Update all nodes in one transaction, without copying the handles. */
+    size_t update_nodes(Span<const RlmNode* const> nodes) const {
+        return static_cast<size_t>(
+            detail::check(rlm_memory_store_update_nodes(get(), nodes.data(), nodes.size())));
+    }
+
+    size_t update_nodes(Span<const Node> nodes) const {
+        auto raw = detail::handles<Node, RlmNode>(nodes);
+        return update_nodes(Span<const RlmNode* const>(raw.data(), raw.size()));
+    }
+
+    /** @return The node, or `std::nullopt` if no node has `node_id` */
+    std::optional<Node> get_node(CStr node_id) const {
+        RlmNode* node = rlm_memory_store_get_node(get(), node_id.get());
+        if (!node) {
+            if (rlm_has_error()) {
+                throw Error::last();
+            }
+            return std::nullopt;
+        }
+        return Node(node);
+    }
+
+    /** @return Whether a node was deleted */
+    bool delete_node(CStr node_id) const {
+        return detail::check(rlm_memory_store_delete_node(get(), node_id.get())) == 1;
+    }
+
+    NodeList query_by_type(RlmNodeType type, int64_t limit) const {
+        return NodeList(detail::check_ptr(rlm_memory_store_query_by_type_list(get(), type, limit)));
+    }
+
+    NodeList query_by_tier(RlmTier tier, int64_t limit) const {
+        return NodeList(detail::check_ptr(rlm_memory_store_query_by_tier_list(get(), tier, limit)));
+    }
+
+    NodeList search_content(CStr query, int64_t limit) const {
+        return NodeList(
+            detail::check_ptr(rlm_memory_store_search_content_list(get(), query.get(), limit)));
+    }
+
+    /** @return JSON array of `{"id", "score"}`, best first */
+    String search_embedding(Span<const float> query, int64_t k,
+                            std::optional<RlmTier> tier = std::nullopt) const {
+        return detail::check_str(rlm_memory_store_search_embedding(
+            get(), query.data(), query.size(), k, tier ? static_cast<int32_t>(*tier) : -1));
+    }
+
+    /** @return JSON array of `{"id", "score"}` with fused scores */
+    String search_hybrid(CStr text, Span<const float> query, int64_t k,
+                         std::optional<RlmTier> tier = std::nullopt) const {
+        return detail::check_str(rlm_memory_store_search_hybrid(
+            get(), text.get(), query.data(), query.size(), k,
+            tier ? static_cast<int32_t>(*tier) : -1));
+    }
+
+    /** @param node_ids_json JSON array of node ids */
+    String promote(CStr node_ids_json, CStr reason) const {
+        return detail::check_str(
+            rlm_memory_store_promote(get(), node_ids_json.get(), reason.get()));
+    }
+
+    String decay(double factor, double min_confidence) const {
+        return detail::check_str(rlm_memory_store_decay(get(), factor, min_confidence));
+    }
+
+    RlmMemoryStats stats() const {
+        RlmMemoryStats out{};
+        detail::check(rlm_memory_store_stats_into(get(), &out));
+        return out;
+    }
+
+    String stats_json() const { return detail::check_str(rlm_memory_store_stats(get())); }
+
+    void add_edge(const HyperEdge& edge) const {
+        detail::check(rlm_memory_store_add_edge(get(), edge.get()));
+    }
+
+    size_t add_edges(Span<const RlmHyperEdge* const> edges) const {
+        return static_cast<size_t>(
+            detail::check(rlm_memory_store_add_edges(get(), edges.data(), edges.size())));
+    }
+
+    size_t add_edges(Span<const HyperEdge> edges) const {
+        auto raw = detail::handles<HyperEdge, RlmHyperEdge>(edges);
+        return add_edges(Span<const RlmHyperEdge* const>(raw.data(), raw.size()));
+    }
+
+    HyperEdgeList edges_for_node(CStr node_id) const {
+        return HyperEdgeList(
+            detail::check_ptr(rlm_memory_store_get_edges_for_node_list(get(), node_id.get())));
+    }
+
+    /** @return JSON `{"nodes": [...], "edges": [...]}` */
+    String neighborhood(CStr node_id, uint32_t depth, int64_t limit = -1) const {
+        return detail::check_str(
+            rlm_memory_store_neighborhood(get(), node_id.get(), depth, limit));
+    }
+
+    const RlmMemoryStore* get() const noexcept { return store_.get(); }
+
+private:
+    detail::Owned<RlmMemoryStore, rlm_memory_store_free> store_;
+};
+
+/** Background decay and consolidation; stops when destroyed. */
+class MemoryMaintenance {
+public:
+    /** @param options_json See `rlm_memory_maintenance_start()` (may be NULL) */
+    static MemoryMaintenance start(const MemoryStore& store, CStr options_json = nullptr) {
+        return MemoryMaintenance(
+            detail::check_ptr(rlm_memory_maintenance_start(store.get(), options_json.get())));
+    }
+
+    explicit MemoryMaintenance(RlmMemoryMaintenance* maintenance) noexcept
+        : maintenance_(maintenance) {}
+
+    void trigger() const noexcept { rlm_memory_maintenance_trigger(maintenance_.get()); }
+    String stats() const { return detail::check_str(rlm_memory_maintenance_stats(maintenance_.get())); }
+
+    const RlmMemoryMaintenance* get() const noexcept { return maintenance_.get(); }
+
+private:
+    detail::Owned<RlmMemoryMaintenance, rlm_memory_maintenance_free> maintenance_;
+};
+
+/* ============================================================================
+ * SessionContext
+ * ============================================================================ */
+
+class SessionContext {
+public:
+    SessionContext() : ctx_(detail::check_ptr(rlm_session_context_new())) {}
+
+    /** Take ownership of `ctx` (must not be NULL). */
+    explicit SessionContext(RlmSessionContext* ctx) noexcept : ctx_(ctx) {}
+
+    static SessionContext from_json(CStr json) {
+        return SessionContext(detail::check_ptr(rlm_session_context_from_json(json.get())));
+    }
+
+    void add_user_message(CStr content) {
+        detail::check(rlm_session_context_add_user_message(get_mut(), content.get()));
+    }
+
+    void add_assistant_message(CStr content) {
+        detail::check(rlm_session_context_add_assistant_message(get_mut(), content.get()));
+    }
+
+    void cache_file(CStr path, CStr content) {
+        detail::check(rlm_session_context_cache_file(get_mut(), path.get(), content.get()));
+    }
+
+    /** Borrow a cached file's content; `std::nullopt` if it is not cached. */
+    std::optional<std::string_view> file(CStr path) const noexcept {
+        return view_opt(rlm_session_context_get_file_view(get(), path.get()));
+    }
+
+    void load_tokenizer(CStr tiktoken_path) {
+        detail::check(rlm_session_context_load_tokenizer(get_mut(), tiktoken_path.get()));
+    }
+
+    int64_t message_count() const noexcept { return rlm_session_context_message_count(get()); }
+    int64_t file_count() const noexcept { return rlm_session_context_file_count(get()); }
+    int64_t tool_output_count() const noexcept {
+        return rlm_session_context_tool_output_count(get());
+    }
+    int64_t total_message_tokens() const noexcept {
+        return rlm_session_context_total_message_tokens(get());
+    }
+    int64_t total_tokens() const noexcept { return rlm_session_context_total_tokens(get()); }
+
+    String to_json() const { return detail::check_str(rlm_session_context_to_json(get())); }
+
+    const RlmSessionContext* get() const noexcept { return ctx_.get(); }
+    RlmSessionContext* get_mut() noexcept { return ctx_.get(); }
+
+private:
+    detail::Owned<RlmSessionContext, rlm_session_context_free> ctx_;
+};
+
+/* ============================================================================
+ * SessionSnapshot
+ * ============================================================================ */
+
+/** Appends checkpoints of a SessionContext to a binary snapshot. */
+class SessionSnapshotWriter {
+public:
+    /** Create (or truncate) a snapshot at `path`. */
+    static SessionSnapshotWriter create(CStr path) {
+        return SessionSnapshotWriter(
+            detail::check_ptr(rlm_session_snapshot_writer_create(path.get())));
+    }
+
+    /** Continue the snapshot at `path`; the next checkpoint is a delta. */
+    static SessionSnapshotWriter append(CStr path) {
+        return SessionSnapshotWriter(
+            detail::check_ptr(rlm_session_snapshot_writer_append(path.get())));
+    }
+
+    /** Stream to a duplicate of `fd` (POSIX only); the caller keeps `fd`. */
+    static SessionSnapshotWriter from_fd(int fd) {
+        return SessionSnapshotWriter(detail::check_ptr(rlm_session_snapshot_writer_from_fd(fd)));
+    }
+
+    explicit SessionSnapshotWriter(RlmSessionSnapshotWriter* writer) noexcept
+        : writer_(writer) {}
+
+    /** Append and flush a checkpoint; discard the writer if this throws. */
+    RlmSnapshotCheckpointStats checkpoint(const SessionContext& ctx) {
+        RlmSnapshotCheckpointStats stats{};
+        detail::check(rlm_session_snapshot_writer_checkpoint(get_mut(), ctx.get(), &stats));
+        return stats;
+    }
+
+    RlmSessionSnapshotWriter* get_mut() noexcept { return writer_.get(); }
+
+private:
+    detail::Owned<RlmSessionSnapshotWriter, rlm_session_snapshot_writer_free> writer_;
+};
+
+/** A memory-mapped snapshot; file bodies are borrowed from the mapping. */
+class SessionSnapshot {
+public:
+    static SessionSnapshot open(CStr path) {
+        return SessionSnapshot(detail::check_ptr(rlm_session_snapshot_open(path.get())));
+    }
+
+    explicit SessionSnapshot(RlmSessionSnapshot* snapshot) noexcept : snapshot_(snapshot) {}
+
+    int64_t message_count() const noexcept { return rlm_session_snapshot_message_count(get()); }
+    int64_t file_count() const noexcept { return rlm_session_snapshot_file_count(get()); }
+
+    /** Borrow a cached file's content; valid while this snapshot lives. */
+    std::optional<std::string_view> file(CStr path) const noexcept {
+        return view_opt(rlm_session_snapshot_get_file_view(get(), path.get()));
+    }
+
+    SessionContext to_context() const {
+        return SessionContext(detail::check_ptr(rlm_session_snapshot_to_context(get())));
+    }
+
+    const RlmSessionSnapshot* get() const noexcept { return snapshot_.get(); }
+
+private:
+    detail::Owned<RlmSessionSnapshot, rlm_session_snapshot_free> snapshot_;
+};
+
+/* ============================================================================
+ * Arena
+ * ============================================================================ */
+
+/**
+ * Request-scoped storage for short-lived objects and strings. Everything it
+ * returns is released by `reset()` or destruction; not thread-safe.
+ */
+class Arena {
+public:
+    Arena() : arena_(detail::check_ptr(rlm_arena_new())) {}
+
+    void reset() noexcept { rlm_arena_reset(get()); }
+    size_t object_count() const noexcept { return rlm_arena_object_count(arena_.get()); }
+    size_t string_bytes() const noexcept { return rlm_arena_string_bytes(arena_.get()); }
+
+    NodeRef node(RlmNodeType type, CStr content) {
+        return NodeRef(detail::check_ptr(rlm_node_new_in(get(), type, content.get())));
+    }
+
+    NodeRef node(RlmNodeType type, CStr content, RlmTier tier, double confidence) {
+        return NodeRef(detail::check_ptr(
+            rlm_node_new_full_in(get(), type, content.get(), tier, confidence)));
+    }
+
+    RlmMessage* message(RlmRole role, CStr content) {
+        return detail::check_ptr(rlm_message_new_in(get(), role, content.get()));
+    }
+
+    RlmToolOutput* tool_output(CStr tool_name, CStr content) {
+        return detail::check_ptr(rlm_tool_output_new_in(get(), tool_name.get(), content.get()));
+    }
+
+    RlmToolOutput* tool_output(CStr tool_name, CStr content, int exit_code) {
+        return detail::check_ptr(rlm_tool_output_new_with_exit_code_in(
+            get(), tool_name.get(), content.get(), exit_code));
+    }
+
+    RlmTrajectoryEvent* event(RlmTrajectoryEventType type, uint32_t depth, CStr content) {
+        return detail::check_ptr(rlm_trajectory_event_new_in(get(), type, depth, content.get()));
+    }
+
+    std::string_view node_id(NodeRef node) {
+        return detail::check_ptr(rlm_node_id_in(get(), node.get()));
+    }
+
+    std::string_view to_json(NodeRef node) {
+        return detail::check_ptr(rlm_node_to_json_in(get(), node.get()));
+    }
+
+    std::string_view to_json(const RlmTrajectoryEvent* event) {
+        return detail::check_ptr(rlm_trajectory_event_to_json_in(get(), event));
+    }
+
+    std::string_view log_line(const RlmTrajectoryEvent* event) {
+        return detail::check_ptr(rlm_trajectory_event_log_line_in(get(), event));
+    }
+
+    RlmArena* get() noexcept { return arena_.get(); }
+
+private:
+    detail::Owned<RlmArena, rlm_arena_free> arena_;
+};
+
+/* ============================================================================
+ * REPL
+ * ============================================================================ */
+
+/** In-flight REPL request; abandoned if destroyed before `wait()`. */
+class ReplPending {
+public:
+    explicit ReplPending(RlmReplPending* pending) noexcept : pending_(pending) {}
+
+    /** @return Whether `wait()` would not block */
+    bool poll() { return detail::check(rlm_repl_pending_poll(pending_.get())) == 1; }
+
+    /** Block for the result; may be called once. */
+    String wait() { return detail::check_str(rlm_repl_pending_wait(pending_.get())); }
+
+    RlmReplPending* get() const noexcept { return pending_.get(); }
+
+private:
+    detail::Owned<RlmReplPending, rlm_repl_pending_free> pending_;
+};
+
+namespace detail {
+
+/** REPL operations shared by owned handles and pool leases. */
+template <typename Derived>
+class ReplOps {
+public:
+    /** @return JSON execution result */
+    String execute(CStr code) { return check_str(rlm_repl_handle_execute(raw(), code.get())); }
+
+    ReplPending execute_async(CStr code) {
+        return ReplPending(check_ptr(rlm_repl_handle_execute_async(raw(), code.get())));
+    }
+
+    /** @return JSON variable value */
+    String get_variable(CStr name) {
+        return check_str(rlm_repl_handle_get_variable(raw(), name.get()));
+    }
+
+    ReplPending get_variable_async(CStr name) {
+        return ReplPending(check_ptr(rlm_repl_handle_get_variable_async(raw(), name.get())));
+    }
+
+    void set_variable(CStr name, CStr value_json) {
+        check(rlm_repl_handle_set_variable(raw(), name.get(), value_json.get()));
+    }
+
+    void resolve_operation(CStr operation_id, CStr result_json) {
+        check(rlm_repl_handle_resolve_operation(raw(), operation_id.get(), result_json.get()));
+    }
+
+    String list_variables() { return check_str(rlm_repl_handle_list_variables(raw())); }
+    String status() { return check_str(rlm_repl_handle_status(raw())); }
+    void reset() { check(rlm_repl_handle_reset(raw())); }
+    void shutdown() { check(rlm_repl_handle_shutdown(raw())); }
+    bool is_alive() { return check(rlm_repl_handle_is_alive(raw())) == 1; }
+
+private:
+    RlmReplHandle* raw() noexcept { return static_cast<Derived*>(this)->get(); }
+};
+
+} // namespace detail
+
+/** Owned REPL subprocess. */
+class ReplHandle : public detail::ReplOps<ReplHandle> {
+public:
+    static ReplHandle spawn() {
+        return ReplHandle(detail::check_ptr(rlm_repl_handle_spawn_default()));
+    }
+
+    /** @param config_json See `rlm_repl_handle_spawn()` */
+    static ReplHandle spawn(CStr config_json) {
+        return ReplHandle(detail::check_ptr(rlm_repl_handle_spawn(config_json.get())));
+    }
+
+    /** Take ownership of `handle` (must not be NULL). */
+    explicit ReplHandle(RlmReplHandle* handle) noexcept : handle_(handle) {}
+
+    RlmReplHandle* get() const noexcept { return handle_.get(); }
+    RlmReplHandle* release() noexcept { return handle_.release(); }
+
+private:
+    detail::Owned<RlmReplHandle, rlm_repl_handle_free> handle_;
+};
+
+class ReplPool;
+
+/**
+ * REPL handle checked out of a `ReplPool`; returned to the pool when
+ * destroyed. Must not outlive the pool.
+ */
+class ReplLease : public detail::ReplOps<ReplLease> {
+public:
+    ReplLease(ReplLease&& other) noexcept
+        : pool_(other.pool_), handle_(std::exchange(other.handle_, nullptr)) {}
+
+    ReplLease& operator=(ReplLease&& other) noexcept {
+        if (this != &other) {
+            release_to_pool();
+            pool_ = other.pool_;
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+
+    ReplLease(const ReplLease&) = delete;
+    ReplLease& operator=(const ReplLease&) = delete;
+
+    ~ReplLease() { release_to_pool(); }
+
+    /** Keep the handle instead of returning it to the pool. */
+    ReplHandle detach() noexcept { return ReplHandle(std::exchange(handle_, nullptr)); }
+
+    RlmReplHandle* get() const noexcept { return handle_; }
+
+private:
+    friend class ReplPool;
+
+    ReplLease(const RlmReplPool* pool, RlmReplHandle* handle) noexcept
+        : pool_(pool), handle_(handle) {}
+
+    void release_to_pool() noexcept {
+        if (handle_) {
+            rlm_repl_pool_release(pool_, std::exchange(handle_, nullptr));
+        }
+    }
+
+    const RlmReplPool* pool_;
+    RlmReplHandle* handle_;
+};
+
+/** Pool of REPL subprocesses. Safe to share across threads by const reference. */
+class ReplPool {
+public:
+    /** @param max_size Maximum live handles (0 for unbounded) */
+    static ReplPool create(size_t max_size) {
+        return ReplPool(detail::check_ptr(rlm_repl_pool_new_default(max_size)));
+    }
+
+    static ReplPool create(CStr config_json, size_t max_size) {
+        return ReplPool(detail::check_ptr(rlm_repl_pool_new(config_json.get(), max_size)));
+    }
+
+    /** @param config_json,options_json See `rlm_repl_pool_new_with_options()` (may be NULL) */
+    static ReplPool with_options(CStr config_json, CStr options_json) {
+        return ReplPool(detail::check_ptr(
+            rlm_repl_pool_new_with_options(config_json.get(), options_json.get())));
+    }
+
+    /** Take ownership of `pool` (must not be NULL). */
+    explicit ReplPool(RlmReplPool* pool) noexcept : pool_(pool) {}
+
+    ReplLease acquire() const {
+        return ReplLease(get(), detail::check_ptr(rlm_repl_pool_acquire(get())));
+    }
+
+    ReplLease acquire(uint64_t timeout_ms) const {
+        return ReplLease(get(), detail::check_ptr(rlm_repl_pool_acquire_timeout(get(), timeout_ms)));
+    }
+
+    String stats() const { return detail::check_str(rlm_repl_pool_stats(get())); }
+
+    const RlmReplPool* get() const noexcept { return pool_.get(); }
+
+private:
+    detail::Owned<RlmReplPool, rlm_repl_pool_free> pool_;
+};
+
+/* ============================================================================
+ * CostTracker
+ * ============================================================================ */
+
+/** Token and cost accounting. `record()` is safe to call from many threads. */
+class CostTracker {
+public:
+    CostTracker() : tracker_(detail::check_ptr(rlm_cost_tracker_new())) {}
+
+    /** Take ownership of `tracker` (must not be NULL). */
+    explicit CostTracker(RlmCostTracker* tracker) noexcept : tracker_(tracker) {}
+
+    static CostTracker from_json(CStr json) {
+        return CostTracker(detail::check_ptr(rlm_cost_tracker_from_json(json.get())));
+    }
+
+    /** @param cost Cost in USD, or negative to compute it from the model */
+    void record(CStr model, uint64_t input_tokens, uint64_t output_tokens,
+                uint64_t cache_read_tokens = 0, uint64_t cache_creation_tokens = 0,
+                double cost = -1.0) const {
+        detail::check(rlm_cost_tracker_record(get_mut(), model.get(), input_tokens, output_tokens,
+                                              cache_read_tokens, cache_creation_tokens, cost));
+    }
+
+    void merge(const CostTracker& other) const {
+        detail::check(rlm_cost_tracker_merge(get_mut(), other.get()));
+    }
+
+    uint64_t total_input_tokens() const noexcept {
+        return rlm_cost_tracker_total_input_tokens(get());
+    }
+    uint64_t total_output_tokens() const noexcept {
+        return rlm_cost_tracker_total_output_tokens(get());
+    }
+    uint64_t total_cache_read_tokens() const noexcept {
+        return rlm_cost_tracker_total_cache_read_tokens(get());
+    }
+    uint64_t total_cache_creation_tokens() const noexcept {
+        return rlm_cost_tracker_total_cache_creation_tokens(get());
+    }
+    double total_cost() const noexcept { return rlm_cost_tracker_total_cost(get()); }
+    uint64_t request_count() const noexcept { return rlm_cost_tracker_request_count(get()); }
+
+    /** Fill `out` with the totals without JSON. */
+    bool snapshot_into(RlmCostSnapshot& out) const noexcept {
+        return rlm_cost_tracker_snapshot_into(get(), &out) == 0;
+    }
+
+    RlmCostSnapshot snapshot() const {
+        RlmCostSnapshot out{};
+        detail::check(rlm_cost_tracker_snapshot_into(get(), &out));
+        return out;
+    }
+
+    size_t model_count() const noexcept { return rlm_cost_tracker_model_count(get()); }
+
+    /**
+     * Fill the costs of model `index`; `name` (may be NULL) receives a view
+     * valid until the tracker is destroyed.
+     * @return false if `index` is out of range
+     */
+    bool model_costs_into(size_t index, RlmUsageCosts& out,
+                          std::string_view* name = nullptr) const noexcept {
+        RlmStrView raw{nullptr, 0};
+        if (rlm_cost_tracker_model_costs_into(get(), index, &out, name ? &raw : nullptr) != 0) {
+            return false;
+        }
+        if (name) {
+            *name = view(raw);
+        }
+        return true;
+    }
+
+    String by_model_json() const { return detail::check_str(rlm_cost_tracker_by_model_json(get())); }
+    String to_json() const { return detail::check_str(rlm_cost_tracker_to_json(get())); }
+
+    const RlmCostTracker* get() const noexcept { return tracker_.get(); }
+
+private:
+    // rlm_cost_tracker_record/merge take a mutable pointer but synchronize
+    // internally, so they are exposed as const like the rest of the tracker.
+    RlmCostTracker* get_mut() const noexcept { return tracker_.get(); }
+
+    detail::Owned<RlmCostTracker, rlm_cost_tracker_free> tracker_;
+};
+
+/* ============================================================================
+ * Metrics
+ * ============================================================================ */
+
+/** Process-wide hot-path latency histograms; safe to read from any thread. */
+namespace metrics {
+
+inline RlmMetricsSnapshot snapshot() {
+    RlmMetricsSnapshot out{};
+    detail::check(rlm_metrics_snapshot(&out));
+    return out;
+}
+
+inline RlmMetricSample sample(RlmMetric metric) { return snapshot().samples[metric]; }
+
+/** Prometheus text exposition of every metric. */
+inline std::string prometheus() { return detail::check_str(rlm_metrics_prometheus()).str(); }
+
+inline void reset() noexcept { rlm_metrics_reset(); }
+
+inline std::string_view name(RlmMetric metric) noexcept { return rlm_metric_name(metric); }
+
+/** Toggle `tracing` spans around instrumented operations at runtime. */
+inline void set_tracing(bool enabled) noexcept { rlm_metrics_set_tracing(enabled ? 1 : 0); }
+
+inline bool tracing_enabled() noexcept { return rlm_metrics_tracing_enabled() != 0; }
+
+} // namespace metrics
+
+/* ============================================================================
+ * Library Functions
+ * ============================================================================ */
+
+inline String version() { return detail::check_str(rlm_version()); }
+
+/** Calls `rlm_init()` on construction and `rlm_shutdown()` on destruction. */
+class Library {
+public:
+    Library() { detail::check(rlm_init()); }
+    ~Library() { rlm_shutdown(); }
+
+    Library(const Library&) = delete;
+    Library& operator=(const Library&) = delete;
+};
+
+} // namespace rlm
+
+#endif /* RLM_CORE_HPP */
@@ -0,0 +1,189 @@
+"""Lazily materialized context variables.
+
+The host may send a context variable as a manifest instead of its full
+contents. Large item bodies are stored once in a content-addressed blob
+directory and referenced by hash::
+
+    {"$rlm_lazy": {"dir": "/dev/shm/rlm-blobs-1-0", "value": {
+        "/src/main.rs": {"$rlm_blob": {"hash": "9f...", "len": 48213}}
+    }}}
+
+``wrap`` turns the manifest into ``LazyDict``/``LazyList`` containers that
+behave like ``dict``/``list`` but read a blob only when its item is first
+accessed, then keep the string in place. Blobs are shared across variables
+and recursion depths, so each hash is read at most once per process. Blobs
+are owned by the host and are never unlinked here.
+"""
+
+from __future__ import annotations
+
+import os
+import re
+from typing import Any, Iterator
+
+ROOT_KEY = "$rlm_lazy"
+BLOB_KEY = "$rlm_blob"
+
+_HASH_RE = re.compile(r"^[0-9a-f]{64}$")
+
+# hash -> materialized text, shared by every lazy variable in this process.
+_cache: dict[str, str] = {}
+
+
+class BlobRef:
+    """Reference to one blob; materialized on first access."""
+
+    __slots__ = ("directory", "hash", "length")
+
+    def __init__(self, directory: str, spec: dict[str, Any]):
+        blob_hash = spec.get("hash")
+        if not isinstance(blob_hash, str) or not _HASH_RE.match(blob_hash):
+            raise ValueError(f"invalid blob hash: {blob_hash!r}")
+        self.directory = directory
+        self.hash = blob_hash
+        self.length = int(spec.get("len", 0))
+
+    def load(self) -> str:
+        text = _cache.get(self.hash)
+        if text is None:
+            path = os.path.join(self.directory, f"blob-{self.hash}")
+            with open(path, encoding="utf-8") as f:
+                text = f.read()
+            _cache[self.hash] = text
+        return text
+
+    def __repr__(self) -> str:
+        return f"<lazy {self.length} bytes>"
+
+
+def _materialize(value: Any) -> Any:
+    return value.load() if isinstance(value, BlobRef) else value
+
+
+class LazyDict(dict):
+    """``dict`` whose blob-backed values load on first access.
+
+    Every way of reading values goes through ``__getitem__``, including
+    ``dict(d)``, ``{**d}`` and ``other.update(d)``: CPython copies a dict
+    subclass's raw slots directly unless the subclass defines its own
+    ``__iter__``, so this one does.
+    """
+
+    def __getitem__(self, key: Any) -> Any:
+        value = dict.__getitem__(self, key)
+        if isinstance(value, BlobRef):
+            value = value.load()
+            dict.__setitem__(self, key, value)
+        return value
+
+    def __iter__(self) -> Iterator[Any]:
+        return iter(dict.keys(self))
+
+    def get(self, key: Any, default: Any = None) -> Any:
+        return self[key] if key in self else default
+
+    def values(self):  # type: ignore[override]
+        return [self[key] for key in self]
+
+    def items(self):  # type: ignore[override]
+        return [(key, self[key]) for key in self]
+
+    def pop(self, key: Any, *default: Any) -> Any:
+        return _materialize(dict.pop(self, key, *default))
+
+    def popitem(self) -> tuple[Any, Any]:
+        key, value = dict.popitem(self)
+        return key, _materialize(value)
+
+    def setdefault(self, key: Any, default: Any = None) -> Any:
+        if key in self:
+            return self[key]
+        dict.__setitem__(self, key, default)
+        return default
+
+    def copy(self) -> dict[Any, Any]:
+        return dict(self.items())
+
+    def __or__(self, other: Any) -> Any:
+        if not isinstance(other, dict):
+            return NotImplemented
+        merged = self.copy()
+        merged.update(other)
+        return merged
+
+    def __ror__(self, other: Any) -> Any:
+        if not isinstance(other, dict):
+            return NotImplemented
+        merged = dict(other)
+        merged.update(self.items())
+        return merged
+
+    def __eq__(self, other: object) -> bool:
+        return dict(self.items()) == other
+
+    __hash__ = None  # type: ignore[assignment]
+
+    def __repr__(self) -> str:
+        return "{" + ", ".join(f"{k!r}: {v!r}" for k, v in dict.items(self)) + "}"
+
+
+class LazyList(list):
+    """``list`` whose blob-backed items load on first access."""
+
+    def _load(self, index: int) -> Any:
+        value = list.__getitem__(self, index)
+        if isinstance(value, BlobRef):
+            value = value.load()
+            list.__setitem__(self, index, value)
+        return value
+
+    def __getitem__(self, index: Any) -> Any:
+        if isinstance(index, slice):
+            return [self._load(i) for i in range(*index.indices(len(self)))]
+        return self._load(index)
+
+    def __iter__(self) -> Iterator[Any]:
+        for i in range(len(self)):
+            yield self._load(i)
+
+    def __eq__(self, other: object) -> bool:
+        return list(iter(self)) == other
+
+    __hash__ = None  # type: ignore[assignment]
+
+    def __repr__(self) -> str:
+        return "[" + ", ".join(repr(v) for v in list.__iter__(self)) + "]"
+
+
+def _wrap(directory: str, value: Any) -> tuple[Any, bool]:
+    """Return ``value`` with blob references, and whether any were found."""
+    if isinstance(value, dict):
+        spec = value.get(BLOB_KEY) if len(value) == 1 else None
+        if isinstance(spec, dict):
+            return BlobRef(directory, spec), True
+        items = {k: _wrap(directory, v) for k, v in value.items()}
+        lazy = any(found for _, found in items.values())
+        values = {k: v for k, (v, _) in items.items()}
+        return (LazyDict(values) if lazy else values), lazy
+    if isinstance(value, list):
+        items = [_wrap(directory, v) for v in value]
+        lazy = any(found for _, found in items)
+        values = [v for v, _ in items]
+        return (LazyList(values) if lazy else values), lazy
+    return value, False
+
+
+def wrap(value: Any) -> Any:
+    """Turn a lazy manifest into lazy containers; other values pass through."""
+    if not isinstance(value, dict) or len(value) != 1:
+        return value
+    spec = value.get(ROOT_KEY)
+    if not isinstance(spec, dict) or not isinstance(spec.get("dir"), str):
+        return value
+    wrapped, _ = _wrap(spec["dir"], spec.get("value"))
+    return _materialize(wrapped)
+
+
+def clear_cache() -> None:
+    """Forget materialized blobs (e.g. on REPL reset)."""
+    _cache.clear()
@@ -15,6 +15,7 @@ from typing import Any
 
 from pydantic import ValidationError
 
+from rlm_repl import lazy
 from rlm_repl.deferred import PendingOperationError, get_registry, reset_registry
 from rlm_repl.protocol import (
     ErrorCode,
@@ -31,6 +32,7 @@ from rlm_repl.protocol import (
     VariablesResponse,
 )
 from rlm_repl.sandbox import CompilationError, Sandbox, SandboxError
+from rlm_repl.shm import SharedMemory
 
 
 class ReplServer:
@@ -40,13 +42,14 @@ class ReplServer:
         self.sandbox = Sandbox()
         self.running = True
         self.signature_registration: dict[str, Any] | None = None
+        self.shm = SharedMemory.from_env()
 
     def handle_request(self, request: JsonRpcRequest) -> JsonRpcResponse | None:
         """Handle a JSON-RPC request and return a response."""
         method = request.method
-        params = request.params or {}
 
         try:
+            params = self.shm.resolve(request.params or {})
             if method == "execute":
                 result = self._execute(params)
             elif method == "get_variable":
@@ -151,7 +154,7 @@ class ReplServer:
 
         execution_time_ms = (time.perf_counter() - start_time) * 1000
 
-        return ExecuteResponse(
+        response = ExecuteResponse(
             success=success,
             result=_serialize_result(result),
             stdout=stdout,
@@ -162,17 +165,20 @@ class ReplServer:
             pending_operations=all_pending,
             submit_result=submit_result,
         ).model_dump()
+        for key in ("result", "stdout", "stderr"):
+            response[key] = self.shm.offload(response[key])
+        return response
 
     def _get_variable(self, params: dict[str, Any]) -> Any:
         """Get a variable value."""
         req = GetVariableRequest(**params)
         value = self.sandbox.get_variable(req.name)
-        return _serialize_result(value)
+        return self.shm.offload(_serialize_result(value))
 
     def _set_variable(self, params: dict[str, Any]) -> dict[str, bool]:
         """Set a variable value."""
         req = SetVariableRequest(**params)
-        self.sandbox.set_variable(req.name, req.value)
+        self.sandbox.set_variable(req.name, lazy.wrap(req.value))
         return {"success": True}
 
     def _resolve_operation(self, params: dict[str, Any]) -> dict[str, bool]:
@@ -211,6 +217,7 @@ class ReplServer:
         """Reset the REPL state."""
         self.sandbox = Sandbox()
         reset_registry()
+        lazy.clear_cache()
         self.signature_registration = None
         return {"success": True}
 
@@ -0,0 +1,132 @@
+"""Shared-memory side channel for large payloads.
+
+The host passes large values as segment files in a private directory on a
+memory-backed filesystem instead of inline JSON. A JSON-RPC message carries a
+placeholder in their place::
+
+    {"$rlm_shm": {"name": "seg-1", "len": 4194304, "encoding": "utf8"}}
+
+``utf8`` segments decode to ``str``, ``json`` segments to the parsed value, and
+``bytes`` segments to a zero-copy ``memoryview`` over the mapping. Segments are
+unlinked as soon as they are read. Results over the threshold travel back the
+same way.
+
+The channel is configured by the host through ``RLM_REPL_SHM_DIR`` and
+``RLM_REPL_SHM_THRESHOLD``; without them every value stays inline.
+"""
+
+from __future__ import annotations
+
+import itertools
+import json
+import mmap
+import os
+from typing import Any
+
+PLACEHOLDER_KEY = "$rlm_shm"
+DIR_ENV = "RLM_REPL_SHM_DIR"
+THRESHOLD_ENV = "RLM_REPL_SHM_THRESHOLD"
+
+
+class SharedMemory:
+    """Reader and writer for the host's segment directory."""
+
+    def __init__(self, directory: str | None, threshold: int):
+        self.directory = directory
+        self.threshold = threshold if directory else 0
+        self._counter = itertools.count()
+
+    @classmethod
+    def from_env(cls) -> SharedMemory:
+        try:
+            threshold = int(os.environ.get(THRESHOLD_ENV, "0"))
+        except ValueError:
+            threshold = 0
+        return cls(os.environ.get(DIR_ENV) or None, max(threshold, 0))
+
+    @property
+    def enabled(self) -> bool:
+        return self.threshold > 0
+
+    def _path(self, name: Any) -> str:
+        if (
+            not self.directory
+            or not isinstance(name, str)
+            or not name
+            or "/" in name
+            or "\\" in name
+            or name in (".", "..")
+        ):
+            raise ValueError(f"invalid shared-memory segment name: {name!r}")
+        return os.path.join(self.directory, name)
+
+    # ------------------------------------------------------------------
+    # Host -> REPL
+    # ------------------------------------------------------------------
+
+    def resolve(self, value: Any) -> Any:
+        """Replace every placeholder in ``value`` with its segment contents."""
+        if isinstance(value, dict):
+            spec = value.get(PLACEHOLDER_KEY) if len(value) == 1 else None
+            if isinstance(spec, dict):
+                return self._load(spec)
+            return {k: self.resolve(v) for k, v in value.items()}
+        if isinstance(value, list):
+            return [self.resolve(v) for v in value]
+        return value
+
+    def _load(self, spec: dict[str, Any]) -> Any:
+        path = self._path(spec.get("name"))
+        encoding = spec.get("encoding", "utf8")
+        try:
+            with open(path, "rb") as f:
+                size = os.fstat(f.fileno()).st_size
+                length = min(int(spec.get("len", size)), size)
+                if length == 0:
+                    data: Any = b""
+                else:
+                    # The mapping outlives the file; unlinking below is safe.
+                    data = memoryview(mmap.mmap(f.fileno(), size, access=mmap.ACCESS_READ))[
+                        :length
+                    ]
+        finally:
+            try:
+                os.unlink(path)
+            except OSError:
+                pass
+
+        if encoding == "bytes":
+            return data if isinstance(data, memoryview) else memoryview(data)
+        if encoding == "json":
+            return json.loads(bytes(data))
+        if encoding == "utf8":
+            return str(data, "utf-8")
+        raise ValueError(f"unsupported shared-memory encoding: {encoding!r}")
+
+    # ------------------------------------------------------------------
+    # REPL -> host
+    # ------------------------------------------------------------------
+
+    def offload(self, value: Any) -> Any:
+        """Return ``value`` or, if it is over the threshold, a placeholder."""
+        if not self.enabled:
+            return value
+        if isinstance(value, str):
+            if len(value) < self.threshold // 4:
+                return value
+            data = value.encode("utf-8")
+            if len(data) >= self.threshold:
+                return self._store(data, "utf8")
+            return value
+        if isinstance(value, (dict, list)):
+            data = json.dumps(value).encode("utf-8")
+            if len(data) >= self.threshold:
+                return self._store(data, "json")
+        return value
+
+    def _store(self, data: bytes, encoding: str) -> dict[str, Any]:
+        name = f"py-{os.getpid()}-{next(self._counter)}"
+        fd = os.open(self._path(name), os.O_WRONLY | os.O_CREAT | os.O_EXCL, 0o600)
+        with os.fdopen(fd, "wb") as f:
+            f.write(data)
+        return {PLACEHOLDER_KEY: {"name": name, "len": len(data), "encoding": encoding}}
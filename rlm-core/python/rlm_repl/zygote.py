@@ -0,0 +1,170 @@
+"""Fork server ("zygote") for fast REPL startup.
+
+The zygote imports the REPL runtime once, then forks a fresh REPL server for
+every connection on a Unix domain socket. Each forked child speaks the normal
+JSON-RPC protocol over that connection, so spawning a REPL costs a ``fork()``
+instead of an interpreter boot plus imports.
+
+Per-connection protocol (one JSON line from the client):
+
+- ``{"method": "fork", "params": {"env": {...}}}``: the child applies ``env``,
+  replies ``{"pid": N}`` and then behaves exactly like ``python -m rlm_repl``
+  (starting with the ``ready`` message).
+- ``{"method": "kill", "params": {"pid": N}}``: SIGKILL a child forked by
+  this zygote; replies ``{"ok": bool}``.
+
+The zygote exits when its stdin reaches EOF, i.e. when the host process that
+owns it goes away.
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import random
+import select
+import signal
+import socket
+import sys
+import types
+from typing import Any
+
+# Pre-import everything a REPL server needs so forked children start warm.
+from rlm_repl import deferred, helpers, protocol  # noqa: F401
+from rlm_repl.main import ReplServer
+from rlm_repl.sandbox import Sandbox
+
+PRELOAD_MODULE_NAME = "rlm_context"
+
+
+def _load_preload(path: str) -> None:
+    """Execute generated helper source as an importable module."""
+    with open(path, encoding="utf-8") as f:
+        source = f.read()
+    module = types.ModuleType(PRELOAD_MODULE_NAME)
+    module.__file__ = path
+    exec(compile(source, path, "exec"), module.__dict__)
+    sys.modules[PRELOAD_MODULE_NAME] = module
+
+
+def _send(conn: socket.socket, payload: dict[str, Any]) -> None:
+    conn.sendall((json.dumps(payload) + "\n").encode("utf-8"))
+
+
+def _read_request(conn: socket.socket) -> dict[str, Any] | None:
+    data = b""
+    while not data.endswith(b"\n"):
+        chunk = conn.recv(4096)
+        if not chunk:
+            return None
+        data += chunk
+        if len(data) > 65536:
+            return None
+    try:
+        return json.loads(data)
+    except json.JSONDecodeError:
+        return None
+
+
+def _run_child(
+    listener: socket.socket, conn: socket.socket, env: dict[str, str]
+) -> None:
+    """Body of a forked child: become a normal REPL server on `conn`."""
+    try:
+        listener.close()
+        os.environ.update(env)
+        signal.signal(signal.SIGCHLD, signal.SIG_DFL)
+        signal.signal(signal.SIGTERM, signal.SIG_DFL)
+        random.seed()
+
+        os.dup2(conn.fileno(), 0)
+        os.dup2(conn.fileno(), 1)
+        conn.close()
+        sys.stdin = os.fdopen(0, "r", encoding="utf-8", closefd=False)
+        sys.stdout = os.fdopen(1, "w", encoding="utf-8", closefd=False)
+
+        sys.stdout.write(json.dumps({"pid": os.getpid()}) + "\n")
+        sys.stdout.flush()
+        ReplServer().run()
+    finally:
+        os._exit(0)
+
+
+def serve(socket_path: str) -> None:
+    """Accept fork/kill requests until stdin closes."""
+    # Children are reaped automatically; we never wait on them.
+    signal.signal(signal.SIGCHLD, signal.SIG_IGN)
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+
+    listener = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    listener.bind(socket_path)
+    listener.listen(64)
+
+    children: set[int] = set()
+
+    ready = {"jsonrpc": "2.0", "method": "ready", "params": {"mode": "fork_server"}}
+    sys.stdout.write(json.dumps(ready) + "\n")
+    sys.stdout.flush()
+
+    stdin_fd = sys.stdin.fileno()
+    while True:
+        readable, _, _ = select.select([listener, stdin_fd], [], [])
+        if stdin_fd in readable and not os.read(stdin_fd, 4096):
+            break
+        if listener not in readable:
+            continue
+
+        conn, _ = listener.accept()
+        try:
+            request = _read_request(conn)
+            method = request.get("method") if request else None
+
+            if method == "fork":
+                params = request.get("params") or {}
+                env = {
+                    str(k): str(v) for k, v in (params.get("env") or {}).items()
+                }
+                sys.stdout.flush()
+                sys.stderr.flush()
+                pid = os.fork()
+                if pid == 0:
+                    _run_child(listener, conn, env)
+                children.add(pid)
+            elif method == "kill":
+                pid = int((request.get("params") or {}).get("pid", 0))
+                ok = pid in children
+                if ok:
+                    children.discard(pid)
+                    try:
+                        os.kill(pid, signal.SIGKILL)
+                    except ProcessLookupError:
+                        pass
+                _send(conn, {"ok": ok})
+            else:
+                _send(conn, {"error": f"unknown method: {method}"})
+        except OSError:
+            pass
+        finally:
+            conn.close()
+
+    listener.close()
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description="RLM REPL fork server")
+    parser.add_argument("--socket", required=True, help="Unix socket path to listen on")
+    parser.add_argument("--preload", help="Python source to preload as `rlm_context`")
+    args = parser.parse_args()
+
+    if args.preload:
+        _load_preload(args.preload)
+
+    # Construct one sandbox so lazily-initialized state is paid for up front.
+    Sandbox()
+
+    serve(args.socket)
+
+
+if __name__ == "__main__":
+    main()
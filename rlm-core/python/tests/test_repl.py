@@ -28,6 +28,8 @@ from rlm_repl.protocol import (
     JsonRpcRequest,
 )
 from rlm_repl.sandbox import CompilationError, Sandbox, SandboxError
+from rlm_repl.shm import PLACEHOLDER_KEY, SharedMemory
+from rlm_repl import lazy
 
 
 class TestDeferredOperations:
@@ -208,6 +210,91 @@ class TestProtocol:
         assert error.message == "test"
 
 
+class TestSharedMemory:
+    """Tests for the shared-memory side channel."""
+
+    def test_roundtrip_and_unlink(self, tmp_path):
+        shm = SharedMemory(str(tmp_path), threshold=8)
+        text = shm.offload("x" * 32)
+        data = shm.offload({"files": {"a.py": "print(1)"}})
+        assert PLACEHOLDER_KEY in text and PLACEHOLDER_KEY in data
+        assert shm.offload("small") == "small"
+
+        resolved = shm.resolve({"text": text, "items": [data]})
+        assert resolved == {"text": "x" * 32, "items": [{"files": {"a.py": "print(1)"}}]}
+        assert list(tmp_path.iterdir()) == []
+
+    def test_bytes_segment_is_memoryview(self, tmp_path):
+        (tmp_path / "seg-0").write_bytes(b"abcdef")
+        shm = SharedMemory(str(tmp_path), threshold=8)
+        view = shm.resolve({PLACEHOLDER_KEY: {"name": "seg-0", "len": 3, "encoding": "bytes"}})
+        assert isinstance(view, memoryview)
+        assert bytes(view) == b"abc"
+
+    def test_disabled_and_traversal(self, tmp_path):
+        assert SharedMemory(None, threshold=8).offload("x" * 64) == "x" * 64
+        shm = SharedMemory(str(tmp_path), threshold=8)
+        with pytest.raises(ValueError):
+            shm.resolve({PLACEHOLDER_KEY: {"name": "../secret", "len": 1}})
+
+
+class TestLazyVariables:
+    """Tests for lazily materialized context variables."""
+
+    def test_blobs_load_on_first_access(self, tmp_path):
+        blob_hash = "ab" * 32
+        (tmp_path / f"blob-{blob_hash}").write_text("fn main() {}", encoding="utf-8")
+        ref = {lazy.BLOB_KEY: {"hash": blob_hash, "len": 12}}
+        manifest = {
+            lazy.ROOT_KEY: {
+                "dir": str(tmp_path),
+                "value": {"/a.rs": ref, "/b.rs": "inline"},
+            }
+        }
+        lazy.clear_cache()
+        files = lazy.wrap(manifest)
+        assert isinstance(files, dict)
+        assert isinstance(dict.__getitem__(files, "/a.rs"), lazy.BlobRef)
+
+        assert files["/a.rs"] == "fn main() {}"
+        assert dict(files.items()) == {"/a.rs": "fn main() {}", "/b.rs": "inline"}
+
+        conversation = lazy.wrap(
+            {lazy.ROOT_KEY: {"dir": str(tmp_path), "value": [{"role": "user", "content": ref}]}}
+        )
+        assert [m["content"] for m in conversation] == ["fn main() {}"]
+        assert lazy.wrap({"plain": 1}) == {"plain": 1}
+
+    def test_copies_materialize_blobs(self, tmp_path):
+        blob_hash = "cd" * 32
+        (tmp_path / f"blob-{blob_hash}").write_text("body", encoding="utf-8")
+        manifest = {
+            lazy.ROOT_KEY: {
+                "dir": str(tmp_path),
+                "value": {"/a.rs": {lazy.BLOB_KEY: {"hash": blob_hash, "len": 4}}},
+            }
+        }
+        expected = {"/a.rs": "body"}
+        for copy in (dict, lambda d: {**d}, lambda d: d.copy(), lambda d: d | {}):
+            lazy.clear_cache()
+            assert copy(lazy.wrap(manifest)) == expected
+        merged: dict = {}
+        merged.update(lazy.wrap(manifest))
+        assert merged == expected
+        assert list(lazy.wrap(manifest).values()) == ["body"]
+
+    def test_invalid_hash_rejected(self, tmp_path):
+        with pytest.raises(ValueError):
+            lazy.wrap(
+                {
+                    lazy.ROOT_KEY: {
+                        "dir": str(tmp_path),
+                        "value": [{lazy.BLOB_KEY: {"hash": "../../etc/passwd"}}],
+                    }
+                }
+            )
+
+
 class TestReplServer:
     """Tests for JSON-RPC method handling in ReplServer."""
 
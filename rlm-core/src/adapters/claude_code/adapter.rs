@@ -172,7 +172,7 @@ impl AdapterRuntime {
             &memory_hits,
         )?;
 
-        let mut routing_runtime = OrchestrationRoutingRuntime::for_mode(final_mode);
+        let routing_runtime = OrchestrationRoutingRuntime::for_mode(final_mode);
         let (routing_decision, tier) = routing_runtime.route_recursive(&request.query, 0);
         let usage = LlmTokenUsage {
             input_tokens: estimate_tokens(&root_prompt)
@@ -7,8 +7,8 @@
 //! - Context characteristics (file count, token volume)
 //! - Historical signals (previous turn state)
 
-use crate::context::SessionContext;
-use regex::Regex;
+use crate::context::{Message, Role, SessionContext};
+use regex::RegexSet;
 use serde::{Deserialize, Serialize};
 use std::sync::LazyLock;
 
@@ -236,65 +236,157 @@ impl Default for PatternClassifier {
     }
 }
 
-// Lazy-initialized regex patterns
-static MULTI_FILE_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(r"(?i)(files?|modules?|components?|across|between|multiple|all\s+the)\s+(in|from|under|within)?")
-        .expect("invalid regex")
+// Query signal patterns, matched together in a single `RegexSet` pass.
+// Indices into the set follow the order of this list.
+const MULTI_FILE: usize = 0;
+const CROSS_CONTEXT: usize = 1;
+const TEMPORAL: usize = 2;
+const PATTERN_ANALYSIS: usize = 3;
+const DEBUGGING: usize = 4;
+const EXHAUSTIVE: usize = 5;
+const SECURITY: usize = 6;
+const ARCHITECTURE: usize = 7;
+const THOROUGH: usize = 8;
+const FAST: usize = 9;
+const CONTINUATION: usize = 10;
+
+static QUERY_PATTERNS: LazyLock<RegexSet> = LazyLock::new(|| {
+    RegexSet::new([
+        // MULTI_FILE
+        r"(?i)(files?|modules?|components?|across|between|multiple|all\s+the)\s+(in|from|under|within)?",
+        // CROSS_CONTEXT: "why X when Y", "how does X", relationship queries, etc.
+        r"(?i)(why\b.*\b(when|if|given|since)|how\s+(does|do|is|are)|relationship|connect|interact|depend|flow|between|across|what\b.*\b(cause|led\s+to|result))",
+        // TEMPORAL
+        r"(?i)(before|after|when|then|history|previous|changed|evolved|used\s+to)",
+        // PATTERN_ANALYSIS: "find places where", "search for X where", pattern queries, etc.
+        r"(?i)((find|search|locate|grep)\b.*\b(where|that|which)|how\s+many|list\s+(all|every)|pattern|structure|architecture|design|organize|layout|convention|idiom)",
+        // DEBUGGING
+        r"(?i)(debug|error|bug|issue|problem|fix|broken|failing|crash|exception|traceback|not\s+work)",
+        // EXHAUSTIVE
+        r"(?i)(all|every|each|exhaustive|comprehensive|complete|full|entire|everywhere)",
+        // SECURITY
+        r"(?i)(security|auth|permission|access|credential|secret|vulnerab|injection|xss|csrf|owasp)",
+        // ARCHITECTURE
+        r"(?i)(architect|design|refactor|restructure|reorganize|system|overview|high.level)",
+        // THOROUGH
+        r"(?i)(thorough|careful|detailed|deep|exhaustive|comprehensive|make\s+sure|be\s+careful)",
+        // FAST
+        r"(?i)(quick|fast|simple|just|only|brief|short|don'?t\s+overthink)",
+        // CONTINUATION
+        r"(?i)(continue|also|now|next|then|keep|more|another|additionally)",
+    ])
+    .expect("invalid regex")
 });
 
-static CROSS_CONTEXT_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    // Matches "why X when Y", "how does X", relationship queries, etc.
-    Regex::new(r"(?i)(why\b.*\b(when|if|given|since)|how\s+(does|do|is|are)|relationship|connect|interact|depend|flow|between|across|what\b.*\b(cause|led\s+to|result))")
-        .expect("invalid regex")
-});
+/// Phrases in an assistant message that mark the turn as confused.
+const CONFUSION_MARKERS: [&str; 3] = ["I'm not sure", "Could you clarify", "I need more context"];
 
-static TEMPORAL_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(r"(?i)(before|after|when|then|history|previous|changed|evolved|used\s+to)")
-        .expect("invalid regex")
-});
+/// User messages shorter than this (in bytes) read as a continuation.
+const SHORT_FOLLOW_UP_LEN: usize = 50;
 
-static PATTERN_ANALYSIS: LazyLock<Regex> = LazyLock::new(|| {
-    // Matches "find places where", "search for X where", pattern queries, etc.
-    Regex::new(r"(?i)((find|search|locate|grep)\b.*\b(where|that|which)|how\s+many|list\s+(all|every)|pattern|structure|architecture|design|organize|layout|convention|idiom)")
-        .expect("invalid regex")
-});
+/// Set the query-derived signals, returning whether the query itself reads
+/// as a continuation.
+fn apply_query_signals(signals: &mut TaskComplexitySignals, query: &str) -> bool {
+    let matched = QUERY_PATTERNS.matches(query);
 
-static DEBUGGING_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(r"(?i)(debug|error|bug|issue|problem|fix|broken|failing|crash|exception|traceback|not\s+work)")
-        .expect("invalid regex")
-});
+    signals.references_multiple_files = matched.matched(MULTI_FILE)
+        || query.matches('/').count() > 1
+        || query.matches(".rs").count() > 1
+        || query.matches(".py").count() > 1
+        || query.matches(".ts").count() > 1;
 
-static EXHAUSTIVE_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(r"(?i)(all|every|each|exhaustive|comprehensive|complete|full|entire|everywhere)")
-        .expect("invalid regex")
-});
+    signals.requires_cross_context_reasoning = matched.matched(CROSS_CONTEXT);
+    signals.involves_temporal_reasoning = matched.matched(TEMPORAL);
+    signals.asks_about_patterns = matched.matched(PATTERN_ANALYSIS);
+    signals.debugging_task = matched.matched(DEBUGGING);
+    signals.requires_exhaustive_search = matched.matched(EXHAUSTIVE);
+    signals.security_review_task = matched.matched(SECURITY);
+    signals.architecture_analysis = matched.matched(ARCHITECTURE);
 
-static SECURITY_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(r"(?i)(security|auth|permission|access|credential|secret|vulnerab|injection|xss|csrf|owasp)")
-        .expect("invalid regex")
-});
+    // User intent signals
+    signals.user_wants_thorough = matched.matched(THOROUGH);
+    signals.user_wants_fast = matched.matched(FAST);
 
-static ARCHITECTURE_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(r"(?i)(architect|design|refactor|restructure|reorganize|system|overview|high.level)")
-        .expect("invalid regex")
-});
+    matched.matched(CONTINUATION)
+}
 
-static THOROUGH_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(
-        r"(?i)(thorough|careful|detailed|deep|exhaustive|comprehensive|make\s+sure|be\s+careful)",
-    )
-    .expect("invalid regex")
-});
+fn is_confused(message: &Message) -> bool {
+    CONFUSION_MARKERS
+        .iter()
+        .any(|marker| message.content.contains(marker))
+}
 
-static FAST_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(r"(?i)(quick|fast|simple|just|only|brief|short|don'?t\s+overthink)")
-        .expect("invalid regex")
-});
+/// Per-session state for incremental classification.
+///
+/// Caches the context-derived signals between calls so that classifying a
+/// new message only looks at messages and files added since the previous
+/// call. The cache assumes the context grows through the `SessionContext`
+/// API; call [`ClassifierSession::reset`] after replacing or rewriting a
+/// context in place without going through
+/// [`SessionContext::recount_tokens`]. A shrinking history, and any removal
+/// counted by [`SessionContext::messages_version`], is detected and rescanned
+/// automatically. Tool output tokens are read from
+/// [`SessionContext::total_tool_tokens`] rather than cached, so trimming tool
+/// outputs never leaves a stale total.
+#[derive(Debug, Clone, Default)]
+pub struct ClassifierSession {
+    messages_seen: usize,
+    messages_version: Option<u64>,
+    last_user_len: Option<usize>,
+    last_assistant_confused: bool,
+    files_seen: usize,
+    files_version: Option<u64>,
+    multiple_dirs: bool,
+    previous: Option<TaskComplexitySignals>,
+}
 
-static CONTINUATION_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
-    Regex::new(r"(?i)(continue|also|now|next|then|keep|more|another|additionally)")
-        .expect("invalid regex")
-});
+impl ClassifierSession {
+    /// Create an empty session.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Signals from the most recent classification, if any.
+    pub fn previous_signals(&self) -> Option<&TaskComplexitySignals> {
+        self.previous.as_ref()
+    }
+
+    /// Forget all cached state.
+    pub fn reset(&mut self) {
+        *self = Self::default();
+    }
+
+    fn sync(&mut self, context: &SessionContext) {
+        // Removing a message and appending another keeps the length, so the
+        // version catches history rewrites the length check would miss.
+        let messages_version = Some(context.messages_version());
+        if messages_version != self.messages_version || context.messages.len() < self.messages_seen
+        {
+            self.messages_version = messages_version;
+            self.messages_seen = 0;
+            self.last_user_len = None;
+            self.last_assistant_confused = false;
+        }
+        for message in &context.messages[self.messages_seen..] {
+            match message.role {
+                Role::User => self.last_user_len = Some(message.content.len()),
+                Role::Assistant => self.last_assistant_confused = is_confused(message),
+                _ => {}
+            }
+        }
+        self.messages_seen = context.messages.len();
+
+        // Caching a file under an existing path leaves the directory set
+        // unchanged, so only a change in the path set requires a rescan. The
+        // length check catches direct edits to `files`.
+        let files_version = Some(context.files_version());
+        if files_version != self.files_version || context.files.len() != self.files_seen {
+            self.multiple_dirs = context.spans_multiple_directories();
+            self.files_seen = context.files.len();
+            self.files_version = files_version;
+        }
+    }
+}
 
 impl PatternClassifier {
     /// Create a new classifier with default settings.
@@ -313,25 +405,7 @@ impl PatternClassifier {
     /// Analyze a query and context to extract complexity signals.
     pub fn analyze(&self, query: &str, context: &SessionContext) -> TaskComplexitySignals {
         let mut signals = TaskComplexitySignals::default();
-
-        // Query pattern analysis
-        signals.references_multiple_files = MULTI_FILE_PATTERN.is_match(query)
-            || query.matches('/').count() > 1
-            || query.matches(".rs").count() > 1
-            || query.matches(".py").count() > 1
-            || query.matches(".ts").count() > 1;
-
-        signals.requires_cross_context_reasoning = CROSS_CONTEXT_PATTERN.is_match(query);
-        signals.involves_temporal_reasoning = TEMPORAL_PATTERN.is_match(query);
-        signals.asks_about_patterns = PATTERN_ANALYSIS.is_match(query);
-        signals.debugging_task = DEBUGGING_PATTERN.is_match(query);
-        signals.requires_exhaustive_search = EXHAUSTIVE_PATTERN.is_match(query);
-        signals.security_review_task = SECURITY_PATTERN.is_match(query);
-        signals.architecture_analysis = ARCHITECTURE_PATTERN.is_match(query);
-
-        // User intent signals
-        signals.user_wants_thorough = THOROUGH_PATTERN.is_match(query);
-        signals.user_wants_fast = FAST_PATTERN.is_match(query);
+        let query_is_continuation = apply_query_signals(&mut signals, query);
 
         // Context analysis
         signals.context_has_multiple_domains = context.spans_multiple_directories();
@@ -339,31 +413,76 @@ impl PatternClassifier {
         signals.recent_tool_outputs_large = context.total_tool_tokens() > 10000;
 
         // Historical signals
-        if let Some(last_assistant) = context.last_assistant_message() {
-            signals.previous_turn_was_confused = last_assistant.content.contains("I'm not sure")
-                || last_assistant.content.contains("Could you clarify")
-                || last_assistant.content.contains("I need more context");
-        }
-
-        signals.task_is_continuation = CONTINUATION_PATTERN.is_match(query)
+        signals.previous_turn_was_confused =
+            context.last_assistant_message().is_some_and(is_confused);
+        signals.task_is_continuation = query_is_continuation
             || context
                 .last_user_message()
-                .map_or(false, |m| m.content.len() < 50);
+                .is_some_and(|m| m.content.len() < SHORT_FOLLOW_UP_LEN);
 
         signals
     }
 
+    /// Analyze a query using state cached in `session` from earlier calls.
+    ///
+    /// Produces the same signals as [`Self::analyze`], but the context is
+    /// only scanned from where the previous call on this session left off.
+    pub fn analyze_incremental(
+        &self,
+        session: &mut ClassifierSession,
+        query: &str,
+        context: &SessionContext,
+    ) -> TaskComplexitySignals {
+        session.sync(context);
+
+        let mut signals = TaskComplexitySignals::default();
+        let query_is_continuation = apply_query_signals(&mut signals, query);
+
+        signals.context_has_multiple_domains = session.multiple_dirs;
+        signals.files_span_multiple_modules = session.files_seen > 3;
+        signals.recent_tool_outputs_large = context.total_tool_tokens() > 10000;
+
+        signals.previous_turn_was_confused = session.last_assistant_confused;
+        signals.task_is_continuation = query_is_continuation
+            || session
+                .last_user_len
+                .is_some_and(|len| len < SHORT_FOLLOW_UP_LEN);
+
+        session.previous = Some(signals.clone());
+        signals
+    }
+
     /// Determine if RLM should activate for the given query and context.
     pub fn should_activate(&self, query: &str, context: &SessionContext) -> ActivationDecision {
         if self.force_activation {
-            return ActivationDecision::activate(
-                "Force activation enabled",
-                100,
-                TaskComplexitySignals::default(),
-            );
+            return Self::forced();
+        }
+        self.decide(self.analyze(query, context))
+    }
+
+    /// Incremental form of [`Self::should_activate`]; see
+    /// [`Self::analyze_incremental`].
+    pub fn should_activate_incremental(
+        &self,
+        session: &mut ClassifierSession,
+        query: &str,
+        context: &SessionContext,
+    ) -> ActivationDecision {
+        if self.force_activation {
+            return Self::forced();
         }
+        self.decide(self.analyze_incremental(session, query, context))
+    }
 
-        let signals = self.analyze(query, context);
+    fn forced() -> ActivationDecision {
+        ActivationDecision::activate(
+            "Force activation enabled",
+            100,
+            TaskComplexitySignals::default(),
+        )
+    }
+
+    fn decide(&self, signals: TaskComplexitySignals) -> ActivationDecision {
         let score = signals.score();
         let active = signals.active_signals();
 
@@ -385,6 +504,7 @@ impl PatternClassifier {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::context::ToolOutput;
 
     #[test]
     fn test_signals_score() {
@@ -483,4 +603,129 @@ mod tests {
         assert!(decision.should_activate);
         assert_eq!(decision.score, 100);
     }
+
+    #[test]
+    fn test_incremental_matches_full_analysis() {
+        let classifier = PatternClassifier::new();
+        let mut session = ClassifierSession::new();
+        let mut ctx = SessionContext::new();
+
+        let turns = [
+            ("Just show me main", None),
+            (
+                "Why does the auth flow fail when the token expires?",
+                Some("/src/auth/mod.rs"),
+            ),
+            ("ok", Some("/src/lib.rs")),
+            (
+                "Find every place that constructs a Client",
+                Some("/tests/client.rs"),
+            ),
+            ("Refactor the whole system", Some("/src/utils/helpers.rs")),
+        ];
+        for (i, (query, file)) in turns.iter().enumerate() {
+            if let Some(path) = file {
+                ctx.cache_file(*path, "");
+            }
+            ctx.add_tool_output(ToolOutput::new("read", "x".repeat(12_000 * i)));
+
+            let full = classifier.analyze(query, &ctx);
+            let incremental = classifier.analyze_incremental(&mut session, query, &ctx);
+            assert_eq!(incremental, full, "turn {}: {}", i, query);
+            assert_eq!(session.previous_signals(), Some(&full));
+
+            ctx.add_user_message(*query);
+            ctx.add_assistant_message(if i % 2 == 0 {
+                "I'm not sure which module you mean."
+            } else {
+                "Done."
+            });
+        }
+    }
+
+    #[test]
+    fn test_incremental_rescans_after_trim() {
+        let classifier = PatternClassifier::new();
+        let mut session = ClassifierSession::new();
+        let mut ctx = SessionContext::new();
+        ctx.add_tool_output(ToolOutput::new("read", "x".repeat(50_000)));
+        ctx.add_tool_output(ToolOutput::new("ls", "a b c"));
+
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert!(signals.recent_tool_outputs_large);
+
+        ctx.trim_tool_outputs(1);
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert!(!signals.recent_tool_outputs_large);
+        assert_eq!(signals, classifier.analyze("what is this", &ctx));
+    }
+
+    #[test]
+    fn test_incremental_trim_then_append() {
+        let classifier = PatternClassifier::new();
+        let mut session = ClassifierSession::new();
+        let mut ctx = SessionContext::new();
+        for _ in 0..3 {
+            ctx.add_tool_output(ToolOutput::new("read", "x".repeat(20_000)));
+        }
+        classifier.analyze_incremental(&mut session, "what is this", &ctx);
+
+        // Trim and append so the output count ends where it started.
+        ctx.trim_tool_outputs(1);
+        ctx.add_tool_output(ToolOutput::new("ls", "a"));
+        ctx.add_tool_output(ToolOutput::new("ls", "b"));
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert_eq!(signals, classifier.analyze("what is this", &ctx));
+        assert!(!signals.recent_tool_outputs_large);
+    }
+
+    #[test]
+    fn test_incremental_rescans_swapped_files() {
+        let classifier = PatternClassifier::new();
+        let mut session = ClassifierSession::new();
+        let mut ctx = SessionContext::new();
+        ctx.cache_file("/src/a.rs", "");
+        ctx.cache_file("/src/b.rs", "");
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert!(!signals.context_has_multiple_domains);
+
+        // Same file count, different directory set.
+        ctx.remove_file("/src/b.rs");
+        ctx.cache_file("/tests/b.rs", "");
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert!(signals.context_has_multiple_domains);
+        assert_eq!(signals, classifier.analyze("what is this", &ctx));
+
+        // Direct edits followed by recount_tokens are picked up too.
+        ctx.files.remove("/tests/b.rs");
+        ctx.files.insert("/src/c.rs".into(), String::new());
+        ctx.recount_tokens();
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert!(!signals.context_has_multiple_domains);
+    }
+
+    #[test]
+    fn test_incremental_rescans_rewritten_history() {
+        let classifier = PatternClassifier::new();
+        let mut session = ClassifierSession::new();
+        let mut ctx = SessionContext::new();
+        ctx.add_user_message("Please refactor the authentication module");
+        ctx.add_assistant_message("I'm not sure what you mean.");
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert!(signals.previous_turn_was_confused);
+
+        // Same length, different last assistant turn.
+        ctx.remove_message(1);
+        ctx.add_assistant_message("Done.");
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert!(!signals.previous_turn_was_confused);
+        assert_eq!(signals, classifier.analyze("what is this", &ctx));
+
+        // Direct edits followed by recount_tokens are picked up too.
+        ctx.messages[1].content = "Could you clarify?".into();
+        ctx.recount_tokens();
+        let signals = classifier.analyze_incremental(&mut session, "what is this", &ctx);
+        assert!(signals.previous_turn_was_confused);
+        assert_eq!(signals, classifier.analyze("what is this", &ctx));
+    }
 }
@@ -18,9 +18,13 @@
 //! - SPEC-25.03: Variable access helpers for REPL
 //! - SPEC-25.04: Size tracking and limits
 
+use super::lazy::{ContentStore, LazyVariables};
 use super::types::SessionContext;
+use crate::error::Result;
 use serde::{Deserialize, Serialize};
+use serde_json::Value;
 use std::collections::HashMap;
+use std::sync::Arc;
 
 /// Size thresholds for context variables (SPEC-25.04).
 pub const WARN_SIZE_BYTES: usize = 100 * 1024; // 100 KB
@@ -35,6 +39,10 @@ pub struct SizeConfig {
     pub chunk_threshold: usize,
     /// Maximum total externalized context size (bytes).
     pub max_total_size: usize,
+    /// Optional token budget for the whole session, counted with the
+    /// session's tokenizer.
+    #[serde(default, skip_serializing_if = "Option::is_none")]
+    pub max_total_tokens: Option<usize>,
 }
 
 impl Default for SizeConfig {
@@ -43,10 +51,20 @@ impl Default for SizeConfig {
             warn_threshold: WARN_SIZE_BYTES,
             chunk_threshold: REQUIRE_CHUNKING_BYTES,
             max_total_size: 10 * 1024 * 1024, // 10 MB
+            max_total_tokens: None,
         }
     }
 }
 
+impl SizeConfig {
+    /// Check the session's running token total against `max_total_tokens`.
+    pub fn check_session_tokens(&self, ctx: &SessionContext) -> Option<SizeWarning> {
+        let max = self.max_total_tokens?;
+        let total = ctx.total_tokens();
+        (total > max).then_some(SizeWarning::TokenBudgetExceeded { total, max })
+    }
+}
+
 /// Size policy warning generated by `check_size_limits`.
 #[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
 pub enum SizeWarning {
@@ -64,6 +82,8 @@ pub enum SizeWarning {
     },
     /// Total size exceeds max configured limit.
     TotalSizeExceeded { total: usize, max: usize },
+    /// Session token total exceeds the configured token budget.
+    TokenBudgetExceeded { total: usize, max: usize },
 }
 
 impl SizeWarning {
@@ -90,6 +110,10 @@ impl SizeWarning {
                 "total externalized context exceeds max ({} bytes > {} bytes)",
                 total, max
             ),
+            Self::TokenBudgetExceeded { total, max } => format!(
+                "session context exceeds token budget ({} tokens > {} tokens)",
+                total, max
+            ),
         }
     }
 }
@@ -495,6 +519,116 @@ impl ExternalizedContext {
         code
     }
 
+    /// Get the externalized variables as untruncated JSON values.
+    ///
+    /// Unlike [`Self::repl_setup_code`], nothing is escaped into Python source
+    /// or truncated; pass the result to `ReplHandle::set_variables`, which
+    /// moves large values through shared memory.
+    pub fn repl_variables(&self, ctx: &SessionContext) -> Vec<(String, serde_json::Value)> {
+        use serde_json::json;
+
+        let mut vars = Vec::new();
+        if self.variables.contains_key("conversation") {
+            let messages = ctx
+                .messages
+                .iter()
+                .map(|msg| json!({"role": msg.role.to_string(), "content": msg.content}))
+                .collect();
+            vars.push((
+                "conversation".to_string(),
+                serde_json::Value::Array(messages),
+            ));
+        }
+        if self.variables.contains_key("files") {
+            vars.push(("files".to_string(), json!(ctx.files)));
+        }
+        if self.variables.contains_key("tool_outputs") {
+            let outputs = ctx
+                .tool_outputs
+                .iter()
+                .map(|output| {
+                    json!({
+                        "tool": output.tool_name,
+                        "content": output.content,
+                        "exit_code": output.exit_code.unwrap_or(0),
+                    })
+                })
+                .collect();
+            vars.push((
+                "tool_outputs".to_string(),
+                serde_json::Value::Array(outputs),
+            ));
+        }
+        if self.variables.contains_key("working_memory") {
+            vars.push(("working_memory".to_string(), json!(ctx.working_memory)));
+        }
+        vars
+    }
+
+    /// Get the externalized variables as lazy manifests.
+    ///
+    /// Like [`Self::repl_variables`], but each message, file and tool output
+    /// body at or above the store's minimum blob size is written once to
+    /// `store` and replaced by a content-hash reference. The REPL reads a
+    /// blob only when sandbox code first touches that item, and content
+    /// already in the store (from another session or recursion depth) is not
+    /// written again. Keep the returned lease alive while the REPL may read
+    /// the variables.
+    pub fn repl_lazy_variables(
+        &self,
+        ctx: &SessionContext,
+        store: &Arc<ContentStore>,
+    ) -> Result<LazyVariables> {
+        use serde_json::json;
+
+        let mut lease = store.lease();
+        let mut vars = Vec::new();
+        if self.variables.contains_key("conversation") {
+            let messages = ctx
+                .messages
+                .iter()
+                .map(|msg| {
+                    Ok(json!({
+                        "role": msg.role.to_string(),
+                        "content": lease.reference(&msg.content)?,
+                    }))
+                })
+                .collect::<Result<Vec<_>>>()?;
+            vars.push(("conversation".to_string(), Value::Array(messages)));
+        }
+        if self.variables.contains_key("files") {
+            let files = ctx
+                .files
+                .iter()
+                .map(|(path, content)| Ok((path.clone(), lease.reference(content)?)))
+                .collect::<Result<serde_json::Map<_, _>>>()?;
+            vars.push(("files".to_string(), Value::Object(files)));
+        }
+        if self.variables.contains_key("tool_outputs") {
+            let outputs = ctx
+                .tool_outputs
+                .iter()
+                .map(|output| {
+                    Ok(json!({
+                        "tool": output.tool_name,
+                        "content": lease.reference(&output.content)?,
+                        "exit_code": output.exit_code.unwrap_or(0),
+                    }))
+                })
+                .collect::<Result<Vec<_>>>()?;
+            vars.push(("tool_outputs".to_string(), Value::Array(outputs)));
+        }
+
+        let mut variables: Vec<(String, Value)> = vars
+            .into_iter()
+            .map(|(name, value)| (name, lease.wrap(value)))
+            .collect();
+        if self.variables.contains_key("working_memory") {
+            variables.push(("working_memory".to_string(), json!(ctx.working_memory)));
+        }
+        Ok(LazyVariables { variables, lease })
+    }
+
     /// Check size limits and return typed warnings.
     pub fn check_size_limits(&self, config: &SizeConfig) -> Vec<SizeWarning> {
         let mut warnings = Vec::new();
@@ -821,6 +955,14 @@ impl ContextSizeTracker {
         self.total_bytes += size;
     }
 
+    /// Stop tracking a variable, returning its last size.
+    pub fn remove(&mut self, name: &str) -> Option<usize> {
+        self.history.remove(name);
+        let size = self.current.remove(name)?;
+        self.total_bytes = self.total_bytes.saturating_sub(size);
+        Some(size)
+    }
+
     /// Check if a variable exceeds the warning threshold.
     pub fn exceeds_warning(&self, name: &str) -> bool {
         self.current.get(name).copied().unwrap_or(0) > WARN_SIZE_BYTES
@@ -909,6 +1051,7 @@ mod tests {
                     warn_threshold: 80_000,
                     chunk_threshold: 200_000,
                     max_total_size: 400_000,
+                    max_total_tokens: None,
                 },
             ),
         );
@@ -923,6 +1066,7 @@ mod tests {
                     warn_threshold: 80_000,
                     chunk_threshold: 200_000,
                     max_total_size: 400_000,
+                    max_total_tokens: None,
                 },
             ),
         );
@@ -937,6 +1081,7 @@ mod tests {
             warn_threshold: 80_000,
             chunk_threshold: 200_000,
             max_total_size: 400_000,
+            max_total_tokens: None,
         };
         let warnings = externalized.check_size_limits(&config);
 
@@ -962,6 +1107,7 @@ mod tests {
             warn_threshold: 64_000,
             chunk_threshold: 128_000,
             max_total_size: 600_000,
+            max_total_tokens: None,
         };
 
         externalized.auto_chunk(&config);
@@ -1128,4 +1274,43 @@ mod tests {
         assert!(setup.contains("files = {"));
         assert!(setup.contains("Helpers are preloaded in the sandbox"));
     }
+
+    #[test]
+    fn test_repl_variables_are_untruncated() {
+        let mut ctx = SessionContext::new();
+        ctx.add_user_message("Test message");
+        let big = "x\"y".repeat(10_000);
+        ctx.cache_file("/src/big.rs", &big);
+
+        let externalized = ExternalizedContext::from_session(&ctx, "Query");
+        let vars: HashMap<_, _> = externalized.repl_variables(&ctx).into_iter().collect();
+
+        assert_eq!(vars["files"]["/src/big.rs"], serde_json::Value::String(big));
+        assert_eq!(vars["conversation"][0]["content"], "Test message");
+    }
+
+    #[test]
+    fn test_repl_lazy_variables_reference_blobs() {
+        let mut ctx = SessionContext::new();
+        ctx.add_user_message("Test message");
+        let big = "fn main() {}\n".repeat(1_000);
+        ctx.cache_file("/src/a.rs", &big);
+        ctx.cache_file("/src/b.rs", &big);
+
+        let store = Arc::new(ContentStore::create(1 << 20).unwrap());
+        let externalized = ExternalizedContext::from_session(&ctx, "Query");
+        let lazy = externalized.repl_lazy_variables(&ctx, &store).unwrap();
+        let vars: HashMap<_, _> = lazy.variables.iter().cloned().collect();
+
+        let files = &vars["files"]["$rlm_lazy"]["value"];
+        assert_eq!(files["/src/a.rs"], files["/src/b.rs"]);
+        assert_eq!(files["/src/a.rs"]["$rlm_blob"]["len"], big.len());
+        assert_eq!(
+            vars["conversation"]["$rlm_lazy"]["value"][0]["content"],
+            "Test message"
+        );
+        // Two files with the same body share one blob.
+        assert_eq!(store.stats().writes, 1);
+        assert_eq!(lazy.lease.len(), 2);
+    }
 }
@@ -0,0 +1,615 @@
+//! Content-addressed blob store for lazy context externalization.
+//!
+//! Instead of shipping every message and file body to the REPL up front,
+//! [`ExternalizedContext::repl_lazy_variables`] writes each large item once
+//! into a [`ContentStore`] directory, keyed by a hash of its content, and
+//! sends the REPL a manifest of small references:
+//!
+//! ```json
+//! {"$rlm_lazy": {"dir": "/dev/shm/rlm-blobs-1-0", "value": {
+//!     "/src/main.rs": {"$rlm_blob": {"hash": "9f…", "len": 48213}}
+//! }}}
+//! ```
+//!
+//! The REPL materializes a blob only when sandbox code first reads that item.
+//! Identical content is written once no matter how many sessions or recursion
+//! depths externalize it. The store keeps its sizes in a
+//! [`ContextSizeTracker`] and evicts least-recently-used blobs that no live
+//! [`ContentLease`] references once the byte budget is exceeded.
+//!
+//! A store on a directory shared by several processes ([`ContentStore::open`])
+//! keeps the canonical `blob-<hash>` files in that directory and hard-links
+//! each blob it uses into a private `refs-*` subdirectory, which is what the
+//! REPL reads from. A canonical blob's link count is therefore a cross-process
+//! reference count: eviction only unlinks the store's own reference and
+//! deletes the canonical file once no other store links it, and a blob
+//! another process is using can never disappear from under its REPL.
+//!
+//! [`ExternalizedContext::repl_lazy_variables`]: super::ExternalizedContext::repl_lazy_variables
+
+use super::externalize::ContextSizeTracker;
+use crate::error::{Error, Result};
+use serde_json::{json, Value};
+use sha2::{Digest, Sha256};
+use std::collections::HashMap;
+#[cfg(unix)]
+use std::os::unix::fs::{DirBuilderExt, MetadataExt, OpenOptionsExt};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex};
+
+/// Key of the object wrapping a lazily externalized variable.
+pub const LAZY_ROOT_KEY: &str = "$rlm_lazy";
+
+/// Key of a reference to one blob inside a lazy variable.
+pub const LAZY_BLOB_KEY: &str = "$rlm_blob";
+
+/// Items smaller than this are sent inline by default.
+pub const DEFAULT_MIN_BLOB_BYTES: usize = 1024;
+
+/// Default byte budget before unreferenced blobs are evicted.
+pub const DEFAULT_BLOB_BUDGET_BYTES: usize = 256 * 1024 * 1024;
+
+static NEXT_STORE: AtomicU64 = AtomicU64::new(0);
+
+/// Distinguishes temporary files of concurrent blob writes.
+static NEXT_TMP: AtomicU64 = AtomicU64::new(0);
+
+/// SHA-256 of blob content, stable across processes.
+///
+/// Blobs are deduplicated by name alone, so the hash must be
+/// collision-resistant: equal names mean equal content.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub struct ContentHash(pub [u8; 32]);
+
+impl ContentHash {
+    /// Length of the binary hash in bytes.
+    pub const LEN: usize = 32;
+
+    /// Hash `bytes`.
+    pub fn of(bytes: &[u8]) -> Self {
+        Self(Sha256::digest(bytes).into())
+    }
+
+    /// Parse the lowercase hex form produced by `Display`.
+    pub fn from_hex(hex: &str) -> Option<Self> {
+        if hex.len() != Self::LEN * 2 || !hex.is_ascii() {
+            return None;
+        }
+        let mut hash = [0u8; Self::LEN];
+        for (i, byte) in hash.iter_mut().enumerate() {
+            *byte = u8::from_str_radix(&hex[i * 2..i * 2 + 2], 16).ok()?;
+        }
+        Some(Self(hash))
+    }
+}
+
+impl std::fmt::Display for ContentHash {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        for byte in &self.0 {
+            write!(f, "{:02x}", byte)?;
+        }
+        Ok(())
+    }
+}
+
+/// Counters describing a [`ContentStore`].
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct ContentStoreStats {
+    /// Blobs currently on disk.
+    pub blobs: usize,
+    /// Bytes currently on disk.
+    pub bytes: usize,
+    /// Puts satisfied by an existing blob.
+    pub hits: u64,
+    /// Blobs written.
+    pub writes: u64,
+    /// Blobs evicted to stay within budget.
+    pub evictions: u64,
+}
+
+#[derive(Debug)]
+struct BlobEntry {
+    last_used: u64,
+    pins: usize,
+}
+
+#[derive(Debug, Default)]
+struct StoreState {
+    entries: HashMap<ContentHash, BlobEntry>,
+    sizes: ContextSizeTracker,
+    tick: u64,
+    stats: ContentStoreStats,
+}
+
+/// Directory of content-addressed blobs shared by lazy externalizations.
+///
+/// Share one store (behind an `Arc`) between a session and its recursive
+/// sub-calls so repeated context is written once.
+#[derive(Debug)]
+pub struct ContentStore {
+    /// Directory the REPL reads `blob-<hash>` files from; removed on drop.
+    dir: PathBuf,
+    /// Directory of canonical blobs shared with other processes, if any.
+    shared: Option<PathBuf>,
+    budget_bytes: usize,
+    min_blob_bytes: usize,
+    state: Mutex<StoreState>,
+}
+
+impl ContentStore {
+    /// Create a private store on a memory-backed filesystem where available.
+    /// The directory is removed when the store is dropped.
+    pub fn create(budget_bytes: usize) -> Result<Self> {
+        let base = Path::new("/dev/shm");
+        let base = if base.is_dir() {
+            base.to_path_buf()
+        } else {
+            std::env::temp_dir()
+        };
+        let dir = base.join(format!(
+            "rlm-blobs-{}-{}",
+            std::process::id(),
+            NEXT_STORE.fetch_add(1, Ordering::Relaxed)
+        ));
+        let mut builder = std::fs::DirBuilder::new();
+        #[cfg(unix)]
+        builder.mode(0o700);
+        builder
+            .create(&dir)
+            .map_err(|e| Error::Internal(format!("Failed to create blob dir: {}", e)))?;
+        Ok(Self::with_dir(dir, None, budget_bytes))
+    }
+
+    /// Use an existing directory, e.g. one shared by several processes.
+    ///
+    /// Blobs already present are reused and the directory is left in place;
+    /// only this store's private reference directory inside it is removed
+    /// when the store is dropped.
+    pub fn open(dir: impl Into<PathBuf>, budget_bytes: usize) -> Result<Self> {
+        let shared = dir.into();
+        // Directories created here are private like `create`'s; an
+        // existing directory keeps whatever sharing its owner set up.
+        let mut builder = std::fs::DirBuilder::new();
+        builder.recursive(true);
+        #[cfg(unix)]
+        builder.mode(0o700);
+        builder
+            .create(&shared)
+            .map_err(|e| Error::Internal(format!("Failed to open blob dir: {}", e)))?;
+        let refs = shared.join(format!(
+            "refs-{}-{}",
+            std::process::id(),
+            NEXT_STORE.fetch_add(1, Ordering::Relaxed)
+        ));
+        let mut builder = std::fs::DirBuilder::new();
+        #[cfg(unix)]
+        builder.mode(0o700);
+        builder
+            .create(&refs)
+            .map_err(|e| Error::Internal(format!("Failed to create blob dir: {}", e)))?;
+        Ok(Self::with_dir(refs, Some(shared), budget_bytes))
+    }
+
+    fn with_dir(dir: PathBuf, shared: Option<PathBuf>, budget_bytes: usize) -> Self {
+        Self {
+            dir,
+            shared,
+            budget_bytes,
+            min_blob_bytes: DEFAULT_MIN_BLOB_BYTES,
+            state: Mutex::new(StoreState::default()),
+        }
+    }
+
+    /// Send items shorter than `bytes` inline instead of as blobs.
+    pub fn with_min_blob_bytes(mut self, bytes: usize) -> Self {
+        self.min_blob_bytes = bytes;
+        self
+    }
+
+    /// Directory the REPL reads blobs from.
+    pub fn dir(&self) -> &Path {
+        &self.dir
+    }
+
+    /// Minimum item size stored as a blob.
+    pub fn min_blob_bytes(&self) -> usize {
+        self.min_blob_bytes
+    }
+
+    /// Current counters.
+    pub fn stats(&self) -> ContentStoreStats {
+        self.lock().stats
+    }
+
+    /// Start a lease that keeps the blobs it references from being evicted.
+    pub fn lease(self: &Arc<Self>) -> ContentLease {
+        ContentLease {
+            store: Arc::clone(self),
+            pinned: Vec::new(),
+        }
+    }
+
+    /// Read a blob back, or `None` if neither this store nor (for a shared
+    /// directory) any other process holds it.
+    pub fn read(&self, hash: ContentHash) -> Result<Option<String>> {
+        let known = self.lock().entries.contains_key(&hash);
+        let path = match (&self.shared, known) {
+            (Some(shared), false) => Self::blob_path_in(shared, hash),
+            _ => self.blob_path(hash),
+        };
+        let content = match std::fs::read_to_string(path) {
+            Ok(content) => content,
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => return Ok(None),
+            Err(e) => return Err(Error::Internal(format!("Failed to read blob: {}", e))),
+        };
+        // Another process wrote this one; don't trust the name blindly.
+        if !known && ContentHash::of(content.as_bytes()) != hash {
+            return Err(Error::Internal(format!(
+                "Blob {} does not match its hash",
+                hash
+            )));
+        }
+        Ok(Some(content))
+    }
+
+    fn lock(&self) -> std::sync::MutexGuard<'_, StoreState> {
+        self.state.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    fn blob_path_in(dir: &Path, hash: ContentHash) -> PathBuf {
+        dir.join(format!("blob-{}", hash))
+    }
+
+    fn blob_path(&self, hash: ContentHash) -> PathBuf {
+        Self::blob_path_in(&self.dir, hash)
+    }
+
+    /// Store `content` (if new) and pin it.
+    fn put(&self, content: &str) -> Result<ContentHash> {
+        let hash = ContentHash::of(content.as_bytes());
+        let mut state = self.lock();
+        state.tick += 1;
+        let tick = state.tick;
+        if let Some(entry) = state.entries.get_mut(&hash) {
+            entry.last_used = tick;
+            entry.pins += 1;
+            state.stats.hits += 1;
+            return Ok(hash);
+        }
+
+        if self.materialize(hash, content.as_bytes())? {
+            state.stats.writes += 1;
+        } else {
+            state.stats.hits += 1;
+        }
+        state.entries.insert(
+            hash,
+            BlobEntry {
+                last_used: tick,
+                pins: 1,
+            },
+        );
+        state.sizes.update(&hash.to_string(), content.len());
+        self.evict(&mut state);
+        Ok(hash)
+    }
+
+    /// Make `blob-<hash>` readable in [`Self::dir`], reusing an existing copy
+    /// when there is one. Returns whether the body had to be written.
+    fn materialize(&self, hash: ContentHash, bytes: &[u8]) -> Result<bool> {
+        let io_err = |e: std::io::Error| Error::Internal(format!("Failed to write blob: {}", e));
+        let path = self.blob_path(hash);
+        let Some(shared) = &self.shared else {
+            if Self::is_intact(&path, hash, bytes.len()) {
+                return Ok(false);
+            }
+            Self::write_blob(&path, bytes)?;
+            return Ok(true);
+        };
+
+        // Take a reference to the canonical copy before trusting it. If it
+        // is evicted concurrently, the hard link keeps our copy alive.
+        let canonical = Self::blob_path_in(shared, hash);
+        let _ = std::fs::remove_file(&path);
+        match std::fs::hard_link(&canonical, &path) {
+            Ok(()) if Self::is_intact(&path, hash, bytes.len()) => return Ok(false),
+            Ok(()) => std::fs::remove_file(&path).map_err(io_err)?,
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => {}
+            Err(e) => return Err(io_err(e)),
+        }
+        Self::write_blob(&path, bytes)?;
+        // Publish for other processes; a failure only costs them a rewrite.
+        let _ = std::fs::remove_file(&canonical);
+        let _ = std::fs::hard_link(&path, &canonical);
+        Ok(true)
+    }
+
+    /// Whether `path` holds exactly the blob for `hash`, `len` bytes long.
+    ///
+    /// A copy in a shared directory may have been written by another process
+    /// or user, so its contents are hashed rather than trusted by name and
+    /// length; reading it back is still cheaper than rewriting it.
+    fn is_intact(path: &Path, hash: ContentHash, len: usize) -> bool {
+        let sized =
+            std::fs::metadata(path).is_ok_and(|meta| meta.is_file() && meta.len() == len as u64);
+        sized && std::fs::read(path).is_ok_and(|bytes| ContentHash::of(&bytes) == hash)
+    }
+
+    fn write_blob(path: &Path, bytes: &[u8]) -> Result<()> {
+        let io_err = |e: std::io::Error| Error::Internal(format!("Failed to write blob: {}", e));
+        // Write under a unique temporary name so readers never observe a
+        // partial blob and concurrent writers never share a file.
+        let mut tmp = path.as_os_str().to_owned();
+        tmp.push(format!(
+            ".tmp{}-{}",
+            std::process::id(),
+            NEXT_TMP.fetch_add(1, Ordering::Relaxed)
+        ));
+        let tmp = PathBuf::from(tmp);
+        let mut options = std::fs::OpenOptions::new();
+        options.write(true).create_new(true);
+        #[cfg(unix)]
+        options.mode(0o600);
+        let result = options.open(&tmp).and_then(|mut file| {
+            std::io::Write::write_all(&mut file, bytes)?;
+            std::fs::rename(&tmp, path)
+        });
+        if result.is_err() {
+            let _ = std::fs::remove_file(&tmp);
+        }
+        result.map_err(io_err)
+    }
+
+    /// Delete this store's copy of `hash`, and the shared canonical copy once
+    /// no other store references it.
+    fn discard(&self, hash: ContentHash) {
+        let _ = std::fs::remove_file(self.blob_path(hash));
+        #[cfg(unix)]
+        if let Some(shared) = &self.shared {
+            let canonical = Self::blob_path_in(shared, hash);
+            // A link count of one means only the canonical name is left. A
+            // store that links it right after keeps its own copy regardless.
+            if std::fs::metadata(&canonical).is_ok_and(|meta| meta.nlink() == 1) {
+                let _ = std::fs::remove_file(&canonical);
+            }
+        }
+    }
+
+    fn unpin(&self, hashes: &[ContentHash]) {
+        let mut state = self.lock();
+        for hash in hashes {
+            if let Some(entry) = state.entries.get_mut(hash) {
+                entry.pins = entry.pins.saturating_sub(1);
+            }
+        }
+        self.evict(&mut state);
+    }
+
+    /// Drop least-recently-used unpinned blobs until within budget.
+    fn evict(&self, state: &mut StoreState) {
+        if state.sizes.total_bytes > self.budget_bytes {
+            let mut candidates: Vec<(u64, ContentHash)> = state
+                .entries
+                .iter()
+                .filter(|(_, entry)| entry.pins == 0)
+                .map(|(hash, entry)| (entry.last_used, *hash))
+                .collect();
+            candidates.sort_unstable_by_key(|(last_used, _)| *last_used);
+            for (_, hash) in candidates {
+                if state.sizes.total_bytes <= self.budget_bytes {
+                    break;
+                }
+                state.entries.remove(&hash);
+                state.sizes.remove(&hash.to_string());
+                self.discard(hash);
+                state.stats.evictions += 1;
+            }
+        }
+        state.stats.blobs = state.entries.len();
+        state.stats.bytes = state.sizes.total_bytes;
+    }
+}
+
+impl Drop for ContentStore {
+    fn drop(&mut self) {
+        // For a shared directory this drops only our references; canonical
+        // blobs stay for other processes and later stores to reuse.
+        let _ = std::fs::remove_dir_all(&self.dir);
+    }
+}
+
+/// Pins the blobs referenced by one lazy externalization until dropped.
+///
+/// Keep the lease alive for as long as the REPL may read the variables.
+#[derive(Debug)]
+pub struct ContentLease {
+    store: Arc<ContentStore>,
+    pinned: Vec<ContentHash>,
+}
+
+impl ContentLease {
+    /// Store backing this lease.
+    pub fn store(&self) -> &Arc<ContentStore> {
+        &self.store
+    }
+
+    /// Number of blob references held.
+    pub fn len(&self) -> usize {
+        self.pinned.len()
+    }
+
+    /// Whether the lease holds no blob references.
+    pub fn is_empty(&self) -> bool {
+        self.pinned.is_empty()
+    }
+
+    /// Return `content` inline if it is small, otherwise store it and return
+    /// a blob reference.
+    pub fn reference(&mut self, content: &str) -> Result<Value> {
+        if content.len() < self.store.min_blob_bytes {
+            return Ok(Value::String(content.to_string()));
+        }
+        let hash = self.store.put(content)?;
+        self.pinned.push(hash);
+        Ok(json!({ LAZY_BLOB_KEY: { "hash": hash.to_string(), "len": content.len() } }))
+    }
+
+    /// Wrap a manifest built with [`Self::reference`] as a lazy variable.
+    pub fn wrap(&self, value: Value) -> Value {
+        json!({ LAZY_ROOT_KEY: {
+            "dir": self.store.dir.to_string_lossy(),
+            "value": value,
+        }})
+    }
+}
+
+impl Drop for ContentLease {
+    fn drop(&mut self) {
+        self.store.unpin(&self.pinned);
+    }
+}
+
+/// Lazily externalized REPL variables and the lease keeping them readable.
+#[derive(Debug)]
+pub struct LazyVariables {
+    /// `(name, manifest)` pairs for `ReplHandle::set_variables`.
+    pub variables: Vec<(String, Value)>,
+    /// Keeps the referenced blobs on disk.
+    pub lease: ContentLease,
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_blobs_are_deduplicated_and_pinned() {
+        let store = Arc::new(ContentStore::create(10_000).unwrap().with_min_blob_bytes(8));
+        let body = "x".repeat(6_000);
+
+        let mut first = store.lease();
+        assert_eq!(first.reference("tiny").unwrap(), "tiny");
+        let reference = first.reference(&body).unwrap();
+        let hash = reference[LAZY_BLOB_KEY]["hash"]
+            .as_str()
+            .unwrap()
+            .to_string();
+
+        let mut second = store.lease();
+        assert_eq!(second.reference(&body).unwrap(), reference);
+        let stats = store.stats();
+        assert_eq!((stats.writes, stats.hits, stats.blobs), (1, 1, 1));
+        assert!(store.dir().join(format!("blob-{}", hash)).exists());
+
+        // A second large blob overflows the budget, but both are pinned.
+        second.reference(&"y".repeat(6_000)).unwrap();
+        assert_eq!(store.stats().evictions, 0);
+
+        drop(first);
+        drop(second);
+        // Unpinned and over budget: the older blob goes first.
+        let stats = store.stats();
+        assert_eq!(stats.evictions, 1);
+        assert_eq!(stats.bytes, 6_000);
+        assert!(store
+            .read(ContentHash::of(body.as_bytes()))
+            .unwrap()
+            .is_none());
+    }
+
+    #[test]
+    fn test_content_hash_hex_roundtrip() {
+        let hash = ContentHash::of(b"hello");
+        assert_eq!(hash.to_string().len(), 64);
+        assert_eq!(ContentHash::from_hex(&hash.to_string()), Some(hash));
+        assert_eq!(ContentHash::from_hex("abc"), None);
+        assert_eq!(ContentHash::from_hex(&"g".repeat(64)), None);
+    }
+
+    #[test]
+    fn test_shared_dir_blobs_are_reference_counted() {
+        let dir = tempfile::tempdir().unwrap();
+        let open = || {
+            Arc::new(
+                ContentStore::open(dir.path(), 1_000)
+                    .unwrap()
+                    .with_min_blob_bytes(8),
+            )
+        };
+        let (a, b) = (open(), open());
+        let body = "z".repeat(4_000);
+        let hash = ContentHash::of(body.as_bytes());
+        let canonical = dir.path().join(format!("blob-{}", hash));
+
+        let mut lease_a = a.lease();
+        lease_a.reference(&body).unwrap();
+        assert_eq!(a.stats().writes, 1);
+        assert!(canonical.exists());
+
+        // Another store reads blobs it never stored, and reuses them
+        // without writing them again.
+        assert_eq!(b.read(hash).unwrap().as_deref(), Some(body.as_str()));
+        let mut lease_b = b.lease();
+        lease_b.reference(&body).unwrap();
+        assert_eq!((b.stats().writes, b.stats().hits), (0, 1));
+
+        // Evicting from `a` drops only a's reference; b's REPL still sees it.
+        drop(lease_a);
+        assert_eq!(a.stats().evictions, 1);
+        assert!(!a.dir().join(format!("blob-{}", hash)).exists());
+        assert!(b.dir().join(format!("blob-{}", hash)).exists());
+        assert!(canonical.exists());
+
+        // The last reference takes the canonical copy with it.
+        drop(lease_b);
+        assert_eq!(b.stats().evictions, 1);
+        #[cfg(unix)]
+        assert!(!canonical.exists());
+
+        // A damaged canonical copy is replaced rather than reused, and a
+        // foreign blob whose content does not match its name is rejected.
+        let other = "q".repeat(500);
+        let other_hash = ContentHash::of(other.as_bytes());
+        let other_path = dir.path().join(format!("blob-{}", other_hash));
+        std::fs::write(&other_path, "short").unwrap();
+        let mut lease = a.lease();
+        lease.reference(&other).unwrap();
+        assert_eq!(a.stats().writes, 2);
+        assert_eq!(std::fs::read_to_string(&other_path).unwrap(), other);
+
+        // So is one of the right length but the wrong content.
+        let same_len = "r".repeat(500);
+        let same_len_path = dir
+            .path()
+            .join(format!("blob-{}", ContentHash::of(same_len.as_bytes())));
+        std::fs::write(&same_len_path, "s".repeat(500)).unwrap();
+        lease.reference(&same_len).unwrap();
+        assert_eq!(a.stats().writes, 3);
+        assert_eq!(std::fs::read_to_string(&same_len_path).unwrap(), same_len);
+
+        let forged = ContentHash::of(b"forged");
+        std::fs::write(dir.path().join(format!("blob-{}", forged)), "not it").unwrap();
+        assert!(b.read(forged).is_err());
+
+        let refs = (a.dir().to_path_buf(), b.dir().to_path_buf());
+        drop(lease);
+        drop((a, b));
+        assert!(!refs.0.exists() && !refs.1.exists());
+        assert!(dir.path().exists());
+    }
+
+    #[cfg(unix)]
+    #[test]
+    fn test_open_creates_private_shared_dir() {
+        use std::os::unix::fs::PermissionsExt;
+
+        let base = tempfile::tempdir().unwrap();
+        let shared = base.path().join("nested").join("blobs");
+        let _store = ContentStore::open(&shared, 1_000).unwrap();
+        for dir in [shared.parent().unwrap(), shared.as_path()] {
+            let mode = std::fs::metadata(dir).unwrap().permissions().mode();
+            assert_eq!(mode & 0o777, 0o700);
+        }
+    }
+}
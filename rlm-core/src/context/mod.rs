@@ -26,12 +26,28 @@
 //! // peek(conversation, 0, 5)  -> first 5 messages
 //! // search(files, "auth")     -> files matching pattern
 //! ```
+//!
+//! # Snapshots
+//!
+//! [`SnapshotWriter`] appends checkpoints to a binary snapshot where file
+//! and tool-output bodies are stored once by content hash and each
+//! checkpoint adds only new messages. [`SessionSnapshot`] resumes from a
+//! memory-mapped snapshot, reading bodies only when they are requested.
 
 mod externalize;
+mod lazy;
+mod snapshot;
+mod tokenizer;
 mod types;
 
 pub use externalize::{
     ContextSizeTracker, ContextVarType, ContextVariable, ExternalizationConfig,
     ExternalizedContext, SizeConfig, SizeWarning, VariableAccessHelper,
 };
+pub use lazy::{
+    ContentHash, ContentLease, ContentStore, ContentStoreStats, LazyVariables,
+    DEFAULT_BLOB_BUDGET_BYTES, DEFAULT_MIN_BLOB_BYTES,
+};
+pub use snapshot::{CheckpointStats, SessionSnapshot, SnapshotWriter};
+pub use tokenizer::{BpeTokenizer, Tokenizer};
 pub use types::{Message, Role, SessionContext, ToolOutput};
@@ -0,0 +1,842 @@
+//! Append-only binary snapshots of a [`SessionContext`].
+//!
+//! Checkpointing through JSON re-encodes every cached file and tool output
+//! on every turn. A snapshot file is instead a log that a [`SnapshotWriter`]
+//! appends to as the session grows:
+//!
+//! ```text
+//! header      MAGIC, version u32, reserved u32
+//! record      tag u8, payload length u64, checksum [u8; 8], payload
+//!   blob        ContentHash (SHA-256), then the raw UTF-8 body
+//!   messages    JSON: messages kept from the previous checkpoint (`base`)
+//!               and the ones appended since
+//!   state       JSON: file and tool-output tables with bodies replaced by
+//!               blob hashes, plus working memory; commits the checkpoint
+//! ```
+//!
+//! Bodies are content-addressed, so a file or tool output that has not
+//! changed since an earlier checkpoint is referenced rather than rewritten,
+//! and only new messages are written. [`SessionSnapshot`] maps the file,
+//! replays the committed records and borrows bodies straight from the
+//! mapping when they are asked for.
+//!
+//! The checksum is the first 8 bytes of SHA-256 over the tag, length and
+//! payload. Replay stops at the first record that is incomplete, fails its
+//! checksum or does not decode; whatever follows the last `state` record
+//! before that point is an interrupted checkpoint and is ignored. Bytes are
+//! never changed in place: a snapshot that is recreated, or recovered after
+//! an interrupted checkpoint, is written to a new file and renamed over the
+//! old one, so existing mappings stay valid.
+//!
+//! ```rust,ignore
+//! let mut writer = SnapshotWriter::append("session.rlmsnap")?;
+//! writer.checkpoint(&ctx)?; // every turn
+//!
+//! let snapshot = SessionSnapshot::open("session.rlmsnap")?;
+//! let main = snapshot.file("/src/main.rs")?; // borrowed from the mapping
+//! let ctx = snapshot.to_context()?;
+//! ```
+
+use super::lazy::ContentHash;
+use super::types::{Message, SessionContext, ToolOutput};
+use crate::error::{Error, Result};
+use chrono::{DateTime, Utc};
+use memmap2::Mmap;
+use serde::{Deserialize, Serialize};
+use serde_json::Value;
+use sha2::{Digest, Sha256};
+use std::collections::{HashMap, HashSet};
+use std::fs::{File, OpenOptions};
+use std::io::{BufWriter, Write};
+use std::ops::Range;
+#[cfg(unix)]
+use std::os::unix::fs::OpenOptionsExt;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+
+/// First bytes of a session snapshot.
+const MAGIC: &[u8; 8] = b"RLMSNAP\0";
+const VERSION: u32 = 1;
+
+const HEADER_LEN: usize = 16;
+/// Tag byte, u64 payload length, then the checksum.
+const RECORD_HEADER_LEN: usize = 9 + CHECKSUM_LEN;
+const CHECKSUM_LEN: usize = 8;
+const HASH_LEN: usize = ContentHash::LEN;
+
+const TAG_BLOB: u8 = 1;
+const TAG_MESSAGES: u8 = 2;
+const TAG_STATE: u8 = 3;
+
+fn corrupt(what: &str) -> Error {
+    Error::Internal(format!("Corrupt session snapshot: {}", what))
+}
+
+fn io_err(e: std::io::Error) -> Error {
+    Error::Internal(format!("Session snapshot I/O failed: {}", e))
+}
+
+/// Suffix counter for temporary snapshot files.
+static NEXT_TMP: AtomicU64 = AtomicU64::new(0);
+
+fn file_header() -> [u8; HEADER_LEN] {
+    let mut header = [0u8; HEADER_LEN];
+    header[..MAGIC.len()].copy_from_slice(MAGIC);
+    header[8..12].copy_from_slice(&VERSION.to_le_bytes());
+    header
+}
+
+/// Checksum of a record from its tag and length bytes and its payload.
+fn record_checksum(head: &[u8], parts: &[&[u8]]) -> [u8; CHECKSUM_LEN] {
+    let mut hasher = Sha256::new();
+    hasher.update(head);
+    for part in parts {
+        hasher.update(part);
+    }
+    let digest = hasher.finalize();
+    digest[..CHECKSUM_LEN]
+        .try_into()
+        .expect("CHECKSUM_LEN bytes")
+}
+
+/// Write a new file for `path` with `fill` and rename it into place.
+///
+/// Readers that mapped the previous file keep its inode, so they never see
+/// it truncated under them. The new file is synced before the rename.
+fn replace_file(path: &Path, fill: impl FnOnce(&mut File) -> std::io::Result<()>) -> Result<File> {
+    let mut tmp = path.as_os_str().to_owned();
+    tmp.push(format!(
+        ".tmp{}-{}",
+        std::process::id(),
+        NEXT_TMP.fetch_add(1, Ordering::Relaxed)
+    ));
+    let tmp = PathBuf::from(tmp);
+    let mut options = OpenOptions::new();
+    options.write(true).create_new(true);
+    #[cfg(unix)]
+    options.mode(0o600);
+    let result = options.open(&tmp).and_then(|mut file| {
+        fill(&mut file)?;
+        file.sync_data()?;
+        std::fs::rename(&tmp, path)?;
+        Ok(file)
+    });
+    if result.is_err() {
+        let _ = std::fs::remove_file(&tmp);
+    }
+    result.map_err(io_err)
+}
+
+fn sync_file(out: &mut BufWriter<File>) -> std::io::Result<()> {
+    out.get_ref().sync_data()
+}
+
+fn parse_hash(hex: &str) -> Result<ContentHash> {
+    ContentHash::from_hex(hex).ok_or_else(|| corrupt("bad blob hash"))
+}
+
+fn message_hash(message: &Message) -> Result<ContentHash> {
+    Ok(ContentHash::of(&serde_json::to_vec(message)?))
+}
+
+#[derive(Serialize)]
+struct MessagesOut<'a> {
+    base: usize,
+    messages: &'a [Message],
+}
+
+#[derive(Deserialize)]
+struct MessagesIn {
+    /// Messages kept from the previous checkpoint; `messages` follow them.
+    base: usize,
+    messages: Vec<Message>,
+}
+
+#[derive(Serialize)]
+struct StateOut<'a> {
+    files: Vec<(&'a str, String)>,
+    tool_outputs: Vec<ToolOutputOut<'a>>,
+    working_memory: &'a HashMap<String, Value>,
+}
+
+#[derive(Deserialize)]
+struct StateIn {
+    files: Vec<(String, String)>,
+    tool_outputs: Vec<ToolOutputIn>,
+    working_memory: HashMap<String, Value>,
+}
+
+#[derive(Serialize)]
+struct ToolOutputOut<'a> {
+    tool_name: &'a str,
+    content: String,
+    exit_code: Option<i32>,
+    timestamp: Option<DateTime<Utc>>,
+    metadata: &'a Option<HashMap<String, Value>>,
+}
+
+#[derive(Deserialize)]
+struct ToolOutputIn {
+    tool_name: String,
+    /// Blob hash of the output body.
+    content: String,
+    exit_code: Option<i32>,
+    timestamp: Option<DateTime<Utc>>,
+    metadata: Option<HashMap<String, Value>>,
+}
+
+/// What one [`SnapshotWriter::checkpoint`] appended.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct CheckpointStats {
+    /// Bodies appended because the file did not hold them yet.
+    pub blobs_written: usize,
+    /// Bodies referenced from earlier records instead of rewritten.
+    pub blobs_reused: usize,
+    /// Messages appended.
+    pub messages_written: usize,
+    /// Whether the message list was rewritten from the start, either because
+    /// this is the first checkpoint or because the first message changed.
+    pub full: bool,
+    /// Bytes appended.
+    pub bytes_written: u64,
+}
+
+/// Streams checkpoints of a [`SessionContext`] into a snapshot.
+///
+/// Each checkpoint appends only bodies the stream does not already hold and
+/// the messages from the first one that changed since the previous
+/// checkpoint, which is the end of the list when messages are only
+/// appended. Finding it hashes every message, so edits anywhere in the
+/// history are caught. When writing to a file, each checkpoint is synced to
+/// disk before it returns. After an error, discard the writer and resume
+/// with [`SnapshotWriter::append`]. A snapshot has a single writer at a time.
+pub struct SnapshotWriter<W: Write = BufWriter<File>> {
+    out: W,
+    /// Makes flushed bytes durable; `None` for streams that cannot sync.
+    sync: Option<fn(&mut W) -> std::io::Result<()>>,
+    /// Blobs already in the stream.
+    blobs: HashSet<ContentHash>,
+    /// Hash of each message covered by the last checkpoint.
+    message_hashes: Vec<ContentHash>,
+    bytes_written: u64,
+}
+
+impl SnapshotWriter {
+    /// Create a snapshot at `path`, replacing any existing one.
+    ///
+    /// The new snapshot is renamed over the old file rather than truncating
+    /// it, so readers that still map the old file are unaffected.
+    pub fn create(path: impl AsRef<Path>) -> Result<Self> {
+        let file = replace_file(path.as_ref(), |file| file.write_all(&file_header()))?;
+        Ok(Self {
+            out: BufWriter::new(file),
+            sync: Some(sync_file),
+            blobs: HashSet::new(),
+            message_hashes: Vec::new(),
+            bytes_written: HEADER_LEN as u64,
+        })
+    }
+
+    /// Continue the snapshot at `path`, creating it if it does not exist.
+    ///
+    /// Blobs already in the file are reused, and the next checkpoint is a
+    /// delta against the last committed one. If an interrupted checkpoint
+    /// follows it, the committed prefix is copied to a new file that
+    /// replaces the old one.
+    pub fn append(path: impl AsRef<Path>) -> Result<Self> {
+        let path = path.as_ref();
+        match std::fs::metadata(path) {
+            Ok(meta) if meta.len() > 0 => {}
+            Ok(_) => return Self::create(path),
+            Err(e) if e.kind() == std::io::ErrorKind::NotFound => return Self::create(path),
+            Err(e) => return Err(io_err(e)),
+        }
+
+        let snapshot = SessionSnapshot::open(path)?;
+        let committed = snapshot.committed_len;
+        let blobs = snapshot.blobs.keys().copied().collect();
+        let message_hashes = snapshot
+            .messages
+            .iter()
+            .map(message_hash)
+            .collect::<Result<Vec<_>>>()?;
+        let file = if snapshot.map.len() > committed {
+            let prefix = &snapshot.map[..committed];
+            replace_file(path, |file| file.write_all(prefix))?
+        } else {
+            OpenOptions::new().append(true).open(path).map_err(io_err)?
+        };
+
+        Ok(Self {
+            out: BufWriter::new(file),
+            sync: Some(sync_file),
+            blobs,
+            message_hashes,
+            bytes_written: committed as u64,
+        })
+    }
+}
+
+impl<W: Write> SnapshotWriter<W> {
+    /// Start a new snapshot stream on `out` (a file, pipe or socket),
+    /// writing the header.
+    ///
+    /// Checkpoints are flushed but not synced; use
+    /// [`SnapshotWriter::create`] for durable files.
+    pub fn new(mut out: W) -> Result<Self> {
+        out.write_all(&file_header()).map_err(io_err)?;
+        Ok(Self {
+            out,
+            sync: None,
+            blobs: HashSet::new(),
+            message_hashes: Vec::new(),
+            bytes_written: HEADER_LEN as u64,
+        })
+    }
+
+    /// Append a checkpoint of `ctx`, flush it and sync it to disk.
+    pub fn checkpoint(&mut self, ctx: &SessionContext) -> Result<CheckpointStats> {
+        let start = self.bytes_written;
+        let mut stats = CheckpointStats::default();
+
+        let mut hashes = Vec::with_capacity(ctx.messages.len());
+        for message in &ctx.messages {
+            hashes.push(message_hash(message)?);
+        }
+        let base = hashes
+            .iter()
+            .zip(&self.message_hashes)
+            .take_while(|(new, old)| new == old)
+            .count();
+        let messages = MessagesOut {
+            base,
+            messages: &ctx.messages[base..],
+        };
+        self.write_record(TAG_MESSAGES, &[&serde_json::to_vec(&messages)?])?;
+        stats.messages_written = messages.messages.len();
+        stats.full = base == 0;
+        let mut files = Vec::with_capacity(ctx.files.len());
+        for (path, content) in &ctx.files {
+            let hash = self.put_blob(content, &mut stats)?;
+            files.push((path.as_str(), hash.to_string()));
+        }
+        // Stable output for identical contexts.
+        files.sort_unstable();
+
+        let mut tool_outputs = Vec::with_capacity(ctx.tool_outputs.len());
+        for output in &ctx.tool_outputs {
+            let hash = self.put_blob(&output.content, &mut stats)?;
+            tool_outputs.push(ToolOutputOut {
+                tool_name: &output.tool_name,
+                content: hash.to_string(),
+                exit_code: output.exit_code,
+                timestamp: output.timestamp,
+                metadata: &output.metadata,
+            });
+        }
+
+        let state = StateOut {
+            files,
+            tool_outputs,
+            working_memory: &ctx.working_memory,
+        };
+        self.write_record(TAG_STATE, &[&serde_json::to_vec(&state)?])?;
+        self.out.flush().map_err(io_err)?;
+        if let Some(sync) = self.sync {
+            sync(&mut self.out).map_err(io_err)?;
+        }
+
+        self.message_hashes = hashes;
+        stats.bytes_written = self.bytes_written - start;
+        Ok(stats)
+    }
+
+    /// Total bytes in the stream, header included.
+    pub fn bytes_written(&self) -> u64 {
+        self.bytes_written
+    }
+
+    /// Append `content` as a blob unless the stream already holds it.
+    ///
+    /// Blobs are keyed by SHA-256, so a known hash means identical content.
+    fn put_blob(&mut self, content: &str, stats: &mut CheckpointStats) -> Result<ContentHash> {
+        let hash = ContentHash::of(content.as_bytes());
+        if self.blobs.contains(&hash) {
+            stats.blobs_reused += 1;
+            return Ok(hash);
+        }
+        self.write_record(TAG_BLOB, &[&hash.0, content.as_bytes()])?;
+        self.blobs.insert(hash);
+        stats.blobs_written += 1;
+        Ok(hash)
+    }
+
+    fn write_record(&mut self, tag: u8, parts: &[&[u8]]) -> Result<()> {
+        let len: usize = parts.iter().map(|p| p.len()).sum();
+        let mut header = [0u8; RECORD_HEADER_LEN];
+        header[0] = tag;
+        header[1..9].copy_from_slice(&(len as u64).to_le_bytes());
+        let checksum = record_checksum(&header[..9], parts);
+        header[9..].copy_from_slice(&checksum);
+        self.out.write_all(&header).map_err(io_err)?;
+        for part in parts {
+            self.out.write_all(part).map_err(io_err)?;
+        }
+        self.bytes_written += (RECORD_HEADER_LEN + len) as u64;
+        Ok(())
+    }
+}
+
+struct ToolOutputEntry {
+    record: ToolOutputIn,
+    hash: ContentHash,
+}
+
+/// A memory-mapped snapshot, resumed at its last committed checkpoint.
+///
+/// Messages, working memory and the file and tool-output tables are decoded
+/// on open; file and tool-output bodies stay in the mapping until read.
+pub struct SessionSnapshot {
+    map: Mmap,
+    /// Body range of every committed blob record, by hash.
+    blobs: HashMap<ContentHash, (usize, usize)>,
+    messages: Vec<Message>,
+    files: HashMap<String, ContentHash>,
+    tool_outputs: Vec<ToolOutputEntry>,
+    working_memory: HashMap<String, Value>,
+    checkpoints: usize,
+    /// End of the last committed checkpoint.
+    committed_len: usize,
+}
+
+impl SessionSnapshot {
+    /// Map and replay the snapshot at `path`.
+    pub fn open(path: impl AsRef<Path>) -> Result<Self> {
+        let file = File::open(path).map_err(io_err)?;
+        // SAFETY: bytes written to a snapshot file are never changed or
+        // truncated. Writers only append; `SnapshotWriter::create` and the
+        // recovery in `SnapshotWriter::append` write a new file and rename it
+        // over the path, so this mapping keeps the old inode.
+        let map = unsafe { Mmap::map(&file) }.map_err(io_err)?;
+        Self::from_map(map)
+    }
+
+    fn from_map(map: Mmap) -> Result<Self> {
+        if map.len() < HEADER_LEN || &map[..MAGIC.len()] != MAGIC {
+            return Err(corrupt("bad magic"));
+        }
+        let version = u32::from_le_bytes(map[8..12].try_into().expect("4 bytes"));
+        if version != VERSION {
+            return Err(corrupt(&format!("unsupported version {}", version)));
+        }
+
+        let mut blobs = HashMap::new();
+        let mut messages: Vec<Message> = Vec::new();
+        let mut pending: Option<Range<usize>> = None;
+        let mut last_state: Option<StateIn> = None;
+        let mut checkpoints = 0;
+        let mut committed_len = HEADER_LEN;
+
+        // Stop at the first record that is incomplete, fails its checksum or
+        // does not decode: the torn tail of an interrupted checkpoint.
+        let mut at = HEADER_LEN;
+        while at + RECORD_HEADER_LEN <= map.len() {
+            let tag = map[at];
+            let len = u64::from_le_bytes(map[at + 1..at + 9].try_into().expect("8 bytes"));
+            let body = at + RECORD_HEADER_LEN;
+            let Some(end) = usize::try_from(len)
+                .ok()
+                .and_then(|len| body.checked_add(len))
+                .filter(|&end| end <= map.len())
+            else {
+                break;
+            };
+            if record_checksum(&map[at..at + 9], &[&map[body..end]]) != map[at + 9..body] {
+                break;
+            }
+
+            match tag {
+                TAG_BLOB if end - body >= HASH_LEN => {
+                    let hash = ContentHash(
+                        map[body..body + HASH_LEN]
+                            .try_into()
+                            .expect("HASH_LEN bytes"),
+                    );
+                    blobs
+                        .entry(hash)
+                        .or_insert((body + HASH_LEN, end - body - HASH_LEN));
+                }
+                TAG_MESSAGES => pending = Some(body..end),
+                TAG_STATE => {
+                    let Ok(state) = serde_json::from_slice::<StateIn>(&map[body..end]) else {
+                        break;
+                    };
+                    if let Some(range) = pending.take() {
+                        let Ok(delta) = serde_json::from_slice::<MessagesIn>(&map[range]) else {
+                            break;
+                        };
+                        if delta.base > messages.len() {
+                            break;
+                        }
+                        messages.truncate(delta.base);
+                        messages.extend(delta.messages);
+                    }
+                    last_state = Some(state);
+                    checkpoints += 1;
+                    committed_len = end;
+                }
+                _ => break,
+            }
+            at = end;
+        }
+        // Blobs of an interrupted checkpoint are not part of the snapshot.
+        blobs.retain(|_, &mut (at, _)| at < committed_len);
+
+        let StateIn {
+            files,
+            tool_outputs,
+            working_memory,
+        } = last_state.unwrap_or(StateIn {
+            files: Vec::new(),
+            tool_outputs: Vec::new(),
+            working_memory: HashMap::new(),
+        });
+
+        let known = |hex: &str| -> Result<ContentHash> {
+            let hash = parse_hash(hex)?;
+            if blobs.contains_key(&hash) {
+                Ok(hash)
+            } else {
+                Err(corrupt("missing blob"))
+            }
+        };
+        let files = files
+            .into_iter()
+            .map(|(path, hex)| Ok((path, known(&hex)?)))
+            .collect::<Result<HashMap<_, _>>>()?;
+        let tool_outputs = tool_outputs
+            .into_iter()
+            .map(|record| {
+                let hash = known(&record.content)?;
+                Ok(ToolOutputEntry { record, hash })
+            })
+            .collect::<Result<Vec<_>>>()?;
+
+        Ok(Self {
+            map,
+            blobs,
+            messages,
+            files,
+            tool_outputs,
+            working_memory,
+            checkpoints,
+            committed_len,
+        })
+    }
+
+    fn blob(&self, hash: ContentHash) -> Result<&str> {
+        // Every referenced hash was checked against `blobs` on open.
+        let (at, len) = self.blobs[&hash];
+        std::str::from_utf8(&self.map[at..at + len]).map_err(|_| corrupt("blob is not UTF-8"))
+    }
+
+    /// Conversation messages.
+    pub fn messages(&self) -> &[Message] {
+        &self.messages
+    }
+
+    /// Working memory.
+    pub fn working_memory(&self) -> &HashMap<String, Value> {
+        &self.working_memory
+    }
+
+    /// Number of committed checkpoints.
+    pub fn checkpoints(&self) -> usize {
+        self.checkpoints
+    }
+
+    /// Number of cached files.
+    pub fn file_count(&self) -> usize {
+        self.files.len()
+    }
+
+    /// Paths of the cached files, in no particular order.
+    pub fn file_paths(&self) -> impl Iterator<Item = &str> {
+        self.files.keys().map(String::as_str)
+    }
+
+    /// Borrow a cached file's contents from the mapping.
+    pub fn file(&self, path: &str) -> Result<Option<&str>> {
+        self.files
+            .get(path)
+            .map(|&hash| self.blob(hash))
+            .transpose()
+    }
+
+    /// Number of tool outputs.
+    pub fn tool_output_count(&self) -> usize {
+        self.tool_outputs.len()
+    }
+
+    /// Decode the tool output at `index`.
+    pub fn tool_output(&self, index: usize) -> Result<Option<ToolOutput>> {
+        let Some(entry) = self.tool_outputs.get(index) else {
+            return Ok(None);
+        };
+        Ok(Some(ToolOutput {
+            tool_name: entry.record.tool_name.clone(),
+            content: self.blob(entry.hash)?.to_string(),
+            exit_code: entry.record.exit_code,
+            timestamp: entry.record.timestamp,
+            metadata: entry.record.metadata.clone(),
+        }))
+    }
+
+    /// Materialize the full session context, reading every body.
+    pub fn to_context(&self) -> Result<SessionContext> {
+        let mut ctx = SessionContext::new();
+        ctx.messages = self.messages.clone();
+        for (path, &hash) in &self.files {
+            ctx.files.insert(path.clone(), self.blob(hash)?.to_string());
+        }
+        for index in 0..self.tool_outputs.len() {
+            ctx.tool_outputs.extend(self.tool_output(index)?);
+        }
+        ctx.working_memory = self.working_memory.clone();
+        ctx.recount_tokens();
+        Ok(ctx)
+    }
+}
+
+impl std::fmt::Debug for SessionSnapshot {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("SessionSnapshot")
+            .field("bytes", &self.map.len())
+            .field("checkpoints", &self.checkpoints)
+            .field("messages", &self.messages.len())
+            .field("files", &self.files.len())
+            .field("tool_outputs", &self.tool_outputs.len())
+            .finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use tempfile::TempDir;
+
+    fn sample_context() -> SessionContext {
+        let mut ctx = SessionContext::new();
+        ctx.add_user_message("Analyze the auth system");
+        ctx.add_assistant_message("Reading the sources");
+        ctx.cache_file("/src/auth.rs", "fn authenticate() {}\n".repeat(400));
+        ctx.cache_file("/src/main.rs", "fn main() {}");
+        ctx.add_tool_output(ToolOutput::new("bash", "ok\n").with_exit_code(0));
+        ctx.set_memory("depth", 1);
+        ctx
+    }
+
+    #[test]
+    fn test_snapshot_roundtrip_borrows_bodies() {
+        let dir = TempDir::new().unwrap();
+        let path = dir.path().join("session.rlmsnap");
+        let ctx = sample_context();
+
+        let mut writer = SnapshotWriter::create(&path).unwrap();
+        let stats = writer.checkpoint(&ctx).unwrap();
+        assert!(stats.full);
+        assert_eq!((stats.blobs_written, stats.messages_written), (3, 2));
+        drop(writer);
+
+        let snapshot = SessionSnapshot::open(&path).unwrap();
+        assert_eq!(snapshot.checkpoints(), 1);
+        assert_eq!(snapshot.file("/src/main.rs").unwrap(), Some("fn main() {}"));
+        assert_eq!(snapshot.file("/missing").unwrap(), None);
+        assert_eq!(snapshot.tool_output(0).unwrap().unwrap().exit_code, Some(0));
+
+        let restored = snapshot.to_context().unwrap();
+        assert_eq!(restored.messages.len(), 2);
+        assert_eq!(restored.files, ctx.files);
+        assert_eq!(restored.get_memory("depth"), ctx.get_memory("depth"));
+        assert_eq!(restored.total_tokens(), ctx.total_tokens());
+    }
+
+    #[test]
+    fn test_checkpoints_append_only_deltas() {
+        let dir = TempDir::new().unwrap();
+        let path = dir.path().join("session.rlmsnap");
+        let mut ctx = sample_context();
+        let mut writer = SnapshotWriter::create(&path).unwrap();
+        let first = writer.checkpoint(&ctx).unwrap();
+
+        // Unchanged bodies are referenced, not rewritten.
+        ctx.add_user_message("Now check the tests");
+        let second = writer.checkpoint(&ctx).unwrap();
+        assert!(!second.full);
+        assert_eq!(second.messages_written, 1);
+        assert_eq!((second.blobs_written, second.blobs_reused), (0, 3));
+        assert!(second.bytes_written * 10 < first.bytes_written);
+
+        ctx.cache_file("/src/main.rs", "fn main() { run() }");
+        assert_eq!(writer.checkpoint(&ctx).unwrap().blobs_written, 1);
+
+        // Editing history falls back to a full message rewrite.
+        ctx.remove_message(0);
+        let rewritten = writer.checkpoint(&ctx).unwrap();
+        assert!(rewritten.full);
+        assert_eq!(rewritten.messages_written, 2);
+        drop(writer);
+
+        let snapshot = SessionSnapshot::open(&path).unwrap();
+        assert_eq!(snapshot.checkpoints(), 4);
+        let contents: Vec<_> = snapshot.messages().iter().map(|m| &m.content).collect();
+        assert_eq!(contents, ["Reading the sources", "Now check the tests"]);
+        assert_eq!(
+            snapshot.file("/src/main.rs").unwrap(),
+            Some("fn main() { run() }")
+        );
+    }
+
+    /// Encode a record the way `SnapshotWriter` does.
+    fn raw_record(tag: u8, payload: &[u8]) -> Vec<u8> {
+        let mut head = vec![tag];
+        head.extend_from_slice(&(payload.len() as u64).to_le_bytes());
+        let checksum = record_checksum(&head, &[payload]);
+        head.extend_from_slice(&checksum);
+        head.extend_from_slice(payload);
+        head
+    }
+
+    fn append_bytes(path: &Path, bytes: &[u8]) {
+        let mut file = OpenOptions::new().append(true).open(path).unwrap();
+        file.write_all(bytes).unwrap();
+    }
+
+    #[test]
+    fn test_append_resumes_after_torn_checkpoint() {
+        let dir = TempDir::new().unwrap();
+        let path = dir.path().join("session.rlmsnap");
+        let mut ctx = sample_context();
+        SnapshotWriter::create(&path)
+            .unwrap()
+            .checkpoint(&ctx)
+            .unwrap();
+        let committed = std::fs::metadata(&path).unwrap().len();
+
+        // An interrupted checkpoint: a complete messages record, then a
+        // blob record cut off mid-payload.
+        let mut tail = raw_record(TAG_MESSAGES, br#"{"base":0,"messages":[]}"#);
+        tail.extend_from_slice(&raw_record(TAG_BLOB, &[7u8; 1_000])[..100]);
+        append_bytes(&path, &tail);
+        let torn = SessionSnapshot::open(&path).unwrap();
+        assert_eq!(torn.messages().len(), 2);
+
+        // Recovery replaces the file, so the open mapping stays readable.
+        let mut writer = SnapshotWriter::append(&path).unwrap();
+        assert_eq!(writer.bytes_written(), committed);
+        assert_eq!(std::fs::metadata(&path).unwrap().len(), committed);
+        assert_eq!(torn.file("/src/main.rs").unwrap(), Some("fn main() {}"));
+        ctx.add_assistant_message("Resumed");
+        let stats = writer.checkpoint(&ctx).unwrap();
+        assert!(!stats.full);
+        assert_eq!((stats.messages_written, stats.blobs_written), (1, 0));
+        drop(writer);
+
+        let snapshot = SessionSnapshot::open(&path).unwrap();
+        assert_eq!(snapshot.checkpoints(), 2);
+        assert_eq!(snapshot.messages().len(), 3);
+        assert_eq!(snapshot.to_context().unwrap().files, ctx.files);
+    }
+
+    #[test]
+    fn test_undecodable_tail_is_ignored() {
+        let dir = TempDir::new().unwrap();
+        let path = dir.path().join("session.rlmsnap");
+        let ctx = sample_context();
+        let mut writer = SnapshotWriter::create(&path).unwrap();
+        writer.checkpoint(&ctx).unwrap();
+        let committed = writer.bytes_written();
+        drop(writer);
+        let original = std::fs::read(&path).unwrap();
+
+        let mut corrupted = raw_record(TAG_BLOB, b"not quite right");
+        let last = corrupted.len() - 1;
+        corrupted[last] ^= 1;
+        let tails = [
+            // Zero-filled blocks left by a crash.
+            vec![0u8; 4096],
+            b"garbage that is not a record".to_vec(),
+            // A checksummed state record that is not valid JSON.
+            raw_record(TAG_STATE, b"{\"files\": ["),
+            // A complete record whose payload was damaged.
+            corrupted,
+        ];
+        for tail in tails {
+            std::fs::write(&path, &original).unwrap();
+            append_bytes(&path, &tail);
+            let snapshot = SessionSnapshot::open(&path).unwrap();
+            assert_eq!(snapshot.checkpoints(), 1);
+            assert_eq!(snapshot.to_context().unwrap().files, ctx.files);
+            drop(snapshot);
+            let writer = SnapshotWriter::append(&path).unwrap();
+            assert_eq!(writer.bytes_written(), committed);
+        }
+    }
+
+    #[test]
+    fn test_edited_message_rewrites_from_the_edit() {
+        let dir = TempDir::new().unwrap();
+        let path = dir.path().join("session.rlmsnap");
+        let mut ctx = sample_context();
+        ctx.add_user_message("Now check the tests");
+        let mut writer = SnapshotWriter::create(&path).unwrap();
+        writer.checkpoint(&ctx).unwrap();
+
+        // The last message is unchanged, but an earlier one was edited.
+        ctx.messages[1].content = "Reading the tests".to_string();
+        let stats = writer.checkpoint(&ctx).unwrap();
+        assert!(!stats.full);
+        assert_eq!(stats.messages_written, 2);
+        drop(writer);
+
+        let snapshot = SessionSnapshot::open(&path).unwrap();
+        let contents: Vec<_> = snapshot.messages().iter().map(|m| &m.content).collect();
+        assert_eq!(
+            contents,
+            [
+                "Analyze the auth system",
+                "Reading the tests",
+                "Now check the tests"
+            ]
+        );
+    }
+
+    #[test]
+    fn test_create_does_not_truncate_mapped_snapshot() {
+        let dir = TempDir::new().unwrap();
+        let path = dir.path().join("session.rlmsnap");
+        let ctx = sample_context();
+        SnapshotWriter::create(&path)
+            .unwrap()
+            .checkpoint(&ctx)
+            .unwrap();
+        let old = SessionSnapshot::open(&path).unwrap();
+
+        SnapshotWriter::create(&path)
+            .unwrap()
+            .checkpoint(&SessionContext::new())
+            .unwrap();
+        assert_eq!(old.file("/src/main.rs").unwrap(), Some("fn main() {}"));
+        assert_eq!(SessionSnapshot::open(&path).unwrap().file_count(), 0);
+        // No temporary files are left behind.
+        assert_eq!(std::fs::read_dir(dir.path()).unwrap().count(), 1);
+    }
+
+    #[test]
+    fn test_open_rejects_non_snapshots() {
+        let dir = TempDir::new().unwrap();
+        let path = dir.path().join("not-a-snapshot");
+        std::fs::write(&path, b"{\"messages\": []}").unwrap();
+        assert!(SessionSnapshot::open(&path).is_err());
+    }
+}
@@ -0,0 +1,426 @@
+//! Token counting for context budgets.
+//!
+//! [`Tokenizer::Heuristic`] keeps the historical ~4 bytes/token estimate and
+//! needs no data. [`Tokenizer::Bpe`] wraps a [`BpeTokenizer`] loaded from a
+//! tiktoken rank table (`cl100k_base.tiktoken`, `o200k_base.tiktoken`, ...)
+//! and produces exact token counts for those encodings.
+//!
+//! Pre-tokenization mirrors the cl100k split pattern with a hand-written
+//! scanner: ASCII bytes are classified through a lookup table and only
+//! non-ASCII characters fall back to Unicode property checks, so the common
+//! case never touches the regex engine.
+
+use crate::error::{Error, Result};
+use std::collections::HashMap;
+use std::path::Path;
+use std::sync::Arc;
+
+/// Strategy used to count tokens in context text.
+#[derive(Debug, Clone, Default)]
+pub enum Tokenizer {
+    /// Approximate ~4 bytes per token.
+    #[default]
+    Heuristic,
+    /// Exact byte-pair encoding with a tiktoken-compatible rank table.
+    Bpe(Arc<BpeTokenizer>),
+}
+
+impl Tokenizer {
+    /// Load a BPE tokenizer from a `.tiktoken` rank file.
+    pub fn bpe_from_file(path: impl AsRef<Path>) -> Result<Self> {
+        Ok(Self::Bpe(Arc::new(BpeTokenizer::from_tiktoken_file(path)?)))
+    }
+
+    /// Count tokens in `text`.
+    pub fn count(&self, text: &str) -> usize {
+        match self {
+            Self::Heuristic => text.len() / 4,
+            Self::Bpe(bpe) => bpe.count(text),
+        }
+    }
+
+    /// Whether counts are exact rather than estimated.
+    pub fn is_exact(&self) -> bool {
+        matches!(self, Self::Bpe(_))
+    }
+}
+
+/// Byte-pair encoder over a tiktoken rank table.
+pub struct BpeTokenizer {
+    ranks: HashMap<Vec<u8>, u32>,
+}
+
+impl std::fmt::Debug for BpeTokenizer {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("BpeTokenizer")
+            .field("vocab_size", &self.ranks.len())
+            .finish()
+    }
+}
+
+impl BpeTokenizer {
+    /// Build a tokenizer from token-bytes -> rank pairs.
+    pub fn from_ranks(ranks: HashMap<Vec<u8>, u32>) -> Self {
+        Self { ranks }
+    }
+
+    /// Parse the tiktoken text format: one `<base64 token> <rank>` per line.
+    pub fn from_tiktoken(data: &str) -> Result<Self> {
+        let mut ranks = HashMap::new();
+        for (line_no, line) in data.lines().enumerate() {
+            let line = line.trim();
+            if line.is_empty() {
+                continue;
+            }
+            let parsed = line.split_once(' ').and_then(|(token, rank)| {
+                Some((decode_base64(token)?, rank.trim().parse::<u32>().ok()?))
+            });
+            let Some((token, rank)) = parsed else {
+                return Err(Error::Config(format!(
+                    "invalid tiktoken rank entry on line {}",
+                    line_no + 1
+                )));
+            };
+            ranks.insert(token, rank);
+        }
+        if ranks.is_empty() {
+            return Err(Error::Config("empty tiktoken rank table".to_string()));
+        }
+        Ok(Self { ranks })
+    }
+
+    /// Load a `.tiktoken` rank file from disk.
+    pub fn from_tiktoken_file(path: impl AsRef<Path>) -> Result<Self> {
+        let path = path.as_ref();
+        let data = std::fs::read_to_string(path).map_err(|e| {
+            Error::Config(format!(
+                "failed to read tiktoken file {}: {}",
+                path.display(),
+                e
+            ))
+        })?;
+        Self::from_tiktoken(&data)
+    }
+
+    /// Number of entries in the rank table.
+    pub fn vocab_size(&self) -> usize {
+        self.ranks.len()
+    }
+
+    /// Encode `text` into token ranks.
+    ///
+    /// Byte sequences missing from the table (only possible with a partial
+    /// table) are skipped.
+    pub fn encode(&self, text: &str) -> Vec<u32> {
+        let mut tokens = Vec::with_capacity(text.len() / 3);
+        for piece in pretokenize(text) {
+            let piece = piece.as_bytes();
+            if let Some(&rank) = self.ranks.get(piece) {
+                tokens.push(rank);
+                continue;
+            }
+            let parts = self.merge(piece);
+            tokens.extend(
+                parts
+                    .windows(2)
+                    .filter_map(|w| self.ranks.get(&piece[w[0].0..w[1].0]).copied()),
+            );
+        }
+        tokens
+    }
+
+    /// Count tokens in `text` without materializing them.
+    pub fn count(&self, text: &str) -> usize {
+        pretokenize(text)
+            .map(|piece| {
+                let piece = piece.as_bytes();
+                if self.ranks.contains_key(piece) {
+                    1
+                } else {
+                    self.merge(piece).len() - 1
+                }
+            })
+            .sum()
+    }
+
+    /// Merge adjacent parts of `piece` lowest rank first. Returns part start
+    /// offsets followed by `piece.len()`.
+    fn merge(&self, piece: &[u8]) -> Vec<(usize, u32)> {
+        let rank_of = |parts: &[(usize, u32)], i: usize| -> u32 {
+            if i + 3 < parts.len() {
+                self.ranks
+                    .get(&piece[parts[i].0..parts[i + 3].0])
+                    .copied()
+                    .unwrap_or(u32::MAX)
+            } else {
+                u32::MAX
+            }
+        };
+
+        let mut parts = Vec::with_capacity(piece.len() + 1);
+        for i in 0..piece.len().saturating_sub(1) {
+            let rank = self
+                .ranks
+                .get(&piece[i..i + 2])
+                .copied()
+                .unwrap_or(u32::MAX);
+            parts.push((i, rank));
+        }
+        if !piece.is_empty() {
+            parts.push((piece.len() - 1, u32::MAX));
+        }
+        parts.push((piece.len(), u32::MAX));
+
+        loop {
+            let Some((i, _)) = parts[..parts.len() - 1]
+                .iter()
+                .enumerate()
+                .filter(|(_, (_, rank))| *rank != u32::MAX)
+                .min_by_key(|(_, (_, rank))| *rank)
+            else {
+                break;
+            };
+            if i > 0 {
+                parts[i - 1].1 = rank_of(&parts, i - 1);
+            }
+            parts[i].1 = rank_of(&parts, i);
+            parts.remove(i + 1);
+        }
+        parts
+    }
+}
+
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Class {
+    Letter,
+    Digit,
+    Space,
+    Newline,
+    Other,
+}
+
+const fn ascii_classes() -> [Class; 128] {
+    let mut table = [Class::Other; 128];
+    let mut b = 0;
+    while b < 128 {
+        let c = b as u8;
+        table[b] = if c.is_ascii_alphabetic() {
+            Class::Letter
+        } else if c.is_ascii_digit() {
+            Class::Digit
+        } else if c == b'\r' || c == b'\n' {
+            Class::Newline
+        } else if c.is_ascii_whitespace() || c == 0x0b {
+            Class::Space
+        } else {
+            Class::Other
+        };
+        b += 1;
+    }
+    table
+}
+
+static ASCII_CLASSES: [Class; 128] = ascii_classes();
+
+fn classify(c: char) -> Class {
+    if c.is_ascii() {
+        ASCII_CLASSES[c as usize]
+    } else if c.is_alphabetic() {
+        Class::Letter
+    } else if c.is_numeric() {
+        Class::Digit
+    } else if c.is_whitespace() {
+        Class::Space
+    } else {
+        Class::Other
+    }
+}
+
+/// Split `text` the way the cl100k pattern does:
+/// contractions, letter runs with one optional leading symbol, 1-3 digit
+/// runs, symbol runs with an optional leading space, and whitespace that
+/// leaves a single space attached to the following word.
+pub(crate) fn pretokenize(text: &str) -> impl Iterator<Item = &str> {
+    let mut pos = 0;
+    std::iter::from_fn(move || {
+        if pos >= text.len() {
+            return None;
+        }
+        let start = pos;
+        pos = start + next_piece_len(&text[start..]);
+        Some(&text[start..pos])
+    })
+}
+
+/// End offset of the run of characters from `from` whose class satisfies `want`.
+fn run(rest: &str, from: usize, want: impl Fn(Class) -> bool) -> usize {
+    rest[from..]
+        .char_indices()
+        .find(|(_, c)| !want(classify(*c)))
+        .map_or(rest.len(), |(i, _)| from + i)
+}
+
+fn next_piece_len(rest: &str) -> usize {
+    let first = rest.chars().next().expect("non-empty input");
+    let class = classify(first);
+    let second_class = rest[first.len_utf8()..].chars().next().map(classify);
+
+    if first == '\'' {
+        if let Some(len) = contraction_len(&rest[1..]) {
+            return 1 + len;
+        }
+    }
+
+    match class {
+        Class::Letter => run(rest, 0, |c| c == Class::Letter),
+        Class::Digit => {
+            let end = run(rest, 0, |c| c == Class::Digit);
+            rest[..end].char_indices().nth(3).map_or(end, |(i, _)| i)
+        }
+        Class::Space | Class::Other if second_class == Some(Class::Letter) => {
+            run(rest, first.len_utf8(), |c| c == Class::Letter)
+        }
+        Class::Other => symbol_run(rest, 0),
+        Class::Space if first == ' ' && second_class == Some(Class::Other) => symbol_run(rest, 1),
+        Class::Space | Class::Newline => {
+            let end = run(rest, 0, |c| matches!(c, Class::Space | Class::Newline));
+            let last_newline = rest[..end]
+                .char_indices()
+                .filter(|(_, c)| classify(*c) == Class::Newline)
+                .last();
+            if let Some((i, c)) = last_newline {
+                return i + c.len_utf8();
+            }
+            if end == rest.len() {
+                return end;
+            }
+            // Leave the final space to prefix the next word.
+            let last = rest[..end].chars().next_back().map_or(0, char::len_utf8);
+            if end - last > 0 {
+                end - last
+            } else {
+                end
+            }
+        }
+    }
+}
+
+fn symbol_run(rest: &str, from: usize) -> usize {
+    let mut end = run(rest, from, |c| c == Class::Other);
+    end += rest[end..]
+        .bytes()
+        .take_while(|b| *b == b'\r' || *b == b'\n')
+        .count();
+    end
+}
+
+fn contraction_len(after: &str) -> Option<usize> {
+    let bytes = after.as_bytes();
+    let lower = |i: usize| bytes.get(i).map(u8::to_ascii_lowercase);
+    match (lower(0), lower(1)) {
+        (Some(b'r'), Some(b'e')) | (Some(b'v'), Some(b'e')) | (Some(b'l'), Some(b'l')) => Some(2),
+        (Some(b's' | b't' | b'm' | b'd'), _) => Some(1),
+        _ => None,
+    }
+}
+
+fn decode_base64(input: &str) -> Option<Vec<u8>> {
+    fn value(c: u8) -> Option<u32> {
+        match c {
+            b'A'..=b'Z' => Some((c - b'A') as u32),
+            b'a'..=b'z' => Some((c - b'a') as u32 + 26),
+            b'0'..=b'9' => Some((c - b'0') as u32 + 52),
+            b'+' => Some(62),
+            b'/' => Some(63),
+            _ => None,
+        }
+    }
+
+    let input = input.trim_end_matches('=').as_bytes();
+    let mut out = Vec::with_capacity(input.len() * 3 / 4);
+    for chunk in input.chunks(4) {
+        if chunk.len() == 1 {
+            return None;
+        }
+        let mut acc = 0u32;
+        for &c in chunk {
+            acc = (acc << 6) | value(c)?;
+        }
+        acc <<= 6 * (4 - chunk.len()) as u32;
+        let bytes = acc.to_be_bytes();
+        out.extend_from_slice(&bytes[1..chunk.len()]);
+    }
+    Some(out)
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Byte-level table over ASCII plus a few merges, in tiktoken format.
+    fn test_table() -> String {
+        let encode = |bytes: &[u8]| -> String {
+            const ALPHABET: &[u8; 64] =
+                b"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            let mut out = String::new();
+            for chunk in bytes.chunks(3) {
+                let mut buf = [0u8; 3];
+                buf[..chunk.len()].copy_from_slice(chunk);
+                let n = u32::from_be_bytes([0, buf[0], buf[1], buf[2]]);
+                for i in 0..=chunk.len() {
+                    out.push(ALPHABET[(n >> (18 - 6 * i) & 63) as usize] as char);
+                }
+                for _ in chunk.len()..3 {
+                    out.push('=');
+                }
+            }
+            out
+        };
+        let mut entries: Vec<Vec<u8>> = (0u8..128).map(|b| vec![b]).collect();
+        for merge in [
+            "he", "ll", "llo", "hello", " w", " wor", "or", "ld", " world",
+        ] {
+            entries.push(merge.as_bytes().to_vec());
+        }
+        entries
+            .iter()
+            .enumerate()
+            .map(|(rank, bytes)| format!("{} {}\n", encode(bytes), rank))
+            .collect()
+    }
+
+    #[test]
+    fn test_pretokenize_matches_cl100k_splits() {
+        let pieces: Vec<&str> = pretokenize("Hello world, it's 12345!\n\n  done  ").collect();
+        assert_eq!(
+            pieces,
+            vec![
+                "Hello", " world", ",", " it", "'s", " ", "123", "45", "!\n\n", " ", " done", "  "
+            ]
+        );
+        assert_eq!(pretokenize("").count(), 0);
+        assert_eq!(
+            pretokenize("héllo wörld").collect::<Vec<_>>(),
+            vec!["héllo", " wörld"]
+        );
+    }
+
+    #[test]
+    fn test_bpe_encode_and_count() {
+        let bpe = BpeTokenizer::from_tiktoken(&test_table()).unwrap();
+        assert_eq!(bpe.vocab_size(), 137);
+
+        let tokens = bpe.encode("hello world");
+        assert_eq!(tokens.len(), 2);
+        assert_eq!(bpe.count("hello world"), 2);
+        // "help" only merges "he", leaving l, p as single bytes.
+        assert_eq!(bpe.count("help"), 3);
+
+        let tokenizer = Tokenizer::Bpe(Arc::new(bpe));
+        assert!(tokenizer.is_exact());
+        assert_eq!(tokenizer.count("hello hello"), 3);
+        assert_eq!(Tokenizer::Heuristic.count("hello hello"), 2);
+
+        assert!(BpeTokenizer::from_tiktoken("not-base64!! x").is_err());
+    }
+}
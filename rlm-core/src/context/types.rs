@@ -1,5 +1,6 @@
 //! Core context types: Message, ToolOutput, SessionContext.
 
+use super::tokenizer::Tokenizer;
 use chrono::{DateTime, Utc};
 use serde::{Deserialize, Serialize};
 use serde_json::Value;
@@ -158,7 +159,13 @@ impl ToolOutput {
 /// - `files`: Cached file contents by path
 /// - `tool_outputs`: Recent tool execution results
 /// - `working_memory`: Session-scoped key-value state
+///
+/// Token totals are maintained incrementally by the mutating methods, so the
+/// `total_*_tokens` getters are O(1). Code that edits the public collections
+/// directly should call [`SessionContext::recount_tokens`] afterwards; a
+/// length mismatch is detected and falls back to a full scan.
 #[derive(Debug, Clone, Default, Serialize, Deserialize)]
+#[serde(from = "SessionContextData")]
 pub struct SessionContext {
     /// Conversation messages
     pub messages: Vec<Message>,
@@ -168,6 +175,59 @@ pub struct SessionContext {
     pub tool_outputs: Vec<ToolOutput>,
     /// Working memory (session state)
     pub working_memory: HashMap<String, Value>,
+    /// Strategy used for token counts
+    #[serde(skip)]
+    tokenizer: Tokenizer,
+    /// Running token totals
+    #[serde(skip)]
+    tokens: TokenTotals,
+    /// Bumped whenever a path is added to or removed from `files`
+    #[serde(skip)]
+    files_version: u64,
+    /// Bumped whenever existing messages are removed or may have been edited
+    #[serde(skip)]
+    messages_version: u64,
+}
+
+/// Running token totals, each paired with the collection length it covers.
+#[derive(Debug, Clone, Copy, Default)]
+struct TokenTotals {
+    messages: usize,
+    message_count: usize,
+    files: usize,
+    file_count: usize,
+    tools: usize,
+    tool_count: usize,
+}
+
+/// Serialized form of [`SessionContext`]; totals are rebuilt on load.
+#[derive(Deserialize)]
+struct SessionContextData {
+    #[serde(default)]
+    messages: Vec<Message>,
+    #[serde(default)]
+    files: HashMap<String, String>,
+    #[serde(default)]
+    tool_outputs: Vec<ToolOutput>,
+    #[serde(default)]
+    working_memory: HashMap<String, Value>,
+}
+
+impl From<SessionContextData> for SessionContext {
+    fn from(data: SessionContextData) -> Self {
+        let mut ctx = Self {
+            messages: data.messages,
+            files: data.files,
+            tool_outputs: data.tool_outputs,
+            working_memory: data.working_memory,
+            tokenizer: Tokenizer::default(),
+            tokens: TokenTotals::default(),
+            files_version: 0,
+            messages_version: 0,
+        };
+        ctx.recount_tokens();
+        ctx
+    }
 }
 
 impl SessionContext {
@@ -176,24 +236,139 @@ impl SessionContext {
         Self::default()
     }
 
+    /// Use `tokenizer` for token counts.
+    pub fn with_tokenizer(mut self, tokenizer: Tokenizer) -> Self {
+        self.set_tokenizer(tokenizer);
+        self
+    }
+
+    /// Switch token counting strategy and recount existing content.
+    pub fn set_tokenizer(&mut self, tokenizer: Tokenizer) {
+        self.tokenizer = tokenizer;
+        self.recount_tokens();
+    }
+
+    /// Tokenizer used for token counts.
+    pub fn tokenizer(&self) -> &Tokenizer {
+        &self.tokenizer
+    }
+
+    /// Count tokens in `text` with this context's tokenizer.
+    pub fn count_tokens(&self, text: &str) -> usize {
+        self.tokenizer.count(text)
+    }
+
+    /// Rebuild running token totals from scratch.
+    ///
+    /// Also bumps [`files_version`](Self::files_version) and
+    /// [`messages_version`](Self::messages_version), since direct edits may
+    /// have changed the cached paths or rewritten the history.
+    pub fn recount_tokens(&mut self) {
+        self.files_version += 1;
+        self.messages_version += 1;
+        self.tokens = TokenTotals {
+            messages: self.scan_message_tokens(),
+            message_count: self.messages.len(),
+            files: self.scan_file_tokens(),
+            file_count: self.files.len(),
+            tools: self.scan_tool_tokens(),
+            tool_count: self.tool_outputs.len(),
+        };
+    }
+
+    fn scan_message_tokens(&self) -> usize {
+        self.messages
+            .iter()
+            .map(|m| self.tokenizer.count(&m.content))
+            .sum()
+    }
+
+    fn scan_file_tokens(&self) -> usize {
+        self.files.values().map(|c| self.tokenizer.count(c)).sum()
+    }
+
+    fn scan_tool_tokens(&self) -> usize {
+        self.tool_outputs
+            .iter()
+            .map(|o| self.tokenizer.count(&o.content))
+            .sum()
+    }
+
     /// Add a message to the conversation.
     pub fn add_message(&mut self, message: Message) {
+        self.tokens.messages += self.tokenizer.count(&message.content);
+        self.tokens.message_count += 1;
         self.messages.push(message);
     }
 
     /// Add a user message.
     pub fn add_user_message(&mut self, content: impl Into<String>) {
-        self.messages.push(Message::user(content));
+        self.add_message(Message::user(content));
     }
 
     /// Add an assistant message.
     pub fn add_assistant_message(&mut self, content: impl Into<String>) {
-        self.messages.push(Message::assistant(content));
+        self.add_message(Message::assistant(content));
+    }
+
+    /// Remove and return the message at `index`.
+    pub fn remove_message(&mut self, index: usize) -> Option<Message> {
+        if index >= self.messages.len() {
+            return None;
+        }
+        let message = self.messages.remove(index);
+        self.tokens.messages = self
+            .tokens
+            .messages
+            .saturating_sub(self.tokenizer.count(&message.content));
+        self.tokens.message_count = self.tokens.message_count.saturating_sub(1);
+        self.messages_version += 1;
+        Some(message)
+    }
+
+    /// Counter that changes whenever existing messages are removed, or may
+    /// have been edited in place (see [`recount_tokens`](Self::recount_tokens)).
+    ///
+    /// Appending messages leaves it unchanged.
+    pub fn messages_version(&self) -> u64 {
+        self.messages_version
     }
 
     /// Cache a file's contents.
     pub fn cache_file(&mut self, path: impl Into<String>, content: impl Into<String>) {
-        self.files.insert(path.into(), content.into());
+        let content = content.into();
+        self.tokens.files += self.tokenizer.count(&content);
+        match self.files.insert(path.into(), content) {
+            Some(previous) => {
+                self.tokens.files = self
+                    .tokens
+                    .files
+                    .saturating_sub(self.tokenizer.count(&previous));
+            }
+            None => {
+                self.tokens.file_count += 1;
+                self.files_version += 1;
+            }
+        }
+    }
+
+    /// Remove a cached file, returning its contents.
+    pub fn remove_file(&mut self, path: &str) -> Option<String> {
+        let content = self.files.remove(path)?;
+        self.tokens.files = self
+            .tokens
+            .files
+            .saturating_sub(self.tokenizer.count(&content));
+        self.tokens.file_count = self.tokens.file_count.saturating_sub(1);
+        self.files_version += 1;
+        Some(content)
+    }
+
+    /// Counter that changes whenever the set of cached file paths changes.
+    ///
+    /// Replacing the contents of an already cached path leaves it unchanged.
+    pub fn files_version(&self) -> u64 {
+        self.files_version
     }
 
     /// Get cached file content.
@@ -203,6 +378,8 @@ impl SessionContext {
 
     /// Add a tool output.
     pub fn add_tool_output(&mut self, output: ToolOutput) {
+        self.tokens.tools += self.tokenizer.count(&output.content);
+        self.tokens.tool_count += 1;
         self.tool_outputs.push(output);
     }
 
@@ -235,19 +412,36 @@ impl SessionContext {
             .find(|m| m.role == Role::Assistant)
     }
 
-    /// Count total approximate tokens in messages.
+    /// Count total tokens in messages.
     pub fn total_message_tokens(&self) -> usize {
-        self.messages.iter().map(|m| m.approx_tokens()).sum()
+        if self.tokens.message_count == self.messages.len() {
+            self.tokens.messages
+        } else {
+            self.scan_message_tokens()
+        }
     }
 
-    /// Count total approximate tokens in cached files.
+    /// Count total tokens in cached files.
     pub fn total_file_tokens(&self) -> usize {
-        self.files.values().map(|c| c.len() / 4).sum()
+        if self.tokens.file_count == self.files.len() {
+            self.tokens.files
+        } else {
+            self.scan_file_tokens()
+        }
     }
 
-    /// Count total approximate tokens in tool outputs.
+    /// Count total tokens in tool outputs.
     pub fn total_tool_tokens(&self) -> usize {
-        self.tool_outputs.iter().map(|o| o.approx_tokens()).sum()
+        if self.tokens.tool_count == self.tool_outputs.len() {
+            self.tokens.tools
+        } else {
+            self.scan_tool_tokens()
+        }
+    }
+
+    /// Count total tokens across messages, files and tool outputs.
+    pub fn total_tokens(&self) -> usize {
+        self.total_message_tokens() + self.total_file_tokens() + self.total_tool_tokens()
     }
 
     /// Get unique file paths referenced.
@@ -270,6 +464,8 @@ impl SessionContext {
         if self.tool_outputs.len() > keep_last {
             let start = self.tool_outputs.len() - keep_last;
             self.tool_outputs = self.tool_outputs.split_off(start);
+            self.tokens.tools = self.scan_tool_tokens();
+            self.tokens.tool_count = self.tool_outputs.len();
         }
     }
 
@@ -348,4 +544,38 @@ mod tests {
         assert_eq!(last_two[0].content, "Second");
         assert_eq!(last_two[1].content, "Third");
     }
+
+    #[test]
+    fn test_running_token_totals() {
+        let mut ctx = SessionContext::new();
+        ctx.add_user_message("a".repeat(40));
+        ctx.add_assistant_message("b".repeat(80));
+        ctx.cache_file("/a.rs", "x".repeat(400));
+        ctx.add_tool_output(ToolOutput::new("bash", "y".repeat(12)));
+        assert_eq!(ctx.total_message_tokens(), 30);
+        assert_eq!(ctx.total_file_tokens(), 100);
+        assert_eq!(ctx.total_tokens(), 133);
+
+        // Replacing a file swaps its contribution.
+        ctx.cache_file("/a.rs", "x".repeat(40));
+        assert_eq!(ctx.total_file_tokens(), 10);
+        assert_eq!(ctx.remove_file("/a.rs").map(|c| c.len()), Some(40));
+        assert_eq!(ctx.total_file_tokens(), 0);
+
+        assert!(ctx.remove_message(0).is_some());
+        assert_eq!(ctx.total_message_tokens(), 20);
+        ctx.trim_tool_outputs(0);
+        assert_eq!(ctx.total_tool_tokens(), 0);
+
+        // Direct edits that change a length fall back to a scan.
+        ctx.messages.push(Message::user("c".repeat(8)));
+        assert_eq!(ctx.total_message_tokens(), 22);
+        ctx.recount_tokens();
+        assert_eq!(ctx.total_message_tokens(), 22);
+
+        // Totals survive a serde round trip.
+        let restored: SessionContext =
+            serde_json::from_str(&serde_json::to_string(&ctx).unwrap()).unwrap();
+        assert_eq!(restored.total_message_tokens(), 22);
+    }
 }
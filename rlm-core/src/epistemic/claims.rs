@@ -3,11 +3,143 @@
 //! Extracts atomic, verifiable claims from multi-sentence LLM responses.
 //! Each claim represents a single factual assertion that can be independently
 //! evaluated for grounding.
+//!
+//! Sentences are found by a single scan over the response, so each claim's
+//! span points exactly at its text. Per-sentence word statistics come from one
+//! more scan of the sentence. The few regexes left (evidence patterns) are
+//! compiled once per process.
 
 use regex::Regex;
 use std::collections::HashSet;
+use std::sync::LazyLock;
 
 use super::types::{Claim, ClaimCategory, EvidenceRef, EvidenceType};
+use crate::metrics::{self, Metric};
+
+/// Abbreviations whose trailing period does not end a sentence.
+const ABBREVIATIONS: [&str; 7] = ["e.g", "i.e", "etc", "vs", "Mr", "Ms", "Dr"];
+
+/// Below this many total bytes, `extract_batch` stays on the calling thread.
+const PARALLEL_BATCH_MIN_BYTES: usize = 16 * 1024;
+
+/// Numeric citations (`[3]`) and `(source: ...)` attributions.
+static CITATION_PATTERN: LazyLock<Regex> =
+    LazyLock::new(|| Regex::new(r"\[(\d+)\]|\(source:\s*([^)]+)\)").expect("Invalid regex"));
+
+/// File references introduced by "in", "from" or "see".
+static FILE_REF_PATTERN: LazyLock<Regex> = LazyLock::new(|| {
+    Regex::new(r"(?:in|from|see)\s+[`']?([a-zA-Z0-9_/.-]+\.[a-z]+)[`']?").expect("Invalid regex")
+});
+
+/// Inline code spans.
+static INLINE_CODE_PATTERN: LazyLock<Regex> =
+    LazyLock::new(|| Regex::new(r"`([^`]+)`").expect("Invalid regex"));
+
+/// Word-level counts for one sentence.
+#[derive(Debug, Default, Clone, Copy, PartialEq, Eq)]
+struct WordStats {
+    /// Words matching `\b[A-Z][a-zA-Z0-9_]*\b`.
+    identifiers: usize,
+    /// Words matching `\b\d+\b`.
+    numbers: usize,
+}
+
+impl WordStats {
+    /// Count identifiers and numbers in one pass over `text`.
+    fn scan(text: &str) -> Self {
+        let mut stats = Self::default();
+        let mut word_start = None;
+        for (i, c) in text
+            .char_indices()
+            .chain(std::iter::once((text.len(), ' ')))
+        {
+            if c.is_alphanumeric() || c == '_' {
+                word_start.get_or_insert(i);
+                continue;
+            }
+            let Some(start) = word_start.take() else {
+                continue;
+            };
+            let word = &text[start..i];
+            if word.as_bytes()[0].is_ascii_uppercase()
+                && word.bytes().all(|b| b.is_ascii_alphanumeric() || b == b'_')
+            {
+                stats.identifiers += 1;
+            } else if word.chars().all(char::is_numeric) {
+                stats.numbers += 1;
+            }
+        }
+        stats
+    }
+}
+
+/// Byte spans of the trimmed, non-empty sentences in `text`, in order.
+///
+/// A sentence ends at a run of `.`/`!`/`?` followed by whitespace (the run is
+/// not part of the sentence) or at a blank line. A single period right after
+/// one of [`ABBREVIATIONS`] does not end a sentence.
+fn sentence_spans(text: &str) -> Vec<(usize, usize)> {
+    let bytes = text.as_bytes();
+    let mut spans = Vec::new();
+    let mut push = |start: usize, end: usize| {
+        let raw = &text[start..end];
+        let trimmed = raw.trim_start();
+        let start = start + (raw.len() - trimmed.len());
+        let trimmed = trimmed.trim_end();
+        if !trimmed.is_empty() {
+            spans.push((start, start + trimmed.len()));
+        }
+    };
+
+    let mut sentence_start = 0;
+    let mut i = 0;
+    while i < bytes.len() {
+        match bytes[i] {
+            b'.' | b'!' | b'?' => {
+                let mut run_end = i + 1;
+                while run_end < bytes.len() && matches!(bytes[run_end], b'.' | b'!' | b'?') {
+                    run_end += 1;
+                }
+                let next = text[run_end..]
+                    .char_indices()
+                    .find(|(_, c)| !c.is_whitespace())
+                    .map_or(text.len(), |(offset, _)| run_end + offset);
+                let abbreviation =
+                    run_end - i == 1 && bytes[i] == b'.' && ends_with_abbreviation(&text[..i]);
+                if next > run_end && !abbreviation {
+                    push(sentence_start, i);
+                    sentence_start = next;
+                    i = next;
+                } else {
+                    i = run_end;
+                }
+            }
+            b'\n' if bytes.get(i + 1) == Some(&b'\n') => {
+                let mut run_end = i + 2;
+                while run_end < bytes.len() && bytes[run_end] == b'\n' {
+                    run_end += 1;
+                }
+                push(sentence_start, i);
+                sentence_start = run_end;
+                i = run_end;
+            }
+            _ => i += 1,
+        }
+    }
+    push(sentence_start, text.len());
+    spans
+}
+
+fn ends_with_abbreviation(text: &str) -> bool {
+    ABBREVIATIONS.iter().any(|abbr| {
+        text.strip_suffix(abbr).is_some_and(|before| {
+            !before
+                .chars()
+                .next_back()
+                .is_some_and(|c| c.is_alphanumeric())
+        })
+    })
+}
 
 /// Extract atomic claims from an LLM response.
 pub struct ClaimExtractor {
@@ -17,9 +149,9 @@ pub struct ClaimExtractor {
     max_length: usize,
     /// Categories to extract (None = all)
     categories: Option<HashSet<ClaimCategory>>,
-    /// Words that signal factual claims
+    /// Words that signal factual claims (lowercase)
     factual_signals: Vec<String>,
-    /// Words that signal hedging/uncertainty
+    /// Words that signal hedging/uncertainty (lowercase)
     hedge_words: Vec<String>,
 }
 
@@ -62,8 +194,8 @@ impl ClaimExtractor {
                 "seems".to_string(),
                 "appears".to_string(),
                 "suggests".to_string(),
-                "I think".to_string(),
-                "I believe".to_string(),
+                "i think".to_string(),
+                "i believe".to_string(),
                 "may".to_string(),
             ],
         }
@@ -89,31 +221,33 @@ impl ClaimExtractor {
 
     /// Extract claims from a response.
     pub fn extract(&self, response: &str) -> Vec<Claim> {
+        let _timer = metrics::Timer::start(Metric::ClaimExtract);
         let mut claims = Vec::new();
 
-        // Split into sentences
-        let sentences = self.split_sentences(response);
-
-        for (idx, sentence) in sentences.iter().enumerate() {
-            let trimmed = sentence.trim();
+        for (start, end) in sentence_spans(response) {
+            let sentence = &response[start..end];
 
             // Skip if too short or too long
-            if trimmed.len() < self.min_length || trimmed.len() > self.max_length {
+            if sentence.len() < self.min_length || sentence.len() > self.max_length {
                 continue;
             }
 
             // Skip questions
-            if trimmed.ends_with('?') {
+            if sentence.ends_with('?') {
                 continue;
             }
 
+            let lower = sentence.to_lowercase();
+
             // Skip meta-commentary that's not asserting facts
-            if self.is_meta_commentary(trimmed) {
+            if Self::is_meta_commentary(&lower) {
                 continue;
             }
 
+            let stats = WordStats::scan(sentence);
+
             // Classify the claim
-            let category = self.classify_claim(trimmed);
+            let category = self.classify_claim(&lower, stats);
 
             // Filter by category if specified
             if let Some(ref allowed) = self.categories {
@@ -123,23 +257,18 @@ impl ClaimExtractor {
             }
 
             // Calculate specificity
-            let specificity = self.estimate_specificity(trimmed);
-
-            // Calculate span in original text
-            let span = self.find_span(response, trimmed, idx);
+            let specificity = Self::estimate_specificity(sentence, &lower, stats);
 
             // Check for hedging
-            let is_hedged = self.is_hedged(trimmed);
+            let is_hedged = self.is_hedged(&lower);
 
-            let mut claim = Claim::new(trimmed, category).with_specificity(if is_hedged {
-                specificity * 0.5
-            } else {
-                specificity
-            });
-
-            if let Some((start, end)) = span {
-                claim = claim.with_span(start, end);
-            }
+            let mut claim = Claim::new(sentence, category)
+                .with_specificity(if is_hedged {
+                    specificity * 0.5
+                } else {
+                    specificity
+                })
+                .with_span(start, end);
 
             // Add metadata about hedging
             if is_hedged {
@@ -152,59 +281,13 @@ impl ClaimExtractor {
         }
 
         // Extract evidence references from the claims
-        self.link_evidence(&mut claims, response);
+        Self::link_evidence(&mut claims, response);
 
         claims
     }
 
-    /// Split text into sentences.
-    fn split_sentences(&self, text: &str) -> Vec<String> {
-        // Handle common abbreviations
-        let text = text
-            .replace("e.g.", "e.g")
-            .replace("i.e.", "i.e")
-            .replace("etc.", "etc")
-            .replace("vs.", "vs")
-            .replace("Mr.", "Mr")
-            .replace("Ms.", "Ms")
-            .replace("Dr.", "Dr");
-
-        // Split on sentence boundaries
-        let re = Regex::new(r"[.!?]+\s+|\n\n+").unwrap();
-        let mut sentences: Vec<String> = re.split(&text).map(|s| s.trim().to_string()).collect();
-
-        // Handle the last sentence if it doesn't end with punctuation
-        if let Some(last) = text.split_whitespace().last() {
-            if !last.ends_with('.') && !last.ends_with('!') && !last.ends_with('?') {
-                if let Some(last_sentence) = sentences.last_mut() {
-                    if !last_sentence.is_empty()
-                        && !last_sentence.ends_with('.')
-                        && !last_sentence.ends_with('!')
-                        && !last_sentence.ends_with('?')
-                    {
-                        // It's already there, just incomplete
-                    }
-                }
-            }
-        }
-
-        // Restore abbreviations
-        sentences
-            .into_iter()
-            .map(|s| {
-                s.replace("e.g", "e.g.")
-                    .replace("i.e", "i.e.")
-                    .replace(" etc", " etc.")
-                    .replace(" vs", " vs.")
-            })
-            .filter(|s| !s.is_empty())
-            .collect()
-    }
-
-    /// Classify a claim into a category.
-    fn classify_claim(&self, text: &str) -> ClaimCategory {
-        let lower = text.to_lowercase();
-
+    /// Classify a claim into a category, given its lowercased text.
+    fn classify_claim(&self, lower: &str, stats: WordStats) -> ClaimCategory {
         // Code behavior patterns
         if lower.contains("function")
             || lower.contains("method")
@@ -219,7 +302,7 @@ impl ClaimExtractor {
         }
 
         // Numerical patterns
-        if Regex::new(r"\b\d+\b").unwrap().is_match(&lower)
+        if stats.numbers > 0
             || lower.contains("percent")
             || lower.contains("bytes")
             || lower.contains("milliseconds")
@@ -271,29 +354,26 @@ impl ClaimExtractor {
         }
 
         // Default to factual if contains factual signals
-        for signal in &self.factual_signals {
-            if lower.contains(&signal.to_lowercase()) {
-                return ClaimCategory::Factual;
-            }
+        if self
+            .factual_signals
+            .iter()
+            .any(|signal| lower.contains(signal.as_str()))
+        {
+            return ClaimCategory::Factual;
         }
 
         ClaimCategory::Unknown
     }
 
     /// Estimate the specificity of a claim (0.0-1.0).
-    fn estimate_specificity(&self, text: &str) -> f64 {
-        let lower = text.to_lowercase();
+    fn estimate_specificity(text: &str, lower: &str, stats: WordStats) -> f64 {
         let mut specificity = 0.5; // Base specificity
 
         // Specific names/identifiers increase specificity
-        let identifier_re = Regex::new(r"\b[A-Z][a-zA-Z0-9_]*\b").unwrap();
-        let identifier_count = identifier_re.find_iter(text).count();
-        specificity += (identifier_count as f64 * 0.05).min(0.2);
+        specificity += (stats.identifiers as f64 * 0.05).min(0.2);
 
         // Numbers increase specificity
-        let number_re = Regex::new(r"\b\d+\b").unwrap();
-        let number_count = number_re.find_iter(text).count();
-        specificity += (number_count as f64 * 0.1).min(0.2);
+        specificity += (stats.numbers as f64 * 0.1).min(0.2);
 
         // File paths, URLs increase specificity
         if text.contains('/') || text.contains('\\') || text.contains("://") {
@@ -331,22 +411,16 @@ impl ClaimExtractor {
     }
 
     /// Check if a claim is hedged (contains uncertainty language).
-    fn is_hedged(&self, text: &str) -> bool {
-        let lower = text.to_lowercase();
-        for word in &self.hedge_words {
-            if lower.contains(&word.to_lowercase()) {
-                return true;
-            }
-        }
-        false
+    fn is_hedged(&self, lower: &str) -> bool {
+        self.hedge_words
+            .iter()
+            .any(|word| lower.contains(word.as_str()))
     }
 
-    /// Check if text is meta-commentary (not a factual claim).
-    fn is_meta_commentary(&self, text: &str) -> bool {
-        let lower = text.to_lowercase();
-
+    /// Check if lowercased text is meta-commentary (not a factual claim).
+    fn is_meta_commentary(lower: &str) -> bool {
         // Common meta-commentary patterns
-        let meta_patterns = [
+        const META_PATTERNS: [&str; 12] = [
             "let me",
             "i'll",
             "i will",
@@ -361,45 +435,16 @@ impl ClaimExtractor {
             "remember that",
         ];
 
-        for pattern in meta_patterns {
-            if lower.starts_with(pattern) {
-                return true;
-            }
-        }
-
-        false
-    }
-
-    /// Find the span of a sentence in the original text.
-    fn find_span(&self, original: &str, sentence: &str, hint_idx: usize) -> Option<(usize, usize)> {
-        // Try to find the sentence starting from the hint position
-        let search_start = if hint_idx > 0 {
-            // Start searching after previous sentences
-            original
-                .match_indices(sentence)
-                .nth(0)
-                .map(|(i, _)| i)
-                .unwrap_or(0)
-        } else {
-            0
-        };
-
-        original[search_start..]
-            .find(sentence)
-            .map(|i| (search_start + i, search_start + i + sentence.len()))
+        META_PATTERNS
+            .iter()
+            .any(|pattern| lower.starts_with(pattern))
     }
 
     /// Link evidence references to claims.
-    fn link_evidence(&self, claims: &mut [Claim], response: &str) {
-        // Look for common evidence patterns
-        let citation_re = Regex::new(r"\[(\d+)\]|\(source:\s*([^)]+)\)").unwrap();
-        let file_re =
-            Regex::new(r"(?:in|from|see)\s+[`']?([a-zA-Z0-9_/.-]+\.[a-z]+)[`']?").unwrap();
-        let code_re = Regex::new(r"`([^`]+)`").unwrap();
-
+    fn link_evidence(claims: &mut [Claim], response: &str) {
         // Extract all citations from the response
         let mut citations: Vec<(usize, String)> = Vec::new();
-        for cap in citation_re.captures_iter(response) {
+        for cap in CITATION_PATTERN.captures_iter(response) {
             let citation = cap.get(1).or_else(|| cap.get(2)).map(|m| m.as_str());
             if let Some(c) = citation {
                 let start = cap.get(0).unwrap().start();
@@ -409,7 +454,7 @@ impl ClaimExtractor {
 
         // Extract file references
         let mut file_refs: Vec<(usize, String)> = Vec::new();
-        for cap in file_re.captures_iter(response) {
+        for cap in FILE_REF_PATTERN.captures_iter(response) {
             if let Some(file) = cap.get(1) {
                 file_refs.push((cap.get(0).unwrap().start(), file.as_str().to_string()));
             }
@@ -442,8 +487,11 @@ impl ClaimExtractor {
                 }
 
                 // Look for inline code references within the claim
+                if !claim.text.contains('`') {
+                    continue;
+                }
                 let claim_text = &claim.text;
-                for cap in code_re.captures_iter(claim_text) {
+                for cap in INLINE_CODE_PATTERN.captures_iter(claim_text) {
                     if let Some(code) = cap.get(1) {
                         let code_text = code.as_str();
                         if code_text.len() > 2 {
@@ -469,8 +517,35 @@ impl ClaimExtractor {
     }
 
     /// Extract claims from multiple responses (for batch processing).
+    ///
+    /// Large batches are split across the available cores; results are in
+    /// input order either way.
     pub fn extract_batch(&self, responses: &[&str]) -> Vec<Vec<Claim>> {
-        responses.iter().map(|r| self.extract(r)).collect()
+        let total_bytes: usize = responses.iter().map(|r| r.len()).sum();
+        let workers = std::thread::available_parallelism()
+            .map_or(1, |n| n.get())
+            .min(responses.len());
+        if workers <= 1 || total_bytes < PARALLEL_BATCH_MIN_BYTES {
+            return responses.iter().map(|r| self.extract(r)).collect();
+        }
+
+        let chunk_size = responses.len().div_ceil(workers);
+        std::thread::scope(|scope| {
+            let workers: Vec<_> = responses
+                .chunks(chunk_size)
+                .map(|chunk| {
+                    scope.spawn(move || chunk.iter().map(|r| self.extract(r)).collect::<Vec<_>>())
+                })
+                .collect();
+            workers
+                .into_iter()
+                .flat_map(|worker| {
+                    worker
+                        .join()
+                        .unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+                })
+                .collect()
+        })
     }
 }
 
@@ -629,4 +704,61 @@ mod tests {
             assert!(claim.text.len() >= 20);
         }
     }
+
+    #[test]
+    fn test_spans_point_at_claim_text() {
+        let extractor = ClaimExtractor::new();
+        let response =
+            "The cache is warm.  The cache is warm.\n\nDr. Smith wrote the parser module.";
+
+        let claims = extractor.extract(response);
+        assert_eq!(claims.len(), 3);
+        for claim in &claims {
+            let (start, end) = claim.source_span.expect("every claim has a span");
+            assert_eq!(&response[start..end], claim.text);
+        }
+        // Repeated sentences get their own spans.
+        assert_ne!(claims[0].source_span, claims[1].source_span);
+        assert_eq!(claims[2].text, "Dr. Smith wrote the parser module.");
+    }
+
+    #[test]
+    fn test_word_stats_match_regex_definitions() {
+        let identifier_re = Regex::new(r"\b[A-Z][a-zA-Z0-9_]*\b").unwrap();
+        let number_re = Regex::new(r"\b\d+\b").unwrap();
+        for text in [
+            "The UserService class calls AuthController.validate()",
+            "Took 3.14 seconds over 12a runs, x42 and 7_b; v2 of HTTP2 Über",
+            "",
+            "_Private __init__ 2024-01-01 A",
+        ] {
+            assert_eq!(
+                WordStats::scan(text),
+                WordStats {
+                    identifiers: identifier_re.find_iter(text).count(),
+                    numbers: number_re.find_iter(text).count(),
+                },
+                "{text}"
+            );
+        }
+    }
+
+    #[test]
+    fn test_extract_batch_matches_sequential() {
+        let extractor = ClaimExtractor::new();
+        let response = "The function returns an integer. The latency is 50 milliseconds. ";
+        let owned: Vec<String> = (0..400)
+            .map(|i| format!("{response}Item {i} is cached."))
+            .collect();
+        let responses: Vec<&str> = owned.iter().map(String::as_str).collect();
+
+        let batch = extractor.extract_batch(&responses);
+        assert_eq!(batch.len(), responses.len());
+        for (claims, response) in batch.iter().zip(&responses) {
+            let expected = extractor.extract(response);
+            let texts: Vec<_> = claims.iter().map(|c| (&c.text, c.source_span)).collect();
+            let expected: Vec<_> = expected.iter().map(|c| (&c.text, c.source_span)).collect();
+            assert_eq!(texts, expected);
+        }
+    }
 }
@@ -5,8 +5,11 @@
 //! module provides utilities to mask or remove evidence from context before
 //! re-prompting for p0 estimation.
 
-use regex::Regex;
-use std::collections::HashSet;
+use regex::{Regex, RegexSet};
+use std::collections::{BTreeMap, HashSet};
+use std::sync::LazyLock;
+
+use crate::metrics::{self, Metric};
 
 /// Types of evidence that can be scrubbed.
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
@@ -96,44 +99,135 @@ impl ScrubConfig {
     }
 }
 
+/// Built-in scrub rules, in priority order: when matches overlap, the
+/// earlier rule wins.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum Rule {
+    CodeBlock,
+    ToolOutput,
+    InlineCode,
+    Citation,
+    Url,
+    Path,
+    Quote,
+    Number,
+}
+
+impl Rule {
+    const ALL: [Rule; 8] = [
+        Rule::CodeBlock,
+        Rule::ToolOutput,
+        Rule::InlineCode,
+        Rule::Citation,
+        Rule::Url,
+        Rule::Path,
+        Rule::Quote,
+        Rule::Number,
+    ];
+
+    fn pattern(self) -> &'static str {
+        match self {
+            // Fenced code blocks: ```lang\n...\n```
+            Rule::CodeBlock => r"(?s)```[a-zA-Z]*\n.*?\n```",
+            // Tool output sections (common patterns)
+            Rule::ToolOutput => {
+                r"(?s)(?:Output|Result|Response|REPL):\s*\n?```.*?```|\{[^}]{20,}\}"
+            }
+            // Inline code: `...`
+            Rule::InlineCode => r"`[^`]+`",
+            // Citations: [1], [source: ...], (ref: ...)
+            Rule::Citation => r"\[(?:\d+|source:[^\]]+)\]|\(ref:[^)]+\)",
+            // URLs
+            Rule::Url => r"https?://[^\s]+",
+            // File paths
+            Rule::Path => r"(?:/[a-zA-Z0-9_.-]+)+(?:\.[a-zA-Z]+)?|[a-zA-Z]:\\[^\s]+",
+            // Quoted text
+            Rule::Quote => r#""[^"]{10,}"|'[^']{10,}'"#,
+            // Significant numbers (more than just single digits)
+            Rule::Number => r"\b\d{2,}\b|\b\d+\.\d+\b|\b0x[0-9a-fA-F]+\b",
+        }
+    }
+
+    fn target(self) -> ScrubTarget {
+        match self {
+            Rule::CodeBlock | Rule::InlineCode => ScrubTarget::Code,
+            Rule::ToolOutput => ScrubTarget::ToolOutput,
+            Rule::Citation => ScrubTarget::Citations,
+            Rule::Url | Rule::Path => ScrubTarget::Paths,
+            Rule::Quote => ScrubTarget::Quotes,
+            Rule::Number => ScrubTarget::Numbers,
+        }
+    }
+}
+
+/// Compiled built-in rules, indexed like [`Rule::ALL`].
+static RULE_REGEXES: LazyLock<Vec<Regex>> = LazyLock::new(|| {
+    Rule::ALL
+        .iter()
+        .map(|rule| Regex::new(rule.pattern()).expect("Invalid regex"))
+        .collect()
+});
+
+/// A match that survived filtering, before overlap resolution.
+struct Candidate {
+    start: usize,
+    end: usize,
+    target: ScrubTarget,
+    /// Use the fenced placeholder instead of the plain one.
+    fenced: bool,
+}
+
 /// Scrub evidence from text based on configuration.
+///
+/// All enabled rules and custom patterns are compiled at construction into
+/// one [`RegexSet`]. A scrub runs that set once over the text, then locates
+/// matches only for the rules that fired. Matches are taken from the original
+/// text; overlaps go to the higher-priority rule (built-ins in [`Rule::ALL`]
+/// order, then custom patterns). The output is written into one buffer.
 pub struct EvidenceScrubber {
     config: ScrubConfig,
-    code_block_re: Regex,
-    inline_code_re: Regex,
-    tool_output_re: Regex,
-    citation_re: Regex,
-    path_re: Regex,
-    url_re: Regex,
-    quote_re: Regex,
-    number_re: Regex,
+    /// Enabled built-in rules, followed by custom patterns. `None` if the
+    /// combined set exceeds the regex size limit; every rule is then run.
+    set: Option<RegexSet>,
+    rules: Vec<Rule>,
+    custom: Vec<Regex>,
 }
 
 impl EvidenceScrubber {
     /// Create a new scrubber with the given configuration.
+    ///
+    /// Custom patterns that fail to compile are skipped with a warning.
     pub fn new(config: ScrubConfig) -> Self {
+        let scrub_all = config.targets.contains(&ScrubTarget::All);
+        let rules: Vec<Rule> = Rule::ALL
+            .into_iter()
+            .filter(|rule| scrub_all || config.targets.contains(&rule.target()))
+            .collect();
+        let custom: Vec<Regex> = config
+            .custom_patterns
+            .iter()
+            .filter_map(|pattern| match Regex::new(pattern) {
+                Ok(re) => Some(re),
+                Err(e) => {
+                    tracing::warn!(%pattern, error = %e, "Skipping invalid scrub pattern");
+                    None
+                }
+            })
+            .collect();
+
+        let patterns = rules
+            .iter()
+            .map(|rule| rule.pattern())
+            .chain(custom.iter().map(Regex::as_str));
+        let set = RegexSet::new(patterns)
+            .map_err(|e| tracing::warn!(error = %e, "Scrub rules too large to combine"))
+            .ok();
+
         Self {
             config,
-            // Matches fenced code blocks: ```lang\n...\n```
-            code_block_re: Regex::new(r"(?s)```[a-zA-Z]*\n.*?\n```").unwrap(),
-            // Matches inline code: `...`
-            inline_code_re: Regex::new(r"`[^`]+`").unwrap(),
-            // Matches tool output sections (common patterns)
-            tool_output_re: Regex::new(
-                r"(?s)(?:Output|Result|Response|REPL):\s*\n?```.*?```|\{[^}]{20,}\}",
-            )
-            .unwrap(),
-            // Matches citations: [1], [source: ...], (ref: ...)
-            citation_re: Regex::new(r"\[(?:\d+|source:[^\]]+)\]|\(ref:[^)]+\)").unwrap(),
-            // Matches file paths
-            path_re: Regex::new(r"(?:/[a-zA-Z0-9_.-]+)+(?:\.[a-zA-Z]+)?|[a-zA-Z]:\\[^\s]+")
-                .unwrap(),
-            // Matches URLs
-            url_re: Regex::new(r"https?://[^\s]+").unwrap(),
-            // Matches quoted text
-            quote_re: Regex::new(r#""[^"]{10,}"|'[^']{10,}'"#).unwrap(),
-            // Matches significant numbers (more than just single digits)
-            number_re: Regex::new(r"\b\d{2,}\b|\b\d+\.\d+\b|\b0x[0-9a-fA-F]+\b").unwrap(),
+            set,
+            rules,
+            custom,
         }
     }
 
@@ -144,207 +238,99 @@ impl EvidenceScrubber {
 
     /// Scrub evidence from the given text.
     pub fn scrub(&self, text: &str) -> ScrubResult {
-        let mut result = text.to_string();
-        let mut scrubbed_items = Vec::new();
-
-        let should_scrub = |target: ScrubTarget| {
-            self.config.targets.contains(&ScrubTarget::All) || self.config.targets.contains(&target)
+        let _timer = metrics::Timer::start(Metric::Scrub);
+        let fired: Vec<usize> = match self.set {
+            Some(ref set) => set.matches(text).into_iter().collect(),
+            None => (0..self.rules.len() + self.custom.len()).collect(),
         };
-
-        // Scrub code blocks first (they're the largest)
-        if should_scrub(ScrubTarget::Code) {
-            let items = self.scrub_code_blocks(&mut result);
-            scrubbed_items.extend(items);
-        }
-
-        // Scrub tool outputs
-        if should_scrub(ScrubTarget::ToolOutput) {
-            let items = self.scrub_tool_outputs(&mut result);
-            scrubbed_items.extend(items);
-        }
-
-        // Scrub inline code (after blocks, to avoid double-scrubbing)
-        if should_scrub(ScrubTarget::Code) {
-            let items = self.scrub_inline_code(&mut result);
-            scrubbed_items.extend(items);
-        }
-
-        // Scrub citations
-        if should_scrub(ScrubTarget::Citations) {
-            let items = self.scrub_citations(&mut result);
-            scrubbed_items.extend(items);
-        }
-
-        // Scrub paths
-        if should_scrub(ScrubTarget::Paths) {
-            let items = self.scrub_paths(&mut result);
-            scrubbed_items.extend(items);
-        }
-
-        // Scrub quotes
-        if should_scrub(ScrubTarget::Quotes) {
-            let items = self.scrub_quotes(&mut result);
-            scrubbed_items.extend(items);
+        let mut candidates = Vec::new();
+        for index in fired {
+            match self.rules.get(index) {
+                Some(&rule) => self.collect_rule(rule, text, &mut candidates),
+                None => {
+                    let re = &self.custom[index - self.rules.len()];
+                    for m in re.find_iter(text) {
+                        if m.len() >= self.config.min_length {
+                            candidates.push(Candidate {
+                                start: m.start(),
+                                end: m.end(),
+                                target: ScrubTarget::All,
+                                fenced: false,
+                            });
+                        }
+                    }
+                }
+            }
         }
 
-        // Scrub numbers
-        if should_scrub(ScrubTarget::Numbers) {
-            let items = self.scrub_numbers(&mut result);
-            scrubbed_items.extend(items);
+        // Candidates are grouped by priority; claim spans greedily.
+        let mut accepted: BTreeMap<usize, Candidate> = BTreeMap::new();
+        for candidate in candidates {
+            let overlaps = accepted
+                .range(..candidate.end)
+                .next_back()
+                .is_some_and(|(_, prior)| prior.end > candidate.start);
+            if !overlaps && candidate.end > candidate.start {
+                accepted.insert(candidate.start, candidate);
+            }
         }
 
-        // Apply custom patterns
-        for pattern in &self.config.custom_patterns {
-            if let Ok(re) = Regex::new(pattern) {
-                let items = self.scrub_pattern(&mut result, &re, "custom");
-                scrubbed_items.extend(items);
+        let fenced_placeholder = format!("```\n{}\n```", self.config.placeholder);
+        let placeholder_for = |c: &Candidate| {
+            if c.fenced {
+                fenced_placeholder.as_str()
+            } else {
+                self.config.placeholder.as_str()
             }
+        };
+        let capacity = accepted.values().fold(text.len(), |len, c| {
+            len - (c.end - c.start) + placeholder_for(c).len()
+        });
+
+        let mut scrubbed_text = String::with_capacity(capacity);
+        let mut scrubbed_items = Vec::with_capacity(accepted.len());
+        let mut cursor = 0;
+        for candidate in accepted.values() {
+            scrubbed_text.push_str(&text[cursor..candidate.start]);
+            scrubbed_text.push_str(placeholder_for(candidate));
+            cursor = candidate.end;
+            scrubbed_items.push(ScrubbedItem {
+                content: text[candidate.start..candidate.end].to_string(),
+                item_type: candidate.target,
+                start: candidate.start,
+                end: candidate.end,
+            });
         }
+        scrubbed_text.push_str(&text[cursor..]);
 
         ScrubResult {
-            scrubbed_text: result,
+            scrubbed_text,
             original_text: text.to_string(),
             scrubbed_items,
         }
     }
 
-    fn scrub_code_blocks(&self, text: &mut String) -> Vec<ScrubbedItem> {
-        let mut items = Vec::new();
-
-        let placeholder = if self.config.preserve_structure {
-            format!("```\n{}\n```", self.config.placeholder)
-        } else {
-            self.config.placeholder.clone()
-        };
-
-        // Collect matches first, then replace in reverse index order.
-        // This avoids re-matching newly inserted placeholders.
-        let matches: Vec<(usize, usize, String)> = self
-            .code_block_re
-            .find_iter(text)
-            .map(|m| (m.start(), m.end(), m.as_str().to_string()))
-            .collect();
-
-        for (start, end, content) in matches.into_iter().rev() {
-            if content.len() >= self.config.min_length {
-                items.push(ScrubbedItem {
-                    content,
-                    item_type: ScrubTarget::Code,
-                    start,
-                    end,
-                });
-                *text = format!("{}{}{}", &text[..start], placeholder, &text[end..]);
+    /// Push the matches of one built-in rule that pass its filters.
+    fn collect_rule(&self, rule: Rule, text: &str, candidates: &mut Vec<Candidate>) {
+        let re = &RULE_REGEXES[rule as usize];
+        for m in re.find_iter(text) {
+            // Citations are short by nature and always scrubbed.
+            if rule != Rule::Citation && m.len() < self.config.min_length {
+                continue;
             }
-        }
-
-        items.reverse();
-        items
-    }
-
-    fn scrub_inline_code(&self, text: &mut String) -> Vec<ScrubbedItem> {
-        let mut items = Vec::new();
-
-        // Avoid matching inside fenced code blocks (```...```), which should
-        // preserve structure when configured.
-        let matches: Vec<(usize, usize, String)> = self
-            .inline_code_re
-            .find_iter(text)
-            .filter_map(|m| {
-                let before = text[..m.start()].chars().next_back();
-                let after = text[m.end()..].chars().next();
-                if before == Some('`') || after == Some('`') {
-                    None
-                } else {
-                    Some((m.start(), m.end(), m.as_str().to_string()))
-                }
-            })
-            .collect();
-
-        for (start, end, content) in matches.into_iter().rev() {
-            if content.len() >= self.config.min_length {
-                items.push(ScrubbedItem {
-                    content,
-                    item_type: ScrubTarget::Code,
-                    start,
-                    end,
-                });
-                *text = format!(
-                    "{}{}{}",
-                    &text[..start],
-                    self.config.placeholder,
-                    &text[end..]
-                );
-            }
-        }
-
-        items.reverse();
-        items
-    }
-
-    fn scrub_tool_outputs(&self, text: &mut String) -> Vec<ScrubbedItem> {
-        self.scrub_pattern(text, &self.tool_output_re, "tool_output")
-    }
-
-    fn scrub_citations(&self, text: &mut String) -> Vec<ScrubbedItem> {
-        self.scrub_pattern(text, &self.citation_re, "citation")
-    }
-
-    fn scrub_paths(&self, text: &mut String) -> Vec<ScrubbedItem> {
-        let mut items = Vec::new();
-
-        // First URLs, then file paths
-        items.extend(self.scrub_pattern(text, &self.url_re, "url"));
-        items.extend(self.scrub_pattern(text, &self.path_re, "path"));
-
-        items
-    }
-
-    fn scrub_quotes(&self, text: &mut String) -> Vec<ScrubbedItem> {
-        self.scrub_pattern(text, &self.quote_re, "quote")
-    }
-
-    fn scrub_numbers(&self, text: &mut String) -> Vec<ScrubbedItem> {
-        self.scrub_pattern(text, &self.number_re, "number")
-    }
-
-    fn scrub_pattern(&self, text: &mut String, re: &Regex, type_name: &str) -> Vec<ScrubbedItem> {
-        let mut items = Vec::new();
-        let target = match type_name {
-            "code" => ScrubTarget::Code,
-            "tool_output" => ScrubTarget::ToolOutput,
-            "citation" => ScrubTarget::Citations,
-            "url" | "path" => ScrubTarget::Paths,
-            "quote" => ScrubTarget::Quotes,
-            "number" => ScrubTarget::Numbers,
-            _ => ScrubTarget::All,
-        };
-
-        // Find all matches first - collect positions and content
-        let matches: Vec<(usize, usize, String)> = re
-            .find_iter(text)
-            .map(|m| (m.start(), m.end(), m.as_str().to_string()))
-            .collect();
-
-        // Replace in reverse order to preserve indices
-        for (start, end, content) in matches.into_iter().rev() {
-            if content.len() >= self.config.min_length || target == ScrubTarget::Citations {
-                items.push(ScrubbedItem {
-                    content,
-                    item_type: target,
-                    start,
-                    end,
-                });
-                *text = format!(
-                    "{}{}{}",
-                    &text[..start],
-                    self.config.placeholder,
-                    &text[end..]
-                );
+            // Backtick runs belong to fenced blocks, not inline code.
+            if rule == Rule::InlineCode
+                && (text[..m.start()].ends_with('`') || text[m.end()..].starts_with('`'))
+            {
+                continue;
             }
+            candidates.push(Candidate {
+                start: m.start(),
+                end: m.end(),
+                target: rule.target(),
+                fenced: rule == Rule::CodeBlock && self.config.preserve_structure,
+            });
         }
-
-        items.reverse(); // Put back in original order
-        items
     }
 
     /// Scrub specific evidence items by their references.
@@ -643,4 +629,45 @@ This validates the input."#;
         let code_items = result.items_by_type(ScrubTarget::Code);
         assert!(!code_items.is_empty());
     }
+
+    #[test]
+    fn test_items_reference_original_text() {
+        let mut config = ScrubConfig::aggressive();
+        config.min_length = 2;
+        let scrubber = EvidenceScrubber::new(config);
+
+        let text = "Fetch https://example.com/v2/items [3] then run `cargo test` on 2048 rows.\n```\nlet x = 42;\n```";
+        let result = scrubber.scrub(text);
+
+        assert!(result.scrubbed_count() >= 5);
+        let mut last_end = 0;
+        for item in &result.scrubbed_items {
+            assert_eq!(&text[item.start..item.end], item.content);
+            assert!(item.start >= last_end, "items are ordered and disjoint");
+            last_end = item.end;
+        }
+        // The URL wins over the path inside it; the block wins over its number.
+        assert_eq!(result.items_by_type(ScrubTarget::Paths).len(), 1);
+        assert!(!result
+            .scrubbed_items
+            .iter()
+            .any(|i| i.content == "42" && i.item_type == ScrubTarget::Numbers));
+        assert!(!result.scrubbed_text.contains("2048"));
+    }
+
+    #[test]
+    fn test_invalid_custom_pattern_is_skipped() {
+        let config = ScrubConfig::default()
+            .with_custom_pattern("(unclosed")
+            .with_custom_pattern(r"secret-\d+");
+        let scrubber = EvidenceScrubber::new(config);
+
+        let result = scrubber.scrub("The token is secret-123456 here.");
+        assert_eq!(result.scrubbed_count(), 1);
+        assert_eq!(result.scrubbed_items[0].item_type, ScrubTarget::All);
+        assert_eq!(
+            result.scrubbed_text,
+            "The token is [EVIDENCE REDACTED] here."
+        );
+    }
 }
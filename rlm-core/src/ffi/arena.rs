@@ -0,0 +1,285 @@
+//! Request-scoped arenas for short-lived FFI objects.
+//!
+//! An [`Arena`] holds messages, tool outputs, nodes and trajectory events
+//! created with the `*_new_in` constructors, plus strings returned by the
+//! `*_in` accessors, in chunks that are reused across requests. Everything
+//! is released by one `rlm_arena_reset()` instead of a `*_free()` per object
+//! and an `rlm_string_free()` per string.
+
+use std::os::raw::c_char;
+
+use super::error::set_last_error;
+use super::types::{RlmArena, RlmMessage, RlmNode, RlmToolOutput, RlmTrajectoryEvent};
+
+/// Values in the first chunk of each slab.
+const FIRST_CHUNK: usize = 16;
+/// Largest chunk a slab grows to, in values.
+const MAX_CHUNK: usize = 4096;
+/// Bytes in the first text chunk.
+const FIRST_TEXT_CHUNK: usize = 4096;
+/// Largest text chunk, in bytes; longer strings get a chunk of their own.
+const MAX_TEXT_CHUNK: usize = 1 << 20;
+
+/// Typed bump storage. Chunks never reallocate, so pointers to values stay
+/// valid until [`Slab::reset`].
+struct Slab<T> {
+    chunks: Vec<Vec<T>>,
+}
+
+impl<T> Slab<T> {
+    const fn new() -> Self {
+        Self { chunks: Vec::new() }
+    }
+
+    fn alloc(&mut self, value: T) -> *mut T {
+        let full = self
+            .chunks
+            .last()
+            .is_none_or(|chunk| chunk.len() == chunk.capacity());
+        if full {
+            let capacity = self
+                .chunks
+                .last()
+                .map_or(FIRST_CHUNK, |chunk| (chunk.capacity() * 2).min(MAX_CHUNK));
+            self.chunks.push(Vec::with_capacity(capacity));
+        }
+        let chunk = self.chunks.last_mut().expect("chunk pushed above");
+        chunk.push(value);
+        // SAFETY: the value was just pushed, so `len - 1` is in bounds.
+        unsafe { chunk.as_mut_ptr().add(chunk.len() - 1) }
+    }
+
+    fn len(&self) -> usize {
+        self.chunks.iter().map(Vec::len).sum()
+    }
+
+    /// Drop every value, keeping the largest chunk for the next request.
+    fn reset(&mut self) {
+        let Some(mut largest) = self.chunks.pop() else {
+            return;
+        };
+        largest.clear();
+        self.chunks.clear();
+        self.chunks.push(largest);
+    }
+}
+
+/// Bump storage for NUL-terminated strings.
+struct TextSlab {
+    chunks: Vec<Vec<u8>>,
+    /// Reusable buffer for strings that are formatted before being copied.
+    scratch: Vec<u8>,
+}
+
+impl TextSlab {
+    const fn new() -> Self {
+        Self {
+            chunks: Vec::new(),
+            scratch: Vec::new(),
+        }
+    }
+
+    /// Copy `bytes` and a NUL terminator into the slab.
+    fn alloc(&mut self, bytes: &[u8]) -> *const c_char {
+        let needed = bytes.len() + 1;
+        let fits = self
+            .chunks
+            .last()
+            .is_some_and(|chunk| chunk.capacity() - chunk.len() >= needed);
+        if !fits {
+            let grown = self.chunks.last().map_or(FIRST_TEXT_CHUNK, |chunk| {
+                (chunk.capacity() * 2).min(MAX_TEXT_CHUNK)
+            });
+            self.chunks.push(Vec::with_capacity(grown.max(needed)));
+        }
+        let chunk = self.chunks.last_mut().expect("chunk pushed above");
+        let start = chunk.len();
+        chunk.extend_from_slice(bytes);
+        chunk.push(0);
+        // SAFETY: `start` is within the bytes just written; capacity was
+        // reserved above, so the chunk did not reallocate.
+        unsafe { chunk.as_ptr().add(start) as *const c_char }
+    }
+
+    /// Format into the scratch buffer with `write`, then copy the result in.
+    /// Returns `Ok(None)` if the formatted string contains a NUL byte.
+    fn alloc_with<E>(
+        &mut self,
+        write: impl FnOnce(&mut Vec<u8>) -> Result<(), E>,
+    ) -> Result<Option<*const c_char>, E> {
+        let mut scratch = std::mem::take(&mut self.scratch);
+        scratch.clear();
+        let result =
+            write(&mut scratch).map(|()| (!scratch.contains(&0)).then(|| self.alloc(&scratch)));
+        self.scratch = scratch;
+        result
+    }
+
+    fn bytes(&self) -> usize {
+        self.chunks.iter().map(Vec::len).sum()
+    }
+
+    /// Drop every string, keeping the largest chunk for the next request.
+    fn reset(&mut self) {
+        let Some(largest) = (0..self.chunks.len()).max_by_key(|&i| self.chunks[i].capacity())
+        else {
+            return;
+        };
+        let mut largest = self.chunks.swap_remove(largest);
+        largest.clear();
+        self.chunks.clear();
+        self.chunks.push(largest);
+    }
+}
+
+/// Storage behind an [`RlmArena`] handle.
+pub(crate) struct Arena {
+    messages: Slab<RlmMessage>,
+    tool_outputs: Slab<RlmToolOutput>,
+    nodes: Slab<RlmNode>,
+    events: Slab<RlmTrajectoryEvent>,
+    text: TextSlab,
+}
+
+impl Arena {
+    pub(crate) const fn new() -> Self {
+        Self {
+            messages: Slab::new(),
+            tool_outputs: Slab::new(),
+            nodes: Slab::new(),
+            events: Slab::new(),
+            text: TextSlab::new(),
+        }
+    }
+
+    pub(crate) fn message(&mut self, message: RlmMessage) -> *mut RlmMessage {
+        self.messages.alloc(message)
+    }
+
+    pub(crate) fn tool_output(&mut self, output: RlmToolOutput) -> *mut RlmToolOutput {
+        self.tool_outputs.alloc(output)
+    }
+
+    pub(crate) fn node(&mut self, node: RlmNode) -> *mut RlmNode {
+        self.nodes.alloc(node)
+    }
+
+    pub(crate) fn event(&mut self, event: RlmTrajectoryEvent) -> *mut RlmTrajectoryEvent {
+        self.events.alloc(event)
+    }
+
+    /// Copy `s` into the arena as a C string. Returns NULL and sets the last
+    /// error if `s` contains a NUL byte, like `str_to_cstring`.
+    pub(crate) fn str(&mut self, s: &str) -> *const c_char {
+        if s.as_bytes().contains(&0) {
+            set_last_error("string contains null byte");
+            return std::ptr::null();
+        }
+        self.text.alloc(s.as_bytes())
+    }
+
+    /// Format a string in place (e.g. `serde_json::to_writer`) and keep it in
+    /// the arena.
+    pub(crate) fn str_with<E: std::fmt::Display>(
+        &mut self,
+        write: impl FnOnce(&mut Vec<u8>) -> Result<(), E>,
+    ) -> *const c_char {
+        match self.text.alloc_with(write) {
+            Ok(Some(ptr)) => ptr,
+            Ok(None) => {
+                set_last_error("string contains null byte");
+                std::ptr::null()
+            }
+            Err(e) => {
+                set_last_error(&e.to_string());
+                std::ptr::null()
+            }
+        }
+    }
+
+    fn reset(&mut self) {
+        self.messages.reset();
+        self.tool_outputs.reset();
+        self.nodes.reset();
+        self.events.reset();
+        self.text.reset();
+    }
+}
+
+/// Borrow the arena behind a handle, setting the last error if it is NULL.
+///
+/// # Safety
+/// `arena` must be a valid arena pointer or NULL, not aliased for `'a`.
+pub(crate) unsafe fn arena_mut<'a>(arena: *mut RlmArena) -> Option<&'a mut Arena> {
+    if arena.is_null() {
+        set_last_error("null arena pointer");
+        return None;
+    }
+    Some(&mut (*arena).0)
+}
+
+// ============================================================================
+// Arena lifecycle
+// ============================================================================
+
+/// Create an empty arena.
+///
+/// An arena is not thread-safe: use one per request (or per thread).
+///
+/// # Safety
+/// The returned pointer must be freed with `rlm_arena_free()`.
+#[no_mangle]
+pub extern "C" fn rlm_arena_new() -> *mut RlmArena {
+    Box::into_raw(Box::new(RlmArena(Arena::new())))
+}
+
+/// Release every object and string allocated in the arena, keeping its
+/// memory for reuse.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer, or NULL.
+/// - Every pointer obtained from the arena is invalid after this call.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_arena_reset(arena: *mut RlmArena) {
+    if !arena.is_null() {
+        (*arena).0.reset();
+    }
+}
+
+/// Free an arena and everything allocated in it.
+///
+/// # Safety
+/// - `arena` must be a valid pointer returned by `rlm_arena_new()`, or NULL.
+/// - Every pointer obtained from the arena is invalid after this call.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_arena_free(arena: *mut RlmArena) {
+    if !arena.is_null() {
+        drop(Box::from_raw(arena));
+    }
+}
+
+/// Number of objects currently allocated in the arena.
+///
+/// # Safety
+/// `arena` must be a valid arena pointer.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_arena_object_count(arena: *const RlmArena) -> usize {
+    if arena.is_null() {
+        return 0;
+    }
+    let arena = &(*arena).0;
+    arena.messages.len() + arena.tool_outputs.len() + arena.nodes.len() + arena.events.len()
+}
+
+/// Bytes of string data currently allocated in the arena, including
+/// terminators.
+///
+/// # Safety
+/// `arena` must be a valid arena pointer.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_arena_string_bytes(arena: *const RlmArena) -> usize {
+    if arena.is_null() {
+        return 0;
+    }
+    (*arena).0.text.bytes()
+}
@@ -1,10 +1,23 @@
 //! FFI bindings for context types.
 
+use std::collections::HashMap;
 use std::os::raw::c_char;
+use std::sync::{Arc, LazyLock, Mutex};
 
+use super::arena::arena_mut;
 use super::error::{cstr_to_str, ffi_try, set_last_error, str_to_cstring};
-use super::types::{RlmMessage, RlmRole, RlmSessionContext, RlmToolOutput};
-use crate::context::{Message, Role, SessionContext, ToolOutput};
+use super::types::{
+    RlmArena, RlmMessage, RlmRole, RlmSessionContext, RlmSessionSnapshot, RlmSessionSnapshotWriter,
+    RlmSnapshotCheckpointStats, RlmStrView, RlmToolOutput,
+};
+use crate::context::{
+    BpeTokenizer, Message, Role, SessionContext, SessionSnapshot, SnapshotWriter, Tokenizer,
+    ToolOutput,
+};
+
+/// Rank tables loaded by path, shared by every context that uses them.
+static TOKENIZERS: LazyLock<Mutex<HashMap<String, Arc<BpeTokenizer>>>> =
+    LazyLock::new(|| Mutex::new(HashMap::new()));
 
 // ============================================================================
 // SessionContext
@@ -130,6 +143,28 @@ pub unsafe extern "C" fn rlm_session_context_get_file(
     }
 }
 
+/// Borrow a cached file's contents without copying.
+///
+/// Returns `{ NULL, 0 }` if the file is not cached or on error.
+///
+/// # Safety
+/// - `ctx` must be a valid pointer to a session context.
+/// - `path` must be a valid null-terminated string.
+/// - The view is not NUL-terminated and is valid only until `ctx` is mutated
+///   or freed. Do not pass it to `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_context_get_file_view(
+    ctx: *const RlmSessionContext,
+    path: *const c_char,
+) -> RlmStrView {
+    if ctx.is_null() {
+        set_last_error("null context pointer");
+        return RlmStrView::null();
+    }
+    let path = ffi_try!(cstr_to_str(path), RlmStrView::null());
+    RlmStrView::borrow_opt((*ctx).0.get_file(path))
+}
+
 /// Add a tool output to the session context.
 ///
 /// # Safety
@@ -203,6 +238,48 @@ pub unsafe extern "C" fn rlm_session_context_total_message_tokens(
     (*ctx).0.total_message_tokens() as i64
 }
 
+/// Get total tokens across messages, files and tool outputs.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_context_total_tokens(ctx: *const RlmSessionContext) -> i64 {
+    if ctx.is_null() {
+        return 0;
+    }
+    (*ctx).0.total_tokens() as i64
+}
+
+/// Count tokens with a BPE tokenizer loaded from a `.tiktoken` rank file
+/// instead of the ~4 bytes/token estimate. Existing content is recounted.
+/// Rank tables are cached by path for the life of the process.
+///
+/// # Safety
+/// - `ctx` must be a valid pointer.
+/// - `tiktoken_path` must be a valid null-terminated string.
+///
+/// Returns 0 on success, -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_context_load_tokenizer(
+    ctx: *mut RlmSessionContext,
+    tiktoken_path: *const c_char,
+) -> i32 {
+    if ctx.is_null() {
+        set_last_error("null context pointer");
+        return -1;
+    }
+    let path = ffi_try!(cstr_to_str(tiktoken_path), -1);
+    let mut cache = TOKENIZERS.lock().unwrap_or_else(|e| e.into_inner());
+    let bpe = match cache.get(path) {
+        Some(bpe) => Arc::clone(bpe),
+        None => {
+            let bpe = Arc::new(ffi_try!(BpeTokenizer::from_tiktoken_file(path), -1));
+            cache.insert(path.to_string(), Arc::clone(&bpe));
+            bpe
+        }
+    };
+    drop(cache);
+    (*ctx).0.set_tokenizer(Tokenizer::Bpe(bpe));
+    0
+}
+
 /// Serialize context to JSON.
 ///
 /// # Safety
@@ -236,6 +313,190 @@ pub unsafe extern "C" fn rlm_session_context_from_json(
     Box::into_raw(Box::new(RlmSessionContext(ctx)))
 }
 
+// ============================================================================
+// SessionSnapshot
+// ============================================================================
+
+/// Create a binary session snapshot at `path`, replacing any existing one.
+///
+/// # Safety
+/// - `path` must be a valid null-terminated string.
+/// - The returned pointer must be freed with `rlm_session_snapshot_writer_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_writer_create(
+    path: *const c_char,
+) -> *mut RlmSessionSnapshotWriter {
+    let path = ffi_try!(cstr_to_str(path));
+    let writer = ffi_try!(SnapshotWriter::create(path));
+    Box::into_raw(Box::new(RlmSessionSnapshotWriter(writer)))
+}
+
+/// Continue the snapshot at `path`, creating it if missing. The next
+/// checkpoint is a delta against the last committed one.
+///
+/// # Safety
+/// - `path` must be a valid null-terminated string.
+/// - The returned pointer must be freed with `rlm_session_snapshot_writer_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_writer_append(
+    path: *const c_char,
+) -> *mut RlmSessionSnapshotWriter {
+    let path = ffi_try!(cstr_to_str(path));
+    let writer = ffi_try!(SnapshotWriter::append(path));
+    Box::into_raw(Box::new(RlmSessionSnapshotWriter(writer)))
+}
+
+/// Stream a new snapshot to a file descriptor (a file, pipe or socket). The
+/// descriptor is duplicated; the caller keeps ownership of `fd`.
+///
+/// # Safety
+/// - `fd` must be an open, writable file descriptor.
+/// - The returned pointer must be freed with `rlm_session_snapshot_writer_free()`.
+#[cfg(unix)]
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_writer_from_fd(
+    fd: std::os::raw::c_int,
+) -> *mut RlmSessionSnapshotWriter {
+    if fd < 0 {
+        set_last_error("invalid file descriptor");
+        return std::ptr::null_mut();
+    }
+    let owned = match std::os::fd::BorrowedFd::borrow_raw(fd).try_clone_to_owned() {
+        Ok(owned) => owned,
+        Err(e) => {
+            set_last_error(&format!("Failed to duplicate fd {}: {}", fd, e));
+            return std::ptr::null_mut();
+        }
+    };
+    let out = std::io::BufWriter::new(std::fs::File::from(owned));
+    let writer = ffi_try!(SnapshotWriter::new(out));
+    Box::into_raw(Box::new(RlmSessionSnapshotWriter(writer)))
+}
+
+/// Append a checkpoint of `ctx` and flush it. Writers opened by path also
+/// sync it to disk.
+///
+/// After a failure the writer should be freed and the snapshot resumed with
+/// `rlm_session_snapshot_writer_append()`.
+///
+/// # Safety
+/// - `writer` and `ctx` must be valid pointers.
+/// - `stats_out` may be NULL; otherwise it receives what was appended.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_writer_checkpoint(
+    writer: *mut RlmSessionSnapshotWriter,
+    ctx: *const RlmSessionContext,
+    stats_out: *mut RlmSnapshotCheckpointStats,
+) -> i32 {
+    if writer.is_null() || ctx.is_null() {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let stats = ffi_try!((*writer).0.checkpoint(&(*ctx).0), -1);
+    if !stats_out.is_null() {
+        *stats_out = stats.into();
+    }
+    0
+}
+
+/// Free a snapshot writer.
+///
+/// # Safety
+/// - `writer` must be a valid pointer returned by a `rlm_session_snapshot_writer_*`
+///   constructor, or NULL.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_writer_free(writer: *mut RlmSessionSnapshotWriter) {
+    if !writer.is_null() {
+        drop(Box::from_raw(writer));
+    }
+}
+
+/// Map a snapshot and resume its last committed checkpoint. File bodies
+/// are read from the mapping only when requested.
+///
+/// # Safety
+/// - `path` must be a valid null-terminated string.
+/// - The returned pointer must be freed with `rlm_session_snapshot_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_open(path: *const c_char) -> *mut RlmSessionSnapshot {
+    let path = ffi_try!(cstr_to_str(path));
+    let snapshot = ffi_try!(SessionSnapshot::open(path));
+    Box::into_raw(Box::new(RlmSessionSnapshot(snapshot)))
+}
+
+/// Free a snapshot, unmapping it.
+///
+/// # Safety
+/// - `snapshot` must be a valid pointer returned by `rlm_session_snapshot_open()`, or NULL.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_free(snapshot: *mut RlmSessionSnapshot) {
+    if !snapshot.is_null() {
+        drop(Box::from_raw(snapshot));
+    }
+}
+
+/// Get the number of messages in a snapshot.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_message_count(
+    snapshot: *const RlmSessionSnapshot,
+) -> i64 {
+    if snapshot.is_null() {
+        return 0;
+    }
+    (*snapshot).0.messages().len() as i64
+}
+
+/// Get the number of cached files in a snapshot.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_file_count(
+    snapshot: *const RlmSessionSnapshot,
+) -> i64 {
+    if snapshot.is_null() {
+        return 0;
+    }
+    (*snapshot).0.file_count() as i64
+}
+
+/// Borrow a cached file's contents straight from the snapshot mapping.
+///
+/// Returns `{ NULL, 0 }` if the file is not cached or on error.
+///
+/// # Safety
+/// - `snapshot` must be a valid pointer to a snapshot.
+/// - `path` must be a valid null-terminated string.
+/// - The view is not NUL-terminated and is valid until `snapshot` is freed.
+///   Do not pass it to `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_get_file_view(
+    snapshot: *const RlmSessionSnapshot,
+    path: *const c_char,
+) -> RlmStrView {
+    if snapshot.is_null() {
+        set_last_error("null snapshot pointer");
+        return RlmStrView::null();
+    }
+    let path = ffi_try!(cstr_to_str(path), RlmStrView::null());
+    let content = ffi_try!((*snapshot).0.file(path), RlmStrView::null());
+    RlmStrView::borrow_opt(content)
+}
+
+/// Materialize a snapshot as a session context, reading every body.
+///
+/// # Safety
+/// - `snapshot` must be a valid pointer to a snapshot.
+/// - The returned pointer must be freed with `rlm_session_context_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_session_snapshot_to_context(
+    snapshot: *const RlmSessionSnapshot,
+) -> *mut RlmSessionContext {
+    if snapshot.is_null() {
+        set_last_error("null snapshot pointer");
+        return std::ptr::null_mut();
+    }
+    let ctx = ffi_try!((*snapshot).0.to_context());
+    Box::into_raw(Box::new(RlmSessionContext(ctx)))
+}
+
 // ============================================================================
 // Message
 // ============================================================================
@@ -310,6 +571,20 @@ pub unsafe extern "C" fn rlm_message_content(msg: *const RlmMessage) -> *mut c_c
     str_to_cstring(&(*msg).0.content)
 }
 
+/// Borrow the content of a message without copying.
+///
+/// # Safety
+/// The view is not NUL-terminated and is valid only until `msg` is freed.
+/// Do not pass it to `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_message_content_view(msg: *const RlmMessage) -> RlmStrView {
+    if msg.is_null() {
+        set_last_error("null message pointer");
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow(&(*msg).0.content)
+}
+
 /// Get the timestamp of a message (RFC3339 format).
 ///
 /// # Safety
@@ -326,6 +601,49 @@ pub unsafe extern "C" fn rlm_message_timestamp(msg: *const RlmMessage) -> *mut c
     }
 }
 
+/// Create a message in an arena.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - `content` must be a valid null-terminated string.
+/// - The message is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_message_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_message_new_in(
+    arena: *mut RlmArena,
+    role: RlmRole,
+    content: *const c_char,
+) -> *mut RlmMessage {
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null_mut();
+    };
+    let content = ffi_try!(cstr_to_str(content));
+    arena.message(RlmMessage(Message::new(Role::from(role), content)))
+}
+
+/// Get the timestamp of a message (RFC3339 format) as an arena string.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - The string is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_string_free()`. Returns NULL if no timestamp is set.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_message_timestamp_in(
+    arena: *mut RlmArena,
+    msg: *const RlmMessage,
+) -> *const c_char {
+    if msg.is_null() {
+        return std::ptr::null();
+    }
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null();
+    };
+    match (*msg).0.timestamp {
+        Some(ts) => arena.str(&ts.to_rfc3339()),
+        None => std::ptr::null(),
+    }
+}
+
 // ============================================================================
 // ToolOutput
 // ============================================================================
@@ -358,6 +676,47 @@ pub unsafe extern "C" fn rlm_tool_output_new_with_exit_code(
     Box::into_raw(Box::new(RlmToolOutput(output)))
 }
 
+/// Create a tool output in an arena.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - `tool_name` and `content` must be valid null-terminated strings.
+/// - The output is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_tool_output_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_tool_output_new_in(
+    arena: *mut RlmArena,
+    tool_name: *const c_char,
+    content: *const c_char,
+) -> *mut RlmToolOutput {
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null_mut();
+    };
+    let tool_name = ffi_try!(cstr_to_str(tool_name));
+    let content = ffi_try!(cstr_to_str(content));
+    arena.tool_output(RlmToolOutput(ToolOutput::new(tool_name, content)))
+}
+
+/// Create a tool output with an exit code in an arena.
+///
+/// # Safety
+/// Same as `rlm_tool_output_new_in()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_tool_output_new_with_exit_code_in(
+    arena: *mut RlmArena,
+    tool_name: *const c_char,
+    content: *const c_char,
+    exit_code: i32,
+) -> *mut RlmToolOutput {
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null_mut();
+    };
+    let tool_name = ffi_try!(cstr_to_str(tool_name));
+    let content = ffi_try!(cstr_to_str(content));
+    let output = ToolOutput::new(tool_name, content).with_exit_code(exit_code);
+    arena.tool_output(RlmToolOutput(output))
+}
+
 /// Free a tool output.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_tool_output_free(output: *mut RlmToolOutput) {
@@ -379,6 +738,21 @@ pub unsafe extern "C" fn rlm_tool_output_tool_name(output: *const RlmToolOutput)
     str_to_cstring(&(*output).0.tool_name)
 }
 
+/// Borrow the tool name without copying.
+///
+/// # Safety
+/// The view is not NUL-terminated and is valid only until `output` is freed.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_tool_output_tool_name_view(
+    output: *const RlmToolOutput,
+) -> RlmStrView {
+    if output.is_null() {
+        set_last_error("null pointer");
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow(&(*output).0.tool_name)
+}
+
 /// Get the content.
 ///
 /// # Safety
@@ -392,6 +766,19 @@ pub unsafe extern "C" fn rlm_tool_output_content(output: *const RlmToolOutput) -
     str_to_cstring(&(*output).0.content)
 }
 
+/// Borrow the content without copying.
+///
+/// # Safety
+/// The view is not NUL-terminated and is valid only until `output` is freed.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_tool_output_content_view(output: *const RlmToolOutput) -> RlmStrView {
+    if output.is_null() {
+        set_last_error("null pointer");
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow(&(*output).0.content)
+}
+
 /// Get the exit code. Returns -1 if not set.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_tool_output_exit_code(output: *const RlmToolOutput) -> i32 {
@@ -484,6 +871,66 @@ pub unsafe extern "C" fn rlm_pattern_classifier_should_activate(
     Box::into_raw(Box::new(super::types::RlmActivationDecision(decision)))
 }
 
+/// Create an empty classifier session for incremental classification.
+///
+/// # Safety
+/// The returned pointer must be freed with `rlm_classifier_session_free()`.
+#[no_mangle]
+pub extern "C" fn rlm_classifier_session_new() -> *mut super::types::RlmClassifierSession {
+    Box::into_raw(Box::new(super::types::RlmClassifierSession(
+        crate::complexity::ClassifierSession::new(),
+    )))
+}
+
+/// Forget the cached state of a classifier session.
+///
+/// # Safety
+/// `session` must be a valid pointer or NULL.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_classifier_session_reset(
+    session: *mut super::types::RlmClassifierSession,
+) {
+    if !session.is_null() {
+        (*session).0.reset();
+    }
+}
+
+/// Free a classifier session.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_classifier_session_free(
+    session: *mut super::types::RlmClassifierSession,
+) {
+    if !session.is_null() {
+        drop(Box::from_raw(session));
+    }
+}
+
+/// Check if RLM should activate for a query, reusing state cached in
+/// `session` so only context added since the previous call is scanned.
+///
+/// # Safety
+/// - `classifier` and `session` must be valid pointers.
+/// - `query` must be a valid null-terminated string.
+/// - `ctx` must be a valid pointer to a session context.
+/// - The returned pointer must be freed with `rlm_activation_decision_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_pattern_classifier_should_activate_incremental(
+    classifier: *const super::types::RlmPatternClassifier,
+    session: *mut super::types::RlmClassifierSession,
+    query: *const c_char,
+    ctx: *const RlmSessionContext,
+) -> *mut super::types::RlmActivationDecision {
+    if classifier.is_null() || session.is_null() || ctx.is_null() {
+        set_last_error("null pointer");
+        return std::ptr::null_mut();
+    }
+    let query = ffi_try!(cstr_to_str(query));
+    let decision = (*classifier)
+        .0
+        .should_activate_incremental(&mut (*session).0, query, &(*ctx).0);
+    Box::into_raw(Box::new(super::types::RlmActivationDecision(decision)))
+}
+
 // ============================================================================
 // ActivationDecision
 // ============================================================================
@@ -528,6 +975,21 @@ pub unsafe extern "C" fn rlm_activation_decision_reason(
     str_to_cstring(&(*decision).0.reason)
 }
 
+/// Borrow the decision reason without copying.
+///
+/// # Safety
+/// The view is not NUL-terminated and is valid only until `decision` is freed.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_activation_decision_reason_view(
+    decision: *const super::types::RlmActivationDecision,
+) -> RlmStrView {
+    if decision.is_null() {
+        set_last_error("null pointer");
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow(&(*decision).0.reason)
+}
+
 /// Get the complexity score.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_activation_decision_score(
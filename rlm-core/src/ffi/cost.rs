@@ -7,8 +7,13 @@
 //!
 //! These integrate with the Go budget package to provide
 //! shared cost calculation and tracking logic.
+//!
+//! The tracker is backed by [`ShardedCostTracker`], so a single handle may be
+//! recorded into and read from any number of threads concurrently.
 
-use crate::llm::{CostTracker, ModelSpec, TokenUsage};
+use super::error::set_last_error;
+use super::types::{RlmCostSnapshot, RlmStrView, RlmUsageCosts};
+use crate::llm::{CostTracker, ModelCosts, ModelSpec, ShardedCostTracker, TierCosts, TokenUsage};
 use std::ffi::CStr;
 use std::ffi::CString;
 use std::os::raw::c_char;
@@ -17,8 +22,8 @@ use std::os::raw::c_char;
 // CostTracker FFI
 // ============================================================================
 
-/// Opaque handle for CostTracker.
-pub struct RlmCostTracker(CostTracker);
+/// Opaque handle for a thread-safe cost tracker.
+pub struct RlmCostTracker(ShardedCostTracker);
 
 /// Create a new cost tracker.
 ///
@@ -26,7 +31,7 @@ pub struct RlmCostTracker(CostTracker);
 /// The returned tracker must be freed with `rlm_cost_tracker_free()`.
 #[no_mangle]
 pub extern "C" fn rlm_cost_tracker_new() -> *mut RlmCostTracker {
-    Box::into_raw(Box::new(RlmCostTracker(CostTracker::new())))
+    Box::into_raw(Box::new(RlmCostTracker(ShardedCostTracker::new())))
 }
 
 /// Free a cost tracker.
@@ -41,7 +46,8 @@ pub unsafe extern "C" fn rlm_cost_tracker_free(tracker: *mut RlmCostTracker) {
     }
 }
 
-/// Record token usage from a completion.
+/// Record token usage from a completion. Safe to call concurrently on the
+/// same tracker.
 ///
 /// # Safety
 /// - `tracker` must be a valid pointer.
@@ -99,7 +105,8 @@ pub unsafe extern "C" fn rlm_cost_tracker_merge(
     if tracker.is_null() || other.is_null() {
         return -1;
     }
-    (*tracker).0.merge(&(*other).0);
+    let other = (*other).0.snapshot();
+    (*tracker).0.merge(&other);
     0
 }
 
@@ -111,7 +118,7 @@ pub unsafe extern "C" fn rlm_cost_tracker_total_input_tokens(
     if tracker.is_null() {
         return 0;
     }
-    (*tracker).0.total_input_tokens
+    (*tracker).0.totals().input_tokens
 }
 
 /// Get total output tokens.
@@ -122,7 +129,7 @@ pub unsafe extern "C" fn rlm_cost_tracker_total_output_tokens(
     if tracker.is_null() {
         return 0;
     }
-    (*tracker).0.total_output_tokens
+    (*tracker).0.totals().output_tokens
 }
 
 /// Get total cache read tokens.
@@ -133,7 +140,7 @@ pub unsafe extern "C" fn rlm_cost_tracker_total_cache_read_tokens(
     if tracker.is_null() {
         return 0;
     }
-    (*tracker).0.total_cache_read_tokens
+    (*tracker).0.totals().cache_read_tokens
 }
 
 /// Get total cache creation tokens.
@@ -144,7 +151,7 @@ pub unsafe extern "C" fn rlm_cost_tracker_total_cache_creation_tokens(
     if tracker.is_null() {
         return 0;
     }
-    (*tracker).0.total_cache_creation_tokens
+    (*tracker).0.totals().cache_creation_tokens
 }
 
 /// Get total cost in USD.
@@ -153,7 +160,7 @@ pub unsafe extern "C" fn rlm_cost_tracker_total_cost(tracker: *const RlmCostTrac
     if tracker.is_null() {
         return 0.0;
     }
-    (*tracker).0.total_cost
+    (*tracker).0.totals().total_cost
 }
 
 /// Get request count.
@@ -162,7 +169,7 @@ pub unsafe extern "C" fn rlm_cost_tracker_request_count(tracker: *const RlmCostT
     if tracker.is_null() {
         return 0;
     }
-    (*tracker).0.request_count
+    (*tracker).0.totals().request_count
 }
 
 /// Get per-model cost breakdown as JSON.
@@ -178,7 +185,7 @@ pub unsafe extern "C" fn rlm_cost_tracker_by_model_json(
         return std::ptr::null_mut();
     }
 
-    match serde_json::to_string(&(*tracker).0.by_model) {
+    match serde_json::to_string(&(*tracker).0.by_model()) {
         Ok(json) => match CString::new(json) {
             Ok(s) => s.into_raw(),
             Err(_) => std::ptr::null_mut(),
@@ -198,7 +205,7 @@ pub unsafe extern "C" fn rlm_cost_tracker_to_json(tracker: *const RlmCostTracker
         return std::ptr::null_mut();
     }
 
-    match serde_json::to_string(&(*tracker).0) {
+    match serde_json::to_string(&(*tracker).0.snapshot()) {
         Ok(json) => match CString::new(json) {
             Ok(s) => s.into_raw(),
             Err(_) => std::ptr::null_mut(),
@@ -224,11 +231,97 @@ pub unsafe extern "C" fn rlm_cost_tracker_from_json(json: *const c_char) -> *mut
     };
 
     match serde_json::from_str::<CostTracker>(json_str) {
-        Ok(tracker) => Box::into_raw(Box::new(RlmCostTracker(tracker))),
+        Ok(tracker) => Box::into_raw(Box::new(RlmCostTracker(ShardedCostTracker::from(&tracker)))),
         Err(_) => std::ptr::null_mut(),
     }
 }
 
+fn usage_costs(costs: &TierCosts) -> RlmUsageCosts {
+    RlmUsageCosts {
+        input_tokens: costs.input_tokens,
+        output_tokens: costs.output_tokens,
+        request_count: costs.request_count,
+        cost: costs.cost,
+    }
+}
+
+/// Fill `out` with aggregated totals and tier costs without serializing.
+///
+/// # Safety
+/// - `tracker` and `out` must be valid pointers.
+///
+/// Returns 0 on success, -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_cost_tracker_snapshot_into(
+    tracker: *const RlmCostTracker,
+    out: *mut RlmCostSnapshot,
+) -> i32 {
+    if tracker.is_null() || out.is_null() {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let totals = (*tracker).0.totals();
+    *out = RlmCostSnapshot {
+        input_tokens: totals.input_tokens,
+        output_tokens: totals.output_tokens,
+        cache_read_tokens: totals.cache_read_tokens,
+        cache_creation_tokens: totals.cache_creation_tokens,
+        request_count: totals.request_count,
+        total_cost: totals.total_cost,
+        tiers: totals.tiers.each_ref().map(usage_costs),
+    };
+    0
+}
+
+/// Number of models addressable with `rlm_cost_tracker_model_costs_into()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_cost_tracker_model_count(tracker: *const RlmCostTracker) -> usize {
+    if tracker.is_null() {
+        return 0;
+    }
+    (*tracker).0.model_count()
+}
+
+/// Fill `out` with the costs of the model at `index` and `name` with a view
+/// of its name (valid until the tracker is freed). `name` may be NULL.
+///
+/// # Safety
+/// - `tracker` and `out` must be valid pointers; `name` must be valid or NULL.
+///
+/// Returns 0 on success, -1 if `index` is out of range.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_cost_tracker_model_costs_into(
+    tracker: *const RlmCostTracker,
+    index: usize,
+    out: *mut RlmUsageCosts,
+    name: *mut RlmStrView,
+) -> i32 {
+    if tracker.is_null() || out.is_null() {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let Some((model, costs)) = (*tracker).0.model_costs(index) else {
+        set_last_error(&format!("model index {} out of range", index));
+        return -1;
+    };
+    let ModelCosts {
+        input_tokens,
+        output_tokens,
+        cost,
+        request_count,
+    } = costs;
+    *out = RlmUsageCosts {
+        input_tokens,
+        output_tokens,
+        request_count,
+        cost,
+    };
+    if !name.is_null() {
+        *name = RlmStrView::borrow(model);
+    }
+    0
+}
+
 // ============================================================================
 // ModelSpec FFI - Cost calculation helpers
 // ============================================================================
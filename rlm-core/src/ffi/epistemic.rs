@@ -61,24 +61,63 @@ pub unsafe extern "C" fn rlm_claim_extractor_extract(
     let claims = (*extractor).0.extract(response);
 
     // Convert claims to JSON
-    let json_claims: Vec<serde_json::Value> = claims
+    let json_claims: Vec<serde_json::Value> = claims.iter().map(claim_to_json).collect();
+
+    let json = ffi_try!(serde_json::to_string(&json_claims));
+    str_to_cstring(&json)
+}
+
+/// Extract claims from several responses at once.
+///
+/// Large batches are processed in parallel. Returns a JSON array with one
+/// array of claims per response, in input order.
+///
+/// # Safety
+/// - `extractor` must be a valid pointer.
+/// - `responses` must point to `count` valid null-terminated strings
+///   (it may be NULL when `count` is 0).
+/// - The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_claim_extractor_extract_batch(
+    extractor: *mut RlmClaimExtractor,
+    responses: *const *const c_char,
+    count: usize,
+) -> *mut c_char {
+    if extractor.is_null() {
+        set_last_error("null extractor pointer");
+        return std::ptr::null_mut();
+    }
+    if responses.is_null() && count > 0 {
+        set_last_error("null responses pointer");
+        return std::ptr::null_mut();
+    }
+    let mut texts = Vec::with_capacity(count);
+    for i in 0..count {
+        texts.push(ffi_try!(cstr_to_str(*responses.add(i))));
+    }
+
+    let json_batches: Vec<Vec<serde_json::Value>> = (*extractor)
+        .0
+        .extract_batch(&texts)
         .iter()
-        .map(|c| {
-            serde_json::json!({
-                "id": c.id.0.to_string(),
-                "text": c.text,
-                "category": format!("{:?}", c.category),
-                "specificity": c.specificity,
-                "span_start": c.source_span.map(|(s, _)| s),
-                "span_end": c.source_span.map(|(_, e)| e),
-            })
-        })
+        .map(|claims| claims.iter().map(claim_to_json).collect())
         .collect();
 
-    let json = ffi_try!(serde_json::to_string(&json_claims));
+    let json = ffi_try!(serde_json::to_string(&json_batches));
     str_to_cstring(&json)
 }
 
+fn claim_to_json(c: &epistemic::Claim) -> serde_json::Value {
+    serde_json::json!({
+        "id": c.id.0.to_string(),
+        "text": c.text,
+        "category": format!("{:?}", c.category),
+        "specificity": c.specificity,
+        "span_start": c.source_span.map(|(s, _)| s),
+        "span_end": c.source_span.map(|(_, e)| e),
+    })
+}
+
 /// Extract high-specificity claims above a threshold.
 ///
 /// Returns a JSON array of claims.
@@ -0,0 +1,27 @@
+//! FFI bindings for LLM provider admission control.
+//!
+//! Exposes live [`ProviderLimiter`](crate::llm::ProviderLimiter) state so
+//! hosts can chart concurrency, budgets and throttling per provider.
+
+use std::os::raw::c_char;
+
+use super::error::{ffi_try, str_to_cstring};
+use crate::llm::limiter_snapshots;
+
+// ============================================================================
+// Provider limiters
+// ============================================================================
+
+/// Get the state of every live provider limiter as a JSON array.
+///
+/// Each element is a `LimiterSnapshot`: provider, adaptive concurrency
+/// limit, in-flight and waiting counts, remaining request/token budgets,
+/// any Retry-After pause, latency statistics and throttle/coalesce counters.
+///
+/// # Safety
+/// The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub extern "C" fn rlm_llm_limiter_state_json() -> *mut c_char {
+    let json = ffi_try!(serde_json::to_string(&limiter_snapshots()));
+    str_to_cstring(&json)
+}
@@ -1,12 +1,18 @@
 //! FFI bindings for memory types.
 
+use std::io::Write;
 use std::os::raw::c_char;
 use std::path::PathBuf;
 
+use super::arena::arena_mut;
 use super::error::{cstr_to_str, ffi_try, set_last_error, str_to_cstring};
-use super::types::{RlmHyperEdge, RlmMemoryStore, RlmNode, RlmNodeType, RlmTier};
+use super::types::{
+    RlmArena, RlmHyperEdge, RlmHyperEdgeList, RlmMemoryMaintenance, RlmMemoryStats, RlmMemoryStore,
+    RlmNode, RlmNodeList, RlmNodeType, RlmStrView, RlmTier,
+};
 use crate::memory::{
-    EdgeType, HyperEdge, Node, NodeId, NodeQuery, NodeType, SqliteMemoryStore, Tier,
+    EdgeType, HyperEdge, MaintenanceOptions, MaintenanceScheduler, MemoryStoreOptions, Node,
+    NodeId, NodeQuery, NodeType, SqliteMemoryStore, Tier,
 };
 
 // ============================================================================
@@ -40,6 +46,35 @@ pub unsafe extern "C" fn rlm_memory_store_open(path: *const c_char) -> *mut RlmM
     Box::into_raw(Box::new(RlmMemoryStore(store)))
 }
 
+/// Open or create a memory store at a path with tuning options.
+///
+/// `options_json` is an object with any of `reader_pool_size`, `synchronous`,
+/// `busy_timeout_ms` and `statement_cache_capacity`; omitted fields (or a NULL
+/// `options_json`) use the defaults.
+///
+/// # Safety
+/// - `path` must be a valid null-terminated string.
+/// - `options_json` must be a valid null-terminated string or NULL.
+/// - The returned pointer must be freed with `rlm_memory_store_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_open_with_options(
+    path: *const c_char,
+    options_json: *const c_char,
+) -> *mut RlmMemoryStore {
+    let path = ffi_try!(cstr_to_str(path));
+    let options = if options_json.is_null() {
+        MemoryStoreOptions::default()
+    } else {
+        let json = ffi_try!(cstr_to_str(options_json));
+        ffi_try!(serde_json::from_str::<MemoryStoreOptions>(json))
+    };
+    let store = ffi_try!(SqliteMemoryStore::open_with_options(
+        PathBuf::from(path),
+        options
+    ));
+    Box::into_raw(Box::new(RlmMemoryStore(store)))
+}
+
 /// Free a memory store.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_memory_store_free(store: *mut RlmMemoryStore) {
@@ -64,6 +99,64 @@ pub unsafe extern "C" fn rlm_memory_store_add_node(
     0
 }
 
+/// Add many nodes to the store in a single transaction.
+///
+/// Returns the number of nodes inserted, or -1 on failure (in which case no
+/// nodes from the batch are persisted).
+///
+/// # Safety
+/// - `store` must be a valid pointer.
+/// - `nodes` must point to `n` valid, non-NULL node pointers (may be NULL if `n` is 0).
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_add_nodes(
+    store: *const RlmMemoryStore,
+    nodes: *const *const RlmNode,
+    n: usize,
+) -> i64 {
+    if store.is_null() || (nodes.is_null() && n > 0) {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let batch = ffi_try!(collect_handles(nodes, n, |node| node.0.clone()), -1);
+    ffi_try!((*store).0.add_nodes(&batch), -1) as i64
+}
+
+/// Update many nodes in a single transaction.
+///
+/// Returns the number of nodes written, or -1 on failure.
+///
+/// # Safety
+/// - `store` must be a valid pointer.
+/// - `nodes` must point to `n` valid, non-NULL node pointers (may be NULL if `n` is 0).
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_update_nodes(
+    store: *const RlmMemoryStore,
+    nodes: *const *const RlmNode,
+    n: usize,
+) -> i64 {
+    if store.is_null() || (nodes.is_null() && n > 0) {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let batch = ffi_try!(collect_handles(nodes, n, |node| node.0.clone()), -1);
+    ffi_try!((*store).0.update_nodes(&batch), -1) as i64
+}
+
+/// Copy the values behind an array of FFI handles, rejecting NULL entries.
+unsafe fn collect_handles<H, T>(
+    handles: *const *const H,
+    n: usize,
+    f: impl Fn(&H) -> T,
+) -> Result<Vec<T>, &'static str> {
+    if n == 0 {
+        return Ok(Vec::new());
+    }
+    std::slice::from_raw_parts(handles, n)
+        .iter()
+        .map(|&h| h.as_ref().map(&f).ok_or("null element in batch"))
+        .collect()
+}
+
 /// Get a node by ID.
 ///
 /// # Safety
@@ -194,6 +287,96 @@ pub unsafe extern "C" fn rlm_memory_store_search_content(
     str_to_cstring(&json)
 }
 
+/// Nearest-neighbour search over node embeddings.
+///
+/// Returns a JSON array of `{"id": "...", "score": f32}` objects ordered by
+/// descending cosine similarity. `tier_filter` is an `RlmTier` value, or a
+/// negative number to search every tier.
+///
+/// # Safety
+/// - `store` must be a valid pointer.
+/// - `query` must point to `dim` readable floats.
+/// - The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_search_embedding(
+    store: *const RlmMemoryStore,
+    query: *const f32,
+    dim: usize,
+    k: i64,
+    tier_filter: i32,
+) -> *mut c_char {
+    if store.is_null() {
+        set_last_error("null store pointer");
+        return std::ptr::null_mut();
+    }
+    let query = ffi_try!(float_slice(query, dim));
+    let tier = ffi_try!(tier_from_filter(tier_filter));
+    let hits = ffi_try!((*store).0.search_embedding(query, k.max(0) as usize, tier));
+    scored_ids_json(&hits)
+}
+
+/// Hybrid full-text and embedding search fused by reciprocal rank.
+///
+/// Returns the same shape as `rlm_memory_store_search_embedding()`, with
+/// fused rank scores instead of similarities.
+///
+/// # Safety
+/// - `store` must be a valid pointer.
+/// - `text` must be a valid null-terminated FTS query string.
+/// - `query` must point to `dim` readable floats.
+/// - The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_search_hybrid(
+    store: *const RlmMemoryStore,
+    text: *const c_char,
+    query: *const f32,
+    dim: usize,
+    k: i64,
+    tier_filter: i32,
+) -> *mut c_char {
+    if store.is_null() {
+        set_last_error("null store pointer");
+        return std::ptr::null_mut();
+    }
+    let text = ffi_try!(cstr_to_str(text));
+    let query = ffi_try!(float_slice(query, dim));
+    let tier = ffi_try!(tier_from_filter(tier_filter));
+    let hits = ffi_try!((*store)
+        .0
+        .search_hybrid(text, query, k.max(0) as usize, tier));
+    scored_ids_json(&hits)
+}
+
+unsafe fn float_slice<'a>(ptr: *const f32, len: usize) -> Result<&'a [f32], &'static str> {
+    if len == 0 {
+        return Ok(&[]);
+    }
+    if ptr.is_null() {
+        return Err("null query vector");
+    }
+    Ok(std::slice::from_raw_parts(ptr, len))
+}
+
+fn tier_from_filter(filter: i32) -> Result<Option<Tier>, String> {
+    match filter {
+        f if f < 0 => Ok(None),
+        0 => Ok(Some(Tier::Task)),
+        1 => Ok(Some(Tier::Session)),
+        2 => Ok(Some(Tier::LongTerm)),
+        3 => Ok(Some(Tier::Archive)),
+        other => Err(format!("invalid tier filter: {}", other)),
+    }
+}
+
+fn scored_ids_json(hits: &[(Node, f32)]) -> *mut c_char {
+    let data: Vec<serde_json::Value> = hits
+        .iter()
+        .map(|(n, score)| serde_json::json!({ "id": n.id.to_string(), "score": score }))
+        .collect();
+    let json = ffi_try!(serde_json::to_string(&data));
+    str_to_cstring(&json)
+}
+
 /// Promote nodes to the next tier. Returns a JSON array of promoted node IDs.
 ///
 /// # Safety
@@ -241,6 +424,78 @@ pub unsafe extern "C" fn rlm_memory_store_decay(
     str_to_cstring(&json)
 }
 
+/// Start background decay/consolidation of a store in bounded batches.
+///
+/// `options_json` is an object with any of `decay_factor`, `min_confidence`,
+/// `consolidate_tiers`, `batch_size`, `batch_pause_ms` and
+/// `sweep_interval_ms`; omitted fields (or a NULL `options_json`) use the
+/// defaults. The scheduler shares the store's connections, so the store may
+/// be freed independently.
+///
+/// # Safety
+/// - `store` must be a valid pointer.
+/// - `options_json` must be a valid null-terminated string or NULL.
+/// - The returned pointer must be freed with `rlm_memory_maintenance_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_maintenance_start(
+    store: *const RlmMemoryStore,
+    options_json: *const c_char,
+) -> *mut RlmMemoryMaintenance {
+    if store.is_null() {
+        set_last_error("null store pointer");
+        return std::ptr::null_mut();
+    }
+    let options = if options_json.is_null() {
+        MaintenanceOptions::default()
+    } else {
+        let json = ffi_try!(cstr_to_str(options_json));
+        ffi_try!(serde_json::from_str::<MaintenanceOptions>(json))
+    };
+    let scheduler = ffi_try!(MaintenanceScheduler::start((*store).0.clone(), options));
+    Box::into_raw(Box::new(RlmMemoryMaintenance(scheduler)))
+}
+
+/// Start the next maintenance sweep now.
+///
+/// # Safety
+/// `maintenance` must be a valid pointer or NULL.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_maintenance_trigger(maintenance: *const RlmMemoryMaintenance) {
+    if !maintenance.is_null() {
+        (*maintenance).0.trigger();
+    }
+}
+
+/// Get maintenance counters as JSON.
+///
+/// # Safety
+/// - `maintenance` must be a valid pointer.
+/// - The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_maintenance_stats(
+    maintenance: *const RlmMemoryMaintenance,
+) -> *mut c_char {
+    if maintenance.is_null() {
+        set_last_error("null maintenance pointer");
+        return std::ptr::null_mut();
+    }
+    let json = ffi_try!(serde_json::to_string(&(*maintenance).0.stats()));
+    str_to_cstring(&json)
+}
+
+/// Stop background maintenance and free the handle.
+///
+/// Blocks until the batch in progress, if any, has committed.
+///
+/// # Safety
+/// `maintenance` must be a pointer returned by `rlm_memory_maintenance_start()` or NULL.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_maintenance_free(maintenance: *mut RlmMemoryMaintenance) {
+    if !maintenance.is_null() {
+        drop(Box::from_raw(maintenance));
+    }
+}
+
 /// Get store statistics as JSON.
 ///
 /// # Safety
@@ -294,6 +549,48 @@ pub unsafe extern "C" fn rlm_node_new_full(
     Box::into_raw(Box::new(RlmNode(node)))
 }
 
+/// Create a node in an arena.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - `content` must be a valid null-terminated string.
+/// - The node is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_node_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_new_in(
+    arena: *mut RlmArena,
+    node_type: RlmNodeType,
+    content: *const c_char,
+) -> *mut RlmNode {
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null_mut();
+    };
+    let content = ffi_try!(cstr_to_str(content));
+    arena.node(RlmNode(Node::new(NodeType::from(node_type), content)))
+}
+
+/// Create a node with tier and confidence in an arena.
+///
+/// # Safety
+/// Same as `rlm_node_new_in()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_new_full_in(
+    arena: *mut RlmArena,
+    node_type: RlmNodeType,
+    content: *const c_char,
+    tier: RlmTier,
+    confidence: f64,
+) -> *mut RlmNode {
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null_mut();
+    };
+    let content = ffi_try!(cstr_to_str(content));
+    let node = Node::new(NodeType::from(node_type), content)
+        .with_tier(Tier::from(tier))
+        .with_confidence(confidence);
+    arena.node(RlmNode(node))
+}
+
 /// Free a node.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_node_free(node: *mut RlmNode) {
@@ -315,6 +612,27 @@ pub unsafe extern "C" fn rlm_node_id(node: *const RlmNode) -> *mut c_char {
     str_to_cstring(&(*node).0.id.to_string())
 }
 
+/// Get the node ID as an arena string.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - The string is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_id_in(
+    arena: *mut RlmArena,
+    node: *const RlmNode,
+) -> *const c_char {
+    if node.is_null() {
+        set_last_error("null node pointer");
+        return std::ptr::null();
+    }
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null();
+    };
+    arena.str_with(|buf| write!(buf, "{}", (*node).0.id))
+}
+
 /// Get the node type.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_node_type(node: *const RlmNode) -> RlmNodeType {
@@ -337,6 +655,20 @@ pub unsafe extern "C" fn rlm_node_content(node: *const RlmNode) -> *mut c_char {
     str_to_cstring(&(*node).0.content)
 }
 
+/// Borrow the node content without copying.
+///
+/// # Safety
+/// The view is not NUL-terminated and is valid only until `node` is mutated
+/// or freed. Do not pass it to `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_content_view(node: *const RlmNode) -> RlmStrView {
+    if node.is_null() {
+        set_last_error("null node pointer");
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow(&(*node).0.content)
+}
+
 /// Get the node tier.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_node_tier(node: *const RlmNode) -> RlmTier {
@@ -371,6 +703,21 @@ pub unsafe extern "C" fn rlm_node_subtype(node: *const RlmNode) -> *mut c_char {
     }
 }
 
+/// Borrow the node subtype without copying.
+///
+/// Returns `{ NULL, 0 }` if no subtype is set.
+///
+/// # Safety
+/// The view is valid only until `node` is mutated (e.g. `rlm_node_set_subtype()`)
+/// or freed.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_subtype_view(node: *const RlmNode) -> RlmStrView {
+    if node.is_null() {
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow_opt((*node).0.subtype.as_deref())
+}
+
 /// Set the node subtype.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_node_set_subtype(node: *mut RlmNode, subtype: *const c_char) -> i32 {
@@ -465,6 +812,27 @@ pub unsafe extern "C" fn rlm_node_to_json(node: *const RlmNode) -> *mut c_char {
     str_to_cstring(&json)
 }
 
+/// Serialize node to JSON as an arena string.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - The string is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_to_json_in(
+    arena: *mut RlmArena,
+    node: *const RlmNode,
+) -> *const c_char {
+    if node.is_null() {
+        set_last_error("null node pointer");
+        return std::ptr::null();
+    }
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null();
+    };
+    arena.str_with(|buf| serde_json::to_writer(buf, &(*node).0))
+}
+
 /// Deserialize node from JSON.
 ///
 /// # Safety
@@ -587,6 +955,20 @@ pub unsafe extern "C" fn rlm_hyperedge_label(edge: *const RlmHyperEdge) -> *mut
     }
 }
 
+/// Borrow the edge label without copying.
+///
+/// Returns `{ NULL, 0 }` if no label is set.
+///
+/// # Safety
+/// The view is not NUL-terminated and is valid only until `edge` is freed.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_hyperedge_label_view(edge: *const RlmHyperEdge) -> RlmStrView {
+    if edge.is_null() {
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow_opt((*edge).0.label.as_deref())
+}
+
 /// Get the edge weight.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_hyperedge_weight(edge: *const RlmHyperEdge) -> f64 {
@@ -656,6 +1038,28 @@ pub unsafe extern "C" fn rlm_memory_store_add_edge(
     0
 }
 
+/// Add many edges to a memory store in a single transaction.
+///
+/// Returns the number of edges inserted, or -1 on failure (in which case no
+/// edges from the batch are persisted).
+///
+/// # Safety
+/// - `store` must be a valid pointer.
+/// - `edges` must point to `n` valid, non-NULL edge pointers (may be NULL if `n` is 0).
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_add_edges(
+    store: *const RlmMemoryStore,
+    edges: *const *const RlmHyperEdge,
+    n: usize,
+) -> i64 {
+    if store.is_null() || (edges.is_null() && n > 0) {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let batch = ffi_try!(collect_handles(edges, n, |edge| edge.0.clone()), -1);
+    ffi_try!((*store).0.add_edges(&batch), -1) as i64
+}
+
 /// Get edges connected to a node. Returns a JSON array of edge data.
 ///
 /// # Safety
@@ -672,24 +1076,336 @@ pub unsafe extern "C" fn rlm_memory_store_get_edges_for_node(
     let id_str = ffi_try!(cstr_to_str(node_id));
     let id = ffi_try!(NodeId::parse(id_str));
     let edges = ffi_try!((*store).0.get_edges_for_node(&id));
-    let edge_data: Vec<serde_json::Value> = edges
-        .iter()
-        .map(|e| {
-            serde_json::json!({
-                "id": e.id.to_string(),
-                "edge_type": e.edge_type.to_string(),
-                "label": e.label,
-                "weight": e.weight,
-                "members": e.members.iter().map(|m| {
-                    serde_json::json!({
-                        "node_id": m.node_id.to_string(),
-                        "role": m.role,
-                        "position": m.position
-                    })
-                }).collect::<Vec<_>>()
-            })
-        })
-        .collect();
+    let edge_data: Vec<serde_json::Value> = edges.iter().map(edge_to_json).collect();
     let json = ffi_try!(serde_json::to_string(&edge_data));
     str_to_cstring(&json)
 }
+
+/// Expand the k-hop neighbourhood of a node in one call.
+///
+/// Returns a JSON object `{"nodes": [...], "edges": [...]}` where `nodes` are
+/// full node objects ordered by hop distance (origin first) and `edges` use the
+/// same shape as `rlm_memory_store_get_edges_for_node()`. At most `limit` nodes
+/// are returned; only edges whose members are all in `nodes` are included.
+///
+/// # Safety
+/// - `store` must be a valid pointer.
+/// - `node_id` must be a valid null-terminated UUID string.
+/// - The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_neighborhood(
+    store: *const RlmMemoryStore,
+    node_id: *const c_char,
+    depth: u32,
+    limit: i64,
+) -> *mut c_char {
+    if store.is_null() {
+        set_last_error("null store pointer");
+        return std::ptr::null_mut();
+    }
+    let id_str = ffi_try!(cstr_to_str(node_id));
+    let id = ffi_try!(NodeId::parse(id_str));
+    let limit = if limit < 0 {
+        usize::MAX
+    } else {
+        limit as usize
+    };
+    let subgraph = ffi_try!((*store).0.neighborhood(&id, depth, limit));
+    let json = serde_json::json!({
+        "nodes": subgraph.nodes,
+        "edges": subgraph.edges.iter().map(edge_to_json).collect::<Vec<_>>(),
+    });
+    let json = ffi_try!(serde_json::to_string(&json));
+    str_to_cstring(&json)
+}
+
+fn edge_to_json(e: &HyperEdge) -> serde_json::Value {
+    serde_json::json!({
+        "id": e.id.to_string(),
+        "edge_type": e.edge_type.to_string(),
+        "label": e.label,
+        "weight": e.weight,
+        "members": e.members.iter().map(|m| {
+            serde_json::json!({
+                "node_id": m.node_id.to_string(),
+                "role": m.role,
+                "position": m.position
+            })
+        }).collect::<Vec<_>>()
+    })
+}
+
+// ============================================================================
+// Result Lists
+// ============================================================================
+//
+// Handle-based alternatives to the JSON query functions above. Results stay as
+// native objects and are read through the ordinary node/edge accessors, so no
+// serialization happens on either side of the boundary.
+
+fn node_list(nodes: Vec<Node>) -> *mut RlmNodeList {
+    Box::into_raw(Box::new(RlmNodeList(
+        nodes.into_iter().map(RlmNode).collect(),
+    )))
+}
+
+/// Query nodes by type, returning a node list.
+///
+/// # Safety
+/// The returned list must be freed with `rlm_node_list_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_query_by_type_list(
+    store: *const RlmMemoryStore,
+    node_type: RlmNodeType,
+    limit: i64,
+) -> *mut RlmNodeList {
+    if store.is_null() {
+        set_last_error("null store pointer");
+        return std::ptr::null_mut();
+    }
+    let query = NodeQuery::new()
+        .node_types(vec![NodeType::from(node_type)])
+        .limit(limit as usize);
+    node_list(ffi_try!((*store).0.query_nodes(&query)))
+}
+
+/// Query nodes by tier, returning a node list.
+///
+/// # Safety
+/// The returned list must be freed with `rlm_node_list_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_query_by_tier_list(
+    store: *const RlmMemoryStore,
+    tier: RlmTier,
+    limit: i64,
+) -> *mut RlmNodeList {
+    if store.is_null() {
+        set_last_error("null store pointer");
+        return std::ptr::null_mut();
+    }
+    let query = NodeQuery::new()
+        .tiers(vec![Tier::from(tier)])
+        .limit(limit as usize);
+    node_list(ffi_try!((*store).0.query_nodes(&query)))
+}
+
+/// Full-text search on content, returning a node list.
+///
+/// # Safety
+/// - `query` must be a valid null-terminated string.
+/// - The returned list must be freed with `rlm_node_list_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_search_content_list(
+    store: *const RlmMemoryStore,
+    query: *const c_char,
+    limit: i64,
+) -> *mut RlmNodeList {
+    if store.is_null() {
+        set_last_error("null store pointer");
+        return std::ptr::null_mut();
+    }
+    let query_str = ffi_try!(cstr_to_str(query));
+    node_list(ffi_try!((*store)
+        .0
+        .search_content(query_str, limit as usize)))
+}
+
+/// Get all edges containing a node, returning an edge list.
+///
+/// # Safety
+/// - `node_id` must be a valid null-terminated UUID string.
+/// - The returned list must be freed with `rlm_hyperedge_list_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_get_edges_for_node_list(
+    store: *const RlmMemoryStore,
+    node_id: *const c_char,
+) -> *mut RlmHyperEdgeList {
+    if store.is_null() {
+        set_last_error("null store pointer");
+        return std::ptr::null_mut();
+    }
+    let id_str = ffi_try!(cstr_to_str(node_id));
+    let id = ffi_try!(NodeId::parse(id_str));
+    let edges = ffi_try!((*store).0.get_edges_for_node(&id));
+    Box::into_raw(Box::new(RlmHyperEdgeList(
+        edges.into_iter().map(RlmHyperEdge).collect(),
+    )))
+}
+
+/// Fill `out` with store statistics. Returns 0 on success, -1 on error.
+///
+/// # Safety
+/// `out` must point to writable memory for one `RlmMemoryStats`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_memory_store_stats_into(
+    store: *const RlmMemoryStore,
+    out: *mut RlmMemoryStats,
+) -> i32 {
+    if store.is_null() || out.is_null() {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let stats = ffi_try!((*store).0.stats(), -1);
+    let mut result = RlmMemoryStats {
+        total_nodes: stats.total_nodes,
+        total_edges: stats.total_edges,
+        ..Default::default()
+    };
+    for (tier, count) in &stats.nodes_by_tier {
+        result.nodes_by_tier[RlmTier::from(*tier) as usize] = (*count).max(0) as u64;
+    }
+    for (node_type, count) in &stats.nodes_by_type {
+        result.nodes_by_type[RlmNodeType::from(*node_type) as usize] = (*count).max(0) as u64;
+    }
+    *out = result;
+    0
+}
+
+/// Number of nodes in a list.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_list_len(list: *const RlmNodeList) -> usize {
+    if list.is_null() {
+        return 0;
+    }
+    (*list).0.len()
+}
+
+/// Borrow the node at `index`, or NULL if out of range.
+///
+/// # Safety
+/// The returned pointer is owned by the list and valid until the list is
+/// freed. It must not be passed to `rlm_node_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_list_get(
+    list: *const RlmNodeList,
+    index: usize,
+) -> *const RlmNode {
+    if list.is_null() {
+        set_last_error("null list pointer");
+        return std::ptr::null();
+    }
+    match (*list).0.get(index) {
+        Some(node) => node,
+        None => {
+            set_last_error("index out of range");
+            std::ptr::null()
+        }
+    }
+}
+
+/// Free a node list and every node it owns.
+///
+/// # Safety
+/// The list must have been returned by a `*_list` function.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_list_free(list: *mut RlmNodeList) {
+    if !list.is_null() {
+        drop(Box::from_raw(list));
+    }
+}
+
+/// Number of edges in a list.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_hyperedge_list_len(list: *const RlmHyperEdgeList) -> usize {
+    if list.is_null() {
+        return 0;
+    }
+    (*list).0.len()
+}
+
+/// Borrow the edge at `index`, or NULL if out of range.
+///
+/// # Safety
+/// The returned pointer is owned by the list and valid until the list is
+/// freed. It must not be passed to `rlm_hyperedge_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_hyperedge_list_get(
+    list: *const RlmHyperEdgeList,
+    index: usize,
+) -> *const RlmHyperEdge {
+    if list.is_null() {
+        set_last_error("null list pointer");
+        return std::ptr::null();
+    }
+    match (*list).0.get(index) {
+        Some(edge) => edge,
+        None => {
+            set_last_error("index out of range");
+            std::ptr::null()
+        }
+    }
+}
+
+/// Free an edge list and every edge it owns.
+///
+/// # Safety
+/// The list must have been returned by a `*_list` function.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_hyperedge_list_free(list: *mut RlmHyperEdgeList) {
+    if !list.is_null() {
+        drop(Box::from_raw(list));
+    }
+}
+
+/// Copy the node's 16-byte UUID into `out` without allocating.
+///
+/// Returns 0 on success, -1 if either pointer is null.
+///
+/// # Safety
+/// `out` must point to 16 writable bytes.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_node_id_bytes(node: *const RlmNode, out: *mut u8) -> i32 {
+    if node.is_null() || out.is_null() {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let bytes = (*node).0.id.0.as_bytes();
+    std::ptr::copy_nonoverlapping(bytes.as_ptr(), out, bytes.len());
+    0
+}
+
+/// Number of members in an edge.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_hyperedge_member_count(edge: *const RlmHyperEdge) -> usize {
+    if edge.is_null() {
+        return 0;
+    }
+    (*edge).0.members.len()
+}
+
+/// Copy the 16-byte UUID of member `index` into `out` without allocating.
+///
+/// Returns 0 on success, -1 on a null pointer or out-of-range index.
+///
+/// # Safety
+/// `out` must point to 16 writable bytes.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_hyperedge_member_id_bytes(
+    edge: *const RlmHyperEdge,
+    index: usize,
+    out: *mut u8,
+) -> i32 {
+    if edge.is_null() || out.is_null() {
+        set_last_error("null pointer");
+        return -1;
+    }
+    let Some(member) = (*edge).0.members.get(index) else {
+        set_last_error("index out of range");
+        return -1;
+    };
+    let bytes = member.node_id.0.as_bytes();
+    std::ptr::copy_nonoverlapping(bytes.as_ptr(), out, bytes.len());
+    0
+}
+
+/// Borrow the role of member `index`, or a null view if out of range.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_hyperedge_member_role_view(
+    edge: *const RlmHyperEdge,
+    index: usize,
+) -> RlmStrView {
+    if edge.is_null() {
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow_opt((*edge).0.members.get(index).map(|m| m.role.as_str()))
+}
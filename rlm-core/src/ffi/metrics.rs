@@ -0,0 +1,67 @@
+//! FFI bindings for hot-path metrics.
+//!
+//! Exposes the process-wide latency histograms in [`crate::metrics`] as a
+//! fixed-layout snapshot and as Prometheus text, and switches the optional
+//! `tracing` spans on or off at runtime.
+
+use std::os::raw::c_char;
+
+use super::error::{set_last_error, str_to_cstring};
+use super::types::{RlmMetric, RlmMetricsSnapshot};
+use crate::metrics::{self, Metric};
+
+/// Fill `out` with every metric, indexed by `RlmMetric`, without serializing.
+///
+/// # Safety
+/// - `out` must be a valid pointer.
+///
+/// Returns 0 on success, -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_metrics_snapshot(out: *mut RlmMetricsSnapshot) -> i32 {
+    if out.is_null() {
+        set_last_error("null pointer");
+        return -1;
+    }
+    *out = RlmMetricsSnapshot {
+        samples: metrics::snapshot_all().map(Into::into),
+    };
+    0
+}
+
+/// Render every metric in the Prometheus text exposition format.
+///
+/// # Safety
+/// The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub extern "C" fn rlm_metrics_prometheus() -> *mut c_char {
+    str_to_cstring(&metrics::prometheus_text())
+}
+
+/// Clear every metric.
+#[no_mangle]
+pub extern "C" fn rlm_metrics_reset() {
+    metrics::reset();
+}
+
+/// Stable snake_case name of a metric, as used in the Prometheus output.
+///
+/// The returned string is static and must not be freed.
+#[no_mangle]
+pub extern "C" fn rlm_metric_name(metric: RlmMetric) -> *const c_char {
+    Metric::from(metric).c_name().as_ptr()
+}
+
+/// Turn `tracing` spans around instrumented operations on (non-zero) or off
+/// (0), overriding the `RLM_TRACE_SPANS` environment variable.
+#[no_mangle]
+pub extern "C" fn rlm_metrics_set_tracing(enabled: i32) {
+    metrics::set_tracing_enabled(enabled != 0);
+}
+
+/// Whether `tracing` spans are enabled.
+///
+/// Returns 1 if enabled, 0 if not.
+#[no_mangle]
+pub extern "C" fn rlm_metrics_tracing_enabled() -> i32 {
+    i32::from(metrics::tracing_enabled())
+}
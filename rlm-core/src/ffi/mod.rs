@@ -9,6 +9,8 @@
 //! - Objects created by `*_new()` functions must be freed with corresponding `*_free()` functions
 //! - Strings returned by the library must be freed with `rlm_string_free()`
 //! - Caller-owned strings passed to functions are not freed by the library
+//! - Objects and strings from `*_in()` functions live in an `RlmArena` and are
+//!   released together by `rlm_arena_reset()`; never pass them to `*_free()`
 //!
 //! ## Error Handling
 //!
@@ -20,24 +22,31 @@
 //! ## Thread Safety
 //!
 //! - The library is thread-safe; objects can be used from multiple threads
+//! - An `RlmArena` is the exception: use one arena per request or thread
 //! - Each thread has its own last error state
 
+mod arena;
 mod context;
 mod cost;
 mod epistemic;
 mod error;
+mod llm;
 mod memory;
+mod metrics;
 mod orchestrator;
 mod reasoning;
 mod repl;
 mod trajectory;
 mod types;
 
+pub use arena::*;
 pub use context::*;
 pub use cost::*;
 pub use epistemic::*;
 pub use error::*;
+pub use llm::*;
 pub use memory::*;
+pub use metrics::*;
 pub use orchestrator::*;
 pub use reasoning::*;
 pub use repl::*;
@@ -247,6 +256,28 @@ mod tests {
         unsafe { rlm_string_free(std::ptr::null_mut()) };
     }
 
+    #[test]
+    fn test_llm_limiter_state_json() {
+        let limiter = crate::llm::ProviderLimiter::new(
+            crate::llm::Provider::OpenAI,
+            crate::llm::LimiterConfig::default(),
+        );
+        let json = rlm_llm_limiter_state_json();
+        assert!(!json.is_null());
+        let state: serde_json::Value =
+            serde_json::from_str(unsafe { CStr::from_ptr(json).to_str().unwrap() }).unwrap();
+        unsafe { rlm_string_free(json) };
+
+        let entry = state
+            .as_array()
+            .unwrap()
+            .iter()
+            .find(|s| s["id"] == limiter.snapshot().id)
+            .expect("live limiter should be reported");
+        assert_eq!(entry["provider"], "openai");
+        assert_eq!(entry["in_flight"], 0);
+    }
+
     #[test]
     fn test_session_context_lifecycle() {
         let ctx = rlm_session_context_new();
@@ -300,6 +331,98 @@ mod tests {
         unsafe { rlm_message_free(msg) };
     }
 
+    #[test]
+    fn test_borrowed_string_views() {
+        let content = std::ffi::CString::new("Borrowed content").unwrap();
+        let msg = unsafe { rlm_message_user(content.as_ptr()) };
+        let view = unsafe { rlm_message_content_view(msg) };
+        assert_eq!(view.len, "Borrowed content".len());
+        assert_eq!(unsafe { view.as_str() }, Some("Borrowed content"));
+        unsafe { rlm_message_free(msg) };
+
+        let ctx = rlm_session_context_new();
+        let path = std::ffi::CString::new("/src/lib.rs").unwrap();
+        let body = std::ffi::CString::new("pub fn lib() {}").unwrap();
+        unsafe { rlm_session_context_cache_file(ctx, path.as_ptr(), body.as_ptr()) };
+        let view = unsafe { rlm_session_context_get_file_view(ctx, path.as_ptr()) };
+        assert_eq!(unsafe { view.as_str() }, Some("pub fn lib() {}"));
+
+        let missing = std::ffi::CString::new("/nope.rs").unwrap();
+        let view = unsafe { rlm_session_context_get_file_view(ctx, missing.as_ptr()) };
+        assert!(view.ptr.is_null());
+        assert_eq!(view.len, 0);
+        unsafe { rlm_session_context_free(ctx) };
+
+        let node_content = std::ffi::CString::new("Fact body").unwrap();
+        let node = unsafe { rlm_node_new(RlmNodeType::Fact, node_content.as_ptr()) };
+        assert_eq!(
+            unsafe { rlm_node_content_view(node).as_str() },
+            Some("Fact body")
+        );
+        assert!(unsafe { rlm_node_subtype_view(node) }.ptr.is_null());
+        unsafe { rlm_node_free(node) };
+
+        let view = unsafe { rlm_node_content_view(std::ptr::null()) };
+        assert!(view.ptr.is_null());
+        assert_eq!(rlm_has_error(), 1);
+    }
+
+    #[test]
+    fn test_session_snapshot_checkpoint_and_resume() {
+        let dir = tempfile::TempDir::new().unwrap();
+        let file = dir.path().join("session.rlmsnap");
+        let file = std::ffi::CString::new(file.to_str().unwrap()).unwrap();
+
+        let ctx = rlm_session_context_new();
+        let user = std::ffi::CString::new("Hello").unwrap();
+        let path = std::ffi::CString::new("/src/lib.rs").unwrap();
+        let body = std::ffi::CString::new("pub fn lib() {}").unwrap();
+        unsafe {
+            rlm_session_context_add_user_message(ctx, user.as_ptr());
+            rlm_session_context_cache_file(ctx, path.as_ptr(), body.as_ptr());
+        }
+
+        let writer = unsafe { rlm_session_snapshot_writer_create(file.as_ptr()) };
+        assert!(!writer.is_null());
+        let mut stats = RlmSnapshotCheckpointStats::default();
+        assert_eq!(
+            unsafe { rlm_session_snapshot_writer_checkpoint(writer, ctx, &mut stats) },
+            0
+        );
+        assert_eq!((stats.full, stats.blobs_written), (1, 1));
+        unsafe { rlm_session_snapshot_writer_free(writer) };
+
+        let writer = unsafe { rlm_session_snapshot_writer_append(file.as_ptr()) };
+        unsafe { rlm_session_context_add_assistant_message(ctx, user.as_ptr()) };
+        assert_eq!(
+            unsafe { rlm_session_snapshot_writer_checkpoint(writer, ctx, &mut stats) },
+            0
+        );
+        assert_eq!(
+            (stats.full, stats.blobs_reused, stats.messages_written),
+            (0, 1, 1)
+        );
+        unsafe { rlm_session_snapshot_writer_free(writer) };
+
+        let snapshot = unsafe { rlm_session_snapshot_open(file.as_ptr()) };
+        assert!(!snapshot.is_null());
+        assert_eq!(unsafe { rlm_session_snapshot_message_count(snapshot) }, 2);
+        assert_eq!(unsafe { rlm_session_snapshot_file_count(snapshot) }, 1);
+        let view = unsafe { rlm_session_snapshot_get_file_view(snapshot, path.as_ptr()) };
+        assert_eq!(unsafe { view.as_str() }, Some("pub fn lib() {}"));
+
+        let restored = unsafe { rlm_session_snapshot_to_context(snapshot) };
+        assert_eq!(
+            unsafe { rlm_session_context_total_tokens(restored) },
+            unsafe { rlm_session_context_total_tokens(ctx) }
+        );
+        unsafe {
+            rlm_session_context_free(restored);
+            rlm_session_snapshot_free(snapshot);
+            rlm_session_context_free(ctx);
+        }
+    }
+
     #[test]
     fn test_memory_store_lifecycle() {
         let store = rlm_memory_store_in_memory();
@@ -312,6 +435,64 @@ mod tests {
         unsafe { rlm_memory_store_free(store) };
     }
 
+    #[test]
+    fn test_memory_store_batch_insert() {
+        let store = rlm_memory_store_in_memory();
+        let contents: Vec<std::ffi::CString> = (0..4)
+            .map(|i| std::ffi::CString::new(format!("batch node {}", i)).unwrap())
+            .collect();
+        let nodes: Vec<*mut RlmNode> = contents
+            .iter()
+            .map(|c| unsafe { rlm_node_new(RlmNodeType::Fact, c.as_ptr()) })
+            .collect();
+        let ptrs: Vec<*const RlmNode> = nodes.iter().map(|&n| n as *const RlmNode).collect();
+
+        let inserted = unsafe { rlm_memory_store_add_nodes(store, ptrs.as_ptr(), ptrs.len()) };
+        assert_eq!(inserted, 4);
+
+        // Re-inserting the same ids fails atomically.
+        let inserted = unsafe { rlm_memory_store_add_nodes(store, ptrs.as_ptr(), ptrs.len()) };
+        assert_eq!(inserted, -1);
+
+        let empty = unsafe { rlm_memory_store_add_nodes(store, std::ptr::null(), 0) };
+        assert_eq!(empty, 0);
+
+        for node in nodes {
+            unsafe { rlm_node_free(node) };
+        }
+        unsafe { rlm_memory_store_free(store) };
+    }
+
+    #[test]
+    fn test_memory_store_result_lists() {
+        let store = rlm_memory_store_in_memory();
+        let content = std::ffi::CString::new("listed fact").unwrap();
+        let node = unsafe { rlm_node_new(RlmNodeType::Fact, content.as_ptr()) };
+        assert_eq!(unsafe { rlm_memory_store_add_node(store, node) }, 0);
+
+        let list = unsafe { rlm_memory_store_query_by_type_list(store, RlmNodeType::Fact, 10) };
+        assert_eq!(unsafe { rlm_node_list_len(list) }, 1);
+        let first = unsafe { rlm_node_list_get(list, 0) };
+        let view = unsafe { rlm_node_content_view(first) };
+        assert_eq!(unsafe { view.as_str() }, Some("listed fact"));
+        assert!(unsafe { rlm_node_list_get(list, 1) }.is_null());
+
+        let mut expected = [0u8; 16];
+        let mut actual = [0u8; 16];
+        assert_eq!(unsafe { rlm_node_id_bytes(node, expected.as_mut_ptr()) }, 0);
+        assert_eq!(unsafe { rlm_node_id_bytes(first, actual.as_mut_ptr()) }, 0);
+        assert_eq!(expected, actual);
+        unsafe { rlm_node_list_free(list) };
+
+        let mut stats = RlmMemoryStats::default();
+        assert_eq!(unsafe { rlm_memory_store_stats_into(store, &mut stats) }, 0);
+        assert_eq!(stats.total_nodes, 1);
+        assert_eq!(stats.nodes_by_type[RlmNodeType::Fact as usize], 1);
+
+        unsafe { rlm_node_free(node) };
+        unsafe { rlm_memory_store_free(store) };
+    }
+
     #[test]
     fn test_node_lifecycle() {
         let content = std::ffi::CString::new("Test fact").unwrap();
@@ -345,6 +526,92 @@ mod tests {
         unsafe { rlm_trajectory_event_free(event) };
     }
 
+    #[test]
+    fn test_trajectory_subscribe_and_sink() {
+        use std::sync::atomic::{AtomicUsize, Ordering};
+
+        unsafe extern "C" fn on_event(
+            event: *const RlmTrajectoryEvent,
+            user_data: *mut std::ffi::c_void,
+        ) {
+            if (*event).0.content == "ffi-bus-event" {
+                (*(user_data as *const AtomicUsize)).fetch_add(1, Ordering::SeqCst);
+            }
+        }
+
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("trajectory.bin");
+        let cpath = std::ffi::CString::new(path.to_str().unwrap()).unwrap();
+        let mask = 1u32 << RlmTrajectoryEventType::CriticInvoked as u32;
+        let count = AtomicUsize::new(0);
+
+        unsafe {
+            let id = rlm_trajectory_subscribe(
+                Some(on_event),
+                mask,
+                &count as *const AtomicUsize as *mut std::ffi::c_void,
+            );
+            assert!(id > 0);
+            let sink =
+                rlm_trajectory_sink_open(cpath.as_ptr(), RlmTrajectorySinkFormat::Binary, mask);
+            assert!(!sink.is_null());
+
+            let content = std::ffi::CString::new("ffi-bus-event").unwrap();
+            let event = rlm_trajectory_event_new(
+                RlmTrajectoryEventType::CriticInvoked,
+                1,
+                content.as_ptr(),
+            );
+            assert!(rlm_trajectory_publish(event) >= 2);
+            rlm_trajectory_event_free(event);
+
+            assert_eq!(rlm_trajectory_unsubscribe(id), 0);
+            assert_eq!(rlm_trajectory_unsubscribe(id), -1);
+            assert_eq!(rlm_trajectory_sink_close(sink), 0);
+        }
+        assert_eq!(count.load(Ordering::SeqCst), 1);
+
+        let file = std::fs::File::open(&path).unwrap();
+        let events: Vec<_> = crate::trajectory::BinaryEventReader::new(file)
+            .unwrap()
+            .collect::<std::io::Result<_>>()
+            .unwrap();
+        assert!(events.iter().any(|e| e.content == "ffi-bus-event"));
+    }
+
+    #[test]
+    fn test_trajectory_subscribe_receives_emitter_events() {
+        use crate::trajectory::{BroadcastEmitter, TrajectoryEmitter, TrajectoryEvent};
+        use std::sync::atomic::{AtomicUsize, Ordering};
+
+        unsafe extern "C" fn on_event(
+            event: *const RlmTrajectoryEvent,
+            user_data: *mut std::ffi::c_void,
+        ) {
+            if (*event).0.content == "ffi-emitter-event" {
+                (*(user_data as *const AtomicUsize)).fetch_add(1, Ordering::SeqCst);
+            }
+        }
+
+        let mask = 1u32 << RlmTrajectoryEventType::Final as u32;
+        let count = AtomicUsize::new(0);
+        let id = unsafe {
+            rlm_trajectory_subscribe(
+                Some(on_event),
+                mask,
+                &count as *const AtomicUsize as *mut std::ffi::c_void,
+            )
+        };
+        assert!(id > 0);
+
+        // The library's own emitter, with no local subscribers at all.
+        let emitter = BroadcastEmitter::new(16);
+        emitter.emit(TrajectoryEvent::final_answer(0, "ffi-emitter-event"));
+
+        assert_eq!(rlm_trajectory_unsubscribe(id), 0);
+        assert_eq!(count.load(Ordering::SeqCst), 1);
+    }
+
     #[test]
     fn test_pattern_classifier() {
         let classifier = rlm_pattern_classifier_new();
@@ -365,6 +632,51 @@ mod tests {
         unsafe { rlm_pattern_classifier_free(classifier) };
     }
 
+    #[test]
+    fn test_pattern_classifier_incremental() {
+        let classifier = rlm_pattern_classifier_new();
+        let session = rlm_classifier_session_new();
+        let ctx = rlm_session_context_new();
+        let first = std::ffi::CString::new("Review the auth system for security issues").unwrap();
+        let follow_up = std::ffi::CString::new("Fix it").unwrap();
+
+        unsafe {
+            let decision = rlm_pattern_classifier_should_activate_incremental(
+                classifier,
+                session,
+                first.as_ptr(),
+                ctx,
+            );
+            assert_eq!(rlm_activation_decision_should_activate(decision), 1);
+            rlm_activation_decision_free(decision);
+
+            rlm_session_context_add_user_message(ctx, first.as_ptr());
+            let incremental = rlm_pattern_classifier_should_activate_incremental(
+                classifier,
+                session,
+                follow_up.as_ptr(),
+                ctx,
+            );
+            let full = rlm_pattern_classifier_should_activate(classifier, follow_up.as_ptr(), ctx);
+            assert_eq!((*incremental).0, (*full).0);
+            rlm_activation_decision_free(incremental);
+            rlm_activation_decision_free(full);
+
+            rlm_classifier_session_reset(session);
+            assert!(rlm_pattern_classifier_should_activate_incremental(
+                classifier,
+                std::ptr::null_mut(),
+                follow_up.as_ptr(),
+                ctx,
+            )
+            .is_null());
+
+            rlm_session_context_free(ctx);
+            rlm_classifier_session_free(session);
+            rlm_pattern_classifier_free(classifier);
+        }
+    }
+
     #[test]
     fn test_cost_tracker_lifecycle() {
         let tracker = rlm_cost_tracker_new();
@@ -382,6 +694,31 @@ mod tests {
         let output = unsafe { rlm_cost_tracker_total_output_tokens(tracker) };
         assert_eq!(output, 500);
 
+        let mut snapshot = RlmCostSnapshot::default();
+        assert_eq!(
+            unsafe { rlm_cost_tracker_snapshot_into(tracker, &mut snapshot) },
+            0
+        );
+        assert_eq!(snapshot.input_tokens, 1000);
+        assert_eq!(snapshot.request_count, 1);
+        assert!((snapshot.total_cost - 0.01).abs() < 1e-12);
+
+        assert_eq!(unsafe { rlm_cost_tracker_model_count(tracker) }, 1);
+        let mut costs = RlmUsageCosts::default();
+        let mut name = RlmStrView::null();
+        unsafe {
+            assert_eq!(
+                rlm_cost_tracker_model_costs_into(tracker, 0, &mut costs, &mut name),
+                0
+            );
+            assert_eq!(name.as_str(), Some("claude-sonnet"));
+            assert_eq!(
+                rlm_cost_tracker_model_costs_into(tracker, 1, &mut costs, std::ptr::null_mut()),
+                -1
+            );
+        }
+        assert_eq!(costs.output_tokens, 500);
+
         unsafe { rlm_cost_tracker_free(tracker) };
     }
 
@@ -552,4 +889,84 @@ mod tests {
 
         unsafe { rlm_string_free(features) };
     }
+
+    #[test]
+    fn test_arena_objects_and_strings() {
+        let arena = rlm_arena_new();
+        let content = std::ffi::CString::new("arena fact").unwrap();
+        unsafe {
+            for round in 0..3 {
+                let mut nodes = Vec::new();
+                for _ in 0..40 {
+                    nodes.push(rlm_node_new_in(arena, RlmNodeType::Fact, content.as_ptr()));
+                }
+                let msg = rlm_message_new_in(arena, RlmRole::User, content.as_ptr());
+                let out = rlm_tool_output_new_with_exit_code_in(
+                    arena,
+                    content.as_ptr(),
+                    content.as_ptr(),
+                    0,
+                );
+                let event = rlm_trajectory_event_new_in(
+                    arena,
+                    RlmTrajectoryEventType::Analyze,
+                    1,
+                    content.as_ptr(),
+                );
+                assert_eq!(rlm_arena_object_count(arena), 43, "round {round}");
+
+                // Earlier allocations stay valid as the slabs grow.
+                let first_id = CStr::from_ptr(rlm_node_id_in(arena, nodes[0]));
+                assert_eq!(first_id.to_str().unwrap(), (*nodes[0]).0.id.to_string());
+                let json = CStr::from_ptr(rlm_node_to_json_in(arena, nodes[39]));
+                assert!(json.to_str().unwrap().contains("arena fact"));
+                assert!(!rlm_trajectory_event_to_json_in(arena, event).is_null());
+                assert!(!rlm_trajectory_event_log_line_in(arena, event).is_null());
+                assert!(!rlm_message_timestamp_in(arena, msg).is_null());
+                assert_eq!(rlm_tool_output_is_success(out), 1);
+                assert_eq!(first_id.to_str().unwrap(), (*nodes[0]).0.id.to_string());
+                assert!(rlm_arena_string_bytes(arena) > 0);
+
+                rlm_arena_reset(arena);
+                assert_eq!(rlm_arena_object_count(arena), 0);
+                assert_eq!(rlm_arena_string_bytes(arena), 0);
+            }
+
+            assert!(
+                rlm_node_new_in(std::ptr::null_mut(), RlmNodeType::Fact, content.as_ptr())
+                    .is_null()
+            );
+            assert_eq!(rlm_has_error(), 1);
+            rlm_arena_free(arena);
+        }
+    }
+
+    #[test]
+    fn test_metrics_snapshot_and_prometheus() {
+        unsafe {
+            let mut before = RlmMetricsSnapshot::default();
+            assert_eq!(rlm_metrics_snapshot(&mut before), 0);
+
+            let scrubber = rlm_evidence_scrubber_new();
+            let text = std::ffi::CString::new("See src/lib.rs line 42").unwrap();
+            rlm_string_free(rlm_evidence_scrubber_scrub(scrubber, text.as_ptr()));
+            rlm_evidence_scrubber_free(scrubber);
+
+            let mut after = RlmMetricsSnapshot::default();
+            assert_eq!(rlm_metrics_snapshot(&mut after), 0);
+            let scrub = RlmMetric::Scrub as usize;
+            assert!(after.samples[scrub].count > before.samples[scrub].count);
+            assert!(after.samples[scrub].max_ns >= after.samples[scrub].p50_ns);
+
+            let name = CStr::from_ptr(rlm_metric_name(RlmMetric::Scrub));
+            assert_eq!(name.to_str().unwrap(), "scrub");
+            let text = rlm_metrics_prometheus();
+            assert!(CStr::from_ptr(text)
+                .to_str()
+                .unwrap()
+                .contains("rlm_scrub_seconds_count "));
+            rlm_string_free(text);
+            assert_eq!(rlm_metrics_snapshot(std::ptr::null_mut()), -1);
+        }
+    }
 }
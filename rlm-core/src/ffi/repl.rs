@@ -3,8 +3,11 @@
 use std::os::raw::c_char;
 
 use super::error::{cstr_to_str, ffi_try, set_last_error, str_to_cstring};
-use super::types::{RlmReplHandle, RlmReplPool};
-use crate::repl::{ReplConfig, ReplHandle, ReplPool};
+use super::types::{RlmReplHandle, RlmReplPending, RlmReplPool};
+use crate::error::Error;
+use crate::pool::PoolOptions;
+use crate::repl::{ExecuteResult, PendingReply, ReplConfig, ReplHandle, ReplPool, ReplStartupMode};
+use std::time::Duration;
 
 // ============================================================================
 // ReplConfig
@@ -25,6 +28,8 @@ pub extern "C" fn rlm_repl_config_default() -> *mut c_char {
         "timeout_ms": config.timeout_ms,
         "max_memory_bytes": config.max_memory_bytes,
         "max_cpu_seconds": config.max_cpu_seconds,
+        "startup_mode": "spawn",
+        "shm_threshold_bytes": config.shm_threshold_bytes,
     });
     match serde_json::to_string(&json) {
         Ok(s) => str_to_cstring(&s),
@@ -35,6 +40,49 @@ pub extern "C" fn rlm_repl_config_default() -> *mut c_char {
     }
 }
 
+/// Parse a REPL configuration JSON object, defaulting missing fields.
+///
+/// `startup_mode` is `"spawn"` (default) or `"fork_server"`.
+/// `shm_threshold_bytes` of 0 disables the shared-memory channel.
+fn parse_repl_config(json_str: &str) -> crate::error::Result<ReplConfig> {
+    let json: serde_json::Value = serde_json::from_str(json_str)?;
+
+    let mut config = ReplConfig::default();
+
+    if let Some(s) = json.get("python_path").and_then(|v| v.as_str()) {
+        config.python_path = s.to_string();
+    }
+    if let Some(s) = json.get("repl_package_path").and_then(|v| v.as_str()) {
+        config.repl_package_path = Some(s.to_string());
+    }
+    if let Some(n) = json.get("timeout_ms").and_then(|v| v.as_u64()) {
+        config.timeout_ms = n;
+    }
+    if let Some(n) = json.get("max_memory_bytes").and_then(|v| v.as_u64()) {
+        config.max_memory_bytes = Some(n);
+    }
+    if let Some(n) = json.get("max_cpu_seconds").and_then(|v| v.as_u64()) {
+        config.max_cpu_seconds = Some(n);
+    }
+    if let Some(n) = json.get("shm_threshold_bytes").and_then(|v| v.as_u64()) {
+        config.shm_threshold_bytes = n.min(usize::MAX as u64) as usize;
+    }
+    if let Some(mode) = json.get("startup_mode").and_then(|v| v.as_str()) {
+        config.startup_mode = match mode {
+            "spawn" => ReplStartupMode::Spawn,
+            "fork_server" => ReplStartupMode::ForkServer,
+            other => {
+                return Err(Error::Config(format!(
+                    "unknown startup_mode '{}' (expected 'spawn' or 'fork_server')",
+                    other
+                )))
+            }
+        };
+    }
+
+    Ok(config)
+}
+
 // ============================================================================
 // ReplHandle
 // ============================================================================
@@ -63,25 +111,7 @@ pub extern "C" fn rlm_repl_handle_spawn_default() -> *mut RlmReplHandle {
 #[no_mangle]
 pub unsafe extern "C" fn rlm_repl_handle_spawn(config_json: *const c_char) -> *mut RlmReplHandle {
     let json_str = ffi_try!(cstr_to_str(config_json));
-    let json: serde_json::Value = ffi_try!(serde_json::from_str(json_str));
-
-    let mut config = ReplConfig::default();
-
-    if let Some(s) = json.get("python_path").and_then(|v| v.as_str()) {
-        config.python_path = s.to_string();
-    }
-    if let Some(s) = json.get("repl_package_path").and_then(|v| v.as_str()) {
-        config.repl_package_path = Some(s.to_string());
-    }
-    if let Some(n) = json.get("timeout_ms").and_then(|v| v.as_u64()) {
-        config.timeout_ms = n;
-    }
-    if let Some(n) = json.get("max_memory_bytes").and_then(|v| v.as_u64()) {
-        config.max_memory_bytes = Some(n);
-    }
-    if let Some(n) = json.get("max_cpu_seconds").and_then(|v| v.as_u64()) {
-        config.max_cpu_seconds = Some(n);
-    }
+    let config = ffi_try!(parse_repl_config(json_str));
 
     let handle = ffi_try!(ReplHandle::spawn(config));
     Box::into_raw(Box::new(RlmReplHandle(handle)))
@@ -279,6 +309,138 @@ pub unsafe extern "C" fn rlm_repl_handle_is_alive(handle: *mut RlmReplHandle) ->
     }
 }
 
+// ============================================================================
+// Pipelined requests
+// ============================================================================
+
+/// A request started through one of the `*_async` functions.
+pub(crate) enum PendingRequest {
+    Execute(PendingReply<ExecuteResult>),
+    Value(PendingReply<serde_json::Value>),
+}
+
+impl PendingRequest {
+    fn poll(&mut self) -> bool {
+        match self {
+            Self::Execute(reply) => reply.poll(),
+            Self::Value(reply) => reply.poll(),
+        }
+    }
+
+    fn wait_json(self) -> crate::error::Result<String> {
+        Ok(match self {
+            Self::Execute(reply) => serde_json::to_string(&reply.wait()?)?,
+            Self::Value(reply) => serde_json::to_string(&reply.wait()?)?,
+        })
+    }
+}
+
+fn pending_into_raw(request: PendingRequest) -> *mut RlmReplPending {
+    Box::into_raw(Box::new(RlmReplPending(Some(request))))
+}
+
+/// Start executing Python code without waiting for the result.
+///
+/// Several requests may be in flight on one handle; collect each result with
+/// `rlm_repl_pending_wait()`.
+///
+/// # Safety
+/// - `handle` must be a valid pointer.
+/// - `code` must be a valid null-terminated string.
+/// - The returned pointer must be freed with `rlm_repl_pending_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_repl_handle_execute_async(
+    handle: *mut RlmReplHandle,
+    code: *const c_char,
+) -> *mut RlmReplPending {
+    if handle.is_null() {
+        set_last_error("null handle pointer");
+        return std::ptr::null_mut();
+    }
+    let code = ffi_try!(cstr_to_str(code));
+    let reply = ffi_try!((*handle).0.submit_execute(code));
+    pending_into_raw(PendingRequest::Execute(reply))
+}
+
+/// Request a variable from the REPL namespace without waiting for the value.
+///
+/// # Safety
+/// - `handle` must be a valid pointer.
+/// - `name` must be a valid null-terminated string.
+/// - The returned pointer must be freed with `rlm_repl_pending_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_repl_handle_get_variable_async(
+    handle: *mut RlmReplHandle,
+    name: *const c_char,
+) -> *mut RlmReplPending {
+    if handle.is_null() {
+        set_last_error("null handle pointer");
+        return std::ptr::null_mut();
+    }
+    let name = ffi_try!(cstr_to_str(name));
+    let reply = ffi_try!((*handle).0.submit_get_variable(name));
+    pending_into_raw(PendingRequest::Value(reply))
+}
+
+/// Check without blocking whether a pending request has completed.
+///
+/// A request also counts as complete once it has failed or timed out.
+///
+/// Returns 1 if `rlm_repl_pending_wait()` would not block, 0 if the request
+/// is still in flight, -1 on error (including when the result was already
+/// taken).
+///
+/// # Safety
+/// - `pending` must be a valid pointer.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_repl_pending_poll(pending: *mut RlmReplPending) -> i32 {
+    if pending.is_null() {
+        set_last_error("null pending pointer");
+        return -1;
+    }
+    match (*pending).0.as_mut() {
+        Some(request) => i32::from(request.poll()),
+        None => {
+            set_last_error("pending result already taken");
+            -1
+        }
+    }
+}
+
+/// Block until a pending request completes and take its result.
+///
+/// Returns the same JSON as the blocking variant of the request. The result
+/// can be taken only once; the pending object must still be freed.
+///
+/// # Safety
+/// - `pending` must be a valid pointer.
+/// - The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_repl_pending_wait(pending: *mut RlmReplPending) -> *mut c_char {
+    if pending.is_null() {
+        set_last_error("null pending pointer");
+        return std::ptr::null_mut();
+    }
+    let Some(request) = (*pending).0.take() else {
+        set_last_error("pending result already taken");
+        return std::ptr::null_mut();
+    };
+    let json = ffi_try!(request.wait_json());
+    str_to_cstring(&json)
+}
+
+/// Free a pending request, abandoning it if it has not completed.
+///
+/// # Safety
+/// - `pending` must be a valid pointer or NULL.
+/// - After calling this function, `pending` must not be used.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_repl_pending_free(pending: *mut RlmReplPending) {
+    if !pending.is_null() {
+        drop(Box::from_raw(pending));
+    }
+}
+
 // ============================================================================
 // ReplPool
 // ============================================================================
@@ -286,7 +448,7 @@ pub unsafe extern "C" fn rlm_repl_handle_is_alive(handle: *mut RlmReplHandle) ->
 /// Create a new REPL pool with default configuration.
 ///
 /// # Arguments
-/// - `max_size`: Maximum number of REPL handles to keep in the pool.
+/// - `max_size`: Maximum number of live REPL handles (0 for unbounded).
 ///
 /// # Safety
 /// The returned pointer must be freed with `rlm_repl_pool_free()`.
@@ -308,25 +470,7 @@ pub unsafe extern "C" fn rlm_repl_pool_new(
     max_size: usize,
 ) -> *mut RlmReplPool {
     let json_str = ffi_try!(cstr_to_str(config_json));
-    let json: serde_json::Value = ffi_try!(serde_json::from_str(json_str));
-
-    let mut config = ReplConfig::default();
-
-    if let Some(s) = json.get("python_path").and_then(|v| v.as_str()) {
-        config.python_path = s.to_string();
-    }
-    if let Some(s) = json.get("repl_package_path").and_then(|v| v.as_str()) {
-        config.repl_package_path = Some(s.to_string());
-    }
-    if let Some(n) = json.get("timeout_ms").and_then(|v| v.as_u64()) {
-        config.timeout_ms = n;
-    }
-    if let Some(n) = json.get("max_memory_bytes").and_then(|v| v.as_u64()) {
-        config.max_memory_bytes = Some(n);
-    }
-    if let Some(n) = json.get("max_cpu_seconds").and_then(|v| v.as_u64()) {
-        config.max_cpu_seconds = Some(n);
-    }
+    let config = ffi_try!(parse_repl_config(json_str));
 
     let pool = ReplPool::new(config, max_size);
     Box::into_raw(Box::new(RlmReplPool(pool)))
@@ -346,7 +490,8 @@ pub unsafe extern "C" fn rlm_repl_pool_free(pool: *mut RlmReplPool) {
 
 /// Acquire a REPL handle from the pool.
 ///
-/// This will either return an existing idle handle or spawn a new one.
+/// This returns an idle handle, spawns a new one if the pool is below its
+/// maximum size, or waits up to the pool's acquire timeout for a release.
 ///
 /// # Safety
 /// - `pool` must be a valid pointer.
@@ -379,3 +524,74 @@ pub unsafe extern "C" fn rlm_repl_pool_release(
     let handle = Box::from_raw(handle);
     (*pool).0.release(handle.0);
 }
+
+/// Create a new REPL pool with sizing and timing options.
+///
+/// `options_json` may contain `min_idle`, `max_size`, `acquire_timeout_ms` and
+/// `health_check_interval_ms`; missing fields take their defaults. Either
+/// argument may be NULL to use defaults. When `min_idle > 0` interpreters are
+/// started in the background so acquires do not wait for Python startup.
+///
+/// # Safety
+/// - Non-NULL arguments must be valid null-terminated JSON strings.
+/// - The returned pointer must be freed with `rlm_repl_pool_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_repl_pool_new_with_options(
+    config_json: *const c_char,
+    options_json: *const c_char,
+) -> *mut RlmReplPool {
+    let config = if config_json.is_null() {
+        ReplConfig::default()
+    } else {
+        ffi_try!(parse_repl_config(ffi_try!(cstr_to_str(config_json))))
+    };
+    let options = if options_json.is_null() {
+        PoolOptions::default()
+    } else {
+        ffi_try!(serde_json::from_str::<PoolOptions>(ffi_try!(cstr_to_str(
+            options_json
+        ))))
+    };
+    let pool = ReplPool::with_options(config, options);
+    Box::into_raw(Box::new(RlmReplPool(pool)))
+}
+
+/// Acquire a REPL handle, waiting at most `timeout_ms` for one to free up.
+///
+/// Returns NULL and sets the last error if the wait times out.
+///
+/// # Safety
+/// - `pool` must be a valid pointer.
+/// - The returned pointer must be freed with `rlm_repl_handle_free()` or
+///   returned to the pool with `rlm_repl_pool_release()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_repl_pool_acquire_timeout(
+    pool: *const RlmReplPool,
+    timeout_ms: u64,
+) -> *mut RlmReplHandle {
+    if pool.is_null() {
+        set_last_error("null pool pointer");
+        return std::ptr::null_mut();
+    }
+    let handle = ffi_try!((*pool).0.acquire_timeout(Duration::from_millis(timeout_ms)));
+    Box::into_raw(Box::new(RlmReplHandle(handle)))
+}
+
+/// Get pool statistics as JSON.
+///
+/// Fields: `idle`, `busy`, `spawning`, `spawned`, `spawn_failures`,
+/// `acquire_timeouts`, and `spawn_latency_ms` (histogram counts for buckets
+/// bounded by 10, 50, 100, 250, 500, 1000, 2500, 5000 ms plus overflow).
+///
+/// # Safety
+/// - `pool` must be a valid pointer.
+/// - The returned string must be freed with `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_repl_pool_stats(pool: *const RlmReplPool) -> *mut c_char {
+    if pool.is_null() {
+        set_last_error("null pool pointer");
+        return std::ptr::null_mut();
+    }
+    let json = ffi_try!(serde_json::to_string(&(*pool).0.stats()));
+    str_to_cstring(&json)
+}
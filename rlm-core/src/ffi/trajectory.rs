@@ -1,10 +1,18 @@
 //! FFI bindings for trajectory types.
 
+use std::collections::HashMap;
+use std::ffi::c_void;
 use std::os::raw::c_char;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{LazyLock, Mutex};
 
+use super::arena::arena_mut;
 use super::error::{cstr_to_str, ffi_try, set_last_error, str_to_cstring};
-use super::types::{RlmTrajectoryEvent, RlmTrajectoryEventType};
-use crate::trajectory::TrajectoryEvent;
+use super::types::{
+    RlmArena, RlmStrView, RlmTrajectoryEvent, RlmTrajectoryEventType, RlmTrajectorySink,
+    RlmTrajectorySinkFormat,
+};
+use crate::trajectory::{EventFilter, SinkConfig, TrajectoryEvent, TrajectorySink};
 
 // ============================================================================
 // TrajectoryEvent
@@ -26,6 +34,28 @@ pub unsafe extern "C" fn rlm_trajectory_event_new(
     Box::into_raw(Box::new(RlmTrajectoryEvent(event)))
 }
 
+/// Create a trajectory event in an arena.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - `content` must be a valid null-terminated string.
+/// - The event is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_trajectory_event_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_event_new_in(
+    arena: *mut RlmArena,
+    event_type: RlmTrajectoryEventType,
+    depth: u32,
+    content: *const c_char,
+) -> *mut RlmTrajectoryEvent {
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null_mut();
+    };
+    let content = ffi_try!(cstr_to_str(content));
+    let event = TrajectoryEvent::new(event_type.into(), depth, content);
+    arena.event(RlmTrajectoryEvent(event))
+}
+
 /// Create an RLM start event.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_trajectory_event_rlm_start(
@@ -179,6 +209,21 @@ pub unsafe extern "C" fn rlm_trajectory_event_content(
     str_to_cstring(&(*event).0.content)
 }
 
+/// Borrow the event content without copying.
+///
+/// # Safety
+/// The view is not NUL-terminated and is valid only until `event` is freed.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_event_content_view(
+    event: *const RlmTrajectoryEvent,
+) -> RlmStrView {
+    if event.is_null() {
+        set_last_error("null event pointer");
+        return RlmStrView::null();
+    }
+    RlmStrView::borrow(&(*event).0.content)
+}
+
 /// Get the event timestamp (RFC3339 format).
 ///
 /// # Safety
@@ -209,6 +254,27 @@ pub unsafe extern "C" fn rlm_trajectory_event_log_line(
     str_to_cstring(&(*event).0.as_log_line())
 }
 
+/// Get the event as a log line, as an arena string.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - The string is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_event_log_line_in(
+    arena: *mut RlmArena,
+    event: *const RlmTrajectoryEvent,
+) -> *const c_char {
+    if event.is_null() {
+        set_last_error("null event pointer");
+        return std::ptr::null();
+    }
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null();
+    };
+    arena.str(&(*event).0.as_log_line())
+}
+
 /// Check if the event is an error.
 #[no_mangle]
 pub unsafe extern "C" fn rlm_trajectory_event_is_error(event: *const RlmTrajectoryEvent) -> i32 {
@@ -251,6 +317,27 @@ pub unsafe extern "C" fn rlm_trajectory_event_to_json(
     str_to_cstring(&json)
 }
 
+/// Serialize event to JSON as an arena string.
+///
+/// # Safety
+/// - `arena` must be a valid arena pointer.
+/// - The string is released by `rlm_arena_reset()`; do not pass it to
+///   `rlm_string_free()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_event_to_json_in(
+    arena: *mut RlmArena,
+    event: *const RlmTrajectoryEvent,
+) -> *const c_char {
+    if event.is_null() {
+        set_last_error("null event pointer");
+        return std::ptr::null();
+    }
+    let Some(arena) = arena_mut(arena) else {
+        return std::ptr::null();
+    };
+    arena.str_with(|buf| serde_json::to_writer(buf, &(*event).0))
+}
+
 /// Deserialize event from JSON.
 ///
 /// # Safety
@@ -306,3 +393,226 @@ pub extern "C" fn rlm_trajectory_event_type_name(
     };
     str_to_cstring(name)
 }
+
+// ============================================================================
+// Trajectory Bus, Subscriptions and Sinks
+// ============================================================================
+
+/// Callback receiving events from `rlm_trajectory_subscribe()`.
+///
+/// `event` is borrowed for the duration of the call only.
+pub type RlmTrajectoryCallback =
+    Option<unsafe extern "C" fn(event: *const RlmTrajectoryEvent, user_data: *mut c_void)>;
+
+static SUBSCRIPTIONS: LazyLock<Mutex<HashMap<u64, TrajectorySink>>> =
+    LazyLock::new(|| Mutex::new(HashMap::new()));
+static NEXT_SUBSCRIPTION: AtomicU64 = AtomicU64::new(1);
+
+/// Caller-provided context pointer, handed back to the callback verbatim.
+struct UserData(*mut c_void);
+
+// SAFETY: the library never dereferences the pointer; making it safe to use
+// from the delivery thread is the caller's contract.
+unsafe impl Send for UserData {}
+
+impl UserData {
+    fn get(&self) -> *mut c_void {
+        self.0
+    }
+}
+
+/// Publish an event on the process-wide trajectory bus.
+///
+/// # Safety
+/// `event` must be a valid pointer; it is copied, not consumed.
+///
+/// Returns the number of subscribers that will receive the event, or -1 on
+/// error.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_publish(event: *const RlmTrajectoryEvent) -> i64 {
+    if event.is_null() {
+        set_last_error("null pointer");
+        return -1;
+    }
+    crate::trajectory::publish((*event).0.clone()) as i64
+}
+
+/// Subscribe to the trajectory bus.
+///
+/// `callback` runs on a library-owned thread, once per event whose type bit
+/// is set in `filter_mask` (0 selects all types), in publish order.
+///
+/// # Safety
+/// - `callback` must be safe to call from another thread with `user_data`.
+/// - `rlm_trajectory_unsubscribe()` must not be called from inside `callback`.
+///
+/// Returns the subscription id (> 0), or 0 on error.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_subscribe(
+    callback: RlmTrajectoryCallback,
+    filter_mask: u32,
+    user_data: *mut c_void,
+) -> u64 {
+    let Some(callback) = callback else {
+        set_last_error("null callback");
+        return 0;
+    };
+    let user_data = UserData(user_data);
+    let sink = TrajectorySink::to_callback(
+        crate::trajectory::subscribe(),
+        move |event| {
+            let event = RlmTrajectoryEvent(event);
+            callback(&event, user_data.get());
+        },
+        sink_config(filter_mask),
+    );
+    match sink {
+        Ok(sink) => {
+            let id = NEXT_SUBSCRIPTION.fetch_add(1, Ordering::Relaxed);
+            SUBSCRIPTIONS
+                .lock()
+                .unwrap_or_else(|e| e.into_inner())
+                .insert(id, sink);
+            id
+        }
+        Err(e) => {
+            set_last_error(&format!("Failed to start subscription: {}", e));
+            0
+        }
+    }
+}
+
+/// Cancel a subscription after delivering the events already queued for it.
+///
+/// Returns 0 on success, -1 if `id` is not an active subscription.
+#[no_mangle]
+pub extern "C" fn rlm_trajectory_unsubscribe(id: u64) -> i32 {
+    // Take the sink out first so the registry is not locked while joining.
+    let sink = SUBSCRIPTIONS
+        .lock()
+        .unwrap_or_else(|e| e.into_inner())
+        .remove(&id);
+    match sink {
+        Some(sink) => {
+            let _ = sink.close();
+            0
+        }
+        None => {
+            set_last_error(&format!("Unknown trajectory subscription {}", id));
+            -1
+        }
+    }
+}
+
+/// Default sink settings with the given event-type filter mask.
+fn sink_config(filter_mask: u32) -> SinkConfig {
+    SinkConfig {
+        filter: EventFilter::from_mask(filter_mask),
+        ..SinkConfig::default()
+    }
+}
+
+/// Stream trajectory bus events to a file, appending if it exists.
+///
+/// # Safety
+/// - `path` must be a valid null-terminated string.
+/// - The returned pointer must be released with `rlm_trajectory_sink_close()`.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_sink_open(
+    path: *const c_char,
+    format: RlmTrajectorySinkFormat,
+    filter_mask: u32,
+) -> *mut RlmTrajectorySink {
+    let path = ffi_try!(cstr_to_str(path));
+    match TrajectorySink::to_file(
+        crate::trajectory::subscribe(),
+        path,
+        format.into(),
+        sink_config(filter_mask),
+    ) {
+        Ok(sink) => Box::into_raw(Box::new(RlmTrajectorySink(sink))),
+        Err(e) => {
+            set_last_error(&format!("Failed to open trajectory sink '{}': {}", path, e));
+            std::ptr::null_mut()
+        }
+    }
+}
+
+/// Stream trajectory bus events to a file descriptor. The descriptor is
+/// duplicated; the caller keeps ownership of `fd`.
+///
+/// # Safety
+/// - `fd` must be an open, writable file descriptor.
+/// - The returned pointer must be released with `rlm_trajectory_sink_close()`.
+#[cfg(unix)]
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_sink_open_fd(
+    fd: std::os::raw::c_int,
+    format: RlmTrajectorySinkFormat,
+    filter_mask: u32,
+) -> *mut RlmTrajectorySink {
+    if fd < 0 {
+        set_last_error("invalid file descriptor");
+        return std::ptr::null_mut();
+    }
+    let owned = match std::os::fd::BorrowedFd::borrow_raw(fd).try_clone_to_owned() {
+        Ok(owned) => owned,
+        Err(e) => {
+            set_last_error(&format!("Failed to duplicate fd {}: {}", fd, e));
+            return std::ptr::null_mut();
+        }
+    };
+    match TrajectorySink::to_writer(
+        crate::trajectory::subscribe(),
+        std::fs::File::from(owned),
+        format.into(),
+        sink_config(filter_mask),
+    ) {
+        Ok(sink) => Box::into_raw(Box::new(RlmTrajectorySink(sink))),
+        Err(e) => {
+            set_last_error(&format!(
+                "Failed to open trajectory sink on fd {}: {}",
+                fd, e
+            ));
+            std::ptr::null_mut()
+        }
+    }
+}
+
+/// Number of events written by a sink so far.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_sink_delivered(sink: *const RlmTrajectorySink) -> u64 {
+    if sink.is_null() {
+        return 0;
+    }
+    (*sink).0.delivered()
+}
+
+/// Number of events a sink dropped because it fell behind.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_sink_dropped(sink: *const RlmTrajectorySink) -> u64 {
+    if sink.is_null() {
+        return 0;
+    }
+    (*sink).0.dropped()
+}
+
+/// Flush and close a sink, freeing it.
+///
+/// # Safety
+/// `sink` must be a pointer returned by `rlm_trajectory_sink_open*()` or NULL.
+///
+/// Returns 0 on success, -1 if a write failed.
+#[no_mangle]
+pub unsafe extern "C" fn rlm_trajectory_sink_close(sink: *mut RlmTrajectorySink) -> i32 {
+    if sink.is_null() {
+        return 0;
+    }
+    match Box::from_raw(sink).0.close() {
+        Ok(()) => 0,
+        Err(e) => {
+            set_last_error(&format!("Trajectory sink write failed: {}", e));
+            -1
+        }
+    }
+}
@@ -7,6 +7,12 @@ use std::os::raw::c_char;
 /// Opaque handle for SessionContext.
 pub struct RlmSessionContext(pub(crate) crate::context::SessionContext);
 
+/// Opaque handle for a SnapshotWriter.
+pub struct RlmSessionSnapshotWriter(pub(crate) crate::context::SnapshotWriter);
+
+/// Opaque handle for a memory-mapped SessionSnapshot.
+pub struct RlmSessionSnapshot(pub(crate) crate::context::SessionSnapshot);
+
 /// Opaque handle for Message.
 pub struct RlmMessage(pub(crate) crate::context::Message);
 
@@ -16,6 +22,9 @@ pub struct RlmToolOutput(pub(crate) crate::context::ToolOutput);
 /// Opaque handle for SqliteMemoryStore.
 pub struct RlmMemoryStore(pub(crate) crate::memory::SqliteMemoryStore);
 
+/// Opaque handle for a running MaintenanceScheduler.
+pub struct RlmMemoryMaintenance(pub(crate) crate::memory::MaintenanceScheduler);
+
 /// Opaque handle for Node.
 pub struct RlmNode(pub(crate) crate::memory::Node);
 
@@ -25,9 +34,15 @@ pub struct RlmHyperEdge(pub(crate) crate::memory::HyperEdge);
 /// Opaque handle for TrajectoryEvent.
 pub struct RlmTrajectoryEvent(pub(crate) crate::trajectory::TrajectoryEvent);
 
+/// Opaque handle for a streaming TrajectorySink.
+pub struct RlmTrajectorySink(pub(crate) crate::trajectory::TrajectorySink);
+
 /// Opaque handle for PatternClassifier.
 pub struct RlmPatternClassifier(pub(crate) crate::complexity::PatternClassifier);
 
+/// Opaque handle for ClassifierSession.
+pub struct RlmClassifierSession(pub(crate) crate::complexity::ClassifierSession);
+
 /// Opaque handle for ActivationDecision.
 pub struct RlmActivationDecision(pub(crate) crate::complexity::ActivationDecision);
 
@@ -37,6 +52,169 @@ pub struct RlmReplHandle(pub(crate) crate::repl::ReplHandle);
 /// Opaque handle for ReplPool.
 pub struct RlmReplPool(pub(crate) crate::repl::ReplPool);
 
+/// Opaque handle for an in-flight REPL request.
+///
+/// Holds `None` once the result has been taken.
+pub struct RlmReplPending(pub(crate) Option<super::repl::PendingRequest>);
+
+/// Opaque handle for a request-scoped arena of FFI objects and strings.
+pub struct RlmArena(pub(crate) super::arena::Arena);
+
+/// Opaque handle for a list of nodes returned by a store query.
+pub struct RlmNodeList(pub(crate) Vec<RlmNode>);
+
+/// Opaque handle for a list of hyperedges returned by a store query.
+pub struct RlmHyperEdgeList(pub(crate) Vec<RlmHyperEdge>);
+
+// ============================================================================
+// Borrowed string views
+// ============================================================================
+
+/// Borrowed, non-owning view of a UTF-8 string held inside an FFI object.
+///
+/// The bytes are *not* NUL-terminated; always use `len`. A view is valid until
+/// the owning object is mutated or freed, and must never be passed to
+/// `rlm_string_free()`. An absent value is reported as `{ NULL, 0 }`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy)]
+pub struct RlmStrView {
+    pub ptr: *const c_char,
+    pub len: usize,
+}
+
+impl RlmStrView {
+    /// View representing an absent value.
+    pub(crate) const fn null() -> Self {
+        Self {
+            ptr: std::ptr::null(),
+            len: 0,
+        }
+    }
+
+    /// Borrow a Rust string slice without copying.
+    pub(crate) fn borrow(s: &str) -> Self {
+        Self {
+            ptr: s.as_ptr() as *const c_char,
+            len: s.len(),
+        }
+    }
+
+    /// Borrow an optional string slice, mapping `None` to a null view.
+    pub(crate) fn borrow_opt(s: Option<&str>) -> Self {
+        s.map(Self::borrow).unwrap_or_else(Self::null)
+    }
+
+    /// Reinterpret the view as a Rust string slice (tests only).
+    #[cfg(test)]
+    pub(crate) unsafe fn as_str<'a>(&self) -> Option<&'a str> {
+        if self.ptr.is_null() {
+            return None;
+        }
+        let bytes = std::slice::from_raw_parts(self.ptr as *const u8, self.len);
+        std::str::from_utf8(bytes).ok()
+    }
+}
+
+// ============================================================================
+// Fixed-layout results
+// ============================================================================
+
+/// Memory store statistics in a fixed C layout.
+///
+/// `nodes_by_tier` is indexed by `RlmTier` and `nodes_by_type` by `RlmNodeType`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct RlmMemoryStats {
+    pub total_nodes: u64,
+    pub total_edges: u64,
+    pub nodes_by_tier: [u64; 4],
+    pub nodes_by_type: [u64; 5],
+}
+
+/// Token and cost counters for one tier or model in a fixed C layout.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct RlmUsageCosts {
+    pub input_tokens: u64,
+    pub output_tokens: u64,
+    pub request_count: u64,
+    pub cost: f64,
+}
+
+/// Cost tracker totals in a fixed C layout.
+///
+/// `tiers` is indexed root, recursive, extraction.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq)]
+pub struct RlmCostSnapshot {
+    pub input_tokens: u64,
+    pub output_tokens: u64,
+    pub cache_read_tokens: u64,
+    pub cache_creation_tokens: u64,
+    pub request_count: u64,
+    pub total_cost: f64,
+    pub tiers: [RlmUsageCosts; 3],
+}
+
+/// What one snapshot checkpoint appended, in a fixed C layout.
+///
+/// `full` is 1 when the message list was rewritten from the start.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct RlmSnapshotCheckpointStats {
+    pub blobs_written: u64,
+    pub blobs_reused: u64,
+    pub messages_written: u64,
+    pub bytes_written: u64,
+    pub full: i32,
+}
+
+impl From<crate::context::CheckpointStats> for RlmSnapshotCheckpointStats {
+    fn from(s: crate::context::CheckpointStats) -> Self {
+        RlmSnapshotCheckpointStats {
+            blobs_written: s.blobs_written as u64,
+            blobs_reused: s.blobs_reused as u64,
+            messages_written: s.messages_written as u64,
+            bytes_written: s.bytes_written,
+            full: s.full as i32,
+        }
+    }
+}
+
+/// Latency summary of one metric in a fixed C layout.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct RlmMetricSample {
+    pub count: u64,
+    pub sum_ns: u64,
+    pub max_ns: u64,
+    pub p50_ns: u64,
+    pub p95_ns: u64,
+    pub p99_ns: u64,
+}
+
+impl From<crate::metrics::MetricSnapshot> for RlmMetricSample {
+    fn from(s: crate::metrics::MetricSnapshot) -> Self {
+        RlmMetricSample {
+            count: s.count,
+            sum_ns: s.sum_ns,
+            max_ns: s.max_ns,
+            p50_ns: s.p50_ns,
+            p95_ns: s.p95_ns,
+            p99_ns: s.p99_ns,
+        }
+    }
+}
+
+/// Every hot-path metric in a fixed C layout.
+///
+/// `samples` is indexed by `RlmMetric`.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct RlmMetricsSnapshot {
+    pub samples: [RlmMetricSample; crate::metrics::Metric::COUNT],
+}
+
 // ============================================================================
 // Enum representations for FFI
 // ============================================================================
@@ -171,6 +349,53 @@ pub enum RlmTrajectoryEventType {
     AdversarialComplete = 24,
 }
 
+/// Encoding for trajectory sinks.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RlmTrajectorySinkFormat {
+    JsonLines = 0,
+    Binary = 1,
+}
+
+impl From<RlmTrajectorySinkFormat> for crate::trajectory::SinkFormat {
+    fn from(f: RlmTrajectorySinkFormat) -> Self {
+        match f {
+            RlmTrajectorySinkFormat::JsonLines => crate::trajectory::SinkFormat::JsonLines,
+            RlmTrajectorySinkFormat::Binary => crate::trajectory::SinkFormat::Binary,
+        }
+    }
+}
+
+/// Hot-path metric selector.
+#[repr(C)]
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum RlmMetric {
+    ReplRoundTrip = 0,
+    ReplSpawn = 1,
+    SqliteQuery = 2,
+    StoreLockWait = 3,
+    LlmCall = 4,
+    LlmQueue = 5,
+    Scrub = 6,
+    ClaimExtract = 7,
+}
+
+impl From<RlmMetric> for crate::metrics::Metric {
+    fn from(m: RlmMetric) -> Self {
+        use crate::metrics::Metric;
+        match m {
+            RlmMetric::ReplRoundTrip => Metric::ReplRoundTrip,
+            RlmMetric::ReplSpawn => Metric::ReplSpawn,
+            RlmMetric::SqliteQuery => Metric::SqliteQuery,
+            RlmMetric::StoreLockWait => Metric::StoreLockWait,
+            RlmMetric::LlmCall => Metric::LlmCall,
+            RlmMetric::LlmQueue => Metric::LlmQueue,
+            RlmMetric::Scrub => Metric::Scrub,
+            RlmMetric::ClaimExtract => Metric::ClaimExtract,
+        }
+    }
+}
+
 impl From<crate::trajectory::TrajectoryEventType> for RlmTrajectoryEventType {
     fn from(t: crate::trajectory::TrajectoryEventType) -> Self {
         match t {
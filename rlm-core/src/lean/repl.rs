@@ -8,11 +8,13 @@
 use crate::error::{Error, Result};
 use crate::repl::{ExecuteResult, ReplEnvironment};
 use serde_json::Value;
+use sha2::{Digest, Sha256};
 use std::collections::HashMap;
 use std::io::{BufRead, BufReader, Write};
 use std::path::{Path, PathBuf};
 use std::process::{Child, ChildStdin, ChildStdout, Command, Stdio};
-use std::time::{Duration, Instant};
+use std::sync::{LazyLock, Mutex};
+use std::time::{Duration, Instant, SystemTime};
 
 use super::types::{Goal, LeanCommand, LeanEventMetadata, LeanResponse, ProofState, ProofStep};
 
@@ -74,6 +76,11 @@ pub struct LeanReplConfig {
 
     /// Whether to enable verbose logging.
     pub verbose: bool,
+
+    /// Environment pickle (from [`LeanRepl::pickle`]) restored on spawn.
+    /// Processes start from the pickled imports instead of re-elaborating
+    /// them, and [`LeanRepl::reset`] returns to that environment.
+    pub env_pickle: Option<PathBuf>,
 }
 
 impl Default for LeanReplConfig {
@@ -84,6 +91,7 @@ impl Default for LeanReplConfig {
             timeout_ms: 60_000, // Lean type checking can be slow
             max_retries: 2,
             verbose: false,
+            env_pickle: None,
         }
     }
 }
@@ -108,6 +116,73 @@ impl LeanReplConfig {
         self.verbose = verbose;
         self
     }
+
+    /// Restore this environment pickle on spawn.
+    pub fn with_env_pickle(mut self, path: impl Into<PathBuf>) -> Self {
+        self.env_pickle = Some(path.into());
+        self
+    }
+
+    /// Stable identity of the environment a freshly spawned REPL starts in.
+    ///
+    /// Environment IDs are process-local, so caches shared across processes
+    /// key on this instead. The pickle is identified by its SHA-256 as well
+    /// as its path, so regenerating it in place yields a new key; the hash is
+    /// recomputed only when the file's size or modification time changes.
+    pub fn env_key(&self) -> String {
+        let display = |p: &Option<PathBuf>| {
+            p.as_deref()
+                .map(|p| p.display().to_string())
+                .unwrap_or_default()
+        };
+        format!(
+            "{}|{}|{}",
+            display(&self.project_root),
+            display(&self.env_pickle),
+            self.env_pickle
+                .as_deref()
+                .map(pickle_digest)
+                .unwrap_or_default()
+        )
+    }
+}
+
+/// Pickle digests by path, with the size and mtime they were computed at.
+static PICKLE_DIGESTS: LazyLock<Mutex<HashMap<PathBuf, (u64, SystemTime, String)>>> =
+    LazyLock::new(Default::default);
+
+/// Hex SHA-256 of the pickle at `path`, or `"missing"` if it cannot be read.
+fn pickle_digest(path: &Path) -> String {
+    let Ok(meta) = std::fs::metadata(path) else {
+        return "missing".to_string();
+    };
+    let stamp = (
+        meta.len(),
+        meta.modified().unwrap_or(SystemTime::UNIX_EPOCH),
+    );
+    if let Ok(digests) = PICKLE_DIGESTS.lock() {
+        if let Some((len, modified, digest)) = digests.get(path) {
+            if (*len, *modified) == stamp {
+                return digest.clone();
+            }
+        }
+    }
+
+    let mut hasher = Sha256::new();
+    let hashed =
+        std::fs::File::open(path).and_then(|mut file| std::io::copy(&mut file, &mut hasher));
+    if hashed.is_err() {
+        return "missing".to_string();
+    }
+    let digest: String = hasher
+        .finalize()
+        .iter()
+        .map(|b| format!("{:02x}", b))
+        .collect();
+    if let Ok(mut digests) = PICKLE_DIGESTS.lock() {
+        digests.insert(path.to_path_buf(), (stamp.0, stamp.1, digest.clone()));
+    }
+    digest
 }
 
 /// Handle to a running Lean REPL subprocess.
@@ -120,6 +195,8 @@ pub struct LeanRepl {
     stdout: BufReader<ChildStdout>,
     /// Current environment ID.
     current_env: Option<u64>,
+    /// Environment restored from `config.env_pickle` at spawn.
+    base_env: Option<u64>,
     /// Configuration.
     config: LeanReplConfig,
     /// Pending sorries (unfinished proofs) as operation IDs.
@@ -157,16 +234,21 @@ impl LeanRepl {
 
         let stdout = BufReader::new(stdout);
 
-        let repl = Self {
+        let mut repl = Self {
             child,
             stdin: Some(stdin),
             stdout,
             current_env: None,
+            base_env: None,
             config,
             pending_sorries: Vec::new(),
             proof_states: HashMap::new(),
         };
 
+        if let Some(path) = repl.config.env_pickle.clone() {
+            repl.base_env = Some(repl.unpickle(&path)?);
+        }
+
         Ok(repl)
     }
 
@@ -452,9 +534,14 @@ impl LeanRepl {
         self.current_env = Some(env);
     }
 
-    /// Reset to fresh environment.
+    /// Environment restored from the configured pickle, if any.
+    pub fn base_env(&self) -> Option<u64> {
+        self.base_env
+    }
+
+    /// Reset to the base environment (the unpickled one, or a fresh one).
     pub fn reset(&mut self) {
-        self.current_env = None;
+        self.current_env = self.base_env;
         self.pending_sorries.clear();
         self.proof_states.clear();
     }
@@ -657,6 +744,10 @@ impl Drop for LeanRepl {
 }
 
 /// Pool of Lean REPL instances for concurrent usage.
+///
+/// With [`LeanReplConfig::env_pickle`] set, every process starts from the
+/// pickled environment and returns to it on release, so handles are
+/// interchangeable.
 pub struct LeanReplPool {
     config: LeanReplConfig,
     handles: std::sync::Mutex<Vec<LeanRepl>>,
@@ -689,9 +780,49 @@ impl LeanReplPool {
         }
 
         // No available handles, spawn a new one
+        drop(handles);
         LeanRepl::spawn(self.config.clone())
     }
 
+    /// Spawn handles in parallel until `count` are idle (capped at the pool
+    /// size), so later fan-out does not pay for process start-up serially.
+    pub fn warm(&self, count: usize) -> Result<()> {
+        let idle = self
+            .handles
+            .lock()
+            .map_err(|e| Error::Internal(format!("Failed to lock pool: {}", e)))?
+            .len();
+        let missing = count.min(self.max_size).saturating_sub(idle);
+
+        let spawned: Vec<Result<LeanRepl>> = std::thread::scope(|scope| {
+            let workers: Vec<_> = (0..missing)
+                .map(|_| scope.spawn(|| LeanRepl::spawn(self.config.clone())))
+                .collect();
+            workers
+                .into_iter()
+                .map(|w| match w.join() {
+                    Ok(handle) => handle,
+                    Err(payload) => std::panic::resume_unwind(payload),
+                })
+                .collect()
+        });
+
+        for handle in spawned {
+            self.release(handle?);
+        }
+        Ok(())
+    }
+
+    /// The configuration new handles are spawned with.
+    pub fn config(&self) -> &LeanReplConfig {
+        &self.config
+    }
+
+    /// Maximum number of idle handles kept.
+    pub fn max_size(&self) -> usize {
+        self.max_size
+    }
+
     /// Return a REPL handle to the pool.
     pub fn release(&self, mut handle: LeanRepl) {
         // Reset the handle before returning to pool
@@ -724,6 +855,52 @@ mod tests {
         assert_eq!(config.project_root, Some(PathBuf::from("/path/to/project")));
     }
 
+    #[test]
+    fn test_env_key_distinguishes_pickles() {
+        let bare = LeanReplConfig::with_project("/proj");
+        let pickled = bare.clone().with_env_pickle("/proj/env.olean");
+        assert_eq!(
+            bare.env_key(),
+            LeanReplConfig::with_project("/proj").env_key()
+        );
+        assert_ne!(bare.env_key(), pickled.env_key());
+        assert_eq!(pickled.env_pickle, Some(PathBuf::from("/proj/env.olean")));
+    }
+
+    #[test]
+    fn test_env_key_tracks_pickle_contents() {
+        let dir = tempfile::tempdir().unwrap();
+        let pickle = dir.path().join("env.olean");
+        let config = LeanReplConfig::with_project("/proj").with_env_pickle(&pickle);
+        let missing = config.env_key();
+
+        std::fs::write(&pickle, b"first environment").unwrap();
+        let first = config.env_key();
+        assert_ne!(first, missing);
+        assert_eq!(config.env_key(), first);
+
+        // Regenerated in place under the same path.
+        std::fs::write(&pickle, b"second environment, longer").unwrap();
+        assert_ne!(config.env_key(), first);
+    }
+
+    #[test]
+    #[ignore = "requires Lean REPL installed"]
+    fn test_pool_restores_pickled_env() {
+        let dir = tempfile::tempdir().unwrap();
+        let pickle = dir.path().join("env.olean");
+        let mut repl = LeanRepl::spawn(LeanReplConfig::default()).unwrap();
+        repl.execute_command("def rlmPooled : Nat := 42").unwrap();
+        repl.pickle(&pickle).unwrap();
+
+        let pool = LeanReplPool::new(LeanReplConfig::default().with_env_pickle(&pickle), 2);
+        pool.warm(2).unwrap();
+        let mut handle = pool.acquire().unwrap();
+        assert!(handle.base_env().is_some());
+        assert_eq!(handle.evaluate("rlmPooled").unwrap().trim(), "42");
+        pool.release(handle);
+    }
+
     // Integration tests require Lean environment
     #[test]
     #[ignore = "requires Lean REPL installed"]
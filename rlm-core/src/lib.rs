@@ -39,8 +39,10 @@ pub mod ffi;
 pub mod lean;
 pub mod llm;
 pub mod memory;
+pub mod metrics;
 pub mod module;
 pub mod orchestrator;
+pub mod pool;
 pub mod proof;
 #[cfg(feature = "python")]
 pub mod pybind;
@@ -69,11 +71,13 @@ pub use adversarial::{
     ValidationIteration, ValidationResult as AdversarialValidationResult,
     ValidationStats as AdversarialValidationStats, ValidationStrategy, ValidationVerdict,
 };
-pub use complexity::{ActivationDecision, PatternClassifier, TaskComplexitySignals};
+pub use complexity::{
+    ActivationDecision, ClassifierSession, PatternClassifier, TaskComplexitySignals,
+};
 pub use context::{
-    ContextSizeTracker, ContextVarType, ContextVariable, ExternalizationConfig,
-    ExternalizedContext, Message, Role, SessionContext, SizeConfig, SizeWarning, ToolOutput,
-    VariableAccessHelper,
+    BpeTokenizer, ContentStore, ContextSizeTracker, ContextVarType, ContextVariable,
+    ExternalizationConfig, ExternalizedContext, LazyVariables, Message, Role, SessionContext,
+    SizeConfig, SizeWarning, Tokenizer, ToolOutput, VariableAccessHelper,
 };
 pub use dp_integration::{
     CoverageReport, CoverageSummary, DPCommand, DPCommandHandler, DPCommandResult,
@@ -90,9 +94,11 @@ pub use epistemic::{
 pub use error::{Error, Result};
 pub use llm::{
     AnthropicClient, BatchConfig, BatchExecutor, BatchQueryResult, BatchedLLMQuery,
-    BatchedQueryResults, ClientConfig, CompletionRequest, CompletionResponse, CostTracker,
-    DualModelConfig, LLMClient, ModelCallTier, ModelSpec, ModelTier, Provider, QueryType,
-    RoutingContext, SmartRouter, SwitchStrategy, TierBreakdown,
+    BatchedQueryResults, CachingClient, ClientConfig, CompletionRequest, CompletionResponse,
+    CostTracker, DualModelConfig, LLMClient, LimiterConfig, LimiterSnapshot, ModelCallTier,
+    ModelSpec, ModelTier, Provider, ProviderLimiter, QueryType, ResponseCache, ResponseCacheConfig,
+    ResponseCachePolicy, RoutingContext, ShardedCostTracker, SmartRouter, SwitchStrategy,
+    TierBreakdown,
 };
 pub use memory::{Node, NodeId, NodeType, SqliteMemoryStore, Tier};
 pub use module::{
@@ -101,6 +107,7 @@ pub use module::{
     PredictConfig, Predictor,
 };
 pub use orchestrator::{FallbackLoop, FallbackLoopStep, OrchestrationRoutingRuntime, Orchestrator};
+pub use pool::{PoolOptions, PoolStats, ProcessPool};
 pub use proof::{
     AIAssistantConfig, AIProofAssistant, AutomationTier, HelperLemma, HelperProofStatus,
     LimitReason, ProofAttempt, ProofAutomation, ProofAutomationBuilder, ProofContext, ProofSession,
@@ -111,9 +118,10 @@ pub use reasoning::{
     DecisionNode, DecisionNodeId, DecisionNodeType, DecisionPath, DecisionPoint, DecisionTree,
     DotConfig, HtmlConfig, HtmlTheme, NetworkXGraph, NetworkXGraphAttrs, NetworkXLink,
     NetworkXNode, OptionStatus, ReasoningTrace, ReasoningTraceStore, TraceAnalyzer,
-    TraceComparison, TraceEdge, TraceEdgeLabel, TraceId, TraceQuery, TraceStats, TraceStoreStats,
+    TraceComparison, TraceEdge, TraceEdgeLabel, TraceId, TraceQuery, TraceSaveResult, TraceStats,
+    TraceStoreStats,
 };
-pub use repl::{ExecuteResult, ReplConfig, ReplHandle, ReplPool};
+pub use repl::{ExecuteResult, PendingReply, ReplConfig, ReplHandle, ReplPool, ReplStartupMode};
 pub use signature::{
     apply_defaults, validate_fields, validate_value, ExecutionLimits, ExecutionResult,
     FallbackConfig, FallbackExtractor, FallbackTrigger, FieldSpec, FieldType, HistoryEntry,
@@ -123,6 +131,9 @@ pub use sync::{
     DriftReport, DriftType, DualTrackSync, FormalizationLevel, SyncDirection, SyncResult,
 };
 pub use topos::{
-    IndexBuilder, LeanRef, Link, LinkIndex, LinkType, ToposClient, ToposClientConfig, ToposRef,
+    IndexBuilder, LeanRef, Link, LinkIndex, LinkType, MappedLinkIndex, ToposClient,
+    ToposClientConfig, ToposRef,
+};
+pub use trajectory::{
+    EventFilter, SinkConfig, SinkFormat, TrajectoryEvent, TrajectoryEventType, TrajectorySink,
 };
-pub use trajectory::{TrajectoryEvent, TrajectoryEventType};
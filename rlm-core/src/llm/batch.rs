@@ -4,6 +4,8 @@
 //! - Configurable concurrency limits (SPEC-26.03)
 //! - Graceful error handling for partial failures (SPEC-26.04)
 //! - Order-preserving result collection
+//! - Adaptive per-provider admission control (see [`ProviderLimiter`])
+//! - Coalescing of identical in-flight requests, within and across batches
 //!
 //! # Example
 //!
@@ -24,17 +26,20 @@
 //! ```
 
 use std::collections::HashMap;
-use std::sync::Arc;
-use std::time::{Duration, Instant};
+use std::sync::{Arc, Mutex, OnceLock};
+use std::time::Duration;
 
-use futures::future::join_all;
+use futures::future::{join_all, BoxFuture, FutureExt, Shared};
 use serde::{Deserialize, Serialize};
-use tokio::sync::{Mutex, Semaphore};
+use tokio::sync::Semaphore;
 use tokio::time::sleep;
 
-use super::types::{ChatMessage, CompletionRequest, Provider};
+use super::cache::{CacheKey, ResponseCachePolicy};
+use super::limiter::{LimiterConfig, ProviderLimiter};
+use super::types::{ChatMessage, CompletionRequest, CompletionResponse, Provider};
 use super::LLMClient;
 use crate::error::{Error, Result};
+use crate::metrics::{self, Metric};
 
 /// Default maximum parallel queries.
 pub const DEFAULT_MAX_PARALLEL: usize = 5;
@@ -53,63 +58,22 @@ fn default_provider_rate_limits() -> HashMap<Provider, u32> {
     limits
 }
 
-#[derive(Debug, Clone, Copy)]
-struct ProviderWindowState {
-    window_start: Instant,
-    used: u32,
-}
-
-#[derive(Debug)]
-struct ProviderRateLimiter {
-    limits: HashMap<Provider, u32>,
-    window: Duration,
-    state: Mutex<HashMap<Provider, ProviderWindowState>>,
-}
-
-impl ProviderRateLimiter {
-    fn new(limits: HashMap<Provider, u32>, window: Duration) -> Self {
-        Self {
-            limits,
-            window,
-            state: Mutex::new(HashMap::new()),
-        }
-    }
-
-    async fn acquire(&self, provider: Provider) {
-        let limit = match self.limits.get(&provider).copied() {
-            Some(limit) if limit > 0 => limit,
-            _ => return,
-        };
-
-        loop {
-            let wait = {
-                let mut state = self.state.lock().await;
-                let entry = state.entry(provider).or_insert(ProviderWindowState {
-                    window_start: Instant::now(),
-                    used: 0,
-                });
-
-                let elapsed = entry.window_start.elapsed();
-                if elapsed >= self.window {
-                    entry.window_start = Instant::now();
-                    entry.used = 0;
-                }
-
-                if entry.used < limit {
-                    entry.used += 1;
-                    None
-                } else {
-                    Some(self.window.saturating_sub(elapsed))
-                }
-            };
+/// Outcome shared by every caller coalesced onto one request.
+type SharedOutcome = std::result::Result<CompletionResponse, String>;
+type InFlight = Mutex<HashMap<CacheKey, Shared<BoxFuture<'static, SharedOutcome>>>>;
 
-            if let Some(wait) = wait {
-                sleep(wait).await;
-            } else {
-                break;
-            }
-        }
-    }
+/// Rough token cost of a request, charged against a tokens-per-window budget
+/// before the real usage is known.
+fn estimate_request_tokens(request: &CompletionRequest) -> u32 {
+    let chars = request.system.as_ref().map_or(0, String::len)
+        + request
+            .messages
+            .iter()
+            .map(|m| m.content.len())
+            .sum::<usize>();
+    u32::try_from(chars / 4)
+        .unwrap_or(u32::MAX)
+        .saturating_add(request.max_tokens.unwrap_or(0))
 }
 
 /// Retry configuration for batched requests.
@@ -352,27 +316,27 @@ impl BatchedQueryResults {
 
 /// Executor for batched LLM queries (SPEC-26.02, SPEC-26.03).
 ///
-/// Uses a semaphore for concurrency control to respect rate limits.
+/// Each batch is bounded by its own `max_parallel` semaphore. Across batches,
+/// an executor-wide [`ProviderLimiter`] adapts concurrency to 429s and
+/// latency and enforces request and token budgets. Identical requests that
+/// the coalescing policy admits share one provider call while it is in flight.
 pub struct BatchExecutor<C: LLMClient> {
     client: Arc<C>,
     max_parallel: usize,
     retry_config: RetryConfig,
     retry_failures: bool,
     provider_rate_limits: HashMap<Provider, u32>,
+    provider_token_limits: HashMap<Provider, u32>,
     rate_limit_window: Duration,
+    coalesce: Option<ResponseCachePolicy>,
+    limiter: OnceLock<Arc<ProviderLimiter>>,
+    in_flight: Arc<InFlight>,
 }
 
 impl<C: LLMClient + 'static> BatchExecutor<C> {
     /// Create a new batch executor.
     pub fn new(client: C) -> Self {
-        Self {
-            client: Arc::new(client),
-            max_parallel: DEFAULT_MAX_PARALLEL,
-            retry_config: RetryConfig::default(),
-            retry_failures: true,
-            provider_rate_limits: default_provider_rate_limits(),
-            rate_limit_window: Duration::from_millis(DEFAULT_RATE_LIMIT_WINDOW_MS),
-        }
+        Self::from_arc(Arc::new(client))
     }
 
     /// Create from an Arc'd client.
@@ -383,13 +347,20 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
             retry_config: RetryConfig::default(),
             retry_failures: true,
             provider_rate_limits: default_provider_rate_limits(),
+            provider_token_limits: HashMap::new(),
             rate_limit_window: Duration::from_millis(DEFAULT_RATE_LIMIT_WINDOW_MS),
+            coalesce: Some(ResponseCachePolicy::default()),
+            limiter: OnceLock::new(),
+            in_flight: Arc::new(Mutex::new(HashMap::new())),
         }
     }
 
     /// Set the maximum parallel queries.
+    ///
+    /// This is also the ceiling (and starting point) of the adaptive limit.
     pub fn with_max_parallel(mut self, max: usize) -> Self {
         self.max_parallel = max.max(1);
+        self.limiter = OnceLock::new();
         self
     }
 
@@ -413,6 +384,15 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
     ) -> Self {
         self.provider_rate_limits
             .insert(provider, requests_per_minute);
+        self.limiter = OnceLock::new();
+        self
+    }
+
+    /// Set a tokens-per-window budget for one provider (0 = unlimited).
+    pub fn with_provider_token_limit(mut self, provider: Provider, tokens_per_minute: u32) -> Self {
+        self.provider_token_limits
+            .insert(provider, tokens_per_minute);
+        self.limiter = OnceLock::new();
         self
     }
 
@@ -421,6 +401,26 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
     /// The default is one minute. This is primarily useful for tests.
     pub fn with_rate_limit_window(mut self, window: Duration) -> Self {
         self.rate_limit_window = window;
+        self.limiter = OnceLock::new();
+        self
+    }
+
+    /// Set which duplicate requests may share one in-flight call
+    /// (`None` disables coalescing).
+    ///
+    /// The default, [`ResponseCachePolicy::DeterministicOnly`], only
+    /// coalesces `temperature == 0.0` requests so sampling stays independent.
+    pub fn with_coalescing(mut self, policy: Option<ResponseCachePolicy>) -> Self {
+        self.coalesce = policy;
+        self
+    }
+
+    /// Use `limiter` instead of one built from this executor's settings,
+    /// e.g. to share adaptive state between executors for one provider.
+    ///
+    /// Later limit-related builder calls replace it again.
+    pub fn with_limiter(mut self, limiter: Arc<ProviderLimiter>) -> Self {
+        self.limiter = OnceLock::from(limiter);
         self
     }
 
@@ -430,10 +430,32 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
         self.retry_failures = config.retry_failures;
         self.retry_config = config.retry_config;
         self.provider_rate_limits = config.provider_rate_limits;
+        self.provider_token_limits = config.provider_token_limits;
         self.rate_limit_window = Duration::from_millis(config.rate_limit_window_ms.max(1));
+        self.coalesce = config.coalesce;
+        self.limiter = OnceLock::new();
         self
     }
 
+    /// The limiter governing this executor's provider, created on first use.
+    pub fn limiter(&self) -> Arc<ProviderLimiter> {
+        Arc::clone(self.limiter.get_or_init(|| {
+            let provider = self.client.provider();
+            let per_provider =
+                |limits: &HashMap<Provider, u32>| limits.get(&provider).copied().unwrap_or(0);
+            ProviderLimiter::new(
+                provider,
+                LimiterConfig {
+                    requests_per_window: per_provider(&self.provider_rate_limits),
+                    tokens_per_window: per_provider(&self.provider_token_limits),
+                    window_ms: self.rate_limit_window.as_millis().max(1) as u64,
+                    max_concurrency: self.max_parallel,
+                    ..LimiterConfig::default()
+                },
+            )
+        }))
+    }
+
     fn is_retryable_error(error: &Error) -> bool {
         match error {
             Error::Timeout { .. } => true,
@@ -445,25 +467,65 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
 
     fn is_retryable_message(message: &str) -> bool {
         let lower = message.to_ascii_lowercase();
+        Self::is_rate_limit_message(&lower)
+            || lower.contains("temporarily unavailable")
+            || lower.contains("timeout")
+    }
+
+    fn is_rate_limit_message(lower: &str) -> bool {
         lower.contains("429")
             || lower.contains("rate limit")
             || lower.contains("rate_limit")
             || lower.contains("too many requests")
-            || lower.contains("temporarily unavailable")
-            || lower.contains("timeout")
+    }
+
+    /// The provider's rate-limit signal, with its `retry-after` hint if the
+    /// client included one (see `client::retry_after_hint`).
+    fn rate_limit_signal(error: &Error) -> Option<Option<Duration>> {
+        let message = match error {
+            Error::LLM(message) | Error::LlmApi { message, .. } => message.to_ascii_lowercase(),
+            _ => return None,
+        };
+        if !Self::is_rate_limit_message(&message) {
+            return None;
+        }
+        let retry_after = message
+            .split_once("retry-after: ")
+            .and_then(|(_, rest)| rest.split_once('s'))
+            .and_then(|(secs, _)| secs.trim().parse::<f64>().ok())
+            .filter(|secs| secs.is_finite() && *secs >= 0.0)
+            .map(Duration::from_secs_f64);
+        Some(retry_after)
     }
 
     async fn complete_with_retry(
         client: Arc<C>,
+        limiter: Arc<ProviderLimiter>,
         request: CompletionRequest,
         retry_config: RetryConfig,
         retry_failures: bool,
-    ) -> Result<super::types::CompletionResponse> {
+    ) -> Result<CompletionResponse> {
+        let estimated_tokens = estimate_request_tokens(&request);
         let mut attempt = 0;
         loop {
-            match client.complete(request.clone()).await {
-                Ok(response) => return Ok(response),
+            let queued = metrics::Timer::start(Metric::LlmQueue);
+            let permit = limiter.acquire(estimated_tokens).await;
+            drop(queued);
+            let call = metrics::Timer::start(Metric::LlmCall);
+            let result = client.complete(request.clone()).await;
+            drop(call);
+            match result {
+                Ok(response) => {
+                    let used = u32::try_from(response.usage.total()).unwrap_or(u32::MAX);
+                    permit.record_success(used);
+                    return Ok(response);
+                }
                 Err(error) => {
+                    match Self::rate_limit_signal(&error) {
+                        Some(retry_after) => permit.record_throttled(retry_after),
+                        None => drop(permit),
+                    }
+
                     let should_retry = retry_failures
                         && attempt < retry_config.max_retries
                         && Self::is_retryable_error(&error);
@@ -479,9 +541,59 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
         }
     }
 
+    /// Send `request`, joining an identical in-flight request when the
+    /// coalescing policy allows. Returns the outcome and whether it was
+    /// coalesced.
+    async fn dispatch(&self, request: CompletionRequest) -> (SharedOutcome, bool) {
+        let limiter = self.limiter();
+        let coalesce = self.coalesce.is_some_and(|policy| policy.admits(&request));
+        let run = Self::complete_with_retry(
+            Arc::clone(&self.client),
+            Arc::clone(&limiter),
+            request.clone(),
+            self.retry_config.clone(),
+            self.retry_failures,
+        );
+        if !coalesce {
+            return (run.await.map_err(|e| e.to_string()), false);
+        }
+
+        let key = CacheKey::for_request(&request);
+        let (shared, coalesced) = {
+            // The map only holds handles to futures; a poisoned lock
+            // cannot leave it inconsistent.
+            let mut in_flight = self.in_flight.lock().unwrap_or_else(|e| e.into_inner());
+            match in_flight.get(&key) {
+                Some(existing) => (existing.clone(), true),
+                None => {
+                    let registry = Arc::clone(&self.in_flight);
+                    let leader_key = key.clone();
+                    let shared = async move {
+                        let outcome = run.await.map_err(|e| e.to_string());
+                        registry
+                            .lock()
+                            .unwrap_or_else(|e| e.into_inner())
+                            .remove(&leader_key);
+                        outcome
+                    }
+                    .boxed()
+                    .shared();
+                    in_flight.insert(key, shared.clone());
+                    (shared, false)
+                }
+            }
+        };
+        if coalesced {
+            limiter.record_coalesced();
+        }
+        (shared.await, coalesced)
+    }
+
     /// Execute a batched query with concurrency control (SPEC-26.03, SPEC-26.04).
     ///
     /// Returns results in the original order. Failed queries don't abort the batch.
+    /// A query coalesced onto another reports zero tokens, so `total_tokens`
+    /// counts each provider call once.
     pub async fn execute(&self, batch: BatchedLLMQuery) -> Result<BatchedQueryResults> {
         if batch.is_empty() {
             return Ok(BatchedQueryResults::from_results(Vec::new()));
@@ -490,11 +602,6 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
         // Use the smaller of batch config and executor config for max parallel
         let max_parallel = batch.max_parallel.min(self.max_parallel);
         let semaphore = Arc::new(Semaphore::new(max_parallel));
-        let provider = self.client.provider();
-        let rate_limiter = Arc::new(ProviderRateLimiter::new(
-            self.provider_rate_limits.clone(),
-            self.rate_limit_window,
-        ));
 
         // Create tasks for each prompt
         let tasks: Vec<_> = batch
@@ -502,16 +609,11 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
             .into_iter()
             .enumerate()
             .map(|(index, prompt)| {
-                let client = Arc::clone(&self.client);
                 let semaphore = Arc::clone(&semaphore);
                 let context = batch.contexts.get(index).cloned().flatten();
                 let model = batch.model.clone();
                 let temperature = batch.temperature;
                 let max_tokens = batch.max_tokens;
-                let provider = provider;
-                let rate_limiter = Arc::clone(&rate_limiter);
-                let retry_config = self.retry_config.clone();
-                let retry_failures = self.retry_failures;
 
                 async move {
                     // Acquire semaphore permit
@@ -541,24 +643,18 @@ impl<C: LLMClient + 'static> BatchExecutor<C> {
                     // Add the prompt
                     request = request.with_message(ChatMessage::user(&prompt));
 
-                    // Respect provider-specific rate-limit policy before calling the provider.
-                    rate_limiter.acquire(provider).await;
-
-                    // Execute query with bounded exponential-backoff retries.
-                    match Self::complete_with_retry(
-                        Arc::clone(&client),
-                        request,
-                        retry_config,
-                        retry_failures,
-                    )
-                    .await
-                    {
-                        Ok(response) => {
-                            let text = response.content.clone();
-                            let tokens = Some(response.usage.total() as u32);
-                            BatchQueryResult::success(index, text, tokens)
+                    // The provider limiter gates each attempt; retries use
+                    // bounded exponential backoff.
+                    match self.dispatch(request).await {
+                        (Ok(response), coalesced) => {
+                            let tokens = if coalesced {
+                                0
+                            } else {
+                                response.usage.total() as u32
+                            };
+                            BatchQueryResult::success(index, response.content, Some(tokens))
                         }
-                        Err(e) => BatchQueryResult::failure(index, e.to_string()),
+                        (Err(e), _) => BatchQueryResult::failure(index, e),
                     }
                 }
             })
@@ -586,6 +682,16 @@ pub struct BatchConfig {
     pub retry_config: RetryConfig,
     /// Window duration used by provider rate limiting.
     pub rate_limit_window_ms: u64,
+    /// Provider-specific tokens-per-window budget (missing = unlimited).
+    #[serde(default)]
+    pub provider_token_limits: HashMap<Provider, u32>,
+    /// Which identical in-flight requests share one provider call.
+    #[serde(default = "default_coalesce")]
+    pub coalesce: Option<ResponseCachePolicy>,
+}
+
+fn default_coalesce() -> Option<ResponseCachePolicy> {
+    Some(ResponseCachePolicy::default())
 }
 
 impl Default for BatchConfig {
@@ -597,6 +703,8 @@ impl Default for BatchConfig {
             provider_rate_limits: default_provider_rate_limits(),
             retry_config: RetryConfig::default(),
             rate_limit_window_ms: DEFAULT_RATE_LIMIT_WINDOW_MS,
+            provider_token_limits: HashMap::new(),
+            coalesce: default_coalesce(),
         }
     }
 }
@@ -607,6 +715,7 @@ mod tests {
     use std::time::Instant;
 
     use async_trait::async_trait;
+    use tokio::sync::Mutex;
 
     use super::*;
     use crate::llm::{
@@ -738,6 +847,7 @@ mod tests {
     struct FlakyBatchClient {
         provider: Provider,
         fail_until: usize,
+        delay: Duration,
         calls: Arc<AtomicUsize>,
         call_times: Arc<Mutex<Vec<Instant>>>,
     }
@@ -747,10 +857,16 @@ mod tests {
             Self {
                 provider,
                 fail_until,
+                delay: Duration::ZERO,
                 calls: Arc::new(AtomicUsize::new(0)),
                 call_times: Arc::new(Mutex::new(Vec::new())),
             }
         }
+
+        fn with_delay(mut self, delay: Duration) -> Self {
+            self.delay = delay;
+            self
+        }
     }
 
     #[async_trait]
@@ -761,6 +877,9 @@ mod tests {
             drop(call_times);
 
             let call = self.calls.fetch_add(1, Ordering::SeqCst) + 1;
+            if !self.delay.is_zero() {
+                sleep(self.delay).await;
+            }
             if call <= self.fail_until {
                 return Err(Error::LLM("429 rate limit exceeded".to_string()));
             }
@@ -870,4 +989,90 @@ mod tests {
         assert_eq!(call_times.len(), 2);
         assert!(elapsed >= Duration::from_millis(15));
     }
+
+    #[tokio::test]
+    async fn test_duplicate_prompts_are_coalesced_within_a_batch() {
+        let client =
+            FlakyBatchClient::new(Provider::OpenAI, 0).with_delay(Duration::from_millis(20));
+        let calls = Arc::clone(&client.calls);
+        let executor = BatchExecutor::new(client).with_retry_failures(false);
+
+        let results = executor
+            .execute(
+                BatchedLLMQuery::new()
+                    .add_prompt("same")
+                    .add_prompt("same")
+                    .add_prompt("other")
+                    .add_prompt("same")
+                    .with_temperature(0.0),
+            )
+            .await
+            .expect("batch execution should succeed");
+
+        assert_eq!(calls.load(Ordering::SeqCst), 2);
+        assert_eq!(results.success_count, 4);
+        // Coalesced queries report no tokens of their own.
+        assert_eq!(results.total_tokens, 30);
+        assert_eq!(executor.limiter().snapshot().coalesced, 2);
+    }
+
+    #[tokio::test]
+    async fn test_coalescing_spans_concurrent_batches_and_respects_policy() {
+        let client =
+            FlakyBatchClient::new(Provider::OpenAI, 0).with_delay(Duration::from_millis(20));
+        let calls = Arc::clone(&client.calls);
+        let executor = BatchExecutor::new(client).with_retry_failures(false);
+        let batch = || BatchedLLMQuery::new().add_prompt("q").with_temperature(0.0);
+
+        let (a, b) = tokio::join!(executor.execute(batch()), executor.execute(batch()));
+        assert!(a.unwrap().all_succeeded() && b.unwrap().all_succeeded());
+        assert_eq!(calls.load(Ordering::SeqCst), 1);
+
+        // Sampled requests stay independent under the default policy.
+        let sampled = BatchedLLMQuery::new()
+            .add_prompt("q")
+            .add_prompt("q")
+            .with_temperature(0.7);
+        executor.execute(sampled).await.unwrap();
+        assert_eq!(calls.load(Ordering::SeqCst), 3);
+    }
+
+    #[tokio::test]
+    async fn test_rate_limit_responses_shrink_adaptive_concurrency() {
+        let client = FlakyBatchClient::new(Provider::Anthropic, 1);
+        let executor = BatchExecutor::new(client)
+            .with_max_parallel(8)
+            .with_retry_config(RetryConfig {
+                max_retries: 1,
+                base_delay_ms: 1,
+                backoff_factor: 1.0,
+            });
+
+        let results = executor
+            .execute(BatchedLLMQuery::new().add_prompt("q1"))
+            .await
+            .unwrap();
+        assert!(results.all_succeeded());
+
+        let snapshot = executor.limiter().snapshot();
+        assert_eq!(snapshot.throttled, 1);
+        assert!(snapshot.concurrency_limit < 5.0);
+        assert_eq!(snapshot.in_flight, 0);
+        assert_eq!(snapshot.requests_available.map(f64::floor), Some(58.0));
+    }
+
+    #[test]
+    fn test_rate_limit_signal_parses_retry_after() {
+        type Exec = BatchExecutor<FlakyBatchClient>;
+        let hinted = Error::LLM(
+            "Anthropic API error (rate_limit_error): slow down (retry-after: 2.5s)".to_string(),
+        );
+        assert_eq!(
+            Exec::rate_limit_signal(&hinted),
+            Some(Some(Duration::from_millis(2500)))
+        );
+        let bare = Error::LLM("OpenAI API error: Too Many Requests".to_string());
+        assert_eq!(Exec::rate_limit_signal(&bare), Some(None));
+        assert_eq!(Exec::rate_limit_signal(&Error::timeout(10)), None);
+    }
 }
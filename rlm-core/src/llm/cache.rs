@@ -1,16 +1,28 @@
-//! Prompt caching for LLM requests.
+//! Prompt and response caching for LLM requests.
 //!
 //! Provides cache key generation and hit tracking for prompt caching
-//! supported by providers like Anthropic.
+//! supported by providers like Anthropic, plus a local response cache that
+//! skips the provider entirely for repeated requests.
 
+use async_trait::async_trait;
 use chrono::{DateTime, Duration, Utc};
 use serde::{Deserialize, Serialize};
 use sha2::{Digest, Sha256};
-use std::collections::HashMap;
-use std::sync::Arc;
+use std::collections::{BTreeMap, HashMap};
+use std::io::Write;
+#[cfg(unix)]
+use std::os::unix::fs::OpenOptionsExt;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, MutexGuard};
 use tokio::sync::RwLock;
 
-use super::types::ChatMessage;
+use super::client::LLMClient;
+use super::types::{
+    ChatMessage, CompletionRequest, CompletionResponse, EmbeddingRequest, EmbeddingResponse,
+    ModelSpec, Provider, TokenUsage,
+};
+use crate::error::Result;
 
 /// Cache key for a prompt.
 #[derive(Debug, Clone, PartialEq, Eq, Hash, Serialize, Deserialize)]
@@ -39,6 +51,62 @@ impl CacheKey {
         CacheKey(format!("{:x}", hash))
     }
 
+    /// Generate a key identifying a complete request for response caching.
+    ///
+    /// Covers the model, every sampling parameter and the full prompt; each
+    /// field is length-prefixed so distinct requests cannot collide by
+    /// concatenation.
+    pub fn for_request(request: &CompletionRequest) -> Self {
+        fn field(hasher: &mut Sha256, tag: &[u8], value: Option<&[u8]>) {
+            hasher.update(tag);
+            match value {
+                Some(v) => {
+                    hasher.update((v.len() as u64).to_le_bytes());
+                    hasher.update(v);
+                }
+                None => hasher.update(u64::MAX.to_le_bytes()),
+            }
+        }
+
+        let mut hasher = Sha256::new();
+        field(
+            &mut hasher,
+            b"model",
+            request.model.as_deref().map(str::as_bytes),
+        );
+        let temperature = request.temperature.map(|t| t.to_bits().to_le_bytes());
+        field(
+            &mut hasher,
+            b"temperature",
+            temperature.as_ref().map(|t| &t[..]),
+        );
+        let max_tokens = request.max_tokens.map(|n| n.to_le_bytes());
+        field(
+            &mut hasher,
+            b"max_tokens",
+            max_tokens.as_ref().map(|n| &n[..]),
+        );
+        let stop_count = request
+            .stop
+            .as_ref()
+            .map(|s| (s.len() as u64).to_le_bytes());
+        field(&mut hasher, b"stop", stop_count.as_ref().map(|n| &n[..]));
+        for stop in request.stop.iter().flatten() {
+            field(&mut hasher, b"stop_seq", Some(stop.as_bytes()));
+        }
+        field(
+            &mut hasher,
+            b"system",
+            request.system.as_deref().map(str::as_bytes),
+        );
+        for msg in &request.messages {
+            field(&mut hasher, b"role", Some(&[msg.role as u8][..]));
+            field(&mut hasher, b"content", Some(msg.content.as_bytes()));
+        }
+
+        CacheKey(format!("{:x}", hasher.finalize()))
+    }
+
     /// Generate a cache key from raw content.
     pub fn from_content(content: &str) -> Self {
         let mut hasher = Sha256::new();
@@ -251,6 +319,362 @@ impl Default for PromptCache {
     }
 }
 
+/// Which requests a [`ResponseCache`] may serve from cache.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default, Serialize, Deserialize)]
+#[serde(rename_all = "snake_case")]
+pub enum ResponseCachePolicy {
+    /// Only requests with `temperature == 0.0`, whose completions are
+    /// expected to be reproducible.
+    #[default]
+    DeterministicOnly,
+    /// Every request, regardless of sampling temperature.
+    All,
+}
+
+impl ResponseCachePolicy {
+    /// Whether `request` may be answered with another request's response.
+    pub fn admits(&self, request: &CompletionRequest) -> bool {
+        match self {
+            Self::All => true,
+            Self::DeterministicOnly => request.temperature == Some(0.0),
+        }
+    }
+}
+
+/// Configuration for [`ResponseCache`].
+#[derive(Debug, Clone)]
+pub struct ResponseCacheConfig {
+    /// Maximum in-memory entries (0 disables the memory tier)
+    pub max_entries: usize,
+    /// Maximum approximate in-memory size in bytes
+    pub max_bytes: usize,
+    /// Entries older than this are ignored (None: never expire)
+    pub ttl: Option<Duration>,
+    /// Which requests are cacheable
+    pub policy: ResponseCachePolicy,
+    /// Optional directory for the on-disk tier, typically `llm_cache/` next
+    /// to the memory-store database
+    pub disk_dir: Option<PathBuf>,
+}
+
+impl Default for ResponseCacheConfig {
+    fn default() -> Self {
+        Self {
+            max_entries: 1024,
+            max_bytes: 64 * 1024 * 1024,
+            ttl: None,
+            policy: ResponseCachePolicy::DeterministicOnly,
+            disk_dir: None,
+        }
+    }
+}
+
+impl ResponseCacheConfig {
+    /// Store the on-disk tier in `llm_cache/` beside a memory-store database.
+    pub fn with_memory_store_path(mut self, db_path: impl AsRef<Path>) -> Self {
+        let parent = db_path
+            .as_ref()
+            .parent()
+            .map(Path::to_path_buf)
+            .unwrap_or_default();
+        self.disk_dir = Some(parent.join("llm_cache"));
+        self
+    }
+}
+
+/// A cached completion as stored on disk.
+#[derive(Serialize, Deserialize)]
+struct StoredResponse {
+    created_at: DateTime<Utc>,
+    response: CompletionResponse,
+}
+
+struct MemoryEntry {
+    stored: StoredResponse,
+    size: usize,
+    tick: u64,
+}
+
+/// In-memory LRU tier, ordered by last-access tick.
+#[derive(Default)]
+struct MemoryTier {
+    entries: HashMap<CacheKey, MemoryEntry>,
+    order: BTreeMap<u64, CacheKey>,
+    next_tick: u64,
+    bytes: usize,
+}
+
+impl MemoryTier {
+    fn touch(&mut self, key: &CacheKey) -> Option<&StoredResponse> {
+        let tick = self.next_tick;
+        let entry = self.entries.get_mut(key)?;
+        self.next_tick += 1;
+        self.order.remove(&entry.tick);
+        self.order.insert(tick, key.clone());
+        entry.tick = tick;
+        Some(&entry.stored)
+    }
+
+    fn remove(&mut self, key: &CacheKey) {
+        if let Some(entry) = self.entries.remove(key) {
+            self.order.remove(&entry.tick);
+            self.bytes -= entry.size;
+        }
+    }
+
+    fn insert(
+        &mut self,
+        key: CacheKey,
+        stored: StoredResponse,
+        max_entries: usize,
+        max_bytes: usize,
+    ) {
+        self.remove(&key);
+        let size = approximate_size(&stored.response);
+        if max_entries == 0 || size > max_bytes {
+            return;
+        }
+        while self.entries.len() >= max_entries || self.bytes + size > max_bytes {
+            let Some((_, oldest)) = self.order.pop_first() else {
+                break;
+            };
+            if let Some(entry) = self.entries.remove(&oldest) {
+                self.bytes -= entry.size;
+            }
+        }
+        let tick = self.next_tick;
+        self.next_tick += 1;
+        self.order.insert(tick, key.clone());
+        self.bytes += size;
+        self.entries.insert(key, MemoryEntry { stored, size, tick });
+    }
+}
+
+fn approximate_size(response: &CompletionResponse) -> usize {
+    response.id.len() + response.model.len() + response.content.len() + 128
+}
+
+/// Suffix counter for temporary disk-tier files.
+static NEXT_TMP: AtomicU64 = AtomicU64::new(0);
+
+/// Content-addressed cache of completed LLM responses.
+///
+/// Unlike [`PromptCache`], this stores the completion itself so an identical
+/// request never reaches the provider twice. Keys come from
+/// [`CacheKey::for_request`], so model, sampling parameters and the full
+/// prompt all participate. A size-bounded LRU sits in front of an optional
+/// on-disk tier that survives restarts.
+pub struct ResponseCache {
+    config: ResponseCacheConfig,
+    memory: Mutex<MemoryTier>,
+    stats: Mutex<CacheStats>,
+}
+
+impl ResponseCache {
+    /// Create a response cache.
+    pub fn new(config: ResponseCacheConfig) -> Self {
+        Self {
+            config,
+            memory: Mutex::new(MemoryTier::default()),
+            stats: Mutex::new(CacheStats::default()),
+        }
+    }
+
+    /// Cache configuration.
+    pub fn config(&self) -> &ResponseCacheConfig {
+        &self.config
+    }
+
+    /// Whether `request` may be served from or stored in the cache.
+    pub fn is_cacheable(&self, request: &CompletionRequest) -> bool {
+        self.config.policy.admits(request)
+    }
+
+    fn is_fresh(&self, stored: &StoredResponse) -> bool {
+        self.config
+            .ttl
+            .map_or(true, |ttl| Utc::now() - stored.created_at <= ttl)
+    }
+
+    fn lock_memory(&self) -> MutexGuard<'_, MemoryTier> {
+        // The tier is a cache; a panic mid-update at worst loses entries.
+        self.memory.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    fn lock_stats(&self) -> MutexGuard<'_, CacheStats> {
+        self.stats.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    /// Look up a cached response for `key`, recording a hit or miss.
+    pub fn get(&self, key: &CacheKey) -> Option<CompletionResponse> {
+        let found = self.get_memory(key).or_else(|| {
+            let stored = self.read_disk(key)?;
+            let response = stored.response.clone();
+            self.lock_memory().insert(
+                key.clone(),
+                stored,
+                self.config.max_entries,
+                self.config.max_bytes,
+            );
+            Some(response)
+        });
+
+        let mut stats = self.lock_stats();
+        match found {
+            Some(ref response) => stats.record_hit(
+                response.usage.input_tokens + response.usage.output_tokens,
+                response.cost.unwrap_or(0.0),
+            ),
+            None => stats.record_miss(),
+        }
+        found
+    }
+
+    fn get_memory(&self, key: &CacheKey) -> Option<CompletionResponse> {
+        let mut memory = self.lock_memory();
+        let fresh = memory
+            .touch(key)
+            .map(|stored| self.is_fresh(stored).then(|| stored.response.clone()))?;
+        if fresh.is_none() {
+            memory.remove(key);
+        }
+        fresh
+    }
+
+    /// Store a response under `key` in every configured tier.
+    pub fn put(&self, key: CacheKey, response: CompletionResponse) {
+        let stored = StoredResponse {
+            created_at: Utc::now(),
+            response,
+        };
+        self.write_disk(&key, &stored);
+        let mut memory = self.lock_memory();
+        memory.insert(key, stored, self.config.max_entries, self.config.max_bytes);
+        self.lock_stats().entry_count = memory.entries.len() as u64;
+    }
+
+    fn disk_path(&self, key: &CacheKey) -> Option<PathBuf> {
+        let dir = self.config.disk_dir.as_ref()?;
+        let shard = key.0.get(..2).unwrap_or("00");
+        Some(dir.join(shard).join(format!("{}.json", key.0)))
+    }
+
+    fn read_disk(&self, key: &CacheKey) -> Option<StoredResponse> {
+        let path = self.disk_path(key)?;
+        let bytes = std::fs::read(&path).ok()?;
+        match serde_json::from_slice::<StoredResponse>(&bytes) {
+            Ok(stored) if self.is_fresh(&stored) => Some(stored),
+            _ => {
+                let _ = std::fs::remove_file(&path);
+                None
+            }
+        }
+    }
+
+    fn write_disk(&self, key: &CacheKey, stored: &StoredResponse) {
+        let Some(path) = self.disk_path(key) else {
+            return;
+        };
+        // Write-then-rename so concurrent readers never see a torn entry. The
+        // temporary name is unique per write, so writers in this process and
+        // others never share one, and entries are private to the user.
+        let tmp = path.with_extension(format!(
+            "tmp{}-{}",
+            std::process::id(),
+            NEXT_TMP.fetch_add(1, Ordering::Relaxed)
+        ));
+        let result = (|| -> std::io::Result<()> {
+            if let Some(parent) = path.parent() {
+                std::fs::create_dir_all(parent)?;
+            }
+            let bytes = serde_json::to_vec(stored)?;
+            let mut options = std::fs::OpenOptions::new();
+            options.write(true).create_new(true);
+            #[cfg(unix)]
+            options.mode(0o600);
+            options.open(&tmp)?.write_all(&bytes)?;
+            std::fs::rename(&tmp, &path)
+        })();
+        if let Err(e) = result {
+            let _ = std::fs::remove_file(&tmp);
+            tracing::warn!("Failed to persist LLM response cache entry: {}", e);
+        }
+    }
+
+    /// Hit/miss statistics. `cached_tokens` counts tokens served from cache
+    /// and `estimated_savings` the provider cost avoided.
+    pub fn stats(&self) -> CacheStats {
+        self.lock_stats().clone()
+    }
+
+    /// Drop all in-memory entries and reset statistics. The disk tier is kept.
+    pub fn clear(&self) {
+        *self.lock_memory() = MemoryTier::default();
+        *self.lock_stats() = CacheStats::default();
+    }
+}
+
+/// [`LLMClient`] wrapper that serves repeated requests from a
+/// [`ResponseCache`].
+///
+/// A cache hit returns the stored completion with zero usage and cost, since
+/// no provider was called: rate limiters, budgets and `CostTracker`s that
+/// record the response charge nothing for it. Tokens and cost avoided are
+/// reported by [`ResponseCache::stats`] instead.
+pub struct CachingClient<C> {
+    inner: C,
+    cache: Arc<ResponseCache>,
+}
+
+impl<C: LLMClient> CachingClient<C> {
+    /// Wrap `inner` with `cache`. The cache may be shared between clients.
+    pub fn new(inner: C, cache: Arc<ResponseCache>) -> Self {
+        Self { inner, cache }
+    }
+
+    /// The shared response cache.
+    pub fn cache(&self) -> &Arc<ResponseCache> {
+        &self.cache
+    }
+
+    /// The wrapped client.
+    pub fn inner(&self) -> &C {
+        &self.inner
+    }
+}
+
+#[async_trait]
+impl<C: LLMClient> LLMClient for CachingClient<C> {
+    async fn complete(&self, request: CompletionRequest) -> Result<CompletionResponse> {
+        if !self.cache.is_cacheable(&request) {
+            return self.inner.complete(request).await;
+        }
+
+        let key = CacheKey::for_request(&request);
+        if let Some(mut response) = self.cache.get(&key) {
+            response.usage = TokenUsage::default();
+            response.cost = Some(0.0);
+            return Ok(response);
+        }
+
+        let response = self.inner.complete(request).await?;
+        self.cache.put(key, response.clone());
+        Ok(response)
+    }
+
+    async fn embed(&self, request: EmbeddingRequest) -> Result<EmbeddingResponse> {
+        self.inner.embed(request).await
+    }
+
+    fn provider(&self) -> Provider {
+        self.inner.provider()
+    }
+
+    fn available_models(&self) -> Vec<ModelSpec> {
+        self.inner.available_models()
+    }
+}
+
 /// Determine optimal cache breakpoints in a message sequence.
 ///
 /// Anthropic caching requires minimum 1024 tokens for cache-eligible content.
@@ -298,6 +722,7 @@ pub fn apply_cache_markers(messages: &mut [ChatMessage], breakpoints: &[usize])
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::error::Error;
     use crate::llm::types::ChatRole;
 
     #[test]
@@ -407,6 +832,205 @@ mod tests {
         assert!(messages[2].cache_control.is_none());
     }
 
+    #[test]
+    fn test_request_key_covers_sampling_parameters() {
+        let base = CompletionRequest::new()
+            .with_model("m")
+            .with_temperature(0.0)
+            .with_message(ChatMessage::user("Hello"));
+        let key = CacheKey::for_request(&base);
+
+        assert_eq!(key, CacheKey::for_request(&base.clone()));
+        assert_ne!(
+            key,
+            CacheKey::for_request(&base.clone().with_model("other"))
+        );
+        assert_ne!(
+            key,
+            CacheKey::for_request(&base.clone().with_temperature(0.5))
+        );
+        assert_ne!(
+            key,
+            CacheKey::for_request(&base.clone().with_max_tokens(10))
+        );
+        assert_ne!(key, CacheKey::for_request(&base.clone().with_system("s")));
+    }
+
+    struct CountingClient {
+        calls: std::sync::atomic::AtomicUsize,
+    }
+
+    #[async_trait]
+    impl LLMClient for CountingClient {
+        async fn complete(&self, request: CompletionRequest) -> Result<CompletionResponse> {
+            let call = self.calls.fetch_add(1, std::sync::atomic::Ordering::SeqCst);
+            Ok(CompletionResponse {
+                id: format!("resp-{call}"),
+                model: request.model.unwrap_or_default(),
+                content: format!("answer {call}"),
+                stop_reason: None,
+                usage: TokenUsage {
+                    input_tokens: 100,
+                    output_tokens: 20,
+                    cache_read_tokens: None,
+                    cache_creation_tokens: None,
+                },
+                timestamp: Utc::now(),
+                cost: Some(0.01),
+            })
+        }
+
+        async fn embed(&self, _request: EmbeddingRequest) -> Result<EmbeddingResponse> {
+            Err(Error::LLM(
+                "embedding not implemented in test mock".to_string(),
+            ))
+        }
+
+        fn provider(&self) -> Provider {
+            Provider::Anthropic
+        }
+
+        fn available_models(&self) -> Vec<ModelSpec> {
+            vec![]
+        }
+    }
+
+    fn counting_client(cache: Arc<ResponseCache>) -> CachingClient<CountingClient> {
+        CachingClient::new(
+            CountingClient {
+                calls: std::sync::atomic::AtomicUsize::new(0),
+            },
+            cache,
+        )
+    }
+
+    #[tokio::test]
+    async fn test_caching_client_serves_deterministic_repeats() {
+        let cache = Arc::new(ResponseCache::new(ResponseCacheConfig::default()));
+        let client = counting_client(Arc::clone(&cache));
+        let request = CompletionRequest::new()
+            .with_model("m")
+            .with_temperature(0.0)
+            .with_message(ChatMessage::user("Q"));
+
+        let first = client.complete(request.clone()).await.unwrap();
+        let second = client.complete(request.clone()).await.unwrap();
+        assert_eq!(first.content, second.content);
+        assert_eq!(second.usage.input_tokens, 0);
+        assert_eq!(second.usage.output_tokens, 0);
+        assert_eq!(second.usage.cache_read_tokens, None);
+        assert_eq!(second.cost, Some(0.0));
+
+        // Sampled requests bypass the cache under the default policy.
+        client
+            .complete(request.with_temperature(0.7))
+            .await
+            .unwrap();
+        assert_eq!(
+            client
+                .inner()
+                .calls
+                .load(std::sync::atomic::Ordering::SeqCst),
+            2
+        );
+
+        // The hit is reported through the cache, not the response.
+        let stats = cache.stats();
+        assert_eq!(stats.hits, 1);
+        assert_eq!(stats.misses, 1);
+        assert_eq!(stats.cached_tokens, 120);
+        assert!((stats.estimated_savings - 0.01).abs() < 1e-12);
+
+        let mut tracker = crate::llm::CostTracker::new();
+        tracker.record(&second.model, &second.usage, second.cost);
+        assert_eq!(tracker.total_input_tokens, 0);
+        assert_eq!(tracker.total_output_tokens, 0);
+    }
+
+    fn response(content: &str) -> CompletionResponse {
+        CompletionResponse {
+            id: "id".to_string(),
+            model: "m".to_string(),
+            content: content.to_string(),
+            stop_reason: None,
+            usage: TokenUsage::default(),
+            timestamp: Utc::now(),
+            cost: None,
+        }
+    }
+
+    #[test]
+    fn test_response_cache_evicts_least_recently_used() {
+        let cache = ResponseCache::new(ResponseCacheConfig {
+            max_entries: 2,
+            ..ResponseCacheConfig::default()
+        });
+        let (a, b, c) = (
+            CacheKey::from_content("a"),
+            CacheKey::from_content("b"),
+            CacheKey::from_content("c"),
+        );
+        cache.put(a.clone(), response("a"));
+        cache.put(b.clone(), response("b"));
+        assert!(cache.get(&a).is_some());
+        cache.put(c.clone(), response("c"));
+
+        assert!(cache.get(&b).is_none());
+        assert_eq!(cache.get(&a).unwrap().content, "a");
+        assert_eq!(cache.get(&c).unwrap().content, "c");
+    }
+
+    #[test]
+    fn test_response_cache_disk_tier_survives_restart() {
+        let dir = tempfile::tempdir().unwrap();
+        let config =
+            ResponseCacheConfig::default().with_memory_store_path(dir.path().join("memory.db"));
+        let key = CacheKey::from_content("persisted");
+
+        ResponseCache::new(config.clone()).put(key.clone(), response("saved"));
+        let reopened = ResponseCache::new(config);
+        assert_eq!(reopened.get(&key).unwrap().content, "saved");
+        assert!(dir.path().join("llm_cache").is_dir());
+    }
+
+    #[test]
+    fn test_response_cache_disk_writes_are_private_and_race_free() {
+        let dir = tempfile::tempdir().unwrap();
+        let config =
+            ResponseCacheConfig::default().with_memory_store_path(dir.path().join("memory.db"));
+        let cache = Arc::new(ResponseCache::new(config.clone()));
+        let key = CacheKey::from_content("contended");
+
+        let handles: Vec<_> = (0..8)
+            .map(|i| {
+                let cache = Arc::clone(&cache);
+                let key = key.clone();
+                std::thread::spawn(move || cache.put(key, response(&format!("writer {}", i))))
+            })
+            .collect();
+        for handle in handles {
+            handle.join().unwrap();
+        }
+
+        let path = cache.disk_path(&key).unwrap();
+        let entries: Vec<_> = std::fs::read_dir(path.parent().unwrap())
+            .unwrap()
+            .map(|e| e.unwrap().path())
+            .collect();
+        assert_eq!(entries, [path.clone()], "no temporary files are left");
+        assert!(ResponseCache::new(config)
+            .get(&key)
+            .unwrap()
+            .content
+            .starts_with("writer "));
+        #[cfg(unix)]
+        {
+            use std::os::unix::fs::PermissionsExt;
+            let mode = std::fs::metadata(&path).unwrap().permissions().mode();
+            assert_eq!(mode & 0o777, 0o600);
+        }
+    }
+
     #[tokio::test]
     async fn test_cache_cleanup() {
         let cache = PromptCache::new().with_ttl(Duration::zero());
@@ -17,6 +17,20 @@ use super::types::{
     Provider, StopReason, TokenUsage,
 };
 
+/// Format a response's `Retry-After` header as an error-message suffix.
+///
+/// The batch executor reads it back to pause its provider limiter. Only the
+/// delay-seconds form is recognised; HTTP dates are ignored.
+fn retry_after_hint(response: &reqwest::Response) -> String {
+    response
+        .headers()
+        .get(reqwest::header::RETRY_AFTER)
+        .and_then(|value| value.to_str().ok())
+        .and_then(|value| value.trim().parse::<f64>().ok())
+        .map(|secs| format!(" (retry-after: {}s)", secs))
+        .unwrap_or_default()
+}
+
 /// LLM client trait for making completions and embeddings.
 #[async_trait]
 pub trait LLMClient: Send + Sync {
@@ -219,6 +233,7 @@ impl LLMClient for AnthropicClient {
             .map_err(|e| Error::LLM(format!("HTTP request failed: {}", e)))?;
 
         let status = response.status();
+        let retry_after = retry_after_hint(&response);
         let body = response
             .text()
             .await
@@ -227,13 +242,13 @@ impl LLMClient for AnthropicClient {
         if !status.is_success() {
             if let Ok(error) = serde_json::from_str::<AnthropicError>(&body) {
                 return Err(Error::LLM(format!(
-                    "Anthropic API error ({}): {}",
-                    error.error.error_type, error.error.message
+                    "Anthropic API error ({}): {}{}",
+                    error.error.error_type, error.error.message, retry_after
                 )));
             }
             return Err(Error::LLM(format!(
-                "Anthropic API error ({}): {}",
-                status, body
+                "Anthropic API error ({}): {}{}",
+                status, body, retry_after
             )));
         }
 
@@ -455,6 +470,7 @@ impl LLMClient for OpenAIClient {
             .map_err(|e| Error::LLM(format!("HTTP request failed: {}", e)))?;
 
         let status = response.status();
+        let retry_after = retry_after_hint(&response);
         let body = response
             .text()
             .await
@@ -463,13 +479,13 @@ impl LLMClient for OpenAIClient {
         if !status.is_success() {
             if let Ok(error) = serde_json::from_str::<OpenAIError>(&body) {
                 return Err(Error::LLM(format!(
-                    "OpenAI API error: {}",
-                    error.error.message
+                    "OpenAI API error: {}{}",
+                    error.error.message, retry_after
                 )));
             }
             return Err(Error::LLM(format!(
-                "OpenAI API error ({}): {}",
-                status, body
+                "OpenAI API error ({}): {}{}",
+                status, body, retry_after
             )));
         }
 
@@ -537,6 +553,7 @@ impl LLMClient for OpenAIClient {
             .map_err(|e| Error::LLM(format!("HTTP request failed: {}", e)))?;
 
         let status = response.status();
+        let retry_after = retry_after_hint(&response);
         let body = response
             .text()
             .await
@@ -545,13 +562,13 @@ impl LLMClient for OpenAIClient {
         if !status.is_success() {
             if let Ok(error) = serde_json::from_str::<OpenAIError>(&body) {
                 return Err(Error::LLM(format!(
-                    "OpenAI API error: {}",
-                    error.error.message
+                    "OpenAI API error: {}{}",
+                    error.error.message, retry_after
                 )));
             }
             return Err(Error::LLM(format!(
-                "OpenAI API error ({}): {}",
-                status, body
+                "OpenAI API error ({}): {}{}",
+                status, body, retry_after
             )));
         }
 
@@ -744,6 +761,7 @@ impl LLMClient for GoogleClient {
             .map_err(|e| Error::LLM(format!("HTTP request failed: {}", e)))?;
 
         let status = response.status();
+        let retry_after = retry_after_hint(&response);
         let body = response
             .text()
             .await
@@ -752,13 +770,13 @@ impl LLMClient for GoogleClient {
         if !status.is_success() {
             if let Ok(error) = serde_json::from_str::<GeminiError>(&body) {
                 return Err(Error::LLM(format!(
-                    "Gemini API error: {}",
-                    error.error.message
+                    "Gemini API error: {}{}",
+                    error.error.message, retry_after
                 )));
             }
             return Err(Error::LLM(format!(
-                "Gemini API error ({}): {}",
-                status, body
+                "Gemini API error ({}): {}{}",
+                status, body, retry_after
             )));
         }
 
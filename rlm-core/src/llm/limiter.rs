@@ -0,0 +1,594 @@
+//! Adaptive per-provider admission control for LLM requests.
+//!
+//! A [`ProviderLimiter`] admits a request only when all of its gates allow it:
+//!
+//! - **Concurrency**: an AIMD limit on in-flight requests. Each success
+//!   raises it by `1/limit` (about +1 per round trip at full load). A
+//!   rate-limit response, or smoothed latency well above the long-run
+//!   baseline, cuts it multiplicatively. At most one cut happens per smoothed round trip,
+//!   so a burst of 429s from one wave counts once.
+//! - **Requests per window** and **tokens per window**: token buckets that
+//!   refill continuously. The token bucket is charged an estimate up front and
+//!   corrected with the real usage afterwards.
+//! - **Retry-After**: a provider-requested pause holds back all admissions
+//!   until it expires.
+//!
+//! Every live limiter registers itself, so [`limiter_snapshots`] can report
+//! process-wide state (exposed over FFI as `rlm_llm_limiter_state_json`).
+
+use serde::{Deserialize, Serialize};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, MutexGuard, OnceLock, Weak};
+use std::time::{Duration, Instant};
+use tokio::sync::Notify;
+
+use super::types::Provider;
+
+/// Multiplicative cut applied when latency, not a 429, signals overload.
+const LATENCY_BACKOFF: f64 = 0.9;
+/// Latency inflation below this many milliseconds is treated as noise.
+const LATENCY_SLACK_MS: f64 = 50.0;
+/// Weight of the newest sample in the smoothed latency.
+const LATENCY_EWMA_ALPHA: f64 = 0.2;
+/// Weight of the newest sample in the baseline latency. The baseline follows
+/// the workload's own mix of short and long completions (about 20 samples),
+/// so only a recent rise relative to it reads as overload; an all-time
+/// minimum would be pinned by one short completion and cut forever.
+const LATENCY_BASELINE_ALPHA: f64 = 0.05;
+
+static REGISTRY: OnceLock<Mutex<Vec<Weak<ProviderLimiter>>>> = OnceLock::new();
+static NEXT_LIMITER: AtomicU64 = AtomicU64::new(0);
+
+/// Configuration for a [`ProviderLimiter`].
+#[derive(Debug, Clone, Serialize, Deserialize)]
+#[serde(default)]
+pub struct LimiterConfig {
+    /// Requests admitted per window (0 = unlimited).
+    pub requests_per_window: u32,
+    /// Tokens (input + output) admitted per window (0 = unlimited).
+    pub tokens_per_window: u32,
+    /// Window over which the per-window budgets refill.
+    pub window_ms: u64,
+    /// Lower bound for the adaptive concurrency limit.
+    pub min_concurrency: usize,
+    /// Upper bound for the adaptive concurrency limit, and its starting value.
+    pub max_concurrency: usize,
+    /// Factor applied to the concurrency limit on a rate-limit response.
+    pub backoff_ratio: f64,
+    /// Smoothed latency above `latency_tolerance x` the baseline counts as overload.
+    pub latency_tolerance: f64,
+}
+
+impl Default for LimiterConfig {
+    fn default() -> Self {
+        Self {
+            requests_per_window: 0,
+            tokens_per_window: 0,
+            window_ms: super::batch::DEFAULT_RATE_LIMIT_WINDOW_MS,
+            min_concurrency: 1,
+            max_concurrency: super::batch::DEFAULT_MAX_PARALLEL,
+            backoff_ratio: 0.5,
+            latency_tolerance: 2.0,
+        }
+    }
+}
+
+/// Point-in-time view of a limiter, for dashboards.
+#[derive(Debug, Clone, Serialize, Deserialize)]
+pub struct LimiterSnapshot {
+    /// Process-unique limiter id.
+    pub id: u64,
+    /// Provider this limiter governs.
+    pub provider: Provider,
+    /// Current adaptive concurrency limit.
+    pub concurrency_limit: f64,
+    /// Requests currently holding a permit.
+    pub in_flight: usize,
+    /// Requests waiting for admission.
+    pub waiting: usize,
+    /// Request budget left in the bucket (None if unlimited).
+    pub requests_available: Option<f64>,
+    /// Token budget left in the bucket (None if unlimited; may be negative).
+    pub tokens_available: Option<f64>,
+    /// Remaining provider-requested pause.
+    pub paused_for_ms: Option<u64>,
+    /// Smoothed request latency.
+    pub latency_ewma_ms: Option<f64>,
+    /// Slowly adapting latency baseline the smoothed latency is compared to.
+    pub latency_baseline_ms: Option<f64>,
+    /// Requests admitted so far.
+    pub admitted: u64,
+    /// Rate-limit responses seen so far.
+    pub throttled: u64,
+    /// Duplicate requests that joined an in-flight request instead.
+    pub coalesced: u64,
+    /// The configuration in effect.
+    pub config: LimiterConfig,
+}
+
+#[derive(Debug)]
+struct TokenBucket {
+    capacity: f64,
+    available: f64,
+    refill_per_sec: f64,
+    last_refill: Instant,
+}
+
+impl TokenBucket {
+    fn new(per_window: u32, window: Duration) -> Option<Self> {
+        if per_window == 0 {
+            return None;
+        }
+        let capacity = f64::from(per_window);
+        Some(Self {
+            capacity,
+            available: capacity,
+            refill_per_sec: capacity / window.as_secs_f64().max(1e-3),
+            last_refill: Instant::now(),
+        })
+    }
+
+    fn refill(&mut self, now: Instant) {
+        let elapsed = now
+            .saturating_duration_since(self.last_refill)
+            .as_secs_f64();
+        self.available = (self.available + elapsed * self.refill_per_sec).min(self.capacity);
+        self.last_refill = now;
+    }
+
+    /// Time until `amount` is available (zero if it is now). Requests larger
+    /// than the bucket only wait for a full bucket.
+    fn wait_for(&self, amount: f64) -> Duration {
+        let deficit = amount.min(self.capacity) - self.available;
+        if deficit <= 0.0 {
+            Duration::ZERO
+        } else {
+            Duration::from_secs_f64(deficit / self.refill_per_sec)
+        }
+    }
+
+    fn adjust(&mut self, delta: f64) {
+        self.available = (self.available + delta).min(self.capacity);
+    }
+}
+
+#[derive(Debug)]
+struct LimiterState {
+    limit: f64,
+    in_flight: usize,
+    waiting: usize,
+    requests: Option<TokenBucket>,
+    tokens: Option<TokenBucket>,
+    paused_until: Option<Instant>,
+    latency_ewma_ms: Option<f64>,
+    latency_baseline_ms: Option<f64>,
+    last_decrease: Option<Instant>,
+    admitted: u64,
+    throttled: u64,
+    coalesced: u64,
+}
+
+impl LimiterState {
+    /// Cut the limit by `factor`, unless it was already cut within the last
+    /// smoothed round trip.
+    fn decrease(&mut self, factor: f64, min: f64, now: Instant) {
+        let cooldown = Duration::from_secs_f64(self.latency_ewma_ms.unwrap_or(0.0) / 1000.0);
+        if self
+            .last_decrease
+            .is_some_and(|at| now.saturating_duration_since(at) < cooldown)
+        {
+            return;
+        }
+        self.limit = (self.limit * factor).max(min);
+        self.last_decrease = Some(now);
+    }
+
+    /// Fold a successful request's latency into the averages and adjust
+    /// the limit: cut it if latency is inflated against the baseline,
+    /// otherwise grow it additively.
+    fn observe_success(&mut self, latency_ms: f64, config: &LimiterConfig, now: Instant) {
+        let (ewma, baseline) = match (self.latency_ewma_ms, self.latency_baseline_ms) {
+            (Some(ewma), Some(baseline)) => (
+                ewma + LATENCY_EWMA_ALPHA * (latency_ms - ewma),
+                baseline + LATENCY_BASELINE_ALPHA * (latency_ms - baseline),
+            ),
+            _ => (latency_ms, latency_ms),
+        };
+        self.latency_ewma_ms = Some(ewma);
+        self.latency_baseline_ms = Some(baseline);
+
+        if ewma > baseline * config.latency_tolerance && ewma - baseline > LATENCY_SLACK_MS {
+            self.decrease(LATENCY_BACKOFF, config.min_concurrency as f64, now);
+        } else {
+            self.limit = (self.limit + 1.0 / self.limit).min(config.max_concurrency as f64);
+        }
+    }
+}
+
+/// Adaptive concurrency plus request and token budgets for one provider.
+#[derive(Debug)]
+pub struct ProviderLimiter {
+    id: u64,
+    provider: Provider,
+    config: LimiterConfig,
+    state: Mutex<LimiterState>,
+    changed: Notify,
+}
+
+/// Admission granted by [`ProviderLimiter::acquire`].
+///
+/// Report the outcome with [`Self::record_success`] or
+/// [`Self::record_throttled`]; dropping the permit without either releases
+/// the slot without adjusting the limit.
+#[derive(Debug)]
+pub struct LimiterPermit {
+    limiter: Arc<ProviderLimiter>,
+    estimated_tokens: u32,
+    started: Instant,
+}
+
+/// Keeps [`LimiterSnapshot::waiting`] accurate even if an `acquire` future
+/// is cancelled.
+struct WaitingGuard<'a>(&'a ProviderLimiter);
+
+impl Drop for WaitingGuard<'_> {
+    fn drop(&mut self) {
+        self.0.lock_state().waiting -= 1;
+    }
+}
+
+enum Admission {
+    Granted,
+    WaitFor(Duration),
+    WaitForRelease,
+}
+
+impl ProviderLimiter {
+    /// Create and register a limiter.
+    pub fn new(provider: Provider, mut config: LimiterConfig) -> Arc<Self> {
+        config.min_concurrency = config.min_concurrency.max(1);
+        config.max_concurrency = config.max_concurrency.max(config.min_concurrency);
+        config.backoff_ratio = config.backoff_ratio.clamp(0.05, 1.0);
+        config.latency_tolerance = config.latency_tolerance.max(1.0);
+
+        let window = Duration::from_millis(config.window_ms.max(1));
+        let limiter = Arc::new(Self {
+            id: NEXT_LIMITER.fetch_add(1, Ordering::Relaxed),
+            provider,
+            state: Mutex::new(LimiterState {
+                limit: config.max_concurrency as f64,
+                in_flight: 0,
+                waiting: 0,
+                requests: TokenBucket::new(config.requests_per_window, window),
+                tokens: TokenBucket::new(config.tokens_per_window, window),
+                paused_until: None,
+                latency_ewma_ms: None,
+                latency_baseline_ms: None,
+                last_decrease: None,
+                admitted: 0,
+                throttled: 0,
+                coalesced: 0,
+            }),
+            config,
+            changed: Notify::new(),
+        });
+
+        let mut registry = lock_registry();
+        registry.retain(|weak| weak.strong_count() > 0);
+        registry.push(Arc::downgrade(&limiter));
+        drop(registry);
+        limiter
+    }
+
+    /// Provider this limiter governs.
+    pub fn provider(&self) -> Provider {
+        self.provider
+    }
+
+    /// The configuration in effect (after clamping).
+    pub fn config(&self) -> &LimiterConfig {
+        &self.config
+    }
+
+    fn lock_state(&self) -> MutexGuard<'_, LimiterState> {
+        // State is plain counters; a panic mid-update cannot break invariants
+        // worse than a skewed counter, so keep serving.
+        self.state.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    /// Wait until a request estimated at `estimated_tokens` may be sent.
+    pub async fn acquire(self: &Arc<Self>, estimated_tokens: u32) -> LimiterPermit {
+        let mut waiting: Option<WaitingGuard<'_>> = None;
+        loop {
+            // Register for wake-ups before checking, so a release between the
+            // check and the await is not missed.
+            let changed = self.changed.notified();
+            let admission = {
+                let mut state = self.lock_state();
+                let admission = self.try_admit(&mut state, estimated_tokens);
+                if !matches!(admission, Admission::Granted) && waiting.is_none() {
+                    state.waiting += 1;
+                    waiting = Some(WaitingGuard(self.as_ref()));
+                }
+                admission
+            };
+
+            match admission {
+                Admission::Granted => {
+                    return LimiterPermit {
+                        limiter: Arc::clone(self),
+                        estimated_tokens,
+                        started: Instant::now(),
+                    };
+                }
+                Admission::WaitFor(wait) => {
+                    let _ = tokio::time::timeout(wait, changed).await;
+                }
+                Admission::WaitForRelease => changed.await,
+            }
+        }
+    }
+
+    fn try_admit(&self, state: &mut LimiterState, estimated_tokens: u32) -> Admission {
+        let now = Instant::now();
+        if let Some(until) = state.paused_until {
+            if until > now {
+                return Admission::WaitFor(until - now);
+            }
+            state.paused_until = None;
+        }
+        if state.in_flight >= state.limit.floor() as usize {
+            return Admission::WaitForRelease;
+        }
+
+        let mut wait = Duration::ZERO;
+        if let Some(ref mut bucket) = state.requests {
+            bucket.refill(now);
+            wait = wait.max(bucket.wait_for(1.0));
+        }
+        if let Some(ref mut bucket) = state.tokens {
+            bucket.refill(now);
+            wait = wait.max(bucket.wait_for(f64::from(estimated_tokens)));
+        }
+        if !wait.is_zero() {
+            return Admission::WaitFor(wait);
+        }
+
+        if let Some(ref mut bucket) = state.requests {
+            bucket.adjust(-1.0);
+        }
+        if let Some(ref mut bucket) = state.tokens {
+            bucket.adjust(-f64::from(estimated_tokens));
+        }
+        state.in_flight += 1;
+        state.admitted += 1;
+        Admission::Granted
+    }
+
+    /// Count a request that was served by joining an identical in-flight one.
+    pub fn record_coalesced(&self) {
+        self.lock_state().coalesced += 1;
+    }
+
+    /// Current state of this limiter.
+    pub fn snapshot(&self) -> LimiterSnapshot {
+        let now = Instant::now();
+        let mut state = self.lock_state();
+        if let Some(ref mut bucket) = state.requests {
+            bucket.refill(now);
+        }
+        if let Some(ref mut bucket) = state.tokens {
+            bucket.refill(now);
+        }
+        LimiterSnapshot {
+            id: self.id,
+            provider: self.provider,
+            concurrency_limit: state.limit,
+            in_flight: state.in_flight,
+            waiting: state.waiting,
+            requests_available: state.requests.as_ref().map(|b| b.available),
+            tokens_available: state.tokens.as_ref().map(|b| b.available),
+            paused_for_ms: state
+                .paused_until
+                .filter(|until| *until > now)
+                .map(|until| (until - now).as_millis() as u64),
+            latency_ewma_ms: state.latency_ewma_ms,
+            latency_baseline_ms: state.latency_baseline_ms,
+            admitted: state.admitted,
+            throttled: state.throttled,
+            coalesced: state.coalesced,
+            config: self.config.clone(),
+        }
+    }
+}
+
+impl LimiterPermit {
+    /// Record a successful request that used `actual_tokens`.
+    pub fn record_success(self, actual_tokens: u32) {
+        let latency_ms = self.started.elapsed().as_secs_f64() * 1000.0;
+        let config = &self.limiter.config;
+        let mut state = self.limiter.lock_state();
+        state.observe_success(latency_ms, config, Instant::now());
+
+        let correction = f64::from(self.estimated_tokens) - f64::from(actual_tokens);
+        if let Some(ref mut bucket) = state.tokens {
+            bucket.adjust(correction);
+        }
+    }
+
+    /// Record a rate-limit response, pausing admissions for `retry_after`
+    /// if the provider gave one.
+    pub fn record_throttled(self, retry_after: Option<Duration>) {
+        let config = &self.limiter.config;
+        let now = Instant::now();
+        let mut state = self.limiter.lock_state();
+
+        state.throttled += 1;
+        state.decrease(config.backoff_ratio, config.min_concurrency as f64, now);
+        if let Some(retry_after) = retry_after {
+            let until = now + retry_after;
+            state.paused_until = Some(state.paused_until.map_or(until, |u| u.max(until)));
+        }
+        // The provider rejected the request, so it consumed no token budget.
+        let estimated = f64::from(self.estimated_tokens);
+        if let Some(ref mut bucket) = state.tokens {
+            bucket.adjust(estimated);
+        }
+    }
+}
+
+impl Drop for LimiterPermit {
+    fn drop(&mut self) {
+        self.limiter.lock_state().in_flight -= 1;
+        self.limiter.changed.notify_waiters();
+    }
+}
+
+fn lock_registry() -> MutexGuard<'static, Vec<Weak<ProviderLimiter>>> {
+    // The registry only holds weak references; a poisoned lock loses nothing.
+    REGISTRY
+        .get_or_init(|| Mutex::new(Vec::new()))
+        .lock()
+        .unwrap_or_else(|e| e.into_inner())
+}
+
+/// Snapshots of every live limiter in the process, ordered by id.
+pub fn limiter_snapshots() -> Vec<LimiterSnapshot> {
+    let limiters: Vec<Arc<ProviderLimiter>> = {
+        let mut registry = lock_registry();
+        registry.retain(|weak| weak.strong_count() > 0);
+        registry.iter().filter_map(Weak::upgrade).collect()
+    };
+    limiters.iter().map(|limiter| limiter.snapshot()).collect()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn config(max_concurrency: usize) -> LimiterConfig {
+        LimiterConfig {
+            max_concurrency,
+            ..LimiterConfig::default()
+        }
+    }
+
+    #[tokio::test]
+    async fn test_aimd_backs_off_on_throttle_and_recovers() {
+        let limiter = ProviderLimiter::new(Provider::OpenAI, config(8));
+
+        limiter.acquire(0).await.record_throttled(None);
+        assert_eq!(limiter.snapshot().concurrency_limit, 4.0);
+        assert_eq!(limiter.snapshot().throttled, 1);
+
+        for _ in 0..20 {
+            limiter.acquire(0).await.record_success(0);
+        }
+        let snapshot = limiter.snapshot();
+        assert!(snapshot.concurrency_limit > 7.0);
+        assert!(snapshot.concurrency_limit <= 8.0);
+        assert_eq!(snapshot.in_flight, 0);
+    }
+
+    #[tokio::test]
+    async fn test_concurrency_limit_blocks_until_release() {
+        let limiter = ProviderLimiter::new(Provider::Anthropic, config(1));
+        let first = limiter.acquire(0).await;
+
+        let waiter = {
+            let limiter = Arc::clone(&limiter);
+            tokio::spawn(async move { limiter.acquire(0).await.record_success(0) })
+        };
+        tokio::time::sleep(Duration::from_millis(20)).await;
+        assert!(!waiter.is_finished());
+        assert_eq!(limiter.snapshot().waiting, 1);
+
+        drop(first);
+        tokio::time::timeout(Duration::from_secs(1), waiter)
+            .await
+            .expect("waiter should be admitted after release")
+            .unwrap();
+        assert_eq!(limiter.snapshot().waiting, 0);
+    }
+
+    #[tokio::test]
+    async fn test_retry_after_pauses_admission() {
+        let limiter = ProviderLimiter::new(Provider::OpenRouter, config(4));
+        limiter
+            .acquire(0)
+            .await
+            .record_throttled(Some(Duration::from_millis(30)));
+        assert!(limiter.snapshot().paused_for_ms.is_some());
+
+        let started = Instant::now();
+        drop(limiter.acquire(0).await);
+        assert!(started.elapsed() >= Duration::from_millis(25));
+    }
+
+    #[tokio::test]
+    async fn test_token_bucket_charges_estimate_and_corrects() {
+        let limiter = ProviderLimiter::new(
+            Provider::OpenAI,
+            LimiterConfig {
+                tokens_per_window: 1000,
+                window_ms: 60_000,
+                ..config(4)
+            },
+        );
+
+        let permit = limiter.acquire(600).await;
+        let available = limiter.snapshot().tokens_available.unwrap();
+        assert!((available - 400.0).abs() < 1.0);
+
+        permit.record_success(100);
+        let available = limiter.snapshot().tokens_available.unwrap();
+        assert!((available - 900.0).abs() < 1.0);
+
+        assert!(limiter_snapshots()
+            .iter()
+            .any(|s| s.id == limiter.snapshot().id));
+    }
+
+    /// Feed `latencies` to the limiter as successes spaced 1 ms apart.
+    fn observe(limiter: &ProviderLimiter, start: Instant, latencies: &[f64]) {
+        let mut state = limiter.lock_state();
+        for (i, &ms) in latencies.iter().enumerate() {
+            let now = start + Duration::from_millis(i as u64);
+            state.observe_success(ms, &limiter.config, now);
+        }
+    }
+
+    #[test]
+    fn test_mixed_latencies_do_not_ratchet_the_limit_down() {
+        let limiter = ProviderLimiter::new(Provider::Anthropic, config(8));
+        let start = Instant::now();
+
+        // One very short completion, then a steady mix of short and long
+        // ones: an all-time floor would treat every later success as
+        // inflated and pin the limit at the minimum.
+        let mut latencies = vec![5.0];
+        latencies.extend((0..400).map(|i| if i % 3 == 0 { 900.0 } else { 120.0 }));
+        observe(&limiter, start, &latencies);
+
+        let snapshot = limiter.snapshot();
+        assert_eq!(snapshot.concurrency_limit, 8.0);
+        assert!(snapshot.latency_baseline_ms.unwrap() > 200.0);
+    }
+
+    #[test]
+    fn test_sustained_latency_rise_backs_off() {
+        let limiter = ProviderLimiter::new(Provider::Anthropic, config(8));
+        let start = Instant::now();
+        observe(&limiter, start, &[100.0; 50]);
+        assert_eq!(limiter.snapshot().concurrency_limit, 8.0);
+
+        // Space samples past the cooldown so each inflated one may cut.
+        let mut state = limiter.lock_state();
+        for i in 0..10 {
+            let now = start + Duration::from_secs(10 + i);
+            state.observe_success(600.0, &limiter.config, now);
+        }
+        drop(state);
+        assert!(limiter.snapshot().concurrency_limit < 8.0);
+    }
+}
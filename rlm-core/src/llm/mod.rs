@@ -34,7 +34,9 @@
 mod batch;
 mod cache;
 mod client;
+mod limiter;
 mod router;
+mod sharded_cost;
 mod types;
 
 pub use batch::{
@@ -42,17 +44,22 @@ pub use batch::{
     DEFAULT_MAX_PARALLEL,
 };
 pub use cache::{
-    apply_cache_markers, find_cache_breakpoints, CacheEntry, CacheKey, CacheStats, PromptCache,
+    apply_cache_markers, find_cache_breakpoints, CacheEntry, CacheKey, CacheStats, CachingClient,
+    PromptCache, ResponseCache, ResponseCacheConfig, ResponseCachePolicy,
 };
 #[cfg(feature = "gemini")]
 pub use client::GoogleClient;
 pub use client::{
     AnthropicClient, ClientConfig, LLMClient, MultiProviderClient, OpenAIClient, TrackedClient,
 };
+pub use limiter::{
+    limiter_snapshots, LimiterConfig, LimiterPermit, LimiterSnapshot, ProviderLimiter,
+};
 pub use router::{
     DualModelConfig, QueryType, RoutingContext, RoutingDecision, SmartRouter, SwitchStrategy,
     TierDefaults,
 };
+pub use sharded_cost::{CostTotals, ShardedCostTracker, MAX_TRACKED_MODELS};
 pub use types::{
     CacheControl, ChatMessage, ChatRole, CompletionRequest, CompletionResponse, CostTracker,
     EmbeddingRequest, EmbeddingResponse, ModelCallTier, ModelCosts, ModelSpec, ModelTier, Provider,
@@ -0,0 +1,479 @@
+//! Thread-safe cost tracking with per-thread shards.
+//!
+//! [`ShardedCostTracker`] records usage through `&self`. Each thread writes to
+//! its own cache-line-aligned shard of relaxed atomic counters, indexed by a
+//! fixed, append-only model-id table, so concurrent recorders never contend
+//! on a lock or on each other's cache lines. Reads sum the shards on demand;
+//! a read that races with writers sees each counter at some recent value
+//! rather than one global instant.
+
+use super::types::{CostTracker, ModelCallTier, ModelCosts, TierCosts, TokenUsage};
+use std::collections::HashMap;
+use std::sync::atomic::{AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Mutex, OnceLock};
+
+/// Distinct models tracked in the lock-free table. Further models are still
+/// counted, in a mutex-guarded overflow map.
+pub const MAX_TRACKED_MODELS: usize = 64;
+
+/// Upper bound on shards regardless of core count.
+const MAX_SHARDS: usize = 64;
+
+// Counter slots in a shard's totals block.
+const TOTAL_INPUT: usize = 0;
+const TOTAL_OUTPUT: usize = 1;
+const TOTAL_CACHE_READ: usize = 2;
+const TOTAL_CACHE_CREATION: usize = 3;
+const TOTAL_REQUESTS: usize = 4;
+const TOTAL_COST: usize = 5;
+
+// Counter slots in per-model and per-tier blocks.
+const INPUT: usize = 0;
+const OUTPUT: usize = 1;
+const REQUESTS: usize = 2;
+const COST: usize = 3;
+
+static NEXT_THREAD: AtomicUsize = AtomicUsize::new(0);
+
+thread_local! {
+    static THREAD_SLOT: usize = NEXT_THREAD.fetch_add(1, Ordering::Relaxed);
+}
+
+/// Aggregated totals without the per-model breakdown.
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct CostTotals {
+    pub input_tokens: u64,
+    pub output_tokens: u64,
+    pub cache_read_tokens: u64,
+    pub cache_creation_tokens: u64,
+    pub request_count: u64,
+    pub total_cost: f64,
+    /// Indexed by [`ModelCallTier`] order: root, recursive, extraction
+    pub tiers: [TierCosts; 3],
+}
+
+fn add_f64(counter: &AtomicU64, value: f64) {
+    // Shards are thread-affine, so this loop almost never retries.
+    let _ = counter.fetch_update(Ordering::Relaxed, Ordering::Relaxed, |bits| {
+        Some((f64::from_bits(bits) + value).to_bits())
+    });
+}
+
+fn load_f64(counter: &AtomicU64) -> f64 {
+    f64::from_bits(counter.load(Ordering::Relaxed))
+}
+
+fn tier_index(tier: ModelCallTier) -> usize {
+    match tier {
+        ModelCallTier::Root => 0,
+        ModelCallTier::Recursive => 1,
+        ModelCallTier::Extraction => 2,
+    }
+}
+
+#[repr(align(128))]
+struct Shard {
+    totals: [AtomicU64; 6],
+    models: [[AtomicU64; 4]; MAX_TRACKED_MODELS],
+    tiers: [[AtomicU64; 4]; 3],
+}
+
+impl Shard {
+    fn new() -> Self {
+        Self {
+            totals: Default::default(),
+            models: std::array::from_fn(|_| Default::default()),
+            tiers: Default::default(),
+        }
+    }
+}
+
+fn add_block(block: &[AtomicU64; 4], input: u64, output: u64, requests: u64, cost: f64) {
+    block[INPUT].fetch_add(input, Ordering::Relaxed);
+    block[OUTPUT].fetch_add(output, Ordering::Relaxed);
+    block[REQUESTS].fetch_add(requests, Ordering::Relaxed);
+    if cost != 0.0 {
+        add_f64(&block[COST], cost);
+    }
+}
+
+/// Append-only model name table; ids are never reused or reassigned.
+struct ModelTable {
+    names: [OnceLock<String>; MAX_TRACKED_MODELS],
+    len: AtomicUsize,
+    register: Mutex<()>,
+}
+
+impl ModelTable {
+    fn new() -> Self {
+        Self {
+            names: std::array::from_fn(|_| OnceLock::new()),
+            len: AtomicUsize::new(0),
+            register: Mutex::new(()),
+        }
+    }
+
+    fn find(&self, model: &str, from: usize, to: usize) -> Option<usize> {
+        (from..to).find(|&i| self.names[i].get().is_some_and(|name| name == model))
+    }
+
+    /// Id for `model`, registering it if needed; `None` once the table is full.
+    fn id(&self, model: &str) -> Option<usize> {
+        let len = self.len.load(Ordering::Acquire);
+        if let Some(id) = self.find(model, 0, len) {
+            return Some(id);
+        }
+
+        // Registration is rare (once per model), so it may take a lock.
+        let _guard = self.register.lock().unwrap_or_else(|e| e.into_inner());
+        let current = self.len.load(Ordering::Acquire);
+        if let Some(id) = self.find(model, len, current) {
+            return Some(id);
+        }
+        if current == MAX_TRACKED_MODELS {
+            return None;
+        }
+        let _ = self.names[current].set(model.to_string());
+        self.len.store(current + 1, Ordering::Release);
+        Some(current)
+    }
+
+    fn len(&self) -> usize {
+        self.len.load(Ordering::Acquire)
+    }
+
+    fn name(&self, id: usize) -> Option<&str> {
+        self.names.get(id)?.get().map(String::as_str)
+    }
+}
+
+/// Cost tracker safe to share across threads without external locking.
+pub struct ShardedCostTracker {
+    shards: Box<[Shard]>,
+    models: ModelTable,
+    overflow: Mutex<HashMap<String, ModelCosts>>,
+}
+
+impl Default for ShardedCostTracker {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl std::fmt::Debug for ShardedCostTracker {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("ShardedCostTracker")
+            .field("shards", &self.shards.len())
+            .field("totals", &self.totals())
+            .finish()
+    }
+}
+
+impl ShardedCostTracker {
+    /// Create a tracker with one shard per available core (rounded up to a
+    /// power of two).
+    pub fn new() -> Self {
+        let cores = std::thread::available_parallelism().map_or(4, |n| n.get());
+        Self::with_shards(cores)
+    }
+
+    /// Create a tracker with `shards` shards (rounded up to a power of two).
+    pub fn with_shards(shards: usize) -> Self {
+        let count = shards.clamp(1, MAX_SHARDS).next_power_of_two();
+        Self {
+            shards: (0..count).map(|_| Shard::new()).collect(),
+            models: ModelTable::new(),
+            overflow: Mutex::new(HashMap::new()),
+        }
+    }
+
+    fn shard(&self) -> &Shard {
+        let slot = THREAD_SLOT.with(|slot| *slot);
+        &self.shards[slot & (self.shards.len() - 1)]
+    }
+
+    /// Record usage from a completion response.
+    pub fn record(&self, model: &str, usage: &TokenUsage, cost: Option<f64>) {
+        self.record_inner(model, usage, cost, None);
+    }
+
+    /// Record usage with an explicit orchestration tier.
+    pub fn record_tiered(
+        &self,
+        model: &str,
+        usage: &TokenUsage,
+        cost: Option<f64>,
+        tier: ModelCallTier,
+    ) {
+        self.record_inner(model, usage, cost, Some(tier));
+    }
+
+    fn record_inner(
+        &self,
+        model: &str,
+        usage: &TokenUsage,
+        cost: Option<f64>,
+        tier: Option<ModelCallTier>,
+    ) {
+        let shard = self.shard();
+        let cost = cost.unwrap_or(0.0);
+
+        shard.totals[TOTAL_INPUT].fetch_add(usage.input_tokens, Ordering::Relaxed);
+        shard.totals[TOTAL_OUTPUT].fetch_add(usage.output_tokens, Ordering::Relaxed);
+        shard.totals[TOTAL_CACHE_READ]
+            .fetch_add(usage.cache_read_tokens.unwrap_or(0), Ordering::Relaxed);
+        shard.totals[TOTAL_CACHE_CREATION]
+            .fetch_add(usage.cache_creation_tokens.unwrap_or(0), Ordering::Relaxed);
+        shard.totals[TOTAL_REQUESTS].fetch_add(1, Ordering::Relaxed);
+        if cost != 0.0 {
+            add_f64(&shard.totals[TOTAL_COST], cost);
+        }
+
+        self.add_model(
+            shard,
+            model,
+            &ModelCosts {
+                input_tokens: usage.input_tokens,
+                output_tokens: usage.output_tokens,
+                cost,
+                request_count: 1,
+            },
+        );
+
+        if let Some(tier) = tier {
+            add_block(
+                &shard.tiers[tier_index(tier)],
+                usage.input_tokens,
+                usage.output_tokens,
+                1,
+                cost,
+            );
+        }
+    }
+
+    fn add_model(&self, shard: &Shard, model: &str, costs: &ModelCosts) {
+        match self.models.id(model) {
+            Some(id) => add_block(
+                &shard.models[id],
+                costs.input_tokens,
+                costs.output_tokens,
+                costs.request_count,
+                costs.cost,
+            ),
+            None => {
+                let mut overflow = self.overflow.lock().unwrap_or_else(|e| e.into_inner());
+                let entry = overflow.entry(model.to_string()).or_default();
+                entry.input_tokens += costs.input_tokens;
+                entry.output_tokens += costs.output_tokens;
+                entry.cost += costs.cost;
+                entry.request_count += costs.request_count;
+            }
+        }
+    }
+
+    /// Add everything recorded in `other` to this tracker.
+    pub fn merge(&self, other: &CostTracker) {
+        let shard = self.shard();
+        shard.totals[TOTAL_INPUT].fetch_add(other.total_input_tokens, Ordering::Relaxed);
+        shard.totals[TOTAL_OUTPUT].fetch_add(other.total_output_tokens, Ordering::Relaxed);
+        shard.totals[TOTAL_CACHE_READ].fetch_add(other.total_cache_read_tokens, Ordering::Relaxed);
+        shard.totals[TOTAL_CACHE_CREATION]
+            .fetch_add(other.total_cache_creation_tokens, Ordering::Relaxed);
+        shard.totals[TOTAL_REQUESTS].fetch_add(other.request_count, Ordering::Relaxed);
+        add_f64(&shard.totals[TOTAL_COST], other.total_cost);
+
+        for (model, costs) in &other.by_model {
+            self.add_model(shard, model, costs);
+        }
+        for (i, tier) in [
+            &other.root_costs,
+            &other.recursive_costs,
+            &other.extraction_costs,
+        ]
+        .into_iter()
+        .enumerate()
+        {
+            add_block(
+                &shard.tiers[i],
+                tier.input_tokens,
+                tier.output_tokens,
+                tier.request_count,
+                tier.cost,
+            );
+        }
+    }
+
+    /// Aggregate totals and tier costs, without building the model map.
+    pub fn totals(&self) -> CostTotals {
+        let mut totals = CostTotals::default();
+        for shard in self.shards.iter() {
+            totals.input_tokens += shard.totals[TOTAL_INPUT].load(Ordering::Relaxed);
+            totals.output_tokens += shard.totals[TOTAL_OUTPUT].load(Ordering::Relaxed);
+            totals.cache_read_tokens += shard.totals[TOTAL_CACHE_READ].load(Ordering::Relaxed);
+            totals.cache_creation_tokens +=
+                shard.totals[TOTAL_CACHE_CREATION].load(Ordering::Relaxed);
+            totals.request_count += shard.totals[TOTAL_REQUESTS].load(Ordering::Relaxed);
+            totals.total_cost += load_f64(&shard.totals[TOTAL_COST]);
+            for (tier, block) in totals.tiers.iter_mut().zip(&shard.tiers) {
+                tier.merge(&Self::block_costs(block).into());
+            }
+        }
+        totals
+    }
+
+    fn block_costs(block: &[AtomicU64; 4]) -> ModelCosts {
+        ModelCosts {
+            input_tokens: block[INPUT].load(Ordering::Relaxed),
+            output_tokens: block[OUTPUT].load(Ordering::Relaxed),
+            cost: load_f64(&block[COST]),
+            request_count: block[REQUESTS].load(Ordering::Relaxed),
+        }
+    }
+
+    /// Number of models in the fixed table (see [`MAX_TRACKED_MODELS`]).
+    pub fn model_count(&self) -> usize {
+        self.models.len()
+    }
+
+    /// Name and aggregated costs of the model with table id `id`.
+    pub fn model_costs(&self, id: usize) -> Option<(&str, ModelCosts)> {
+        let name = self.models.name(id)?;
+        let mut costs = ModelCosts::default();
+        for shard in self.shards.iter() {
+            let part = Self::block_costs(&shard.models[id]);
+            costs.input_tokens += part.input_tokens;
+            costs.output_tokens += part.output_tokens;
+            costs.cost += part.cost;
+            costs.request_count += part.request_count;
+        }
+        Some((name, costs))
+    }
+
+    /// Aggregated per-model breakdown, including overflow models.
+    pub fn by_model(&self) -> HashMap<String, ModelCosts> {
+        let mut by_model: HashMap<String, ModelCosts> = (0..self.model_count())
+            .filter_map(|id| self.model_costs(id))
+            .map(|(name, costs)| (name.to_string(), costs))
+            .collect();
+        let overflow = self.overflow.lock().unwrap_or_else(|e| e.into_inner());
+        by_model.extend(overflow.iter().map(|(k, v)| (k.clone(), v.clone())));
+        by_model
+    }
+
+    /// Aggregate everything into a plain [`CostTracker`].
+    pub fn snapshot(&self) -> CostTracker {
+        let totals = self.totals();
+        let [root_costs, recursive_costs, extraction_costs] = totals.tiers;
+        CostTracker {
+            total_input_tokens: totals.input_tokens,
+            total_output_tokens: totals.output_tokens,
+            total_cache_read_tokens: totals.cache_read_tokens,
+            total_cache_creation_tokens: totals.cache_creation_tokens,
+            total_cost: totals.total_cost,
+            request_count: totals.request_count,
+            by_model: self.by_model(),
+            root_costs,
+            recursive_costs,
+            extraction_costs,
+        }
+    }
+}
+
+impl From<ModelCosts> for TierCosts {
+    fn from(costs: ModelCosts) -> Self {
+        Self {
+            input_tokens: costs.input_tokens,
+            output_tokens: costs.output_tokens,
+            cost: costs.cost,
+            request_count: costs.request_count,
+        }
+    }
+}
+
+impl From<&CostTracker> for ShardedCostTracker {
+    fn from(tracker: &CostTracker) -> Self {
+        let sharded = Self::new();
+        sharded.merge(tracker);
+        sharded
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Arc;
+
+    fn usage(input: u64, output: u64) -> TokenUsage {
+        TokenUsage {
+            input_tokens: input,
+            output_tokens: output,
+            cache_read_tokens: Some(1),
+            cache_creation_tokens: None,
+        }
+    }
+
+    #[test]
+    fn test_matches_cost_tracker() {
+        let sharded = ShardedCostTracker::with_shards(4);
+        let mut plain = CostTracker::new();
+        for (model, tier) in [
+            ("opus", ModelCallTier::Root),
+            ("haiku", ModelCallTier::Recursive),
+            ("haiku", ModelCallTier::Extraction),
+        ] {
+            sharded.record_tiered(model, &usage(100, 20), Some(0.5), tier);
+            plain.record_tiered(model, &usage(100, 20), Some(0.5), tier);
+        }
+        sharded.record("sonnet", &usage(7, 3), None);
+        plain.record("sonnet", &usage(7, 3), None);
+
+        let snapshot = sharded.snapshot();
+        assert_eq!(
+            serde_json::to_value(&snapshot).unwrap(),
+            serde_json::to_value(&plain).unwrap()
+        );
+
+        let roundtrip = ShardedCostTracker::from(&plain);
+        assert_eq!(roundtrip.totals(), sharded.totals());
+    }
+
+    #[test]
+    fn test_concurrent_recording() {
+        let tracker = Arc::new(ShardedCostTracker::new());
+        let handles: Vec<_> = (0..8)
+            .map(|t| {
+                let tracker = Arc::clone(&tracker);
+                std::thread::spawn(move || {
+                    for _ in 0..1000 {
+                        tracker.record(&format!("model-{}", t % 3), &usage(2, 1), Some(0.25));
+                    }
+                })
+            })
+            .collect();
+        handles.into_iter().for_each(|h| h.join().unwrap());
+
+        let totals = tracker.totals();
+        assert_eq!(totals.request_count, 8000);
+        assert_eq!(totals.input_tokens, 16000);
+        assert_eq!(totals.cache_read_tokens, 8000);
+        assert_eq!(totals.total_cost, 2000.0);
+        assert_eq!(tracker.model_count(), 3);
+        let by_model = tracker.by_model();
+        assert_eq!(
+            by_model.values().map(|c| c.request_count).sum::<u64>(),
+            8000
+        );
+    }
+
+    #[test]
+    fn test_overflow_models_are_kept() {
+        let tracker = ShardedCostTracker::with_shards(1);
+        for i in 0..MAX_TRACKED_MODELS + 2 {
+            tracker.record(&format!("m{}", i), &usage(1, 1), None);
+        }
+        assert_eq!(tracker.model_count(), MAX_TRACKED_MODELS);
+        assert_eq!(tracker.by_model().len(), MAX_TRACKED_MODELS + 2);
+        assert_eq!(tracker.model_costs(0).unwrap().0, "m0");
+        assert!(tracker.model_costs(MAX_TRACKED_MODELS).is_none());
+    }
+}
@@ -461,7 +461,7 @@ pub struct CostTracker {
 }
 
 /// Costs breakdown by model tier (for dual-model optimization).
-#[derive(Debug, Clone, Default, Serialize, Deserialize)]
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
 pub struct TierCosts {
     /// Input tokens used
     pub input_tokens: u64,
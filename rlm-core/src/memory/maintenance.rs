@@ -0,0 +1,318 @@
+//! Background decay and consolidation in bounded batches.
+//!
+//! [`MaintenanceScheduler`] runs the same decay and consolidation as
+//! [`SqliteMemoryStore::decay`] and [`SqliteMemoryStore::consolidate`], but on
+//! a background thread and one bounded batch at a time, pausing between
+//! batches so foreground writes never wait behind a full-store sweep.
+
+use crate::error::{Error, Result};
+use crate::memory::store::{MaintenanceBatch, SqliteMemoryStore};
+use crate::memory::types::Tier;
+use serde::{Deserialize, Serialize};
+use std::sync::{Arc, Condvar, Mutex, MutexGuard};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant};
+
+/// Tuning for a [`MaintenanceScheduler`].
+///
+/// All fields are optional when deserialized from JSON; missing fields take
+/// their default values.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+#[serde(default)]
+pub struct MaintenanceOptions {
+    /// Decay factor applied per 24 hours since last access.
+    pub decay_factor: f64,
+    /// Nodes below this confidence are not decayed further.
+    pub min_confidence: f64,
+    /// Tiers whose nodes are promoted to the next tier on every sweep.
+    pub consolidate_tiers: Vec<Tier>,
+    /// Nodes processed per transaction.
+    pub batch_size: usize,
+    /// Pause between batches of one sweep, in milliseconds.
+    pub batch_pause_ms: u64,
+    /// Time from the start of one sweep to the start of the next, in
+    /// milliseconds. Decay compounds per sweep, as with repeated
+    /// [`SqliteMemoryStore::decay`] calls.
+    pub sweep_interval_ms: u64,
+}
+
+impl Default for MaintenanceOptions {
+    fn default() -> Self {
+        Self {
+            decay_factor: 0.95,
+            min_confidence: 0.1,
+            consolidate_tiers: Vec::new(),
+            batch_size: 500,
+            batch_pause_ms: 10,
+            sweep_interval_ms: 24 * 60 * 60 * 1000,
+        }
+    }
+}
+
+/// Counters reported by [`MaintenanceScheduler::stats`].
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct MaintenanceStats {
+    /// Completed sweeps over the whole store.
+    pub sweeps: u64,
+    /// Batches committed.
+    pub batches: u64,
+    /// Confidence decrements written.
+    pub decayed: u64,
+    /// Tier promotions written.
+    pub promoted: u64,
+    /// Batches that failed. A failed batch ends its sweep early.
+    pub errors: u64,
+    /// Most recent batch error.
+    pub last_error: Option<String>,
+}
+
+struct State {
+    shutdown: bool,
+    run_now: bool,
+    stats: MaintenanceStats,
+}
+
+struct Shared {
+    state: Mutex<State>,
+    changed: Condvar,
+}
+
+impl Shared {
+    fn lock(&self) -> MutexGuard<'_, State> {
+        self.state.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    /// Sleep until `deadline`, shutdown, or a manual trigger. Returns false on
+    /// shutdown.
+    fn wait_until(&self, deadline: Instant) -> bool {
+        let mut state = self.lock();
+        loop {
+            if state.shutdown {
+                return false;
+            }
+            if state.run_now {
+                state.run_now = false;
+                return true;
+            }
+            let now = Instant::now();
+            if now >= deadline {
+                return true;
+            }
+            state = self
+                .changed
+                .wait_timeout(state, deadline - now)
+                .unwrap_or_else(|e| e.into_inner())
+                .0;
+        }
+    }
+}
+
+/// Where the current sweep is.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+enum Phase {
+    Decay,
+    Consolidate(usize),
+}
+
+/// Background thread that decays and consolidates a store incrementally.
+///
+/// Dropping the scheduler stops the thread after its current batch.
+pub struct MaintenanceScheduler {
+    shared: Arc<Shared>,
+    worker: Option<JoinHandle<()>>,
+}
+
+impl MaintenanceScheduler {
+    /// Start maintaining `store`. The first sweep begins immediately.
+    pub fn start(store: SqliteMemoryStore, options: MaintenanceOptions) -> Result<Self> {
+        let shared = Arc::new(Shared {
+            state: Mutex::new(State {
+                shutdown: false,
+                run_now: false,
+                stats: MaintenanceStats::default(),
+            }),
+            changed: Condvar::new(),
+        });
+
+        let worker = {
+            let shared = Arc::clone(&shared);
+            std::thread::Builder::new()
+                .name("rlm-memory-maintenance".to_string())
+                .spawn(move || run(store, options, shared))
+                .map_err(|e| Error::Internal(format!("Failed to start maintenance: {}", e)))?
+        };
+
+        Ok(Self {
+            shared,
+            worker: Some(worker),
+        })
+    }
+
+    /// Counters accumulated since the scheduler started.
+    pub fn stats(&self) -> MaintenanceStats {
+        self.shared.lock().stats.clone()
+    }
+
+    /// Start the next sweep now instead of waiting for the interval.
+    pub fn trigger(&self) {
+        self.shared.lock().run_now = true;
+        self.shared.changed.notify_all();
+    }
+
+    /// Stop the background thread and wait for it to exit.
+    pub fn shutdown(&mut self) {
+        self.shared.lock().shutdown = true;
+        self.shared.changed.notify_all();
+        if let Some(worker) = self.worker.take() {
+            let _ = worker.join();
+        }
+    }
+}
+
+impl Drop for MaintenanceScheduler {
+    fn drop(&mut self) {
+        self.shutdown();
+    }
+}
+
+fn run(store: SqliteMemoryStore, options: MaintenanceOptions, shared: Arc<Shared>) {
+    let batch_size = options.batch_size.max(1);
+    let pause = Duration::from_millis(options.batch_pause_ms);
+    let interval = Duration::from_millis(options.sweep_interval_ms);
+
+    loop {
+        let sweep_started = Instant::now();
+        let mut phase = Phase::Decay;
+        let mut cursor = 0;
+        let mut failed = false;
+
+        loop {
+            let result = match phase {
+                Phase::Decay => store.decay_batch(
+                    options.decay_factor,
+                    options.min_confidence,
+                    cursor,
+                    batch_size,
+                ),
+                Phase::Consolidate(i) => {
+                    let tier = options.consolidate_tiers[i];
+                    match tier.next() {
+                        Some(to_tier) => store.consolidate_batch(
+                            tier,
+                            to_tier,
+                            cursor,
+                            batch_size,
+                            &format!("Scheduled consolidation of {}", tier),
+                        ),
+                        // The last tier has nowhere to go.
+                        None => Ok(MaintenanceBatch {
+                            cursor,
+                            done: true,
+                            ..Default::default()
+                        }),
+                    }
+                }
+            };
+
+            let done = {
+                let mut state = shared.lock();
+                match result {
+                    Ok(batch) => {
+                        state.stats.batches += 1;
+                        let changed = batch.changed.len() as u64;
+                        match phase {
+                            Phase::Decay => state.stats.decayed += changed,
+                            Phase::Consolidate(_) => state.stats.promoted += changed,
+                        }
+                        cursor = batch.cursor;
+                        Some(batch.done)
+                    }
+                    Err(e) => {
+                        // Give up on this sweep; the next one starts over.
+                        state.stats.errors += 1;
+                        state.stats.last_error = Some(e.to_string());
+                        None
+                    }
+                }
+            };
+            let Some(done) = done else {
+                failed = true;
+                break;
+            };
+
+            if done {
+                let next = match phase {
+                    Phase::Decay => 0,
+                    Phase::Consolidate(i) => i + 1,
+                };
+                if next >= options.consolidate_tiers.len() {
+                    break;
+                }
+                phase = Phase::Consolidate(next);
+                cursor = 0;
+                continue;
+            }
+
+            if !shared.wait_until(Instant::now() + pause) {
+                return;
+            }
+        }
+
+        if !failed {
+            shared.lock().stats.sweeps += 1;
+        }
+        if !shared.wait_until(sweep_started + interval) {
+            return;
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use crate::memory::{Node, NodeQuery, NodeType};
+    use chrono::Utc;
+
+    #[test]
+    fn test_scheduler_sweeps_in_batches() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let stale = Utc::now() - chrono::Duration::days(2);
+        let nodes: Vec<Node> = (0..7)
+            .map(|i| {
+                let mut node = Node::new(NodeType::Fact, format!("fact {}", i));
+                node.last_accessed = stale;
+                node
+            })
+            .collect();
+        store.add_nodes(&nodes).unwrap();
+
+        let options = MaintenanceOptions {
+            decay_factor: 0.5,
+            consolidate_tiers: vec![Tier::Task],
+            batch_size: 3,
+            batch_pause_ms: 0,
+            ..Default::default()
+        };
+        let mut scheduler = MaintenanceScheduler::start(store.clone(), options).unwrap();
+
+        let deadline = Instant::now() + Duration::from_secs(10);
+        while scheduler.stats().sweeps == 0 && Instant::now() < deadline {
+            std::thread::sleep(Duration::from_millis(5));
+        }
+        scheduler.shutdown();
+
+        let stats = scheduler.stats();
+        assert_eq!(stats.sweeps, 1);
+        assert_eq!(stats.errors, 0);
+        assert_eq!(stats.decayed, 7);
+        assert_eq!(stats.promoted, 7);
+        // 3 decay batches and 3 consolidation batches of at most 3 nodes
+        assert_eq!(stats.batches, 6);
+
+        let session = store
+            .query_nodes(&NodeQuery::new().tiers(vec![Tier::Session]))
+            .unwrap();
+        assert_eq!(session.len(), 7);
+        assert!(session.iter().all(|n| (n.confidence - 0.25).abs() < 1e-9));
+    }
+}
@@ -27,13 +27,20 @@
 //! store.promote(&[fact.id], "Frequently accessed")?;
 //! ```
 
+mod maintenance;
 mod schema;
 mod store;
 mod types;
+mod vector;
 
+pub use maintenance::{MaintenanceOptions, MaintenanceScheduler, MaintenanceStats};
 pub use schema::{get_schema_version, initialize_schema, is_initialized, SCHEMA_VERSION};
-pub use store::{EvolutionEntry, MemoryStats, SqliteMemoryStore};
+pub use store::{
+    vector_index_path, EvolutionEntry, MaintenanceBatch, MemoryStats, MemoryStoreOptions,
+    SqliteMemoryStore, MAINTENANCE_BATCH_SIZE,
+};
 pub use types::{
     ConsolidationResult, EdgeId, EdgeMember, EdgeType, HyperEdge, Node, NodeId, NodeQuery,
-    NodeType, Provenance, ProvenanceSource, Tier,
+    NodeType, Provenance, ProvenanceSource, Subgraph, Tier,
 };
+pub use vector::{HnswParams, VectorIndex};
@@ -1,9 +1,12 @@
 //! SQLite schema and migrations for the memory system.
 
+use crate::memory::types::{EdgeId, EdgeType, NodeId, NodeType};
+use rusqlite::types::{FromSql, FromSqlError, FromSqlResult, ToSql, ToSqlOutput, ValueRef};
 use rusqlite::{Connection, Result as SqliteResult};
+use uuid::Uuid;
 
 /// Current schema version.
-pub const SCHEMA_VERSION: i32 = 1;
+pub const SCHEMA_VERSION: i32 = 3;
 
 /// Initialize the database schema.
 pub fn initialize_schema(conn: &Connection) -> SqliteResult<()> {
@@ -35,10 +38,28 @@ pub fn initialize_schema(conn: &Connection) -> SqliteResult<()> {
     if current_version < 1 {
         apply_v1_schema(conn)?;
     }
+    if current_version < 2 {
+        migrate_v1_to_v2(conn)?;
+    }
+    if current_version < 3 {
+        migrate_v2_to_v3(conn)?;
+    }
 
     Ok(())
 }
 
+/// FTS sync on update, limited to rows whose content actually changed.
+///
+/// Confidence, tier and access bookkeeping rewrite rows far more often than
+/// content does; re-indexing those rows would only churn the FTS index.
+const NODES_AU_TRIGGER: &str = "CREATE TRIGGER IF NOT EXISTS nodes_au
+    AFTER UPDATE OF content ON nodes
+    WHEN OLD.content IS NOT NEW.content
+    BEGIN
+        INSERT INTO nodes_fts(nodes_fts, rowid, content) VALUES ('delete', OLD.rowid, OLD.content);
+        INSERT INTO nodes_fts(rowid, content) VALUES (NEW.rowid, NEW.content);
+    END";
+
 /// Apply version 1 schema.
 fn apply_v1_schema(conn: &Connection) -> SqliteResult<()> {
     // Nodes table
@@ -155,13 +176,7 @@ fn apply_v1_schema(conn: &Connection) -> SqliteResult<()> {
         END",
         [],
     )?;
-    conn.execute(
-        "CREATE TRIGGER IF NOT EXISTS nodes_au AFTER UPDATE ON nodes BEGIN
-            INSERT INTO nodes_fts(nodes_fts, rowid, content) VALUES ('delete', OLD.rowid, OLD.content);
-            INSERT INTO nodes_fts(rowid, content) VALUES (NEW.rowid, NEW.content);
-        END",
-        [],
-    )?;
+    conn.execute(NODES_AU_TRIGGER, [])?;
 
     // Record migration
     conn.execute("INSERT INTO schema_version (version) VALUES (1)", [])?;
@@ -169,6 +184,442 @@ fn apply_v1_schema(conn: &Connection) -> SqliteResult<()> {
     Ok(())
 }
 
+/// Version 2: an embedding change log for incremental vector-index sync.
+///
+/// Triggers append a row whenever a node's embedding appears, changes or
+/// disappears, or an embedded node changes tier, so every connection (in any
+/// process) can bring a cached index up to date by reading rows past the
+/// last `seq` it applied. `vector_index_meta.store_id` is a random id that
+/// ties a persisted index file to this particular database.
+const V2_SCHEMA: &str = "
+    CREATE TABLE IF NOT EXISTS embedding_changes (
+        seq INTEGER PRIMARY KEY AUTOINCREMENT,
+        node_id TEXT NOT NULL
+    );
+    CREATE TABLE IF NOT EXISTS vector_index_meta (
+        id INTEGER PRIMARY KEY CHECK (id = 0),
+        store_id BLOB NOT NULL
+    );
+    INSERT OR IGNORE INTO vector_index_meta (id, store_id) VALUES (0, randomblob(16));
+";
+
+/// Triggers that feed `embedding_changes`.
+const EMBEDDING_LOG_TRIGGERS: &str = "
+    CREATE TRIGGER IF NOT EXISTS nodes_embedding_ai AFTER INSERT ON nodes
+    WHEN NEW.embedding IS NOT NULL BEGIN
+        INSERT INTO embedding_changes (node_id) VALUES (NEW.id);
+    END;
+    CREATE TRIGGER IF NOT EXISTS nodes_embedding_au AFTER UPDATE OF embedding, tier ON nodes
+    WHEN OLD.embedding IS NOT NEW.embedding
+        OR (NEW.embedding IS NOT NULL AND OLD.tier IS NOT NEW.tier) BEGIN
+        INSERT INTO embedding_changes (node_id) VALUES (NEW.id);
+    END;
+    CREATE TRIGGER IF NOT EXISTS nodes_embedding_ad AFTER DELETE ON nodes
+    WHEN OLD.embedding IS NOT NULL BEGIN
+        INSERT INTO embedding_changes (node_id) VALUES (OLD.id);
+    END;
+";
+
+/// Apply version 2: the embedding change log behind the vector index.
+fn migrate_v1_to_v2(conn: &Connection) -> SqliteResult<()> {
+    let tx = conn.unchecked_transaction()?;
+    tx.execute_batch(V2_SCHEMA)?;
+    tx.execute_batch(EMBEDDING_LOG_TRIGGERS)?;
+    tx.execute("INSERT INTO schema_version (version) VALUES (2)", [])?;
+    tx.commit()
+}
+
+/// Tables created by the version 3 layout, in dependency order.
+///
+/// Ids are 16-byte UUID blobs and `node_type`/`edge_type` are the integer
+/// codes of [`NodeType`] and [`EdgeType`]. `{s}` is replaced by a table-name
+/// suffix so the migration can build the new tables next to the old ones.
+const V3_TABLES: &str = "
+    CREATE TABLE nodes{s} (
+        id BLOB NOT NULL PRIMARY KEY,
+        node_type INTEGER NOT NULL,
+        subtype TEXT,
+        content TEXT NOT NULL,
+        embedding BLOB,
+        tier INTEGER NOT NULL DEFAULT 0,
+        confidence REAL NOT NULL DEFAULT 1.0,
+        provenance_source TEXT,
+        provenance_ref TEXT,
+        provenance_observed_at TEXT,
+        provenance_context TEXT,
+        created_at TEXT NOT NULL DEFAULT (datetime('now')),
+        updated_at TEXT NOT NULL DEFAULT (datetime('now')),
+        last_accessed TEXT NOT NULL DEFAULT (datetime('now')),
+        access_count INTEGER NOT NULL DEFAULT 0,
+        metadata TEXT
+    );
+    CREATE TABLE hyperedges{s} (
+        id BLOB NOT NULL PRIMARY KEY,
+        edge_type INTEGER NOT NULL,
+        label TEXT,
+        weight REAL NOT NULL DEFAULT 1.0,
+        created_at TEXT NOT NULL DEFAULT (datetime('now')),
+        metadata TEXT
+    );
+    CREATE TABLE membership{s} (
+        hyperedge_id BLOB NOT NULL,
+        node_id BLOB NOT NULL,
+        role TEXT NOT NULL,
+        position INTEGER NOT NULL DEFAULT 0,
+        PRIMARY KEY (hyperedge_id, node_id, role),
+        FOREIGN KEY (hyperedge_id) REFERENCES hyperedges(id) ON DELETE CASCADE,
+        FOREIGN KEY (node_id) REFERENCES nodes(id) ON DELETE CASCADE
+    ) WITHOUT ROWID;
+    CREATE TABLE evolution_log{s} (
+        id INTEGER PRIMARY KEY AUTOINCREMENT,
+        node_id BLOB NOT NULL,
+        operation TEXT NOT NULL,
+        from_tier INTEGER,
+        to_tier INTEGER,
+        reason TEXT,
+        created_at TEXT NOT NULL DEFAULT (datetime('now')),
+        FOREIGN KEY (node_id) REFERENCES nodes(id) ON DELETE CASCADE
+    );
+";
+
+/// Indexes and FTS triggers of the version 3 layout.
+///
+/// `(tier, confidence)` and `(node_type, last_accessed)` serve tier/type
+/// filters and the grouped counts in `stats` from the index alone;
+/// `tier` alone keeps rowid order within a tier for batched consolidation.
+const V3_INDEXES: &str = "
+    CREATE INDEX IF NOT EXISTS idx_nodes_tier ON nodes(tier);
+    CREATE INDEX IF NOT EXISTS idx_nodes_tier_confidence ON nodes(tier, confidence);
+    CREATE INDEX IF NOT EXISTS idx_nodes_type_accessed ON nodes(node_type, last_accessed);
+    CREATE INDEX IF NOT EXISTS idx_nodes_confidence ON nodes(confidence);
+    CREATE INDEX IF NOT EXISTS idx_nodes_last_accessed ON nodes(last_accessed);
+    CREATE INDEX IF NOT EXISTS idx_membership_node ON membership(node_id);
+    CREATE INDEX IF NOT EXISTS idx_evolution_node ON evolution_log(node_id);
+
+    CREATE TRIGGER IF NOT EXISTS nodes_ai AFTER INSERT ON nodes BEGIN
+        INSERT INTO nodes_fts(rowid, content) VALUES (NEW.rowid, NEW.content);
+    END;
+    CREATE TRIGGER IF NOT EXISTS nodes_ad AFTER DELETE ON nodes BEGIN
+        INSERT INTO nodes_fts(nodes_fts, rowid, content) VALUES ('delete', OLD.rowid, OLD.content);
+    END;
+";
+
+/// Copy version 2 rows into the `_v3` tables. Node rowids are kept so
+/// `nodes_fts` stays valid without a rebuild. `{node_type}` and
+/// `{edge_type}` are replaced by the name-to-code `CASE` expressions.
+const V2_TO_V3_COPY: &str = "
+    INSERT INTO nodes_v3 (
+        rowid, id, node_type, subtype, content, embedding, tier, confidence,
+        provenance_source, provenance_ref, provenance_observed_at, provenance_context,
+        created_at, updated_at, last_accessed, access_count, metadata
+    )
+    SELECT rowid, unhex(replace(id, '-', '')), {node_type},
+           subtype, content, embedding, tier, confidence,
+           provenance_source, provenance_ref, provenance_observed_at, provenance_context,
+           created_at, updated_at, last_accessed, access_count, metadata
+    FROM nodes;
+
+    INSERT INTO hyperedges_v3 (id, edge_type, label, weight, created_at, metadata)
+    SELECT unhex(replace(id, '-', '')), {edge_type}, label, weight, created_at, metadata
+    FROM hyperedges;
+
+    INSERT INTO membership_v3 (hyperedge_id, node_id, role, position)
+    SELECT unhex(replace(hyperedge_id, '-', '')), unhex(replace(node_id, '-', '')),
+           role, position
+    FROM membership;
+
+    INSERT INTO evolution_log_v3 (id, node_id, operation, from_tier, to_tier, reason, created_at)
+    SELECT id, unhex(replace(node_id, '-', '')), operation, from_tier, to_tier, reason, created_at
+    FROM evolution_log;
+
+    DROP TABLE evolution_log;
+    DROP TABLE membership;
+    DROP TABLE hyperedges;
+    DROP TABLE nodes;
+
+    ALTER TABLE nodes_v3 RENAME TO nodes;
+    ALTER TABLE hyperedges_v3 RENAME TO hyperedges;
+    ALTER TABLE membership_v3 RENAME TO membership;
+    ALTER TABLE evolution_log_v3 RENAME TO evolution_log;
+";
+
+/// Id columns kept outside the rebuilt tables, as `(table, column)`. The
+/// migration converts their UUID text to blobs in place.
+const DEPENDENT_ID_COLUMNS: &[(&str, &str)] = &[
+    ("embedding_changes", "node_id"),
+    ("reasoning_traces", "root_node_id"),
+    ("reasoning_traces", "root_edge_id"),
+    ("reasoning_trace_nodes", "node_id"),
+    ("reasoning_trace_edges", "edge_id"),
+];
+
+/// How many offending rows a failed migration lists by id.
+const MAX_REPORTED_ROWS: usize = 20;
+
+fn table_exists(conn: &Connection, name: &str) -> SqliteResult<bool> {
+    conn.query_row(
+        "SELECT EXISTS (SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = ?1)",
+        [name],
+        |row| row.get(0),
+    )
+}
+
+/// SQL condition matching `column` values that do not decode to 16 bytes.
+fn not_uuid(column: &str) -> String {
+    format!("(typeof({column}) != 'text' OR length(unhex(replace({column}, '-', ''))) IS NOT 16)")
+}
+
+/// `CASE` expression mapping stored type names in `column` to their codes.
+///
+/// There is no `ELSE`: unknown names are rejected up front by
+/// [`unconvertible_rows`] rather than silently given some other type.
+fn type_code_case<T: std::fmt::Display>(column: &str, codes: &[T]) -> String {
+    let arms: String = codes
+        .iter()
+        .enumerate()
+        .map(|(code, name)| format!(" WHEN '{name}' THEN {code}"))
+        .collect();
+    format!("CASE {column}{arms} END")
+}
+
+/// SQL list of the stored names of `codes`, for `IN (...)`.
+fn type_names<T: std::fmt::Display>(codes: &[T]) -> String {
+    codes
+        .iter()
+        .map(|name| format!("'{name}'"))
+        .collect::<Vec<_>>()
+        .join(", ")
+}
+
+/// Describe every row the version 3 layout cannot represent.
+///
+/// Each entry names the table and column plus the quoted id of the row, so
+/// a failed migration says exactly what to fix instead of tripping a
+/// `NOT NULL` constraint halfway through the copy.
+fn unconvertible_rows(conn: &Connection) -> SqliteResult<Vec<String>> {
+    let mut checks = vec![
+        ("nodes", "id", "id", not_uuid("id")),
+        (
+            "nodes",
+            "node_type",
+            "id",
+            format!(
+                "node_type IS NULL OR node_type NOT IN ({})",
+                type_names(&NODE_TYPE_CODES)
+            ),
+        ),
+        ("hyperedges", "id", "id", not_uuid("id")),
+        (
+            "hyperedges",
+            "edge_type",
+            "id",
+            format!(
+                "edge_type IS NULL OR edge_type NOT IN ({})",
+                type_names(&EDGE_TYPE_CODES)
+            ),
+        ),
+        (
+            "membership",
+            "hyperedge_id",
+            "hyperedge_id",
+            not_uuid("hyperedge_id"),
+        ),
+        ("membership", "node_id", "node_id", not_uuid("node_id")),
+        ("evolution_log", "node_id", "id", not_uuid("node_id")),
+    ];
+    for &(table, column) in DEPENDENT_ID_COLUMNS {
+        if table_exists(conn, table)? {
+            // Nullable references stay NULL; only text has to parse
+            checks.push((
+                table,
+                column,
+                column,
+                format!("typeof({column}) = 'text' AND {}", not_uuid(column)),
+            ));
+        }
+    }
+
+    let mut rows = Vec::new();
+    for (table, column, key, condition) in checks {
+        let mut stmt = conn.prepare(&format!(
+            "SELECT quote({key}) FROM {table} WHERE {condition}"
+        ))?;
+        let mut found = stmt.query([])?;
+        while let Some(row) = found.next()? {
+            let key_value: String = row.get(0)?;
+            rows.push(format!("{table}.{column} of {key} {key_value}"));
+        }
+    }
+    Ok(rows)
+}
+
+/// Apply version 3: binary ids, integer type codes and composite indexes.
+fn migrate_v2_to_v3(conn: &Connection) -> SqliteResult<()> {
+    // Tables are rebuilt, so FK enforcement must be off while they are
+    // swapped; it cannot change inside a transaction.
+    conn.pragma_update(None, "foreign_keys", "OFF")?;
+    let result = (|| {
+        let tx = conn.unchecked_transaction()?;
+
+        let bad_rows = unconvertible_rows(&tx)?;
+        if !bad_rows.is_empty() {
+            let mut listed = bad_rows[..bad_rows.len().min(MAX_REPORTED_ROWS)].join(", ");
+            if bad_rows.len() > MAX_REPORTED_ROWS {
+                listed.push_str(&format!(" and {} more", bad_rows.len() - MAX_REPORTED_ROWS));
+            }
+            return Err(rusqlite::Error::SqliteFailure(
+                rusqlite::ffi::Error::new(rusqlite::ffi::SQLITE_MISMATCH),
+                Some(format!(
+                    "schema v3 migration cannot convert {} values: {}",
+                    bad_rows.len(),
+                    listed
+                )),
+            ));
+        }
+
+        tx.execute_batch(&V3_TABLES.replace("{s}", "_v3"))?;
+        tx.execute_batch(
+            &V2_TO_V3_COPY
+                .replace(
+                    "{node_type}",
+                    &type_code_case("node_type", &NODE_TYPE_CODES),
+                )
+                .replace(
+                    "{edge_type}",
+                    &type_code_case("edge_type", &EDGE_TYPE_CODES),
+                ),
+        )?;
+        tx.execute_batch(V3_INDEXES)?;
+        tx.execute(NODES_AU_TRIGGER, [])?;
+        tx.execute_batch(EMBEDDING_LOG_TRIGGERS)?;
+
+        for (table, column) in DEPENDENT_ID_COLUMNS {
+            if table_exists(&tx, table)? {
+                tx.execute(
+                    &format!(
+                        "UPDATE {table} SET {column} = unhex(replace({column}, '-', ''))
+                         WHERE typeof({column}) = 'text'"
+                    ),
+                    [],
+                )?;
+            }
+        }
+
+        let violations: i64 =
+            tx.query_row("SELECT COUNT(*) FROM pragma_foreign_key_check", [], |row| {
+                row.get(0)
+            })?;
+        if violations > 0 {
+            return Err(rusqlite::Error::SqliteFailure(
+                rusqlite::ffi::Error::new(rusqlite::ffi::SQLITE_CONSTRAINT_FOREIGNKEY),
+                Some(format!(
+                    "schema v3 migration left {} dangling references",
+                    violations
+                )),
+            ));
+        }
+
+        tx.execute("INSERT INTO schema_version (version) VALUES (3)", [])?;
+        tx.commit()
+    })();
+    conn.pragma_update(None, "foreign_keys", "ON")?;
+    result
+}
+
+// ==================== Column Encodings ====================
+
+/// Decode a UUID stored as a 16-byte blob, or as text by older layouts.
+fn uuid_column(value: ValueRef<'_>) -> FromSqlResult<Uuid> {
+    match value {
+        ValueRef::Blob(bytes) => {
+            Uuid::from_slice(bytes).map_err(|e| FromSqlError::Other(Box::new(e)))
+        }
+        ValueRef::Text(text) => std::str::from_utf8(text)
+            .map_err(|e| FromSqlError::Other(Box::new(e)))
+            .and_then(|s| Uuid::parse_str(s).map_err(|e| FromSqlError::Other(Box::new(e)))),
+        _ => Err(FromSqlError::InvalidType),
+    }
+}
+
+impl ToSql for NodeId {
+    fn to_sql(&self) -> SqliteResult<ToSqlOutput<'_>> {
+        Ok(ToSqlOutput::Borrowed(ValueRef::Blob(self.0.as_bytes())))
+    }
+}
+
+impl FromSql for NodeId {
+    fn column_result(value: ValueRef<'_>) -> FromSqlResult<Self> {
+        uuid_column(value).map(Self)
+    }
+}
+
+impl ToSql for EdgeId {
+    fn to_sql(&self) -> SqliteResult<ToSqlOutput<'_>> {
+        Ok(ToSqlOutput::Borrowed(ValueRef::Blob(self.0.as_bytes())))
+    }
+}
+
+impl FromSql for EdgeId {
+    fn column_result(value: ValueRef<'_>) -> FromSqlResult<Self> {
+        uuid_column(value).map(Self)
+    }
+}
+
+/// Storage codes for [`NodeType`]; unknown codes read back as `Fact`.
+const NODE_TYPE_CODES: [NodeType; 5] = [
+    NodeType::Entity,
+    NodeType::Fact,
+    NodeType::Experience,
+    NodeType::Decision,
+    NodeType::Snippet,
+];
+
+/// Storage codes for [`EdgeType`]; unknown codes read back as `Semantic`.
+const EDGE_TYPE_CODES: [EdgeType; 6] = [
+    EdgeType::Semantic,
+    EdgeType::Structural,
+    EdgeType::Causal,
+    EdgeType::Temporal,
+    EdgeType::Reference,
+    EdgeType::Reasoning,
+];
+
+fn code_of<T: PartialEq>(codes: &[T], value: &T) -> i64 {
+    codes.iter().position(|c| c == value).unwrap_or(0) as i64
+}
+
+impl ToSql for NodeType {
+    fn to_sql(&self) -> SqliteResult<ToSqlOutput<'_>> {
+        Ok(ToSqlOutput::from(code_of(&NODE_TYPE_CODES, self)))
+    }
+}
+
+impl FromSql for NodeType {
+    fn column_result(value: ValueRef<'_>) -> FromSqlResult<Self> {
+        let code = value.as_i64()?;
+        Ok(usize::try_from(code)
+            .ok()
+            .and_then(|i| NODE_TYPE_CODES.get(i).copied())
+            .unwrap_or(NodeType::Fact))
+    }
+}
+
+impl ToSql for EdgeType {
+    fn to_sql(&self) -> SqliteResult<ToSqlOutput<'_>> {
+        Ok(ToSqlOutput::from(code_of(&EDGE_TYPE_CODES, self)))
+    }
+}
+
+impl FromSql for EdgeType {
+    fn column_result(value: ValueRef<'_>) -> FromSqlResult<Self> {
+        let code = value.as_i64()?;
+        Ok(usize::try_from(code)
+            .ok()
+            .and_then(|i| EDGE_TYPE_CODES.get(i).copied())
+            .unwrap_or(EdgeType::Semantic))
+    }
+}
+
 /// Get the current schema version.
 pub fn get_schema_version(conn: &Connection) -> SqliteResult<i32> {
     conn.query_row(
@@ -193,13 +644,29 @@ pub fn is_initialized(conn: &Connection) -> bool {
 mod tests {
     use super::*;
 
+    /// A database at schema version 2, as left by releases with text ids.
+    fn v2_database() -> Connection {
+        let conn = Connection::open_in_memory().unwrap();
+        conn.execute(
+            "CREATE TABLE schema_version (
+                version INTEGER PRIMARY KEY,
+                applied_at TEXT NOT NULL DEFAULT (datetime('now'))
+            )",
+            [],
+        )
+        .unwrap();
+        apply_v1_schema(&conn).unwrap();
+        migrate_v1_to_v2(&conn).unwrap();
+        conn
+    }
+
     #[test]
     fn test_initialize_schema() {
         let conn = Connection::open_in_memory().unwrap();
         initialize_schema(&conn).unwrap();
 
         assert!(is_initialized(&conn));
-        assert_eq!(get_schema_version(&conn).unwrap(), 1);
+        assert_eq!(get_schema_version(&conn).unwrap(), SCHEMA_VERSION);
     }
 
     #[test]
@@ -210,7 +677,256 @@ mod tests {
         initialize_schema(&conn).unwrap();
         initialize_schema(&conn).unwrap();
 
-        assert_eq!(get_schema_version(&conn).unwrap(), 1);
+        assert_eq!(get_schema_version(&conn).unwrap(), SCHEMA_VERSION);
+    }
+
+    #[test]
+    fn test_fts_update_trigger_skips_unchanged_content() {
+        let conn = v2_database();
+
+        // Start from the unconditional trigger older databases carry; the
+        // v3 rebuild must replace it
+        conn.execute_batch(
+            "DROP TRIGGER nodes_au;
+             CREATE TRIGGER nodes_au AFTER UPDATE ON nodes BEGIN
+                INSERT INTO nodes_fts(nodes_fts, rowid, content) VALUES ('delete', OLD.rowid, OLD.content);
+                INSERT INTO nodes_fts(rowid, content) VALUES (NEW.rowid, NEW.content);
+             END;",
+        )
+        .unwrap();
+        initialize_schema(&conn).unwrap();
+
+        let id = NodeId::new();
+        conn.execute(
+            "INSERT INTO nodes (id, node_type, content) VALUES (?1, 1, 'alpha')",
+            [&id],
+        )
+        .unwrap();
+        let changes = |conn: &Connection| -> i64 {
+            conn.query_row("SELECT total_changes()", [], |row| row.get(0))
+                .unwrap()
+        };
+
+        let before = changes(&conn);
+        conn.execute("UPDATE nodes SET confidence = 0.5 WHERE id = ?1", [&id])
+            .unwrap();
+        assert_eq!(
+            changes(&conn) - before,
+            1,
+            "no FTS rows for metadata updates"
+        );
+
+        conn.execute("UPDATE nodes SET content = 'beta' WHERE id = ?1", [&id])
+            .unwrap();
+        let hits: i64 = conn
+            .query_row(
+                "SELECT COUNT(*) FROM nodes_fts WHERE nodes_fts MATCH 'beta'",
+                [],
+                |row| row.get(0),
+            )
+            .unwrap();
+        assert_eq!(hits, 1);
+    }
+
+    #[test]
+    fn test_embedding_change_log() {
+        let conn = Connection::open_in_memory().unwrap();
+        initialize_schema(&conn).unwrap();
+        let logged = |conn: &Connection| -> i64 {
+            conn.query_row("SELECT COUNT(*) FROM embedding_changes", [], |row| {
+                row.get(0)
+            })
+            .unwrap()
+        };
+        let plain = NodeId::new();
+        let embedded = NodeId::new();
+
+        conn.execute(
+            "INSERT INTO nodes (id, node_type, content) VALUES (?1, 1, 'a')",
+            [&plain],
+        )
+        .unwrap();
+        assert_eq!(logged(&conn), 0, "nodes without embeddings are not logged");
+
+        conn.execute(
+            "INSERT INTO nodes (id, node_type, content, embedding) VALUES (?1, 1, 'b', x'00')",
+            [&embedded],
+        )
+        .unwrap();
+        conn.execute(
+            "UPDATE nodes SET confidence = 0.5 WHERE id = ?1",
+            [&embedded],
+        )
+        .unwrap();
+        conn.execute("UPDATE nodes SET tier = 0 WHERE id = ?1", [&embedded])
+            .unwrap();
+        assert_eq!(
+            logged(&conn),
+            1,
+            "unchanged embedding and tier are not logged"
+        );
+
+        conn.execute("UPDATE nodes SET tier = 2 WHERE id = ?1", [&embedded])
+            .unwrap();
+        conn.execute(
+            "UPDATE nodes SET embedding = x'01' WHERE id = ?1",
+            [&embedded],
+        )
+        .unwrap();
+        conn.execute("UPDATE nodes SET tier = 3 WHERE id = ?1", [&plain])
+            .unwrap();
+        conn.execute("DELETE FROM nodes", []).unwrap();
+        assert_eq!(logged(&conn), 4);
+
+        let store_id: Vec<u8> = conn
+            .query_row("SELECT store_id FROM vector_index_meta", [], |row| {
+                row.get(0)
+            })
+            .unwrap();
+        assert_eq!(store_id.len(), 16);
+    }
+
+    #[test]
+    fn test_migrates_v2_database() {
+        let conn = v2_database();
+
+        let a = NodeId::new();
+        let b = NodeId::new();
+        let edge = EdgeId::new();
+        conn.execute(
+            "INSERT INTO nodes (id, node_type, content, tier, embedding) VALUES
+                (?1, 'decision', 'alpha beta', 1, x'00'), (?2, 'snippet', 'gamma', 2, NULL)",
+            [a.to_string(), b.to_string()],
+        )
+        .unwrap();
+        conn.execute(
+            "INSERT INTO hyperedges (id, edge_type) VALUES (?1, 'reasoning')",
+            [edge.to_string()],
+        )
+        .unwrap();
+        conn.execute(
+            "INSERT INTO membership (hyperedge_id, node_id, role, position) VALUES
+                (?1, ?2, 'subject', 0), (?1, ?3, 'object', 1)",
+            [edge.to_string(), a.to_string(), b.to_string()],
+        )
+        .unwrap();
+        conn.execute(
+            "INSERT INTO evolution_log (node_id, operation) VALUES (?1, 'promote')",
+            [a.to_string()],
+        )
+        .unwrap();
+
+        initialize_schema(&conn).unwrap();
+        assert_eq!(get_schema_version(&conn).unwrap(), SCHEMA_VERSION);
+
+        let (id, node_type, width): (NodeId, NodeType, i64) = conn
+            .query_row(
+                "SELECT id, node_type, length(id) FROM nodes WHERE tier = 1",
+                [],
+                |row| Ok((row.get(0)?, row.get(1)?, row.get(2)?)),
+            )
+            .unwrap();
+        assert_eq!((id, node_type, width), (a.clone(), NodeType::Decision, 16));
+
+        let edge_type: EdgeType = conn
+            .query_row(
+                "SELECT edge_type FROM hyperedges WHERE id = ?1",
+                [&edge],
+                |row| row.get(0),
+            )
+            .unwrap();
+        assert_eq!(edge_type, EdgeType::Reasoning);
+
+        let members: i64 = conn
+            .query_row(
+                "SELECT COUNT(*) FROM membership m JOIN nodes n ON n.id = m.node_id
+                 WHERE m.hyperedge_id = ?1",
+                [&edge],
+                |row| row.get(0),
+            )
+            .unwrap();
+        assert_eq!(members, 2);
+
+        // The change log written by v2 triggers now holds blob ids too
+        let logged: NodeId = conn
+            .query_row(
+                "SELECT node_id FROM embedding_changes WHERE typeof(node_id) = 'blob'",
+                [],
+                |row| row.get(0),
+            )
+            .unwrap();
+        assert_eq!(logged, a);
+
+        // Rowids were kept, so full-text search still finds migrated rows
+        let hit: NodeId = conn
+            .query_row(
+                "SELECT n.id FROM nodes n JOIN nodes_fts f ON n.rowid = f.rowid
+                 WHERE nodes_fts MATCH 'beta'",
+                [],
+                |row| row.get(0),
+            )
+            .unwrap();
+        assert_eq!(hit, a);
+
+        // Foreign keys are enforced again and cascade through blob ids, and
+        // the rebuilt table still feeds the change log
+        conn.execute("DELETE FROM nodes WHERE id = ?1", [&a])
+            .unwrap();
+        let remaining: i64 = conn
+            .query_row(
+                "SELECT (SELECT COUNT(*) FROM membership) + (SELECT COUNT(*) FROM evolution_log)",
+                [],
+                |row| row.get(0),
+            )
+            .unwrap();
+        assert_eq!(remaining, 1);
+        let log_rows: i64 = conn
+            .query_row("SELECT COUNT(*) FROM embedding_changes", [], |row| {
+                row.get(0)
+            })
+            .unwrap();
+        assert_eq!(log_rows, 2);
+    }
+
+    #[test]
+    fn test_migration_reports_unconvertible_rows() {
+        let conn = v2_database();
+        let good = NodeId::new();
+        let edge = EdgeId::new();
+        conn.execute(
+            "INSERT INTO nodes (id, node_type, content) VALUES
+                (?1, 'fact', 'fine'), ('legacy-7', 'fact', 'bad id')",
+            [good.to_string()],
+        )
+        .unwrap();
+        conn.execute(
+            "INSERT INTO hyperedges (id, edge_type) VALUES (?1, 'mystery')",
+            [edge.to_string()],
+        )
+        .unwrap();
+
+        let err = initialize_schema(&conn).unwrap_err().to_string();
+        assert!(err.contains("nodes.id of id 'legacy-7'"), "{err}");
+        assert!(
+            err.contains(&format!("hyperedges.edge_type of id '{edge}'")),
+            "{err}"
+        );
+        assert!(!err.contains(&good.to_string()), "{err}");
+
+        // Nothing was converted and foreign keys are back on
+        assert_eq!(get_schema_version(&conn).unwrap(), 2);
+        let id_type: String = conn
+            .query_row(
+                "SELECT typeof(id) FROM nodes WHERE id = ?1",
+                [good.to_string()],
+                |row| row.get(0),
+            )
+            .unwrap();
+        assert_eq!(id_type, "text");
+        let foreign_keys: i64 = conn
+            .pragma_query_value(None, "foreign_keys", |row| row.get(0))
+            .unwrap();
+        assert_eq!(foreign_keys, 1);
     }
 
     #[test]
@@ -1,31 +1,299 @@
 //! SQLite-backed memory store implementation.
 
 use crate::error::{Error, Result};
-use crate::memory::schema::{initialize_schema, is_initialized};
+use crate::memory::schema::initialize_schema;
 use crate::memory::types::*;
+use crate::memory::vector::{decode_embedding, encode_embedding, VectorIndex};
+use crate::metrics::{self, Metric};
 use chrono::{DateTime, Utc};
-use rusqlite::{params, Connection, OptionalExtension};
+use rusqlite::functions::FunctionFlags;
+use rusqlite::types::ValueRef;
+use rusqlite::{params, Connection, OpenFlags, OptionalExtension};
+use serde::{Deserialize, Serialize};
 use serde_json::Value;
 use std::collections::HashMap;
-use std::path::Path;
-use std::sync::{Arc, Mutex};
+use std::path::{Path, PathBuf};
+use std::sync::{Arc, Condvar, Mutex, RwLock};
+use std::time::Duration;
+
+/// Tuning options for a file-backed [`SqliteMemoryStore`].
+///
+/// All fields are optional when deserialized from JSON; missing fields take
+/// their default values.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+#[serde(default)]
+pub struct MemoryStoreOptions {
+    /// Number of read-only connections serving queries concurrently with the
+    /// writer. `0` routes every read through the writer connection.
+    pub reader_pool_size: usize,
+    /// SQLite `synchronous` pragma applied to the writer (`OFF`, `NORMAL`, `FULL`).
+    pub synchronous: String,
+    /// How long a connection waits on a locked database before failing.
+    pub busy_timeout_ms: u64,
+    /// Per-connection prepared statement cache capacity.
+    pub statement_cache_capacity: usize,
+}
+
+impl Default for MemoryStoreOptions {
+    fn default() -> Self {
+        Self {
+            reader_pool_size: 4,
+            synchronous: "NORMAL".to_string(),
+            busy_timeout_ms: 5_000,
+            statement_cache_capacity: 64,
+        }
+    }
+}
+
+/// Embedding changes applied in memory before the vector index file is rewritten.
+const VECTOR_SAVE_INTERVAL: usize = 1024;
+
+/// `hood(node_id, hops)`: the nodes within `?2` hops of node `?1`, at most
+/// `?3` of them, nearest first. Ties are broken by id so every query that
+/// reuses the CTE sees the same node set.
+const NEIGHBORHOOD_CTE: &str = "WITH RECURSIVE reach(node_id, depth) AS (
+        SELECT ?1, 0
+        UNION
+        SELECT m2.node_id, r.depth + 1
+        FROM reach r
+        JOIN membership m1 ON m1.node_id = r.node_id
+        JOIN membership m2 ON m2.hyperedge_id = m1.hyperedge_id
+        WHERE r.depth < ?2
+    ),
+    hood AS (
+        SELECT node_id, MIN(depth) AS hops FROM reach
+        GROUP BY node_id ORDER BY hops, node_id LIMIT ?3
+    )";
+
+/// Path of the vector index file kept next to the database at `db_path`.
+pub fn vector_index_path(db_path: &Path) -> PathBuf {
+    let mut path = db_path.as_os_str().to_owned();
+    path.push(".hnsw");
+    PathBuf::from(path)
+}
+
+/// Last sequence number handed out by `embedding_changes`, or 0.
+fn embedding_log_head(conn: &Connection) -> rusqlite::Result<i64> {
+    conn.query_row(
+        "SELECT COALESCE((SELECT seq FROM sqlite_sequence WHERE name = 'embedding_changes'), 0)",
+        [],
+        |row| row.get(0),
+    )
+}
+
+/// An embedding change read from the log: the node's current tier and
+/// embedding, or `None` if it was deleted or lost its embedding.
+type EmbeddingChange = (NodeId, Option<(Tier, Vec<f32>)>);
+
+/// Vector index shared by clones of a store handle.
+struct VectorCache {
+    index: Option<VectorIndex>,
+    /// Last `embedding_changes.seq` reflected in `index`.
+    applied: i64,
+    /// Changes applied since the index file was last written.
+    unsaved: usize,
+    /// Index file for file-backed stores.
+    sidecar: Option<PathBuf>,
+    /// Random id from `vector_index_meta`, tying index files to this database.
+    store_id: Vec<u8>,
+}
+
+impl VectorCache {
+    fn new(conn: &Connection, sidecar: Option<PathBuf>) -> rusqlite::Result<Self> {
+        let store_id = conn.query_row(
+            "SELECT store_id FROM vector_index_meta WHERE id = 0",
+            [],
+            |row| row.get(0),
+        )?;
+        Ok(Self {
+            index: None,
+            applied: 0,
+            unsaved: 0,
+            sidecar,
+            store_id,
+        })
+    }
+
+    /// Key stored in the index file: the store id and the applied sequence.
+    fn key(&self) -> Vec<u8> {
+        let mut key = self.store_id.clone();
+        key.extend_from_slice(&self.applied.to_le_bytes());
+        key
+    }
+
+    /// Adopt the index file if it belongs to this database. Returns whether it did.
+    fn load_sidecar(&mut self) -> bool {
+        let Some(path) = self.sidecar.as_deref() else {
+            return false;
+        };
+        if !path.exists() {
+            return false;
+        }
+        let (index, key) = match VectorIndex::load(path) {
+            Ok(loaded) => loaded,
+            Err(e) => {
+                tracing::warn!("Ignoring unreadable vector index: {}", e);
+                return false;
+            }
+        };
+        let id_len = self.store_id.len();
+        if key.len() != id_len + 8 || key[..id_len] != self.store_id[..] {
+            return false;
+        }
+        let mut seq = [0u8; 8];
+        seq.copy_from_slice(&key[id_len..]);
+        self.index = Some(index);
+        self.applied = i64::from_le_bytes(seq);
+        self.unsaved = 0;
+        true
+    }
+
+    /// Write the index file. Returns whether there was a file to write.
+    fn save(&mut self) -> Result<bool> {
+        let (Some(index), Some(path)) = (self.index.as_ref(), self.sidecar.as_deref()) else {
+            return Ok(false);
+        };
+        index.save(path, &self.key())?;
+        self.unsaved = 0;
+        Ok(true)
+    }
+}
+
+impl Drop for VectorCache {
+    fn drop(&mut self) {
+        if self.unsaved > 0 {
+            if let Err(e) = self.save() {
+                tracing::warn!("Failed to save vector index: {}", e);
+            }
+        }
+    }
+}
+
+/// Fixed-size pool of read-only connections.
+struct ReaderPool {
+    size: usize,
+    idle: Mutex<Vec<Connection>>,
+    available: Condvar,
+}
+
+/// A connection checked out of a [`ReaderPool`], returned on drop so that a
+/// panicking query does not shrink the pool.
+struct PooledReader<'a> {
+    pool: &'a ReaderPool,
+    conn: Option<Connection>,
+}
+
+impl Drop for PooledReader<'_> {
+    fn drop(&mut self) {
+        if let (Some(conn), Ok(mut idle)) = (self.conn.take(), self.pool.idle.lock()) {
+            idle.push(conn);
+            self.pool.available.notify_one();
+        }
+    }
+}
+
+impl ReaderPool {
+    fn with_reader<F, T>(&self, f: F) -> Result<T>
+    where
+        F: FnOnce(&Connection) -> rusqlite::Result<T>,
+    {
+        let wait = metrics::Timer::start(Metric::StoreLockWait);
+        let reader = {
+            let mut idle = self
+                .idle
+                .lock()
+                .map_err(|e| Error::Internal(format!("Failed to lock reader pool: {}", e)))?;
+            loop {
+                if let Some(conn) = idle.pop() {
+                    break PooledReader {
+                        pool: self,
+                        conn: Some(conn),
+                    };
+                }
+                idle = self
+                    .available
+                    .wait(idle)
+                    .map_err(|e| Error::Internal(format!("Failed to lock reader pool: {}", e)))?;
+            }
+        };
+        drop(wait);
+
+        let conn = reader.conn.as_ref().expect("checked out");
+        metrics::time(Metric::SqliteQuery, || f(conn))
+            .map_err(|e| Error::MemoryStorage(e.to_string()))
+    }
+}
 
 /// SQLite-backed memory store.
+///
+/// Writes go through a single writer connection. File-backed stores opened in
+/// WAL mode additionally keep a pool of read-only connections so queries do
+/// not serialize behind writers.
+///
+/// Embedding search is served from an HNSW [`VectorIndex`]. Triggers append
+/// every embedding insert, update, delete and tier change to the
+/// `embedding_changes` log, and each search first applies log entries past
+/// the last one the index reflects, so writes from other handles and other
+/// processes are seen. File-backed stores persist the index next to the
+/// database (see [`vector_index_path`]) keyed by the database's id and log
+/// position, reload it on open and prune the log up to it; the index is only
+/// rebuilt from `nodes` when the file is missing, foreign, or older than the
+/// retained log. Clones share the connections and the index, so a clone can
+/// be handed to a background thread such as a [`MaintenanceScheduler`].
+///
+/// [`MaintenanceScheduler`]: crate::memory::MaintenanceScheduler
+#[derive(Clone)]
 pub struct SqliteMemoryStore {
     conn: Arc<Mutex<Connection>>,
+    readers: Option<Arc<ReaderPool>>,
+    vectors: Arc<RwLock<VectorCache>>,
 }
 
 impl SqliteMemoryStore {
     /// Open or create a memory store at the given path.
     pub fn open(path: impl AsRef<Path>) -> Result<Self> {
+        Self::open_with_options(path, MemoryStoreOptions::default())
+    }
+
+    /// Open or create a memory store at the given path with explicit tuning.
+    pub fn open_with_options(path: impl AsRef<Path>, options: MemoryStoreOptions) -> Result<Self> {
+        let path = path.as_ref();
         let conn = Connection::open(path).map_err(|e| Error::MemoryStorage(e.to_string()))?;
 
-        if !is_initialized(&conn) {
-            initialize_schema(&conn).map_err(|e| Error::MemoryStorage(e.to_string()))?;
-        }
+        // Idempotent; also applies upgrades to databases created earlier.
+        initialize_schema(&conn).map_err(|e| Error::MemoryStorage(e.to_string()))?;
+        Self::configure_writer(&conn, &options).map_err(|e| Error::MemoryStorage(e.to_string()))?;
+        Self::register_functions(&conn).map_err(|e| Error::MemoryStorage(e.to_string()))?;
+
+        let journal_mode: String = conn
+            .pragma_query_value(None, "journal_mode", |row| row.get(0))
+            .map_err(|e| Error::MemoryStorage(e.to_string()))?;
+
+        // Concurrent readers only help when readers don't block the writer.
+        let readers = if options.reader_pool_size > 0 && journal_mode.eq_ignore_ascii_case("wal") {
+            let mut idle = Vec::with_capacity(options.reader_pool_size);
+            for _ in 0..options.reader_pool_size {
+                idle.push(
+                    Self::open_reader(path, &options)
+                        .map_err(|e| Error::MemoryStorage(e.to_string()))?,
+                );
+            }
+            Some(Arc::new(ReaderPool {
+                size: options.reader_pool_size,
+                idle: Mutex::new(idle),
+                available: Condvar::new(),
+            }))
+        } else {
+            None
+        };
+
+        let vectors = VectorCache::new(&conn, Some(vector_index_path(path)))
+            .map_err(|e| Error::MemoryStorage(e.to_string()))?;
 
         Ok(Self {
             conn: Arc::new(Mutex::new(conn)),
+            readers,
+            vectors: Arc::new(RwLock::new(vectors)),
         })
     }
 
@@ -33,135 +301,249 @@ impl SqliteMemoryStore {
     pub fn in_memory() -> Result<Self> {
         let conn = Connection::open_in_memory().map_err(|e| Error::MemoryStorage(e.to_string()))?;
         initialize_schema(&conn).map_err(|e| Error::MemoryStorage(e.to_string()))?;
+        Self::register_functions(&conn).map_err(|e| Error::MemoryStorage(e.to_string()))?;
+        let vectors =
+            VectorCache::new(&conn, None).map_err(|e| Error::MemoryStorage(e.to_string()))?;
 
         Ok(Self {
             conn: Arc::new(Mutex::new(conn)),
+            readers: None,
+            vectors: Arc::new(RwLock::new(vectors)),
         })
     }
 
-    fn with_conn<F, T>(&self, f: F) -> Result<T>
+    /// Number of pooled read-only connections (0 when reads use the writer).
+    pub fn reader_pool_size(&self) -> usize {
+        self.readers.as_ref().map_or(0, |pool| pool.size)
+    }
+
+    fn configure_writer(conn: &Connection, options: &MemoryStoreOptions) -> rusqlite::Result<()> {
+        conn.pragma_update(None, "journal_mode", "WAL")?;
+        conn.pragma_update(None, "synchronous", options.synchronous.as_str())?;
+        conn.pragma_update(None, "foreign_keys", "ON")?;
+        conn.busy_timeout(Duration::from_millis(options.busy_timeout_ms))?;
+        conn.set_prepared_statement_cache_capacity(options.statement_cache_capacity);
+        Ok(())
+    }
+
+    /// Register the SQL functions used by maintenance statements on the writer.
+    ///
+    /// `rlm_decay(confidence, last_accessed, factor, now_ms)` returns
+    /// `confidence * factor^(whole hours since last_accessed / 24)`, or
+    /// `confidence` unchanged if `last_accessed` does not parse.
+    fn register_functions(conn: &Connection) -> rusqlite::Result<()> {
+        conn.create_scalar_function(
+            "rlm_decay",
+            4,
+            FunctionFlags::SQLITE_UTF8 | FunctionFlags::SQLITE_DETERMINISTIC,
+            |ctx| {
+                let confidence: f64 = ctx.get(0)?;
+                let last_accessed: String = ctx.get(1)?;
+                let factor: f64 = ctx.get(2)?;
+                let now_ms: i64 = ctx.get(3)?;
+                let Ok(last_accessed) = DateTime::parse_from_rfc3339(&last_accessed) else {
+                    return Ok(confidence);
+                };
+                let hours = (now_ms - last_accessed.timestamp_millis()) / 3_600_000;
+                Ok(confidence * factor.powf(hours as f64 / 24.0))
+            },
+        )
+    }
+
+    fn open_reader(path: &Path, options: &MemoryStoreOptions) -> rusqlite::Result<Connection> {
+        let conn = Connection::open_with_flags(
+            path,
+            OpenFlags::SQLITE_OPEN_READ_ONLY
+                | OpenFlags::SQLITE_OPEN_NO_MUTEX
+                | OpenFlags::SQLITE_OPEN_URI,
+        )?;
+        conn.busy_timeout(Duration::from_millis(options.busy_timeout_ms))?;
+        conn.set_prepared_statement_cache_capacity(options.statement_cache_capacity);
+        Ok(conn)
+    }
+
+    pub(crate) fn with_conn<F, T>(&self, f: F) -> Result<T>
     where
         F: FnOnce(&Connection) -> rusqlite::Result<T>,
     {
-        let conn = self
-            .conn
-            .lock()
+        let conn = metrics::time(Metric::StoreLockWait, || self.conn.lock())
             .map_err(|e| Error::Internal(format!("Failed to lock connection: {}", e)))?;
-        f(&conn).map_err(|e| Error::MemoryStorage(e.to_string()))
+        metrics::time(Metric::SqliteQuery, || f(&conn))
+            .map_err(|e| Error::MemoryStorage(e.to_string()))
+    }
+
+    /// Run a read-only operation on a pooled reader, falling back to the writer.
+    pub(crate) fn with_read_conn<F, T>(&self, f: F) -> Result<T>
+    where
+        F: FnOnce(&Connection) -> rusqlite::Result<T>,
+    {
+        match &self.readers {
+            Some(pool) => pool.with_reader(f),
+            None => self.with_conn(f),
+        }
     }
 
     // ==================== Node Operations ====================
 
     /// Add a node to the store.
     pub fn add_node(&self, node: &Node) -> Result<()> {
-        self.with_conn(|conn| {
-            let embedding_blob = node
-                .embedding
-                .as_ref()
-                .map(|e| e.iter().flat_map(|f| f.to_le_bytes()).collect::<Vec<u8>>());
+        self.with_conn(|conn| Self::insert_node(conn, node))
+    }
 
-            let provenance_context = node
-                .provenance
-                .as_ref()
-                .and_then(|p| p.context.as_ref())
-                .map(|c| serde_json::to_string(c).unwrap_or_default());
+    /// Add many nodes in a single transaction.
+    ///
+    /// All inserts share one cached prepared statement and one commit, so the
+    /// lock is taken once and the journal is synced once for the whole batch.
+    /// If any insert fails the entire batch is rolled back.
+    pub fn add_nodes(&self, nodes: &[Node]) -> Result<usize> {
+        self.with_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            for node in nodes {
+                Self::insert_node(&tx, node)?;
+            }
+            tx.commit()?;
+            Ok(())
+        })?;
+        Ok(nodes.len())
+    }
 
-            let metadata = node
-                .metadata
+    pub(crate) fn insert_node(conn: &Connection, node: &Node) -> rusqlite::Result<()> {
+        let embedding_blob = node.embedding.as_deref().map(encode_embedding);
+
+        let provenance_context = node
+            .provenance
+            .as_ref()
+            .and_then(|p| p.context.as_ref())
+            .map(|c| serde_json::to_string(c).unwrap_or_default());
+
+        let metadata = node
+            .metadata
+            .as_ref()
+            .map(|m| serde_json::to_string(m).unwrap_or_default());
+
+        let mut stmt = conn.prepare_cached(
+            "INSERT INTO nodes (
+                id, node_type, subtype, content, embedding, tier, confidence,
+                provenance_source, provenance_ref, provenance_observed_at, provenance_context,
+                created_at, updated_at, last_accessed, access_count, metadata
+            ) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15, ?16)",
+        )?;
+        stmt.execute(params![
+            node.id,
+            node.node_type,
+            node.subtype,
+            node.content,
+            embedding_blob,
+            node.tier as i32,
+            node.confidence,
+            node.provenance
                 .as_ref()
-                .map(|m| serde_json::to_string(m).unwrap_or_default());
-
-            conn.execute(
-                "INSERT INTO nodes (
-                    id, node_type, subtype, content, embedding, tier, confidence,
-                    provenance_source, provenance_ref, provenance_observed_at, provenance_context,
-                    created_at, updated_at, last_accessed, access_count, metadata
-                ) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12, ?13, ?14, ?15, ?16)",
-                params![
-                    node.id.to_string(),
-                    node.node_type.to_string(),
-                    node.subtype,
-                    node.content,
-                    embedding_blob,
-                    node.tier as i32,
-                    node.confidence,
-                    node.provenance
-                        .as_ref()
-                        .map(|p| format!("{:?}", p.source_type)),
-                    node.provenance.as_ref().and_then(|p| p.source_ref.clone()),
-                    node.provenance.as_ref().map(|p| p.observed_at.to_rfc3339()),
-                    provenance_context,
-                    node.created_at.to_rfc3339(),
-                    node.updated_at.to_rfc3339(),
-                    node.last_accessed.to_rfc3339(),
-                    node.access_count as i64,
-                    metadata,
-                ],
-            )?;
-            Ok(())
-        })
+                .map(|p| format!("{:?}", p.source_type)),
+            node.provenance.as_ref().and_then(|p| p.source_ref.clone()),
+            node.provenance.as_ref().map(|p| p.observed_at.to_rfc3339()),
+            provenance_context,
+            node.created_at.to_rfc3339(),
+            node.updated_at.to_rfc3339(),
+            node.last_accessed.to_rfc3339(),
+            node.access_count as i64,
+            metadata,
+        ])?;
+        Ok(())
     }
 
     /// Get a node by ID.
     pub fn get_node(&self, id: &NodeId) -> Result<Option<Node>> {
-        self.with_conn(|conn| {
-            conn.query_row(
+        self.with_read_conn(|conn| {
+            conn.prepare_cached(
                 "SELECT id, node_type, subtype, content, embedding, tier, confidence,
                         provenance_source, provenance_ref, provenance_observed_at, provenance_context,
                         created_at, updated_at, last_accessed, access_count, metadata
                  FROM nodes WHERE id = ?1",
-                params![id.to_string()],
-                |row| Self::row_to_node(row),
-            )
+            )?
+            .query_row(params![id], |row| Self::row_to_node(row))
             .optional()
         })
     }
 
     /// Update a node.
     pub fn update_node(&self, node: &Node) -> Result<()> {
+        self.with_conn(|conn| Self::write_node_update(conn, node))
+    }
+
+    /// Update many nodes in a single transaction.
+    pub fn update_nodes(&self, nodes: &[Node]) -> Result<usize> {
         self.with_conn(|conn| {
-            let embedding_blob = node
-                .embedding
-                .as_ref()
-                .map(|e| e.iter().flat_map(|f| f.to_le_bytes()).collect::<Vec<u8>>());
+            let tx = conn.unchecked_transaction()?;
+            for node in nodes {
+                Self::write_node_update(&tx, node)?;
+            }
+            tx.commit()?;
+            Ok(())
+        })?;
+        Ok(nodes.len())
+    }
 
-            let metadata = node
-                .metadata
-                .as_ref()
-                .map(|m| serde_json::to_string(m).unwrap_or_default());
+    fn write_node_update(conn: &Connection, node: &Node) -> rusqlite::Result<()> {
+        let embedding_blob = node.embedding.as_deref().map(encode_embedding);
 
-            conn.execute(
-                "UPDATE nodes SET
-                    content = ?2, embedding = ?3, tier = ?4, confidence = ?5,
-                    updated_at = ?6, last_accessed = ?7, access_count = ?8, metadata = ?9
-                 WHERE id = ?1",
-                params![
-                    node.id.to_string(),
-                    node.content,
-                    embedding_blob,
-                    node.tier as i32,
-                    node.confidence,
-                    node.updated_at.to_rfc3339(),
-                    node.last_accessed.to_rfc3339(),
-                    node.access_count as i64,
-                    metadata,
-                ],
-            )?;
-            Ok(())
-        })
+        let metadata = node
+            .metadata
+            .as_ref()
+            .map(|m| serde_json::to_string(m).unwrap_or_default());
+
+        let mut stmt = conn.prepare_cached(
+            "UPDATE nodes SET
+                content = ?2, embedding = ?3, tier = ?4, confidence = ?5,
+                updated_at = ?6, last_accessed = ?7, access_count = ?8, metadata = ?9
+             WHERE id = ?1",
+        )?;
+        stmt.execute(params![
+            node.id,
+            node.content,
+            embedding_blob,
+            node.tier as i32,
+            node.confidence,
+            node.updated_at.to_rfc3339(),
+            node.last_accessed.to_rfc3339(),
+            node.access_count as i64,
+            metadata,
+        ])?;
+        Ok(())
     }
 
     /// Delete a node.
     pub fn delete_node(&self, id: &NodeId) -> Result<bool> {
         self.with_conn(|conn| {
-            let rows = conn.execute("DELETE FROM nodes WHERE id = ?1", params![id.to_string()])?;
+            let rows = conn.execute("DELETE FROM nodes WHERE id = ?1", params![id])?;
             Ok(rows > 0)
         })
     }
 
+    /// Delete many nodes in a single transaction.
+    ///
+    /// Returns the number of nodes that existed and were removed.
+    pub fn delete_nodes(&self, ids: &[NodeId]) -> Result<usize> {
+        self.with_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            let deleted = Self::delete_node_rows(&tx, ids)?;
+            tx.commit()?;
+            Ok(deleted)
+        })
+    }
+
+    /// Delete `ids` on `conn`, returning how many of them existed.
+    pub(crate) fn delete_node_rows(conn: &Connection, ids: &[NodeId]) -> rusqlite::Result<usize> {
+        let mut stmt = conn.prepare_cached("DELETE FROM nodes WHERE id = ?1")?;
+        let mut deleted = 0;
+        for id in ids {
+            deleted += stmt.execute(params![id])?;
+        }
+        Ok(deleted)
+    }
+
     /// Query nodes.
     pub fn query_nodes(&self, query: &NodeQuery) -> Result<Vec<Node>> {
-        self.with_conn(|conn| {
+        self.with_read_conn(|conn| {
             let mut sql = String::from(
                 "SELECT id, node_type, subtype, content, embedding, tier, confidence,
                         provenance_source, provenance_ref, provenance_observed_at, provenance_context,
@@ -174,7 +556,7 @@ impl SqliteMemoryStore {
                 let placeholders: Vec<String> = types.iter().map(|_| "?".to_string()).collect();
                 sql.push_str(&format!(" AND node_type IN ({})", placeholders.join(",")));
                 for t in types {
-                    params_vec.push(Box::new(t.to_string()));
+                    params_vec.push(Box::new(*t));
                 }
             }
 
@@ -204,6 +586,8 @@ impl SqliteMemoryStore {
             let params_refs: Vec<&dyn rusqlite::ToSql> =
                 params_vec.iter().map(|b| b.as_ref()).collect();
 
+            // The SQL varies with the filters and limits, so caching it would
+            // only churn the statement cache.
             let mut stmt = conn.prepare(&sql)?;
             let nodes = stmt
                 .query_map(params_refs.as_slice(), |row| Self::row_to_node(row))?
@@ -216,8 +600,8 @@ impl SqliteMemoryStore {
 
     /// Full-text search on content.
     pub fn search_content(&self, query: &str, limit: usize) -> Result<Vec<Node>> {
-        self.with_conn(|conn| {
-            let mut stmt = conn.prepare(
+        self.with_read_conn(|conn| {
+            let mut stmt = conn.prepare_cached(
                 "SELECT n.id, n.node_type, n.subtype, n.content, n.embedding, n.tier, n.confidence,
                         n.provenance_source, n.provenance_ref, n.provenance_observed_at, n.provenance_context,
                         n.created_at, n.updated_at, n.last_accessed, n.access_count, n.metadata
@@ -238,33 +622,18 @@ impl SqliteMemoryStore {
     }
 
     fn row_to_node(row: &rusqlite::Row) -> rusqlite::Result<Node> {
-        let id_str: String = row.get(0)?;
-        let node_type_str: String = row.get(1)?;
         let tier_int: i32 = row.get(5)?;
 
-        let embedding: Option<Vec<f32>> = row.get::<_, Option<Vec<u8>>>(4)?.map(|bytes| {
-            bytes
-                .chunks(4)
-                .map(|chunk| {
-                    let arr: [u8; 4] = chunk.try_into().unwrap_or([0; 4]);
-                    f32::from_le_bytes(arr)
-                })
-                .collect()
-        });
+        // Decode straight from SQLite's buffer rather than copying the blob first.
+        let embedding: Option<Vec<f32>> = match row.get_ref(4)? {
+            ValueRef::Blob(bytes) => Some(decode_embedding(bytes)),
+            _ => None,
+        };
 
         let metadata: Option<HashMap<String, Value>> = row
             .get::<_, Option<String>>(15)?
             .and_then(|s| serde_json::from_str(&s).ok());
 
-        let node_type = match node_type_str.as_str() {
-            "entity" => NodeType::Entity,
-            "fact" => NodeType::Fact,
-            "experience" => NodeType::Experience,
-            "decision" => NodeType::Decision,
-            "snippet" => NodeType::Snippet,
-            _ => NodeType::Fact,
-        };
-
         let tier = match tier_int {
             0 => Tier::Task,
             1 => Tier::Session,
@@ -274,8 +643,8 @@ impl SqliteMemoryStore {
         };
 
         Ok(Node {
-            id: NodeId::parse(&id_str).unwrap_or_else(|_| NodeId::new()),
-            node_type,
+            id: row.get(0)?,
+            node_type: row.get(1)?,
             subtype: row.get(2)?,
             content: row.get(3)?,
             embedding,
@@ -290,141 +659,443 @@ impl SqliteMemoryStore {
         })
     }
 
+    // ==================== Embedding Search ====================
+
+    /// Find the `k` nodes whose embeddings are most similar to `query`.
+    ///
+    /// Results are ordered best first with their cosine similarity. Nodes
+    /// without an embedding, or with a different dimension than the index,
+    /// are never returned. `tier` restricts results to a single tier.
+    pub fn search_embedding(
+        &self,
+        query: &[f32],
+        k: usize,
+        tier: Option<Tier>,
+    ) -> Result<Vec<(Node, f32)>> {
+        let hits = self.with_vector_index(|index| {
+            if !index.is_empty() && query.len() != index.dim() {
+                return Err(Error::MemoryStorage(format!(
+                    "Embedding dimension mismatch: expected {}, got {}",
+                    index.dim(),
+                    query.len()
+                )));
+            }
+            Ok(index.search(query, k, tier))
+        })?;
+        let scores: HashMap<NodeId, f32> = hits.iter().cloned().collect();
+        let ids: Vec<NodeId> = hits.into_iter().map(|(id, _)| id).collect();
+        Ok(self
+            .get_nodes(&ids)?
+            .into_iter()
+            .map(|n| {
+                let score = scores[&n.id];
+                (n, score)
+            })
+            .collect())
+    }
+
+    /// Rank nodes by both full-text relevance and embedding similarity.
+    ///
+    /// The two candidate lists are merged with reciprocal rank fusion, so a
+    /// node ranked highly by either signal surfaces even if the other misses
+    /// it. Returned scores are fused RRF scores, not similarities.
+    pub fn search_hybrid(
+        &self,
+        text: &str,
+        query: &[f32],
+        k: usize,
+        tier: Option<Tier>,
+    ) -> Result<Vec<(Node, f32)>> {
+        const RRF_K: f32 = 60.0;
+        let pool = k.saturating_mul(4).max(k);
+
+        let lexical: Vec<Node> = self
+            .search_content(text, pool)?
+            .into_iter()
+            .filter(|n| tier.map_or(true, |t| n.tier == t))
+            .collect();
+        let semantic = self.search_embedding(query, pool, tier)?;
+
+        let mut fused: HashMap<NodeId, (Node, f32)> = HashMap::new();
+        let ranked = lexical
+            .into_iter()
+            .enumerate()
+            .chain(semantic.into_iter().map(|(n, _)| n).enumerate());
+        for (rank, node) in ranked {
+            let contribution = 1.0 / (RRF_K + rank as f32 + 1.0);
+            fused.entry(node.id.clone()).or_insert((node, 0.0)).1 += contribution;
+        }
+
+        let mut results: Vec<(Node, f32)> = fused.into_values().collect();
+        results.sort_by(|a, b| b.1.total_cmp(&a.1));
+        results.truncate(k);
+        Ok(results)
+    }
+
+    /// Load nodes by ID, preserving the order of `ids` and skipping misses.
+    pub(crate) fn get_nodes(&self, ids: &[NodeId]) -> Result<Vec<Node>> {
+        if ids.is_empty() {
+            return Ok(Vec::new());
+        }
+        let mut found: HashMap<NodeId, Node> = self.with_read_conn(|conn| {
+            let sql = format!(
+                "SELECT id, node_type, subtype, content, embedding, tier, confidence,
+                        provenance_source, provenance_ref, provenance_observed_at, provenance_context,
+                        created_at, updated_at, last_accessed, access_count, metadata
+                 FROM nodes WHERE id IN ({})",
+                vec!["?"; ids.len()].join(",")
+            );
+            let mut stmt = conn.prepare(&sql)?;
+            let nodes = stmt
+                .query_map(
+                    rusqlite::params_from_iter(ids),
+                    |row| Self::row_to_node(row),
+                )?
+                .filter_map(|r| r.ok())
+                .map(|n| (n.id.clone(), n))
+                .collect();
+            Ok(nodes)
+        })?;
+        Ok(ids.iter().filter_map(|id| found.remove(id)).collect())
+    }
+
+    /// Run `f` against the vector index after bringing it up to date.
+    fn with_vector_index<F, T>(&self, f: F) -> Result<T>
+    where
+        F: FnOnce(&VectorIndex) -> Result<T>,
+    {
+        let head = self.with_read_conn(embedding_log_head)?;
+        {
+            let cache = self
+                .vectors
+                .read()
+                .map_err(|e| Error::Internal(format!("Failed to lock vector index: {}", e)))?;
+            if let Some(index) = cache.index.as_ref().filter(|_| cache.applied == head) {
+                return f(index);
+            }
+        }
+
+        let mut cache = self
+            .vectors
+            .write()
+            .map_err(|e| Error::Internal(format!("Failed to lock vector index: {}", e)))?;
+        self.sync_vector_index(&mut cache)?;
+        f(cache.index.as_ref().expect("vector index synced above"))
+    }
+
+    /// Apply logged embedding changes, loading or rebuilding the index if the
+    /// log no longer reaches back to the position it reflects.
+    fn sync_vector_index(&self, cache: &mut VectorCache) -> Result<()> {
+        let mut delta = match cache.index {
+            Some(_) => self.read_embedding_changes(cache.applied)?,
+            None => None,
+        };
+        if delta.is_none() {
+            cache.index = None;
+            if cache.load_sidecar() {
+                delta = self.read_embedding_changes(cache.applied)?;
+            }
+        }
+
+        let rebuilt = match delta {
+            Some((head, changes)) => {
+                let index = cache.index.as_mut().expect("delta implies an index");
+                for (id, state) in &changes {
+                    match state {
+                        Some((tier, embedding)) => {
+                            index.upsert(id, *tier, embedding);
+                        }
+                        None => {
+                            index.remove(id);
+                        }
+                    }
+                }
+                cache.applied = head;
+                cache.unsaved += changes.len();
+                false
+            }
+            None => {
+                let (head, index) = self.build_vector_index()?;
+                cache.unsaved = index.len();
+                cache.index = Some(index);
+                cache.applied = head;
+                true
+            }
+        };
+
+        if (rebuilt && cache.unsaved > 0) || cache.unsaved >= VECTOR_SAVE_INTERVAL {
+            // The in-memory index is already current; a failed save only
+            // costs a rebuild later.
+            if let Err(e) = self.persist_vector_index(cache) {
+                tracing::warn!("Failed to save vector index: {}", e);
+            }
+        }
+        Ok(())
+    }
+
+    /// Read changes after `applied` in one snapshot, returning the new log
+    /// head with them, or `None` if entries after `applied` were pruned.
+    fn read_embedding_changes(&self, applied: i64) -> Result<Option<(i64, Vec<EmbeddingChange>)>> {
+        self.with_read_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            let head = embedding_log_head(&tx)?;
+            let oldest: Option<i64> =
+                tx.query_row("SELECT MIN(seq) FROM embedding_changes", [], |row| {
+                    row.get(0)
+                })?;
+            // Everything before `oldest` (or the whole log, if empty) is pruned.
+            let retained_after = oldest.map_or(head, |seq| seq - 1);
+            if applied > head || applied < retained_after {
+                return Ok(None);
+            }
+
+            let mut changes = Vec::new();
+            {
+                let mut stmt = tx.prepare_cached(
+                    "SELECT c.node_id, n.tier, n.embedding
+                     FROM (SELECT DISTINCT node_id FROM embedding_changes
+                           WHERE seq > ?1 AND seq <= ?2) c
+                     LEFT JOIN nodes n ON n.id = c.node_id",
+                )?;
+                let mut rows = stmt.query(params![applied, head])?;
+                while let Some(row) = rows.next()? {
+                    let Ok(id) = row.get::<_, NodeId>(0) else {
+                        continue;
+                    };
+                    let state = match row.get_ref(2)? {
+                        ValueRef::Blob(bytes) => {
+                            Some((int_to_tier(row.get(1)?), decode_embedding(bytes)))
+                        }
+                        _ => None,
+                    };
+                    changes.push((id, state));
+                }
+            }
+            tx.commit()?;
+            Ok(Some((head, changes)))
+        })
+    }
+
+    /// Build the index from `nodes`, returning it with the log head it reflects.
+    fn build_vector_index(&self) -> Result<(i64, VectorIndex)> {
+        self.with_read_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            let head = embedding_log_head(&tx)?;
+            let mut index = VectorIndex::new();
+            {
+                let mut stmt = tx.prepare_cached(
+                    "SELECT id, tier, embedding FROM nodes WHERE embedding IS NOT NULL",
+                )?;
+                let mut rows = stmt.query([])?;
+                while let Some(row) = rows.next()? {
+                    let Ok(id) = row.get::<_, NodeId>(0) else {
+                        continue;
+                    };
+                    if let ValueRef::Blob(bytes) = row.get_ref(2)? {
+                        index.upsert(&id, int_to_tier(row.get(1)?), &decode_embedding(bytes));
+                    }
+                }
+            }
+            tx.commit()?;
+            Ok((head, index))
+        })
+    }
+
+    /// Write the index file and drop the log entries it covers.
+    fn persist_vector_index(&self, cache: &mut VectorCache) -> Result<()> {
+        if cache.save()? {
+            let applied = cache.applied;
+            self.with_conn(|conn| {
+                conn.execute(
+                    "DELETE FROM embedding_changes WHERE seq <= ?1",
+                    params![applied],
+                )
+            })?;
+        }
+        Ok(())
+    }
+
+    /// Bring the vector index up to date and write it next to the database.
+    ///
+    /// File-backed stores also save periodically during searches and when the
+    /// last handle is dropped; this forces a save now. No-op for in-memory stores.
+    pub fn save_vector_index(&self) -> Result<()> {
+        let mut cache = self
+            .vectors
+            .write()
+            .map_err(|e| Error::Internal(format!("Failed to lock vector index: {}", e)))?;
+        self.sync_vector_index(&mut cache)?;
+        self.persist_vector_index(&mut cache)
+    }
+
     // ==================== Edge Operations ====================
 
     /// Add a hyperedge.
     pub fn add_edge(&self, edge: &HyperEdge) -> Result<()> {
         self.with_conn(|conn| {
-            let metadata = edge
-                .metadata
-                .as_ref()
-                .map(|m| serde_json::to_string(m).unwrap_or_default());
-
-            conn.execute(
-                "INSERT INTO hyperedges (id, edge_type, label, weight, created_at, metadata)
-                 VALUES (?1, ?2, ?3, ?4, ?5, ?6)",
-                params![
-                    edge.id.to_string(),
-                    edge.edge_type.to_string(),
-                    edge.label,
-                    edge.weight,
-                    edge.created_at.to_rfc3339(),
-                    metadata,
-                ],
-            )?;
+            let tx = conn.unchecked_transaction()?;
+            Self::insert_edge(&tx, edge)?;
+            tx.commit()
+        })
+    }
 
-            // Add memberships
-            for member in &edge.members {
-                conn.execute(
-                    "INSERT INTO membership (hyperedge_id, node_id, role, position)
-                     VALUES (?1, ?2, ?3, ?4)",
-                    params![
-                        edge.id.to_string(),
-                        member.node_id.to_string(),
-                        member.role,
-                        member.position,
-                    ],
-                )?;
+    /// Add many hyperedges (with their memberships) in a single transaction.
+    pub fn add_edges(&self, edges: &[HyperEdge]) -> Result<usize> {
+        self.with_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            for edge in edges {
+                Self::insert_edge(&tx, edge)?;
             }
-
-            Ok(())
+            tx.commit()?;
+            Ok(edges.len())
         })
     }
 
+    pub(crate) fn insert_edge(conn: &Connection, edge: &HyperEdge) -> rusqlite::Result<()> {
+        let metadata = edge
+            .metadata
+            .as_ref()
+            .map(|m| serde_json::to_string(m).unwrap_or_default());
+
+        conn.prepare_cached(
+            "INSERT INTO hyperedges (id, edge_type, label, weight, created_at, metadata)
+             VALUES (?1, ?2, ?3, ?4, ?5, ?6)",
+        )?
+        .execute(params![
+            edge.id,
+            edge.edge_type,
+            edge.label,
+            edge.weight,
+            edge.created_at.to_rfc3339(),
+            metadata,
+        ])?;
+
+        // Add memberships
+        let mut stmt = conn.prepare_cached(
+            "INSERT INTO membership (hyperedge_id, node_id, role, position)
+             VALUES (?1, ?2, ?3, ?4)",
+        )?;
+        for member in &edge.members {
+            stmt.execute(params![
+                edge.id,
+                member.node_id,
+                member.role,
+                member.position,
+            ])?;
+        }
+
+        Ok(())
+    }
+
     /// Get edges connected to a node.
+    ///
+    /// Edges and all their members are loaded with a single joined query.
     pub fn get_edges_for_node(&self, node_id: &NodeId) -> Result<Vec<HyperEdge>> {
-        self.with_conn(|conn| {
-            let mut stmt = conn.prepare(
-                "SELECT DISTINCT e.id, e.edge_type, e.label, e.weight, e.created_at, e.metadata
+        self.with_read_conn(|conn| {
+            let mut stmt = conn.prepare_cached(
+                "SELECT e.id, e.edge_type, e.label, e.weight, e.created_at, e.metadata,
+                        m.node_id, m.role, m.position
                  FROM hyperedges e
-                 JOIN membership m ON e.id = m.hyperedge_id
-                 WHERE m.node_id = ?1",
+                 LEFT JOIN membership m ON m.hyperedge_id = e.id
+                 WHERE e.id IN (SELECT hyperedge_id FROM membership WHERE node_id = ?1)
+                 ORDER BY e.created_at, e.id, m.position",
             )?;
+            let rows = stmt.query(params![node_id])?;
+            Self::collect_edges(rows)
+        })
+    }
 
-            let edge_ids: Vec<String> = stmt
-                .query_map(params![node_id.to_string()], |row| row.get(0))?
+    /// Expand the `depth`-hop neighbourhood of a node in one call.
+    ///
+    /// Reachability is computed by a recursive CTE over `membership`, so the
+    /// whole traversal runs inside SQLite. At most `limit` nodes are returned,
+    /// nearest first; the origin is always included if it exists. Edges are
+    /// those whose members are all within the returned node set.
+    pub fn neighborhood(&self, node_id: &NodeId, depth: u32, limit: usize) -> Result<Subgraph> {
+        let depth = depth as i64;
+        let limit = limit.min(i64::MAX as usize) as i64;
+        self.with_read_conn(|conn| {
+            let mut stmt = conn.prepare_cached(&format!(
+                "{NEIGHBORHOOD_CTE}
+                 SELECT n.id, n.node_type, n.subtype, n.content, n.embedding, n.tier, n.confidence,
+                        n.provenance_source, n.provenance_ref, n.provenance_observed_at, n.provenance_context,
+                        n.created_at, n.updated_at, n.last_accessed, n.access_count, n.metadata
+                 FROM hood JOIN nodes n ON n.id = hood.node_id
+                 ORDER BY hood.hops"
+            ))?;
+            let nodes: Vec<Node> = stmt
+                .query_map(params![node_id, depth, limit], |row| {
+                    Self::row_to_node(row)
+                })?
                 .filter_map(|r| r.ok())
                 .collect();
 
-            let mut edges = Vec::new();
-            for edge_id in edge_ids {
-                if let Some(edge) = self.get_edge_internal(conn, &edge_id)? {
-                    edges.push(edge);
-                }
+            if nodes.is_empty() {
+                return Ok(Subgraph::default());
             }
 
-            Ok(edges)
+            let mut stmt = conn.prepare_cached(&format!(
+                "{NEIGHBORHOOD_CTE}
+                 SELECT e.id, e.edge_type, e.label, e.weight, e.created_at, e.metadata,
+                        m.node_id, m.role, m.position
+                 FROM hyperedges e
+                 LEFT JOIN membership m ON m.hyperedge_id = e.id
+                 WHERE e.id IN (SELECT hyperedge_id FROM membership
+                                WHERE node_id IN (SELECT node_id FROM hood))
+                 ORDER BY e.created_at, e.id, m.position"
+            ))?;
+            let rows = stmt.query(params![node_id, depth, limit])?;
+
+            let in_hood: std::collections::HashSet<&NodeId> = nodes.iter().map(|n| &n.id).collect();
+            let edges = Self::collect_edges(rows)?
+                .into_iter()
+                .filter(|e| e.members.iter().all(|m| in_hood.contains(&m.node_id)))
+                .collect();
+
+            Ok(Subgraph { nodes, edges })
         })
     }
 
-    fn get_edge_internal(
-        &self,
-        conn: &Connection,
-        edge_id: &str,
-    ) -> rusqlite::Result<Option<HyperEdge>> {
-        let edge_opt = conn
-            .query_row(
-                "SELECT id, edge_type, label, weight, created_at, metadata
-                 FROM hyperedges WHERE id = ?1",
-                params![edge_id],
-                |row| {
-                    let edge_type_str: String = row.get(1)?;
-                    let edge_type = match edge_type_str.as_str() {
-                        "semantic" => EdgeType::Semantic,
-                        "structural" => EdgeType::Structural,
-                        "causal" => EdgeType::Causal,
-                        "temporal" => EdgeType::Temporal,
-                        "reference" => EdgeType::Reference,
-                        "reasoning" => EdgeType::Reasoning,
-                        _ => EdgeType::Semantic,
-                    };
-
-                    Ok(HyperEdge {
-                        id: EdgeId::parse(&row.get::<_, String>(0)?)
-                            .unwrap_or_else(|_| EdgeId::new()),
-                        edge_type,
-                        label: row.get(2)?,
-                        weight: row.get(3)?,
-                        members: Vec::new(),
-                        created_at: parse_datetime(row.get::<_, String>(4)?),
-                        metadata: row
-                            .get::<_, Option<String>>(5)?
-                            .and_then(|s| serde_json::from_str(&s).ok()),
-                    })
-                },
-            )
-            .optional()?;
-
-        if let Some(mut edge) = edge_opt {
-            // Load members
-            let mut stmt = conn.prepare(
-                "SELECT node_id, role, position FROM membership WHERE hyperedge_id = ?1 ORDER BY position",
-            )?;
-            edge.members = stmt
-                .query_map(params![edge_id], |row| {
-                    Ok(EdgeMember {
-                        node_id: NodeId::parse(&row.get::<_, String>(0)?)
-                            .unwrap_or_else(|_| NodeId::new()),
-                        role: row.get(1)?,
-                        position: row.get(2)?,
-                    })
-                })?
-                .filter_map(|r| r.ok())
-                .collect();
+    /// Fold `(edge columns..., member columns...)` rows, ordered by edge, into edges.
+    fn collect_edges(mut rows: rusqlite::Rows<'_>) -> rusqlite::Result<Vec<HyperEdge>> {
+        let mut edges: Vec<HyperEdge> = Vec::new();
+        let mut current_id: Option<EdgeId> = None;
+
+        while let Some(row) = rows.next()? {
+            let edge_id: EdgeId = row.get(0)?;
+            if current_id.as_ref() != Some(&edge_id) {
+                edges.push(HyperEdge {
+                    id: edge_id.clone(),
+                    edge_type: row.get(1)?,
+                    label: row.get(2)?,
+                    weight: row.get(3)?,
+                    members: Vec::new(),
+                    created_at: parse_datetime(row.get::<_, String>(4)?),
+                    metadata: row
+                        .get::<_, Option<String>>(5)?
+                        .and_then(|s| serde_json::from_str(&s).ok()),
+                });
+                current_id = Some(edge_id);
+            }
 
-            Ok(Some(edge))
-        } else {
-            Ok(None)
+            if let Some(member_id) = row.get::<_, Option<NodeId>>(6)? {
+                if let Some(edge) = edges.last_mut() {
+                    edge.members.push(EdgeMember {
+                        node_id: member_id,
+                        role: row.get(7)?,
+                        position: row.get(8)?,
+                    });
+                }
+            }
         }
+
+        Ok(edges)
     }
 
     /// Delete an edge.
     pub fn delete_edge(&self, id: &EdgeId) -> Result<bool> {
         self.with_conn(|conn| {
-            let rows = conn.execute(
-                "DELETE FROM hyperedges WHERE id = ?1",
-                params![id.to_string()],
-            )?;
+            let rows = conn.execute("DELETE FROM hyperedges WHERE id = ?1", params![id])?;
             Ok(rows > 0)
         })
     }
@@ -458,44 +1129,116 @@ impl SqliteMemoryStore {
     }
 
     /// Apply decay to nodes based on time and access patterns.
+    ///
+    /// Runs [`decay_batch`](Self::decay_batch) over the whole store, so the
+    /// writer lock is held for one batch at a time rather than the full scan.
     pub fn decay(&self, factor: f64, min_confidence: f64) -> Result<Vec<NodeId>> {
-        let nodes = self.query_nodes(&NodeQuery::new().min_confidence(min_confidence))?;
         let mut decayed = Vec::new();
-
-        for mut node in nodes {
-            // Decay formula: confidence * factor^(hours_since_access / 24)
-            let hours = (Utc::now() - node.last_accessed).num_hours() as f64;
-            let decay_exponent = hours / 24.0;
-            let new_confidence = node.confidence * factor.powf(decay_exponent);
-
-            if new_confidence < node.confidence {
-                node.confidence = new_confidence.max(0.0);
-                node.updated_at = Utc::now();
-                self.update_node(&node)?;
-                decayed.push(node.id.clone());
+        let mut cursor = 0;
+        loop {
+            let batch = self.decay_batch(factor, min_confidence, cursor, MAINTENANCE_BATCH_SIZE)?;
+            decayed.extend(batch.changed);
+            if batch.done {
+                return Ok(decayed);
             }
+            cursor = batch.cursor;
         }
+    }
 
-        Ok(decayed)
+    /// Decay up to `limit` nodes after `cursor`, in one transaction.
+    ///
+    /// Start with a cursor of 0 and pass each result's `cursor` to the next
+    /// call until `done`. The batch's rowid range is found first, then one
+    /// set-based UPDATE decays it, computing the new confidence inside SQLite
+    /// with the `rlm_decay` function. Only `confidence` and `last_accessed`
+    /// are read and only `confidence` and `updated_at` are written, so
+    /// neither the FTS index nor the vector index is touched.
+    pub fn decay_batch(
+        &self,
+        factor: f64,
+        min_confidence: f64,
+        cursor: i64,
+        limit: usize,
+    ) -> Result<MaintenanceBatch> {
+        let now = Utc::now();
+        let now_ms = now.timestamp_millis();
+        let updated_at = now.to_rfc3339();
+        self.with_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            // `+confidence` keeps the planner on the rowid range scan
+            // instead of sorting the confidence index every batch.
+            let (end, scanned): (Option<i64>, i64) = tx
+                .prepare_cached(
+                    "SELECT MAX(rowid), COUNT(*) FROM (
+                         SELECT rowid FROM nodes WHERE rowid > ?1 AND +confidence >= ?2
+                         ORDER BY rowid LIMIT ?3
+                     )",
+                )?
+                .query_row(params![cursor, min_confidence, limit as i64], |row| {
+                    Ok((row.get(0)?, row.get(1)?))
+                })?;
+            let mut batch = MaintenanceBatch {
+                cursor: end.unwrap_or(cursor),
+                scanned: scanned as usize,
+                ..Default::default()
+            };
+
+            if scanned > 0 {
+                let mut update = tx.prepare_cached(
+                    "UPDATE nodes
+                     SET confidence = max(rlm_decay(confidence, last_accessed, ?3, ?4), 0.0),
+                         updated_at = ?5
+                     WHERE rowid > ?1 AND rowid <= ?2 AND +confidence >= ?6
+                       AND rlm_decay(confidence, last_accessed, ?3, ?4) < confidence
+                     RETURNING id",
+                )?;
+                let mut rows = update.query(params![
+                    cursor,
+                    batch.cursor,
+                    factor,
+                    now_ms,
+                    updated_at,
+                    min_confidence
+                ])?;
+                while let Some(row) = rows.next()? {
+                    if let Ok(id) = row.get::<_, NodeId>(0) {
+                        batch.changed.push(id);
+                    }
+                }
+            }
+            tx.commit()?;
+            batch.done = batch.scanned < limit;
+            Ok(batch)
+        })
     }
 
     /// Consolidate nodes from one tier to another.
+    ///
+    /// Every node in `from_tier` moves to `to_tier`, which must be a later
+    /// tier, processed [`MAINTENANCE_BATCH_SIZE`] nodes per transaction.
+    /// `source_nodes` lists every node that was in `from_tier`; all of them
+    /// are promoted, so `promoted_nodes` holds the same ids.
     pub fn consolidate(&self, from_tier: Tier, to_tier: Tier) -> Result<ConsolidationResult> {
-        let nodes = self.query_nodes(&NodeQuery::new().tiers(vec![from_tier]))?;
-        let source_ids: Vec<NodeId> = nodes.iter().map(|n| n.id.clone()).collect();
-
-        // For now, just promote nodes above a confidence threshold
-        let promoted = self.promote(
-            &source_ids
-                .iter()
-                .filter(|_| true)
-                .cloned()
-                .collect::<Vec<_>>(),
-            &format!("Consolidation from {} to {}", from_tier, to_tier),
-        )?;
+        let reason = format!("Consolidation from {} to {}", from_tier, to_tier);
+        let mut promoted = Vec::new();
+        let mut cursor = 0;
+        loop {
+            let batch = self.consolidate_batch(
+                from_tier,
+                to_tier,
+                cursor,
+                MAINTENANCE_BATCH_SIZE,
+                &reason,
+            )?;
+            promoted.extend(batch.changed);
+            if batch.done {
+                break;
+            }
+            cursor = batch.cursor;
+        }
 
         Ok(ConsolidationResult {
-            source_nodes: source_ids,
+            source_nodes: promoted.clone(),
             consolidated_node: None,
             promoted_nodes: promoted,
             archived_nodes: Vec::new(),
@@ -503,6 +1246,82 @@ impl SqliteMemoryStore {
         })
     }
 
+    /// Promote up to `limit` nodes of `from_tier` after `cursor` to
+    /// `to_tier`, in one transaction.
+    ///
+    /// The tier change and its evolution log entries are each written with a
+    /// single set-based statement over the batch's rowid range. Cursor
+    /// handling matches [`decay_batch`](Self::decay_batch). Fails if
+    /// `to_tier` is not later than `from_tier`.
+    pub fn consolidate_batch(
+        &self,
+        from_tier: Tier,
+        to_tier: Tier,
+        cursor: i64,
+        limit: usize,
+        reason: &str,
+    ) -> Result<MaintenanceBatch> {
+        if to_tier <= from_tier {
+            return Err(Error::MemoryStorage(format!(
+                "Cannot consolidate from {} to {}: target tier must be later",
+                from_tier, to_tier
+            )));
+        }
+        let updated_at = Utc::now().to_rfc3339();
+
+        let batch = self.with_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            let mut batch = MaintenanceBatch {
+                cursor,
+                ..Default::default()
+            };
+            {
+                let mut select = tx.prepare_cached(
+                    "SELECT rowid, id FROM nodes WHERE tier = ?1 AND rowid > ?2
+                     ORDER BY rowid LIMIT ?3",
+                )?;
+                let mut rows = select.query(params![from_tier as i32, cursor, limit as i64])?;
+                while let Some(row) = rows.next()? {
+                    batch.cursor = row.get(0)?;
+                    batch.scanned += 1;
+                    if let Ok(id) = row.get::<_, NodeId>(1) {
+                        batch.changed.push(id);
+                    }
+                }
+            }
+
+            if batch.scanned > 0 {
+                tx.prepare_cached(
+                    "INSERT INTO evolution_log (node_id, operation, from_tier, to_tier, reason)
+                     SELECT id, 'promote', tier, ?4, ?5 FROM nodes
+                     WHERE tier = ?1 AND rowid > ?2 AND rowid <= ?3",
+                )?
+                .execute(params![
+                    from_tier as i32,
+                    cursor,
+                    batch.cursor,
+                    to_tier as i32,
+                    reason
+                ])?;
+                tx.prepare_cached(
+                    "UPDATE nodes SET tier = ?4, updated_at = ?5
+                     WHERE tier = ?1 AND rowid > ?2 AND rowid <= ?3",
+                )?
+                .execute(params![
+                    from_tier as i32,
+                    cursor,
+                    batch.cursor,
+                    to_tier as i32,
+                    updated_at
+                ])?;
+            }
+            tx.commit()?;
+            batch.done = batch.scanned < limit;
+            Ok(batch)
+        })?;
+        Ok(batch)
+    }
+
     /// Log an evolution event.
     fn log_evolution(
         &self,
@@ -517,7 +1336,7 @@ impl SqliteMemoryStore {
                 "INSERT INTO evolution_log (node_id, operation, from_tier, to_tier, reason)
                  VALUES (?1, ?2, ?3, ?4, ?5)",
                 params![
-                    node_id.to_string(),
+                    node_id,
                     operation,
                     from_tier.map(|t| t as i32),
                     to_tier.map(|t| t as i32),
@@ -530,14 +1349,14 @@ impl SqliteMemoryStore {
 
     /// Get evolution history for a node.
     pub fn get_evolution_history(&self, node_id: &NodeId) -> Result<Vec<EvolutionEntry>> {
-        self.with_conn(|conn| {
-            let mut stmt = conn.prepare(
+        self.with_read_conn(|conn| {
+            let mut stmt = conn.prepare_cached(
                 "SELECT operation, from_tier, to_tier, reason, created_at
                  FROM evolution_log WHERE node_id = ?1 ORDER BY created_at DESC",
             )?;
 
             let entries = stmt
-                .query_map(params![node_id.to_string()], |row| {
+                .query_map(params![node_id], |row| {
                     Ok(EvolutionEntry {
                         operation: row.get(0)?,
                         from_tier: row.get::<_, Option<i32>>(1)?.map(int_to_tier),
@@ -555,12 +1374,13 @@ impl SqliteMemoryStore {
 
     /// Get statistics about the memory store.
     pub fn stats(&self) -> Result<MemoryStats> {
-        self.with_conn(|conn| {
+        self.with_read_conn(|conn| {
             let total_nodes: i64 =
                 conn.query_row("SELECT COUNT(*) FROM nodes", [], |row| row.get(0))?;
 
             let nodes_by_tier: HashMap<Tier, i64> = {
-                let mut stmt = conn.prepare("SELECT tier, COUNT(*) FROM nodes GROUP BY tier")?;
+                let mut stmt =
+                    conn.prepare_cached("SELECT tier, COUNT(*) FROM nodes GROUP BY tier")?;
                 let rows = stmt.query_map([], |row| {
                     let tier_int: i32 = row.get(0)?;
                     let count: i64 = row.get(1)?;
@@ -571,19 +1391,11 @@ impl SqliteMemoryStore {
             };
 
             let nodes_by_type: HashMap<NodeType, i64> = {
-                let mut stmt =
-                    conn.prepare("SELECT node_type, COUNT(*) FROM nodes GROUP BY node_type")?;
+                let mut stmt = conn
+                    .prepare_cached("SELECT node_type, COUNT(*) FROM nodes GROUP BY node_type")?;
                 let rows = stmt.query_map([], |row| {
-                    let type_str: String = row.get(0)?;
+                    let node_type: NodeType = row.get(0)?;
                     let count: i64 = row.get(1)?;
-                    let node_type = match type_str.as_str() {
-                        "entity" => NodeType::Entity,
-                        "fact" => NodeType::Fact,
-                        "experience" => NodeType::Experience,
-                        "decision" => NodeType::Decision,
-                        "snippet" => NodeType::Snippet,
-                        _ => NodeType::Fact,
-                    };
                     Ok((node_type, count))
                 })?;
                 let result: HashMap<NodeType, i64> = rows.filter_map(|r| r.ok()).collect();
@@ -613,6 +1425,23 @@ pub struct EvolutionEntry {
     pub timestamp: DateTime<Utc>,
 }
 
+/// Default number of nodes [`SqliteMemoryStore::decay`] and
+/// [`SqliteMemoryStore::consolidate`] process per transaction.
+pub const MAINTENANCE_BATCH_SIZE: usize = 1000;
+
+/// Outcome of one bounded decay or consolidation batch.
+#[derive(Debug, Clone, Default, PartialEq)]
+pub struct MaintenanceBatch {
+    /// Nodes changed by the batch.
+    pub changed: Vec<NodeId>,
+    /// Nodes examined by the batch.
+    pub scanned: usize,
+    /// Position to resume from in the next batch.
+    pub cursor: i64,
+    /// Whether the batch reached the end of the candidate nodes.
+    pub done: bool,
+}
+
 /// Statistics about the memory store.
 #[derive(Debug, Clone)]
 pub struct MemoryStats {
@@ -697,6 +1526,280 @@ mod tests {
         assert!(results[0].content.contains("authentication"));
     }
 
+    #[test]
+    fn test_search_embedding() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let auth = Node::new(NodeType::Fact, "The authentication system uses JWT")
+            .with_embedding(vec![1.0, 0.0, 0.0]);
+        let db = Node::new(NodeType::Fact, "Database uses PostgreSQL")
+            .with_embedding(vec![0.0, 1.0, 0.0])
+            .with_tier(Tier::Session);
+        store.add_nodes(&[auth.clone(), db.clone()]).unwrap();
+        store
+            .add_node(&Node::new(NodeType::Fact, "No embedding here"))
+            .unwrap();
+
+        let hits = store.search_embedding(&[0.9, 0.1, 0.0], 5, None).unwrap();
+        assert_eq!(hits.len(), 2);
+        assert_eq!(hits[0].0.id, auth.id);
+        assert!(hits[0].1 > hits[1].1);
+
+        // Writes after the index is built are reflected incrementally.
+        let login = Node::new(NodeType::Fact, "Users can login with OAuth")
+            .with_embedding(vec![0.95, 0.0, 0.05]);
+        store.add_node(&login).unwrap();
+        store.delete_node(&auth.id).unwrap();
+        let hits = store.search_embedding(&[1.0, 0.0, 0.0], 1, None).unwrap();
+        assert_eq!(hits[0].0.id, login.id);
+
+        let hits = store
+            .search_embedding(&[1.0, 0.0, 0.0], 5, Some(Tier::Session))
+            .unwrap();
+        assert_eq!(hits.len(), 1);
+        assert_eq!(hits[0].0.id, db.id);
+
+        assert!(store.search_embedding(&[1.0, 0.0], 5, None).is_err());
+
+        let fused = store
+            .search_hybrid("PostgreSQL", &[1.0, 0.0, 0.0], 2, None)
+            .unwrap();
+        let ids: Vec<_> = fused.iter().map(|(n, _)| n.id.clone()).collect();
+        assert_eq!(ids.len(), 2);
+        assert!(ids.contains(&db.id) && ids.contains(&login.id));
+    }
+
+    #[test]
+    fn test_search_embedding_sees_writes_from_other_handles() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let db_path = temp_dir.path().join("shared.db");
+        let reader = SqliteMemoryStore::open(&db_path).unwrap();
+        let writer = SqliteMemoryStore::open(&db_path).unwrap();
+
+        let a = Node::new(NodeType::Fact, "a").with_embedding(vec![1.0, 0.0]);
+        reader.add_node(&a).unwrap();
+        assert_eq!(
+            reader.search_embedding(&[1.0, 0.0], 5, None).unwrap().len(),
+            1
+        );
+
+        // Inserts, deletes and tier changes through another handle.
+        let b = Node::new(NodeType::Fact, "b").with_embedding(vec![0.9, 0.1]);
+        writer.add_node(&b).unwrap();
+        let hits = reader.search_embedding(&[1.0, 0.0], 5, None).unwrap();
+        assert_eq!(hits.len(), 2);
+
+        writer.delete_node(&a.id).unwrap();
+        writer
+            .update_node(&b.clone().with_tier(Tier::Archive))
+            .unwrap();
+        let hits = reader.search_embedding(&[1.0, 0.0], 5, None).unwrap();
+        assert_eq!(hits.len(), 1);
+        assert_eq!(hits[0].0.id, b.id);
+        let archived = reader
+            .search_embedding(&[1.0, 0.0], 5, Some(Tier::Archive))
+            .unwrap();
+        assert_eq!(archived.len(), 1);
+
+        // A raw SQLite connection stands in for another process.
+        let external = Connection::open(&db_path).unwrap();
+        let c = Node::new(NodeType::Fact, "c").with_embedding(vec![0.0, 1.0]);
+        SqliteMemoryStore::insert_node(&external, &c).unwrap();
+        let hits = reader.search_embedding(&[0.0, 1.0], 1, None).unwrap();
+        assert_eq!(hits[0].0.id, c.id);
+    }
+
+    #[test]
+    fn test_vector_index_file_is_reused_and_validated() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let db_path = temp_dir.path().join("persisted.db");
+        let sidecar = vector_index_path(&db_path);
+        let a = Node::new(NodeType::Fact, "a").with_embedding(vec![1.0, 0.0]);
+        let b = Node::new(NodeType::Fact, "b").with_embedding(vec![0.0, 1.0]);
+        let logged = |path: &Path| -> i64 {
+            Connection::open(path)
+                .unwrap()
+                .query_row("SELECT COUNT(*) FROM embedding_changes", [], |row| {
+                    row.get(0)
+                })
+                .unwrap()
+        };
+
+        {
+            let store = SqliteMemoryStore::open(&db_path).unwrap();
+            store.add_nodes(&[a.clone(), b.clone()]).unwrap();
+            // The first search builds the index, writes it and prunes the log.
+            assert_eq!(
+                store.search_embedding(&[1.0, 0.0], 5, None).unwrap().len(),
+                2
+            );
+            assert!(sidecar.exists());
+            assert_eq!(logged(&db_path), 0);
+            store.delete_node(&a.id).unwrap();
+            store.search_embedding(&[1.0, 0.0], 5, None).unwrap();
+        }
+        // Dropping the store saved the unsaved delete.
+        let (saved, _) = VectorIndex::load(&sidecar).unwrap();
+        assert_eq!(saved.len(), 1);
+
+        // Changes made while no index was open are applied on top of the file.
+        let external = Connection::open(&db_path).unwrap();
+        let c = Node::new(NodeType::Fact, "c").with_embedding(vec![0.7, 0.7]);
+        SqliteMemoryStore::insert_node(&external, &c).unwrap();
+        let store = SqliteMemoryStore::open(&db_path).unwrap();
+        let ids: Vec<NodeId> = store
+            .search_embedding(&[1.0, 0.0], 5, None)
+            .unwrap()
+            .into_iter()
+            .map(|(n, _)| n.id)
+            .collect();
+        assert_eq!(ids, vec![c.id.clone(), b.id.clone()]);
+        store.save_vector_index().unwrap();
+        assert_eq!(logged(&db_path), 0);
+        drop(store);
+
+        // An index file from another database is ignored and replaced.
+        let other_path = temp_dir.path().join("other.db");
+        let other = SqliteMemoryStore::open(&other_path).unwrap();
+        other
+            .add_node(&Node::new(NodeType::Fact, "x").with_embedding(vec![1.0, 0.0]))
+            .unwrap();
+        other.save_vector_index().unwrap();
+        drop(other);
+        std::fs::copy(vector_index_path(&other_path), &sidecar).unwrap();
+        let store = SqliteMemoryStore::open(&db_path).unwrap();
+        assert_eq!(
+            store.search_embedding(&[1.0, 0.0], 5, None).unwrap().len(),
+            2
+        );
+
+        // So is a corrupt one.
+        drop(store);
+        std::fs::write(&sidecar, b"garbage").unwrap();
+        let store = SqliteMemoryStore::open(&db_path).unwrap();
+        assert_eq!(
+            store.search_embedding(&[1.0, 0.0], 5, None).unwrap().len(),
+            2
+        );
+    }
+
+    #[test]
+    fn test_add_nodes_batch() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let nodes: Vec<Node> = (0..50)
+            .map(|i| Node::new(NodeType::Fact, format!("Batch fact {}", i)))
+            .collect();
+
+        assert_eq!(store.add_nodes(&nodes).unwrap(), 50);
+        assert_eq!(store.stats().unwrap().total_nodes, 50);
+        assert_eq!(store.search_content("Batch", 100).unwrap().len(), 50);
+
+        let mut updated = nodes[..10].to_vec();
+        for node in &mut updated {
+            node.confidence = 0.25;
+        }
+        assert_eq!(store.update_nodes(&updated).unwrap(), 10);
+        let low = store
+            .query_nodes(&NodeQuery::new().min_confidence(0.5))
+            .unwrap();
+        assert_eq!(low.len(), 40);
+    }
+
+    #[test]
+    fn test_add_nodes_batch_rolls_back_on_error() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let first = Node::new(NodeType::Fact, "Unique");
+        let nodes = vec![first.clone(), Node::new(NodeType::Fact, "Other"), first];
+
+        assert!(store.add_nodes(&nodes).is_err());
+        assert_eq!(store.stats().unwrap().total_nodes, 0);
+    }
+
+    #[test]
+    fn test_delete_nodes_batch() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let nodes = vec![
+            Node::new(NodeType::Fact, "One"),
+            Node::new(NodeType::Fact, "Two"),
+        ];
+        store.add_nodes(&nodes).unwrap();
+
+        let ids = vec![nodes[0].id.clone(), nodes[1].id.clone(), NodeId::new()];
+        assert_eq!(store.delete_nodes(&ids).unwrap(), 2);
+        assert_eq!(store.stats().unwrap().total_nodes, 0);
+    }
+
+    #[test]
+    fn test_add_edges_batch() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let hub = Node::new(NodeType::Entity, "Hub");
+        let spokes: Vec<Node> = (0..5)
+            .map(|i| Node::new(NodeType::Entity, format!("Spoke {}", i)))
+            .collect();
+        store.add_node(&hub).unwrap();
+        store.add_nodes(&spokes).unwrap();
+
+        let edges: Vec<HyperEdge> = spokes
+            .iter()
+            .map(|s| HyperEdge::binary(EdgeType::Structural, hub.id.clone(), s.id.clone(), "has"))
+            .collect();
+        assert_eq!(store.add_edges(&edges).unwrap(), 5);
+        assert_eq!(store.get_edges_for_node(&hub.id).unwrap().len(), 5);
+    }
+
+    #[test]
+    fn test_file_store_uses_reader_pool() {
+        let temp_dir = tempfile::tempdir().unwrap();
+        let db_path = temp_dir.path().join("pooled.db");
+        let options = MemoryStoreOptions {
+            reader_pool_size: 2,
+            ..Default::default()
+        };
+        let store = Arc::new(SqliteMemoryStore::open_with_options(&db_path, options).unwrap());
+        assert_eq!(store.reader_pool_size(), 2);
+
+        let node = Node::new(NodeType::Fact, "Readers see committed writes");
+        store.add_node(&node).unwrap();
+        assert!(store.get_node(&node.id).unwrap().is_some());
+
+        let handles: Vec<_> = (0..8)
+            .map(|_| {
+                let store = Arc::clone(&store);
+                std::thread::spawn(move || store.search_content("committed", 10).unwrap().len())
+            })
+            .collect();
+        for handle in handles {
+            assert_eq!(handle.join().unwrap(), 1);
+        }
+
+        // Pooled readers are read-only; writes still go through the writer.
+        store
+            .add_node(&Node::new(NodeType::Fact, "Second"))
+            .unwrap();
+        assert_eq!(store.stats().unwrap().total_nodes, 2);
+
+        // A panicking query hands its connection back to the pool.
+        for _ in 0..2 {
+            let result = std::panic::catch_unwind(std::panic::AssertUnwindSafe(|| {
+                store.with_read_conn(|_| -> rusqlite::Result<()> { panic!("query failed") })
+            }));
+            assert!(result.is_err());
+        }
+        assert_eq!(store.search_content("committed", 10).unwrap().len(), 1);
+    }
+
+    #[test]
+    fn test_store_options_from_partial_json() {
+        let options: MemoryStoreOptions =
+            serde_json::from_str(r#"{"reader_pool_size": 8}"#).unwrap();
+        assert_eq!(options.reader_pool_size, 8);
+        assert_eq!(options.synchronous, "NORMAL");
+
+        assert_eq!(
+            SqliteMemoryStore::in_memory().unwrap().reader_pool_size(),
+            0
+        );
+    }
+
     #[test]
     fn test_add_and_get_edge() {
         let store = SqliteMemoryStore::in_memory().unwrap();
@@ -719,6 +1822,68 @@ mod tests {
         assert_eq!(edges[0].label, Some("has".to_string()));
     }
 
+    #[test]
+    fn test_edges_for_hub_node_load_all_members() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let hub = Node::new(NodeType::Entity, "Hub");
+        let a = Node::new(NodeType::Entity, "A");
+        let b = Node::new(NodeType::Entity, "B");
+        store
+            .add_nodes(&[hub.clone(), a.clone(), b.clone()])
+            .unwrap();
+
+        let ternary = HyperEdge::new(EdgeType::Semantic)
+            .with_member(hub.id.clone(), "subject")
+            .with_member(a.id.clone(), "object")
+            .with_member(b.id.clone(), "context");
+        let binary = HyperEdge::binary(EdgeType::Causal, a.id.clone(), hub.id.clone(), "causes");
+        store.add_edges(&[ternary.clone(), binary]).unwrap();
+
+        let edges = store.get_edges_for_node(&hub.id).unwrap();
+        assert_eq!(edges.len(), 2);
+        let loaded = edges.iter().find(|e| e.id == ternary.id).unwrap();
+        assert_eq!(loaded.members.len(), 3);
+        assert_eq!(store.get_edges_for_node(&b.id).unwrap().len(), 1);
+    }
+
+    #[test]
+    fn test_neighborhood() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let chain: Vec<Node> = (0..5)
+            .map(|i| Node::new(NodeType::Entity, format!("N{}", i)))
+            .collect();
+        store.add_nodes(&chain).unwrap();
+        let edges: Vec<HyperEdge> = chain
+            .windows(2)
+            .map(|w| {
+                HyperEdge::binary(
+                    EdgeType::Structural,
+                    w[0].id.clone(),
+                    w[1].id.clone(),
+                    "next",
+                )
+            })
+            .collect();
+        store.add_edges(&edges).unwrap();
+
+        let one_hop = store.neighborhood(&chain[2].id, 1, 100).unwrap();
+        assert_eq!(one_hop.nodes.len(), 3);
+        assert_eq!(one_hop.nodes[0].id, chain[2].id);
+        assert_eq!(one_hop.edges.len(), 2);
+
+        let two_hops = store.neighborhood(&chain[0].id, 2, 100).unwrap();
+        assert_eq!(two_hops.nodes.len(), 3);
+        assert_eq!(two_hops.edges.len(), 2);
+
+        let limited = store.neighborhood(&chain[2].id, 4, 2).unwrap();
+        assert_eq!(limited.nodes.len(), 2);
+        assert_eq!(limited.nodes[0].id, chain[2].id);
+        assert_eq!(limited.edges.len(), 1);
+
+        let missing = store.neighborhood(&NodeId::new(), 2, 10).unwrap();
+        assert!(missing.nodes.is_empty());
+    }
+
     #[test]
     fn test_promote() {
         let store = SqliteMemoryStore::in_memory().unwrap();
@@ -750,6 +1915,68 @@ mod tests {
         assert_eq!(history.len(), 2);
     }
 
+    #[test]
+    fn test_decay_and_consolidate_in_batches() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let stale = Utc::now() - chrono::Duration::days(1);
+        let mut nodes: Vec<Node> = (0..5)
+            .map(|i| Node::new(NodeType::Fact, format!("Fact {}", i)).with_tier(Tier::Task))
+            .collect();
+        for node in &mut nodes[..3] {
+            node.last_accessed = stale;
+        }
+        store.add_nodes(&nodes).unwrap();
+
+        let first = store.decay_batch(0.5, 0.1, 0, 2).unwrap();
+        assert_eq!(
+            (first.scanned, first.changed.len(), first.done),
+            (2, 2, false)
+        );
+        let rest = store.decay_batch(0.5, 0.1, first.cursor, 10).unwrap();
+        assert_eq!((rest.scanned, rest.changed.len(), rest.done), (3, 1, true));
+        let node = store.get_node(&nodes[0].id).unwrap().unwrap();
+        assert!((node.confidence - 0.5).abs() < 1e-9);
+        assert_eq!(node.content, "Fact 0");
+
+        let result = store.consolidate(Tier::Task, Tier::Session).unwrap();
+        assert_eq!(result.promoted_nodes.len(), 5);
+        assert_eq!(result.source_nodes, result.promoted_nodes);
+        let node = store.get_node(&nodes[4].id).unwrap().unwrap();
+        assert_eq!(node.tier, Tier::Session);
+        assert_eq!(store.get_evolution_history(&node.id).unwrap().len(), 1);
+        assert_eq!(store.search_content("Fact", 10).unwrap().len(), 5);
+
+        // `to_tier` is honoured, not replaced by the next tier.
+        let result = store.consolidate(Tier::Session, Tier::Archive).unwrap();
+        assert_eq!(result.source_nodes.len(), 5);
+        let node = store.get_node(&nodes[0].id).unwrap().unwrap();
+        assert_eq!(node.tier, Tier::Archive);
+        assert!(store.consolidate(Tier::Archive, Tier::Archive).is_err());
+        assert!(store.consolidate(Tier::Archive, Tier::Task).is_err());
+    }
+
+    #[test]
+    fn test_decay_is_set_based_and_skips_fresh_nodes() {
+        let store = SqliteMemoryStore::in_memory().unwrap();
+        let mut stale = Node::new(NodeType::Fact, "stale").with_confidence(0.8);
+        stale.last_accessed = Utc::now() - chrono::Duration::minutes(48 * 60 + 30);
+        let fresh = Node::new(NodeType::Fact, "fresh").with_confidence(0.8);
+        let mut floor = Node::new(NodeType::Fact, "floor").with_confidence(0.05);
+        floor.last_accessed = stale.last_accessed;
+        store
+            .add_nodes(&[stale.clone(), fresh.clone(), floor.clone()])
+            .unwrap();
+
+        let batch = store.decay_batch(0.5, 0.1, 0, 10).unwrap();
+        assert_eq!(batch.changed, vec![stale.id.clone()]);
+        assert_eq!(batch.scanned, 2, "nodes below min_confidence are skipped");
+        // Whole hours only: 0.8 * 0.5^(48 / 24).
+        let decayed = store.get_node(&stale.id).unwrap().unwrap();
+        assert!((decayed.confidence - 0.2).abs() < 1e-9);
+        assert_eq!(store.get_node(&fresh.id).unwrap().unwrap().confidence, 0.8);
+        assert_eq!(store.get_node(&floor.id).unwrap().unwrap().confidence, 0.05);
+    }
+
     #[test]
     fn test_stats() {
         let store = SqliteMemoryStore::in_memory().unwrap();
@@ -432,6 +432,15 @@ pub struct ConsolidationResult {
     pub summary: String,
 }
 
+/// A k-hop neighbourhood around a node.
+#[derive(Debug, Clone, Default, Serialize, Deserialize)]
+pub struct Subgraph {
+    /// Reached nodes, ordered by hop distance from the origin
+    pub nodes: Vec<Node>,
+    /// Hyperedges whose members all lie within `nodes`
+    pub edges: Vec<HyperEdge>,
+}
+
 /// Query for searching nodes.
 #[derive(Debug, Clone, Default)]
 pub struct NodeQuery {
@@ -0,0 +1,965 @@
+//! Approximate nearest-neighbour index over node embeddings.
+//!
+//! [`VectorIndex`] is an HNSW graph (Malkov & Yashunin, 2016) over
+//! L2-normalized embeddings, so cosine similarity reduces to a dot product.
+//! A search descends the sparse upper layers greedily, then runs a best-first
+//! search of width `ef_search` over the dense bottom layer. Small indexes are
+//! scanned exactly instead, since below a few thousand vectors a contiguous
+//! scan beats pointer chasing.
+//!
+//! Removed or re-embedded nodes leave tombstones that search still traverses
+//! but never returns; the graph is rebuilt once tombstones outnumber live
+//! vectors. The index serializes to a flat file ([`VectorIndex::save`]) so a
+//! store can reopen it without rebuilding the graph.
+//!
+//! The dot-product kernel accumulates in fixed-width lanes, which LLVM lowers
+//! to AVX2/NEON without target-specific intrinsics.
+
+use crate::error::{Error, Result};
+use crate::memory::types::{NodeId, Tier};
+use std::cmp::{Ordering, Reverse};
+use std::collections::{BinaryHeap, HashMap, HashSet};
+use std::path::Path;
+use std::sync::atomic::{AtomicU64, Ordering as AtomicOrdering};
+use uuid::Uuid;
+
+/// Number of independent accumulators in the dot-product kernel.
+const LANES: usize = 8;
+
+/// Magic bytes at the start of a serialized index.
+const FILE_MAGIC: &[u8; 8] = b"RLMHNSW\0";
+
+/// Serialized index format version.
+const FILE_VERSION: u32 = 1;
+
+/// Slot value meaning "no entry point" (empty graph).
+const NO_ENTRY: u32 = u32::MAX;
+
+/// Highest layer a node may be assigned.
+const MAX_LEVEL: usize = 16;
+
+/// Tombstones tolerated before a compaction is considered.
+const MIN_TOMBSTONES_TO_COMPACT: usize = 64;
+
+/// Distinguishes temp files of concurrent saves within one process.
+static SAVE_COUNTER: AtomicU64 = AtomicU64::new(0);
+
+/// Decode a little-endian `f32` blob as stored in `nodes.embedding`.
+///
+/// Trailing bytes that do not form a whole `f32` are ignored.
+pub(crate) fn decode_embedding(bytes: &[u8]) -> Vec<f32> {
+    bytes
+        .chunks_exact(4)
+        .map(|c| f32::from_le_bytes([c[0], c[1], c[2], c[3]]))
+        .collect()
+}
+
+/// Encode an embedding as a little-endian `f32` blob.
+pub(crate) fn encode_embedding(embedding: &[f32]) -> Vec<u8> {
+    let mut out = Vec::with_capacity(embedding.len() * 4);
+    for f in embedding {
+        out.extend_from_slice(&f.to_le_bytes());
+    }
+    out
+}
+
+/// Dot product of two equal-length slices.
+#[inline]
+pub(crate) fn dot(a: &[f32], b: &[f32]) -> f32 {
+    debug_assert_eq!(a.len(), b.len());
+    let mut acc = [0.0f32; LANES];
+    let chunks_a = a.chunks_exact(LANES);
+    let chunks_b = b.chunks_exact(LANES);
+    let tail: f32 = chunks_a
+        .remainder()
+        .iter()
+        .zip(chunks_b.remainder())
+        .map(|(x, y)| x * y)
+        .sum();
+    for (ca, cb) in chunks_a.zip(chunks_b) {
+        for i in 0..LANES {
+            acc[i] += ca[i] * cb[i];
+        }
+    }
+    acc.iter().sum::<f32>() + tail
+}
+
+fn normalized(v: &[f32]) -> Option<Vec<f32>> {
+    let norm = dot(v, v).sqrt();
+    if !norm.is_finite() || norm == 0.0 {
+        return None;
+    }
+    Some(v.iter().map(|x| x / norm).collect())
+}
+
+fn tier_from_code(code: u8) -> Option<Tier> {
+    match code {
+        0 => Some(Tier::Task),
+        1 => Some(Tier::Session),
+        2 => Some(Tier::LongTerm),
+        3 => Some(Tier::Archive),
+        _ => None,
+    }
+}
+
+/// A slot with its similarity to the current query, ordered by score.
+#[derive(Debug, Clone, Copy)]
+struct Scored {
+    score: f32,
+    slot: u32,
+}
+
+impl PartialEq for Scored {
+    fn eq(&self, other: &Self) -> bool {
+        self.cmp(other) == Ordering::Equal
+    }
+}
+
+impl Eq for Scored {}
+
+impl PartialOrd for Scored {
+    fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
+        Some(self.cmp(other))
+    }
+}
+
+impl Ord for Scored {
+    fn cmp(&self, other: &Self) -> Ordering {
+        self.score
+            .total_cmp(&other.score)
+            .then_with(|| other.slot.cmp(&self.slot))
+    }
+}
+
+/// HNSW construction and search parameters.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct HnswParams {
+    /// Links kept per node on upper layers; the bottom layer keeps twice this.
+    pub m: usize,
+    /// Candidate list width while inserting.
+    pub ef_construction: usize,
+    /// Minimum candidate list width while searching (raised to `k` if smaller).
+    pub ef_search: usize,
+    /// Indexes with fewer live vectors than this are scanned exactly.
+    pub exact_below: usize,
+}
+
+impl Default for HnswParams {
+    fn default() -> Self {
+        Self {
+            m: 16,
+            ef_construction: 128,
+            ef_search: 64,
+            exact_below: 1024,
+        }
+    }
+}
+
+/// Approximate cosine-similarity index keyed by node ID.
+///
+/// The dimension is fixed by the first vector inserted; vectors of any other
+/// length, and zero vectors, are not indexed.
+pub struct VectorIndex {
+    params: HnswParams,
+    dim: usize,
+    /// Per-slot node ID, tier and tombstone flag. Slots are never reused.
+    ids: Vec<NodeId>,
+    tiers: Vec<Tier>,
+    deleted: Vec<bool>,
+    /// Row-major normalized vectors, `dim` floats per slot.
+    data: Vec<f32>,
+    /// `links[slot][layer]` lists the neighbours of `slot` on `layer`.
+    links: Vec<Vec<Vec<u32>>>,
+    /// Live node ID to slot.
+    slots: HashMap<NodeId, u32>,
+    entry: u32,
+    top_level: usize,
+    rng: u64,
+}
+
+impl std::fmt::Debug for VectorIndex {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("VectorIndex")
+            .field("params", &self.params)
+            .field("dim", &self.dim)
+            .field("len", &self.len())
+            .field("tombstones", &(self.ids.len() - self.slots.len()))
+            .field("top_level", &self.top_level)
+            .finish()
+    }
+}
+
+impl Default for VectorIndex {
+    fn default() -> Self {
+        Self::with_params(HnswParams::default())
+    }
+}
+
+impl VectorIndex {
+    /// Create an empty index with default parameters.
+    pub fn new() -> Self {
+        Self::default()
+    }
+
+    /// Create an empty index with the given parameters.
+    pub fn with_params(params: HnswParams) -> Self {
+        Self {
+            params: HnswParams {
+                m: params.m.max(2),
+                ef_construction: params.ef_construction.max(1),
+                ef_search: params.ef_search.max(1),
+                exact_below: params.exact_below,
+            },
+            dim: 0,
+            ids: Vec::new(),
+            tiers: Vec::new(),
+            deleted: Vec::new(),
+            data: Vec::new(),
+            links: Vec::new(),
+            slots: HashMap::new(),
+            entry: NO_ENTRY,
+            top_level: 0,
+            rng: 0x9E37_79B9_7F4A_7C15,
+        }
+    }
+
+    /// Parameters the index was built with.
+    pub fn params(&self) -> HnswParams {
+        self.params
+    }
+
+    /// Embedding dimension, or 0 if nothing has been indexed yet.
+    pub fn dim(&self) -> usize {
+        self.dim
+    }
+
+    /// Number of indexed (live) vectors.
+    pub fn len(&self) -> usize {
+        self.slots.len()
+    }
+
+    /// Whether the index is empty.
+    pub fn is_empty(&self) -> bool {
+        self.slots.is_empty()
+    }
+
+    #[inline]
+    fn vector(&self, slot: u32) -> &[f32] {
+        let start = slot as usize * self.dim;
+        &self.data[start..start + self.dim]
+    }
+
+    fn max_links(&self, layer: usize) -> usize {
+        if layer == 0 {
+            self.params.m * 2
+        } else {
+            self.params.m
+        }
+    }
+
+    /// Draw a layer from the geometric distribution with `mL = 1 / ln M`.
+    fn random_level(&mut self) -> usize {
+        // xorshift64*: deterministic so rebuilt graphs are reproducible.
+        self.rng ^= self.rng >> 12;
+        self.rng ^= self.rng << 25;
+        self.rng ^= self.rng >> 27;
+        let bits = self.rng.wrapping_mul(0x2545_F491_4F6C_DD1D) >> 11;
+        let unit = (bits as f64 + 1.0) / (1u64 << 53) as f64;
+        let level = -unit.ln() / (self.params.m as f64).ln();
+        (level as usize).min(MAX_LEVEL)
+    }
+
+    /// Insert or replace the vector for a node. Returns whether it was indexed.
+    pub fn upsert(&mut self, id: &NodeId, tier: Tier, embedding: &[f32]) -> bool {
+        if self.ids.is_empty() && !embedding.is_empty() {
+            self.dim = embedding.len();
+        }
+        let vector = match normalized(embedding) {
+            Some(v) if v.len() == self.dim => v,
+            _ => {
+                self.remove(id);
+                return false;
+            }
+        };
+
+        if let Some(&slot) = self.slots.get(id) {
+            if self.vector(slot) == vector.as_slice() {
+                self.tiers[slot as usize] = tier;
+                return true;
+            }
+            self.tombstone(id);
+        }
+        self.insert(id.clone(), tier, vector);
+        self.maybe_compact();
+        true
+    }
+
+    /// Change the tier recorded for a node's vector. Returns whether it was present.
+    pub fn set_tier(&mut self, id: &NodeId, tier: Tier) -> bool {
+        match self.slots.get(id) {
+            Some(&slot) => {
+                self.tiers[slot as usize] = tier;
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Remove a node's vector. Returns whether it was present.
+    pub fn remove(&mut self, id: &NodeId) -> bool {
+        let removed = self.tombstone(id);
+        if removed {
+            self.maybe_compact();
+        }
+        removed
+    }
+
+    fn tombstone(&mut self, id: &NodeId) -> bool {
+        match self.slots.remove(id) {
+            Some(slot) => {
+                self.deleted[slot as usize] = true;
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Rebuild the graph from live vectors once tombstones dominate it.
+    fn maybe_compact(&mut self) {
+        let live = self.slots.len();
+        let dead = self.ids.len() - live;
+        if live == 0 {
+            if dead > 0 {
+                let rng = self.rng;
+                *self = Self::with_params(self.params);
+                self.rng = rng;
+            }
+            return;
+        }
+        if dead < MIN_TOMBSTONES_TO_COMPACT || dead <= live {
+            return;
+        }
+
+        let mut fresh = Self::with_params(self.params);
+        fresh.dim = self.dim;
+        fresh.rng = self.rng;
+        for slot in 0..self.ids.len() {
+            if !self.deleted[slot] {
+                fresh.insert(
+                    self.ids[slot].clone(),
+                    self.tiers[slot],
+                    self.vector(slot as u32).to_vec(),
+                );
+            }
+        }
+        *self = fresh;
+    }
+
+    fn insert(&mut self, id: NodeId, tier: Tier, vector: Vec<f32>) {
+        let slot = self.ids.len() as u32;
+        let level = self.random_level();
+        self.ids.push(id.clone());
+        self.tiers.push(tier);
+        self.deleted.push(false);
+        self.data.extend_from_slice(&vector);
+        self.links.push(vec![Vec::new(); level + 1]);
+        self.slots.insert(id, slot);
+
+        if self.entry == NO_ENTRY {
+            self.entry = slot;
+            self.top_level = level;
+            return;
+        }
+
+        let mut nearest = Scored {
+            score: dot(&vector, self.vector(self.entry)),
+            slot: self.entry,
+        };
+        for layer in (level + 1..=self.top_level).rev() {
+            nearest = self.greedy(&vector, nearest, layer);
+        }
+        for layer in (0..=level.min(self.top_level)).rev() {
+            let found =
+                self.search_layer(&vector, nearest, self.params.ef_construction, layer, |_| {
+                    true
+                });
+            let max_links = self.max_links(layer);
+            let neighbours = self.select_neighbours(&found, max_links);
+            for &n in &neighbours {
+                self.links[n as usize][layer].push(slot);
+                if self.links[n as usize][layer].len() > max_links {
+                    self.shrink_links(n, layer, max_links);
+                }
+            }
+            self.links[slot as usize][layer] = neighbours;
+            if let Some(&best) = found.first() {
+                nearest = best;
+            }
+        }
+
+        if level > self.top_level {
+            self.top_level = level;
+            self.entry = slot;
+        }
+    }
+
+    /// Follow strictly improving links on one layer until a local optimum.
+    fn greedy(&self, query: &[f32], mut nearest: Scored, layer: usize) -> Scored {
+        loop {
+            let mut improved = false;
+            for &n in &self.links[nearest.slot as usize][layer] {
+                let score = dot(query, self.vector(n));
+                if score > nearest.score {
+                    nearest = Scored { score, slot: n };
+                    improved = true;
+                }
+            }
+            if !improved {
+                return nearest;
+            }
+        }
+    }
+
+    /// Best-first search of width `ef` on one layer, returning matches best first.
+    ///
+    /// Every reachable node is traversed, but only slots passing `accept` are
+    /// collected, so filtered searches keep expanding until `ef` matches are found.
+    fn search_layer(
+        &self,
+        query: &[f32],
+        entry: Scored,
+        ef: usize,
+        layer: usize,
+        accept: impl Fn(u32) -> bool,
+    ) -> Vec<Scored> {
+        let mut visited = HashSet::from([entry.slot]);
+        let mut candidates = BinaryHeap::from([entry]);
+        let mut results: BinaryHeap<Reverse<Scored>> = BinaryHeap::with_capacity(ef + 1);
+        if accept(entry.slot) {
+            results.push(Reverse(entry));
+        }
+
+        while let Some(current) = candidates.pop() {
+            let worst = results.peek().map(|r| r.0.score);
+            if results.len() >= ef && worst.is_some_and(|w| current.score < w) {
+                break;
+            }
+            for &n in &self.links[current.slot as usize][layer] {
+                if !visited.insert(n) {
+                    continue;
+                }
+                let score = dot(query, self.vector(n));
+                let worst = results.peek().map(|r| r.0.score);
+                if results.len() < ef || worst.is_some_and(|w| score > w) {
+                    let scored = Scored { score, slot: n };
+                    candidates.push(scored);
+                    if accept(n) {
+                        results.push(Reverse(scored));
+                        if results.len() > ef {
+                            results.pop();
+                        }
+                    }
+                }
+            }
+        }
+
+        let mut found: Vec<Scored> = results.into_iter().map(|r| r.0).collect();
+        found.sort_unstable_by(|a, b| b.cmp(a));
+        found
+    }
+
+    /// Neighbour-selection heuristic: prefer candidates closer to the new node
+    /// than to any neighbour already kept, then pad with the nearest of the rest.
+    fn select_neighbours(&self, candidates: &[Scored], max: usize) -> Vec<u32> {
+        let mut kept: Vec<u32> = Vec::with_capacity(max);
+        let mut skipped: Vec<u32> = Vec::new();
+        for c in candidates {
+            if kept.len() >= max {
+                break;
+            }
+            let v = self.vector(c.slot);
+            if kept.iter().all(|&k| dot(v, self.vector(k)) < c.score) {
+                kept.push(c.slot);
+            } else {
+                skipped.push(c.slot);
+            }
+        }
+        for s in skipped {
+            if kept.len() >= max {
+                break;
+            }
+            kept.push(s);
+        }
+        kept
+    }
+
+    fn shrink_links(&mut self, slot: u32, layer: usize, max: usize) {
+        let base = self.vector(slot);
+        let mut scored: Vec<Scored> = self.links[slot as usize][layer]
+            .iter()
+            .map(|&n| Scored {
+                score: dot(base, self.vector(n)),
+                slot: n,
+            })
+            .collect();
+        scored.sort_unstable_by(|a, b| b.cmp(a));
+        self.links[slot as usize][layer] = self.select_neighbours(&scored, max);
+    }
+
+    fn accepts(&self, slot: u32, tier: Option<Tier>) -> bool {
+        !self.deleted[slot as usize] && tier.map_or(true, |t| self.tiers[slot as usize] == t)
+    }
+
+    /// Return up to `k` nodes most similar to `query`, best first.
+    ///
+    /// Scores are cosine similarities in `[-1, 1]`. Returns an empty result if
+    /// the query is a zero vector or its length differs from [`Self::dim`].
+    pub fn search(&self, query: &[f32], k: usize, tier: Option<Tier>) -> Vec<(NodeId, f32)> {
+        if k == 0 || query.len() != self.dim || self.slots.is_empty() {
+            return Vec::new();
+        }
+        let Some(query) = normalized(query) else {
+            return Vec::new();
+        };
+
+        let hits = if self.slots.len() < self.params.exact_below {
+            self.search_exact(&query, k, tier)
+        } else {
+            let mut nearest = Scored {
+                score: dot(&query, self.vector(self.entry)),
+                slot: self.entry,
+            };
+            for layer in (1..=self.top_level).rev() {
+                nearest = self.greedy(&query, nearest, layer);
+            }
+            let ef = self.params.ef_search.max(k);
+            let mut found =
+                self.search_layer(&query, nearest, ef, 0, |slot| self.accepts(slot, tier));
+            found.truncate(k);
+            found
+        };
+
+        hits.into_iter()
+            .map(|c| (self.ids[c.slot as usize].clone(), c.score))
+            .collect()
+    }
+
+    fn search_exact(&self, query: &[f32], k: usize, tier: Option<Tier>) -> Vec<Scored> {
+        let mut heap: BinaryHeap<Reverse<Scored>> = BinaryHeap::with_capacity(k + 1);
+        for slot in 0..self.ids.len() as u32 {
+            if !self.accepts(slot, tier) {
+                continue;
+            }
+            let score = dot(query, self.vector(slot));
+            if heap.len() < k {
+                heap.push(Reverse(Scored { score, slot }));
+            } else if heap.peek().is_some_and(|worst| score > worst.0.score) {
+                heap.pop();
+                heap.push(Reverse(Scored { score, slot }));
+            }
+        }
+        // Sorting `Reverse` ascending yields the best score first.
+        heap.into_sorted_vec().into_iter().map(|r| r.0).collect()
+    }
+
+    /// Serialize the index, tagged with an opaque caller-defined `key`.
+    pub fn to_bytes(&self, key: &[u8]) -> Vec<u8> {
+        let mut out = Vec::with_capacity(64 + key.len() + self.data.len() * 4);
+        let put_u32 =
+            |out: &mut Vec<u8>, v: usize| out.extend_from_slice(&(v as u32).to_le_bytes());
+
+        out.extend_from_slice(FILE_MAGIC);
+        put_u32(&mut out, FILE_VERSION as usize);
+        put_u32(&mut out, key.len());
+        out.extend_from_slice(key);
+        put_u32(&mut out, self.dim);
+        put_u32(&mut out, self.params.m);
+        put_u32(&mut out, self.params.ef_construction);
+        put_u32(&mut out, self.params.ef_search);
+        put_u32(&mut out, self.params.exact_below);
+        put_u32(&mut out, self.top_level);
+        put_u32(&mut out, self.entry as usize);
+        out.extend_from_slice(&self.rng.to_le_bytes());
+        put_u32(&mut out, self.ids.len());
+
+        for slot in 0..self.ids.len() {
+            out.extend_from_slice(self.ids[slot].0.as_bytes());
+            out.push(self.tiers[slot] as u8);
+            out.push(self.deleted[slot] as u8);
+            out.push(self.links[slot].len() as u8);
+            out.extend_from_slice(&encode_embedding(self.vector(slot as u32)));
+            for layer in &self.links[slot] {
+                put_u32(&mut out, layer.len());
+                for &n in layer {
+                    out.extend_from_slice(&n.to_le_bytes());
+                }
+            }
+        }
+        out
+    }
+
+    /// Deserialize an index written by [`Self::to_bytes`], returning it with its key.
+    ///
+    /// The graph is validated structurally, so a truncated or corrupt file is
+    /// an error rather than a panic at search time.
+    pub fn from_bytes(bytes: &[u8]) -> Result<(Self, Vec<u8>)> {
+        let mut r = Reader { bytes, pos: 0 };
+        if r.take(FILE_MAGIC.len())? != FILE_MAGIC {
+            return Err(corrupt("bad magic"));
+        }
+        let version = r.u32()?;
+        if version != FILE_VERSION {
+            return Err(corrupt(&format!("unsupported version {}", version)));
+        }
+        let key_len = r.u32()? as usize;
+        let key = r.take(key_len)?.to_vec();
+        let dim = r.u32()? as usize;
+        let params = HnswParams {
+            m: r.u32()? as usize,
+            ef_construction: r.u32()? as usize,
+            ef_search: r.u32()? as usize,
+            exact_below: r.u32()? as usize,
+        };
+        let top_level = r.u32()? as usize;
+        let entry = r.u32()?;
+        let rng = r.u64()?;
+        let count = r.u32()? as usize;
+
+        let mut index = Self::with_params(params);
+        index.dim = dim;
+        index.top_level = top_level;
+        index.entry = entry;
+        index.rng = rng;
+        // Each slot occupies at least 20 bytes; bound allocations by the input.
+        let reserve = count.min(bytes.len() / 20);
+        index.ids.reserve(reserve);
+        index.links.reserve(reserve);
+
+        for slot in 0..count {
+            let id = NodeId(Uuid::from_slice(r.take(16)?).map_err(|e| corrupt(&e.to_string()))?);
+            let tier = tier_from_code(r.u8()?).ok_or_else(|| corrupt("bad tier"))?;
+            let deleted = match r.u8()? {
+                0 => false,
+                1 => true,
+                _ => return Err(corrupt("bad tombstone flag")),
+            };
+            let layers = r.u8()? as usize;
+            if layers == 0 || layers > MAX_LEVEL + 1 {
+                return Err(corrupt("bad layer count"));
+            }
+            index.data.extend(decode_embedding(r.take(dim * 4)?));
+            let mut links = Vec::with_capacity(layers);
+            for _ in 0..layers {
+                let n = r.u32()? as usize;
+                let mut layer = Vec::with_capacity(n.min(r.remaining() / 4));
+                for _ in 0..n {
+                    let neighbour = r.u32()?;
+                    if neighbour as usize >= count {
+                        return Err(corrupt("neighbour out of range"));
+                    }
+                    layer.push(neighbour);
+                }
+                links.push(layer);
+            }
+            if !deleted && index.slots.insert(id.clone(), slot as u32).is_some() {
+                return Err(corrupt("duplicate node"));
+            }
+            index.ids.push(id);
+            index.tiers.push(tier);
+            index.deleted.push(deleted);
+            index.links.push(links);
+        }
+        if r.remaining() != 0 {
+            return Err(corrupt("trailing bytes"));
+        }
+
+        // Every link on layer L must point at a node that has layer L.
+        for links in &index.links {
+            for (layer, neighbours) in links.iter().enumerate() {
+                if neighbours
+                    .iter()
+                    .any(|&n| index.links[n as usize].len() <= layer)
+                {
+                    return Err(corrupt("link to a missing layer"));
+                }
+            }
+        }
+        let entry_ok = if count == 0 {
+            entry == NO_ENTRY
+        } else {
+            (entry as usize) < count && index.links[entry as usize].len() == top_level + 1
+        };
+        if !entry_ok {
+            return Err(corrupt("bad entry point"));
+        }
+
+        Ok((index, key))
+    }
+
+    /// Write the index to `path` atomically with owner-only permissions.
+    pub fn save(&self, path: &Path, key: &[u8]) -> Result<()> {
+        let bytes = self.to_bytes(key);
+        let mut tmp = path.as_os_str().to_owned();
+        tmp.push(format!(
+            ".tmp{}.{}",
+            std::process::id(),
+            SAVE_COUNTER.fetch_add(1, AtomicOrdering::Relaxed)
+        ));
+        let tmp = std::path::PathBuf::from(tmp);
+
+        let write = || -> std::io::Result<()> {
+            use std::io::Write;
+            let mut options = std::fs::OpenOptions::new();
+            options.write(true).create_new(true);
+            #[cfg(unix)]
+            {
+                use std::os::unix::fs::OpenOptionsExt;
+                options.mode(0o600);
+            }
+            let mut file = options.open(&tmp)?;
+            file.write_all(&bytes)?;
+            file.sync_data()?;
+            std::fs::rename(&tmp, path)
+        };
+        write().map_err(|e| {
+            let _ = std::fs::remove_file(&tmp);
+            Error::Internal(format!(
+                "Failed to write vector index {}: {}",
+                path.display(),
+                e
+            ))
+        })
+    }
+
+    /// Read an index written by [`Self::save`], returning it with its key.
+    pub fn load(path: &Path) -> Result<(Self, Vec<u8>)> {
+        let bytes = std::fs::read(path).map_err(|e| {
+            Error::Internal(format!(
+                "Failed to read vector index {}: {}",
+                path.display(),
+                e
+            ))
+        })?;
+        Self::from_bytes(&bytes)
+    }
+}
+
+fn corrupt(what: &str) -> Error {
+    Error::Internal(format!("Corrupt vector index: {}", what))
+}
+
+/// Bounds-checked little-endian cursor over a serialized index.
+struct Reader<'a> {
+    bytes: &'a [u8],
+    pos: usize,
+}
+
+impl<'a> Reader<'a> {
+    fn remaining(&self) -> usize {
+        self.bytes.len() - self.pos
+    }
+
+    fn take(&mut self, n: usize) -> Result<&'a [u8]> {
+        if n > self.remaining() {
+            return Err(corrupt("truncated"));
+        }
+        let out = &self.bytes[self.pos..self.pos + n];
+        self.pos += n;
+        Ok(out)
+    }
+
+    fn u8(&mut self) -> Result<u8> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn u32(&mut self) -> Result<u32> {
+        let b = self.take(4)?;
+        Ok(u32::from_le_bytes([b[0], b[1], b[2], b[3]]))
+    }
+
+    fn u64(&mut self) -> Result<u64> {
+        let mut b = [0u8; 8];
+        b.copy_from_slice(self.take(8)?);
+        Ok(u64::from_le_bytes(b))
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Deterministic pseudo-random unit-ish vectors for recall tests.
+    fn random_vectors(n: usize, dim: usize, seed: u64) -> Vec<Vec<f32>> {
+        let mut state = seed;
+        (0..n)
+            .map(|_| {
+                (0..dim)
+                    .map(|_| {
+                        state = state
+                            .wrapping_mul(6364136223846793005)
+                            .wrapping_add(1442695040888963407);
+                        ((state >> 33) as f32 / (1u64 << 31) as f32) - 0.5
+                    })
+                    .collect()
+            })
+            .collect()
+    }
+
+    fn hnsw_params() -> HnswParams {
+        HnswParams {
+            m: 8,
+            ef_construction: 48,
+            ef_search: 32,
+            exact_below: 0,
+        }
+    }
+
+    #[test]
+    fn test_embedding_roundtrip() {
+        let v = vec![1.5f32, -0.25, 3.0];
+        assert_eq!(decode_embedding(&encode_embedding(&v)), v);
+        assert_eq!(decode_embedding(&[0, 0, 128, 63, 1]), vec![1.0]);
+    }
+
+    #[test]
+    fn test_dot_matches_naive() {
+        let a: Vec<f32> = (0..21).map(|i| i as f32 * 0.5).collect();
+        let b: Vec<f32> = (0..21).map(|i| 1.0 - i as f32 * 0.1).collect();
+        let naive: f32 = a.iter().zip(&b).map(|(x, y)| x * y).sum();
+        assert!((dot(&a, &b) - naive).abs() < 1e-3);
+    }
+
+    #[test]
+    fn test_search_ranks_and_filters() {
+        let mut index = VectorIndex::new();
+        let a = NodeId::new();
+        let b = NodeId::new();
+        let c = NodeId::new();
+        assert!(index.upsert(&a, Tier::Task, &[1.0, 0.0]));
+        assert!(index.upsert(&b, Tier::Session, &[0.7, 0.7]));
+        assert!(index.upsert(&c, Tier::Task, &[0.0, 1.0]));
+        assert!(!index.upsert(&NodeId::new(), Tier::Task, &[1.0, 0.0, 0.0]));
+
+        let hits = index.search(&[1.0, 0.1], 2, None);
+        assert_eq!(hits.len(), 2);
+        assert_eq!(hits[0].0, a);
+        assert_eq!(hits[1].0, b);
+
+        let hits = index.search(&[1.0, 0.1], 5, Some(Tier::Task));
+        assert_eq!(hits.iter().map(|h| &h.0).collect::<Vec<_>>(), vec![&a, &c]);
+
+        assert!(index.remove(&a));
+        assert_eq!(index.len(), 2);
+        assert_eq!(index.search(&[1.0, 0.0], 1, None)[0].0, b);
+        assert!(index.search(&[1.0, 0.0, 0.0], 1, None).is_empty());
+    }
+
+    #[test]
+    fn test_hnsw_recall_against_exact() {
+        let dim = 16;
+        let vectors = random_vectors(1500, dim, 7);
+        let mut ann = VectorIndex::with_params(hnsw_params());
+        let mut exact = VectorIndex::with_params(HnswParams {
+            exact_below: usize::MAX,
+            ..HnswParams::default()
+        });
+        for (i, v) in vectors.iter().enumerate() {
+            let id = NodeId::new();
+            let tier = if i % 3 == 0 {
+                Tier::Session
+            } else {
+                Tier::Task
+            };
+            ann.upsert(&id, tier, v);
+            exact.upsert(&id, tier, v);
+        }
+
+        let k = 10;
+        for tier in [None, Some(Tier::Session)] {
+            let mut hits = 0;
+            let queries = random_vectors(40, dim, 99);
+            for q in &queries {
+                let truth: HashSet<NodeId> =
+                    exact.search(q, k, tier).into_iter().map(|h| h.0).collect();
+                let got = ann.search(q, k, tier);
+                assert_eq!(got.len(), k);
+                assert!(got.windows(2).all(|w| w[0].1 >= w[1].1));
+                hits += got.iter().filter(|h| truth.contains(&h.0)).count();
+            }
+            let recall = hits as f64 / (queries.len() * k) as f64;
+            assert!(recall >= 0.9, "recall@{} = {} for {:?}", k, recall, tier);
+        }
+    }
+
+    #[test]
+    fn test_tombstones_are_skipped_and_compacted() {
+        let mut index = VectorIndex::with_params(hnsw_params());
+        let vectors = random_vectors(400, 8, 3);
+        let ids: Vec<NodeId> = vectors.iter().map(|_| NodeId::new()).collect();
+        for (id, v) in ids.iter().zip(&vectors) {
+            index.upsert(id, Tier::Task, v);
+        }
+        for id in &ids[..300] {
+            assert!(index.remove(id));
+        }
+        assert_eq!(index.len(), 100);
+        // Compaction dropped the tombstones once they outnumbered live slots.
+        assert!(index.ids.len() < 400);
+
+        let live: HashSet<&NodeId> = ids[300..].iter().collect();
+        for v in &vectors[..20] {
+            let hits = index.search(v, 5, None);
+            assert_eq!(hits.len(), 5);
+            assert!(hits.iter().all(|h| live.contains(&h.0)));
+        }
+
+        // Re-embedding a node replaces its vector; same vector only moves tier.
+        let id = &ids[350];
+        assert!(index.upsert(id, Tier::Archive, &vectors[350]));
+        assert_eq!(
+            index.search(&vectors[350], 1, Some(Tier::Archive))[0].0,
+            *id
+        );
+        assert!(index.upsert(id, Tier::Archive, &vectors[0]));
+        assert_eq!(index.search(&vectors[0], 1, Some(Tier::Archive))[0].0, *id);
+        assert_eq!(index.len(), 100);
+    }
+
+    #[test]
+    fn test_save_load_roundtrip() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("index.hnsw");
+        let mut index = VectorIndex::with_params(hnsw_params());
+        let vectors = random_vectors(200, 16, 11);
+        let ids: Vec<NodeId> = vectors.iter().map(|_| NodeId::new()).collect();
+        for (id, v) in ids.iter().zip(&vectors) {
+            index.upsert(id, Tier::LongTerm, v);
+        }
+        index.remove(&ids[0]);
+
+        index.save(&path, b"key-1").unwrap();
+        let (loaded, key) = VectorIndex::load(&path).unwrap();
+        assert_eq!(key, b"key-1");
+        assert_eq!(loaded.len(), 199);
+        assert_eq!(loaded.params(), index.params());
+        for v in &vectors[..10] {
+            assert_eq!(loaded.search(v, 5, None), index.search(v, 5, None));
+        }
+        #[cfg(unix)]
+        {
+            use std::os::unix::fs::PermissionsExt;
+            let mode = std::fs::metadata(&path).unwrap().permissions().mode();
+            assert_eq!(mode & 0o777, 0o600);
+        }
+
+        let bytes = index.to_bytes(b"k");
+        assert!(VectorIndex::from_bytes(&bytes[..bytes.len() - 1]).is_err());
+        let mut bad = bytes.clone();
+        bad[0] ^= 1;
+        assert!(VectorIndex::from_bytes(&bad).is_err());
+        assert!(VectorIndex::from_bytes(&VectorIndex::new().to_bytes(b""))
+            .unwrap()
+            .0
+            .is_empty());
+    }
+}
@@ -0,0 +1,417 @@
+//! Process-wide latency metrics for hot paths.
+//!
+//! Each [`Metric`] owns a static, lock-free histogram of relaxed atomic
+//! counters. Samples land in log-linear buckets (eight linear sub-buckets per
+//! power of two), so recording is a handful of `fetch_add`s and percentiles
+//! carry at most 12.5% relative error. Reads walk the buckets on demand; a
+//! read that races with recorders sees each counter at some recent value.
+//!
+//! When span tracing is enabled, every [`Timer`] also opens a `tracing` span
+//! named `rlm_op` with an `op` field, so subscribers see the same operations
+//! with their own timing. Spans start disabled unless `RLM_TRACE_SPANS` is
+//! set to a truthy value, and can be toggled at runtime with
+//! [`set_tracing_enabled`].
+
+use std::ffi::CStr;
+use std::fmt::Write;
+use std::sync::atomic::{AtomicU64, AtomicU8, Ordering};
+use std::time::{Duration, Instant};
+
+/// Instrumented operations.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash)]
+pub enum Metric {
+    /// REPL request written until its response is routed back
+    ReplRoundTrip,
+    /// Time to spawn or fork a REPL process and see it ready
+    ReplSpawn,
+    /// SQLite work done while holding a memory-store connection
+    SqliteQuery,
+    /// Wait for the memory-store writer lock or a pooled reader
+    StoreLockWait,
+    /// LLM provider call, per attempt
+    LlmCall,
+    /// Wait for batch rate-limiter capacity before an LLM call
+    LlmQueue,
+    /// Evidence scrubbing of one text
+    Scrub,
+    /// Claim extraction from one response
+    ClaimExtract,
+}
+
+impl Metric {
+    /// Number of metrics.
+    pub const COUNT: usize = 8;
+
+    /// All metrics, in index order.
+    pub const ALL: [Metric; Self::COUNT] = [
+        Metric::ReplRoundTrip,
+        Metric::ReplSpawn,
+        Metric::SqliteQuery,
+        Metric::StoreLockWait,
+        Metric::LlmCall,
+        Metric::LlmQueue,
+        Metric::Scrub,
+        Metric::ClaimExtract,
+    ];
+
+    /// Names in index order, NUL-terminated so the C API can return them
+    /// without copying.
+    const NAMES: [&'static str; Self::COUNT] = [
+        "repl_round_trip\0",
+        "repl_spawn\0",
+        "sqlite_query\0",
+        "store_lock_wait\0",
+        "llm_call\0",
+        "llm_queue\0",
+        "scrub\0",
+        "claim_extract\0",
+    ];
+
+    /// Stable snake_case name, also used for the Prometheus metric family.
+    pub fn name(self) -> &'static str {
+        let name = Self::NAMES[self.index()];
+        &name[..name.len() - 1]
+    }
+
+    /// [`Metric::name`] as a C string.
+    pub fn c_name(self) -> &'static CStr {
+        CStr::from_bytes_with_nul(Self::NAMES[self.index()].as_bytes())
+            .expect("metric names are NUL-terminated")
+    }
+
+    fn help(self) -> &'static str {
+        match self {
+            Metric::ReplRoundTrip => "REPL request/response round trip",
+            Metric::ReplSpawn => "REPL process spawn until ready",
+            Metric::SqliteQuery => "SQLite work on a memory-store connection",
+            Metric::StoreLockWait => "Wait for a memory-store connection",
+            Metric::LlmCall => "LLM provider call per attempt",
+            Metric::LlmQueue => "Wait for LLM rate-limiter capacity",
+            Metric::Scrub => "Evidence scrubbing per text",
+            Metric::ClaimExtract => "Claim extraction per response",
+        }
+    }
+
+    /// Position in [`Metric::ALL`].
+    pub fn index(self) -> usize {
+        self as usize
+    }
+
+    /// Metric at `index` in [`Metric::ALL`].
+    pub fn from_index(index: usize) -> Option<Metric> {
+        Self::ALL.get(index).copied()
+    }
+}
+
+/// Linear sub-buckets per power of two, as a bit count.
+const SUB_BITS: u32 = 3;
+const SUB_BUCKETS: usize = 1 << SUB_BITS;
+/// Buckets covering the full `u64` nanosecond range.
+const BUCKETS: usize = (64 - SUB_BITS as usize + 1) * SUB_BUCKETS;
+
+fn bucket_index(ns: u64) -> usize {
+    if ns < SUB_BUCKETS as u64 {
+        return ns as usize;
+    }
+    let exp = 63 - ns.leading_zeros();
+    let sub = (ns >> (exp - SUB_BITS)) as usize & (SUB_BUCKETS - 1);
+    (((exp - SUB_BITS + 1) as usize) << SUB_BITS) + sub
+}
+
+/// Largest value that falls into bucket `index`.
+fn bucket_upper(index: usize) -> u64 {
+    if index < SUB_BUCKETS {
+        return index as u64;
+    }
+    let shift = (index >> SUB_BITS) as u32 - 1;
+    let sub = (index & (SUB_BUCKETS - 1)) as u64;
+    let lower = (SUB_BUCKETS as u64 + sub) << shift;
+    lower + ((1u64 << shift) - 1)
+}
+
+struct Histogram {
+    count: AtomicU64,
+    sum_ns: AtomicU64,
+    max_ns: AtomicU64,
+    buckets: [AtomicU64; BUCKETS],
+}
+
+impl Histogram {
+    #[allow(clippy::declare_interior_mutable_const)]
+    const EMPTY: Histogram = Histogram::new();
+
+    const fn new() -> Self {
+        #[allow(clippy::declare_interior_mutable_const)]
+        const ZERO: AtomicU64 = AtomicU64::new(0);
+        Self {
+            count: ZERO,
+            sum_ns: ZERO,
+            max_ns: ZERO,
+            buckets: [ZERO; BUCKETS],
+        }
+    }
+
+    fn record(&self, ns: u64) {
+        self.buckets[bucket_index(ns)].fetch_add(1, Ordering::Relaxed);
+        self.count.fetch_add(1, Ordering::Relaxed);
+        self.sum_ns.fetch_add(ns, Ordering::Relaxed);
+        self.max_ns.fetch_max(ns, Ordering::Relaxed);
+    }
+
+    fn snapshot(&self) -> MetricSnapshot {
+        let counts: Vec<u64> = self
+            .buckets
+            .iter()
+            .map(|b| b.load(Ordering::Relaxed))
+            .collect();
+        let max_ns = self.max_ns.load(Ordering::Relaxed);
+        // Rank against the bucket total so quantiles agree with the buckets
+        // even when `count` has moved on during the read.
+        let total: u64 = counts.iter().sum();
+        let quantile = |q: f64| -> u64 {
+            if total == 0 {
+                return 0;
+            }
+            let rank = ((q * total as f64).ceil() as u64).max(1);
+            let mut seen = 0;
+            for (index, &n) in counts.iter().enumerate() {
+                seen += n;
+                if seen >= rank {
+                    return bucket_upper(index).min(max_ns);
+                }
+            }
+            max_ns
+        };
+        MetricSnapshot {
+            count: self.count.load(Ordering::Relaxed),
+            sum_ns: self.sum_ns.load(Ordering::Relaxed),
+            max_ns,
+            p50_ns: quantile(0.50),
+            p95_ns: quantile(0.95),
+            p99_ns: quantile(0.99),
+        }
+    }
+
+    fn reset(&self) {
+        for bucket in &self.buckets {
+            bucket.store(0, Ordering::Relaxed);
+        }
+        self.count.store(0, Ordering::Relaxed);
+        self.sum_ns.store(0, Ordering::Relaxed);
+        self.max_ns.store(0, Ordering::Relaxed);
+    }
+}
+
+static HISTOGRAMS: [Histogram; Metric::COUNT] = [Histogram::EMPTY; Metric::COUNT];
+
+/// Point-in-time summary of one metric.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct MetricSnapshot {
+    pub count: u64,
+    pub sum_ns: u64,
+    pub max_ns: u64,
+    pub p50_ns: u64,
+    pub p95_ns: u64,
+    pub p99_ns: u64,
+}
+
+impl MetricSnapshot {
+    /// Mean sample in nanoseconds, or 0 with no samples.
+    pub fn mean_ns(&self) -> u64 {
+        self.sum_ns.checked_div(self.count).unwrap_or(0)
+    }
+}
+
+/// Record one sample of `metric`.
+pub fn record(metric: Metric, elapsed: Duration) {
+    let ns = u64::try_from(elapsed.as_nanos()).unwrap_or(u64::MAX);
+    HISTOGRAMS[metric.index()].record(ns);
+}
+
+/// Summarize one metric.
+pub fn snapshot(metric: Metric) -> MetricSnapshot {
+    HISTOGRAMS[metric.index()].snapshot()
+}
+
+/// Summarize every metric, indexed like [`Metric::ALL`].
+pub fn snapshot_all() -> [MetricSnapshot; Metric::COUNT] {
+    Metric::ALL.map(snapshot)
+}
+
+/// Clear every metric. Samples recorded concurrently may survive the reset.
+pub fn reset() {
+    for histogram in &HISTOGRAMS {
+        histogram.reset();
+    }
+}
+
+/// Render every metric in the Prometheus text exposition format.
+///
+/// Each metric is a `summary` family `rlm_<name>_seconds` with p50/p95/p99
+/// quantiles, plus a `rlm_<name>_seconds_max` gauge.
+pub fn prometheus_text() -> String {
+    let mut out = String::new();
+    for (metric, snap) in Metric::ALL.iter().zip(snapshot_all()) {
+        let family = format!("rlm_{}_seconds", metric.name());
+        let _ = writeln!(out, "# HELP {family} {}.", metric.help());
+        let _ = writeln!(out, "# TYPE {family} summary");
+        for (quantile, ns) in [
+            ("0.5", snap.p50_ns),
+            ("0.95", snap.p95_ns),
+            ("0.99", snap.p99_ns),
+        ] {
+            let _ = writeln!(out, "{family}{{quantile=\"{quantile}\"}} {}", seconds(ns));
+        }
+        let _ = writeln!(out, "{family}_sum {}", seconds(snap.sum_ns));
+        let _ = writeln!(out, "{family}_count {}", snap.count);
+        let _ = writeln!(out, "# HELP {family}_max Largest sample since reset.");
+        let _ = writeln!(out, "# TYPE {family}_max gauge");
+        let _ = writeln!(out, "{family}_max {}", seconds(snap.max_ns));
+    }
+    out
+}
+
+fn seconds(ns: u64) -> f64 {
+    ns as f64 / 1e9
+}
+
+const TRACING_UNSET: u8 = 0;
+const TRACING_OFF: u8 = 1;
+const TRACING_ON: u8 = 2;
+
+static TRACING: AtomicU8 = AtomicU8::new(TRACING_UNSET);
+
+/// Whether timers open `tracing` spans.
+pub fn tracing_enabled() -> bool {
+    match TRACING.load(Ordering::Relaxed) {
+        TRACING_ON => true,
+        TRACING_OFF => false,
+        _ => {
+            let on = std::env::var("RLM_TRACE_SPANS")
+                .map(|v| matches!(v.trim(), "1" | "true" | "yes" | "on"))
+                .unwrap_or(false);
+            // Keep an explicit setting that raced ahead of the env lookup.
+            let state = if on { TRACING_ON } else { TRACING_OFF };
+            let _ = TRACING.compare_exchange(
+                TRACING_UNSET,
+                state,
+                Ordering::Relaxed,
+                Ordering::Relaxed,
+            );
+            TRACING.load(Ordering::Relaxed) == TRACING_ON
+        }
+    }
+}
+
+/// Turn span tracing on or off, overriding `RLM_TRACE_SPANS`.
+pub fn set_tracing_enabled(enabled: bool) {
+    let state = if enabled { TRACING_ON } else { TRACING_OFF };
+    TRACING.store(state, Ordering::Relaxed);
+}
+
+/// Records the time until it is dropped as one sample of a metric.
+///
+/// The span it may carry is never entered, so a timer can be held across
+/// `.await` points.
+#[must_use = "a timer records when dropped"]
+pub struct Timer {
+    metric: Metric,
+    start: Instant,
+    armed: bool,
+    _span: Option<tracing::Span>,
+}
+
+impl Timer {
+    /// Start timing `metric`.
+    pub fn start(metric: Metric) -> Self {
+        let span = tracing_enabled().then(|| tracing::info_span!("rlm_op", op = metric.name()));
+        Self {
+            metric,
+            start: Instant::now(),
+            armed: true,
+            _span: span,
+        }
+    }
+
+    /// Close the timer without recording, for operations that never finished.
+    pub fn discard(mut self) {
+        self.armed = false;
+    }
+}
+
+impl Drop for Timer {
+    fn drop(&mut self) {
+        if self.armed {
+            record(self.metric, self.start.elapsed());
+        }
+    }
+}
+
+/// Time `f` as one sample of `metric`.
+pub fn time<T>(metric: Metric, f: impl FnOnce() -> T) -> T {
+    let _timer = Timer::start(metric);
+    f()
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_bucket_bounds() {
+        for ns in [0, 1, 7, 8, 9, 15, 16, 100, 1_000, 123_456_789, u64::MAX] {
+            let index = bucket_index(ns);
+            assert!(index < BUCKETS);
+            assert!(ns <= bucket_upper(index), "{ns} above bucket {index}");
+            if index > 0 {
+                assert!(ns > bucket_upper(index - 1), "{ns} below bucket {index}");
+            }
+        }
+        assert_eq!(bucket_upper(BUCKETS - 1), u64::MAX);
+    }
+
+    #[test]
+    fn test_quantiles_within_bucket_error() {
+        // Fresh histogram so parallel tests recording real metrics don't interfere.
+        let histogram = Histogram::new();
+        for us in 1..=1000u64 {
+            histogram.record(us * 1_000);
+        }
+        let snap = histogram.snapshot();
+        assert_eq!(snap.count, 1000);
+        assert_eq!(snap.max_ns, 1_000_000);
+        assert_eq!(snap.sum_ns, 500_500_000);
+        for (value, expected) in [(snap.p50_ns, 500_000.0), (snap.p99_ns, 990_000.0)] {
+            let error = (value as f64 - expected).abs() / expected;
+            assert!(error <= 0.125, "{value} vs {expected}");
+        }
+        assert!(snap.p50_ns <= snap.p95_ns && snap.p95_ns <= snap.p99_ns);
+
+        histogram.reset();
+        assert_eq!(histogram.snapshot(), MetricSnapshot::default());
+    }
+
+    #[test]
+    fn test_timer_and_prometheus_text() {
+        let before = snapshot(Metric::ClaimExtract).count;
+        time(Metric::ClaimExtract, || {
+            std::thread::sleep(Duration::from_millis(1))
+        });
+        let snap = snapshot(Metric::ClaimExtract);
+        assert!(snap.count > before);
+        assert!(snap.max_ns >= 1_000_000);
+
+        let text = prometheus_text();
+        assert!(text.contains("# TYPE rlm_claim_extract_seconds summary"));
+        assert!(text.contains("rlm_repl_round_trip_seconds{quantile=\"0.99\"}"));
+        assert_eq!(text.matches("_count ").count(), Metric::COUNT);
+    }
+
+    #[test]
+    fn test_names_match_c_names() {
+        for metric in Metric::ALL {
+            assert_eq!(metric.c_name().to_str().unwrap(), metric.name());
+        }
+        assert_eq!(Metric::StoreLockWait.name(), "store_lock_wait");
+    }
+}
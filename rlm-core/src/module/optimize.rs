@@ -36,13 +36,15 @@
 //! let output = optimized.forward(inputs).await?;
 //! ```
 
-use std::collections::HashSet;
+use std::collections::{HashMap, HashSet};
 use std::marker::PhantomData;
 use std::path::Path;
 use std::sync::Arc;
 
 use async_trait::async_trait;
+use futures::future::join_all;
 use serde::{Deserialize, Serialize};
+use tokio::sync::Semaphore;
 
 use super::{Demonstration, ErasedDemonstration, Example, Module, Predictor};
 use crate::error::{Error, Result};
@@ -162,6 +164,15 @@ pub struct BootstrapFewShot {
 
     /// Whether to deduplicate demonstrations by output.
     pub deduplicate: bool,
+
+    /// Maximum module forward passes in flight at once, across all rounds.
+    /// Bounds concurrent LLM calls during bootstrap.
+    #[serde(default = "default_max_concurrency")]
+    pub max_concurrency: usize,
+}
+
+fn default_max_concurrency() -> usize {
+    8
 }
 
 impl Default for BootstrapFewShot {
@@ -174,6 +185,7 @@ impl Default for BootstrapFewShot {
             temperature: 1.0,
             include_reasoning: true,
             deduplicate: true,
+            max_concurrency: default_max_concurrency(),
         }
     }
 }
@@ -226,6 +238,12 @@ impl BootstrapFewShot {
         self
     }
 
+    /// Set the maximum forward passes in flight (at least 1).
+    pub fn with_max_concurrency(mut self, n: usize) -> Self {
+        self.max_concurrency = n.max(1);
+        self
+    }
+
     /// Create a "greedy" configuration optimized for speed.
     pub fn greedy() -> Self {
         Self {
@@ -236,6 +254,7 @@ impl BootstrapFewShot {
             temperature: 0.7,
             include_reasoning: false,
             deduplicate: true,
+            max_concurrency: default_max_concurrency(),
         }
     }
 
@@ -249,6 +268,7 @@ impl BootstrapFewShot {
             temperature: 1.0,
             include_reasoning: true,
             deduplicate: true,
+            max_concurrency: default_max_concurrency(),
         }
     }
 }
@@ -272,17 +292,34 @@ impl Optimizer for BootstrapFewShot {
         let mut all_candidates: Vec<ScoredDemo<S>> = Vec::new();
         let mut stats = OptimizationStats::new(self.max_rounds);
 
+        // Rounds do not feed into each other, so every (round, example)
+        // forward pass is issued up front, bounded by `max_concurrency`.
+        // `join_all` yields results in issue order, keeping stats and
+        // candidate order identical to a sequential run.
+        let semaphore = Semaphore::new(self.max_concurrency.max(1));
+        let (semaphore, module_ref) = (&semaphore, &module);
+        let passes = (0..self.max_rounds)
+            .flat_map(|_| trainset.iter())
+            .map(|example| async move {
+                let _permit = semaphore
+                    .acquire()
+                    .await
+                    .expect("Semaphore closed unexpectedly");
+                module_ref.forward(example.inputs.clone()).await
+            });
+        let mut outputs = join_all(passes).await.into_iter();
+        let mut scores = ScoreMemo::default();
+
         // Run bootstrap rounds
         for round in 0..self.max_rounds {
             stats.start_round(round);
 
             // Process each training example
-            for example in trainset.iter() {
-                // Run the module on the example inputs
-                match module.forward(example.inputs.clone()).await {
+            for (example, output) in trainset.iter().zip(outputs.by_ref()) {
+                match output {
                     Ok(predicted) => {
                         // Evaluate against ground truth
-                        let score = metric.score(&predicted, &example.outputs);
+                        let score = scores.score(metric.as_ref(), &predicted, &example.outputs);
                         stats.record_evaluation(score);
 
                         // Check if it meets threshold
@@ -318,6 +355,7 @@ impl Optimizer for BootstrapFewShot {
 
             stats.end_round();
         }
+        stats.metric_cache_hits = scores.hits;
 
         // Also add labeled examples from trainset (with score 1.0)
         for example in trainset.iter().take(self.max_labeled_demos) {
@@ -390,6 +428,39 @@ struct ScoredDemo<S: Signature> {
     round: usize,
 }
 
+/// Metric results memoized per (prediction, gold) pair.
+///
+/// Bootstrap rounds and high-temperature sampling often reproduce the same
+/// prediction, and metrics such as edit distance are costly on long outputs.
+/// Pairs are keyed by their JSON encoding; metrics are assumed pure.
+#[derive(Default)]
+struct ScoreMemo {
+    scores: HashMap<(String, String), f64>,
+    hits: usize,
+}
+
+impl ScoreMemo {
+    fn score<T: Serialize>(&mut self, metric: &dyn Metric<T>, predicted: &T, gold: &T) -> f64 {
+        let (Ok(p), Ok(g)) = (
+            serde_json::to_string(predicted),
+            serde_json::to_string(gold),
+        ) else {
+            return metric.score(predicted, gold);
+        };
+        match self.scores.get(&(p.clone(), g.clone())) {
+            Some(&score) => {
+                self.hits += 1;
+                score
+            }
+            None => {
+                let score = metric.score(predicted, gold);
+                self.scores.insert((p, g), score);
+                score
+            }
+        }
+    }
+}
+
 /// Deduplicate demonstrations by output (keeps highest scoring).
 fn deduplicate_demos<S: Signature>(mut demos: Vec<ScoredDemo<S>>) -> Vec<ScoredDemo<S>> {
     // Already sorted by score descending, so first occurrence of each output wins
@@ -562,6 +633,9 @@ pub struct OptimizationStats {
     pub max_score: f64,
     /// Minimum metric score achieved.
     pub min_score: f64,
+    /// Evaluations answered from the (prediction, gold) metric memo.
+    #[serde(default)]
+    pub metric_cache_hits: usize,
     /// Errors encountered during optimization.
     pub errors: Vec<String>,
     /// Per-round statistics.
@@ -580,6 +654,7 @@ impl OptimizationStats {
             mean_score: 0.0,
             max_score: f64::NEG_INFINITY,
             min_score: f64::INFINITY,
+            metric_cache_hits: 0,
             errors: Vec::new(),
             round_stats: Vec::new(),
         }
@@ -758,43 +833,158 @@ pub mod metrics {
         1.0 - (distance as f64 / max_len as f64)
     }
 
-    /// Compute Levenshtein edit distance.
-    fn levenshtein_distance(a: &str, b: &str) -> usize {
-        let a_chars: Vec<char> = a.chars().collect();
-        let b_chars: Vec<char> = b.chars().collect();
-        let m = a_chars.len();
-        let n = b_chars.len();
+    /// Edit distance similarity that gives up below `min_similarity`.
+    ///
+    /// Returns the same value as [`edit_distance_similarity`] when that is at
+    /// least `min_similarity`, and 0.0 otherwise. The distance computation
+    /// stops as soon as the threshold is out of reach, which makes this much
+    /// cheaper on long, dissimilar outputs.
+    pub fn edit_distance_similarity_at_least(
+        predicted: &str,
+        gold: &str,
+        min_similarity: f64,
+    ) -> f64 {
+        if predicted == gold {
+            return 1.0;
+        }
+        if predicted.is_empty() || gold.is_empty() {
+            return 0.0;
+        }
 
-        if m == 0 {
-            return n;
+        let max_len = predicted.len().max(gold.len());
+        // The epsilon keeps float error from costing an exactly-at-threshold
+        // distance; the similarity check below is authoritative.
+        let slack = (1.0 - min_similarity.clamp(0.0, 1.0)) * max_len as f64;
+        let budget = (slack + 1e-9).floor() as usize;
+        match levenshtein_distance_within(predicted, gold, budget) {
+            Some(distance) => {
+                let similarity = 1.0 - (distance as f64 / max_len as f64);
+                if similarity >= min_similarity {
+                    similarity
+                } else {
+                    0.0
+                }
+            }
+            None => 0.0,
         }
-        if n == 0 {
-            return m;
+    }
+
+    /// Levenshtein distance between `a` and `b` (in chars), or `None` if it
+    /// exceeds `max_distance`.
+    pub fn levenshtein_distance_within(a: &str, b: &str, max_distance: usize) -> Option<usize> {
+        let a_chars: Vec<char> = a.chars().collect();
+        let b_chars: Vec<char> = b.chars().collect();
+        if a_chars.len().abs_diff(b_chars.len()) > max_distance {
+            return None;
         }
+        // The shorter string is the bit-parallel pattern: fewer words per step.
+        let (pattern, text) = if a_chars.len() <= b_chars.len() {
+            (a_chars, b_chars)
+        } else {
+            (b_chars, a_chars)
+        };
+        myers_distance(&pattern, &text, max_distance)
+    }
 
-        let mut dp = vec![vec![0usize; n + 1]; m + 1];
+    /// Compute Levenshtein edit distance.
+    fn levenshtein_distance(a: &str, b: &str) -> usize {
+        levenshtein_distance_within(a, b, usize::MAX).unwrap_or(usize::MAX)
+    }
+
+    /// Per-character match masks for a pattern: bit `i % 64` of word `i / 64`
+    /// is set where the pattern holds that character.
+    struct PatternMasks {
+        words: usize,
+        ascii: Vec<u64>,
+        other: std::collections::HashMap<char, Vec<u64>>,
+        none: Vec<u64>,
+    }
+
+    impl PatternMasks {
+        fn new(pattern: &[char]) -> Self {
+            let words = pattern.len().div_ceil(64);
+            let mut masks = Self {
+                words,
+                ascii: vec![0; 128 * words],
+                other: std::collections::HashMap::new(),
+                none: vec![0; words],
+            };
+            for (i, &c) in pattern.iter().enumerate() {
+                let bit = 1u64 << (i % 64);
+                if c.is_ascii() {
+                    masks.ascii[c as usize * words + i / 64] |= bit;
+                } else {
+                    masks.other.entry(c).or_insert_with(|| vec![0; words])[i / 64] |= bit;
+                }
+            }
+            masks
+        }
 
-        for i in 0..=m {
-            dp[i][0] = i;
+        fn get(&self, c: char) -> &[u64] {
+            if c.is_ascii() {
+                let start = c as usize * self.words;
+                &self.ascii[start..start + self.words]
+            } else {
+                self.other.get(&c).map_or(&self.none, |m| m)
+            }
         }
-        for j in 0..=n {
-            dp[0][j] = j;
+    }
+
+    /// Myers' bit-parallel edit distance, in Hyyrö's multi-word form.
+    ///
+    /// Tracks the last DP row's vertical deltas 64 cells per word, so each
+    /// text character costs O(m / 64) word operations instead of O(m). The
+    /// running score is `D[m][j]`; since each remaining text character can
+    /// lower it by at most one, the scan stops once it cannot finish within
+    /// `max_distance`.
+    fn myers_distance(pattern: &[char], text: &[char], max_distance: usize) -> Option<usize> {
+        let m = pattern.len();
+        let n = text.len();
+        if m == 0 {
+            return (n <= max_distance).then_some(n);
         }
 
-        for i in 1..=m {
-            for j in 1..=n {
-                let cost = if a_chars[i - 1] == b_chars[j - 1] {
-                    0
+        let masks = PatternMasks::new(pattern);
+        let words = masks.words;
+        let last = 1u64 << ((m - 1) % 64);
+        let mut vp = vec![!0u64; words];
+        let mut vn = vec![0u64; words];
+        let mut score = m;
+
+        for (j, &c) in text.iter().enumerate() {
+            let eq = masks.get(c);
+            // Row 0 is D[0][j] = j, so every column enters with +1.
+            let mut hp_carry = 1u64;
+            let mut hn_carry = 0u64;
+
+            for w in 0..words {
+                let x = eq[w] | hn_carry;
+                let d0 = ((x & vp[w]).wrapping_add(vp[w]) ^ vp[w]) | x | vn[w];
+                let mut hp = vn[w] | !(d0 | vp[w]);
+                let mut hn = d0 & vp[w];
+
+                let (hp_in, hn_in) = (hp_carry, hn_carry);
+                if w + 1 < words {
+                    hp_carry = hp >> 63;
+                    hn_carry = hn >> 63;
                 } else {
-                    1
-                };
-                dp[i][j] = (dp[i - 1][j] + 1)
-                    .min(dp[i][j - 1] + 1)
-                    .min(dp[i - 1][j - 1] + cost);
+                    hp_carry = u64::from(hp & last != 0);
+                    hn_carry = u64::from(hn & last != 0);
+                }
+
+                hp = (hp << 1) | hp_in;
+                hn = (hn << 1) | hn_in;
+                vp[w] = hn | !(d0 | hp);
+                vn[w] = hp & d0;
+            }
+
+            score = score + hp_carry as usize - hn_carry as usize;
+            if score.saturating_sub(n - j - 1) > max_distance {
+                return None;
             }
         }
 
-        dp[m][n]
+        (score <= max_distance).then_some(score)
     }
 
     /// Combine multiple metrics with weights.
@@ -998,6 +1188,81 @@ mod tests {
         assert!(metrics::edit_distance_similarity("abc", "xyz") < 0.5);
     }
 
+    fn naive_levenshtein(a: &str, b: &str) -> usize {
+        let a: Vec<char> = a.chars().collect();
+        let b: Vec<char> = b.chars().collect();
+        let mut prev: Vec<usize> = (0..=b.len()).collect();
+        for i in 1..=a.len() {
+            let mut row = vec![i; b.len() + 1];
+            for j in 1..=b.len() {
+                let cost = usize::from(a[i - 1] != b[j - 1]);
+                row[j] = (prev[j] + 1).min(row[j - 1] + 1).min(prev[j - 1] + cost);
+            }
+            prev = row;
+        }
+        prev[b.len()]
+    }
+
+    #[test]
+    fn test_bit_parallel_edit_distance_matches_dp() {
+        // Deterministic LCG over a small alphabet (with a non-ASCII char) so
+        // matches are frequent; lengths straddle the 64-bit word boundary.
+        let mut state = 0x2545_f491_4f6c_dd1du64;
+        let mut next = move || {
+            state = state
+                .wrapping_mul(6364136223846793005)
+                .wrapping_add(1442695040888963407);
+            (state >> 33) as usize
+        };
+        let alphabet = ['a', 'b', 'c', 'd', 'é'];
+        let random_string = |next: &mut dyn FnMut() -> usize| {
+            let len = next() % 200;
+            (0..len)
+                .map(|_| alphabet[next() % alphabet.len()])
+                .collect::<String>()
+        };
+
+        for _ in 0..300 {
+            let a = random_string(&mut next);
+            let b = random_string(&mut next);
+            let expected = naive_levenshtein(&a, &b);
+            assert_eq!(
+                metrics::levenshtein_distance_within(&a, &b, usize::MAX),
+                Some(expected),
+                "{a:?} vs {b:?}"
+            );
+            assert_eq!(
+                metrics::levenshtein_distance_within(&a, &b, expected),
+                Some(expected)
+            );
+            if expected > 0 {
+                assert_eq!(
+                    metrics::levenshtein_distance_within(&a, &b, expected - 1),
+                    None
+                );
+            }
+        }
+    }
+
+    #[test]
+    fn test_edit_distance_similarity_at_least() {
+        let exact = metrics::edit_distance_similarity("kitten", "sitting");
+        assert_eq!(
+            metrics::edit_distance_similarity_at_least("kitten", "sitting", exact),
+            exact
+        );
+        assert_eq!(
+            metrics::edit_distance_similarity_at_least("kitten", "sitting", exact + 0.01),
+            0.0
+        );
+        let long_a = "a".repeat(5_000);
+        let long_b = "b".repeat(5_000);
+        assert_eq!(
+            metrics::edit_distance_similarity_at_least(&long_a, &long_b, 0.9),
+            0.0
+        );
+    }
+
     #[test]
     fn test_metrics_contains() {
         assert_eq!(metrics::contains("hello world", "world"), 1.0);
@@ -1127,6 +1392,63 @@ mod tests {
             .all(|d| d.reasoning.is_none()));
     }
 
+    #[derive(Clone, Default)]
+    struct ConcurrencyProbe {
+        in_flight: Arc<std::sync::atomic::AtomicUsize>,
+        peak: Arc<std::sync::atomic::AtomicUsize>,
+    }
+
+    #[async_trait]
+    impl Module for ConcurrencyProbe {
+        type Sig = MockSignature;
+
+        async fn forward(&self, inputs: MockInputs) -> Result<MockOutputs> {
+            use std::sync::atomic::Ordering;
+            let now = self.in_flight.fetch_add(1, Ordering::SeqCst) + 1;
+            self.peak.fetch_max(now, Ordering::SeqCst);
+            tokio::time::sleep(std::time::Duration::from_millis(5)).await;
+            self.in_flight.fetch_sub(1, Ordering::SeqCst);
+            Ok(MockOutputs {
+                result: inputs.text,
+            })
+        }
+
+        fn predictors(&self) -> Vec<&dyn Predictor> {
+            Vec::new()
+        }
+
+        fn set_lm(&mut self, _lm: Arc<dyn LLMClient>) {}
+
+        fn get_lm(&self) -> Option<Arc<dyn LLMClient>> {
+            None
+        }
+    }
+
+    #[tokio::test]
+    async fn test_compile_bounds_concurrency_and_memoizes_metric() {
+        let optimizer = BootstrapFewShot::new()
+            .with_max_rounds(3)
+            .with_max_labeled_demos(0)
+            .with_max_concurrency(2);
+        let module = ConcurrencyProbe::default();
+        let peak = Arc::clone(&module.peak);
+        let trainset = mock_trainset();
+        let metric: MetricFn<MockOutputs> = Arc::new(metrics::exact_match);
+
+        let optimized = optimizer
+            .compile(module, &trainset, metric)
+            .await
+            .expect("compile should succeed");
+
+        assert_eq!(peak.load(std::sync::atomic::Ordering::SeqCst), 2);
+        let stats = optimized.stats();
+        assert_eq!(stats.rounds_completed, 3);
+        assert_eq!(stats.examples_evaluated, 6);
+        assert!(stats.round_stats.iter().all(|r| r.examples_evaluated == 2));
+        // Rounds 2 and 3 reproduce round 1's predictions.
+        assert_eq!(stats.metric_cache_hits, 4);
+    }
+
     #[tokio::test]
     async fn test_optimized_module_save_and_load_roundtrip() {
         let optimizer = BootstrapFewShot::new()
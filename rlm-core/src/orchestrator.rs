@@ -11,8 +11,8 @@ use crate::complexity::{ActivationDecision, TaskComplexitySignals};
 use crate::context::SessionContext;
 use crate::error::Result;
 use crate::llm::{
-    CostTracker, DualModelConfig, ModelCallTier, RoutingContext, RoutingDecision, SmartRouter,
-    TokenUsage,
+    CostTracker, DualModelConfig, ModelCallTier, RoutingContext, RoutingDecision,
+    ShardedCostTracker, SmartRouter, TokenUsage,
 };
 use crate::signature::{
     ExecutionLimits, ExecutionResult, FallbackExtractor, FallbackTrigger, ReplHistory, Signature,
@@ -25,6 +25,7 @@ use serde::{Deserialize, Serialize};
 use serde_json::Value;
 use std::collections::HashMap;
 use std::pin::Pin;
+use std::sync::atomic::{AtomicU64, Ordering};
 use std::time::Instant;
 
 /// Result of a recursive RLM sub-call.
@@ -76,6 +77,19 @@ impl Default for OrchestratorConfig {
     }
 }
 
+impl OrchestratorConfig {
+    /// Tokens left in `total_token_budget` after the session's context.
+    pub fn remaining_token_budget(&self, ctx: &SessionContext) -> u64 {
+        self.total_token_budget
+            .saturating_sub(ctx.total_tokens() as u64)
+    }
+
+    /// Whether the session's context fits within a single call's budget.
+    pub fn fits_single_call(&self, ctx: &SessionContext) -> bool {
+        ctx.total_tokens() as u64 <= self.max_tokens_per_call
+    }
+}
+
 /// Execution mode for the orchestrator.
 #[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize, Deserialize)]
 #[serde(rename_all = "lowercase")]
@@ -285,12 +299,13 @@ impl OrchestratorBuilder {
 ///
 /// This bridges `SmartRouter` dual-model decisions into orchestration paths and
 /// keeps tiered cost accounting (`root`/`recursive`/`extraction`) in sync with
-/// model selection.
+/// model selection. Usage is recorded through `&self` into a sharded tracker,
+/// so concurrent sub-calls can share one runtime without a lock.
 pub struct OrchestrationRoutingRuntime {
     router: SmartRouter,
     dual_model: DualModelConfig,
-    cost_tracker: CostTracker,
-    tokens_used: u64,
+    cost_tracker: ShardedCostTracker,
+    tokens_used: AtomicU64,
 }
 
 impl OrchestrationRoutingRuntime {
@@ -304,8 +319,8 @@ impl OrchestrationRoutingRuntime {
         Self {
             router,
             dual_model,
-            cost_tracker: CostTracker::new(),
-            tokens_used: 0,
+            cost_tracker: ShardedCostTracker::new(),
+            tokens_used: AtomicU64::new(0),
         }
     }
 
@@ -319,8 +334,8 @@ impl OrchestrationRoutingRuntime {
         let context = RoutingContext::new().with_depth(depth);
         let decision = self
             .router
-            .route_rlm(query, &context, &self.dual_model, self.tokens_used);
-        let tier = if self.dual_model.is_using_root(depth, self.tokens_used) {
+            .route_rlm(query, &context, &self.dual_model, self.tokens_used());
+        let tier = if self.dual_model.is_using_root(depth, self.tokens_used()) {
             ModelCallTier::Root
         } else {
             ModelCallTier::Recursive
@@ -335,7 +350,7 @@ impl OrchestrationRoutingRuntime {
             query,
             &context,
             &self.dual_model,
-            self.tokens_used,
+            self.tokens_used(),
             ModelCallTier::Extraction,
         );
         (decision, ModelCallTier::Extraction)
@@ -343,7 +358,7 @@ impl OrchestrationRoutingRuntime {
 
     /// Record token/cost usage for an orchestration call.
     pub fn record_usage(
-        &mut self,
+        &self,
         decision: &RoutingDecision,
         usage: &TokenUsage,
         cost: Option<f64>,
@@ -351,17 +366,23 @@ impl OrchestrationRoutingRuntime {
     ) {
         self.cost_tracker
             .record_tiered(&decision.model.id, usage, cost, tier);
-        self.tokens_used += usage.input_tokens + usage.output_tokens;
+        self.tokens_used
+            .fetch_add(usage.input_tokens + usage.output_tokens, Ordering::Relaxed);
+    }
+
+    /// Snapshot of the current tiered cost tracker state.
+    pub fn cost_tracker(&self) -> CostTracker {
+        self.cost_tracker.snapshot()
     }
 
-    /// Read current tiered cost tracker state.
-    pub fn cost_tracker(&self) -> &CostTracker {
+    /// Shared sharded tracker backing this runtime.
+    pub fn sharded_cost_tracker(&self) -> &ShardedCostTracker {
         &self.cost_tracker
     }
 
     /// Total tokens recorded by this runtime.
     pub fn tokens_used(&self) -> u64 {
-        self.tokens_used
+        self.tokens_used.load(Ordering::Relaxed)
     }
 }
 
@@ -594,6 +615,11 @@ mod tests {
         assert_eq!(config.max_depth, 3);
         assert!(config.default_spawn_repl);
         assert_eq!(config.repl_timeout_ms, 30_000);
+
+        let mut ctx = SessionContext::new();
+        ctx.cache_file("/big.txt", "x".repeat(20_000));
+        assert_eq!(config.remaining_token_budget(&ctx), 95_000);
+        assert!(!config.fits_single_call(&ctx));
     }
 
     #[test]
@@ -652,7 +678,7 @@ mod tests {
 
     #[test]
     fn test_orchestration_routing_runtime_tracks_root_recursive_extraction() {
-        let mut runtime = OrchestrationRoutingRuntime::for_mode(ExecutionMode::Balanced);
+        let runtime = OrchestrationRoutingRuntime::for_mode(ExecutionMode::Balanced);
 
         let (root_decision, root_tier) = runtime.route_recursive("Design system architecture", 0);
         assert_eq!(root_tier, ModelCallTier::Root);
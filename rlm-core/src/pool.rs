@@ -0,0 +1,553 @@
+//! Bounded, pre-warmed pools of subprocess handles.
+//!
+//! [`ProcessPool`] caps the number of live handles, keeps a minimum number of
+//! idle handles warm in the background, and queues callers when the pool is
+//! exhausted. Spawning and liveness checks always run outside the pool lock so
+//! a slow interpreter start never blocks other callers.
+//!
+//! Every handle handed out carries a [`PoolLease`]. Dropping the handle without
+//! returning it (for example when a caller frees it directly) releases its
+//! capacity slot, so the pool cannot leak capacity.
+
+use crate::error::{Error, Result};
+use serde::{Deserialize, Serialize};
+use std::sync::{Arc, Condvar, Mutex, MutexGuard};
+use std::thread::JoinHandle;
+use std::time::{Duration, Instant};
+
+/// Upper bounds (inclusive, in milliseconds) of the spawn latency histogram
+/// buckets. A final overflow bucket counts slower spawns.
+pub const SPAWN_LATENCY_BUCKETS_MS: [u64; 8] = [10, 50, 100, 250, 500, 1_000, 2_500, 5_000];
+
+/// Delay before the maintainer retries after a failed pre-warm spawn.
+const PREWARM_RETRY_MS: u64 = 1_000;
+
+/// A handle that can be managed by a [`ProcessPool`].
+pub trait Poolable: Send + Sized + 'static {
+    /// Configuration used to spawn new handles.
+    type Config: Clone + Send + Sync + 'static;
+
+    /// Spawn a new, ready-to-use handle.
+    fn spawn(config: &Self::Config) -> Result<Self>;
+
+    /// Whether the underlying process is still running.
+    fn is_alive(&mut self) -> bool;
+
+    /// Storage for the lease tying this handle to its pool.
+    fn lease_slot(&mut self) -> &mut Option<PoolLease>;
+}
+
+/// Sizing and timing options for a [`ProcessPool`].
+///
+/// All fields are optional when deserialized from JSON; missing fields take
+/// their default values.
+#[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
+#[serde(default)]
+pub struct PoolOptions {
+    /// Idle handles the background thread keeps warm.
+    pub min_idle: usize,
+    /// Maximum live handles, idle and busy combined. `0` means unbounded.
+    pub max_size: usize,
+    /// How long `acquire()` waits for a handle when the pool is exhausted.
+    pub acquire_timeout_ms: u64,
+    /// How often idle handles are checked for liveness. `0` disables checks.
+    pub health_check_interval_ms: u64,
+}
+
+impl Default for PoolOptions {
+    fn default() -> Self {
+        Self {
+            min_idle: 0,
+            max_size: 4,
+            acquire_timeout_ms: 30_000,
+            health_check_interval_ms: 5_000,
+        }
+    }
+}
+
+/// Point-in-time pool statistics.
+#[derive(Debug, Clone, Default, PartialEq, Serialize, Deserialize)]
+pub struct PoolStats {
+    /// Handles ready to be acquired.
+    pub idle: usize,
+    /// Handles currently checked out.
+    pub busy: usize,
+    /// Spawns in progress.
+    pub spawning: usize,
+    /// Successful spawns since the pool was created.
+    pub spawned: u64,
+    /// Failed spawns since the pool was created.
+    pub spawn_failures: u64,
+    /// Acquires that gave up waiting.
+    pub acquire_timeouts: u64,
+    /// Spawn latency counts per [`SPAWN_LATENCY_BUCKETS_MS`] bucket, followed
+    /// by the overflow bucket.
+    pub spawn_latency_ms: Vec<u64>,
+}
+
+struct State<T> {
+    idle: Vec<T>,
+    busy: usize,
+    spawning: usize,
+    checking: usize,
+    shutdown: bool,
+    spawned: u64,
+    spawn_failures: u64,
+    acquire_timeouts: u64,
+    spawn_latency: [u64; SPAWN_LATENCY_BUCKETS_MS.len() + 1],
+}
+
+impl<T> State<T> {
+    fn total(&self) -> usize {
+        self.idle.len() + self.busy + self.spawning + self.checking
+    }
+}
+
+struct Shared<T: Poolable> {
+    config: T::Config,
+    options: PoolOptions,
+    state: Mutex<State<T>>,
+    changed: Condvar,
+}
+
+impl<T: Poolable> Shared<T> {
+    fn lock(&self) -> Result<MutexGuard<'_, State<T>>> {
+        self.state
+            .lock()
+            .map_err(|e| Error::Internal(format!("Failed to lock pool: {}", e)))
+    }
+
+    fn capacity(&self) -> usize {
+        match self.options.max_size {
+            0 => usize::MAX,
+            n => n,
+        }
+    }
+
+    /// Spawn a handle without holding the lock, recording latency afterwards.
+    fn spawn_timed(&self) -> Result<T> {
+        let start = Instant::now();
+        let result = T::spawn(&self.config);
+        let elapsed_ms = start.elapsed().as_millis() as u64;
+
+        if let Ok(mut state) = self.state.lock() {
+            let bucket = SPAWN_LATENCY_BUCKETS_MS
+                .iter()
+                .position(|&bound| elapsed_ms <= bound)
+                .unwrap_or(SPAWN_LATENCY_BUCKETS_MS.len());
+            state.spawn_latency[bucket] += 1;
+            match result {
+                Ok(_) => state.spawned += 1,
+                Err(_) => state.spawn_failures += 1,
+            }
+        }
+        result
+    }
+}
+
+trait LeaseRelease: Send + Sync {
+    fn release_lease(&self);
+}
+
+impl<T: Poolable> LeaseRelease for Shared<T> {
+    fn release_lease(&self) {
+        if let Ok(mut state) = self.state.lock() {
+            state.busy = state.busy.saturating_sub(1);
+        }
+        self.changed.notify_all();
+    }
+}
+
+/// Capacity reservation held by a checked-out handle.
+///
+/// Dropping the lease returns its slot to the pool that issued it.
+pub struct PoolLease(Arc<dyn LeaseRelease>);
+
+impl Drop for PoolLease {
+    fn drop(&mut self) {
+        self.0.release_lease();
+    }
+}
+
+impl std::fmt::Debug for PoolLease {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.write_str("PoolLease")
+    }
+}
+
+/// Thread-safe bounded pool of [`Poolable`] handles.
+pub struct ProcessPool<T: Poolable> {
+    shared: Arc<Shared<T>>,
+    maintainer: Option<JoinHandle<()>>,
+}
+
+impl<T: Poolable> ProcessPool<T> {
+    /// Create a pool. A background thread is started when pre-warming or
+    /// health checks are enabled.
+    pub fn new(config: T::Config, options: PoolOptions) -> Self {
+        let needs_maintainer = options.min_idle > 0 || options.health_check_interval_ms > 0;
+        let shared = Arc::new(Shared {
+            config,
+            options,
+            state: Mutex::new(State {
+                idle: Vec::new(),
+                busy: 0,
+                spawning: 0,
+                checking: 0,
+                shutdown: false,
+                spawned: 0,
+                spawn_failures: 0,
+                acquire_timeouts: 0,
+                spawn_latency: [0; SPAWN_LATENCY_BUCKETS_MS.len() + 1],
+            }),
+            changed: Condvar::new(),
+        });
+
+        let maintainer = if needs_maintainer {
+            let shared = Arc::clone(&shared);
+            std::thread::Builder::new()
+                .name("rlm-pool-maintainer".to_string())
+                .spawn(move || maintain(shared))
+                .ok()
+        } else {
+            None
+        };
+
+        Self { shared, maintainer }
+    }
+
+    /// Options the pool was created with.
+    pub fn options(&self) -> &PoolOptions {
+        &self.shared.options
+    }
+
+    /// Acquire a handle, waiting up to the configured acquire timeout.
+    pub fn acquire(&self) -> Result<T> {
+        self.acquire_timeout(Duration::from_millis(
+            self.shared.options.acquire_timeout_ms,
+        ))
+    }
+
+    /// Acquire a handle, waiting up to `timeout` if the pool is exhausted.
+    ///
+    /// Idle handles are reused first; otherwise a new handle is spawned if the
+    /// pool is below `max_size`. Fails with [`Error::Timeout`] if no handle
+    /// becomes available in time.
+    pub fn acquire_timeout(&self, timeout: Duration) -> Result<T> {
+        // An overflowing deadline means "wait indefinitely".
+        let deadline = Instant::now().checked_add(timeout);
+        let mut state = self.shared.lock()?;
+
+        loop {
+            if state.shutdown {
+                return Err(Error::Internal("Pool is shut down".to_string()));
+            }
+
+            if let Some(mut handle) = state.idle.pop() {
+                state.busy += 1;
+                drop(state);
+                if handle.is_alive() {
+                    *handle.lease_slot() = Some(self.lease());
+                    // Wake the maintainer so it can top the idle set back up.
+                    self.shared.changed.notify_all();
+                    return Ok(handle);
+                }
+                drop(handle);
+                state = self.shared.lock()?;
+                state.busy -= 1;
+                continue;
+            }
+
+            if state.total() < self.shared.capacity() {
+                state.spawning += 1;
+                drop(state);
+                let result = self.shared.spawn_timed();
+                state = self.shared.lock()?;
+                state.spawning -= 1;
+                return match result {
+                    Ok(mut handle) => {
+                        state.busy += 1;
+                        drop(state);
+                        *handle.lease_slot() = Some(self.lease());
+                        Ok(handle)
+                    }
+                    Err(e) => {
+                        drop(state);
+                        self.shared.changed.notify_all();
+                        Err(e)
+                    }
+                };
+            }
+
+            let now = Instant::now();
+            let wait = match deadline {
+                Some(deadline) if now >= deadline => {
+                    state.acquire_timeouts += 1;
+                    return Err(Error::timeout(timeout.as_millis() as u64));
+                }
+                Some(deadline) => deadline - now,
+                None => Duration::from_secs(3_600),
+            };
+            state = self
+                .shared
+                .changed
+                .wait_timeout(state, wait)
+                .map_err(|e| Error::Internal(format!("Failed to lock pool: {}", e)))?
+                .0;
+        }
+    }
+
+    /// Return a handle to the pool. Dead handles are discarded.
+    pub fn release(&self, mut handle: T) {
+        let lease = handle.lease_slot().take();
+        let alive = handle.is_alive();
+        let mut rejected = None;
+
+        if let Ok(mut state) = self.shared.lock() {
+            // A handle without a lease was never counted against capacity.
+            let fits = lease.is_some() || state.total() < self.shared.capacity();
+            if alive && fits && !state.shutdown {
+                state.idle.push(handle);
+            } else {
+                rejected = Some(handle);
+            }
+        } else {
+            rejected = Some(handle);
+        }
+
+        // Drop the lease after the handle is back so waiters see it idle.
+        drop(lease);
+        self.shared.changed.notify_all();
+        drop(rejected);
+    }
+
+    /// Snapshot of pool occupancy and spawn statistics.
+    pub fn stats(&self) -> PoolStats {
+        match self.shared.state.lock() {
+            Ok(state) => PoolStats {
+                idle: state.idle.len(),
+                busy: state.busy,
+                spawning: state.spawning,
+                spawned: state.spawned,
+                spawn_failures: state.spawn_failures,
+                acquire_timeouts: state.acquire_timeouts,
+                spawn_latency_ms: state.spawn_latency.to_vec(),
+            },
+            Err(_) => PoolStats::default(),
+        }
+    }
+
+    fn lease(&self) -> PoolLease {
+        PoolLease(Arc::clone(&self.shared) as Arc<dyn LeaseRelease>)
+    }
+}
+
+impl<T: Poolable> Drop for ProcessPool<T> {
+    fn drop(&mut self) {
+        let idle = match self.shared.state.lock() {
+            Ok(mut state) => {
+                state.shutdown = true;
+                std::mem::take(&mut state.idle)
+            }
+            Err(_) => Vec::new(),
+        };
+        self.shared.changed.notify_all();
+        drop(idle);
+        if let Some(maintainer) = self.maintainer.take() {
+            let _ = maintainer.join();
+        }
+    }
+}
+
+/// Background loop: keep `min_idle` handles warm and evict dead idle handles.
+fn maintain<T: Poolable>(shared: Arc<Shared<T>>) {
+    let interval = Duration::from_millis(shared.options.health_check_interval_ms);
+    let mut next_check = Instant::now() + interval;
+    let mut retry_at: Option<Instant> = None;
+
+    let Ok(mut state) = shared.state.lock() else {
+        return;
+    };
+    loop {
+        if state.shutdown {
+            return;
+        }
+        let now = Instant::now();
+
+        let wants_handle = state.idle.len() + state.spawning < shared.options.min_idle
+            && state.total() < shared.capacity()
+            && retry_at.map_or(true, |at| now >= at);
+        if wants_handle {
+            state.spawning += 1;
+            drop(state);
+            let result = shared.spawn_timed();
+            let Ok(mut guard) = shared.state.lock() else {
+                return;
+            };
+            guard.spawning -= 1;
+            let mut discard = None;
+            match result {
+                Ok(handle) if !guard.shutdown => {
+                    guard.idle.push(handle);
+                    retry_at = None;
+                }
+                Ok(handle) => discard = Some(handle),
+                Err(e) => {
+                    tracing::warn!("Failed to pre-warm pool handle: {}", e);
+                    retry_at = Some(Instant::now() + Duration::from_millis(PREWARM_RETRY_MS));
+                }
+            }
+            drop(guard);
+            shared.changed.notify_all();
+            drop(discard);
+            state = match shared.state.lock() {
+                Ok(s) => s,
+                Err(_) => return,
+            };
+            continue;
+        }
+
+        if !interval.is_zero() && now >= next_check {
+            let batch = std::mem::take(&mut state.idle);
+            state.checking += batch.len();
+            drop(state);
+            let checked = batch.len();
+            let alive: Vec<T> = batch
+                .into_iter()
+                .filter_map(|mut h| if h.is_alive() { Some(h) } else { None })
+                .collect();
+            state = match shared.state.lock() {
+                Ok(s) => s,
+                Err(_) => return,
+            };
+            state.checking -= checked;
+            state.idle.extend(alive);
+            shared.changed.notify_all();
+            next_check = Instant::now() + interval;
+            continue;
+        }
+
+        let mut wait = if interval.is_zero() {
+            Duration::from_secs(3_600)
+        } else {
+            next_check.saturating_duration_since(now)
+        };
+        if let Some(at) = retry_at {
+            wait = wait.min(at.saturating_duration_since(now));
+        }
+        state = match shared.changed.wait_timeout(state, wait) {
+            Ok((s, _)) => s,
+            Err(_) => return,
+        };
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
+
+    #[derive(Clone, Default)]
+    struct MockConfig {
+        spawned: Arc<AtomicUsize>,
+    }
+
+    struct MockProc {
+        alive: Arc<AtomicBool>,
+        lease: Option<PoolLease>,
+    }
+
+    impl Poolable for MockProc {
+        type Config = MockConfig;
+
+        fn spawn(config: &MockConfig) -> Result<Self> {
+            config.spawned.fetch_add(1, Ordering::SeqCst);
+            Ok(Self {
+                alive: Arc::new(AtomicBool::new(true)),
+                lease: None,
+            })
+        }
+
+        fn is_alive(&mut self) -> bool {
+            self.alive.load(Ordering::SeqCst)
+        }
+
+        fn lease_slot(&mut self) -> &mut Option<PoolLease> {
+            &mut self.lease
+        }
+    }
+
+    fn options(min_idle: usize, max_size: usize) -> PoolOptions {
+        PoolOptions {
+            min_idle,
+            max_size,
+            acquire_timeout_ms: 1_000,
+            health_check_interval_ms: 0,
+        }
+    }
+
+    fn wait_for(pool: &ProcessPool<MockProc>, pred: impl Fn(&PoolStats) -> bool) -> PoolStats {
+        let deadline = Instant::now() + Duration::from_secs(5);
+        loop {
+            let stats = pool.stats();
+            if pred(&stats) || Instant::now() >= deadline {
+                return stats;
+            }
+            std::thread::sleep(Duration::from_millis(5));
+        }
+    }
+
+    #[test]
+    fn test_acquire_respects_max_size() {
+        let config = MockConfig::default();
+        let pool = ProcessPool::<MockProc>::new(config.clone(), options(0, 2));
+
+        let a = pool.acquire().unwrap();
+        let _b = pool.acquire().unwrap();
+        let err = pool.acquire_timeout(Duration::from_millis(20)).unwrap_err();
+        assert!(matches!(err, Error::Timeout { .. }));
+        assert_eq!(pool.stats().acquire_timeouts, 1);
+
+        pool.release(a);
+        let _c = pool.acquire().unwrap();
+        assert_eq!(config.spawned.load(Ordering::SeqCst), 2);
+
+        let stats = pool.stats();
+        assert_eq!((stats.idle, stats.busy), (0, 2));
+        assert_eq!(stats.spawn_latency_ms.iter().sum::<u64>(), 2);
+    }
+
+    #[test]
+    fn test_waiter_wakes_on_release_and_drop() {
+        let pool = Arc::new(ProcessPool::<MockProc>::new(
+            MockConfig::default(),
+            options(0, 1),
+        ));
+        let held = pool.acquire().unwrap();
+
+        let waiter = {
+            let pool = Arc::clone(&pool);
+            std::thread::spawn(move || pool.acquire_timeout(Duration::from_secs(5)).is_ok())
+        };
+        std::thread::sleep(Duration::from_millis(20));
+        // Dropping a leased handle frees its slot just like releasing it.
+        drop(held);
+        assert!(waiter.join().unwrap());
+    }
+
+    #[test]
+    fn test_prewarm_and_dead_handle_eviction() {
+        let config = MockConfig::default();
+        let pool = ProcessPool::<MockProc>::new(config.clone(), options(2, 4));
+        assert_eq!(wait_for(&pool, |s| s.idle == 2).idle, 2);
+
+        let handle = pool.acquire().unwrap();
+        handle.alive.store(false, Ordering::SeqCst);
+        pool.release(handle);
+
+        // The dead handle is discarded and the idle set refilled.
+        let stats = wait_for(&pool, |s| s.idle == 2 && s.busy == 0);
+        assert_eq!((stats.idle, stats.busy), (2, 0));
+        assert_eq!(config.spawned.load(Ordering::SeqCst), 3);
+    }
+}
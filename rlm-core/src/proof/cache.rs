@@ -0,0 +1,196 @@
+//! Tactic outcome cache.
+//!
+//! Lean tactics are deterministic for a given environment and goal, so the
+//! outcome of running `tactic` against `goal` in `env` can be reused instead
+//! of round-tripping to a REPL again. The cache is shared by the workers of
+//! [`ProofAutomation::prove_pooled`](super::ProofAutomation::prove_pooled)
+//! and persists across proof attempts.
+
+use crate::proof::types::TacticResult;
+use std::collections::{HashMap, VecDeque};
+use std::sync::{Mutex, MutexGuard};
+
+/// Default number of outcomes kept.
+pub const DEFAULT_TACTIC_CACHE_ENTRIES: usize = 4_096;
+
+/// Key identifying a tactic outcome.
+#[derive(Debug, Clone, PartialEq, Eq, Hash)]
+pub struct TacticCacheKey {
+    /// Environment identity, from [`LeanReplConfig::env_key`](crate::lean::LeanReplConfig::env_key).
+    pub env: String,
+    /// Goal statement, whitespace-normalized.
+    pub goal: String,
+    /// Tactic text.
+    pub tactic: String,
+}
+
+impl TacticCacheKey {
+    /// Create a key. Runs of whitespace in `goal` and `tactic` collapse to
+    /// one space so reformatted statements share entries.
+    pub fn new(env: impl Into<String>, goal: &str, tactic: &str) -> Self {
+        Self {
+            env: env.into(),
+            goal: normalize(goal),
+            tactic: normalize(tactic),
+        }
+    }
+}
+
+fn normalize(s: &str) -> String {
+    s.split_whitespace().collect::<Vec<_>>().join(" ")
+}
+
+/// Cache hit/miss counters.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct TacticCacheStats {
+    /// Lookups answered from the cache.
+    pub hits: u64,
+    /// Lookups that had to run the tactic.
+    pub misses: u64,
+    /// Outcomes currently stored.
+    pub entries: usize,
+}
+
+#[derive(Default)]
+struct Inner {
+    entries: HashMap<TacticCacheKey, TacticResult>,
+    /// Insertion order, oldest first, for eviction.
+    order: VecDeque<TacticCacheKey>,
+    hits: u64,
+    misses: u64,
+}
+
+/// Thread-safe, size-bounded map from (env, goal, tactic) to outcome.
+///
+/// Eviction is first-in-first-out: outcomes are immutable, so recency buys
+/// little over insertion order for the goals a single search revisits.
+pub struct TacticCache {
+    inner: Mutex<Inner>,
+    max_entries: usize,
+}
+
+impl TacticCache {
+    /// Create a cache holding at most `max_entries` outcomes.
+    pub fn new(max_entries: usize) -> Self {
+        Self {
+            inner: Mutex::new(Inner::default()),
+            max_entries,
+        }
+    }
+
+    fn lock(&self) -> MutexGuard<'_, Inner> {
+        // A panic mid-update at worst loses entries.
+        self.inner.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    /// Look up an outcome, recording a hit or miss. Hits report zero
+    /// elapsed time, since no REPL was consulted.
+    pub fn get(&self, key: &TacticCacheKey) -> Option<TacticResult> {
+        let mut inner = self.lock();
+        match inner.entries.get(key).cloned() {
+            Some(mut result) => {
+                inner.hits += 1;
+                result.elapsed_ms = 0;
+                Some(result)
+            }
+            None => {
+                inner.misses += 1;
+                None
+            }
+        }
+    }
+
+    /// Store an outcome, evicting the oldest entry when full.
+    pub fn put(&self, key: TacticCacheKey, result: TacticResult) {
+        if self.max_entries == 0 {
+            return;
+        }
+        let mut inner = self.lock();
+        if inner.entries.insert(key.clone(), result).is_none() {
+            inner.order.push_back(key);
+            while inner.entries.len() > self.max_entries {
+                let Some(oldest) = inner.order.pop_front() else {
+                    break;
+                };
+                inner.entries.remove(&oldest);
+            }
+        }
+    }
+
+    /// Current counters.
+    pub fn stats(&self) -> TacticCacheStats {
+        let inner = self.lock();
+        TacticCacheStats {
+            hits: inner.hits,
+            misses: inner.misses,
+            entries: inner.entries.len(),
+        }
+    }
+
+    /// Drop every outcome and reset the counters.
+    pub fn clear(&self) {
+        *self.lock() = Inner::default();
+    }
+}
+
+impl Default for TacticCache {
+    fn default() -> Self {
+        Self::new(DEFAULT_TACTIC_CACHE_ENTRIES)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_hit_after_put_and_whitespace_normalization() {
+        let cache = TacticCache::new(8);
+        let key = TacticCacheKey::new("env", "theorem t : 1 + 1 = 2", "decide");
+        assert!(cache.get(&key).is_none());
+
+        cache.put(key, TacticResult::success("decide", vec![], 17));
+        let hit = cache
+            .get(&TacticCacheKey::new(
+                "env",
+                "theorem t :\n  1 + 1 = 2",
+                " decide",
+            ))
+            .expect("normalized key should hit");
+        assert!(hit.is_complete());
+        assert_eq!(hit.elapsed_ms, 0);
+
+        // A different environment is a different outcome.
+        assert!(cache
+            .get(&TacticCacheKey::new(
+                "other",
+                "theorem t : 1 + 1 = 2",
+                "decide"
+            ))
+            .is_none());
+
+        let stats = cache.stats();
+        assert_eq!((stats.hits, stats.misses, stats.entries), (1, 2, 1));
+    }
+
+    #[test]
+    fn test_evicts_oldest_when_full() {
+        let cache = TacticCache::new(2);
+        for tactic in ["simp", "omega", "rfl"] {
+            cache.put(
+                TacticCacheKey::new("env", "goal", tactic),
+                TacticResult::failure(tactic, "no progress", 1),
+            );
+        }
+        assert_eq!(cache.stats().entries, 2);
+        assert!(cache
+            .get(&TacticCacheKey::new("env", "goal", "simp"))
+            .is_none());
+        assert!(cache
+            .get(&TacticCacheKey::new("env", "goal", "rfl"))
+            .is_some());
+
+        cache.clear();
+        assert_eq!(cache.stats(), TacticCacheStats::default());
+    }
+}
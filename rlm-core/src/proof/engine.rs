@@ -7,11 +7,16 @@
 //! 2. Automation tactics (search-based)
 //! 3. AI-assisted tactics (LLM-generated)
 //! 4. Human loop fallback (`sorry` marker for manual completion)
+//!
+//! [`ProofAutomation::prove`] drives a single REPL sequentially;
+//! [`ProofAutomation::prove_pooled`] fans each tier's candidates out across a
+//! [`LeanReplPool`] and memoizes outcomes in a [`TacticCache`].
 
-use crate::error::Result;
-use crate::lean::repl::LeanRepl;
-use crate::lean::types::Goal;
+use crate::error::{Error, Result};
+use crate::lean::repl::{LeanRepl, LeanReplPool};
+use crate::lean::types::{Goal, LeanResponse};
 use crate::memory::{Node, NodeType, SqliteMemoryStore, Tier};
+use crate::proof::cache::{TacticCache, TacticCacheKey, DEFAULT_TACTIC_CACHE_ENTRIES};
 use crate::proof::tactics::{
     domain_specific_tactics, sorry_placeholder, tactic_variations, tactics_for_goal,
     tactics_for_tier,
@@ -19,7 +24,8 @@ use crate::proof::tactics::{
 use crate::proof::types::{
     AutomationTier, ProofAttempt, ProofContext, ProofStats, ProofStrategy, SpecDomain, TacticResult,
 };
-use std::collections::HashMap;
+use std::collections::{HashMap, HashSet};
+use std::sync::atomic::{AtomicBool, AtomicUsize, Ordering};
 use std::time::Instant;
 
 /// Configuration for the proof automation engine.
@@ -45,6 +51,9 @@ pub struct ProofAutomationConfig {
 
     /// Whether to try tactic variations.
     pub try_variations: bool,
+
+    /// Maximum tactic outcomes memoized by [`ProofAutomation::prove_pooled`].
+    pub tactic_cache_entries: usize,
 }
 
 impl Default for ProofAutomationConfig {
@@ -57,6 +66,7 @@ impl Default for ProofAutomationConfig {
             enable_ai: true,
             enable_learning: true,
             try_variations: true,
+            tactic_cache_entries: DEFAULT_TACTIC_CACHE_ENTRIES,
         }
     }
 }
@@ -77,30 +87,37 @@ pub struct ProofAutomation {
 
     /// Memory store for persisting learned strategies.
     memory: Option<SqliteMemoryStore>,
+
+    /// Outcomes of tactics already run by `prove_pooled`.
+    tactic_cache: TacticCache,
 }
 
 impl ProofAutomation {
     /// Create a new proof automation engine.
     pub fn new(config: ProofAutomationConfig) -> Self {
         let strategies = Self::initialize_default_strategies();
+        let tactic_cache = TacticCache::new(config.tactic_cache_entries);
 
         Self {
             config,
             strategies,
             stats: ProofStats::default(),
             memory: None,
+            tactic_cache,
         }
     }
 
     /// Create with an in-memory store for learning.
     pub fn with_memory(config: ProofAutomationConfig, memory: SqliteMemoryStore) -> Self {
         let strategies = Self::initialize_default_strategies();
+        let tactic_cache = TacticCache::new(config.tactic_cache_entries);
 
         Self {
             config,
             strategies,
             stats: ProofStats::default(),
             memory: Some(memory),
+            tactic_cache,
         }
     }
 
@@ -169,12 +186,178 @@ impl ProofAutomation {
         }
 
         // Tier 4: Human fallback
+        Ok(self.fall_back_to_human(goal, attempt))
+    }
+
+    /// Try to prove `theorem` using the tiered approach, running each tier's
+    /// candidate tactics in parallel across `pool`.
+    ///
+    /// `theorem` is the statement without a proof, as accepted by
+    /// [`LeanRepl::start_proof`] (e.g. `theorem t (x : Nat) : x + 0 = x`);
+    /// `goal` is used for tactic selection. Proof-state IDs are
+    /// process-local, so each worker opens its own proof state for
+    /// `theorem`. Outcomes are memoized by (environment, statement, tactic),
+    /// and cached candidates are not re-run. Candidates are recorded in
+    /// priority order; once one closes the goal, workers stop picking up
+    /// new tactics.
+    pub fn prove_pooled(
+        &mut self,
+        pool: &LeanReplPool,
+        theorem: &str,
+        goal: &Goal,
+    ) -> Result<ProofAttempt> {
+        let mut attempt = ProofAttempt::new(goal.clone());
+        let domain = attempt.domain;
+
+        let mut tiers = vec![
+            (AutomationTier::Decidable, self.config.decidable_timeout_ms),
+            (
+                AutomationTier::Automation,
+                self.config.automation_timeout_ms,
+            ),
+        ];
+        if self.config.enable_ai {
+            tiers.push((AutomationTier::AIAssisted, self.config.ai_timeout_ms));
+        }
+
+        for (tier, timeout_ms) in tiers {
+            let candidates = self.pooled_candidates(tier, goal, &attempt);
+            let results =
+                Self::run_pooled(&self.tactic_cache, pool, theorem, &candidates, timeout_ms)?;
+
+            for result in results {
+                attempt.record_tactic(result.clone());
+                if result.is_complete() {
+                    attempt.mark_success(tier);
+                    self.record_success(goal, &result.tactic, domain);
+                    self.stats.record(&attempt);
+                    return Ok(attempt);
+                }
+            }
+        }
+
+        Ok(self.fall_back_to_human(goal, attempt))
+    }
+
+    /// Record the `sorry` fallback (Tier 4) and finish the attempt.
+    fn fall_back_to_human(&mut self, goal: &Goal, mut attempt: ProofAttempt) -> ProofAttempt {
         let sorry = self.mark_for_human(goal);
         attempt.record_tactic(TacticResult::success(sorry, vec![goal.clone()], 0));
         attempt.mark_failure(AutomationTier::HumanLoop);
         self.stats.record(&attempt);
+        attempt
+    }
 
-        Ok(attempt)
+    /// Tactics a tier tries, in priority order, with variations expanded
+    /// inline and duplicates removed.
+    fn pooled_candidates(
+        &self,
+        tier: AutomationTier,
+        goal: &Goal,
+        attempt: &ProofAttempt,
+    ) -> Vec<String> {
+        let base = match tier {
+            AutomationTier::Decidable => self.decidable_tactics(attempt.domain),
+            AutomationTier::Automation => self.automation_tactics(goal),
+            AutomationTier::AIAssisted => return self.build_ai_tactic_candidates(goal, attempt),
+            _ => return Vec::new(),
+        };
+
+        let mut seen = HashSet::new();
+        let mut candidates = Vec::new();
+        for tactic in base {
+            let expanded = if self.config.try_variations {
+                tactic_variations(&tactic, goal)
+            } else {
+                vec![tactic]
+            };
+            for candidate in expanded {
+                if seen.insert(candidate.clone()) {
+                    candidates.push(candidate);
+                }
+            }
+        }
+        candidates
+    }
+
+    /// Resolve `candidates` against `theorem`, from `cache` where possible
+    /// and otherwise across `pool`. Returns the outcomes in candidate order,
+    /// ending at the first one that closes the goal; candidates cut off by
+    /// an earlier success or the timeout are omitted.
+    fn run_pooled(
+        cache: &TacticCache,
+        pool: &LeanReplPool,
+        theorem: &str,
+        candidates: &[String],
+        timeout_ms: u64,
+    ) -> Result<Vec<TacticResult>> {
+        let env = pool.config().env_key();
+        let keys: Vec<TacticCacheKey> = candidates
+            .iter()
+            .map(|tactic| TacticCacheKey::new(env.as_str(), theorem, tactic))
+            .collect();
+
+        let mut results: Vec<Option<TacticResult>> = keys.iter().map(|k| cache.get(k)).collect();
+        // A cached proof makes everything ranked below it irrelevant.
+        if let Some(solved) = results
+            .iter()
+            .position(|r| r.as_ref().is_some_and(TacticResult::is_complete))
+        {
+            results.truncate(solved + 1);
+        }
+
+        let pending: Vec<usize> = (0..results.len())
+            .filter(|&i| results[i].is_none())
+            .collect();
+        if !pending.is_empty() {
+            let parallelism = std::thread::available_parallelism().map_or(1, |n| n.get());
+            let workers = pool.max_size().min(parallelism).clamp(1, pending.len());
+
+            let start = Instant::now();
+            let next = AtomicUsize::new(0);
+            let solved = AtomicBool::new(false);
+            let work = PooledWork {
+                cache,
+                pool,
+                theorem,
+                candidates,
+                keys: &keys,
+                pending: &pending,
+                next: &next,
+                solved: &solved,
+                start,
+                timeout_ms,
+            };
+
+            let outcomes: Vec<Result<Vec<(usize, TacticResult)>>> = std::thread::scope(|scope| {
+                let handles: Vec<_> = (0..workers)
+                    .map(|_| scope.spawn(|| work.run_worker()))
+                    .collect();
+                handles
+                    .into_iter()
+                    .map(|h| match h.join() {
+                        Ok(outcome) => outcome,
+                        Err(payload) => std::panic::resume_unwind(payload),
+                    })
+                    .collect()
+            });
+
+            for outcome in outcomes {
+                for (i, result) in outcome? {
+                    results[i] = Some(result);
+                }
+            }
+        }
+
+        let mut ordered = Vec::with_capacity(results.len());
+        for result in results.into_iter().flatten() {
+            let complete = result.is_complete();
+            ordered.push(result);
+            if complete {
+                break;
+            }
+        }
+        Ok(ordered)
     }
 
     /// Try decidable tactics (Tier 1).
@@ -185,23 +368,9 @@ impl ProofAutomation {
         attempt: &mut ProofAttempt,
     ) -> Result<Option<TacticResult>> {
         let start = Instant::now();
-        let mut tactics = tactics_for_tier(AutomationTier::Decidable);
-
-        // Add learned tactics from strategies
-        if let Some(strategies) = self.strategies.get(&attempt.domain) {
-            for strategy in strategies {
-                for tactic in &strategy.preferred_tactics {
-                    if !tactics.iter().any(|t| *t == tactic.as_str()) {
-                        tactics.push(Box::leak(tactic.clone().into_boxed_str()));
-                    }
-                }
-            }
-        }
-
-        // Limit tactics
-        tactics.truncate(self.config.max_tactics_per_tier);
 
-        for tactic in tactics {
+        for tactic in self.decidable_tactics(attempt.domain) {
+            let tactic = tactic.as_str();
             // Check timeout
             if start.elapsed().as_millis() as u64 > self.config.decidable_timeout_ms {
                 break;
@@ -242,19 +411,9 @@ impl ProofAutomation {
         attempt: &mut ProofAttempt,
     ) -> Result<Option<TacticResult>> {
         let start = Instant::now();
-        let mut tactics = tactics_for_tier(AutomationTier::Automation);
 
-        // Add goal-specific tactics
-        for tactic in tactics_for_goal(goal) {
-            if !tactics.contains(&tactic) {
-                tactics.push(tactic);
-            }
-        }
-
-        // Limit tactics
-        tactics.truncate(self.config.max_tactics_per_tier);
-
-        for tactic in tactics {
+        for tactic in self.automation_tactics(goal) {
+            let tactic = tactic.as_str();
             // Check timeout
             if start.elapsed().as_millis() as u64 > self.config.automation_timeout_ms {
                 break;
@@ -328,6 +487,47 @@ impl ProofAutomation {
         Ok(best_progress)
     }
 
+    /// Decidable tactics followed by learned ones for `domain`, capped at the
+    /// tier budget.
+    fn decidable_tactics(&self, domain: SpecDomain) -> Vec<String> {
+        let mut tactics: Vec<String> = tactics_for_tier(AutomationTier::Decidable)
+            .into_iter()
+            .map(String::from)
+            .collect();
+
+        // Add learned tactics from strategies
+        if let Some(strategies) = self.strategies.get(&domain) {
+            for strategy in strategies {
+                for tactic in &strategy.preferred_tactics {
+                    if !tactics.contains(tactic) {
+                        tactics.push(tactic.clone());
+                    }
+                }
+            }
+        }
+
+        // Limit tactics
+        tactics.truncate(self.config.max_tactics_per_tier);
+        tactics
+    }
+
+    /// Automation tactics followed by goal-specific ones, capped at the tier
+    /// budget.
+    fn automation_tactics(&self, goal: &Goal) -> Vec<String> {
+        let mut tactics = tactics_for_tier(AutomationTier::Automation);
+
+        // Add goal-specific tactics
+        for tactic in tactics_for_goal(goal) {
+            if !tactics.contains(&tactic) {
+                tactics.push(tactic);
+            }
+        }
+
+        // Limit tactics
+        tactics.truncate(self.config.max_tactics_per_tier);
+        tactics.into_iter().map(String::from).collect()
+    }
+
     /// Mark a goal for human intervention (Tier 4).
     fn mark_for_human(&self, goal: &Goal) -> String {
         sorry_placeholder(goal)
@@ -355,11 +555,20 @@ impl ProofAutomation {
         let response = repl.apply_tactic(tactic, proof_state_id);
         let elapsed_ms = start.elapsed().as_millis() as u64;
 
+        Ok(Self::tactic_result(tactic, response, elapsed_ms))
+    }
+
+    /// Convert a REPL reply to a tactic into a [`TacticResult`].
+    fn tactic_result(
+        tactic: &str,
+        response: Result<LeanResponse>,
+        elapsed_ms: u64,
+    ) -> TacticResult {
         match response {
             Ok(resp) => {
                 if resp.has_errors() {
                     let error = resp.format_errors();
-                    Ok(TacticResult::failure(tactic, error, elapsed_ms))
+                    TacticResult::failure(tactic, error, elapsed_ms)
                 } else {
                     // Parse the remaining goals
                     let new_goals: Vec<Goal> = resp
@@ -367,10 +576,10 @@ impl ProofAutomation {
                         .map(|goals| goals.into_iter().map(Goal::from_string).collect())
                         .unwrap_or_default();
 
-                    Ok(TacticResult::success(tactic, new_goals, elapsed_ms))
+                    TacticResult::success(tactic, new_goals, elapsed_ms)
                 }
             }
-            Err(e) => Ok(TacticResult::failure(tactic, e.to_string(), elapsed_ms)),
+            Err(e) => TacticResult::failure(tactic, e.to_string(), elapsed_ms),
         }
     }
 
@@ -409,6 +618,11 @@ impl ProofAutomation {
         &self.stats
     }
 
+    /// Tactic outcomes memoized by [`Self::prove_pooled`].
+    pub fn tactic_cache(&self) -> &TacticCache {
+        &self.tactic_cache
+    }
+
     /// Get strategies for a domain.
     pub fn strategies_for_domain(&self, domain: SpecDomain) -> Option<&Vec<ProofStrategy>> {
         self.strategies.get(&domain)
@@ -542,6 +756,74 @@ impl ProofAutomation {
     }
 }
 
+/// Work shared by the `prove_pooled` workers of one tier.
+struct PooledWork<'a> {
+    cache: &'a TacticCache,
+    pool: &'a LeanReplPool,
+    theorem: &'a str,
+    candidates: &'a [String],
+    keys: &'a [TacticCacheKey],
+    /// Candidate indices not answered by the cache, in priority order.
+    pending: &'a [usize],
+    /// Next position in `pending` to claim.
+    next: &'a AtomicUsize,
+    /// Set once any worker closes the goal.
+    solved: &'a AtomicBool,
+    start: Instant,
+    timeout_ms: u64,
+}
+
+impl PooledWork<'_> {
+    /// Claim pending candidates one at a time on a pooled REPL until the
+    /// queue drains, the goal is closed, or the tier times out.
+    fn run_worker(&self) -> Result<Vec<(usize, TacticResult)>> {
+        let mut repl = self.pool.acquire()?;
+        let outcome = self.run_on(&mut repl);
+        self.pool.release(repl);
+        outcome
+    }
+
+    fn run_on(&self, repl: &mut LeanRepl) -> Result<Vec<(usize, TacticResult)>> {
+        let proof_state_id = repl
+            .start_proof(self.theorem)?
+            .proof_state_id
+            .ok_or_else(|| {
+                Error::repl_execution(format!(
+                    "Lean returned no proof state for `{}`",
+                    self.theorem
+                ))
+            })?;
+
+        let mut results = Vec::new();
+        while !self.solved.load(Ordering::Relaxed)
+            && self.start.elapsed().as_millis() as u64 <= self.timeout_ms
+        {
+            let Some(&i) = self.pending.get(self.next.fetch_add(1, Ordering::Relaxed)) else {
+                break;
+            };
+            let tactic = self.candidates[i].as_str();
+
+            let started = Instant::now();
+            let response = repl.apply_tactic(tactic, proof_state_id);
+            // Only cache answers from Lean; transport errors may not recur.
+            let definitive = response.is_ok();
+            let result = ProofAutomation::tactic_result(
+                tactic,
+                response,
+                started.elapsed().as_millis() as u64,
+            );
+            if definitive {
+                self.cache.put(self.keys[i].clone(), result.clone());
+            }
+            if result.is_complete() {
+                self.solved.store(true, Ordering::Relaxed);
+            }
+            results.push((i, result));
+        }
+        Ok(results)
+    }
+}
+
 /// Builder for ProofAutomation with fluent API.
 pub struct ProofAutomationBuilder {
     config: ProofAutomationConfig,
@@ -593,6 +875,12 @@ impl ProofAutomationBuilder {
         self
     }
 
+    /// Set how many tactic outcomes `prove_pooled` memoizes.
+    pub fn tactic_cache_entries(mut self, entries: usize) -> Self {
+        self.config.tactic_cache_entries = entries;
+        self
+    }
+
     /// Set the memory store for learning.
     pub fn with_memory(mut self, memory: SqliteMemoryStore) -> Self {
         self.memory = Some(memory);
@@ -617,6 +905,8 @@ impl Default for ProofAutomationBuilder {
 #[cfg(test)]
 mod tests {
     use super::*;
+    use crate::lean::repl::LeanReplConfig;
+    use std::path::PathBuf;
 
     #[test]
     fn test_config_default() {
@@ -739,4 +1029,81 @@ mod tests {
         assert!(!context.similar_proofs.is_empty());
         assert!(!context.available_lemmas.is_empty());
     }
+
+    fn unreachable_pool() -> LeanReplPool {
+        let config = LeanReplConfig {
+            repl_path: Some(PathBuf::from("/nonexistent/lean-repl")),
+            ..LeanReplConfig::default()
+        };
+        LeanReplPool::new(config, 2)
+    }
+
+    #[test]
+    fn test_pooled_candidates_expand_variations_without_duplicates() {
+        let automation = ProofAutomation::new(ProofAutomationConfig::default());
+        let goal = Goal::from_string("x + 0 = x");
+        let attempt = ProofAttempt::new(goal.clone());
+
+        let candidates = automation.pooled_candidates(AutomationTier::Decidable, &goal, &attempt);
+        let unique: HashSet<_> = candidates.iter().collect();
+        assert_eq!(unique.len(), candidates.len());
+        for tactic in automation.decidable_tactics(attempt.domain) {
+            assert!(candidates.contains(&tactic));
+        }
+    }
+
+    #[test]
+    fn test_prove_pooled_serves_cached_outcomes_without_repl() {
+        let mut automation = ProofAutomationBuilder::new().enable_ai(false).build();
+        let pool = unreachable_pool();
+        let theorem = "theorem t : 1 + 1 = 2";
+        let goal = Goal::from_string("1 + 1 = 2");
+        let attempt = ProofAttempt::new(goal.clone());
+
+        // Only the first two decidable candidates are known: one fails, the
+        // next closes the goal, so nothing needs a REPL.
+        let candidates = automation.pooled_candidates(AutomationTier::Decidable, &goal, &attempt);
+        let env = pool.config().env_key();
+        automation.tactic_cache().put(
+            TacticCacheKey::new(env.as_str(), theorem, &candidates[0]),
+            TacticResult::failure(candidates[0].as_str(), "no progress", 3),
+        );
+        automation.tactic_cache().put(
+            TacticCacheKey::new(env.as_str(), theorem, &candidates[1]),
+            TacticResult::success(candidates[1].as_str(), vec![], 5),
+        );
+
+        let result = automation.prove_pooled(&pool, theorem, &goal).unwrap();
+        assert!(result.success);
+        assert_eq!(result.tier, AutomationTier::Decidable);
+        assert_eq!(result.tactics_tried.len(), 2);
+        assert_eq!(result.tactics_tried[1].tactic, candidates[1]);
+        assert_eq!(automation.tactic_cache().stats().hits, 2);
+    }
+
+    #[test]
+    fn test_prove_pooled_surfaces_spawn_errors_on_cache_miss() {
+        let mut automation = ProofAutomationBuilder::new().enable_ai(false).build();
+        let goal = Goal::from_string("1 + 1 = 2");
+        let result = automation.prove_pooled(&unreachable_pool(), "theorem t : 1 + 1 = 2", &goal);
+        assert!(result.is_err());
+        assert_eq!(automation.tactic_cache().stats().entries, 0);
+    }
+
+    #[test]
+    #[ignore = "requires Lean REPL installed"]
+    fn test_prove_pooled_caches_across_attempts() {
+        let mut automation = ProofAutomationBuilder::new().enable_ai(false).build();
+        let pool = LeanReplPool::new(LeanReplConfig::default(), 4);
+        let theorem = "theorem t (x : Nat) : x + 0 = x";
+        let goal = Goal::from_string("x + 0 = x").with_hypothesis("x", "Nat");
+
+        let first = automation.prove_pooled(&pool, theorem, &goal).unwrap();
+        assert!(first.success);
+        let misses = automation.tactic_cache().stats().misses;
+
+        let second = automation.prove_pooled(&pool, theorem, &goal).unwrap();
+        assert!(second.success);
+        assert_eq!(automation.tactic_cache().stats().misses, misses);
+    }
 }
@@ -39,8 +39,27 @@
 //! - **Types** (`types.rs`): Core data structures for proof attempts and strategies
 //! - **Tactics** (`tactics.rs`): Tactic constants and selection functions
 //! - **Engine** (`engine.rs`): Main proof automation orchestration
+//! - **Cache** (`cache.rs`): Tactic outcomes keyed by (environment, goal, tactic)
 //! - **AI Assistant** (`ai_assistant.rs`): LLM-powered tactic suggestion
 //!
+//! ## Parallel Search
+//!
+//! [`ProofAutomation::prove_pooled`] fans each tier's candidates out across a
+//! [`LeanReplPool`](crate::lean::LeanReplPool). Pool processes can start from
+//! a pickled environment so imports are elaborated once:
+//!
+//! ```rust,ignore
+//! let config = LeanReplConfig::with_project("/path/to/project")
+//!     .with_env_pickle("/path/to/project/.rlm/env.olean");
+//! let pool = LeanReplPool::new(config, 4);
+//! pool.warm(4)?;
+//!
+//! let result = automation.prove_pooled(&pool, "theorem t (x : Nat) : x + 0 = x", &goal)?;
+//! ```
+//!
+//! Outcomes are memoized in the engine's [`TacticCache`], so re-proving a
+//! goal skips tactics whose outcome in that environment is already known.
+//!
 //! ## Domain-Specific Strategies
 //!
 //! The system recognizes different proof domains and applies appropriate tactics:
@@ -63,6 +82,7 @@
 //! ```
 
 pub mod ai_assistant;
+pub mod cache;
 pub mod engine;
 pub mod session;
 pub mod tactics;
@@ -70,6 +90,7 @@ pub mod types;
 
 // Re-export main types
 pub use ai_assistant::{AIAssistantConfig, AIProofAssistant};
+pub use cache::{TacticCache, TacticCacheKey, TacticCacheStats};
 pub use engine::{ProofAutomation, ProofAutomationBuilder, ProofAutomationConfig};
 pub use session::{
     select_target, HelperLemma, HelperProofStatus, LimitReason, ProofSession, ProofSessionStatus,
@@ -84,7 +84,7 @@ mod visualize;
 
 // Re-export main types
 pub use query::{compare_traces, DecisionPath, TraceAnalyzer, TraceComparison, TraceQuery};
-pub use store::{ReasoningTraceStore, TraceStoreStats};
+pub use store::{ReasoningTraceStore, TraceSaveResult, TraceStoreStats};
 pub use trace::{DecisionTree, ReasoningTrace, TraceStats};
 pub use types::{
     DecisionNode, DecisionNodeId, DecisionNodeType, DecisionPoint, OptionStatus, TraceEdge,
@@ -2,16 +2,136 @@
 //!
 //! Stores reasoning traces as subgraphs within the existing memory hypergraph,
 //! enabling provenance tracking and cross-trace queries.
+//!
+//! Alongside the hypergraph, a small set of trace index tables records each
+//! trace's session, commit and timestamps in their own indexed columns, plus
+//! the mapping from decision node ids to memory node ids. Lookups by session
+//! or commit are index seeks, and saving a trace again only writes the
+//! decisions and edges added since the previous save.
 
 use crate::error::{Error, Result};
-use crate::memory::{
-    EdgeType, HyperEdge, Node, NodeId, NodeQuery, NodeType, SqliteMemoryStore, Tier,
-};
+use crate::memory::{EdgeId, EdgeType, HyperEdge, Node, NodeId, NodeType, SqliteMemoryStore, Tier};
 use crate::reasoning::trace::ReasoningTrace;
 use crate::reasoning::types::*;
-use chrono::Utc;
-use serde_json::{json, Value};
-use std::collections::HashMap;
+use chrono::{DateTime, Utc};
+use rusqlite::{params, Connection, OptionalExtension};
+use serde_json::Value;
+use std::collections::{HashMap, HashSet};
+use std::sync::atomic::{AtomicBool, Ordering};
+
+/// Trace index tables.
+///
+/// `reasoning_trace_nodes` and `reasoning_trace_edges` key on decision ids so
+/// an append can tell which parts of a trace are already stored; the `seq`
+/// columns preserve the order of `ReasoningTrace::nodes` and `edges`. Memory
+/// node and edge ids use the 16-byte encoding of the memory tables.
+const TRACE_INDEX_SCHEMA: &str = "
+    CREATE TABLE IF NOT EXISTS reasoning_traces (
+        trace_id TEXT PRIMARY KEY,
+        session_id TEXT NOT NULL,
+        git_commit TEXT,
+        git_branch TEXT,
+        root_goal TEXT NOT NULL,
+        root_node_id BLOB NOT NULL,
+        root_edge_id BLOB,
+        created_at TEXT NOT NULL,
+        updated_at TEXT NOT NULL,
+        node_count INTEGER NOT NULL DEFAULT 0,
+        edge_count INTEGER NOT NULL DEFAULT 0,
+        metadata TEXT
+    );
+    CREATE INDEX IF NOT EXISTS idx_reasoning_traces_session
+        ON reasoning_traces(session_id, created_at);
+    CREATE INDEX IF NOT EXISTS idx_reasoning_traces_commit
+        ON reasoning_traces(git_commit, created_at) WHERE git_commit IS NOT NULL;
+    CREATE INDEX IF NOT EXISTS idx_reasoning_traces_root
+        ON reasoning_traces(root_node_id);
+
+    CREATE TABLE IF NOT EXISTS reasoning_trace_nodes (
+        trace_id TEXT NOT NULL,
+        decision_node_id TEXT NOT NULL,
+        node_id BLOB NOT NULL,
+        seq INTEGER NOT NULL,
+        PRIMARY KEY (trace_id, decision_node_id)
+    ) WITHOUT ROWID;
+    CREATE INDEX IF NOT EXISTS idx_reasoning_trace_nodes_seq
+        ON reasoning_trace_nodes(trace_id, seq, node_id);
+
+    CREATE TABLE IF NOT EXISTS reasoning_trace_edges (
+        trace_id TEXT NOT NULL,
+        from_decision TEXT NOT NULL,
+        to_decision TEXT NOT NULL,
+        edge_id BLOB NOT NULL,
+        label TEXT NOT NULL,
+        weight REAL NOT NULL,
+        seq INTEGER NOT NULL,
+        PRIMARY KEY (trace_id, from_decision, to_decision)
+    ) WITHOUT ROWID;
+";
+
+/// True when the hypergraph holds trace roots the index does not know about,
+/// i.e. traces written before the index tables existed.
+const PENDING_BACKFILL: &str = "
+    SELECT EXISTS (
+        SELECT 1 FROM nodes n
+        WHERE n.node_type = 3 AND n.subtype = 'trace_root'
+          AND json_extract(n.metadata, '$.trace_id') IS NOT NULL
+          AND NOT EXISTS (SELECT 1 FROM reasoning_traces t WHERE t.root_node_id = n.id)
+    )";
+
+/// Index traces written before the index tables existed from the metadata
+/// their nodes and hyperedges carry. Runs once per store when needed.
+///
+/// Type codes are those of [`NodeType::Decision`] (3) and
+/// [`EdgeType::Reasoning`] (5) in the memory schema.
+const BACKFILL_INDEX: &str = "
+    INSERT OR IGNORE INTO reasoning_traces (
+        trace_id, session_id, git_commit, git_branch, root_goal, root_node_id,
+        root_edge_id, created_at, updated_at
+    )
+    SELECT json_extract(r.metadata, '$.trace_id'),
+           COALESCE(json_extract(r.metadata, '$.session_id'), 'unknown'),
+           json_extract(r.metadata, '$.git_commit'),
+           json_extract(r.metadata, '$.git_branch'),
+           COALESCE((SELECT json_extract(g.metadata, '$.decision_node_id') FROM nodes g
+                     WHERE g.id = unhex(replace(json_extract(r.metadata, '$.root_goal_id'), '-', ''))), ''),
+           r.id,
+           (SELECT m.hyperedge_id FROM membership m
+            JOIN hyperedges e ON e.id = m.hyperedge_id
+            WHERE m.node_id = r.id AND e.label = 'trace_root' LIMIT 1),
+           COALESCE(json_extract(r.metadata, '$.created_at'), r.created_at),
+           r.updated_at
+    FROM nodes r
+    WHERE r.node_type = 3 AND r.subtype = 'trace_root'
+      AND json_extract(r.metadata, '$.trace_id') IS NOT NULL;
+
+    INSERT OR IGNORE INTO reasoning_trace_nodes (trace_id, decision_node_id, node_id, seq)
+    SELECT t.trace_id, json_extract(n.metadata, '$.decision_node_id'), n.id, n.rowid
+    FROM nodes n
+    JOIN reasoning_traces t ON t.trace_id = json_extract(n.metadata, '$.trace_id')
+    WHERE n.node_type = 3 AND COALESCE(n.subtype, '') != 'trace_root'
+      AND json_extract(n.metadata, '$.decision_node_id') IS NOT NULL;
+
+    INSERT OR IGNORE INTO reasoning_trace_edges (
+        trace_id, from_decision, to_decision, edge_id, label, weight, seq
+    )
+    SELECT f.trace_id, f.decision_node_id, o.decision_node_id, e.id,
+           COALESCE(json_extract(e.metadata, '$.trace_edge_label'), e.label, 'references'),
+           e.weight, e.rowid
+    FROM hyperedges e
+    JOIN membership a ON a.hyperedge_id = e.id AND a.position = 0
+    JOIN membership b ON b.hyperedge_id = e.id AND b.position = 1
+    JOIN reasoning_trace_nodes f ON f.node_id = a.node_id
+    JOIN reasoning_trace_nodes o ON o.node_id = b.node_id AND o.trace_id = f.trace_id
+    WHERE e.edge_type = 5
+      AND json_extract(e.metadata, '$.trace_id') = f.trace_id;
+
+    UPDATE reasoning_traces SET
+        node_count = (SELECT COUNT(*) FROM reasoning_trace_nodes n
+                      WHERE n.trace_id = reasoning_traces.trace_id),
+        edge_count = (SELECT COUNT(*) FROM reasoning_trace_edges e
+                      WHERE e.trace_id = reasoning_traces.trace_id);
+";
 
 /// Store for persisting and retrieving reasoning traces.
 ///
@@ -20,19 +140,21 @@ use std::collections::HashMap;
 /// become hyperedges with type `Reasoning`.
 pub struct ReasoningTraceStore {
     memory: SqliteMemoryStore,
+    index_ready: AtomicBool,
 }
 
 impl ReasoningTraceStore {
     /// Create a new trace store backed by the given memory store.
     pub fn new(memory: SqliteMemoryStore) -> Self {
-        Self { memory }
+        Self {
+            memory,
+            index_ready: AtomicBool::new(false),
+        }
     }
 
     /// Create an in-memory store for testing.
     pub fn in_memory() -> Result<Self> {
-        Ok(Self {
-            memory: SqliteMemoryStore::in_memory()?,
-        })
+        Ok(Self::new(SqliteMemoryStore::in_memory()?))
     }
 
     /// Get a reference to the underlying memory store.
@@ -40,43 +162,213 @@ impl ReasoningTraceStore {
         &self.memory
     }
 
+    /// Create the trace index tables and backfill traces saved without them.
+    fn ensure_index(&self) -> Result<()> {
+        if self.index_ready.load(Ordering::Acquire) {
+            return Ok(());
+        }
+        self.memory.with_conn(|conn| {
+            conn.execute_batch(TRACE_INDEX_SCHEMA)?;
+            let pending: bool = conn.query_row(PENDING_BACKFILL, [], |row| row.get(0))?;
+            if pending {
+                let tx = conn.unchecked_transaction()?;
+                tx.execute_batch(BACKFILL_INDEX)?;
+                tx.commit()?;
+            }
+            Ok(())
+        })?;
+        self.index_ready.store(true, Ordering::Release);
+        Ok(())
+    }
+
     // ==================== Save Operations ====================
 
     /// Save a reasoning trace to the store.
     ///
     /// Converts the trace to memory nodes and hyperedges, storing them
     /// in the hypergraph with appropriate metadata for later retrieval.
+    /// Saving a trace that is already stored appends to it; see
+    /// [`append_trace`](Self::append_trace).
     pub fn save_trace(&self, trace: &ReasoningTrace) -> Result<()> {
-        // Map from DecisionNodeId to NodeId for edge creation
-        let mut id_map: HashMap<DecisionNodeId, NodeId> = HashMap::new();
-
-        // Save all decision nodes as memory nodes
-        for decision_node in &trace.nodes {
-            let memory_node = self.decision_node_to_memory_node(decision_node, trace)?;
-            self.memory.add_node(&memory_node)?;
-            id_map.insert(decision_node.id.clone(), memory_node.id);
+        self.append_trace(trace).map(|_| ())
+    }
+
+    /// Write the parts of a trace that are not stored yet.
+    ///
+    /// Decisions and edges already saved for `trace.id` are skipped, so
+    /// calling this after every step of a growing trace writes only the new
+    /// steps. Everything is written in one transaction; on error nothing is
+    /// stored. Returns the number of nodes and edges written.
+    pub fn append_trace(&self, trace: &ReasoningTrace) -> Result<TraceSaveResult> {
+        self.save_traces(std::slice::from_ref(trace))
+    }
+
+    /// Save (or append to) many traces in a single transaction.
+    ///
+    /// Returns the combined number of nodes and edges written.
+    pub fn save_traces(&self, traces: &[ReasoningTrace]) -> Result<TraceSaveResult> {
+        for trace in traces {
+            if !trace.nodes.iter().any(|n| n.id == trace.root_goal) {
+                return Err(Error::Internal(format!(
+                    "Root goal not found in trace {}",
+                    trace.id
+                )));
+            }
         }
+        self.ensure_index()?;
+
+        self.memory.with_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            let mut result = TraceSaveResult::default();
+            for trace in traces {
+                let saved = Self::write_trace(&tx, trace)?;
+                result.nodes_written += saved.nodes_written;
+                result.edges_written += saved.edges_written;
+            }
+            tx.commit()?;
+            Ok(result)
+        })
+    }
 
-        // Save all edges as hyperedges
-        for edge in &trace.edges {
-            if let (Some(from_id), Some(to_id)) = (id_map.get(&edge.from), id_map.get(&edge.to)) {
-                let hyperedge = self.trace_edge_to_hyperedge(edge, from_id, to_id, trace)?;
-                self.memory.add_edge(&hyperedge)?;
+    /// Write one trace's unsaved nodes and edges.
+    fn write_trace(conn: &Connection, trace: &ReasoningTrace) -> rusqlite::Result<TraceSaveResult> {
+        let trace_id = trace.id.to_string();
+        let indexed = conn
+            .prepare_cached("SELECT 1 FROM reasoning_traces WHERE trace_id = ?1")?
+            .exists(params![trace_id])?;
+
+        // Memory ids of decisions already stored for this trace
+        let mut id_map: HashMap<String, NodeId> = HashMap::new();
+        let mut saved_edges: HashSet<(String, String)> = HashSet::new();
+        if indexed {
+            let mut stmt = conn.prepare_cached(
+                "SELECT decision_node_id, node_id FROM reasoning_trace_nodes WHERE trace_id = ?1",
+            )?;
+            let mut rows = stmt.query(params![trace_id])?;
+            while let Some(row) = rows.next()? {
+                if let Ok(node_id) = row.get::<_, NodeId>(1) {
+                    id_map.insert(row.get(0)?, node_id);
+                }
+            }
+
+            let mut stmt = conn.prepare_cached(
+                "SELECT from_decision, to_decision FROM reasoning_trace_edges WHERE trace_id = ?1",
+            )?;
+            let mut rows = stmt.query(params![trace_id])?;
+            while let Some(row) = rows.next()? {
+                saved_edges.insert((row.get(0)?, row.get(1)?));
             }
         }
 
-        // Save trace metadata as a special "trace root" node
-        self.save_trace_metadata(trace, &id_map)?;
+        let mut result = TraceSaveResult::default();
+
+        // Save new decision nodes as memory nodes
+        let mut map_node = conn.prepare_cached(
+            "INSERT INTO reasoning_trace_nodes (trace_id, decision_node_id, node_id, seq)
+             VALUES (?1, ?2, ?3, ?4)",
+        )?;
+        for (seq, decision_node) in trace.nodes.iter().enumerate() {
+            let decision_id = decision_node.id.to_string();
+            if id_map.contains_key(&decision_id) {
+                continue;
+            }
+            let memory_node = Self::decision_node_to_memory_node(decision_node, trace);
+            SqliteMemoryStore::insert_node(conn, &memory_node)?;
+            map_node.execute(params![trace_id, decision_id, memory_node.id, seq as i64])?;
+            id_map.insert(decision_id, memory_node.id.clone());
+            result.nodes_written += 1;
+        }
 
-        Ok(())
+        // Save new edges as hyperedges
+        let mut map_edge = conn.prepare_cached(
+            "INSERT INTO reasoning_trace_edges (
+                trace_id, from_decision, to_decision, edge_id, label, weight, seq
+            ) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7)",
+        )?;
+        for (seq, edge) in trace.edges.iter().enumerate() {
+            let key = (edge.from.to_string(), edge.to.to_string());
+            let (Some(from_id), Some(to_id)) = (id_map.get(&key.0), id_map.get(&key.1)) else {
+                continue;
+            };
+            if saved_edges.contains(&key) {
+                continue;
+            }
+            let hyperedge = Self::trace_edge_to_hyperedge(edge, from_id, to_id, trace);
+            SqliteMemoryStore::insert_edge(conn, &hyperedge)?;
+            map_edge.execute(params![
+                trace_id,
+                key.0,
+                key.1,
+                hyperedge.id,
+                edge.label.to_string(),
+                edge.weight,
+                seq as i64
+            ])?;
+            saved_edges.insert(key);
+            result.edges_written += 1;
+        }
+
+        let metadata = trace
+            .metadata
+            .as_ref()
+            .map(|m| serde_json::to_string(m).unwrap_or_default());
+
+        if indexed {
+            conn.prepare_cached(
+                "UPDATE reasoning_traces SET
+                    git_commit = ?2, git_branch = ?3, updated_at = ?4, metadata = ?5,
+                    node_count = node_count + ?6, edge_count = edge_count + ?7
+                 WHERE trace_id = ?1",
+            )?
+            .execute(params![
+                trace_id,
+                trace.git_commit,
+                trace.git_branch,
+                trace.updated_at.to_rfc3339(),
+                metadata,
+                result.nodes_written as i64,
+                result.edges_written as i64,
+            ])?;
+        } else if let Some(root_memory_id) = id_map.get(&trace.root_goal.to_string()) {
+            // Save a "trace root" node linked to the actual root goal so the
+            // trace stays reachable from the hypergraph itself.
+            let trace_root = Self::trace_root_node(trace, root_memory_id);
+            SqliteMemoryStore::insert_node(conn, &trace_root)?;
+            let link = HyperEdge::binary(
+                EdgeType::Structural,
+                trace_root.id.clone(),
+                root_memory_id.clone(),
+                "trace_root",
+            );
+            SqliteMemoryStore::insert_edge(conn, &link)?;
+
+            conn.prepare_cached(
+                "INSERT INTO reasoning_traces (
+                    trace_id, session_id, git_commit, git_branch, root_goal, root_node_id,
+                    root_edge_id, created_at, updated_at, node_count, edge_count, metadata
+                ) VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10, ?11, ?12)",
+            )?
+            .execute(params![
+                trace_id,
+                trace.session_id,
+                trace.git_commit,
+                trace.git_branch,
+                trace.root_goal.to_string(),
+                trace_root.id,
+                link.id,
+                trace.created_at.to_rfc3339(),
+                trace.updated_at.to_rfc3339(),
+                result.nodes_written as i64,
+                result.edges_written as i64,
+                metadata,
+            ])?;
+        }
+
+        Ok(result)
     }
 
     /// Convert a DecisionNode to a memory Node.
-    fn decision_node_to_memory_node(
-        &self,
-        node: &DecisionNode,
-        trace: &ReasoningTrace,
-    ) -> Result<Node> {
+    fn decision_node_to_memory_node(node: &DecisionNode, trace: &ReasoningTrace) -> Node {
         let mut memory_node = Node::new(NodeType::Decision, &node.content)
             .with_subtype(node.node_type.to_string())
             .with_tier(Tier::Session) // Traces start in session tier
@@ -111,17 +403,16 @@ impl ReasoningTraceStore {
         memory_node.created_at = node.created_at;
         memory_node.updated_at = trace.updated_at;
 
-        Ok(memory_node)
+        memory_node
     }
 
     /// Convert a TraceEdge to a HyperEdge.
     fn trace_edge_to_hyperedge(
-        &self,
         edge: &TraceEdge,
         from_id: &NodeId,
         to_id: &NodeId,
         trace: &ReasoningTrace,
-    ) -> Result<HyperEdge> {
+    ) -> HyperEdge {
         let mut hyperedge = HyperEdge::binary(
             EdgeType::Reasoning,
             from_id.clone(),
@@ -131,40 +422,30 @@ impl ReasoningTraceStore {
         .with_weight(edge.weight);
 
         // Store the edge label in metadata for reconstruction
-        let metadata = json!({
-            "trace_id": trace.id.to_string(),
-            "trace_edge_label": edge.label.to_string(),
-            "session_id": trace.session_id,
-        });
-
-        hyperedge.metadata =
-            Some(serde_json::from_value(metadata).map_err(|e| {
-                Error::Internal(format!("Failed to serialize edge metadata: {}", e))
-            })?);
-
-        Ok(hyperedge)
+        hyperedge.metadata = Some(HashMap::from([
+            ("trace_id".to_string(), Value::from(trace.id.to_string())),
+            (
+                "trace_edge_label".to_string(),
+                Value::from(edge.label.to_string()),
+            ),
+            (
+                "session_id".to_string(),
+                Value::from(trace.session_id.clone()),
+            ),
+        ]));
+
+        hyperedge
     }
 
-    /// Save trace-level metadata as a special node.
-    fn save_trace_metadata(
-        &self,
-        trace: &ReasoningTrace,
-        id_map: &HashMap<DecisionNodeId, NodeId>,
-    ) -> Result<()> {
-        let root_memory_id = id_map
-            .get(&trace.root_goal)
-            .ok_or_else(|| Error::Internal("Root goal not found in id_map".to_string()))?;
-
-        // Create a trace root node that links to the actual root goal
+    /// Build the special node that marks a trace in the hypergraph.
+    fn trace_root_node(trace: &ReasoningTrace, root_memory_id: &NodeId) -> Node {
         let trace_root = Node::new(NodeType::Decision, format!("Trace: {}", trace.id))
             .with_subtype("trace_root")
             .with_tier(Tier::Session)
             .with_metadata("trace_id", trace.id.to_string())
             .with_metadata("root_goal_id", root_memory_id.to_string())
             .with_metadata("session_id", trace.session_id.clone())
-            .with_metadata("created_at", trace.created_at.to_rfc3339())
-            .with_metadata("node_count", trace.nodes.len() as i64)
-            .with_metadata("edge_count", trace.edges.len() as i64);
+            .with_metadata("created_at", trace.created_at.to_rfc3339());
 
         let trace_root = if let Some(ref commit) = trace.git_commit {
             trace_root.with_metadata("git_commit", commit.clone())
@@ -172,165 +453,120 @@ impl ReasoningTraceStore {
             trace_root
         };
 
-        let trace_root = if let Some(ref branch) = trace.git_branch {
+        if let Some(ref branch) = trace.git_branch {
             trace_root.with_metadata("git_branch", branch.clone())
         } else {
             trace_root
-        };
-
-        self.memory.add_node(&trace_root)?;
-
-        // Link trace root to actual root goal
-        let link = HyperEdge::binary(
-            EdgeType::Structural,
-            trace_root.id,
-            root_memory_id.clone(),
-            "trace_root",
-        );
-        self.memory.add_edge(&link)?;
-
-        Ok(())
+        }
     }
 
     // ==================== Load Operations ====================
 
     /// Load a reasoning trace by its ID.
     pub fn load_trace(&self, trace_id: &TraceId) -> Result<Option<ReasoningTrace>> {
-        // Find the trace root node
-        let trace_root = self.find_trace_root(trace_id)?;
-        let trace_root = match trace_root {
-            Some(node) => node,
-            None => return Ok(None),
+        self.ensure_index()?;
+        let id = trace_id.to_string();
+
+        let loaded = self.memory.with_read_conn(|conn| {
+            let Some(row) = conn
+                .prepare_cached(
+                    "SELECT session_id, git_commit, git_branch, root_goal, created_at,
+                            updated_at, metadata
+                     FROM reasoning_traces WHERE trace_id = ?1",
+                )?
+                .query_row(params![id], |row| {
+                    Ok(TraceRow {
+                        session_id: row.get(0)?,
+                        git_commit: row.get(1)?,
+                        git_branch: row.get(2)?,
+                        root_goal: row.get(3)?,
+                        created_at: row.get(4)?,
+                        updated_at: row.get(5)?,
+                        metadata: row.get(6)?,
+                    })
+                })
+                .optional()?
+            else {
+                return Ok(None);
+            };
+
+            let node_ids: Vec<NodeId> = conn
+                .prepare_cached(
+                    "SELECT node_id FROM reasoning_trace_nodes WHERE trace_id = ?1 ORDER BY seq",
+                )?
+                .query_map(params![id], |row| row.get::<_, NodeId>(0))?
+                .filter_map(|r| r.ok())
+                .collect();
+
+            let edges: Vec<(String, String, String, f64)> = conn
+                .prepare_cached(
+                    "SELECT from_decision, to_decision, label, weight
+                     FROM reasoning_trace_edges WHERE trace_id = ?1 ORDER BY seq",
+                )?
+                .query_map(params![id], |row| {
+                    Ok((row.get(0)?, row.get(1)?, row.get(2)?, row.get(3)?))
+                })?
+                .collect::<rusqlite::Result<_>>()?;
+
+            Ok(Some((row, node_ids, edges)))
+        })?;
+        let Some((row, node_ids, edge_rows)) = loaded else {
+            return Ok(None);
         };
 
-        // Get session_id from trace root
-        let session_id = trace_root
-            .metadata
-            .as_ref()
-            .and_then(|m| m.get("session_id"))
-            .and_then(|v| v.as_str())
-            .unwrap_or("unknown")
-            .to_string();
-
-        // Find all nodes belonging to this trace
-        let memory_nodes = self.find_trace_nodes(trace_id)?;
+        // Convert memory nodes back to decision nodes
+        let memory_nodes = self.memory.get_nodes(&node_ids)?;
         if memory_nodes.is_empty() {
             return Ok(None);
         }
-
-        // Find root goal node (first goal node, or use trace root reference)
-        let root_memory_id = trace_root
-            .metadata
-            .as_ref()
-            .and_then(|m| m.get("root_goal_id"))
-            .and_then(|v| v.as_str())
-            .and_then(|s| NodeId::parse(s).ok());
-
-        // Convert memory nodes back to decision nodes
-        let mut decision_nodes = Vec::new();
-        let mut memory_to_decision: HashMap<NodeId, DecisionNodeId> = HashMap::new();
-
-        for memory_node in &memory_nodes {
-            let decision_node = self.memory_node_to_decision_node(memory_node)?;
-            memory_to_decision.insert(memory_node.id.clone(), decision_node.id.clone());
-            decision_nodes.push(decision_node);
-        }
+        let decision_nodes: Vec<DecisionNode> = memory_nodes
+            .iter()
+            .map(Self::memory_node_to_decision_node)
+            .collect();
+        let present: HashSet<String> = decision_nodes.iter().map(|n| n.id.to_string()).collect();
 
         // Determine root goal
-        let root_goal = root_memory_id
-            .and_then(|id| memory_to_decision.get(&id).cloned())
+        let root_goal = DecisionNodeId::parse(&row.root_goal)
+            .ok()
+            .filter(|id| present.contains(&id.to_string()))
             .or_else(|| {
                 decision_nodes
                     .iter()
                     .find(|n| n.node_type == DecisionNodeType::Goal)
                     .map(|n| n.id.clone())
             })
-            .unwrap_or_else(|| {
-                decision_nodes
-                    .first()
-                    .map(|n| n.id.clone())
-                    .unwrap_or_default()
-            });
+            .unwrap_or_else(|| decision_nodes[0].id.clone());
 
-        // Load edges
-        let edges = self.load_trace_edges(trace_id, &memory_to_decision)?;
-
-        // Extract git info from trace root
-        let git_commit = trace_root
-            .metadata
-            .as_ref()
-            .and_then(|m| m.get("git_commit"))
-            .and_then(|v| v.as_str())
-            .map(String::from);
-
-        let git_branch = trace_root
-            .metadata
-            .as_ref()
-            .and_then(|m| m.get("git_branch"))
-            .and_then(|v| v.as_str())
-            .map(String::from);
-
-        // Get created_at from trace root
-        let created_at = trace_root
-            .metadata
-            .as_ref()
-            .and_then(|m| m.get("created_at"))
-            .and_then(|v| v.as_str())
-            .and_then(|s| chrono::DateTime::parse_from_rfc3339(s).ok())
-            .map(|dt| dt.with_timezone(&Utc))
-            .unwrap_or_else(|| trace_root.created_at);
+        // Load edges whose endpoints are both still present
+        let edges = edge_rows
+            .into_iter()
+            .filter(|(from, to, _, _)| present.contains(from) && present.contains(to))
+            .filter_map(|(from, to, label, weight)| {
+                let from = DecisionNodeId::parse(&from).ok()?;
+                let to = DecisionNodeId::parse(&to).ok()?;
+                Some(TraceEdge::new(from, to, parse_edge_label(&label)).with_weight(weight))
+            })
+            .collect();
 
         Ok(Some(ReasoningTrace {
             id: trace_id.clone(),
             root_goal,
-            session_id,
-            created_at,
-            updated_at: trace_root.updated_at,
+            session_id: row.session_id,
+            created_at: parse_timestamp(&row.created_at),
+            updated_at: parse_timestamp(&row.updated_at),
             nodes: decision_nodes,
             edges,
-            git_commit,
-            git_branch,
-            metadata: trace_root.metadata.clone(),
+            git_commit: row.git_commit,
+            git_branch: row.git_branch,
+            metadata: row
+                .metadata
+                .and_then(|m| serde_json::from_str(&m).ok())
+                .filter(|m: &HashMap<String, Value>| !m.is_empty()),
         }))
     }
 
-    /// Find the trace root node.
-    fn find_trace_root(&self, trace_id: &TraceId) -> Result<Option<Node>> {
-        let nodes = self
-            .memory
-            .query_nodes(&NodeQuery::new().node_types(vec![NodeType::Decision]))?;
-
-        Ok(nodes.into_iter().find(|n| {
-            n.subtype.as_deref() == Some("trace_root")
-                && n.metadata
-                    .as_ref()
-                    .and_then(|m| m.get("trace_id"))
-                    .and_then(|v| v.as_str())
-                    == Some(&trace_id.to_string())
-        }))
-    }
-
-    /// Find all nodes belonging to a trace.
-    fn find_trace_nodes(&self, trace_id: &TraceId) -> Result<Vec<Node>> {
-        let nodes = self
-            .memory
-            .query_nodes(&NodeQuery::new().node_types(vec![NodeType::Decision]))?;
-
-        Ok(nodes
-            .into_iter()
-            .filter(|n| {
-                n.subtype.as_deref() != Some("trace_root")
-                    && n.metadata
-                        .as_ref()
-                        .and_then(|m| m.get("trace_id"))
-                        .and_then(|v| v.as_str())
-                        == Some(&trace_id.to_string())
-            })
-            .collect())
-    }
-
     /// Convert a memory node back to a decision node.
-    fn memory_node_to_decision_node(&self, node: &Node) -> Result<DecisionNode> {
+    fn memory_node_to_decision_node(node: &Node) -> DecisionNode {
         // Get the decision node type from subtype
         let node_type = node
             .subtype
@@ -381,7 +617,7 @@ impl ReasoningTraceStore {
         });
         let metadata = metadata.filter(|m| !m.is_empty());
 
-        Ok(DecisionNode {
+        DecisionNode {
             id,
             node_type,
             content: node.content.clone(),
@@ -389,187 +625,111 @@ impl ReasoningTraceStore {
             confidence: node.confidence,
             created_at: node.created_at,
             metadata,
-        })
-    }
-
-    /// Load edges for a trace.
-    fn load_trace_edges(
-        &self,
-        trace_id: &TraceId,
-        memory_to_decision: &HashMap<NodeId, DecisionNodeId>,
-    ) -> Result<Vec<TraceEdge>> {
-        let mut edges = Vec::new();
-
-        // We need to find edges by querying nodes and their connected edges
-        for memory_id in memory_to_decision.keys() {
-            let hyperedges = self.memory.get_edges_for_node(memory_id)?;
-
-            for hyperedge in hyperedges {
-                // Check if this edge belongs to our trace
-                let is_trace_edge = hyperedge
-                    .metadata
-                    .as_ref()
-                    .and_then(|m| m.get("trace_id"))
-                    .and_then(|v| v.as_str())
-                    == Some(&trace_id.to_string());
-
-                if !is_trace_edge {
-                    continue;
-                }
-
-                // Get the edge label
-                let label = hyperedge
-                    .metadata
-                    .as_ref()
-                    .and_then(|m| m.get("trace_edge_label"))
-                    .and_then(|v| v.as_str())
-                    .map(|s| match s {
-                        "spawns" => TraceEdgeLabel::Spawns,
-                        "considers" => TraceEdgeLabel::Considers,
-                        "chooses" => TraceEdgeLabel::Chooses,
-                        "rejects" => TraceEdgeLabel::Rejects,
-                        "implements" => TraceEdgeLabel::Implements,
-                        "produces" => TraceEdgeLabel::Produces,
-                        "leads_to" => TraceEdgeLabel::LeadsTo,
-                        "references" => TraceEdgeLabel::References,
-                        "requires" => TraceEdgeLabel::Requires,
-                        "invalidates" => TraceEdgeLabel::Invalidates,
-                        _ => TraceEdgeLabel::References,
-                    })
-                    .unwrap_or(TraceEdgeLabel::References);
-
-                // Get from and to node IDs
-                if hyperedge.members.len() >= 2 {
-                    let from_memory = &hyperedge.members[0].node_id;
-                    let to_memory = &hyperedge.members[1].node_id;
-
-                    if let (Some(from), Some(to)) = (
-                        memory_to_decision.get(from_memory),
-                        memory_to_decision.get(to_memory),
-                    ) {
-                        // Only add if we haven't seen this edge before
-                        let edge = TraceEdge::new(from.clone(), to.clone(), label)
-                            .with_weight(hyperedge.weight);
-
-                        if !edges
-                            .iter()
-                            .any(|e: &TraceEdge| e.from == edge.from && e.to == edge.to)
-                        {
-                            edges.push(edge);
-                        }
-                    }
-                }
-            }
         }
-
-        Ok(edges)
     }
 
     // ==================== Query Operations ====================
 
-    /// List all trace IDs in the store.
+    /// List all trace IDs in the store, oldest first.
     pub fn list_traces(&self) -> Result<Vec<TraceId>> {
-        let nodes = self
-            .memory
-            .query_nodes(&NodeQuery::new().node_types(vec![NodeType::Decision]))?;
-
-        let trace_ids: Vec<TraceId> = nodes
-            .iter()
-            .filter(|n| n.subtype.as_deref() == Some("trace_root"))
-            .filter_map(|n| {
-                n.metadata
-                    .as_ref()
-                    .and_then(|m| m.get("trace_id"))
-                    .and_then(|v| v.as_str())
-                    .and_then(|s| TraceId::parse(s).ok())
-            })
-            .collect();
-
-        Ok(trace_ids)
+        self.query_trace_ids(
+            "SELECT trace_id FROM reasoning_traces ORDER BY created_at, trace_id",
+            None,
+        )
     }
 
     /// Find traces by session ID.
     pub fn find_by_session(&self, session_id: &str) -> Result<Vec<TraceId>> {
-        let nodes = self
-            .memory
-            .query_nodes(&NodeQuery::new().node_types(vec![NodeType::Decision]))?;
-
-        let trace_ids: Vec<TraceId> = nodes
-            .iter()
-            .filter(|n| n.subtype.as_deref() == Some("trace_root"))
-            .filter(|n| {
-                n.metadata
-                    .as_ref()
-                    .and_then(|m| m.get("session_id"))
-                    .and_then(|v| v.as_str())
-                    == Some(session_id)
-            })
-            .filter_map(|n| {
-                n.metadata
-                    .as_ref()
-                    .and_then(|m| m.get("trace_id"))
-                    .and_then(|v| v.as_str())
-                    .and_then(|s| TraceId::parse(s).ok())
-            })
-            .collect();
-
-        Ok(trace_ids)
+        self.query_trace_ids(
+            "SELECT trace_id FROM reasoning_traces
+             WHERE session_id = ?1 ORDER BY created_at, trace_id",
+            Some(session_id),
+        )
     }
 
     /// Find traces linked to a git commit.
     pub fn find_by_commit(&self, commit: &str) -> Result<Vec<TraceId>> {
-        let nodes = self
-            .memory
-            .query_nodes(&NodeQuery::new().node_types(vec![NodeType::Decision]))?;
-
-        let trace_ids: Vec<TraceId> = nodes
-            .iter()
-            .filter(|n| n.subtype.as_deref() == Some("trace_root"))
-            .filter(|n| {
-                n.metadata
-                    .as_ref()
-                    .and_then(|m| m.get("git_commit"))
-                    .and_then(|v| v.as_str())
-                    == Some(commit)
-            })
-            .filter_map(|n| {
-                n.metadata
-                    .as_ref()
-                    .and_then(|m| m.get("trace_id"))
-                    .and_then(|v| v.as_str())
-                    .and_then(|s| TraceId::parse(s).ok())
-            })
-            .collect();
+        self.query_trace_ids(
+            "SELECT trace_id FROM reasoning_traces
+             WHERE git_commit = ?1 ORDER BY created_at, trace_id",
+            Some(commit),
+        )
+    }
 
-        Ok(trace_ids)
+    fn query_trace_ids(&self, sql: &str, param: Option<&str>) -> Result<Vec<TraceId>> {
+        self.ensure_index()?;
+        self.memory.with_read_conn(|conn| {
+            let mut stmt = conn.prepare_cached(sql)?;
+            let rows = stmt.query_map(rusqlite::params_from_iter(param), |row| {
+                row.get::<_, String>(0)
+            })?;
+            Ok(rows
+                .filter_map(|r| r.ok())
+                .filter_map(|s| TraceId::parse(&s).ok())
+                .collect())
+        })
     }
 
     /// Delete a trace and all its nodes/edges.
     pub fn delete_trace(&self, trace_id: &TraceId) -> Result<bool> {
-        let nodes = self.find_trace_nodes(trace_id)?;
-        let trace_root = self.find_trace_root(trace_id)?;
-
-        if nodes.is_empty() && trace_root.is_none() {
-            return Ok(false);
-        }
-
-        // Delete all trace nodes
-        for node in nodes {
-            self.memory.delete_node(&node.id)?;
-        }
-
-        // Delete trace root
-        if let Some(root) = trace_root {
-            self.memory.delete_node(&root.id)?;
-        }
-
-        Ok(true)
+        self.ensure_index()?;
+        let id = trace_id.to_string();
+
+        self.memory.with_conn(|conn| {
+            let tx = conn.unchecked_transaction()?;
+            let Some((root_node_id, root_edge_id)) = tx
+                .prepare_cached(
+                    "SELECT root_node_id, root_edge_id FROM reasoning_traces WHERE trace_id = ?1",
+                )?
+                .query_row(params![id], |row| {
+                    Ok((row.get::<_, NodeId>(0)?, row.get::<_, Option<EdgeId>>(1)?))
+                })
+                .optional()?
+            else {
+                return Ok(false);
+            };
+
+            let mut node_ids: Vec<NodeId> = tx
+                .prepare_cached("SELECT node_id FROM reasoning_trace_nodes WHERE trace_id = ?1")?
+                .query_map(params![id], |row| row.get(0))?
+                .collect::<rusqlite::Result<_>>()?;
+            node_ids.push(root_node_id);
+
+            tx.execute(
+                "DELETE FROM hyperedges WHERE id IN
+                    (SELECT edge_id FROM reasoning_trace_edges WHERE trace_id = ?1)",
+                params![id],
+            )?;
+            if let Some(edge_id) = root_edge_id {
+                tx.execute("DELETE FROM hyperedges WHERE id = ?1", params![edge_id])?;
+            }
+            SqliteMemoryStore::delete_node_rows(&tx, &node_ids)?;
+            tx.execute(
+                "DELETE FROM reasoning_trace_edges WHERE trace_id = ?1",
+                params![id],
+            )?;
+            tx.execute(
+                "DELETE FROM reasoning_trace_nodes WHERE trace_id = ?1",
+                params![id],
+            )?;
+            tx.execute(
+                "DELETE FROM reasoning_traces WHERE trace_id = ?1",
+                params![id],
+            )?;
+            tx.commit()?;
+            Ok(true)
+        })
     }
 
     /// Get statistics about stored traces.
     pub fn stats(&self) -> Result<TraceStoreStats> {
+        self.ensure_index()?;
         let memory_stats = self.memory.stats()?;
-        let trace_ids = self.list_traces()?;
+        let total_traces: i64 = self.memory.with_read_conn(|conn| {
+            conn.query_row("SELECT COUNT(*) FROM reasoning_traces", [], |row| {
+                row.get(0)
+            })
+        })?;
 
         let decision_nodes = *memory_stats
             .nodes_by_type
@@ -577,7 +737,7 @@ impl ReasoningTraceStore {
             .unwrap_or(&0);
 
         Ok(TraceStoreStats {
-            total_traces: trace_ids.len(),
+            total_traces: total_traces as usize,
             total_decision_nodes: decision_nodes as usize,
             total_memory_nodes: memory_stats.total_nodes as usize,
             total_edges: memory_stats.total_edges as usize,
@@ -585,6 +745,49 @@ impl ReasoningTraceStore {
     }
 }
 
+/// Row of the `reasoning_traces` table.
+struct TraceRow {
+    session_id: String,
+    git_commit: Option<String>,
+    git_branch: Option<String>,
+    root_goal: String,
+    created_at: String,
+    updated_at: String,
+    metadata: Option<String>,
+}
+
+fn parse_edge_label(s: &str) -> TraceEdgeLabel {
+    match s {
+        "spawns" => TraceEdgeLabel::Spawns,
+        "considers" => TraceEdgeLabel::Considers,
+        "chooses" => TraceEdgeLabel::Chooses,
+        "rejects" => TraceEdgeLabel::Rejects,
+        "implements" => TraceEdgeLabel::Implements,
+        "produces" => TraceEdgeLabel::Produces,
+        "leads_to" => TraceEdgeLabel::LeadsTo,
+        "references" => TraceEdgeLabel::References,
+        "requires" => TraceEdgeLabel::Requires,
+        "invalidates" => TraceEdgeLabel::Invalidates,
+        _ => TraceEdgeLabel::References,
+    }
+}
+
+fn parse_timestamp(s: &str) -> DateTime<Utc> {
+    DateTime::parse_from_rfc3339(s)
+        .map(|dt| dt.with_timezone(&Utc))
+        .unwrap_or_else(|_| Utc::now())
+}
+
+/// Number of nodes and edges written by a save.
+#[derive(Debug, Clone, Copy, Default, PartialEq, Eq)]
+pub struct TraceSaveResult {
+    /// Decision nodes written.
+    pub nodes_written: usize,
+
+    /// Trace edges written.
+    pub edges_written: usize,
+}
+
 /// Statistics about the trace store.
 #[derive(Debug, Clone)]
 pub struct TraceStoreStats {
@@ -787,4 +990,106 @@ mod tests {
         assert_eq!(outcome_count, 1);
         assert_eq!(obs_count, 1);
     }
+
+    #[test]
+    fn test_append_writes_only_new_steps() {
+        let store = ReasoningTraceStore::in_memory().unwrap();
+
+        let mut trace = ReasoningTrace::new("Grow", "session-append");
+        let root_id = trace.root_goal.clone();
+        let first = store.append_trace(&trace).unwrap();
+        assert_eq!(first.nodes_written, 1);
+
+        let chosen = trace.log_decision(&root_id, "Pick", &["A", "B"], 0, "Simpler");
+        let second = store.append_trace(&trace).unwrap();
+        assert_eq!(second.nodes_written, trace.nodes.len() - 1);
+        assert_eq!(second.edges_written, trace.edges.len());
+
+        // Re-saving an unchanged trace writes nothing
+        assert_eq!(
+            store.append_trace(&trace).unwrap(),
+            TraceSaveResult::default()
+        );
+
+        trace.log_action(&chosen, "Do A", "Done");
+        store.save_trace(&trace).unwrap();
+
+        let loaded = store.load_trace(&trace.id).unwrap().unwrap();
+        assert_eq!(loaded.root_goal, root_id);
+        assert_eq!(loaded.nodes.len(), trace.nodes.len());
+        assert_eq!(loaded.edges.len(), trace.edges.len());
+        let ids: Vec<_> = loaded.nodes.iter().map(|n| n.id.clone()).collect();
+        let expected: Vec<_> = trace.nodes.iter().map(|n| n.id.clone()).collect();
+        assert_eq!(ids, expected);
+        assert_eq!(store.list_traces().unwrap().len(), 1);
+    }
+
+    #[test]
+    fn test_save_traces_validates_before_writing() {
+        let store = ReasoningTraceStore::in_memory().unwrap();
+
+        let good = ReasoningTrace::new("Good", "session-batch").with_git_commit("c0ffee");
+        let mut bad = ReasoningTrace::new("Bad", "session-batch");
+        bad.nodes.clear();
+        assert!(store.save_traces(&[good.clone(), bad]).is_err());
+        assert!(store.list_traces().unwrap().is_empty());
+
+        let other = ReasoningTrace::new("Other", "session-batch");
+        let saved = store.save_traces(&[good, other]).unwrap();
+        assert_eq!(saved.nodes_written, 2);
+        assert_eq!(store.find_by_session("session-batch").unwrap().len(), 2);
+        assert_eq!(store.find_by_commit("c0ffee").unwrap().len(), 1);
+    }
+
+    #[test]
+    fn test_backfills_traces_saved_without_index() {
+        // Lay out a trace the way stores without index tables did: decision
+        // nodes and a trace root identified only by their metadata.
+        let memory = SqliteMemoryStore::in_memory().unwrap();
+        let mut trace = ReasoningTrace::new("Legacy", "session-legacy").with_git_commit("abc");
+        let root_id = trace.root_goal.clone();
+        trace.log_decision(&root_id, "Choose", &["Only"], 0, "Only option");
+
+        let nodes: Vec<Node> = trace
+            .nodes
+            .iter()
+            .map(|n| ReasoningTraceStore::decision_node_to_memory_node(n, &trace))
+            .collect();
+        memory.add_nodes(&nodes).unwrap();
+        let by_decision: HashMap<_, _> = trace
+            .nodes
+            .iter()
+            .zip(&nodes)
+            .map(|(d, n)| (d.id.clone(), n.id.clone()))
+            .collect();
+        let edges: Vec<HyperEdge> = trace
+            .edges
+            .iter()
+            .map(|e| {
+                ReasoningTraceStore::trace_edge_to_hyperedge(
+                    e,
+                    &by_decision[&e.from],
+                    &by_decision[&e.to],
+                    &trace,
+                )
+            })
+            .collect();
+        memory.add_edges(&edges).unwrap();
+        let root = ReasoningTraceStore::trace_root_node(&trace, &by_decision[&root_id]);
+        memory.add_node(&root).unwrap();
+
+        let store = ReasoningTraceStore::new(memory);
+        assert_eq!(store.find_by_commit("abc").unwrap(), vec![trace.id.clone()]);
+
+        let loaded = store.load_trace(&trace.id).unwrap().unwrap();
+        assert_eq!(loaded.root_goal, root_id);
+        assert_eq!(loaded.nodes.len(), trace.nodes.len());
+        assert_eq!(loaded.edges.len(), trace.edges.len());
+
+        // Appending to a backfilled trace only writes the new step
+        let decision = trace.nodes[1].id.clone();
+        trace.log_observation(&decision, "Later");
+        let appended = store.append_trace(&trace).unwrap();
+        assert_eq!(appended.nodes_written, 1);
+    }
 }
@@ -13,15 +13,26 @@
 
 use crate::error::{Error, Result};
 use crate::llm::{BatchExecutor, BatchedLLMQuery, BatchedQueryResults, LLMClient};
+use crate::metrics::{self, Metric};
+use crate::pool::{PoolLease, PoolOptions, PoolStats, Poolable, ProcessPool};
 use crate::signature::{FieldSpec, SignatureRegistration, SubmitResult};
 use serde::{Deserialize, Serialize};
 use serde_json::Value;
 use std::collections::HashMap;
-use std::io::{BufRead, BufReader, Read, Write};
-use std::process::{Child, ChildStderr, ChildStdin, ChildStdout, Command, Stdio};
-use std::sync::{Arc, Mutex};
+use std::io::{BufRead, BufReader, Read};
+use std::process::{Child, Command, Stdio};
+use std::sync::Arc;
 use std::time::{Duration, Instant};
 
+mod channel;
+mod shm;
+#[cfg(unix)]
+mod zygote;
+
+pub use channel::PendingReply;
+use channel::RpcChannel;
+use shm::SharedMemory;
+
 const SHUTDOWN_GRACE_MS: u64 = 2_000;
 const SHUTDOWN_POLL_MS: u64 = 10;
 
@@ -151,6 +162,19 @@ pub struct ReplStatus {
     pub memory_usage_bytes: Option<u64>,
 }
 
+/// How new REPL subprocesses are started.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum ReplStartupMode {
+    /// Launch a fresh `python -m rlm_repl` interpreter per handle.
+    #[default]
+    Spawn,
+    /// Fork each handle from a shared, pre-imported fork server (Unix only).
+    ///
+    /// This replaces interpreter boot and imports with a `fork()`; the
+    /// externalized context helpers are preloaded as the `rlm_context` module.
+    ForkServer,
+}
+
 /// Configuration for the REPL subprocess.
 #[derive(Debug, Clone)]
 pub struct ReplConfig {
@@ -165,6 +189,11 @@ pub struct ReplConfig {
     pub max_memory_bytes: Option<u64>,
     /// Maximum CPU time in seconds
     pub max_cpu_seconds: Option<u64>,
+    /// How subprocesses are started
+    pub startup_mode: ReplStartupMode,
+    /// Payloads at or above this many bytes travel through a shared-memory
+    /// segment instead of the JSON-RPC pipe (0 disables)
+    pub shm_threshold_bytes: usize,
 }
 
 impl Default for ReplConfig {
@@ -175,22 +204,72 @@ impl Default for ReplConfig {
             timeout_ms: 30_000,
             max_memory_bytes: Some(512 * 1024 * 1024), // 512 MB
             max_cpu_seconds: Some(60),
+            startup_mode: ReplStartupMode::Spawn,
+            shm_threshold_bytes: 256 * 1024,
         }
     }
 }
 
+/// The process behind a [`ReplHandle`].
+enum ReplProcess {
+    Child(Child),
+    #[cfg(unix)]
+    Forked(zygote::ForkedRepl),
+}
+
 /// Handle to a running REPL subprocess.
+///
+/// Requests are pipelined: the `submit_*` methods return a [`PendingReply`]
+/// immediately, so several calls can be in flight on one handle. The blocking
+/// methods are `submit_*` followed by [`PendingReply::wait`].
 pub struct ReplHandle {
-    child: Child,
-    stdin: ChildStdin,
-    stdout: BufReader<ChildStdout>,
-    next_id: u64,
+    process: ReplProcess,
+    channel: RpcChannel,
+    shm: Option<Arc<SharedMemory>>,
     config: ReplConfig,
+    lease: Option<PoolLease>,
 }
 
 impl ReplHandle {
-    /// Spawn a new REPL subprocess.
+    /// Spawn a new REPL subprocess using `config.startup_mode`.
     pub fn spawn(config: ReplConfig) -> Result<Self> {
+        let _timer = metrics::Timer::start(Metric::ReplSpawn);
+        match config.startup_mode {
+            ReplStartupMode::Spawn => Self::spawn_process(config),
+            ReplStartupMode::ForkServer => Self::spawn_forked(config),
+        }
+    }
+
+    #[cfg(unix)]
+    fn spawn_forked(config: ReplConfig) -> Result<Self> {
+        let shm = SharedMemory::create(config.shm_threshold_bytes)?.map(Arc::new);
+        let env = shm
+            .as_ref()
+            .map(|shm| shm.env().to_vec())
+            .unwrap_or_default();
+        let (forked, reader) = zygote::ForkedRepl::fork(&config, &env)?;
+        let stdin = forked
+            .stream
+            .try_clone()
+            .map_err(|e| Error::SubprocessComm(format!("Failed to clone REPL socket: {}", e)))?;
+
+        Ok(Self {
+            process: ReplProcess::Forked(forked),
+            channel: RpcChannel::new(Box::new(stdin), reader, shm.clone())?,
+            shm,
+            config,
+            lease: None,
+        })
+    }
+
+    #[cfg(not(unix))]
+    fn spawn_forked(_config: ReplConfig) -> Result<Self> {
+        Err(Error::Config(
+            "fork_server startup mode requires a Unix platform".to_string(),
+        ))
+    }
+
+    fn spawn_process(config: ReplConfig) -> Result<Self> {
         let startup_context = format!(
             "python_path='{}', entrypoint='-m rlm_repl', repl_package_path='{}'",
             config.python_path,
@@ -213,6 +292,11 @@ impl ReplHandle {
             cmd.env("PYTHONPATH", path);
         }
 
+        let shm = SharedMemory::create(config.shm_threshold_bytes)?.map(Arc::new);
+        if let Some(ref shm) = shm {
+            cmd.envs(shm.env());
+        }
+
         let mut child = cmd.spawn().map_err(|e| {
             Error::SubprocessComm(format!(
                 "Failed to spawn REPL subprocess ({startup_context}): {e}"
@@ -233,181 +317,147 @@ impl ReplHandle {
             .take()
             .ok_or_else(|| Error::SubprocessComm("Failed to get stderr handle".to_string()))?;
 
-        let mut stdout = BufReader::new(stdout);
+        let mut stdout = BufReader::new(Box::new(stdout) as Box<dyn Read + Send>);
 
         // Wait for ready message
-        if let Err(err) =
-            Self::wait_for_ready(&mut child, &mut stdout, &mut stderr, &startup_context)
-        {
-            // Ensure we do not leak a subprocess when startup fails.
-            let _ = child.kill();
-            let _ = child.wait();
-            return Err(err);
-        }
-
-        Ok(Self {
-            child,
-            stdin,
-            stdout,
-            next_id: 1,
-            config,
-        })
-    }
-
-    fn wait_for_ready(
-        child: &mut Child,
-        stdout: &mut BufReader<ChildStdout>,
-        stderr: &mut ChildStderr,
-        startup_context: &str,
-    ) -> Result<()> {
-        let mut line = String::new();
-        let read_bytes = stdout.read_line(&mut line).map_err(|e| {
-            Error::SubprocessComm(format!(
-                "Failed to read ready message ({startup_context}): {e}"
-            ))
-        })?;
-
-        if read_bytes == 0 {
+        let ready = read_ready(&mut stdout, &startup_context, || {
             let mut stderr_output = String::new();
             if matches!(child.try_wait(), Ok(Some(_))) {
                 let _ = stderr.read_to_string(&mut stderr_output);
             }
+            stderr_output
+        });
+        let channel = ready.and_then(|()| RpcChannel::new(Box::new(stdin), stdout, shm.clone()));
+        let channel = match channel {
+            Ok(channel) => channel,
+            Err(err) => {
+                // Ensure we do not leak a subprocess when startup fails.
+                let _ = child.kill();
+                let _ = child.wait();
+                return Err(err);
+            }
+        };
 
-            let stderr_output = stderr_output.trim();
-            let stderr_excerpt: String = stderr_output.chars().take(500).collect();
-            let truncated = stderr_output.chars().count() > 500;
-            let stderr_detail = if stderr_excerpt.is_empty() {
-                String::new()
-            } else if truncated {
-                format!("; stderr: {stderr_excerpt}...")
-            } else {
-                format!("; stderr: {stderr_excerpt}")
-            };
-
-            return Err(Error::SubprocessComm(
-                format!(
-                    "REPL subprocess exited before sending ready message ({startup_context}){stderr_detail}"
-                ),
-            ));
-        }
-
-        let msg: Value = serde_json::from_str(&line).map_err(|e| {
-            Error::SubprocessComm(format!(
-                "Invalid ready message ({startup_context}): {e}; payload={}",
-                line.trim()
-            ))
-        })?;
-
-        if msg.get("method") != Some(&Value::String("ready".to_string())) {
-            return Err(Error::SubprocessComm(format!(
-                "Expected ready message ({startup_context}), got: {}",
-                line.trim()
-            )));
-        }
+        Ok(Self {
+            process: ReplProcess::Child(child),
+            channel,
+            shm,
+            config,
+            lease: None,
+        })
+    }
 
-        Ok(())
+    fn submit<T>(
+        &self,
+        method: &str,
+        params: Value,
+        decode: fn(Value) -> Result<T>,
+    ) -> Result<PendingReply<T>> {
+        self.channel
+            .submit(method, params, self.config.timeout_ms, decode)
     }
 
     fn send_request(&mut self, method: &str, params: Value) -> Result<Value> {
-        let id = self.next_id;
-        self.next_id += 1;
-
-        let request = JsonRpcRequest::new(method, params, id);
-        let request_json = serde_json::to_string(&request)?;
-
-        // Send request
-        writeln!(self.stdin, "{}", request_json)
-            .map_err(|e| Error::SubprocessComm(format!("Failed to send request: {}", e)))?;
-        self.stdin
-            .flush()
-            .map_err(|e| Error::SubprocessComm(format!("Failed to flush stdin: {}", e)))?;
-
-        // Read response with timeout
-        let start = Instant::now();
-        let timeout = Duration::from_millis(self.config.timeout_ms);
-
-        loop {
-            let mut line = String::new();
-
-            // Check timeout
-            if start.elapsed() > timeout {
-                return Err(Error::timeout(self.config.timeout_ms));
-            }
+        self.submit(method, params, Ok)?.wait()
+    }
 
-            // Try to read a line
-            match self.stdout.read_line(&mut line) {
-                Ok(0) => {
-                    return Err(Error::SubprocessComm(
-                        "REPL subprocess closed unexpectedly".to_string(),
-                    ));
-                }
-                Ok(_) => {
-                    let response: JsonRpcResponse = serde_json::from_str(&line)?;
-
-                    // Check if this is our response
-                    if response.id == Some(id) {
-                        if let Some(error) = response.error {
-                            return Err(Error::repl_execution(format!(
-                                "{}: {}",
-                                error.code, error.message
-                            )));
-                        }
-                        return Ok(response.result.unwrap_or(Value::Null));
-                    }
-                    // Otherwise it's a notification or response for a different request
-                    // In a more sophisticated implementation, we'd handle these
-                }
-                Err(e) if e.kind() == std::io::ErrorKind::WouldBlock => {
-                    std::thread::sleep(Duration::from_millis(10));
-                    continue;
-                }
-                Err(e) => {
-                    return Err(Error::SubprocessComm(format!(
-                        "Failed to read response: {}",
-                        e
-                    )));
-                }
-            }
+    /// Move `value` to shared memory if it is over the configured threshold.
+    fn offload(&self, value: Value) -> Result<Value> {
+        match self.shm {
+            Some(ref shm) => shm.offload(value),
+            None => Ok(value),
         }
     }
 
-    /// Execute Python code in the REPL.
-    pub fn execute(&mut self, code: &str) -> Result<ExecuteResult> {
+    /// Start executing Python code without waiting for the result.
+    pub fn submit_execute(&self, code: &str) -> Result<PendingReply<ExecuteResult>> {
+        let code = self.offload(Value::String(code.to_string()))?;
         let params = serde_json::json!({
             "code": code,
             "timeout_ms": self.config.timeout_ms,
             "capture_output": true,
         });
+        self.submit("execute", params, |v| Ok(serde_json::from_value(v)?))
+    }
+
+    /// Request a variable without waiting for the value.
+    pub fn submit_get_variable(&self, name: &str) -> Result<PendingReply<Value>> {
+        self.submit("get_variable", serde_json::json!({ "name": name }), Ok)
+    }
+
+    /// Set a variable without waiting for the acknowledgement.
+    pub fn submit_set_variable(&self, name: &str, value: Value) -> Result<PendingReply<()>> {
+        let value = self.offload(value)?;
+        let params = serde_json::json!({
+            "name": name,
+            "value": value,
+        });
+        self.submit("set_variable", params, |_| Ok(()))
+    }
+
+    /// Resolve a deferred operation without waiting for the acknowledgement.
+    pub fn submit_resolve_operation(
+        &self,
+        operation_id: &str,
+        result: Value,
+    ) -> Result<PendingReply<()>> {
+        let result = self.offload(result)?;
+        let params = serde_json::json!({
+            "operation_id": operation_id,
+            "result": result,
+        });
+        self.submit("resolve_operation", params, |_| Ok(()))
+    }
 
-        let result = self.send_request("execute", params)?;
-        let execute_result: ExecuteResult = serde_json::from_value(result)?;
-        Ok(execute_result)
+    /// Execute Python code in the REPL.
+    pub fn execute(&mut self, code: &str) -> Result<ExecuteResult> {
+        self.submit_execute(code)?.wait()
     }
 
     /// Get a variable from the REPL namespace.
     pub fn get_variable(&mut self, name: &str) -> Result<Value> {
-        let params = serde_json::json!({ "name": name });
-        self.send_request("get_variable", params)
+        self.submit_get_variable(name)?.wait()
     }
 
     /// Set a variable in the REPL namespace.
+    ///
+    /// Values over `shm_threshold_bytes` are passed through shared memory.
     pub fn set_variable(&mut self, name: &str, value: Value) -> Result<()> {
+        self.submit_set_variable(name, value)?.wait()
+    }
+
+    /// Expose raw bytes in the REPL namespace as a `memoryview`, without
+    /// JSON encoding. Requires the shared-memory channel to be enabled.
+    pub fn set_variable_bytes(&mut self, name: &str, bytes: &[u8]) -> Result<()> {
+        let shm = self.shm.as_ref().ok_or_else(|| {
+            Error::Config("set_variable_bytes requires shm_threshold_bytes > 0".to_string())
+        })?;
         let params = serde_json::json!({
             "name": name,
-            "value": value,
+            "value": shm.offload_bytes(bytes)?,
         });
         self.send_request("set_variable", params)?;
         Ok(())
     }
 
+    /// Set several variables, pipelining the requests.
+    pub fn set_variables<I>(&mut self, variables: I) -> Result<()>
+    where
+        I: IntoIterator<Item = (String, Value)>,
+    {
+        let replies = variables
+            .into_iter()
+            .map(|(name, value)| self.submit_set_variable(&name, value))
+            .collect::<Result<Vec<_>>>()?;
+        for reply in replies {
+            reply.wait()?;
+        }
+        Ok(())
+    }
+
     /// Resolve a deferred operation.
     pub fn resolve_operation(&mut self, operation_id: &str, result: Value) -> Result<()> {
-        let params = serde_json::json!({
-            "operation_id": operation_id,
-            "result": result,
-        });
-        self.send_request("resolve_operation", params)?;
-        Ok(())
+        self.submit_resolve_operation(operation_id, result)?.wait()
     }
 
     /// List pending deferred operations with operation metadata.
@@ -423,27 +473,51 @@ impl ReplHandle {
 
     /// Resolve all pending `llm_batch` operations using the provided batch executor.
     ///
+    /// All batches are run concurrently and their results are pipelined back
+    /// to the REPL. If a batch fails, the batches before it are still resolved
+    /// and the first error is returned.
+    ///
     /// Returns the number of operations resolved.
     pub async fn resolve_pending_llm_batches<C: LLMClient + 'static>(
         &mut self,
         executor: &BatchExecutor<C>,
     ) -> Result<usize> {
         let pending = self.list_pending_operations()?;
-        let mut resolved = 0usize;
-
-        for operation in pending {
-            if operation.operation_type != "llm_batch" {
-                continue;
+        let batches = pending
+            .iter()
+            .filter(|operation| operation.operation_type == "llm_batch")
+            .map(|operation| Ok((operation, llm_batch_query_from_operation(operation)?)))
+            .collect::<Result<Vec<_>>>()?;
+
+        let outcomes =
+            futures::future::join_all(batches.into_iter().map(|(operation, query)| async move {
+                (operation, executor.execute(query).await)
+            }))
+            .await;
+
+        let mut replies = Vec::with_capacity(outcomes.len());
+        let mut first_error = None;
+        for (operation, outcome) in outcomes {
+            match outcome {
+                Ok(results) => {
+                    let payload = llm_batch_results_to_payload(&results);
+                    replies.push(self.submit_resolve_operation(&operation.id, payload)?);
+                }
+                Err(e) => {
+                    first_error = Some(e);
+                    break;
+                }
             }
-
-            let query = llm_batch_query_from_operation(&operation)?;
-            let results = executor.execute(query).await?;
-            let payload = llm_batch_results_to_payload(&results);
-            self.resolve_operation(&operation.id, payload)?;
-            resolved += 1;
         }
 
-        Ok(resolved)
+        let resolved = replies.len();
+        for reply in replies {
+            reply.wait()?;
+        }
+        match first_error {
+            Some(e) => Err(e),
+            None => Ok(resolved),
+        }
     }
 
     /// List all variables in the REPL namespace.
@@ -512,23 +586,27 @@ impl ReplHandle {
 
     /// Shutdown the REPL subprocess.
     pub fn shutdown(&mut self) -> Result<()> {
-        let request = JsonRpcRequest::new("shutdown", Value::Null, self.next_id);
-        self.next_id += 1;
-        if let Ok(request_json) = serde_json::to_string(&request) {
-            let _ = writeln!(self.stdin, "{}", request_json);
-            let _ = self.stdin.flush();
-        }
+        let _ = self.channel.send_detached("shutdown", Value::Null);
 
-        wait_for_exit_with_timeout(
-            &mut self.child,
-            Duration::from_millis(SHUTDOWN_GRACE_MS),
-            "REPL subprocess",
-        )
+        let grace = Duration::from_millis(SHUTDOWN_GRACE_MS);
+        match &mut self.process {
+            ReplProcess::Child(child) => {
+                wait_for_exit_with_timeout(child, grace, "REPL subprocess")
+            }
+            #[cfg(unix)]
+            ReplProcess::Forked(forked) => {
+                forked.finish_shutdown(self.channel.wait_closed(grace), grace)
+            }
+        }
     }
 
     /// Check if the subprocess is still running.
     pub fn is_alive(&mut self) -> bool {
-        matches!(self.child.try_wait(), Ok(None))
+        match &mut self.process {
+            ReplProcess::Child(child) => matches!(child.try_wait(), Ok(None)),
+            #[cfg(unix)]
+            ReplProcess::Forked(_) => !self.channel.is_closed(),
+        }
     }
 }
 
@@ -538,6 +616,59 @@ impl Drop for ReplHandle {
     }
 }
 
+/// Read and validate the `ready` line a REPL (or fork server) sends on startup.
+///
+/// `stderr_output` is only invoked if the process closed stdout before
+/// sending anything, to enrich the error.
+fn read_ready(
+    stdout: &mut dyn BufRead,
+    startup_context: &str,
+    stderr_output: impl FnOnce() -> String,
+) -> Result<()> {
+    let mut line = String::new();
+    let read_bytes = stdout.read_line(&mut line).map_err(|e| {
+        Error::SubprocessComm(format!(
+            "Failed to read ready message ({startup_context}): {e}"
+        ))
+    })?;
+
+    if read_bytes == 0 {
+        let stderr_output = stderr_output();
+        let stderr_output = stderr_output.trim();
+        let stderr_excerpt: String = stderr_output.chars().take(500).collect();
+        let truncated = stderr_output.chars().count() > 500;
+        let stderr_detail = if stderr_excerpt.is_empty() {
+            String::new()
+        } else if truncated {
+            format!("; stderr: {stderr_excerpt}...")
+        } else {
+            format!("; stderr: {stderr_excerpt}")
+        };
+
+        return Err(Error::SubprocessComm(
+            format!(
+                "REPL subprocess exited before sending ready message ({startup_context}){stderr_detail}"
+            ),
+        ));
+    }
+
+    let msg: Value = serde_json::from_str(&line).map_err(|e| {
+        Error::SubprocessComm(format!(
+            "Invalid ready message ({startup_context}): {e}; payload={}",
+            line.trim()
+        ))
+    })?;
+
+    if msg.get("method") != Some(&Value::String("ready".to_string())) {
+        return Err(Error::SubprocessComm(format!(
+            "Expected ready message ({startup_context}), got: {}",
+            line.trim()
+        )));
+    }
+
+    Ok(())
+}
+
 fn llm_batch_query_from_operation(operation: &PendingOperation) -> Result<BatchedLLMQuery> {
     let prompts_value = operation
         .params
@@ -631,51 +762,68 @@ fn llm_batch_results_to_payload(results: &BatchedQueryResults) -> Value {
     Value::Array(entries)
 }
 
+impl Poolable for ReplHandle {
+    type Config = ReplConfig;
+
+    fn spawn(config: &ReplConfig) -> Result<Self> {
+        ReplHandle::spawn(config.clone())
+    }
+
+    fn is_alive(&mut self) -> bool {
+        ReplHandle::is_alive(self)
+    }
+
+    fn lease_slot(&mut self) -> &mut Option<PoolLease> {
+        &mut self.lease
+    }
+}
+
 /// Thread-safe REPL pool for managing multiple REPL instances.
+///
+/// The pool bounds the number of live interpreters, optionally keeps a number
+/// of them pre-warmed in the background, and queues callers when exhausted.
 pub struct ReplPool {
-    config: ReplConfig,
-    handles: Arc<Mutex<Vec<ReplHandle>>>,
-    max_size: usize,
+    inner: ProcessPool<ReplHandle>,
 }
 
 impl ReplPool {
-    /// Create a new REPL pool.
+    /// Create a new REPL pool holding at most `max_size` interpreters
+    /// (`0` for unbounded). No interpreters are pre-warmed.
     pub fn new(config: ReplConfig, max_size: usize) -> Self {
-        Self {
+        Self::with_options(
             config,
-            handles: Arc::new(Mutex::new(Vec::new())),
-            max_size,
+            PoolOptions {
+                max_size,
+                ..PoolOptions::default()
+            },
+        )
+    }
+
+    /// Create a new REPL pool with explicit sizing and timing options.
+    pub fn with_options(config: ReplConfig, options: PoolOptions) -> Self {
+        Self {
+            inner: ProcessPool::new(config, options),
         }
     }
 
-    /// Acquire a REPL handle from the pool.
+    /// Acquire a REPL handle, waiting up to the configured acquire timeout.
     pub fn acquire(&self) -> Result<ReplHandle> {
-        let mut handles = self
-            .handles
-            .lock()
-            .map_err(|e| Error::Internal(format!("Failed to lock pool: {}", e)))?;
-
-        // Try to get an existing handle
-        while let Some(mut handle) = handles.pop() {
-            if handle.is_alive() {
-                return Ok(handle);
-            }
-            // Handle is dead, drop it and try another
-        }
+        self.inner.acquire()
+    }
 
-        // No available handles, spawn a new one
-        ReplHandle::spawn(self.config.clone())
+    /// Acquire a REPL handle, waiting up to `timeout` if the pool is exhausted.
+    pub fn acquire_timeout(&self, timeout: Duration) -> Result<ReplHandle> {
+        self.inner.acquire_timeout(timeout)
     }
 
     /// Return a REPL handle to the pool.
     pub fn release(&self, handle: ReplHandle) {
-        let mut handles = self.handles.lock().ok();
-        if let Some(ref mut handles) = handles {
-            if handles.len() < self.max_size {
-                handles.push(handle);
-            }
-            // Otherwise, the handle is dropped
-        }
+        self.inner.release(handle)
+    }
+
+    /// Pool occupancy and spawn statistics.
+    pub fn stats(&self) -> PoolStats {
+        self.inner.stats()
     }
 }
 
@@ -820,6 +968,64 @@ mod tests {
         handle.shutdown().unwrap();
     }
 
+    #[test]
+    #[ignore = "requires Python environment with rlm-repl installed"]
+    fn test_repl_pipelined_requests() {
+        let mut repl = ReplHandle::spawn(local_repl_config()).expect("REPL should start");
+        let sets = (0..8)
+            .map(|i| repl.submit_set_variable(&format!("v{i}"), Value::from(i)))
+            .collect::<Result<Vec<_>>>()
+            .unwrap();
+        let gets = (0..8)
+            .map(|i| repl.submit_get_variable(&format!("v{i}")))
+            .collect::<Result<Vec<_>>>()
+            .unwrap();
+
+        for set in sets {
+            set.wait().unwrap();
+        }
+        for (i, get) in gets.into_iter().enumerate().rev() {
+            assert_eq!(get.wait().unwrap(), Value::from(i));
+        }
+        repl.shutdown().unwrap();
+    }
+
+    #[test]
+    #[cfg(unix)]
+    #[ignore = "requires Python environment with rlm-repl installed"]
+    fn test_repl_fork_server_spawn() {
+        let mut config = local_repl_config();
+        config.startup_mode = ReplStartupMode::ForkServer;
+
+        let mut first = ReplHandle::spawn(config.clone()).expect("fork server REPL should start");
+        let mut second = ReplHandle::spawn(config).expect("second fork should reuse the server");
+        assert!(first.is_alive() && second.is_alive());
+
+        first.execute("x = 1").unwrap();
+        let result = second.execute("'x' in dir()").unwrap();
+        assert!(result.success);
+        assert_eq!(result.result, Some(Value::Bool(false)));
+
+        first.shutdown().unwrap();
+        assert!(!first.is_alive());
+        assert!(second.status().unwrap().ready);
+    }
+
+    #[test]
+    #[cfg(unix)]
+    fn test_repl_fork_server_error_includes_context() {
+        let mut config = ReplConfig::default();
+        config.python_path = "/definitely/missing/python3".to_string();
+        config.startup_mode = ReplStartupMode::ForkServer;
+
+        let msg = match ReplHandle::spawn(config) {
+            Ok(_) => panic!("spawn should fail when python path is invalid"),
+            Err(err) => err.to_string(),
+        };
+        assert!(msg.contains("Failed to spawn REPL fork server"));
+        assert!(msg.contains("entrypoint='-m rlm_repl.zygote'"));
+    }
+
     #[test]
     fn test_repl_spawn_error_includes_context() {
         let mut config = ReplConfig::default();
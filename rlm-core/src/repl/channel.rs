@@ -0,0 +1,416 @@
+//! Pipelined JSON-RPC channel to a REPL subprocess.
+//!
+//! Requests are tagged with a monotonically increasing id and written under a
+//! short lock; a dedicated reader thread routes each response line to the
+//! waiter registered for that id. Any number of requests may be in flight at
+//! once, and each waiter blocks on its own channel with a real deadline
+//! instead of polling the pipe.
+//!
+//! The Python server still handles requests in arrival order, so pipelining
+//! removes per-call round trips rather than adding parallelism inside the
+//! interpreter.
+
+use super::shm::SharedMemory;
+use super::{JsonRpcRequest, JsonRpcResponse};
+use crate::error::{Error, Result};
+use crate::metrics::{self, Metric};
+use serde_json::Value;
+use std::collections::HashMap;
+use std::io::{BufRead, BufReader, Read, Write};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::mpsc::{self, Receiver, RecvTimeoutError, SyncSender, TryRecvError};
+use std::sync::{Arc, Condvar, Mutex, MutexGuard};
+use std::time::{Duration, Instant};
+
+struct State {
+    /// Waiters by request id, each timing its round trip.
+    pending: HashMap<u64, (SyncSender<Result<Value>>, metrics::Timer)>,
+    closed: bool,
+}
+
+struct Shared {
+    state: Mutex<State>,
+    closed_changed: Condvar,
+}
+
+impl Shared {
+    fn lock(&self) -> MutexGuard<'_, State> {
+        // The state is a plain map plus a flag; it stays consistent even if a
+        // holder panicked, so poisoning is not fatal here.
+        self.state.lock().unwrap_or_else(|e| e.into_inner())
+    }
+
+    fn forget(&self, id: u64) {
+        if let Some((_, timer)) = self.lock().pending.remove(&id) {
+            timer.discard();
+        }
+    }
+}
+
+fn closed_error() -> Error {
+    Error::SubprocessComm("REPL subprocess closed unexpectedly".to_string())
+}
+
+fn response_result(response: JsonRpcResponse, shm: Option<&SharedMemory>) -> Result<Value> {
+    match response.error {
+        Some(error) => Err(Error::repl_execution(format!(
+            "{}: {}",
+            error.code, error.message
+        ))),
+        None => {
+            let result = response.result.unwrap_or(Value::Null);
+            match shm {
+                Some(shm) => shm.resolve(result),
+                None => Ok(result),
+            }
+        }
+    }
+}
+
+/// Request/response multiplexer over a REPL's stdin/stdout pair.
+pub(super) struct RpcChannel {
+    writer: Mutex<Box<dyn Write + Send>>,
+    next_id: AtomicU64,
+    shared: Arc<Shared>,
+}
+
+impl RpcChannel {
+    /// Take ownership of both ends and start the reader thread.
+    ///
+    /// With `shm`, shared-memory placeholders in results are resolved on the
+    /// reader thread before waiters see them.
+    pub(super) fn new(
+        writer: Box<dyn Write + Send>,
+        reader: BufReader<Box<dyn Read + Send>>,
+        shm: Option<Arc<SharedMemory>>,
+    ) -> Result<Self> {
+        let shared = Arc::new(Shared {
+            state: Mutex::new(State {
+                pending: HashMap::new(),
+                closed: false,
+            }),
+            closed_changed: Condvar::new(),
+        });
+
+        let thread_shared = Arc::clone(&shared);
+        std::thread::Builder::new()
+            .name("rlm-repl-reader".to_string())
+            .spawn(move || read_responses(reader, &thread_shared, shm.as_deref()))
+            .map_err(|e| {
+                Error::SubprocessComm(format!("Failed to start REPL reader thread: {}", e))
+            })?;
+
+        Ok(Self {
+            writer: Mutex::new(writer),
+            next_id: AtomicU64::new(1),
+            shared,
+        })
+    }
+
+    /// Send a request and register a waiter for its response.
+    ///
+    /// `timeout_ms` bounds the wait, measured from submission.
+    pub(super) fn submit<T>(
+        &self,
+        method: &str,
+        params: Value,
+        timeout_ms: u64,
+        decode: fn(Value) -> Result<T>,
+    ) -> Result<PendingReply<T>> {
+        let id = self.next_id.fetch_add(1, Ordering::Relaxed);
+        let request_json = serde_json::to_string(&JsonRpcRequest::new(method, params, id))?;
+
+        let (tx, rx) = mpsc::sync_channel(1);
+        {
+            let mut state = self.shared.lock();
+            if state.closed {
+                return Err(closed_error());
+            }
+            state
+                .pending
+                .insert(id, (tx, metrics::Timer::start(Metric::ReplRoundTrip)));
+        }
+
+        if let Err(e) = self.write_line(&request_json) {
+            self.shared.forget(id);
+            return Err(e);
+        }
+
+        Ok(PendingReply {
+            id,
+            rx,
+            shared: Arc::clone(&self.shared),
+            deadline: Instant::now().checked_add(Duration::from_millis(timeout_ms)),
+            timeout_ms,
+            ready: None,
+            decode,
+        })
+    }
+
+    /// Send a request whose response, if any, is discarded.
+    pub(super) fn send_detached(&self, method: &str, params: Value) -> Result<()> {
+        let id = self.next_id.fetch_add(1, Ordering::Relaxed);
+        let request_json = serde_json::to_string(&JsonRpcRequest::new(method, params, id))?;
+        self.write_line(&request_json)
+    }
+
+    fn write_line(&self, line: &str) -> Result<()> {
+        let mut writer = self
+            .writer
+            .lock()
+            .map_err(|e| Error::Internal(format!("Failed to lock REPL stdin: {}", e)))?;
+        writeln!(writer, "{}", line)
+            .map_err(|e| Error::SubprocessComm(format!("Failed to send request: {}", e)))?;
+        writer
+            .flush()
+            .map_err(|e| Error::SubprocessComm(format!("Failed to flush stdin: {}", e)))
+    }
+
+    /// Whether the subprocess has closed its output.
+    pub(super) fn is_closed(&self) -> bool {
+        self.shared.lock().closed
+    }
+
+    /// Wait up to `timeout` for the subprocess to close its output.
+    pub(super) fn wait_closed(&self, timeout: Duration) -> bool {
+        let state = self.shared.lock();
+        let (state, _) = self
+            .shared
+            .closed_changed
+            .wait_timeout_while(state, timeout, |s| !s.closed)
+            .unwrap_or_else(|e| e.into_inner());
+        state.closed
+    }
+}
+
+/// Reader thread body: route responses until EOF, then fail all waiters.
+fn read_responses(
+    mut reader: BufReader<Box<dyn Read + Send>>,
+    shared: &Shared,
+    shm: Option<&SharedMemory>,
+) {
+    let mut line = String::new();
+    loop {
+        line.clear();
+        match reader.read_line(&mut line) {
+            Ok(0) => break,
+            Ok(_) => {}
+            Err(e) if e.kind() == std::io::ErrorKind::Interrupted => continue,
+            Err(e) => {
+                tracing::debug!("REPL reader stopped: {}", e);
+                break;
+            }
+        }
+        if line.trim().is_empty() {
+            continue;
+        }
+
+        let response: JsonRpcResponse = match serde_json::from_str(&line) {
+            Ok(response) => response,
+            Err(e) => {
+                tracing::warn!("Discarding malformed REPL response: {}", e);
+                continue;
+            }
+        };
+        // Notifications and responses nobody is waiting for are dropped.
+        let Some(id) = response.id else {
+            continue;
+        };
+        let waiter = shared.lock().pending.remove(&id);
+        if let Some((tx, timer)) = waiter {
+            drop(timer);
+            let _ = tx.send(response_result(response, shm));
+        }
+    }
+
+    let mut state = shared.lock();
+    state.closed = true;
+    // Dropping the senders wakes every waiter with a disconnect.
+    for (_, (_, timer)) in state.pending.drain() {
+        timer.discard();
+    }
+    shared.closed_changed.notify_all();
+}
+
+/// A request that has been sent to the REPL and whose response may not have
+/// arrived yet.
+///
+/// Dropping a `PendingReply` abandons the request: its response is discarded
+/// when it arrives.
+pub struct PendingReply<T> {
+    id: u64,
+    rx: Receiver<Result<Value>>,
+    shared: Arc<Shared>,
+    deadline: Option<Instant>,
+    timeout_ms: u64,
+    ready: Option<Result<Value>>,
+    decode: fn(Value) -> Result<T>,
+}
+
+impl<T> PendingReply<T> {
+    /// JSON-RPC id of the request.
+    pub fn id(&self) -> u64 {
+        self.id
+    }
+
+    /// Check without blocking whether [`Self::wait`] would return immediately,
+    /// i.e. the response arrived, the subprocess went away, or the request
+    /// timed out.
+    pub fn poll(&mut self) -> bool {
+        if self.ready.is_some() {
+            return true;
+        }
+        match self.rx.try_recv() {
+            Ok(result) => self.ready = Some(result),
+            Err(TryRecvError::Disconnected) => self.ready = Some(Err(closed_error())),
+            Err(TryRecvError::Empty) => {
+                if !self.deadline.is_some_and(|d| Instant::now() >= d) {
+                    return false;
+                }
+                self.shared.forget(self.id);
+                self.ready = Some(Err(Error::timeout(self.timeout_ms)));
+            }
+        }
+        true
+    }
+
+    /// Block until the response arrives or the request times out.
+    pub fn wait(mut self) -> Result<T> {
+        let result = match self.ready.take() {
+            Some(result) => result,
+            None => self.recv(),
+        };
+        result.and_then(self.decode)
+    }
+
+    fn recv(&self) -> Result<Value> {
+        let received = match self.deadline {
+            Some(deadline) => self
+                .rx
+                .recv_timeout(deadline.saturating_duration_since(Instant::now())),
+            None => self.rx.recv().map_err(|_| RecvTimeoutError::Disconnected),
+        };
+        match received {
+            Ok(result) => result,
+            Err(RecvTimeoutError::Disconnected) => Err(closed_error()),
+            Err(RecvTimeoutError::Timeout) => {
+                self.shared.forget(self.id);
+                Err(Error::timeout(self.timeout_ms))
+            }
+        }
+    }
+}
+
+impl<T> Drop for PendingReply<T> {
+    fn drop(&mut self) {
+        self.shared.forget(self.id);
+    }
+}
+
+impl<T> std::fmt::Debug for PendingReply<T> {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("PendingReply")
+            .field("id", &self.id)
+            .field("ready", &self.ready.is_some())
+            .finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::io::Cursor;
+
+    /// Writer that discards everything.
+    struct Sink;
+
+    impl Write for Sink {
+        fn write(&mut self, buf: &[u8]) -> std::io::Result<usize> {
+            Ok(buf.len())
+        }
+        fn flush(&mut self) -> std::io::Result<()> {
+            Ok(())
+        }
+    }
+
+    /// Reader that yields the given lines once a request has been registered.
+    struct Delayed {
+        inner: Cursor<Vec<u8>>,
+        gate: Arc<(Mutex<bool>, Condvar)>,
+    }
+
+    impl Read for Delayed {
+        fn read(&mut self, buf: &mut [u8]) -> std::io::Result<usize> {
+            let (open, cv) = &*self.gate;
+            let guard = open.lock().unwrap();
+            let _ = cv.wait_while(guard, |open| !*open).unwrap();
+            self.inner.read(buf)
+        }
+    }
+
+    fn channel_with(lines: &str) -> (RpcChannel, Arc<(Mutex<bool>, Condvar)>) {
+        let gate = Arc::new((Mutex::new(false), Condvar::new()));
+        let reader = Delayed {
+            inner: Cursor::new(lines.as_bytes().to_vec()),
+            gate: Arc::clone(&gate),
+        };
+        let channel = RpcChannel::new(
+            Box::new(Sink),
+            BufReader::new(Box::new(reader) as Box<dyn Read + Send>),
+            None,
+        )
+        .unwrap();
+        (channel, gate)
+    }
+
+    fn open(gate: &(Mutex<bool>, Condvar)) {
+        *gate.0.lock().unwrap() = true;
+        gate.1.notify_all();
+    }
+
+    #[test]
+    fn test_out_of_order_responses_are_routed_by_id() {
+        let (channel, gate) = channel_with(concat!(
+            r#"{"jsonrpc":"2.0","method":"ready","params":{}}"#,
+            "\n",
+            r#"{"jsonrpc":"2.0","result":"second","id":2}"#,
+            "\n",
+            r#"{"jsonrpc":"2.0","error":{"code":-32000,"message":"boom"},"id":3}"#,
+            "\n",
+            r#"{"jsonrpc":"2.0","result":"first","id":1}"#,
+            "\n",
+        ));
+        let first = channel.submit("a", Value::Null, 5_000, Ok).unwrap();
+        let mut second = channel.submit("b", Value::Null, 5_000, Ok).unwrap();
+        let third = channel.submit("c", Value::Null, 5_000, Ok).unwrap();
+        assert!(!second.poll());
+        open(&gate);
+
+        assert_eq!(first.wait().unwrap(), Value::String("first".to_string()));
+        assert_eq!(second.wait().unwrap(), Value::String("second".to_string()));
+        assert!(third.wait().unwrap_err().to_string().contains("boom"));
+
+        assert!(channel.wait_closed(Duration::from_secs(5)));
+        assert!(channel.submit("d", Value::Null, 5_000, Ok).is_err());
+    }
+
+    #[test]
+    fn test_waiters_fail_when_subprocess_closes() {
+        let (channel, gate) = channel_with("");
+        let pending = channel.submit("a", Value::Null, 5_000, Ok).unwrap();
+        open(&gate);
+        let err = pending.wait().unwrap_err();
+        assert!(err.to_string().contains("closed unexpectedly"));
+        assert!(channel.is_closed());
+    }
+
+    #[test]
+    fn test_timeout_forgets_request() {
+        let (channel, gate) = channel_with("");
+        let mut pending = channel.submit("a", Value::Null, 0, Ok).unwrap();
+        assert!(pending.poll());
+        assert!(matches!(pending.wait(), Err(Error::Timeout { .. })));
+        assert!(channel.shared.lock().pending.is_empty());
+        open(&gate);
+    }
+}
@@ -0,0 +1,240 @@
+//! Shared-memory side channel for large REPL payloads.
+//!
+//! Values at or above a size threshold are not embedded in the JSON-RPC line.
+//! Instead they are written once into a segment file in a private directory on
+//! a memory-backed filesystem (`/dev/shm` where available), and the message
+//! carries a small placeholder:
+//!
+//! ```json
+//! {"$rlm_shm": {"name": "seg-1", "len": 4194304, "encoding": "utf8"}}
+//! ```
+//!
+//! `encoding` is `utf8` (a string, sent raw without JSON escaping), `json` (a
+//! serialized JSON value) or `bytes` (raw bytes, surfaced to Python as a
+//! `memoryview` over the mapping). The reader of a segment maps or reads it
+//! and unlinks it; whatever is left is removed with the directory when the
+//! handle goes away.
+
+use crate::error::{Error, Result};
+use serde_json::{Map, Value};
+#[cfg(unix)]
+use std::os::unix::fs::{DirBuilderExt, OpenOptionsExt};
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+
+/// Key marking a shared-memory placeholder object.
+pub(super) const PLACEHOLDER_KEY: &str = "$rlm_shm";
+
+/// Environment variable carrying the segment directory to the REPL.
+pub(super) const DIR_ENV: &str = "RLM_REPL_SHM_DIR";
+
+/// Environment variable carrying the size threshold to the REPL.
+pub(super) const THRESHOLD_ENV: &str = "RLM_REPL_SHM_THRESHOLD";
+
+static NEXT_DIR: AtomicU64 = AtomicU64::new(0);
+
+/// A per-handle directory of shared-memory segments.
+#[derive(Debug)]
+pub(super) struct SharedMemory {
+    dir: PathBuf,
+    threshold: usize,
+    next_segment: AtomicU64,
+}
+
+impl SharedMemory {
+    /// Create the segment directory, or return `None` if `threshold` is 0.
+    pub(super) fn create(threshold: usize) -> Result<Option<Self>> {
+        if threshold == 0 {
+            return Ok(None);
+        }
+        let base = Path::new("/dev/shm");
+        let base = if base.is_dir() {
+            base.to_path_buf()
+        } else {
+            std::env::temp_dir()
+        };
+        let dir = base.join(format!(
+            "rlm-shm-{}-{}",
+            std::process::id(),
+            NEXT_DIR.fetch_add(1, Ordering::Relaxed)
+        ));
+        let mut builder = std::fs::DirBuilder::new();
+        #[cfg(unix)]
+        builder.mode(0o700);
+        builder
+            .create(&dir)
+            .map_err(|e| Error::SubprocessComm(format!("Failed to create shm dir: {}", e)))?;
+
+        Ok(Some(Self {
+            dir,
+            threshold,
+            next_segment: AtomicU64::new(0),
+        }))
+    }
+
+    /// Segment directory, passed to the REPL via [`DIR_ENV`].
+    pub(super) fn dir(&self) -> &Path {
+        &self.dir
+    }
+
+    /// Environment the REPL needs to use this channel.
+    pub(super) fn env(&self) -> [(&'static str, String); 2] {
+        [
+            (DIR_ENV, self.dir.to_string_lossy().into_owned()),
+            (THRESHOLD_ENV, self.threshold.to_string()),
+        ]
+    }
+
+    /// Replace `value` with a placeholder if it is large enough.
+    pub(super) fn offload(&self, value: Value) -> Result<Value> {
+        match value {
+            Value::String(s) if s.len() >= self.threshold => self.write(s.as_bytes(), "utf8"),
+            Value::Array(_) | Value::Object(_) => {
+                let bytes = serde_json::to_vec(&value)?;
+                if bytes.len() >= self.threshold {
+                    self.write(&bytes, "json")
+                } else {
+                    Ok(value)
+                }
+            }
+            other => Ok(other),
+        }
+    }
+
+    /// Write raw bytes as a segment the REPL exposes as a `memoryview`.
+    ///
+    /// Unlike [`Self::offload`], this always uses a segment.
+    pub(super) fn offload_bytes(&self, bytes: &[u8]) -> Result<Value> {
+        self.write(bytes, "bytes")
+    }
+
+    fn write(&self, bytes: &[u8], encoding: &str) -> Result<Value> {
+        let name = format!("seg-{}", self.next_segment.fetch_add(1, Ordering::Relaxed));
+        let path = self.dir.join(&name);
+        let io_err = |e: std::io::Error| {
+            Error::SubprocessComm(format!("Failed to write shm segment: {}", e))
+        };
+        let mut options = std::fs::OpenOptions::new();
+        options.write(true).create_new(true);
+        #[cfg(unix)]
+        options.mode(0o600);
+        let mut file = options.open(&path).map_err(io_err)?;
+        std::io::Write::write_all(&mut file, bytes).map_err(io_err)?;
+
+        let mut spec = Map::new();
+        spec.insert("name".to_string(), Value::String(name));
+        spec.insert("len".to_string(), Value::from(bytes.len()));
+        spec.insert("encoding".to_string(), Value::String(encoding.to_string()));
+        let mut placeholder = Map::new();
+        placeholder.insert(PLACEHOLDER_KEY.to_string(), Value::Object(spec));
+        Ok(Value::Object(placeholder))
+    }
+
+    /// Replace every placeholder in `value` with the segment it refers to,
+    /// consuming the segments.
+    pub(super) fn resolve(&self, value: Value) -> Result<Value> {
+        match value {
+            Value::Object(map) => match placeholder_spec(&map) {
+                Some(spec) => self.read(spec),
+                None => map
+                    .into_iter()
+                    .map(|(k, v)| Ok((k, self.resolve(v)?)))
+                    .collect::<Result<Map<_, _>>>()
+                    .map(Value::Object),
+            },
+            Value::Array(items) => items
+                .into_iter()
+                .map(|v| self.resolve(v))
+                .collect::<Result<Vec<_>>>()
+                .map(Value::Array),
+            other => Ok(other),
+        }
+    }
+
+    fn read(&self, spec: &Map<String, Value>) -> Result<Value> {
+        let name = spec
+            .get("name")
+            .and_then(Value::as_str)
+            .filter(|n| !n.is_empty() && !n.contains(['/', '\\']) && *n != "." && *n != "..")
+            .ok_or_else(|| Error::SubprocessComm("Invalid shm segment name".to_string()))?;
+        let path = self.dir.join(name);
+        let bytes = std::fs::read(&path).map_err(|e| {
+            Error::SubprocessComm(format!("Failed to read shm segment '{}': {}", name, e))
+        });
+        let _ = std::fs::remove_file(&path);
+        let mut bytes = bytes?;
+        if let Some(len) = spec.get("len").and_then(Value::as_u64) {
+            bytes.truncate(len as usize);
+        }
+
+        match spec.get("encoding").and_then(Value::as_str) {
+            Some("json") => Ok(serde_json::from_slice(&bytes)?),
+            Some("utf8") | None => String::from_utf8(bytes).map(Value::String).map_err(|e| {
+                Error::SubprocessComm(format!("shm segment '{}' is not UTF-8: {}", name, e))
+            }),
+            Some(other) => Err(Error::SubprocessComm(format!(
+                "Unsupported shm segment encoding '{}'",
+                other
+            ))),
+        }
+    }
+}
+
+fn placeholder_spec(map: &Map<String, Value>) -> Option<&Map<String, Value>> {
+    if map.len() != 1 {
+        return None;
+    }
+    map.get(PLACEHOLDER_KEY).and_then(Value::as_object)
+}
+
+impl Drop for SharedMemory {
+    fn drop(&mut self) {
+        let _ = std::fs::remove_dir_all(&self.dir);
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_small_values_stay_inline() {
+        let shm = SharedMemory::create(64).unwrap().unwrap();
+        let value = serde_json::json!({"a": [1, 2, 3]});
+        assert_eq!(shm.offload(value.clone()).unwrap(), value);
+        assert!(SharedMemory::create(0).unwrap().is_none());
+    }
+
+    #[test]
+    fn test_offload_and_resolve_roundtrip() {
+        let shm = SharedMemory::create(16).unwrap().unwrap();
+        let text = "x\"y\\z\n".repeat(10);
+        let nested = serde_json::json!({"files": {"a.rs": "fn main() {}".repeat(4)}});
+
+        let placeholders = serde_json::json!({
+            "text": shm.offload(Value::String(text.clone())).unwrap(),
+            "nested": shm.offload(nested.clone()).unwrap(),
+            "small": "ok",
+        });
+        assert!(placeholders["text"].get(PLACEHOLDER_KEY).is_some());
+        assert_eq!(std::fs::read_dir(shm.dir()).unwrap().count(), 2);
+
+        let resolved = shm.resolve(placeholders).unwrap();
+        assert_eq!(resolved["text"], Value::String(text));
+        assert_eq!(resolved["nested"], nested);
+        assert_eq!(resolved["small"], "ok");
+        // Segments are consumed on read.
+        assert_eq!(std::fs::read_dir(shm.dir()).unwrap().count(), 0);
+
+        let dir = shm.dir().to_path_buf();
+        drop(shm);
+        assert!(!dir.exists());
+    }
+
+    #[test]
+    fn test_resolve_rejects_path_traversal() {
+        let shm = SharedMemory::create(16).unwrap().unwrap();
+        let bad = serde_json::json!({PLACEHOLDER_KEY: {"name": "../etc/passwd", "len": 1}});
+        assert!(shm.resolve(bad).is_err());
+    }
+}
@@ -0,0 +1,245 @@
+//! Fork-server ("zygote") REPL startup.
+//!
+//! A zygote is a long-lived `python -m rlm_repl.zygote` process that has
+//! already imported the REPL runtime and the externalized context helpers.
+//! Each REPL is a `fork()` of it, connected to us over a Unix domain socket,
+//! which avoids paying interpreter startup and imports per handle.
+//!
+//! One zygote is kept per (python, package path) pair for the lifetime of the
+//! host process. It exits on its own when its stdin pipe closes.
+
+use super::ReplConfig;
+use crate::context::VariableAccessHelper;
+use crate::error::{Error, Result};
+use serde_json::Value;
+use std::collections::HashMap;
+use std::io::{BufRead, BufReader, Read, Write};
+use std::os::unix::fs::DirBuilderExt;
+use std::os::unix::net::UnixStream;
+use std::path::PathBuf;
+use std::process::{Child, ChildStdin, Command, Stdio};
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, OnceLock};
+use std::time::{Duration, Instant};
+
+static ZYGOTES: OnceLock<Mutex<HashMap<(String, Option<String>), Arc<Zygote>>>> = OnceLock::new();
+static NEXT_ZYGOTE: AtomicU64 = AtomicU64::new(0);
+
+/// A running fork server.
+pub(super) struct Zygote {
+    child: Mutex<Child>,
+    // Held open so the zygote notices (EOF) when this process exits.
+    _stdin: ChildStdin,
+    dir: PathBuf,
+    socket_path: PathBuf,
+}
+
+/// A REPL forked from a zygote.
+pub(super) struct ForkedRepl {
+    pub(super) pid: u32,
+    pub(super) stream: UnixStream,
+    zygote: Arc<Zygote>,
+}
+
+impl Zygote {
+    /// Get the shared zygote for `config`, starting one if none is running.
+    fn shared(config: &ReplConfig) -> Result<Arc<Self>> {
+        let key = (config.python_path.clone(), config.repl_package_path.clone());
+        let registry = ZYGOTES.get_or_init(|| Mutex::new(HashMap::new()));
+        let mut zygotes = registry
+            .lock()
+            .map_err(|e| Error::Internal(format!("Failed to lock zygote registry: {}", e)))?;
+
+        if let Some(zygote) = zygotes.get(&key) {
+            if zygote.is_alive() {
+                return Ok(Arc::clone(zygote));
+            }
+        }
+        let zygote = Arc::new(Self::start(config)?);
+        zygotes.insert(key, Arc::clone(&zygote));
+        Ok(zygote)
+    }
+
+    fn start(config: &ReplConfig) -> Result<Self> {
+        let startup_context = format!(
+            "python_path='{}', entrypoint='-m rlm_repl.zygote', repl_package_path='{}'",
+            config.python_path,
+            config.repl_package_path.as_deref().unwrap_or("<none>")
+        );
+
+        let dir = std::env::temp_dir().join(format!(
+            "rlm-zygote-{}-{}",
+            std::process::id(),
+            NEXT_ZYGOTE.fetch_add(1, Ordering::Relaxed)
+        ));
+        std::fs::DirBuilder::new()
+            .mode(0o700)
+            .create(&dir)
+            .map_err(|e| Error::SubprocessComm(format!("Failed to create zygote dir: {}", e)))?;
+        let socket_path = dir.join("fork.sock");
+        let preload_path = dir.join("rlm_context.py");
+        std::fs::write(&preload_path, VariableAccessHelper::generate_module()).map_err(|e| {
+            Error::SubprocessComm(format!("Failed to write zygote preload module: {}", e))
+        })?;
+
+        let mut cmd = Command::new(&config.python_path);
+        cmd.arg("-m")
+            .arg("rlm_repl.zygote")
+            .arg("--socket")
+            .arg(&socket_path)
+            .arg("--preload")
+            .arg(&preload_path)
+            .stdin(Stdio::piped())
+            .stdout(Stdio::piped())
+            .stderr(Stdio::piped());
+        if let Some(ref path) = config.repl_package_path {
+            cmd.env("PYTHONPATH", path);
+        }
+
+        let mut child = cmd.spawn().map_err(|e| {
+            let _ = std::fs::remove_dir_all(&dir);
+            Error::SubprocessComm(format!(
+                "Failed to spawn REPL fork server ({startup_context}): {e}"
+            ))
+        })?;
+        let stdin = child.stdin.take();
+        let stdout = child.stdout.take();
+        let mut stderr = child.stderr.take();
+
+        let ready = match stdout {
+            Some(stdout) => {
+                let mut stdout = BufReader::new(stdout);
+                super::read_ready(&mut stdout, &startup_context, || {
+                    let mut output = String::new();
+                    if matches!(child.try_wait(), Ok(Some(_))) {
+                        if let Some(ref mut stderr) = stderr {
+                            let _ = stderr.read_to_string(&mut output);
+                        }
+                    }
+                    output
+                })
+            }
+            None => Err(Error::SubprocessComm(
+                "Failed to get fork server stdout handle".to_string(),
+            )),
+        };
+
+        match (ready, stdin) {
+            (Ok(()), Some(stdin)) => Ok(Self {
+                child: Mutex::new(child),
+                _stdin: stdin,
+                dir,
+                socket_path,
+            }),
+            (result, _) => {
+                let _ = child.kill();
+                let _ = child.wait();
+                let _ = std::fs::remove_dir_all(&dir);
+                Err(result.err().unwrap_or_else(|| {
+                    Error::SubprocessComm("Failed to get fork server stdin handle".to_string())
+                }))
+            }
+        }
+    }
+
+    fn is_alive(&self) -> bool {
+        self.child
+            .lock()
+            .map(|mut child| matches!(child.try_wait(), Ok(None)))
+            .unwrap_or(false)
+    }
+
+    /// Ask the zygote to SIGKILL one of its children.
+    pub(super) fn kill(&self, pid: u32) {
+        if let Ok(mut stream) = UnixStream::connect(&self.socket_path) {
+            let request = serde_json::json!({"method": "kill", "params": {"pid": pid}});
+            let _ = writeln!(stream, "{}", request);
+            let _ = stream.set_read_timeout(Some(Duration::from_secs(1)));
+            let mut reply = String::new();
+            let _ = BufReader::new(stream).read_line(&mut reply);
+        }
+    }
+}
+
+impl Drop for Zygote {
+    fn drop(&mut self) {
+        if let Ok(mut child) = self.child.lock() {
+            let _ = child.kill();
+            let _ = child.wait();
+        }
+        let _ = std::fs::remove_dir_all(&self.dir);
+    }
+}
+
+impl ForkedRepl {
+    /// Fork a fresh REPL from the shared zygote and wait for it to be ready.
+    ///
+    /// `env` is applied in the child before the REPL server starts. Returns
+    /// the handle together with a buffered reader positioned after the ready
+    /// message.
+    pub(super) fn fork(
+        config: &ReplConfig,
+        env: &[(&str, String)],
+    ) -> Result<(Self, BufReader<Box<dyn Read + Send>>)> {
+        let zygote = Zygote::shared(config)?;
+        let startup_context = format!("fork server at '{}'", zygote.socket_path.to_string_lossy());
+
+        let mut stream = UnixStream::connect(&zygote.socket_path).map_err(|e| {
+            Error::SubprocessComm(format!("Failed to connect to {startup_context}: {e}"))
+        })?;
+        let io_err = |e: std::io::Error| Error::SubprocessComm(format!("{startup_context}: {e}"));
+
+        // Bound startup so a wedged zygote cannot hang the caller.
+        let deadline = Instant::now() + Duration::from_millis(config.timeout_ms);
+        stream
+            .set_read_timeout(Some(Duration::from_millis(config.timeout_ms.max(1))))
+            .map_err(io_err)?;
+        let env: serde_json::Map<String, Value> = env
+            .iter()
+            .map(|(k, v)| (k.to_string(), Value::String(v.clone())))
+            .collect();
+        let request = serde_json::json!({"method": "fork", "params": {"env": env}});
+        writeln!(stream, "{}", request).map_err(io_err)?;
+
+        let mut reader: BufReader<Box<dyn Read + Send>> =
+            BufReader::new(Box::new(stream.try_clone().map_err(io_err)?));
+        let mut line = String::new();
+        reader.read_line(&mut line).map_err(io_err)?;
+        let pid = serde_json::from_str::<Value>(&line)
+            .ok()
+            .and_then(|v| v.get("pid").and_then(Value::as_u64))
+            .ok_or_else(|| {
+                Error::SubprocessComm(format!(
+                    "Unexpected fork reply from {startup_context}: {}",
+                    line.trim()
+                ))
+            })? as u32;
+
+        let forked = Self {
+            pid,
+            stream,
+            zygote,
+        };
+        if Instant::now() > deadline {
+            return Err(Error::timeout(config.timeout_ms));
+        }
+        super::read_ready(&mut reader, &startup_context, String::new)?;
+        forked.stream.set_read_timeout(None).map_err(io_err)?;
+        Ok((forked, reader))
+    }
+
+    /// Finish a shutdown request: close our end and, if the child did not
+    /// exit within `grace`, kill it through the zygote.
+    pub(super) fn finish_shutdown(&self, exited: bool, grace: Duration) -> Result<()> {
+        let _ = self.stream.shutdown(std::net::Shutdown::Both);
+        if exited {
+            return Ok(());
+        }
+        self.zygote.kill(self.pid);
+        Err(Error::SubprocessComm(format!(
+            "REPL subprocess (forked pid {}) did not exit within {}ms; process was terminated",
+            self.pid,
+            grace.as_millis()
+        )))
+    }
+}
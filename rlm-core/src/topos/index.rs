@@ -3,12 +3,15 @@
 //! This module provides the `LinkIndex` for maintaining and querying
 //! bidirectional links between Topos specifications and Lean formalizations.
 
-use std::collections::HashMap;
+use std::collections::{BTreeMap, HashMap, HashSet};
 use std::fs;
 use std::path::{Path, PathBuf};
+use std::time::UNIX_EPOCH;
 
 use serde::{Deserialize, Serialize};
+use sha2::{Digest, Sha256};
 
+use super::mapped;
 use super::parser::{AnnotationParser, AnnotationTarget};
 use super::types::{LeanRef, Link, LinkSource, LinkType, ToposRef};
 use crate::error::{Error, Result};
@@ -37,6 +40,38 @@ pub struct IndexMetadata {
     pub lean_file_count: usize,
     /// Project root path (for resolving relative paths).
     pub project_root: Option<PathBuf>,
+    /// Change-tracking state of every file indexed by [`IndexBuilder`],
+    /// keyed by path relative to the project root.
+    #[serde(default)]
+    pub files: BTreeMap<PathBuf, IndexedFile>,
+    /// When the last [`IndexBuilder`] scan started, in nanoseconds since the
+    /// Unix epoch. Files modified after this are always re-read.
+    #[serde(default)]
+    pub scan_started_ns: Option<u64>,
+    /// Files the last [`IndexBuilder`] scan had to parse.
+    #[serde(default)]
+    pub reparsed_file_count: usize,
+}
+
+/// Kind of annotations a file contributes.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Hash, Serialize, Deserialize)]
+pub enum IndexedFileKind {
+    /// Topos spec with `@lean` annotations.
+    Topos,
+    /// Lean source with `@topos` annotations.
+    Lean,
+}
+
+/// What a build saw of one file, to tell whether it changed since.
+#[derive(Debug, Clone, PartialEq, Eq, Serialize, Deserialize)]
+pub struct IndexedFile {
+    pub kind: IndexedFileKind,
+    /// Size in bytes.
+    pub len: u64,
+    /// Modification time in nanoseconds since the Unix epoch, if available.
+    pub mtime_ns: Option<u64>,
+    /// Hex SHA-256 of the content.
+    pub content_hash: String,
 }
 
 impl LinkIndex {
@@ -56,6 +91,18 @@ impl LinkIndex {
         }
     }
 
+    /// Assemble an index from links in insertion order and its metadata.
+    pub(super) fn from_parts(links: Vec<Link>, metadata: IndexMetadata) -> Self {
+        let mut index = Self {
+            metadata,
+            ..Default::default()
+        };
+        for link in links {
+            index.add_link(link);
+        }
+        index
+    }
+
     /// Add a link to the index.
     pub fn add_link(&mut self, link: Link) {
         let topos_key = link.topos.to_string_canonical();
@@ -156,8 +203,30 @@ impl LinkIndex {
 
     /// Index a Topos file by parsing its @lean annotations.
     pub fn index_topos_file(&mut self, path: &Path, content: &str) -> Result<usize> {
+        let links = Self::topos_file_links(path, content);
+        let count = links.len();
+        for link in links {
+            self.add_link(link);
+        }
+        self.metadata.topos_file_count += 1;
+        Ok(count)
+    }
+
+    /// Index a Lean file by parsing its @topos annotations.
+    pub fn index_lean_file(&mut self, path: &Path, content: &str) -> Result<usize> {
+        let links = Self::lean_file_links(path, content);
+        let count = links.len();
+        for link in links {
+            self.add_link(link);
+        }
+        self.metadata.lean_file_count += 1;
+        Ok(count)
+    }
+
+    /// Links declared by the @lean annotations of a Topos file.
+    fn topos_file_links(path: &Path, content: &str) -> Vec<Link> {
         let annotations = AnnotationParser::parse_lean_annotations(content);
-        let mut count = 0;
+        let mut links = Vec::new();
 
         // We need context about what element each annotation belongs to
         // For now, use a simple heuristic: find the closest preceding element definition
@@ -173,23 +242,21 @@ impl LinkIndex {
                     let link_type = AnnotationParser::infer_link_type(&annotation);
                     let metadata = AnnotationParser::to_metadata(&annotation);
 
-                    let link = Link::new(topos_ref, lean_ref.clone(), link_type, LinkSource::Topos)
-                        .with_metadata(metadata);
-
-                    self.add_link(link);
-                    count += 1;
+                    links.push(
+                        Link::new(topos_ref, lean_ref.clone(), link_type, LinkSource::Topos)
+                            .with_metadata(metadata),
+                    );
                 }
             }
         }
 
-        self.metadata.topos_file_count += 1;
-        Ok(count)
+        links
     }
 
-    /// Index a Lean file by parsing its @topos annotations.
-    pub fn index_lean_file(&mut self, path: &Path, content: &str) -> Result<usize> {
+    /// Links declared by the @topos annotations of a Lean file.
+    fn lean_file_links(path: &Path, content: &str) -> Vec<Link> {
         let annotations = AnnotationParser::parse_topos_annotations(content);
-        let mut count = 0;
+        let mut links = Vec::new();
 
         let lines: Vec<&str> = content.lines().collect();
 
@@ -205,12 +272,10 @@ impl LinkIndex {
                         let link_type = AnnotationParser::infer_link_type(&annotation);
                         let metadata = AnnotationParser::to_metadata(&annotation);
 
-                        let link =
+                        links.push(
                             Link::new(topos_ref.clone(), lean_ref, link_type, LinkSource::Lean)
-                                .with_metadata(metadata);
-
-                        self.add_link(link);
-                        count += 1;
+                                .with_metadata(metadata),
+                        );
                     }
                 }
                 AnnotationTarget::SpecId(_) => {
@@ -222,8 +287,7 @@ impl LinkIndex {
             }
         }
 
-        self.metadata.lean_file_count += 1;
-        Ok(count)
+        links
     }
 
     /// Find the Topos element context for a line.
@@ -327,14 +391,29 @@ impl LinkIndex {
         serde_json::from_str(json).map_err(Error::Serialization)
     }
 
-    /// Save the index to a file.
+    /// Save the index to a file as JSON.
+    ///
+    /// Like [`save_mapped`](Self::save_mapped), this renames a new file over
+    /// `path`, so a previous binary index mapped at `path` stays intact.
     pub fn save(&self, path: &Path) -> Result<()> {
-        let json = self.to_json()?;
-        fs::write(path, json).map_err(|e| Error::Internal(format!("Failed to save index: {}", e)))
+        mapped::write_atomic(path, self.to_json()?.as_bytes())
     }
 
-    /// Load the index from a file.
+    /// Save the index in the compact binary format that
+    /// [`MappedLinkIndex`](super::mapped::MappedLinkIndex) queries in place.
+    ///
+    /// The file is written alongside and renamed over `path`, so processes
+    /// that have the previous file mapped are unaffected.
+    pub fn save_mapped(&self, path: &Path) -> Result<()> {
+        mapped::write_atomic(path, &mapped::encode(self)?)
+    }
+
+    /// Load the index from a file written by [`save`](Self::save) or
+    /// [`save_mapped`](Self::save_mapped).
     pub fn load(path: &Path) -> Result<Self> {
+        if mapped::is_mapped_file(path) {
+            return mapped::MappedLinkIndex::open(path)?.to_index();
+        }
         let json = fs::read_to_string(path)
             .map_err(|e| Error::Internal(format!("Failed to load index: {}", e)))?;
         Self::from_json(&json)
@@ -351,11 +430,34 @@ impl LinkIndex {
     }
 }
 
+/// Files below this total size are read and parsed on the calling thread.
+const PARALLEL_SCAN_MIN_BYTES: u64 = 256 * 1024;
+
 /// Builder for constructing a LinkIndex from a project directory.
 pub struct IndexBuilder {
     project_root: PathBuf,
     topos_patterns: Vec<String>,
     lean_patterns: Vec<String>,
+    threads: Option<usize>,
+}
+
+/// A file found by the builder's patterns.
+struct ScannedFile {
+    kind: IndexedFileKind,
+    path: PathBuf,
+    rel_path: PathBuf,
+    len: u64,
+    mtime_ns: Option<u64>,
+}
+
+/// Result of reading a file that may have changed.
+enum Rescan {
+    /// Content hash matches the previous build; reuse its links.
+    Same(String),
+    /// Content changed; links parsed from the new content.
+    Parsed(String, Vec<Link>),
+    /// The file could not be read and is left out, as in a full build.
+    Unreadable,
 }
 
 impl IndexBuilder {
@@ -365,6 +467,7 @@ impl IndexBuilder {
             project_root: project_root.into(),
             topos_patterns: vec!["**/*.tps".to_string(), "**/*.topos".to_string()],
             lean_patterns: vec!["**/*.lean".to_string()],
+            threads: None,
         }
     }
 
@@ -380,43 +483,218 @@ impl IndexBuilder {
         self
     }
 
+    /// Cap the threads used to read and parse files (default: all cores).
+    pub fn threads(mut self, threads: usize) -> Self {
+        self.threads = Some(threads.max(1));
+        self
+    }
+
     /// Build the index by scanning all files.
     pub fn build(self) -> Result<LinkIndex> {
-        let mut index = LinkIndex::with_project_root(&self.project_root);
+        self.update(&LinkIndex::new())
+    }
+
+    /// Build the index, reusing `previous` for files that have not changed.
+    ///
+    /// A file whose size and modification time match its entry in
+    /// `previous` is not read at all; one whose content hash matches is read
+    /// but not reparsed. Changed files are read and parsed in parallel.
+    /// Links from files that no longer match are dropped, and
+    /// `LinkSource::Synthesized` links from `previous` are kept.
+    pub fn update(self, previous: &LinkIndex) -> Result<LinkIndex> {
+        let scan_started_ns = unix_nanos(std::time::SystemTime::now());
+        let files = self.discover();
+
+        // A file modified at or after the previous scan started may have
+        // changed again within the same mtime tick, so it is always re-read.
+        let prev_scan = previous.metadata.scan_started_ns;
+        let unchanged = |file: &ScannedFile| {
+            let prev = previous.metadata.files.get(&file.rel_path)?;
+            let settled = file
+                .mtime_ns
+                .zip(prev_scan)
+                .is_some_and(|(mtime, scan)| mtime < scan);
+            (settled
+                && prev.kind == file.kind
+                && prev.len == file.len
+                && prev.mtime_ns == file.mtime_ns)
+                .then(|| prev.content_hash.clone())
+        };
+        let cached: Vec<Option<String>> = files.iter().map(unchanged).collect();
+
+        let to_read: Vec<&ScannedFile> = files
+            .iter()
+            .zip(&cached)
+            .filter(|(_, hash)| hash.is_none())
+            .map(|(file, _)| file)
+            .collect();
+        let mut rescans = self.rescan(&to_read, previous).into_iter();
+        let outcomes: Vec<Rescan> = cached
+            .into_iter()
+            .map(|hash| match hash {
+                Some(hash) => Rescan::Same(hash),
+                None => rescans.next().unwrap_or(Rescan::Unreadable),
+            })
+            .collect();
+        let reparsed = outcomes
+            .iter()
+            .filter(|outcome| matches!(outcome, Rescan::Parsed(..)))
+            .count();
+
+        // Previous links by the file they were parsed from.
+        let mut previous_links: HashMap<(IndexedFileKind, &Path), Vec<&Link>> = HashMap::new();
+        let mut synthesized = Vec::new();
+        for link in &previous.links {
+            let key = match link.source {
+                LinkSource::Topos => (IndexedFileKind::Topos, link.topos.file.as_path()),
+                LinkSource::Lean => (IndexedFileKind::Lean, link.lean.file.as_path()),
+                LinkSource::Synthesized => {
+                    synthesized.push(link.clone());
+                    continue;
+                }
+            };
+            previous_links.entry(key).or_default().push(link);
+        }
 
-        // Find and index Topos files
-        for pattern in &self.topos_patterns {
-            let full_pattern = self.project_root.join(pattern);
-            if let Ok(entries) = glob::glob(full_pattern.to_str().unwrap_or("")) {
-                for entry in entries.flatten() {
-                    if let Ok(content) = fs::read_to_string(&entry) {
-                        // Use relative path
-                        let rel_path = entry.strip_prefix(&self.project_root).unwrap_or(&entry);
-                        let _ = index.index_topos_file(rel_path, &content);
+        let mut index = LinkIndex::with_project_root(&self.project_root);
+        for (file, outcome) in files.into_iter().zip(outcomes) {
+            let content_hash = match outcome {
+                Rescan::Unreadable => continue,
+                Rescan::Same(hash) => {
+                    let key = (file.kind, file.rel_path.as_path());
+                    for link in previous_links.get(&key).into_iter().flatten() {
+                        index.add_link((*link).clone());
+                    }
+                    hash
+                }
+                Rescan::Parsed(hash, links) => {
+                    for link in links {
+                        index.add_link(link);
                     }
+                    hash
                 }
+            };
+            match file.kind {
+                IndexedFileKind::Topos => index.metadata.topos_file_count += 1,
+                IndexedFileKind::Lean => index.metadata.lean_file_count += 1,
             }
+            index.metadata.files.insert(
+                file.rel_path,
+                IndexedFile {
+                    kind: file.kind,
+                    len: file.len,
+                    mtime_ns: file.mtime_ns,
+                    content_hash,
+                },
+            );
         }
+        for link in synthesized {
+            index.add_link(link);
+        }
+
+        index.metadata.scan_started_ns = scan_started_ns;
+        index.metadata.reparsed_file_count = reparsed;
+        index.touch();
+        Ok(index)
+    }
 
-        // Find and index Lean files
-        for pattern in &self.lean_patterns {
-            let full_pattern = self.project_root.join(pattern);
-            if let Ok(entries) = glob::glob(full_pattern.to_str().unwrap_or("")) {
-                for entry in entries.flatten() {
-                    if let Ok(content) = fs::read_to_string(&entry) {
-                        // Use relative path
-                        let rel_path = entry.strip_prefix(&self.project_root).unwrap_or(&entry);
-                        let _ = index.index_lean_file(rel_path, &content);
+    /// Files matching the patterns, Topos first, each listed once.
+    fn discover(&self) -> Vec<ScannedFile> {
+        let mut seen = HashSet::new();
+        let mut files = Vec::new();
+        let groups = [
+            (IndexedFileKind::Topos, &self.topos_patterns),
+            (IndexedFileKind::Lean, &self.lean_patterns),
+        ];
+        for (kind, patterns) in groups {
+            for pattern in patterns {
+                let full_pattern = self.project_root.join(pattern);
+                let Ok(entries) = glob::glob(full_pattern.to_str().unwrap_or("")) else {
+                    continue;
+                };
+                for path in entries.flatten() {
+                    let Ok(meta) = fs::metadata(&path) else {
+                        continue;
+                    };
+                    if !meta.is_file() || !seen.insert(path.clone()) {
+                        continue;
                     }
+                    // Use relative path
+                    let rel_path = path
+                        .strip_prefix(&self.project_root)
+                        .unwrap_or(&path)
+                        .to_path_buf();
+                    files.push(ScannedFile {
+                        kind,
+                        path,
+                        rel_path,
+                        len: meta.len(),
+                        mtime_ns: meta.modified().ok().and_then(unix_nanos),
+                    });
                 }
             }
         }
+        files
+    }
+
+    /// Read, hash and if needed parse `files`, in order, across threads.
+    fn rescan(&self, files: &[&ScannedFile], previous: &LinkIndex) -> Vec<Rescan> {
+        let rescan_one = |file: &ScannedFile| -> Rescan {
+            let Ok(content) = fs::read_to_string(&file.path) else {
+                return Rescan::Unreadable;
+            };
+            let hash = format!("{:x}", Sha256::digest(content.as_bytes()));
+            let same = previous
+                .metadata
+                .files
+                .get(&file.rel_path)
+                .is_some_and(|prev| prev.kind == file.kind && prev.content_hash == hash);
+            if same {
+                return Rescan::Same(hash);
+            }
+            let links = match file.kind {
+                IndexedFileKind::Topos => LinkIndex::topos_file_links(&file.rel_path, &content),
+                IndexedFileKind::Lean => LinkIndex::lean_file_links(&file.rel_path, &content),
+            };
+            Rescan::Parsed(hash, links)
+        };
+
+        let total_bytes: u64 = files.iter().map(|f| f.len).sum();
+        let workers = self
+            .threads
+            .unwrap_or_else(|| std::thread::available_parallelism().map_or(1, |n| n.get()))
+            .min(files.len());
+        if workers <= 1 || total_bytes < PARALLEL_SCAN_MIN_BYTES {
+            return files.iter().map(|f| rescan_one(f)).collect();
+        }
 
-        index.touch();
-        Ok(index)
+        let chunk_size = files.len().div_ceil(workers);
+        let rescan_one = &rescan_one;
+        std::thread::scope(|scope| {
+            let workers: Vec<_> = files
+                .chunks(chunk_size)
+                .map(|chunk| {
+                    scope.spawn(move || chunk.iter().map(|f| rescan_one(f)).collect::<Vec<_>>())
+                })
+                .collect();
+            workers
+                .into_iter()
+                .flat_map(|worker| {
+                    worker
+                        .join()
+                        .unwrap_or_else(|panic| std::panic::resume_unwind(panic))
+                })
+                .collect()
+        })
     }
 }
 
+fn unix_nanos(time: std::time::SystemTime) -> Option<u64> {
+    time.duration_since(UNIX_EPOCH)
+        .ok()
+        .and_then(|d| u64::try_from(d.as_nanos()).ok())
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -529,4 +807,90 @@ structure Order where
         let artifact = LinkIndex::find_lean_artifact_context(&lines, 1);
         assert_eq!(artifact, Some("Order".to_string()));
     }
+
+    fn write_project(dir: &Path, files: &[(&str, &str)]) {
+        for (name, content) in files {
+            let path = dir.join(name);
+            fs::create_dir_all(path.parent().unwrap()).unwrap();
+            fs::write(path, content).unwrap();
+        }
+    }
+
+    const ORDER_TPS: &str = "Concept Order:\n  id: `OrderId`\n  @lean: Order.lean#Order\n";
+    const ORDER_LEAN: &str =
+        "/--\n@topos: orders.tps#Order\n-/\nstructure Order where\n  id : Nat\n";
+
+    #[test]
+    fn test_incremental_update() {
+        let dir = tempfile::tempdir().unwrap();
+        write_project(
+            dir.path(),
+            &[("orders.tps", ORDER_TPS), ("Order.lean", ORDER_LEAN)],
+        );
+
+        let first = IndexBuilder::new(dir.path()).build().unwrap();
+        assert_eq!(first.len(), 2);
+        assert_eq!(first.metadata().files.len(), 2);
+        assert_eq!(first.metadata().reparsed_file_count, 2);
+
+        // Nothing changed: every file is reused without parsing.
+        let mut synthesized = first.clone();
+        synthesized.add_link(Link::new(
+            ToposRef::new("orders.tps", "Order"),
+            LeanRef::new("Order.lean", "order_valid"),
+            LinkType::Theorem,
+            LinkSource::Synthesized,
+        ));
+        let second = IndexBuilder::new(dir.path()).update(&synthesized).unwrap();
+        assert_eq!(second.metadata().reparsed_file_count, 0);
+        assert_eq!(second.len(), 3);
+        assert_eq!(
+            second.links_for_topos_file(Path::new("orders.tps")).len(),
+            3
+        );
+
+        // One file edited, one removed.
+        write_project(
+            dir.path(),
+            &[(
+                "orders.tps",
+                "Concept Order:\n  @lean: Order.lean#Order\n\nBehavior ship:\n  @lean: Order.lean#ship_spec\n",
+            )],
+        );
+        fs::remove_file(dir.path().join("Order.lean")).unwrap();
+        let third = IndexBuilder::new(dir.path()).update(&second).unwrap();
+        assert_eq!(third.metadata().reparsed_file_count, 1);
+        assert_eq!(third.metadata().files.len(), 1);
+        assert_eq!(third.metadata().lean_file_count, 0);
+        assert_eq!(third.links_by_source(LinkSource::Topos).len(), 2);
+        assert!(third.links_by_source(LinkSource::Lean).is_empty());
+        assert_eq!(third.links_by_source(LinkSource::Synthesized).len(), 1);
+    }
+
+    #[test]
+    fn test_parallel_build_matches_serial() {
+        let dir = tempfile::tempdir().unwrap();
+        let padding = "-- filler line for a larger file\n".repeat(300);
+        let files: Vec<(String, String)> = (0..64)
+            .map(|i| {
+                (
+                    format!("specs/S{i}.lean"),
+                    format!(
+                        "/--\n@topos: spec.tps#Item{i}\n-/\nstructure Item{i} where\n{padding}"
+                    ),
+                )
+            })
+            .collect();
+        let files: Vec<(&str, &str)> = files
+            .iter()
+            .map(|(name, content)| (name.as_str(), content.as_str()))
+            .collect();
+        write_project(dir.path(), &files);
+
+        let serial = IndexBuilder::new(dir.path()).threads(1).build().unwrap();
+        let parallel = IndexBuilder::new(dir.path()).threads(8).build().unwrap();
+        assert_eq!(serial.len(), 64);
+        assert_eq!(serial.all_links(), parallel.all_links());
+        assert_eq!(serial.metadata().files, parallel.metadata().files);
+    }
 }
@@ -0,0 +1,618 @@
+//! Compact binary persistence for the link index, read through `mmap`.
+//!
+//! [`LinkIndex::save_mapped`] writes the index as fixed-size records plus a
+//! deduplicated string table. [`MappedLinkIndex`] maps that file and answers
+//! lookups in place: a key lookup is a binary search over the sorted key
+//! table, and only the matching links are decoded.
+//!
+//! Layout (all integers little-endian, sections back to back):
+//!
+//! ```text
+//! header      MAGIC, version u32, reserved u32, then u64 counts of links,
+//!             topos keys, lean keys, postings and string bytes, and the
+//!             metadata JSON as a string ref
+//! links       LINK_LEN bytes each, in insertion order
+//! topos keys  KEY_LEN bytes each, sorted by canonical key bytes
+//! lean keys   KEY_LEN bytes each, sorted by canonical key bytes
+//! postings    u32 link indices; each key owns a contiguous run
+//! strings     UTF-8 bytes addressed by (offset u32, len u32) refs
+//! ```
+
+use std::collections::{BTreeMap, HashMap};
+use std::fs::{self, File, OpenOptions};
+use std::io::Write;
+use std::path::{Path, PathBuf};
+use std::sync::atomic::{AtomicU64, Ordering};
+
+use memmap2::Mmap;
+
+use super::index::{IndexMetadata, LinkIndex};
+use super::types::{LeanRef, Link, LinkMetadata, LinkSource, LinkType, ToposRef};
+use crate::error::{Error, Result};
+
+/// First bytes of a binary link index.
+pub(super) const MAGIC: &[u8; 8] = b"RLMLINKS";
+const VERSION: u32 = 1;
+
+const HEADER_LEN: usize = 64;
+/// Header offset of the five section counts.
+const HEADER_COUNTS: usize = 16;
+/// Header offset of the metadata string ref.
+const HEADER_METADATA: usize = 56;
+const LINK_LEN: usize = 80;
+const KEY_LEN: usize = 16;
+const STR_REF_LEN: usize = 8;
+
+/// Offset marking an absent optional string or number.
+const NONE: u32 = u32::MAX;
+
+// Byte offsets inside a link record.
+const LINK_TOPOS_FILE: usize = 0;
+const LINK_TOPOS_ELEMENT: usize = 8;
+const LINK_TOPOS_SUB: usize = 16;
+const LINK_LEAN_FILE: usize = 24;
+const LINK_LEAN_ARTIFACT: usize = 32;
+const LINK_LEAN_NAMESPACE: usize = 40;
+const LINK_NOTES: usize = 48;
+const LINK_SPEC_ID: usize = 56;
+const LINK_LINE: usize = 64;
+const LINK_COLUMN: usize = 68;
+const LINK_TYPE: usize = 72;
+const LINK_SOURCE: usize = 73;
+const LINK_FLAGS: usize = 74;
+
+const FLAG_METADATA: u8 = 1;
+
+fn corrupt(what: &str) -> Error {
+    Error::Internal(format!("Corrupt link index: {}", what))
+}
+
+fn link_type_code(t: LinkType) -> u8 {
+    match t {
+        LinkType::Structure => 0,
+        LinkType::FunctionSpec => 1,
+        LinkType::Theorem => 2,
+        LinkType::FieldInvariant => 3,
+        LinkType::Property => 4,
+        LinkType::Annotation => 5,
+    }
+}
+
+fn link_type_from_code(code: u8) -> Result<LinkType> {
+    Ok(match code {
+        0 => LinkType::Structure,
+        1 => LinkType::FunctionSpec,
+        2 => LinkType::Theorem,
+        3 => LinkType::FieldInvariant,
+        4 => LinkType::Property,
+        5 => LinkType::Annotation,
+        _ => return Err(corrupt("unknown link type")),
+    })
+}
+
+fn link_source_code(s: LinkSource) -> u8 {
+    match s {
+        LinkSource::Topos => 0,
+        LinkSource::Lean => 1,
+        LinkSource::Synthesized => 2,
+    }
+}
+
+fn link_source_from_code(code: u8) -> Result<LinkSource> {
+    Ok(match code {
+        0 => LinkSource::Topos,
+        1 => LinkSource::Lean,
+        2 => LinkSource::Synthesized,
+        _ => return Err(corrupt("unknown link source")),
+    })
+}
+
+/// Builds the deduplicated string table.
+#[derive(Default)]
+struct StringTable {
+    bytes: Vec<u8>,
+    offsets: HashMap<String, u32>,
+}
+
+impl StringTable {
+    fn put(&mut self, out: &mut Vec<u8>, s: &str) -> Result<()> {
+        let offset = match self.offsets.get(s) {
+            Some(&offset) => offset,
+            None => {
+                let offset = u32::try_from(self.bytes.len())
+                    .ok()
+                    .filter(|&o| o != NONE)
+                    .ok_or_else(|| Error::Internal("Link index strings exceed 4 GiB".into()))?;
+                self.bytes.extend_from_slice(s.as_bytes());
+                self.offsets.insert(s.to_string(), offset);
+                offset
+            }
+        };
+        let len = u32::try_from(s.len())
+            .map_err(|_| Error::Internal("Link index string exceeds 4 GiB".into()))?;
+        out.extend_from_slice(&offset.to_le_bytes());
+        out.extend_from_slice(&len.to_le_bytes());
+        Ok(())
+    }
+
+    fn put_opt(&mut self, out: &mut Vec<u8>, s: Option<&str>) -> Result<()> {
+        match s {
+            Some(s) => self.put(out, s),
+            None => {
+                out.extend_from_slice(&NONE.to_le_bytes());
+                out.extend_from_slice(&0u32.to_le_bytes());
+                Ok(())
+            }
+        }
+    }
+}
+
+fn path_str(path: &Path) -> String {
+    path.to_string_lossy().into_owned()
+}
+
+fn encode_link(link: &Link, strings: &mut StringTable, out: &mut Vec<u8>) -> Result<()> {
+    let start = out.len();
+    strings.put(out, &path_str(&link.topos.file))?;
+    strings.put(out, &link.topos.element)?;
+    strings.put_opt(out, link.topos.sub_element.as_deref())?;
+    strings.put(out, &path_str(&link.lean.file))?;
+    strings.put(out, &link.lean.artifact)?;
+    strings.put_opt(out, link.lean.namespace.as_deref())?;
+
+    let meta = link.metadata.as_ref();
+    strings.put_opt(out, meta.and_then(|m| m.notes.as_deref()))?;
+    strings.put_opt(out, meta.and_then(|m| m.spec_id.as_deref()))?;
+    let line = meta.and_then(|m| m.line).unwrap_or(NONE);
+    let column = meta.and_then(|m| m.column).unwrap_or(NONE);
+    out.extend_from_slice(&line.to_le_bytes());
+    out.extend_from_slice(&column.to_le_bytes());
+
+    let flags = if meta.is_some() { FLAG_METADATA } else { 0 };
+    out.extend_from_slice(&[
+        link_type_code(link.link_type),
+        link_source_code(link.source),
+        flags,
+    ]);
+    out.resize(start + LINK_LEN, 0);
+    Ok(())
+}
+
+fn encode_keys(
+    keys: &BTreeMap<String, Vec<u32>>,
+    strings: &mut StringTable,
+    postings: &mut Vec<u32>,
+    out: &mut Vec<u8>,
+) -> Result<()> {
+    for (key, links) in keys {
+        strings.put(out, key)?;
+        out.extend_from_slice(&(postings.len() as u32).to_le_bytes());
+        out.extend_from_slice(&(links.len() as u32).to_le_bytes());
+        postings.extend_from_slice(links);
+    }
+    Ok(())
+}
+
+/// Serialize `index` in the binary layout described in the module docs.
+pub(super) fn encode(index: &LinkIndex) -> Result<Vec<u8>> {
+    let links = index.all_links();
+    if u32::try_from(links.len()).is_err() {
+        return Err(Error::Internal("Link index has too many links".into()));
+    }
+
+    let mut topos_keys: BTreeMap<String, Vec<u32>> = BTreeMap::new();
+    let mut lean_keys: BTreeMap<String, Vec<u32>> = BTreeMap::new();
+    for (i, link) in links.iter().enumerate() {
+        let i = i as u32;
+        topos_keys
+            .entry(link.topos.to_string_canonical())
+            .or_default()
+            .push(i);
+        lean_keys
+            .entry(link.lean.to_string_canonical())
+            .or_default()
+            .push(i);
+    }
+
+    let mut strings = StringTable::default();
+    let mut body =
+        Vec::with_capacity(links.len() * LINK_LEN + (topos_keys.len() + lean_keys.len()) * KEY_LEN);
+    for link in links {
+        encode_link(link, &mut strings, &mut body)?;
+    }
+    let mut postings = Vec::with_capacity(links.len() * 2);
+    encode_keys(&topos_keys, &mut strings, &mut postings, &mut body)?;
+    encode_keys(&lean_keys, &mut strings, &mut postings, &mut body)?;
+
+    let metadata = serde_json::to_string(index.metadata()).map_err(Error::Serialization)?;
+    let mut metadata_ref = Vec::with_capacity(STR_REF_LEN);
+    strings.put(&mut metadata_ref, &metadata)?;
+
+    let mut out =
+        Vec::with_capacity(HEADER_LEN + body.len() + postings.len() * 4 + strings.bytes.len());
+    out.extend_from_slice(MAGIC);
+    out.extend_from_slice(&VERSION.to_le_bytes());
+    out.extend_from_slice(&0u32.to_le_bytes());
+    for count in [
+        links.len(),
+        topos_keys.len(),
+        lean_keys.len(),
+        postings.len(),
+        strings.bytes.len(),
+    ] {
+        out.extend_from_slice(&(count as u64).to_le_bytes());
+    }
+    debug_assert_eq!(out.len(), HEADER_METADATA);
+    out.extend_from_slice(&metadata_ref);
+    out.resize(HEADER_LEN, 0);
+    out.extend_from_slice(&body);
+    for posting in postings {
+        out.extend_from_slice(&posting.to_le_bytes());
+    }
+    out.extend_from_slice(&strings.bytes);
+    Ok(out)
+}
+
+/// Suffix counter for temporary index files.
+static NEXT_TMP: AtomicU64 = AtomicU64::new(0);
+
+/// Write `bytes` next to `path` and rename it into place, so a reader that
+/// has the old file mapped never sees it truncated.
+///
+/// The temporary name is unique per process and call, so concurrent saves
+/// never share a file, and the data is synced before the rename.
+pub(super) fn write_atomic(path: &Path, bytes: &[u8]) -> Result<()> {
+    let mut tmp = path.as_os_str().to_owned();
+    tmp.push(format!(
+        ".tmp{}-{}",
+        std::process::id(),
+        NEXT_TMP.fetch_add(1, Ordering::Relaxed)
+    ));
+    let tmp = PathBuf::from(tmp);
+    let result = OpenOptions::new()
+        .write(true)
+        .create_new(true)
+        .open(&tmp)
+        .and_then(|mut file| {
+            file.write_all(bytes)?;
+            file.sync_data()?;
+            fs::rename(&tmp, path)
+        });
+    if result.is_err() {
+        let _ = fs::remove_file(&tmp);
+    }
+    result.map_err(|e| Error::Internal(format!("Failed to save index: {}", e)))
+}
+
+/// Whether the file at `path` starts with the binary index magic.
+pub(super) fn is_mapped_file(path: &Path) -> bool {
+    use std::io::Read;
+    let mut magic = [0u8; MAGIC.len()];
+    File::open(path)
+        .and_then(|mut f| f.read_exact(&mut magic))
+        .map(|_| &magic == MAGIC)
+        .unwrap_or(false)
+}
+
+/// A link index file mapped into memory, queried without loading it.
+///
+/// Lookups decode only the links they return. The mapping stays valid while
+/// the file is replaced by [`LinkIndex::save_mapped`], which renames a new
+/// file into place rather than rewriting this one.
+pub struct MappedLinkIndex {
+    map: Mmap,
+    link_count: usize,
+    topos_key_count: usize,
+    lean_key_count: usize,
+    topos_keys_at: usize,
+    lean_keys_at: usize,
+    postings_at: usize,
+    posting_count: usize,
+    strings_at: usize,
+    strings_len: usize,
+}
+
+impl MappedLinkIndex {
+    /// Map the binary index at `path` and validate its layout.
+    pub fn open(path: &Path) -> Result<Self> {
+        let file = File::open(path)
+            .map_err(|e| Error::Internal(format!("Failed to load index: {}", e)))?;
+        // SAFETY: index files are only ever replaced by rename (see
+        // `write_atomic`), never modified in place, so the mapped bytes do
+        // not change underneath us.
+        let map = unsafe { Mmap::map(&file) }
+            .map_err(|e| Error::Internal(format!("Failed to map index: {}", e)))?;
+        Self::from_map(map)
+    }
+
+    fn from_map(map: Mmap) -> Result<Self> {
+        if map.len() < HEADER_LEN || &map[..MAGIC.len()] != MAGIC {
+            return Err(corrupt("bad header"));
+        }
+        let version = u32::from_le_bytes(map[8..12].try_into().unwrap());
+        if version != VERSION {
+            return Err(Error::Internal(format!(
+                "Unsupported link index version {}",
+                version
+            )));
+        }
+        let count = |at: usize| -> Result<usize> {
+            usize::try_from(u64::from_le_bytes(map[at..at + 8].try_into().unwrap()))
+                .map_err(|_| corrupt("count overflow"))
+        };
+        let link_count = count(HEADER_COUNTS)?;
+        let topos_key_count = count(HEADER_COUNTS + 8)?;
+        let lean_key_count = count(HEADER_COUNTS + 16)?;
+        let posting_count = count(HEADER_COUNTS + 24)?;
+        let strings_len = count(HEADER_COUNTS + 32)?;
+
+        let section = |at: usize, n: usize, size: usize| -> Result<usize> {
+            n.checked_mul(size)
+                .and_then(|len| at.checked_add(len))
+                .ok_or_else(|| corrupt("section overflow"))
+        };
+        let topos_keys_at = section(HEADER_LEN, link_count, LINK_LEN)?;
+        let lean_keys_at = section(topos_keys_at, topos_key_count, KEY_LEN)?;
+        let postings_at = section(lean_keys_at, lean_key_count, KEY_LEN)?;
+        let strings_at = section(postings_at, posting_count, 4)?;
+        if section(strings_at, strings_len, 1)? != map.len() {
+            return Err(corrupt("length mismatch"));
+        }
+
+        Ok(Self {
+            map,
+            link_count,
+            topos_key_count,
+            lean_key_count,
+            topos_keys_at,
+            lean_keys_at,
+            postings_at,
+            posting_count,
+            strings_at,
+            strings_len,
+        })
+    }
+
+    fn u32_at(&self, at: usize) -> u32 {
+        u32::from_le_bytes(self.map[at..at + 4].try_into().unwrap())
+    }
+
+    fn opt_str_at(&self, at: usize) -> Result<Option<&str>> {
+        let offset = self.u32_at(at);
+        if offset == NONE {
+            return Ok(None);
+        }
+        let (offset, len) = (offset as usize, self.u32_at(at + 4) as usize);
+        let end = offset
+            .checked_add(len)
+            .filter(|&end| end <= self.strings_len)
+            .ok_or_else(|| corrupt("string out of range"))?;
+        let bytes = &self.map[self.strings_at + offset..self.strings_at + end];
+        std::str::from_utf8(bytes)
+            .map(Some)
+            .map_err(|_| corrupt("invalid UTF-8"))
+    }
+
+    fn str_at(&self, at: usize) -> Result<&str> {
+        self.opt_str_at(at)?
+            .ok_or_else(|| corrupt("missing string"))
+    }
+
+    /// Number of links.
+    pub fn len(&self) -> usize {
+        self.link_count
+    }
+
+    /// Check if the index is empty.
+    pub fn is_empty(&self) -> bool {
+        self.link_count == 0
+    }
+
+    /// Decode the link at `index` in insertion order.
+    pub fn link(&self, index: usize) -> Result<Link> {
+        if index >= self.link_count {
+            return Err(Error::Internal(format!(
+                "Link {} out of range ({} links)",
+                index, self.link_count
+            )));
+        }
+        let at = HEADER_LEN + index * LINK_LEN;
+        let field = |offset: usize| at + offset;
+
+        let topos = ToposRef {
+            file: self.str_at(field(LINK_TOPOS_FILE))?.into(),
+            element: self.str_at(field(LINK_TOPOS_ELEMENT))?.to_string(),
+            sub_element: self.opt_str_at(field(LINK_TOPOS_SUB))?.map(str::to_string),
+        };
+        let lean = LeanRef {
+            file: self.str_at(field(LINK_LEAN_FILE))?.into(),
+            artifact: self.str_at(field(LINK_LEAN_ARTIFACT))?.to_string(),
+            namespace: self
+                .opt_str_at(field(LINK_LEAN_NAMESPACE))?
+                .map(str::to_string),
+        };
+        let number = |offset: usize| Some(self.u32_at(field(offset))).filter(|&n| n != NONE);
+        let metadata = if self.map[field(LINK_FLAGS)] & FLAG_METADATA != 0 {
+            Some(LinkMetadata {
+                line: number(LINK_LINE),
+                column: number(LINK_COLUMN),
+                notes: self.opt_str_at(field(LINK_NOTES))?.map(str::to_string),
+                spec_id: self.opt_str_at(field(LINK_SPEC_ID))?.map(str::to_string),
+            })
+        } else {
+            None
+        };
+
+        Ok(Link {
+            topos,
+            lean,
+            link_type: link_type_from_code(self.map[field(LINK_TYPE)])?,
+            source: link_source_from_code(self.map[field(LINK_SOURCE)])?,
+            metadata,
+        })
+    }
+
+    /// Links indexed under `key` in a sorted key table.
+    fn lookup(&self, table_at: usize, key_count: usize, key: &str) -> Result<Vec<Link>> {
+        let (mut lo, mut hi) = (0, key_count);
+        while lo < hi {
+            let mid = lo + (hi - lo) / 2;
+            let at = table_at + mid * KEY_LEN;
+            match self.str_at(at)?.as_bytes().cmp(key.as_bytes()) {
+                std::cmp::Ordering::Less => lo = mid + 1,
+                std::cmp::Ordering::Greater => hi = mid,
+                std::cmp::Ordering::Equal => {
+                    let first = self.u32_at(at + STR_REF_LEN) as usize;
+                    let n = self.u32_at(at + STR_REF_LEN + 4) as usize;
+                    if first.saturating_add(n) > self.posting_count {
+                        return Err(corrupt("postings out of range"));
+                    }
+                    return (first..first + n)
+                        .map(|p| self.link(self.u32_at(self.postings_at + p * 4) as usize))
+                        .collect();
+                }
+            }
+        }
+        Ok(Vec::new())
+    }
+
+    /// Get all Lean references for a Topos element.
+    pub fn get_lean_refs(&self, topos_ref: &ToposRef) -> Result<Vec<Link>> {
+        self.lookup(
+            self.topos_keys_at,
+            self.topos_key_count,
+            &topos_ref.to_string_canonical(),
+        )
+    }
+
+    /// Get all Topos references for a Lean artifact.
+    pub fn get_topos_refs(&self, lean_ref: &LeanRef) -> Result<Vec<Link>> {
+        self.lookup(
+            self.lean_keys_at,
+            self.lean_key_count,
+            &lean_ref.to_string_canonical(),
+        )
+    }
+
+    /// Decode the index metadata, including per-file change tracking.
+    pub fn metadata(&self) -> Result<IndexMetadata> {
+        let json = self.str_at(HEADER_METADATA)?;
+        serde_json::from_str(json).map_err(Error::Serialization)
+    }
+
+    /// Decode the whole file into a [`LinkIndex`].
+    pub fn to_index(&self) -> Result<LinkIndex> {
+        let links = (0..self.link_count)
+            .map(|i| self.link(i))
+            .collect::<Result<Vec<_>>>()?;
+        Ok(LinkIndex::from_parts(links, self.metadata()?))
+    }
+}
+
+impl std::fmt::Debug for MappedLinkIndex {
+    fn fmt(&self, f: &mut std::fmt::Formatter<'_>) -> std::fmt::Result {
+        f.debug_struct("MappedLinkIndex")
+            .field("links", &self.link_count)
+            .field("topos_keys", &self.topos_key_count)
+            .field("lean_keys", &self.lean_key_count)
+            .field("bytes", &self.map.len())
+            .finish()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn sample_index() -> LinkIndex {
+        let mut index = LinkIndex::with_project_root("/project");
+        index.add_link(
+            Link::new(
+                ToposRef::new("spec.tps", "Order"),
+                LeanRef::new("Order.lean", "Order"),
+                LinkType::Structure,
+                LinkSource::Topos,
+            )
+            .with_metadata(LinkMetadata::at_position(4, 2)),
+        );
+        index.add_link(Link::new(
+            ToposRef::with_sub_element("spec.tps", "Order", "status"),
+            LeanRef::with_namespace("Order.lean", "Order", "status_valid"),
+            LinkType::FieldInvariant,
+            LinkSource::Lean,
+        ));
+        index.add_link(Link::new(
+            ToposRef::new("spec.tps", "Order"),
+            LeanRef::new("Order.lean", "create_order_spec"),
+            LinkType::FunctionSpec,
+            LinkSource::Synthesized,
+        ));
+        index
+    }
+
+    #[test]
+    fn test_mapped_lookups_match_index() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("links.idx");
+        let index = sample_index();
+        index.save_mapped(&path).unwrap();
+
+        let mapped = MappedLinkIndex::open(&path).unwrap();
+        assert_eq!(mapped.len(), 3);
+
+        let order = ToposRef::new("spec.tps", "Order");
+        let expected: Vec<Link> = index.get_lean_refs(&order).into_iter().cloned().collect();
+        assert_eq!(mapped.get_lean_refs(&order).unwrap(), expected);
+        assert_eq!(expected.len(), 2);
+
+        let status = LeanRef::with_namespace("Order.lean", "Order", "status_valid");
+        assert_eq!(
+            mapped.get_topos_refs(&status).unwrap(),
+            vec![index.all_links()[1].clone()]
+        );
+        assert!(mapped
+            .get_lean_refs(&ToposRef::new("spec.tps", "Missing"))
+            .unwrap()
+            .is_empty());
+
+        let loaded = LinkIndex::load(&path).unwrap();
+        assert_eq!(loaded.all_links(), index.all_links());
+        assert_eq!(
+            loaded.metadata().project_root.as_deref(),
+            Some(Path::new("/project"))
+        );
+    }
+
+    #[test]
+    fn test_mapped_rejects_corrupt_files() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("links.idx");
+        let bytes = encode(&sample_index()).unwrap();
+
+        fs::write(&path, &bytes[..bytes.len() - 1]).unwrap();
+        assert!(MappedLinkIndex::open(&path).is_err());
+
+        fs::write(&path, b"{\"links\": []}").unwrap();
+        assert!(MappedLinkIndex::open(&path).is_err());
+        assert!(!is_mapped_file(&path));
+    }
+
+    #[test]
+    fn test_saves_replace_mapped_file() {
+        let dir = tempfile::tempdir().unwrap();
+        let path = dir.path().join("links.idx");
+        let index = sample_index();
+        index.save_mapped(&path).unwrap();
+        let mapped = MappedLinkIndex::open(&path).unwrap();
+
+        // Both formats rename a new file over the mapped one
+        LinkIndex::new().save(&path).unwrap();
+        assert_eq!(mapped.to_index().unwrap().all_links(), index.all_links());
+        assert!(LinkIndex::load(&path).unwrap().all_links().is_empty());
+        LinkIndex::new().save_mapped(&path).unwrap();
+        assert_eq!(mapped.len(), 3);
+
+        let entries: Vec<_> = fs::read_dir(dir.path()).unwrap().collect();
+        assert_eq!(entries.len(), 1, "temporary files are renamed away");
+    }
+}
@@ -36,13 +36,14 @@
 //!
 //! - [`types`]: Core types for references and links (`ToposRef`, `LeanRef`, `Link`)
 //! - [`parser`]: Annotation parser for `@lean` and `@topos` annotations
-//! - [`index`]: Bidirectional link index with persistence
+//! - [`index`]: Bidirectional link index with incremental, parallel builds
+//! - [`mapped`]: Binary index files queried through `mmap`
 //! - [`client`]: MCP client for the Topos server
 //!
 //! ## Example
 //!
 //! ```rust,ignore
-//! use rlm_core::topos::{LinkIndex, IndexBuilder, ToposClient};
+//! use rlm_core::topos::{IndexBuilder, LinkIndex, MappedLinkIndex, ToposClient};
 //!
 //! // Build index from project files
 //! let index = IndexBuilder::new("/path/to/project")
@@ -55,6 +56,13 @@
 //!     println!("Order links to: {}", link.lean);
 //! }
 //!
+//! // Rebuild after edits, reparsing only changed files, and persist the
+//! // index in the binary format that later runs query through mmap
+//! let index = IndexBuilder::new("/path/to/project").update(&index)?;
+//! index.save_mapped(Path::new(".topos/links.idx"))?;
+//! let mapped = MappedLinkIndex::open(Path::new(".topos/links.idx"))?;
+//! let order_links = mapped.get_lean_refs(&topos_ref)?;
+//!
 //! // Use MCP client for validation
 //! let client = ToposClient::from_env();
 //! client.connect().await?;
@@ -63,6 +71,7 @@
 
 pub mod client;
 pub mod index;
+pub mod mapped;
 pub mod parser;
 pub mod types;
 
@@ -71,6 +80,7 @@ pub use client::{
     CompiledContext, Diagnostic, DiagnosticSeverity, SpecSummary, ToposClient, ToposClientConfig,
     ValidationResult,
 };
-pub use index::{IndexBuilder, IndexMetadata, LinkIndex};
+pub use index::{IndexBuilder, IndexMetadata, IndexedFile, IndexedFileKind, LinkIndex};
+pub use mapped::MappedLinkIndex;
 pub use parser::{AnnotationParser, AnnotationType, ParsedAnnotation};
 pub use types::{LeanRef, Link, LinkMetadata, LinkSource, LinkType, ToposElementType, ToposRef};
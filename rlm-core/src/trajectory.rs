@@ -11,11 +11,20 @@
 //! - Cost tracking with budget management
 //! - Model pricing (Jan 2026)
 //! - Burn rate tracking and alerts
+//! - Streaming sinks (JSONL or binary log, C callbacks) via [`TrajectorySink`]
+
+mod sink;
+
+pub use sink::{
+    decode_binary, encode_binary, publish, subscribe, BinaryEventReader, EventFilter, SinkConfig,
+    SinkFormat, TrajectorySink, BINARY_MAGIC, BINARY_VERSION,
+};
 
 use chrono::{DateTime, Duration, Utc};
 use serde::{Deserialize, Serialize};
 use serde_json::Value;
 use std::collections::HashMap;
+use std::io::Write;
 use std::sync::{Arc, RwLock};
 use tokio::sync::broadcast;
 
@@ -109,6 +118,49 @@ impl std::fmt::Display for TrajectoryEventType {
     }
 }
 
+impl TrajectoryEventType {
+    /// Every event type in declaration order, which is also the order of
+    /// `RlmTrajectoryEventType` in the C API.
+    pub const ALL: [Self; 25] = [
+        Self::RlmStart,
+        Self::Analyze,
+        Self::ReplExec,
+        Self::ReplResult,
+        Self::Reason,
+        Self::RecurseStart,
+        Self::RecurseEnd,
+        Self::Final,
+        Self::Error,
+        Self::ToolUse,
+        Self::CostReport,
+        Self::VerifyStart,
+        Self::ClaimExtracted,
+        Self::EvidenceChecked,
+        Self::BudgetComputed,
+        Self::HallucinationFlag,
+        Self::VerifyComplete,
+        Self::Memory,
+        Self::Externalize,
+        Self::Decompose,
+        Self::Synthesize,
+        Self::AdversarialStart,
+        Self::CriticInvoked,
+        Self::IssueFound,
+        Self::AdversarialComplete,
+    ];
+
+    /// Stable numeric code: the index into [`Self::ALL`] and the bit
+    /// position in an [`EventFilter`].
+    pub fn code(self) -> u8 {
+        self as u8
+    }
+
+    /// Inverse of [`Self::code`].
+    pub fn from_code(code: u8) -> Option<Self> {
+        Self::ALL.get(code as usize).copied()
+    }
+}
+
 /// A trajectory event emitted during RLM execution.
 #[derive(Debug, Clone, PartialEq, Serialize, Deserialize)]
 pub struct TrajectoryEvent {
@@ -416,19 +468,36 @@ pub enum ExportFormat {
 
 /// Serialize a list of events to the specified format.
 pub fn export_events(events: &[TrajectoryEvent], format: ExportFormat) -> String {
+    let mut out = Vec::new();
+    match write_events(events, format, &mut out) {
+        Ok(()) => String::from_utf8(out).unwrap_or_default(),
+        Err(_) => match format {
+            ExportFormat::JsonPretty | ExportFormat::JsonCompact => "[]".to_string(),
+            _ => String::new(),
+        },
+    }
+}
+
+/// Stream a list of events to `writer` in the specified format, without
+/// building the whole export in memory first.
+pub fn write_events<W: Write>(
+    events: &[TrajectoryEvent],
+    format: ExportFormat,
+    mut writer: W,
+) -> std::io::Result<()> {
     match format {
-        ExportFormat::JsonLines => events
-            .iter()
-            .filter_map(|e| serde_json::to_string(e).ok())
-            .collect::<Vec<_>>()
-            .join("\n"),
-        ExportFormat::JsonPretty => {
-            serde_json::to_string_pretty(events).unwrap_or_else(|_| "[]".to_string())
-        }
-        ExportFormat::JsonCompact => {
-            serde_json::to_string(events).unwrap_or_else(|_| "[]".to_string())
+        ExportFormat::JsonLines => {
+            for (i, event) in events.iter().enumerate() {
+                if i > 0 {
+                    writer.write_all(b"\n")?;
+                }
+                serde_json::to_writer(&mut writer, event)?;
+            }
+            Ok(())
         }
-        ExportFormat::Markdown => events_to_markdown(events),
+        ExportFormat::JsonPretty => Ok(serde_json::to_writer_pretty(writer, events)?),
+        ExportFormat::JsonCompact => Ok(serde_json::to_writer(writer, events)?),
+        ExportFormat::Markdown => writer.write_all(events_to_markdown(events).as_bytes()),
     }
 }
 
@@ -851,6 +920,9 @@ pub trait TrajectoryEmitter: Send + Sync {
 }
 
 /// Broadcast-based trajectory emitter.
+///
+/// Emitted events also go to the process-wide bus (see [`subscribe`]), so
+/// sinks and C subscriptions observe them without holding the emitter.
 pub struct BroadcastEmitter {
     sender: broadcast::Sender<TrajectoryEvent>,
     verbosity: Verbosity,
@@ -875,12 +947,17 @@ impl BroadcastEmitter {
     pub fn subscriber_count(&self) -> usize {
         self.sender.receiver_count()
     }
+
+    fn send(&self, event: TrajectoryEvent) {
+        sink::forward_to_bus(&event);
+        let _ = self.sender.send(event);
+    }
 }
 
 impl TrajectoryEmitter for BroadcastEmitter {
     fn emit(&self, event: TrajectoryEvent) {
         if event.event_type.should_emit(self.verbosity) {
-            let _ = self.sender.send(event);
+            self.send(event);
         }
     }
 
@@ -906,7 +983,7 @@ impl TrajectoryEmitter for BroadcastEmitter {
             .with_metadata("alert", format!("{:?}", alert))
             .with_metadata("burn_rate", state.burn_rate_per_minute());
 
-        let _ = self.sender.send(event);
+        self.send(event);
     }
 
     fn verbosity(&self) -> Verbosity {
@@ -1033,6 +1110,19 @@ mod tests {
         assert_eq!(lines.len(), 2);
     }
 
+    #[test]
+    fn test_event_type_codes_roundtrip() {
+        for (i, event_type) in TrajectoryEventType::ALL.iter().enumerate() {
+            assert_eq!(event_type.code() as usize, i);
+            assert_eq!(TrajectoryEventType::from_code(i as u8), Some(*event_type));
+            assert_eq!(
+                crate::ffi::RlmTrajectoryEventType::from(*event_type) as usize,
+                i
+            );
+        }
+        assert_eq!(TrajectoryEventType::from_code(25), None);
+    }
+
     // =========================================================================
     // Model Pricing Tests
     // =========================================================================
@@ -0,0 +1,773 @@
+//! Streaming trajectory sinks.
+//!
+//! A [`TrajectorySink`] subscribes to a trajectory broadcast channel and
+//! delivers events to a writer or a callback on its own thread, so slow I/O
+//! or a slow UI never lags the channel. Events pass through a bounded
+//! single-producer/single-consumer ring; when the consumer falls behind, new
+//! events are dropped and counted instead of growing memory.
+//!
+//! Writers receive JSON Lines or a compact length-prefixed binary log. The
+//! binary log starts with the 8-byte header `RLMT` + version (1) + 3 zero
+//! bytes, followed by one record per event, all integers little-endian:
+//!
+//! ```text
+//! u32 record_len          bytes that follow in this record
+//! u8  event_type          TrajectoryEventType::code()
+//! u32 depth
+//! i64 timestamp           microseconds since the Unix epoch
+//! u32 content_len
+//! ..  content             UTF-8
+//! ..  metadata            JSON object, absent if the event has none
+//! ```
+//!
+//! [`BinaryEventReader`] reads the log back.
+
+use super::{TrajectoryEvent, TrajectoryEventType};
+use chrono::DateTime;
+use std::cell::UnsafeCell;
+use std::collections::HashMap;
+use std::future::Future;
+use std::io::{self, BufWriter, Read, Write};
+use std::mem::MaybeUninit;
+use std::path::Path;
+use std::pin::pin;
+use std::sync::atomic::{AtomicBool, AtomicU64, AtomicUsize, Ordering};
+use std::sync::{Arc, LazyLock};
+use std::task::Poll;
+use std::thread::{self, JoinHandle};
+use std::time::Duration;
+use tokio::sync::broadcast::{
+    self,
+    error::{RecvError, TryRecvError},
+};
+use tokio::sync::Notify;
+
+/// Magic bytes opening a binary trajectory log.
+pub const BINARY_MAGIC: [u8; 4] = *b"RLMT";
+
+/// Current binary log version.
+pub const BINARY_VERSION: u8 = 1;
+
+/// Capacity of the process-wide trajectory bus.
+const BUS_CAPACITY: usize = 1024;
+
+/// How long an idle consumer sleeps before re-checking the ring.
+const IDLE_WAIT: Duration = Duration::from_millis(50);
+
+static BUS: LazyLock<broadcast::Sender<TrajectoryEvent>> =
+    LazyLock::new(|| broadcast::channel(BUS_CAPACITY).0);
+
+/// Publish an event on the process-wide trajectory bus.
+///
+/// Returns the number of subscribers that will see it.
+pub fn publish(event: TrajectoryEvent) -> usize {
+    BUS.send(event).unwrap_or(0)
+}
+
+/// Subscribe to the process-wide trajectory bus.
+///
+/// The bus carries everything published with [`publish`] plus every event a
+/// [`BroadcastEmitter`](super::BroadcastEmitter) emits.
+pub fn subscribe() -> broadcast::Receiver<TrajectoryEvent> {
+    BUS.subscribe()
+}
+
+/// Copy `event` onto the bus if anything is subscribed, so emitters pay
+/// nothing for the bus while no sink is attached.
+pub(crate) fn forward_to_bus(event: &TrajectoryEvent) {
+    if BUS.receiver_count() > 0 {
+        let _ = BUS.send(event.clone());
+    }
+}
+
+/// Set of event types a sink accepts, one bit per [`TrajectoryEventType::code`].
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub struct EventFilter(u32);
+
+impl EventFilter {
+    /// Accept every event type.
+    pub const ALL: Self = Self(u32::MAX);
+
+    /// Build a filter from a bit mask; 0 accepts every event type.
+    pub fn from_mask(mask: u32) -> Self {
+        if mask == 0 {
+            Self::ALL
+        } else {
+            Self(mask)
+        }
+    }
+
+    /// Accept only the given event types.
+    pub fn only(types: &[TrajectoryEventType]) -> Self {
+        Self(types.iter().fold(0, |mask, t| mask | (1 << t.code())))
+    }
+
+    /// The underlying bit mask.
+    pub fn mask(self) -> u32 {
+        self.0
+    }
+
+    /// Whether events of type `event_type` pass the filter.
+    pub fn matches(self, event_type: TrajectoryEventType) -> bool {
+        self.0 & (1 << event_type.code()) != 0
+    }
+}
+
+impl Default for EventFilter {
+    fn default() -> Self {
+        Self::ALL
+    }
+}
+
+/// On-disk encoding for writer sinks.
+#[derive(Debug, Clone, Copy, PartialEq, Eq, Default)]
+pub enum SinkFormat {
+    /// One JSON event per line
+    #[default]
+    JsonLines,
+    /// Length-prefixed binary records (see the module docs)
+    Binary,
+}
+
+/// Sink tuning.
+#[derive(Debug, Clone, Copy)]
+pub struct SinkConfig {
+    /// Ring capacity in events; events beyond it are dropped
+    pub capacity: usize,
+    /// Maximum events encoded per write
+    pub batch_size: usize,
+    /// Event types to deliver
+    pub filter: EventFilter,
+}
+
+impl Default for SinkConfig {
+    fn default() -> Self {
+        Self {
+            capacity: 4096,
+            batch_size: 256,
+            filter: EventFilter::ALL,
+        }
+    }
+}
+
+/// Bounded lock-free ring with exactly one producer and one consumer.
+///
+/// `push` must only be called from the forwarding thread and `pop` only from
+/// the consuming thread; [`TrajectorySink`] upholds this.
+struct EventRing<T> {
+    slots: Box<[UnsafeCell<MaybeUninit<T>>]>,
+    /// Next position to read; written only by the consumer.
+    head: AtomicUsize,
+    /// Next position to write; written only by the producer.
+    tail: AtomicUsize,
+}
+
+// SAFETY: each slot is accessed by at most one thread at a time, handed over
+// through the release/acquire pair on `head` and `tail`.
+unsafe impl<T: Send> Send for EventRing<T> {}
+unsafe impl<T: Send> Sync for EventRing<T> {}
+
+impl<T> EventRing<T> {
+    fn new(capacity: usize) -> Self {
+        Self {
+            slots: (0..capacity.max(1))
+                .map(|_| UnsafeCell::new(MaybeUninit::uninit()))
+                .collect(),
+            head: AtomicUsize::new(0),
+            tail: AtomicUsize::new(0),
+        }
+    }
+
+    fn push(&self, value: T) -> std::result::Result<(), T> {
+        let tail = self.tail.load(Ordering::Relaxed);
+        if tail - self.head.load(Ordering::Acquire) == self.slots.len() {
+            return Err(value);
+        }
+        // SAFETY: the slot is free (the consumer has moved past it) and only
+        // this producer writes slots.
+        unsafe { (*self.slots[tail % self.slots.len()].get()).write(value) };
+        self.tail.store(tail + 1, Ordering::Release);
+        Ok(())
+    }
+
+    fn pop(&self) -> Option<T> {
+        let head = self.head.load(Ordering::Relaxed);
+        if head == self.tail.load(Ordering::Acquire) {
+            return None;
+        }
+        // SAFETY: the producer published this slot and will not touch it
+        // again until `head` moves past it.
+        let value = unsafe { (*self.slots[head % self.slots.len()].get()).assume_init_read() };
+        self.head.store(head + 1, Ordering::Release);
+        Some(value)
+    }
+
+    fn is_empty(&self) -> bool {
+        self.head.load(Ordering::Acquire) == self.tail.load(Ordering::Acquire)
+    }
+}
+
+impl<T> Drop for EventRing<T> {
+    fn drop(&mut self) {
+        while self.pop().is_some() {}
+    }
+}
+
+struct Shared {
+    ring: EventRing<TrajectoryEvent>,
+    stop: Notify,
+    forwarder_done: AtomicBool,
+    delivered: AtomicU64,
+    dropped: AtomicU64,
+}
+
+enum Target {
+    Writer {
+        out: BufWriter<Box<dyn Write + Send>>,
+        format: SinkFormat,
+        buf: Vec<u8>,
+    },
+    Callback(Box<dyn FnMut(TrajectoryEvent) + Send>),
+}
+
+impl Target {
+    fn deliver(&mut self, batch: &mut Vec<TrajectoryEvent>) -> io::Result<()> {
+        match self {
+            Self::Writer { out, format, buf } => {
+                buf.clear();
+                for event in batch.iter() {
+                    match format {
+                        SinkFormat::JsonLines => {
+                            serde_json::to_writer(&mut *buf, event)?;
+                            buf.push(b'\n');
+                        }
+                        SinkFormat::Binary => encode_binary(event, buf)?,
+                    }
+                }
+                batch.clear();
+                out.write_all(buf)
+            }
+            Self::Callback(callback) => {
+                batch.drain(..).for_each(|event| callback(event));
+                Ok(())
+            }
+        }
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        match self {
+            Self::Writer { out, .. } => out.flush(),
+            Self::Callback(_) => Ok(()),
+        }
+    }
+}
+
+/// A running trajectory sink.
+///
+/// Dropping the sink stops it after delivering the events already buffered;
+/// use [`TrajectorySink::close`] to also observe write errors.
+pub struct TrajectorySink {
+    shared: Arc<Shared>,
+    forwarder: Option<JoinHandle<()>>,
+    consumer: Option<JoinHandle<io::Result<()>>>,
+}
+
+impl TrajectorySink {
+    /// Stream events from `receiver` into `writer`.
+    pub fn to_writer<W: Write + Send + 'static>(
+        receiver: broadcast::Receiver<TrajectoryEvent>,
+        writer: W,
+        format: SinkFormat,
+        config: SinkConfig,
+    ) -> io::Result<Self> {
+        let mut out = BufWriter::new(Box::new(writer) as Box<dyn Write + Send>);
+        if format == SinkFormat::Binary {
+            out.write_all(&binary_header())?;
+        }
+        Self::spawn(
+            receiver,
+            Target::Writer {
+                out,
+                format,
+                buf: Vec::new(),
+            },
+            config,
+        )
+    }
+
+    /// Stream events from `receiver` into the file at `path`, appending if it
+    /// exists.
+    pub fn to_file(
+        receiver: broadcast::Receiver<TrajectoryEvent>,
+        path: impl AsRef<Path>,
+        format: SinkFormat,
+        config: SinkConfig,
+    ) -> io::Result<Self> {
+        let file = std::fs::OpenOptions::new()
+            .create(true)
+            .append(true)
+            .open(path)?;
+        // Only a fresh binary log gets a header; appending continues the
+        // existing record stream.
+        let format_needs_header = format == SinkFormat::Binary && file.metadata()?.len() == 0;
+        let mut out = BufWriter::new(Box::new(file) as Box<dyn Write + Send>);
+        if format_needs_header {
+            out.write_all(&binary_header())?;
+        }
+        Self::spawn(
+            receiver,
+            Target::Writer {
+                out,
+                format,
+                buf: Vec::new(),
+            },
+            config,
+        )
+    }
+
+    /// Deliver events from `receiver` to `callback`, in order, on the sink's
+    /// consumer thread.
+    pub fn to_callback<F: FnMut(TrajectoryEvent) + Send + 'static>(
+        receiver: broadcast::Receiver<TrajectoryEvent>,
+        callback: F,
+        config: SinkConfig,
+    ) -> io::Result<Self> {
+        Self::spawn(receiver, Target::Callback(Box::new(callback)), config)
+    }
+
+    fn spawn(
+        receiver: broadcast::Receiver<TrajectoryEvent>,
+        mut target: Target,
+        config: SinkConfig,
+    ) -> io::Result<Self> {
+        let shared = Arc::new(Shared {
+            ring: EventRing::new(config.capacity),
+            stop: Notify::new(),
+            forwarder_done: AtomicBool::new(false),
+            delivered: AtomicU64::new(0),
+            dropped: AtomicU64::new(0),
+        });
+
+        let batch_size = config.batch_size.max(1);
+        let consumer_shared = Arc::clone(&shared);
+        let consumer = thread::Builder::new()
+            .name("rlm-trajectory-sink".to_string())
+            .spawn(move || consume(&consumer_shared, &mut target, batch_size))?;
+
+        let consumer_thread = consumer.thread().clone();
+        let forwarder_shared = Arc::clone(&shared);
+        let forwarder = thread::Builder::new()
+            .name("rlm-trajectory-forward".to_string())
+            .spawn(move || {
+                forward(receiver, &forwarder_shared, config.filter, &consumer_thread);
+                forwarder_shared
+                    .forwarder_done
+                    .store(true, Ordering::Release);
+                consumer_thread.unpark();
+            });
+        let forwarder = match forwarder {
+            Ok(handle) => handle,
+            Err(e) => {
+                shared.forwarder_done.store(true, Ordering::Release);
+                consumer.thread().unpark();
+                let _ = consumer.join();
+                return Err(e);
+            }
+        };
+
+        Ok(Self {
+            shared,
+            forwarder: Some(forwarder),
+            consumer: Some(consumer),
+        })
+    }
+
+    /// Events handed to the writer or callback so far.
+    pub fn delivered(&self) -> u64 {
+        self.shared.delivered.load(Ordering::Relaxed)
+    }
+
+    /// Events lost because the ring was full or the channel lagged.
+    pub fn dropped(&self) -> u64 {
+        self.shared.dropped.load(Ordering::Relaxed)
+    }
+
+    /// Stop the sink, deliver buffered events, flush, and report the first
+    /// write error, if any.
+    pub fn close(mut self) -> io::Result<()> {
+        self.shutdown()
+    }
+
+    fn shutdown(&mut self) -> io::Result<()> {
+        self.shared.stop.notify_one();
+        if let Some(forwarder) = self.forwarder.take() {
+            let _ = forwarder.join();
+        }
+        match self.consumer.take().map(JoinHandle::join) {
+            Some(Ok(result)) => result,
+            Some(Err(_)) => Err(io::Error::other("trajectory sink consumer panicked")),
+            None => Ok(()),
+        }
+    }
+}
+
+impl Drop for TrajectorySink {
+    fn drop(&mut self) {
+        let _ = self.shutdown();
+    }
+}
+
+fn forward(
+    mut receiver: broadcast::Receiver<TrajectoryEvent>,
+    shared: &Shared,
+    filter: EventFilter,
+    consumer: &thread::Thread,
+) {
+    let accept = |event: TrajectoryEvent| {
+        if !filter.matches(event.event_type) {
+            return;
+        }
+        if shared.ring.push(event).is_err() {
+            shared.dropped.fetch_add(1, Ordering::Relaxed);
+        } else {
+            consumer.unpark();
+        }
+    };
+
+    // `notify_one` stores a permit, so a stop requested before this future is
+    // first polled is still observed.
+    let mut stopped = pin!(shared.stop.notified());
+    loop {
+        let mut recv = pin!(receiver.recv());
+        // Poll the stop signal first so a busy channel cannot starve it.
+        let next = futures::executor::block_on(std::future::poll_fn(|cx| {
+            if stopped.as_mut().poll(cx).is_ready() {
+                return Poll::Ready(None);
+            }
+            recv.as_mut().poll(cx).map(Some)
+        }));
+        match next {
+            Some(Ok(event)) => accept(event),
+            Some(Err(RecvError::Lagged(n))) => {
+                shared.dropped.fetch_add(n, Ordering::Relaxed);
+            }
+            Some(Err(RecvError::Closed)) => return,
+            None => break,
+        }
+    }
+
+    // Hand over what was already queued when the stop arrived, bounded by
+    // the ring size so producers that keep publishing cannot stall `close`.
+    for _ in 0..shared.ring.slots.len() {
+        match receiver.try_recv() {
+            Ok(event) => accept(event),
+            Err(TryRecvError::Lagged(n)) => {
+                shared.dropped.fetch_add(n, Ordering::Relaxed);
+            }
+            Err(TryRecvError::Empty | TryRecvError::Closed) => return,
+        }
+    }
+}
+
+fn consume(shared: &Shared, target: &mut Target, batch_size: usize) -> io::Result<()> {
+    let mut batch = Vec::with_capacity(batch_size);
+    loop {
+        while batch.len() < batch_size {
+            match shared.ring.pop() {
+                Some(event) => batch.push(event),
+                None => break,
+            }
+        }
+        if !batch.is_empty() {
+            let count = batch.len() as u64;
+            target.deliver(&mut batch)?;
+            shared.delivered.fetch_add(count, Ordering::Relaxed);
+            if shared.ring.is_empty() {
+                target.flush()?;
+            }
+            continue;
+        }
+        if shared.forwarder_done.load(Ordering::Acquire) {
+            if shared.ring.is_empty() {
+                return target.flush();
+            }
+            continue;
+        }
+        thread::park_timeout(IDLE_WAIT);
+    }
+}
+
+fn binary_header() -> [u8; 8] {
+    let mut header = [0u8; 8];
+    header[..4].copy_from_slice(&BINARY_MAGIC);
+    header[4] = BINARY_VERSION;
+    header
+}
+
+fn invalid_data(message: impl Into<String>) -> io::Error {
+    io::Error::new(io::ErrorKind::InvalidData, message.into())
+}
+
+/// Append one binary record for `event` to `out`.
+pub fn encode_binary(event: &TrajectoryEvent, out: &mut Vec<u8>) -> io::Result<()> {
+    let start = out.len();
+    out.extend_from_slice(&[0; 4]);
+    out.push(event.event_type.code());
+    out.extend_from_slice(&event.depth.to_le_bytes());
+    out.extend_from_slice(&event.timestamp.timestamp_micros().to_le_bytes());
+    let content_len = u32::try_from(event.content.len())
+        .map_err(|_| invalid_data("trajectory event content exceeds 4 GiB"))?;
+    out.extend_from_slice(&content_len.to_le_bytes());
+    out.extend_from_slice(event.content.as_bytes());
+    if let Some(ref metadata) = event.metadata {
+        serde_json::to_writer(&mut *out, metadata)?;
+    }
+    let record_len = u32::try_from(out.len() - start - 4)
+        .map_err(|_| invalid_data("trajectory event record exceeds 4 GiB"))?;
+    out[start..start + 4].copy_from_slice(&record_len.to_le_bytes());
+    Ok(())
+}
+
+/// Decode one binary record body (without its length prefix).
+pub fn decode_binary(record: &[u8]) -> io::Result<TrajectoryEvent> {
+    const FIXED: usize = 1 + 4 + 8 + 4;
+    if record.len() < FIXED {
+        return Err(invalid_data("truncated trajectory record"));
+    }
+    let event_type = TrajectoryEventType::from_code(record[0])
+        .ok_or_else(|| invalid_data(format!("unknown trajectory event type {}", record[0])))?;
+    let depth = u32::from_le_bytes(record[1..5].try_into().expect("4 bytes"));
+    let micros = i64::from_le_bytes(record[5..13].try_into().expect("8 bytes"));
+    let content_len = u32::from_le_bytes(record[13..17].try_into().expect("4 bytes")) as usize;
+    let rest = &record[FIXED..];
+    if rest.len() < content_len {
+        return Err(invalid_data("truncated trajectory record content"));
+    }
+    let content = std::str::from_utf8(&rest[..content_len])
+        .map_err(|e| invalid_data(format!("trajectory record content is not UTF-8: {}", e)))?;
+    let metadata = &rest[content_len..];
+    let metadata: Option<HashMap<String, serde_json::Value>> = if metadata.is_empty() {
+        None
+    } else {
+        Some(serde_json::from_slice(metadata)?)
+    };
+
+    Ok(TrajectoryEvent {
+        event_type,
+        depth,
+        content: content.to_string(),
+        metadata,
+        timestamp: DateTime::from_timestamp_micros(micros)
+            .ok_or_else(|| invalid_data("trajectory record timestamp out of range"))?,
+    })
+}
+
+/// Streaming reader for binary trajectory logs.
+pub struct BinaryEventReader<R> {
+    reader: R,
+    record: Vec<u8>,
+}
+
+impl<R: Read> BinaryEventReader<R> {
+    /// Validate the log header and position the reader at the first record.
+    pub fn new(mut reader: R) -> io::Result<Self> {
+        let mut header = [0u8; 8];
+        reader.read_exact(&mut header)?;
+        if header[..4] != BINARY_MAGIC {
+            return Err(invalid_data("not a binary trajectory log"));
+        }
+        if header[4] != BINARY_VERSION {
+            return Err(invalid_data(format!(
+                "unsupported trajectory log version {}",
+                header[4]
+            )));
+        }
+        Ok(Self {
+            reader,
+            record: Vec::new(),
+        })
+    }
+
+    fn next_record(&mut self) -> io::Result<Option<TrajectoryEvent>> {
+        let mut len = [0u8; 4];
+        let mut filled = 0;
+        while filled < len.len() {
+            match self.reader.read(&mut len[filled..]) {
+                Ok(0) if filled == 0 => return Ok(None),
+                Ok(0) => return Err(invalid_data("truncated trajectory record length")),
+                Ok(n) => filled += n,
+                Err(e) if e.kind() == io::ErrorKind::Interrupted => {}
+                Err(e) => return Err(e),
+            }
+        }
+        self.record.resize(u32::from_le_bytes(len) as usize, 0);
+        self.reader.read_exact(&mut self.record)?;
+        decode_binary(&self.record).map(Some)
+    }
+}
+
+impl<R: Read> Iterator for BinaryEventReader<R> {
+    type Item = io::Result<TrajectoryEvent>;
+
+    fn next(&mut self) -> Option<Self::Item> {
+        self.next_record().transpose()
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::sync::Mutex;
+
+    /// Writer that appends into a shared buffer.
+    #[derive(Clone, Default)]
+    struct SharedBuf(Arc<Mutex<Vec<u8>>>);
+
+    impl Write for SharedBuf {
+        fn write(&mut self, data: &[u8]) -> io::Result<usize> {
+            self.0.lock().unwrap().extend_from_slice(data);
+            Ok(data.len())
+        }
+
+        fn flush(&mut self) -> io::Result<()> {
+            Ok(())
+        }
+    }
+
+    #[test]
+    fn test_ring_is_bounded_and_fifo() {
+        let ring = EventRing::new(2);
+        assert!(ring.push(1).is_ok());
+        assert!(ring.push(2).is_ok());
+        assert_eq!(ring.push(3), Err(3));
+        assert_eq!(ring.pop(), Some(1));
+        assert!(ring.push(3).is_ok());
+        assert_eq!(ring.pop(), Some(2));
+        assert_eq!(ring.pop(), Some(3));
+        assert_eq!(ring.pop(), None);
+        assert!(ring.is_empty());
+    }
+
+    #[test]
+    fn test_binary_roundtrip() {
+        let events = vec![
+            TrajectoryEvent::rlm_start("Analyze the auth flow"),
+            TrajectoryEvent::repl_result(2, "ok", true),
+            TrajectoryEvent::final_answer(0, ""),
+        ];
+        let mut log = binary_header().to_vec();
+        for event in &events {
+            encode_binary(event, &mut log).unwrap();
+        }
+
+        let decoded: Vec<_> = BinaryEventReader::new(log.as_slice())
+            .unwrap()
+            .collect::<io::Result<_>>()
+            .unwrap();
+        assert_eq!(decoded.len(), events.len());
+        for (decoded, original) in decoded.iter().zip(&events) {
+            assert_eq!(decoded.event_type, original.event_type);
+            assert_eq!(decoded.depth, original.depth);
+            assert_eq!(decoded.content, original.content);
+            assert_eq!(decoded.metadata, original.metadata);
+            assert_eq!(
+                decoded.timestamp.timestamp_micros(),
+                original.timestamp.timestamp_micros()
+            );
+        }
+
+        assert!(BinaryEventReader::new(&b"NOPE\x01\0\0\0"[..]).is_err());
+        log.truncate(log.len() - 1);
+        let result: io::Result<Vec<_>> = BinaryEventReader::new(log.as_slice()).unwrap().collect();
+        assert!(result.is_err());
+    }
+
+    #[test]
+    fn test_writer_sink_streams_filtered_jsonl() {
+        let (sender, receiver) = broadcast::channel(64);
+        let buf = SharedBuf::default();
+        let config = SinkConfig {
+            filter: EventFilter::only(&[TrajectoryEventType::RlmStart, TrajectoryEventType::Final]),
+            ..SinkConfig::default()
+        };
+        let sink = TrajectorySink::to_writer(receiver, buf.clone(), SinkFormat::JsonLines, config)
+            .unwrap();
+
+        sender.send(TrajectoryEvent::rlm_start("q")).unwrap();
+        sender.send(TrajectoryEvent::reason(1, "skipped")).unwrap();
+        sender
+            .send(TrajectoryEvent::final_answer(0, "done"))
+            .unwrap();
+        drop(sender);
+        sink.close().unwrap();
+
+        let text = String::from_utf8(buf.0.lock().unwrap().clone()).unwrap();
+        let types: Vec<_> = text
+            .lines()
+            .map(|line| {
+                serde_json::from_str::<TrajectoryEvent>(line)
+                    .unwrap()
+                    .event_type
+            })
+            .collect();
+        assert_eq!(
+            types,
+            vec![TrajectoryEventType::RlmStart, TrajectoryEventType::Final]
+        );
+    }
+
+    #[test]
+    fn test_callback_sink_receives_bus_events() {
+        let seen = Arc::new(Mutex::new(Vec::new()));
+        let seen_by_sink = Arc::clone(&seen);
+        let sink = TrajectorySink::to_callback(
+            subscribe(),
+            move |event| seen_by_sink.lock().unwrap().push(event.content),
+            SinkConfig {
+                filter: EventFilter::only(&[TrajectoryEventType::IssueFound]),
+                ..SinkConfig::default()
+            },
+        )
+        .unwrap();
+
+        assert!(
+            publish(TrajectoryEvent::new(
+                TrajectoryEventType::IssueFound,
+                0,
+                "bus-event"
+            )) >= 1
+        );
+        let deadline = std::time::Instant::now() + Duration::from_secs(5);
+        while sink.delivered() == 0 && std::time::Instant::now() < deadline {
+            thread::sleep(Duration::from_millis(5));
+        }
+        sink.close().unwrap();
+        assert!(seen.lock().unwrap().contains(&"bus-event".to_string()));
+    }
+
+    #[test]
+    fn test_close_returns_while_events_keep_arriving() {
+        let (sender, receiver) = broadcast::channel(64);
+        let sink = TrajectorySink::to_callback(receiver, |_| {}, SinkConfig::default()).unwrap();
+
+        let running = Arc::new(AtomicBool::new(true));
+        let producer = {
+            let running = Arc::clone(&running);
+            thread::spawn(move || {
+                while running.load(Ordering::Relaxed) {
+                    let _ = sender.send(TrajectoryEvent::reason(1, "busy"));
+                }
+            })
+        };
+        while sink.delivered() == 0 {
+            thread::sleep(Duration::from_millis(1));
+        }
+
+        let (done_tx, done_rx) = std::sync::mpsc::channel();
+        thread::spawn(move || done_tx.send(sink.close()).unwrap());
+        let closed = done_rx.recv_timeout(Duration::from_secs(5));
+        running.store(false, Ordering::Relaxed);
+        producer.join().unwrap();
+        assert!(matches!(closed, Ok(Ok(()))), "close hung under load");
+    }
+}
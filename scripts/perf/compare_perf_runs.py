@@ -105,6 +105,30 @@ def throughput_check(
     }
 
 
+def native_checks(
+    baseline_runs: list[dict[str, Any]],
+    candidate_runs: list[dict[str, Any]],
+    budget_pct: float,
+    min_abs_latency_ms: float,
+) -> tuple[dict[str, Any], list[str]]:
+    """Latency checks for every native metric the baseline measured."""
+    baseline_names = set.intersection(*(set(run["metrics"]) for run in baseline_runs))
+    candidate_names = set.intersection(*(set(run["metrics"]) for run in candidate_runs))
+    checks: dict[str, Any] = {}
+    for name in sorted(baseline_names):
+        if name not in candidate_names:
+            checks[name] = {"missing_in_candidate": True, "pass": False}
+            continue
+        for stat in ("p50_ms", "p95_ms"):
+            checks[f"{name}:{stat[:3]}"] = latency_check(
+                aggregate_median(baseline_runs, "metrics", name, stat),
+                aggregate_median(candidate_runs, "metrics", name, stat),
+                budget_pct,
+                min_abs_latency_ms,
+            )
+    return checks, sorted(candidate_names - baseline_names)
+
+
 def main() -> None:
     parser = argparse.ArgumentParser(description=__doc__)
     parser.add_argument(
@@ -126,20 +150,45 @@ def main() -> None:
     parser.add_argument("--min-abs-latency-ms", type=float, default=2.0)
     parser.add_argument("--min-abs-throughput-drop-ops", type=float, default=150.0)
     parser.add_argument("--max-error-rate-delta", type=float, default=0.01)
+    parser.add_argument(
+        "--native-baseline",
+        type=parse_run_files,
+        help="Comma-separated native_perf_harness.py baseline run JSON file(s)",
+    )
+    parser.add_argument(
+        "--native-candidate",
+        type=parse_run_files,
+        help="Comma-separated native_perf_harness.py candidate run JSON file(s)",
+    )
+    parser.add_argument("--vg-perf-004-out")
+    parser.add_argument(
+        "--min-abs-native-latency-ms",
+        type=float,
+        default=0.001,
+        help="Absolute floor for native C ABI latency regressions",
+    )
     parser.add_argument(
         "--allow-same-commit",
         action="store_true",
         help="Allow baseline/candidate commit overlap (noise-calibration mode only)",
     )
     args = parser.parse_args()
+    native_args = (args.native_baseline, args.native_candidate, args.vg_perf_004_out)
+    if any(native_args) and not all(native_args):
+        parser.error(
+            "--native-baseline, --native-candidate and --vg-perf-004-out must be given together"
+        )
 
     baseline_files: list[Path] = args.baseline
     candidate_files: list[Path] = args.candidate
     baseline_runs = load_runs(baseline_files)
     candidate_runs = load_runs(candidate_files)
 
-    baseline_commits = commits_for(baseline_runs)
-    candidate_commits = commits_for(candidate_runs)
+    native_baseline_runs = load_runs(args.native_baseline) if args.native_baseline else []
+    native_candidate_runs = load_runs(args.native_candidate) if args.native_candidate else []
+
+    baseline_commits = commits_for(baseline_runs + native_baseline_runs)
+    candidate_commits = commits_for(candidate_runs + native_candidate_runs)
     overlap = sorted(set(baseline_commits) & set(candidate_commits))
     if overlap and not args.allow_same_commit:
         print(
@@ -270,6 +319,29 @@ def main() -> None:
         "pass": perf002_pass,
     }
 
+    vg_perf_004: dict[str, Any] | None = None
+    if native_baseline_runs:
+        perf004_checks, unbaselined = native_checks(
+            native_baseline_runs,
+            native_candidate_runs,
+            budget,
+            args.min_abs_native_latency_ms,
+        )
+        vg_perf_004 = {
+            "gate": "VG-PERF-004",
+            "budget_pct": budget,
+            "min_abs_latency_ms": args.min_abs_native_latency_ms,
+            "aggregation": "median_across_runs",
+            "baseline_files": [str(path) for path in args.native_baseline],
+            "candidate_files": [str(path) for path in args.native_candidate],
+            "baseline_commits": commits_for(native_baseline_runs),
+            "candidate_commits": commits_for(native_candidate_runs),
+            "allow_same_commit": args.allow_same_commit,
+            "checks": perf004_checks,
+            "unbaselined_metrics": unbaselined,
+            "pass": all(check["pass"] for check in perf004_checks.values()),
+        }
+
     vg001_out = Path(args.vg_perf_001_out)
     vg002_out = Path(args.vg_perf_002_out)
     summary_out = Path(args.summary_out)
@@ -277,6 +349,8 @@ def main() -> None:
 
     vg001_out.write_text(json.dumps(vg_perf_001, indent=2))
     vg002_out.write_text(json.dumps(vg_perf_002, indent=2))
+    if vg_perf_004 is not None:
+        Path(args.vg_perf_004_out).write_text(json.dumps(vg_perf_004, indent=2))
 
     summary_lines = [
         "# M5-T01 Perf Comparison Summary",
@@ -297,10 +371,22 @@ def main() -> None:
         f"- vg-perf-001: `{args.vg_perf_001_out}`",
         f"- vg-perf-002: `{args.vg_perf_002_out}`",
     ]
+    if vg_perf_004 is not None:
+        failed = [name for name, check in vg_perf_004["checks"].items() if not check["pass"]]
+        summary_lines += [
+            "",
+            f"VG-PERF-004: {'pass' if vg_perf_004['pass'] else 'fail'}",
+            f"Native latency floor: {args.min_abs_native_latency_ms:.4f} ms",
+            f"Native checks: {len(vg_perf_004['checks'])} ({len(failed)} failed)",
+        ]
+        summary_lines += [f"- failed: `{name}`" for name in failed]
+        summary_lines.append(f"- vg-perf-004: `{args.vg_perf_004_out}`")
     summary_out.write_text("\n".join(summary_lines) + "\n")
 
     print(f"Wrote {vg001_out}")
     print(f"Wrote {vg002_out}")
+    if vg_perf_004 is not None:
+        print(f"Wrote {args.vg_perf_004_out}")
     print(f"Wrote {summary_out}")
 
 
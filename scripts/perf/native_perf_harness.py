@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""Measure rlm_core.h entry points natively and emit M5 harness JSON."""
+
+from __future__ import annotations
+
+import argparse
+import json
+import os
+import platform
+import subprocess
+import sys
+import time
+from pathlib import Path
+from typing import Any
+
+sys.path.insert(0, str(Path(__file__).resolve().parent))
+
+from repl_perf_harness import ROOT, git_rev, metric_summary  # noqa: E402
+
+RLM_CORE_DIR = ROOT / "rlm-core"
+CRITERION_DIR = RLM_CORE_DIR / "target" / "criterion"
+CXX_BENCH_BIN = RLM_CORE_DIR / "target" / "release" / "rlm_core_bench"
+
+
+def run_criterion(nodes: str) -> dict[str, list[float]]:
+    """Run benches/ffi.rs and read back this run's per-iteration samples."""
+    started = time.time()
+    subprocess.run(
+        ["cargo", "bench", "--bench", "ffi", "--", "--noplot"],
+        cwd=RLM_CORE_DIR,
+        env={**os.environ, "RLM_BENCH_NODES": nodes},
+        check=True,
+    )
+
+    samples: dict[str, list[float]] = {}
+    for sample_path in sorted(CRITERION_DIR.glob("**/new/sample.json")):
+        # Skip results left over from benchmarks this run did not execute.
+        if sample_path.stat().st_mtime < started:
+            continue
+        benchmark = json.loads((sample_path.parent / "benchmark.json").read_text())
+        sample = json.loads(sample_path.read_text())
+        samples[benchmark["full_id"]] = [
+            total_ns / iters / 1e6
+            for total_ns, iters in zip(sample["times"], sample["iters"])
+            if iters > 0
+        ]
+    return samples
+
+
+def run_cxx(binary: Path, nodes: str, sample_count: int) -> dict[str, list[float]]:
+    """Run the C++ driver built from benches/native/rlm_core_bench.cpp."""
+    output = subprocess.run(
+        [str(binary), "--nodes", nodes, "--samples", str(sample_count)],
+        cwd=RLM_CORE_DIR,
+        check=True,
+        capture_output=True,
+        text=True,
+    ).stdout
+    return json.loads(output)["samples_ms"]
+
+
+def main() -> None:
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--label", required=True, help="Run label, e.g. baseline/candidate")
+    parser.add_argument("--output", required=True, help="Output JSON path")
+    parser.add_argument(
+        "--nodes",
+        default="10000,100000",
+        help="Comma-separated memory-store sizes (add 1000000 for the full sweep)",
+    )
+    parser.add_argument("--samples", type=int, default=30, help="C++ driver samples per metric")
+    parser.add_argument("--skip-criterion", action="store_true", help="Only run the C++ driver")
+    parser.add_argument(
+        "--cxx-bin",
+        default=str(CXX_BENCH_BIN),
+        help="C++ driver binary; skipped when it does not exist",
+    )
+    args = parser.parse_args()
+
+    output_path = Path(args.output)
+    output_path.parent.mkdir(parents=True, exist_ok=True)
+
+    drivers: list[str] = []
+    samples: dict[str, list[float]] = {}
+    if not args.skip_criterion:
+        samples.update(run_criterion(args.nodes))
+        drivers.append("criterion")
+    cxx_bin = Path(args.cxx_bin)
+    if cxx_bin.exists():
+        samples.update(run_cxx(cxx_bin, args.nodes, args.samples))
+        drivers.append("cxx")
+    if not samples:
+        print("no native benchmarks ran", file=sys.stderr)
+        raise SystemExit(1)
+
+    payload: dict[str, Any] = {
+        "label": args.label,
+        "timestamp_utc": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+        "environment": {
+            "platform": platform.platform(),
+            "python_version": platform.python_version(),
+            "processor": platform.processor(),
+            "loop_commit": git_rev(ROOT),
+            "cwd": str(RLM_CORE_DIR),
+        },
+        "config": {
+            "nodes": [int(n) for n in args.nodes.split(",") if n.strip()],
+            "cxx_samples": args.samples,
+            "drivers": drivers,
+        },
+        "metrics": {name: metric_summary(values) for name, values in sorted(samples.items())},
+    }
+
+    output_path.write_text(json.dumps(payload, indent=2))
+    print(f"Wrote {output_path}")
+
+
+if __name__ == "__main__":
+    main()
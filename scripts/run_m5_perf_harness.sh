@@ -7,6 +7,7 @@ PY_REPL_DIR="$ROOT_DIR/rlm-core/python"
 UV_CACHE_DIR_VALUE="${UV_CACHE_DIR:-$ROOT_DIR/.uv-cache}"
 HARNESS="$ROOT_DIR/scripts/perf/repl_perf_harness.py"
 COMPARE="$ROOT_DIR/scripts/perf/compare_perf_runs.py"
+NATIVE_HARNESS="$ROOT_DIR/scripts/perf/native_perf_harness.py"
 
 EVIDENCE_DATE="${EVIDENCE_DATE:-$(date +%F)}"
 EVIDENCE_DIR_DEFAULT="$ROOT_DIR/docs/execution-plan/evidence/$EVIDENCE_DATE/milestone-M5"
@@ -25,6 +26,11 @@ MIN_ABS_THROUGHPUT_DROP_OPS="${MIN_ABS_THROUGHPUT_DROP_OPS:-150.0}"
 MAX_ERROR_RATE_DELTA="${MAX_ERROR_RATE_DELTA:-0.01}"
 BASELINE_JSON_IN="${BASELINE_JSON_IN:-}"
 ALLOW_SAME_COMMIT="${ALLOW_SAME_COMMIT:-0}"
+NATIVE_BENCH="${NATIVE_BENCH:-0}"
+NATIVE_NODES="${NATIVE_NODES:-10000,100000}"
+NATIVE_SAMPLES="${NATIVE_SAMPLES:-30}"
+NATIVE_MIN_ABS_LATENCY_MS="${NATIVE_MIN_ABS_LATENCY_MS:-0.001}"
+NATIVE_BASELINE_JSON_IN="${NATIVE_BASELINE_JSON_IN:-}"
 
 mkdir -p "$EVIDENCE_DIR"
 mkdir -p "$UV_CACHE_DIR_VALUE"
@@ -41,6 +47,9 @@ CANDIDATE_JSON="$EVIDENCE_DIR/M5-T01-candidate.json"
 VG_PERF_001="$EVIDENCE_DIR/M5-T01-VG-PERF-001.json"
 VG_PERF_002="$EVIDENCE_DIR/M5-T01-VG-PERF-002.json"
 SUMMARY_MD="$EVIDENCE_DIR/M5-T01-perf-summary.md"
+NATIVE_BASELINE_JSON="$EVIDENCE_DIR/M5-T01-native-baseline.json"
+NATIVE_CANDIDATE_JSON="$EVIDENCE_DIR/M5-T01-native-candidate.json"
+VG_PERF_004="$EVIDENCE_DIR/M5-T01-VG-PERF-004.json"
 
 run_harness() {
   local label="$1"
@@ -58,9 +67,22 @@ run_harness() {
   log "[harness:$label] wrote $output"
 }
 
+run_native_harness() {
+  local label="$1"
+  local output="$2"
+  log "[native:$label] running..."
+  LOOP_MIN_AVAILABLE_MIB="$MIN_AVAILABLE_MIB" "$SAFE_RUN" python3 "$NATIVE_HARNESS" \
+    --label "$label" \
+    --output "$output" \
+    --nodes "$NATIVE_NODES" \
+    --samples "$NATIVE_SAMPLES"
+  log "[native:$label] wrote $output"
+}
+
 run_harness_repeated() {
   local label="$1"
   local output="$2"
+  local runner="${3:-run_harness}"
   local run=1
   local run_outputs=()
 
@@ -69,7 +91,7 @@ run_harness_repeated() {
     if [[ "$run" -gt 1 ]]; then
       run_output="${output%.json}.run${run}.json"
     fi
-    run_harness "${label}-run${run}" "$run_output" 1>&2
+    "$runner" "${label}-run${run}" "$run_output" 1>&2
     run_outputs+=("$run_output")
     run=$((run + 1))
   done
@@ -100,6 +122,7 @@ log "min_abs_latency_ms: $MIN_ABS_LATENCY_MS"
 log "min_abs_throughput_drop_ops: $MIN_ABS_THROUGHPUT_DROP_OPS"
 log "max_error_rate_delta: $MAX_ERROR_RATE_DELTA"
 log "allow_same_commit: $ALLOW_SAME_COMMIT"
+log "native_bench: $NATIVE_BENCH"
 log ""
 
 if [[ -n "$BASELINE_JSON_IN" ]]; then
@@ -120,6 +143,23 @@ fi
 CANDIDATE_INPUTS="$(run_harness_repeated "candidate" "$CANDIDATE_JSON")"
 log "candidate_inputs: $CANDIDATE_INPUTS"
 
+if [[ "$NATIVE_BENCH" == "1" ]]; then
+  log "native_nodes: $NATIVE_NODES"
+  if [[ -n "$NATIVE_BASELINE_JSON_IN" ]]; then
+    validate_baseline_inputs "$NATIVE_BASELINE_JSON_IN"
+    NATIVE_BASELINE_INPUTS="$NATIVE_BASELINE_JSON_IN"
+  else
+    if [[ "$ALLOW_SAME_COMMIT" != "1" ]]; then
+      echo "NATIVE_BASELINE_JSON_IN is required with NATIVE_BENCH=1 (or set ALLOW_SAME_COMMIT=1 for calibration)." >&2
+      exit 1
+    fi
+    NATIVE_BASELINE_INPUTS="$(run_harness_repeated "native-baseline" "$NATIVE_BASELINE_JSON" run_native_harness)"
+  fi
+  log "native_baseline_inputs: $NATIVE_BASELINE_INPUTS"
+  NATIVE_CANDIDATE_INPUTS="$(run_harness_repeated "native-candidate" "$NATIVE_CANDIDATE_JSON" run_native_harness)"
+  log "native_candidate_inputs: $NATIVE_CANDIDATE_INPUTS"
+fi
+
 COMPARE_ARGS=(
   --baseline "$BASELINE_INPUTS"
   --candidate "$CANDIDATE_INPUTS"
@@ -134,6 +174,14 @@ COMPARE_ARGS=(
 if [[ "$ALLOW_SAME_COMMIT" == "1" ]]; then
   COMPARE_ARGS+=(--allow-same-commit)
 fi
+if [[ "$NATIVE_BENCH" == "1" ]]; then
+  COMPARE_ARGS+=(
+    --native-baseline "$NATIVE_BASELINE_INPUTS"
+    --native-candidate "$NATIVE_CANDIDATE_INPUTS"
+    --vg-perf-004-out "$VG_PERF_004"
+    --min-abs-native-latency-ms "$NATIVE_MIN_ABS_LATENCY_MS"
+  )
+fi
 
 python3 "$COMPARE" "${COMPARE_ARGS[@]}"
 